@@ -107,7 +107,7 @@ int ActorEditor::Create(const ActorEditor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ActorEditor::ReadProperty(std::string propName, Reader &reader)
+int ActorEditor::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
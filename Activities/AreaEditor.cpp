@@ -103,7 +103,7 @@ int AreaEditor::Create(const AreaEditor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int AreaEditor::ReadProperty(std::string propName, Reader &reader)
+int AreaEditor::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
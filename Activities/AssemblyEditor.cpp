@@ -107,7 +107,7 @@ int AssemblyEditor::Create(const AssemblyEditor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int AssemblyEditor::ReadProperty(std::string propName, Reader &reader)
+int AssemblyEditor::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
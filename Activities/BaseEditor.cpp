@@ -107,7 +107,7 @@ int BaseEditor::Create(const BaseEditor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int BaseEditor::ReadProperty(std::string propName, Reader &reader)
+int BaseEditor::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
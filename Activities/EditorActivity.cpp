@@ -135,7 +135,7 @@ int EditorActivity::Create(const EditorActivity &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int EditorActivity::ReadProperty(std::string propName, Reader &reader)
+int EditorActivity::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
@@ -130,7 +130,7 @@ int GABaseDefense::Create(const GABaseDefense &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GABaseDefense::ReadProperty(std::string propName, Reader &reader)
+int GABaseDefense::ReadProperty(const std::string &propName, Reader &reader)
 {
 
     if (propName == "SpawnIntervalEasiest")
@@ -118,7 +118,7 @@ int GABrainMatch::Create(const GABrainMatch &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GABrainMatch::ReadProperty(std::string propName, Reader &reader)
+int GABrainMatch::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
@@ -129,7 +129,7 @@ int GAMetaAttack::Create(const GAMetaAttack &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GAMetaAttack::ReadProperty(std::string propName, Reader &reader)
+int GAMetaAttack::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
@@ -17,6 +17,7 @@
 #include "MovableMan.h"
 #include "UInputMan.h"
 #include "ConsoleMan.h"
+#include "ProfilerMan.h"
 #include "AudioMan.h"
 #include "SettingsMan.h" 
 #include "AHuman.h"
@@ -117,7 +118,7 @@ int GAScripted::Create(const GAScripted &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GAScripted::ReadProperty(std::string propName, Reader &reader)
+int GAScripted::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "ScriptFile")
         reader >> m_ScriptPath;
@@ -457,7 +458,10 @@ void GAScripted::Update()
     if (m_ActivityState != OVER)
     {   
         // Call the defined function, but only after first checking if it exists
-        g_LuaMan.RunScriptString("if " + m_LuaClassName + ".UpdateActivity then " + m_LuaClassName + ":UpdateActivity(); end");
+        {
+            ProfileZone profileZone(g_ProfilerMan.IsCapturing() ? g_ProfilerMan.RegisterZone("Activity Script: " + GetPresetName()) : 0);
+            g_LuaMan.RunScriptString("if " + m_LuaClassName + ".UpdateActivity then " + m_LuaClassName + ":UpdateActivity(); end");
+        }
 
         UpdateGlobalScripts(false);
     }
@@ -193,7 +193,7 @@ int GATutorial::Create(const GATutorial &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GATutorial::ReadProperty(std::string propName, Reader &reader)
+int GATutorial::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "SpawnIntervalEasiest")
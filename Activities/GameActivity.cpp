@@ -239,7 +239,7 @@ int GameActivity::Create(const GameActivity &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GameActivity::ReadProperty(std::string propName, Reader &reader)
+int GameActivity::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "CPUTeam")
     {
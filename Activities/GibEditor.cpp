@@ -109,7 +109,7 @@ int GibEditor::Create(const GibEditor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int GibEditor::ReadProperty(std::string propName, Reader &reader)
+int GibEditor::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
@@ -159,7 +159,7 @@ namespace RTE {
 	//                  is called. If the property isn't recognized by any of the base classes,
 	//                  false is returned, and the reader's position is untouched.
 
-	int MultiplayerServerLobby::ReadProperty(std::string propName, Reader &reader)
+	int MultiplayerServerLobby::ReadProperty(const std::string &propName, Reader &reader)
 	{
 		// See if the base class(es) can find a match instead
 		return Activity::ReadProperty(propName, reader);
@@ -107,7 +107,7 @@ int SceneEditor::Create(const SceneEditor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int SceneEditor::ReadProperty(std::string propName, Reader &reader)
+int SceneEditor::ReadProperty(const std::string &propName, Reader &reader)
 {
 /*
     if (propName == "CPUTeam")
@@ -146,7 +146,7 @@ int ACDropShip::Create(const ACDropShip &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ACDropShip::ReadProperty(std::string propName, Reader &reader)
+int ACDropShip::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "RThruster")
     {
@@ -260,7 +260,7 @@ int ACrab::Create(const ACrab &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ACrab::ReadProperty(std::string propName, Reader &reader)
+int ACrab::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Turret")
     {
@@ -924,6 +924,8 @@ bool ACrab::Look(float FOVSpread, float range)
     Matrix aimMatrix(m_HFlipped ? -m_AimAngle : m_AimAngle);
     aimMatrix.SetXFlipped(m_HFlipped);
     lookVector *= aimMatrix;
+    if (g_SceneMan.IsVisibilityFansEnabled())
+        return LookWithFan(aimPos, lookVector, FOVSpread);
     // Add the spread
     lookVector.DegRotate(FOVSpread * NormalRand());
 
@@ -1060,15 +1062,14 @@ bool ACrab::IsOnScenePoint(Vector &scenePoint) const
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          UpdateMovePath
+// Virtual method:  OnNewMovePath
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates the path to move along to the currently set movetarget.
+// Description:     Processes a newly calculated MovePath when it comes back from the
+//                  pathfinding thread, and resets the progress tracking for it.
 
-bool ACrab::UpdateMovePath()
+void ACrab::OnNewMovePath()
 {
-    // Do the real path calc; abort and pass along the message if it didn't happen due to throttling
-    if (!Actor::UpdateMovePath())
-        return false;
+    Actor::OnNewMovePath();
 
     // Process the new path we now have, if any
     if (!m_MovePath.empty())
@@ -1103,8 +1104,6 @@ bool ACrab::UpdateMovePath()
             previousPoint = (*lItr);
         }
     }
-
-    return true;
 }
 
 
@@ -1262,7 +1261,7 @@ void ACrab::UpdateAI()
         if ((m_MoveVector.m_X > 0 && m_LateralMoveState == LAT_LEFT) || (m_MoveVector.m_X < 0 && m_LateralMoveState == LAT_RIGHT) || m_LateralMoveState == LAT_STILL)
         {
             // If not following an MO, stay still and switch to sentry mode if we're close enough to final static destination
-            if (!m_pMOMoveTarget && m_Waypoints.empty() && m_MovePath.empty() && fabs(m_MoveVector.m_X) <= 10)
+            if (!m_pMOMoveTarget && m_Waypoints.empty() && m_MovePath.empty() && !IsWaitingForMovePath() && fabs(m_MoveVector.m_X) <= 10)
             {
                 // DONE MOVING TOWARD TARGET
                 m_LateralMoveState = LAT_STILL;
@@ -157,7 +157,7 @@ ENTITYALLOCATION(ACrab)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -541,13 +541,14 @@ ENTITYALLOCATION(ACrab)
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Virtual method:  UpdateMovePath
+// Virtual method:  OnNewMovePath
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates the path to move along to the currently set movetarget.
+// Description:     Processes a newly calculated MovePath when it comes back from the
+//                  pathfinding thread, and resets the progress tracking for it.
 // Arguments:       None.
 // Return value:    None.
 
-    virtual bool UpdateMovePath();
+    virtual void OnNewMovePath();
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
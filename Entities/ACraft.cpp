@@ -101,7 +101,7 @@ int ACraft::Exit::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ACraft::Exit::ReadProperty(std::string propName, Reader &reader)
+int ACraft::Exit::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Offset")
         reader >> m_Offset;
@@ -350,7 +350,7 @@ int ACraft::Create(const ACraft &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ACraft::ReadProperty(std::string propName, Reader &reader)
+int ACraft::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "HatchDelay")
         reader >> m_HatchDelay;
@@ -126,7 +126,7 @@ enum
     //                  read or not. 0 means it was read successfully, and any nonzero indicates
     //                  that a property of that name could not be found in this or base classes.
 
-        virtual int ReadProperty(std::string propName, Reader &reader);
+        virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -344,7 +344,7 @@ enum
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
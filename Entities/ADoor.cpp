@@ -81,7 +81,7 @@ int ADoor::Sensor::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ADoor::Sensor::ReadProperty(std::string propName, Reader &reader)
+int ADoor::Sensor::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "StartOffset")
         reader >> m_StartOffset;
@@ -252,7 +252,7 @@ int ADoor::Create(const ADoor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ADoor::ReadProperty(std::string propName, Reader &reader)
+int ADoor::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Door")
     {
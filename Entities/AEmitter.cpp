@@ -130,7 +130,7 @@ int AEmitter::Create(const AEmitter &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int AEmitter::ReadProperty(std::string propName, Reader &reader)
+int AEmitter::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "AddEmission")
     {
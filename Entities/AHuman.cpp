@@ -256,7 +256,7 @@ int AHuman::Create(const AHuman &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int AHuman::ReadProperty(std::string propName, Reader &reader)
+int AHuman::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Head")
     {
@@ -1648,6 +1648,8 @@ bool AHuman::Look(float FOVSpread, float range)
     Matrix aimMatrix(m_HFlipped ? -m_AimAngle : m_AimAngle);
     aimMatrix.SetXFlipped(m_HFlipped);
     lookVector *= aimMatrix;
+    if (g_SceneMan.IsVisibilityFansEnabled())
+        return LookWithFan(aimPos, lookVector, FOVSpread);
     // Add the spread
     lookVector.DegRotate(FOVSpread * NormalRand());
 
@@ -1825,9 +1827,19 @@ bool AHuman::UpdateMovePath()
     // Estimate how much material this actor can dig through
     m_DigStrength = EstimateDigStrenght();
     
-    // Do the real path calc; abort and pass along the message if it didn't happen due to throttling
-    if (!Actor::UpdateMovePath())
-        return false;
+    return Actor::UpdateMovePath();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  OnNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Processes a newly calculated MovePath when it comes back from the
+//                  pathfinding thread, and resets the progress tracking for it.
+
+void AHuman::OnNewMovePath()
+{
+    Actor::OnNewMovePath();
 
     // Process the new path we now have, if any
     if (!m_MovePath.empty())
@@ -1862,7 +1874,6 @@ bool AHuman::UpdateMovePath()
             previousPoint = (*lItr);
         }
     }
-    return true;
 }
 
 
@@ -2019,7 +2030,7 @@ void AHuman::UpdateAI()
         if ((m_MoveVector.m_X > 0 && m_LateralMoveState == LAT_LEFT) || (m_MoveVector.m_X < 0 && m_LateralMoveState == LAT_RIGHT) || (m_LateralMoveState == LAT_STILL && m_DeviceState != AIMING && m_DeviceState != FIRING))
         {
             // If not following an MO, stay still and switch to sentry mode if we're close enough to final static destination
-            if (!m_pMOMoveTarget && m_Waypoints.empty() && m_MovePath.empty() && fabs(m_MoveVector.m_X) <= 10)
+            if (!m_pMOMoveTarget && m_Waypoints.empty() && m_MovePath.empty() && !IsWaitingForMovePath() && fabs(m_MoveVector.m_X) <= 10)
             {
                 // DONE MOVING TOWARD TARGET
                 m_LateralMoveState = LAT_STILL;
@@ -175,7 +175,7 @@ ENTITYALLOCATION(AHuman)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -896,6 +896,17 @@ ENTITYALLOCATION(AHuman)
     virtual bool UpdateMovePath();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  OnNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Processes a newly calculated MovePath when it comes back from the
+//                  pathfinding thread, and resets the progress tracking for it.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void OnNewMovePath();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateAI
 //////////////////////////////////////////////////////////////////////////////////////////
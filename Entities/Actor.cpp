@@ -123,6 +123,8 @@ void Actor::Clear()
     m_MoveVector.Reset();
     m_MovePath.clear();
     m_UpdateMovePath = true;
+    m_MovePathRequestID = -1;
+    m_MovePathRequestEnd.Reset();
     m_MoveProximityLimit = 100;
     m_LateralMoveState = LAT_STILL;
     m_MoveOvershootTimer.Reset();
@@ -130,6 +132,7 @@ void Actor::Clear()
     m_TeamBlockState = NOTBLOCKED;
     m_BlockTimer.Reset();
     m_BestTargetProximity = 10000.0f;
+    m_LookFanRevealed = false;
     m_ProgressTimer.Reset();
     m_StuckTimer.Reset();
     m_FallTimer.Reset();
@@ -321,7 +324,7 @@ int Actor::Create(const Actor &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Actor::ReadProperty(std::string propName, Reader &reader)
+int Actor::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "BodyHitSound")
         reader >> m_BodyHitSound;
@@ -479,6 +482,8 @@ int Actor::Save(Writer &writer) const
 
 void Actor::Destroy(bool notInherited)
 {
+    CancelMovePathRequest();
+
     for (deque<MovableObject *>::const_iterator itr = m_Inventory.begin(); itr != m_Inventory.end(); ++itr)
         delete (*itr);
 
@@ -714,12 +719,16 @@ bool Actor::Look(float FOVSpread, float range)
     if (lookVector.GetLargest() < 0.01)
     {
         lookVector.SetXY(range, 0);
+        if (g_SceneMan.IsVisibilityFansEnabled())
+            return LookWithFan(aimPos, lookVector, 180);
         lookVector.DegRotate(180 * NormalRand());
     }
     else
     {
         // Set the distance in the look direction
         lookVector.SetMagnitude(range);
+        if (g_SceneMan.IsVisibilityFansEnabled())
+            return LookWithFan(aimPos, lookVector, FOVSpread);
         // Add the spread from the directed look
         lookVector.DegRotate(FOVSpread * NormalRand());
     }
@@ -729,6 +738,26 @@ bool Actor::Look(float FOVSpread, float range)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LookWithFan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a visibility fan covering the whole field of view, instead of
+//                  casting a single random ray out of it. Only does so every few updates.
+
+bool Actor::LookWithFan(const Vector &eyePos, const Vector &lookVector, float FOVSpread)
+{
+    // Tell what the last traced fan revealed only once, like a single ray would have
+    bool revealed = m_LookFanRevealed;
+    m_LookFanRevealed = false;
+
+    // A whole fan sees far more than a ray every update ever did, so the Actors can take turns
+    if ((g_MovableMan.GetSimUpdateFrameNumber() + GetUniqueID()) % c_LookFanInterval == 0)
+        g_SceneMan.AddVisibilityFan(m_Team, eyePos, lookVector, FOVSpread, 25, GetUniqueID());
+
+    return revealed;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          AddGold
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1221,53 +1250,91 @@ MOID Actor::GetAIMOWaypointID()
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          UpdateMovePath
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates the path to move along to the currently set movetarget.
+// Description:     Requests a new path to move along to the currently set movetarget.
 
 bool Actor::UpdateMovePath()
 {
-    // TODO: Do throttling of calls for this function over time??
+    if (!g_SceneMan.GetScene())
+        return false;
 
+    // Don't pile up requests, unless the path has been set to update since the pending one was made
+    bool replacingRequest = IsWaitingForMovePath();
+    if (replacingRequest)
+    {
+        if (!m_UpdateMovePath)
+            return false;
+        CancelMovePathRequest();
+    }
 
-    // Remove the material representation of all doors of this guy's team so he can navigate through them (they'll open for him)
-    g_MovableMan.OverrideMaterialDoors(true, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+    // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
+    Vector pathStart = g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10);
+    Vector pathEnd;
 
     // If we're following someone/thing, then never advance waypoints until that thing disappears
     if (g_MovableMan.ValidMO(m_pMOMoveTarget))
-        g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_pMOMoveTarget->GetPos(), m_MovePath, m_DigStrength);
-    else
+        pathEnd = m_pMOMoveTarget->GetPos();
+    // The replaced request already took its waypoint, so head for the same place
+    else if (replacingRequest)
+        pathEnd = m_MovePathRequestEnd;
+    // Do we currently have a path to a static target we would like to still pursue?
+    else if (m_MovePath.empty())
     {
-        // Do we currently have a path to a static target we would like to still pursue?
-        if (m_MovePath.empty())
+        // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
+        if (!m_Waypoints.empty())
         {
-            // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
-            if (!m_Waypoints.empty())
-            {
-                // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_Waypoints.front().first, m_MovePath, m_DigStrength);
-                // If the waypoint was tied to an MO to pursue, then load it into the current MO target
-                if (g_MovableMan.ValidMO(m_Waypoints.front().second))
-                    m_pMOMoveTarget = m_Waypoints.front().second;
-                else
-                    m_pMOMoveTarget = 0;
-                // We loaded the waypoint, no need to keep it
-                m_Waypoints.pop_front();
-            }
-            // Just try to get to the last Move Target
+            pathEnd = m_Waypoints.front().first;
+            // If the waypoint was tied to an MO to pursue, then load it into the current MO target
+            if (g_MovableMan.ValidMO(m_Waypoints.front().second))
+                m_pMOMoveTarget = m_Waypoints.front().second;
             else
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_MoveTarget, m_MovePath, m_DigStrength);
+                m_pMOMoveTarget = 0;
+            // We loaded the waypoint, no need to keep it
+            m_Waypoints.pop_front();
         }
-        // We had a path before trying to update, so use its last point as the final destination
+        // Just try to get to the last Move Target
         else
-            g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), Vector(m_MovePath.back()), m_MovePath, m_DigStrength);
+            pathEnd = m_MoveTarget;
     }
+    // We had a path before trying to update, so use its last point as the final destination
+    else
+        pathEnd = m_MovePath.back();
+
+    // The path is solved on the pathfinding thread against the costs as they are at the end of this update, and picked up in Update when it's done.
+    // Doors don't have to be taken out of the material layer for this, since the pathfinding costs ignore door material
+    m_MovePathRequestID = g_SceneMan.GetScene()->RequestPath(pathStart, pathEnd, m_DigStrength);
+    m_MovePathRequestEnd = pathEnd;
+    m_UpdateMovePath = false;
 
-    // Place back the material representation of all doors of this guy's team so they are as we found them
-    g_MovableMan.OverrideMaterialDoors(false, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+    // Don't count the wait for the path against the progress made
+    m_StuckTimer.Reset();
+    m_ProgressTimer.Reset();
 
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelMovePathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels the pending move path request, if any, so the current move path
+//                  is kept.
+
+void Actor::CancelMovePathRequest()
+{
+    if (m_MovePathRequestID >= 0 && g_SceneMan.GetScene())
+        g_SceneMan.GetScene()->CancelPathRequest(m_MovePathRequestID);
+    m_MovePathRequestID = -1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  OnNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Processes a newly calculated MovePath when it comes back from the
+//                  pathfinding thread, and resets the progress tracking for it.
+
+void Actor::OnNewMovePath()
+{
     // Process the new path we now have, if any
     if (!m_MovePath.empty())
     {
@@ -1293,12 +1360,9 @@ bool Actor::UpdateMovePath()
     m_StuckTimer.Reset();
     m_ProgressTimer.Reset();
     m_BestTargetProximity = g_SceneMan.GetSceneDim().GetLargest();
-    m_UpdateMovePath = false;
 
     // Don't let the guy walk in the wrong dir for a while if path requires him to start walking in opposite dir from where he's facing
     m_MoveOvershootTimer.SetElapsedSimTimeMS(1000);
-
-    return true;
 }
 
 
@@ -1315,31 +1379,17 @@ bool Actor::UpdateAIScripted()
 
     int error = 0;
 
-    // Check to make sure the preset of this is still defined in the Lua state. If not, re-create it and recover gracefully
-    if (!g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false))
-        ReloadScripts();
-
     // First see if we even have a representation stored in the Lua state, and if not, create one
-    if (m_ScriptObjectName.empty())
-    {
-        // Get the unique object identifier for this object and construct the object isntance name in Lua that points to this object so we can pass it into the preset functions
-        m_ScriptObjectName = GetClassName() + "s." + g_LuaMan.GetNewObjectID();
-
-        // Give access to this in the Lua state
-        g_MovableMan.SetScriptedEntity(this);
-        // Create the Lua variable which will hold the object instance of this instance for as long as it exists
-        if ((error = g_LuaMan.RunScriptString(m_ScriptObjectName + " = To" + GetClassName() + "(MovableMan.ScriptedEntity);")) < 0)
-            return false;
-
-        // Call the scripted creation function, but only after first checking if it and this instance's Lua representation really exists
-        if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".Create and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Create(" + m_ScriptObjectName + "); end")) < 0)
-            return false;
-    }
+    if ((error = PrepareScriptObject()) < 0)
+        return false;
 
-    // Call the defined function, but only after first checking if it and this instance's Lua representation exists
+    // Call the defined function straight through its reference, if it and this instance's Lua representation exist
 
 	g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
-	error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".UpdateAI and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".UpdateAI(" + m_ScriptObjectName + "); end");
+	{
+		ProfileZone profileZone(m_pScriptCallbacks->m_ProfilerZoneIDs[LuaMan::CALLBACK_UPDATEAI]);
+		error = g_LuaMan.CallFunctionRef(m_pScriptCallbacks->m_FunctionRefs[LuaMan::CALLBACK_UPDATEAI], m_ScriptObjectRef);
+	}
 	g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
 
     if (error < 0)
@@ -1478,6 +1528,19 @@ void Actor::Update()
     // Update the viewpoint to be at least what the position is
     m_ViewPoint = m_Pos;
 
+    // Pick up the move path requested earlier if it has come back, or stop waiting for it if it got lost
+    if (IsWaitingForMovePath() && g_SceneMan.GetScene())
+    {
+        float notUsed;
+        if (g_SceneMan.GetScene()->GetPathResult(m_MovePathRequestID, m_MovePath, notUsed))
+        {
+            m_MovePathRequestID = -1;
+            OnNewMovePath();
+        }
+        else if (!g_SceneMan.GetScene()->IsPathRequestPending(m_MovePathRequestID))
+            m_MovePathRequestID = -1;
+    }
+
     // Update the best progress made, if we're any closer to the currently pursued waypoint
     float targetProximity = ((!m_MovePath.empty() ? m_MovePath.back() : m_MoveTarget) - m_Pos).GetMagnitude();
     // Reset the timer if we've made progress as the crow flies
@@ -1539,8 +1602,8 @@ void Actor::Update()
         // No more path, so check if any more waypoints to make a new path to? This doesn't apply if we're following something
         else if (m_MovePath.empty() && !m_Waypoints.empty() && !m_pMOMoveTarget)
             UpdateMovePath();
-        // Nope, so just conclude that we must have reached the ultimate AI target set and exit the goto mode
-        else if (!m_pMOMoveTarget)
+        // Nope, so just conclude that we must have reached the ultimate AI target set and exit the goto mode, unless the path there is still being calculated
+        else if (!m_pMOMoveTarget && !IsWaitingForMovePath())
             m_AIMode = AIMODE_SENTRY;
     }
 
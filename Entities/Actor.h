@@ -156,7 +156,7 @@ ENTITYALLOCATION(Actor)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -572,13 +572,28 @@ ENTITYALLOCATION(Actor)
 // Virtual method:  Look
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Casts an unseen-revealing ray in the direction of where this is facing.
+//                  If visibility fans are enabled, the whole field of view is looked at
+//                  with a fan every few updates instead.
 // Arguments:       The degree angle to deviate from the current view point in the ray
 //                  casting. A random ray will be chosen out of this +-range.
 //                  The range, in pixels, that the ray will have.
-// Return value:    Whether any unseen pixels were revealed by this look.
+// Return value:    Whether any unseen pixels were revealed by this look. With visibility
+//                  fans, whether the last fan of this that was traced since the previous
+//                  look revealed any.
 
     virtual bool Look(float FOVSpread, float range);
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetLookFanRevealed
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Lets this know a visibility fan it queued revealed some unseen pixels
+//                  once it was traced, for the next Look to tell.
+// Arguments:       None.
+// Return value:    None.
+
+    void SetLookFanRevealed() { m_LookFanRevealed = true; }
+
 /* Old version, we don't let the actors carry gold anymore, goes directly to the team funds instead
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          AddGold
@@ -769,7 +784,7 @@ ENTITYALLOCATION(Actor)
 // Arguments:       None.
 // Return value:    None.
 
-    virtual void ClearAIWaypoints() { m_pMOMoveTarget = 0; m_Waypoints.clear(); m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
+    virtual void ClearAIWaypoints() { CancelMovePathRequest(); m_pMOMoveTarget = 0; m_Waypoints.clear(); m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -811,7 +826,7 @@ ENTITYALLOCATION(Actor)
 // Arguments:       None.
 // Return value:    None.
 
-    virtual void ClearMovePath() { m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
+    virtual void ClearMovePath() { CancelMovePathRequest(); m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1139,18 +1154,51 @@ ENTITYALLOCATION(Actor)
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateMovePath
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates this' move path RIGHT NOW. Will update the path to the
-//                  current waypoint, if any. CAVEAT: this only actually updates if a queue
-//                  index number passed in is sufficiently close to 0 to allow this to
-//                  compute, based on an internal global assessment of how often this very
-//                  expensive computation is allowed to run.
-// Arguments:       The queue number this was given the last time
-// Return value:    Whether the update was performed, or if it should be tried again next
+// Description:     Requests a new move path to the current waypoint, if any. The path is
+//                  calculated on the pathfinding thread and replaces the current one when
+//                  it comes back a couple of updates later, until which the current one is
+//                  kept. If a request is already pending, a new one is only made if the
+//                  move path has been set to update since.
+// Arguments:       None.
+// Return value:    Whether a new path was requested, or if it should be tried again next
 //                  frame.
 
     virtual bool UpdateMovePath();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsWaitingForMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether this has requested a new move path that hasn't come back
+//                  yet.
+// Arguments:       None.
+// Return value:    Whether a move path request is pending.
+
+    bool IsWaitingForMovePath() const { return m_MovePathRequestID >= 0; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelMovePathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels the pending move path request, if any, so the current move path
+//                  is kept.
+// Arguments:       None.
+// Return value:    None.
+
+    void CancelMovePathRequest();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  OnNewMovePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Processes a newly calculated MovePath when it comes back from the
+//                  pathfinding thread, and resets the progress tracking for it.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void OnNewMovePath();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateAIScripted
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1516,6 +1564,9 @@ protected:
     std::list<Vector> m_MovePath;
     // Whether it's time to update the path
     bool m_UpdateMovePath;
+    // The ID of the pending path request for the MovePath, or -1 if none, and where that path leads to
+    int m_MovePathRequestID;
+    Vector m_MovePathRequestEnd;
     // The minimum range to consider having reached a move target is considered
     float m_MoveProximityLimit;
     // Whether the AI is trying to progress to the right, left, or stand still
@@ -1537,6 +1588,25 @@ protected:
     Timer m_StuckTimer;
     // Timer for measuring interval between height checks
     Timer m_FallTimer;
+    // How many sim updates apart each Actor queues a visibility fan, so the fans of all Actors are spread out over that many updates
+    static const int c_LookFanInterval = 4;
+    // Whether a visibility fan of this revealed anything since the last Look, so Look can tell the same as it does with single rays
+    bool m_LookFanRevealed;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LookWithFan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a visibility fan covering the whole field of view, instead of
+//                  casting a single random ray out of it. Only does so every few updates.
+// Arguments:       The position to look from.
+//                  The middle of the field of view, as long as the range of the look.
+//                  The degree angle the field of view spreads to each side.
+// Return value:    Whether the last fan of this that was traced since the previous look
+//                  revealed any unseen pixels. What a newly queued fan reveals isn't known
+//                  until the fans are traced.
+
+    bool LookWithFan(const Vector &eyePos, const Vector &lookVector, float FOVSpread);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
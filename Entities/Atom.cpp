@@ -18,6 +18,7 @@
 #include "PresetMan.h"
 #include "RTETools.h"
 #include "Actor.h"
+#include "ThreadMan.h"
 
 namespace RTE {
 
@@ -275,7 +276,7 @@ int Atom::Create(const Atom &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Atom::ReadProperty(std::string propName, Reader &reader)
+int Atom::ReadProperty(const std::string &propName, Reader &reader)
 {
 // TODO: this right?
     if (propName == "Offset")
@@ -633,6 +634,7 @@ bool Atom::StepForward(int numSteps)
         m_MOIDHit = g_NoMOID;
         m_TerrainMatHit = g_MaterialAir;
         bool hitStep = false;
+        const SceneSampler &sampler = g_SceneMan.GetSceneSampler();
 
         if (m_DomSteps < m_Delta[m_Dom]) {
             ++m_DomSteps;
@@ -653,10 +655,10 @@ bool Atom::StepForward(int numSteps)
 
 
             // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(m_IntPos[X], m_IntPos[Y]);
+            sampler.WrapPosition(m_IntPos[X], m_IntPos[Y]);
 
             // Detect terrain hits, if not disabled.
-            if (g_MaterialAir != (m_TerrainMatHit = g_SceneMan.GetTerrMatter(m_IntPos[X], m_IntPos[Y])))
+            if (g_MaterialAir != (m_TerrainMatHit = sampler.GetTerrMatter(m_IntPos[X], m_IntPos[Y])))
             {
                 // Check if we're temporarily disabled from hitting terrain
                 if (!m_TerrainHitsDisabled)
@@ -676,7 +678,7 @@ bool Atom::StepForward(int numSteps)
             // Detect hits with non-ignored MO's, if enabled.
             if (m_pOwnerMO->m_HitsMOs)
             {
-                m_MOIDHit = g_SceneMan.GetMOIDPixel(m_IntPos[X], m_IntPos[Y]);
+                m_MOIDHit = sampler.GetMOIDPixel(m_IntPos[X], m_IntPos[Y]);
 
                 if (IsIgnoringMOID(m_MOIDHit))
                     m_MOIDHit = g_NoMOID;
@@ -967,6 +969,7 @@ int Atom::Travel(float travelTime,
     // Lock all bitmaps involved outside the loop.
     if (!scenePreLocked)
         g_SceneMan.LockScene();
+    const SceneSampler &sampler = g_SceneMan.GetSceneSampler();
 
     // Loop for all the different straight segs (between bounces etc) that
     // have to be traveled during the timeLeft.
@@ -1051,7 +1054,7 @@ int Atom::Travel(float travelTime,
         {
             // Check for the special case if the Atom is starting out embedded in terrain.
             // This can happen if something large gets copied to the terrain and imbeds some Atom:s.
-            if (domSteps == 0 && g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir) {
+            if (domSteps == 0 && sampler.GetTerrMatter(intPos[X], intPos[Y]) != g_MaterialAir) {
                 ++hitCount;
                 hit[X] = hit[Y] = true;
                 if (g_SceneMan.TryPenetrate(intPos[X],
@@ -1089,13 +1092,13 @@ int Atom::Travel(float travelTime,
             error += delta2[sub];
 
             // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            sampler.WrapPosition(intPos[X], intPos[Y]);
 
             /////////////////////////////////////////////////////
             // Atom-MO collision detection and response
             // Detect hits with non-ignored MO's, if enabled.
 
-            m_MOIDHit = g_SceneMan.GetMOIDPixel(intPos[X], intPos[Y]);
+            m_MOIDHit = sampler.GetMOIDPixel(intPos[X], intPos[Y]);
 
             if (m_pOwnerMO->m_HitsMOs && m_MOIDHit != g_NoMOID && !IsIgnoringMOID(m_MOIDHit))
             {
@@ -1149,8 +1152,8 @@ int Atom::Travel(float travelTime,
                 }
 
                 // Check for the collision point in the dominant direction of travel.
-                if (delta[dom] && ((dom == X && g_SceneMan.GetMOIDPixel(hitPos[X], intPos[Y]) != g_NoMOID) ||
-                                   (dom == Y && g_SceneMan.GetMOIDPixel(intPos[X], hitPos[Y]) != g_NoMOID))) {
+                if (delta[dom] && ((dom == X && sampler.GetMOIDPixel(hitPos[X], intPos[Y]) != g_NoMOID) ||
+                                   (dom == Y && sampler.GetMOIDPixel(intPos[X], hitPos[Y]) != g_NoMOID))) {
                     hit[dom] = true;
                     m_LastHit.hitPoint = dom == X ? Vector(hitPos[X], intPos[Y]) :
                                                     Vector(intPos[X], hitPos[Y]);
@@ -1158,8 +1161,8 @@ int Atom::Travel(float travelTime,
                 }
 
                 // Check for the collision point in the submissive direction of travel.
-                if (subStepped && delta[sub] && ((sub == X && g_SceneMan.GetMOIDPixel(hitPos[X], intPos[Y]) != g_NoMOID) ||
-                                                 (sub == Y && g_SceneMan.GetMOIDPixel(intPos[X], hitPos[Y]) != g_NoMOID))) {
+                if (subStepped && delta[sub] && ((sub == X && sampler.GetMOIDPixel(hitPos[X], intPos[Y]) != g_NoMOID) ||
+                                                 (sub == Y && sampler.GetMOIDPixel(intPos[X], hitPos[Y]) != g_NoMOID))) {
                     hit[sub] = true;
                     if (m_LastHit.hitPoint.IsZero())
                         m_LastHit.hitPoint = sub == X ? Vector(hitPos[X], intPos[Y]) :
@@ -1199,7 +1202,7 @@ int Atom::Travel(float travelTime,
             /////////////////////////////////////////////////////
             // Atom-Terrain collision detection and response
             // If there was no MO collision detected, then check for terrain hits.
-			else if ((hitMaterialID = g_SceneMan.GetTerrMatter(intPos[X], intPos[Y])) && !m_pOwnerMO->m_IgnoreTerrain)
+			else if ((hitMaterialID = sampler.GetTerrMatter(intPos[X], intPos[Y])) && !m_pOwnerMO->m_IgnoreTerrain)
             {
 				if (hitMaterialID != g_MaterialAir)
 					m_pOwnerMO->SetHitWhatTerrMaterial(hitMaterialID);
@@ -1245,7 +1248,7 @@ int Atom::Travel(float travelTime,
                         intPos[sub] -= increment[sub];
 
                     // Undo scene wrapping, if necessary
-                    g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+                    sampler.WrapPosition(intPos[X], intPos[Y]);
 
 // TODO: improve sticky logic!
                     // Check if particle is sticky and should adhere to where it collided
@@ -1253,18 +1256,26 @@ int Atom::Travel(float travelTime,
                     {
                         // SPLAT, so update position, apply to terrain and delete, and stop traveling
                         m_pOwnerMO->SetPos(Vector(intPos[X], intPos[Y]));
-                        g_SceneMan.GetTerrain()->ApplyMovableObject(m_pOwnerMO);
+                        if (ThreadMan::IsInParallelJob())
+                        {
+                            // Apply at the splat position when the terrain is ours to write to, the MO isn't deleted until after that
+                            MovableObject *pOwnerMO = m_pOwnerMO;
+                            Vector splatPos(intPos[X], intPos[Y]);
+                            g_ThreadMan.DeferCommand([pOwnerMO, splatPos]() { pOwnerMO->SetPos(splatPos); g_SceneMan.GetTerrain()->ApplyMovableObject(pOwnerMO); });
+                        }
+                        else
+                            g_SceneMan.GetTerrain()->ApplyMovableObject(m_pOwnerMO);
                         m_pOwnerMO->SetToDelete(true);
                         m_LastHit.terminate[HITOR] = hit[dom] = hit[sub] = true;
                         break;
                     }
 
                     // Check for and react upon a collision in the dominant direction of travel.
-                    if (delta[dom] && ((dom == X && g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y])) ||
-                                       (dom == Y && g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y])))) {
+                    if (delta[dom] && ((dom == X && sampler.GetTerrMatter(hitPos[X], intPos[Y])) ||
+                                       (dom == Y && sampler.GetTerrMatter(intPos[X], hitPos[Y])))) {
                         hit[dom] = true;
-                        domMaterialID = dom == X ? g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y]) :
-                                                   g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y]);
+                        domMaterialID = dom == X ? sampler.GetTerrMatter(hitPos[X], intPos[Y]) :
+                                                   sampler.GetTerrMatter(intPos[X], hitPos[Y]);
                         domMaterial = g_SceneMan.GetMaterialFromID(domMaterialID);
 
                         // Bounce according to the collision.
@@ -1274,11 +1285,11 @@ int Atom::Travel(float travelTime,
                     }
 
                     // Check for and react upon a collision in the submissive direction of travel.
-                    if (subStepped && delta[sub] && ((sub == X && g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y])) ||
-                                                     (sub == Y && g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y])))) {
+                    if (subStepped && delta[sub] && ((sub == X && sampler.GetTerrMatter(hitPos[X], intPos[Y])) ||
+                                                     (sub == Y && sampler.GetTerrMatter(intPos[X], hitPos[Y])))) {
                         hit[sub] = true;
-                        subMaterialID = sub == X ? g_SceneMan.GetTerrMatter(hitPos[X], intPos[Y]) :
-                                                   g_SceneMan.GetTerrMatter(intPos[X], hitPos[Y]);
+                        subMaterialID = sub == X ? sampler.GetTerrMatter(hitPos[X], intPos[Y]) :
+                                                   sampler.GetTerrMatter(intPos[X], hitPos[Y]);
                         subMaterial = g_SceneMan.GetMaterialFromID(subMaterialID);
 
                         // Bounce according to the collision.
@@ -1357,11 +1368,21 @@ int Atom::Travel(float travelTime,
     // Draw the trail
     if (g_TimerMan.DrawnSimUpdate() && m_TrailLength) {
         int length = m_TrailLength/* + 3 * PosRand()*/;
-        for (int i = trailPoints.size() - MIN(length, trailPoints.size()); i < trailPoints.size(); ++i)
-        {
-//            RTEAssert(is_inside_bitmap(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, 0), "Trying to draw out of bounds trail!");
-//            _putpixel(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
-            putpixel(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
+        if (ThreadMan::IsInParallelJob()) {
+            // Only keep the part of the trail that actually gets drawn, and draw it when the MO color layer is ours to write to
+            trailPoints.erase(trailPoints.begin(), trailPoints.end() - MIN(length, trailPoints.size()));
+            int trailColor = m_TrailColor.GetIndex();
+            g_ThreadMan.DeferCommand([pTrailBitmap, trailPoints, trailColor]() {
+                for (vector<pair<int, int> >::const_iterator itr = trailPoints.begin(); itr != trailPoints.end(); ++itr)
+                    putpixel(pTrailBitmap, itr->first, itr->second, trailColor);
+            });
+        } else {
+            for (int i = trailPoints.size() - MIN(length, trailPoints.size()); i < trailPoints.size(); ++i)
+            {
+//                RTEAssert(is_inside_bitmap(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, 0), "Trying to draw out of bounds trail!");
+//                _putpixel(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
+                putpixel(pTrailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
+            }
         }
     }
 
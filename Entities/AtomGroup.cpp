@@ -24,6 +24,90 @@ namespace RTE {
 CONCRETECLASSINFO(AtomGroup, Entity, 200)
 
 
+// An Atom that hit something during a travel step, by its index in the atom arrays.
+struct AtomHit
+{
+    AtomHit(int atomIndex, MOID hitMOID, const Vector &offset) : m_AtomIndex(atomIndex), m_MOID(hitMOID), m_Offset(offset) { }
+
+    int m_AtomIndex;
+    // The MOID hit, or g_NoMOID for terrain hits
+    MOID m_MOID;
+    // The rotated offset of the Atom, if the caller needs it
+    Vector m_Offset;
+};
+
+// The hit lists built on every step of a travel. Each thread keeps its own, and they keep their
+// capacity between travels, so travelling doesn't allocate once they've grown to fit.
+struct AtomGroupScratch
+{
+    void Clear()
+    {
+        m_HitTerrAtoms.clear();
+        m_PenetratingAtoms.clear();
+        m_HitResponseAtoms.clear();
+        m_IntersectingAtoms.clear();
+        m_HitMOAtoms.clear();
+        m_HitMOIDs.clear();
+        m_IgnoredMOHits.clear();
+        m_HitTerrOffsets.clear();
+        m_PenetratingOffsets.clear();
+        m_ImpulseForces.clear();
+    }
+
+    // Indices of the Atom:s that hit terrain, penetrated it, have responses to apply, or intersect something
+    vector<int> m_HitTerrAtoms;
+    vector<int> m_PenetratingAtoms;
+    vector<int> m_HitResponseAtoms;
+    vector<int> m_IntersectingAtoms;
+    // All Atom:s that hit MOs this step, in the order they hit, and the unique MOIDs they hit in ascending order
+    vector<AtomHit> m_HitMOAtoms;
+    vector<MOID> m_HitMOIDs;
+    // Atom:s that should ignore hits against specific MOs for a whole PushTravel
+    vector<AtomHit> m_IgnoredMOHits;
+    // Atom:s that hit or penetrated terrain, with their offsets, for PushTravel
+    vector<AtomHit> m_HitTerrOffsets;
+    vector<AtomHit> m_PenetratingOffsets;
+    // Impulse forces in kg * m/s and the offsets they're applied at, for PushTravel
+    vector<pair<Vector, Vector> > m_ImpulseForces;
+};
+
+// The calling thread's scratch buffers, one set per nesting level, since collision callbacks can end up travelling other AtomGroups
+static thread_local deque<AtomGroupScratch> s_ScratchPool;
+static thread_local int s_ScratchDepth = 0;
+
+// Borrows the calling thread's next free set of scratch buffers, cleared, for as long as it's in scope
+class AtomGroupScratchLease
+{
+public:
+    AtomGroupScratchLease()
+    {
+        if (s_ScratchDepth == s_ScratchPool.size())
+            s_ScratchPool.push_back(AtomGroupScratch());
+        m_pScratch = &s_ScratchPool[s_ScratchDepth++];
+        m_pScratch->Clear();
+    }
+    ~AtomGroupScratchLease() { --s_ScratchDepth; }
+    AtomGroupScratch * operator->() const { return m_pScratch; }
+private:
+    AtomGroupScratch *m_pScratch;
+    AtomGroupScratchLease(const AtomGroupScratchLease &reference);
+    AtomGroupScratchLease & operator=(const AtomGroupScratchLease &rhs);
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddHitMOID
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a MOID to a sorted list of unique MOIDs, if it isn't in it already.
+
+static void AddHitMOID(vector<MOID> &hitMOIDs, MOID hitMOID)
+{
+    vector<MOID>::iterator moItr = lower_bound(hitMOIDs.begin(), hitMOIDs.end(), hitMOID);
+    if (moItr == hitMOIDs.end() || *moItr != hitMOID)
+        hitMOIDs.insert(moItr, hitMOID);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -37,6 +121,11 @@ void AtomGroup::Clear()
     m_Resolution = 1;
     m_Depth = 0;
     m_Atoms.clear();
+    m_AtomPtrs.clear();
+    m_AtomOffsets.clear();
+    m_AtomNormals.clear();
+    m_AtomMaterials.clear();
+    m_AtomArraysDirty = true;
     m_SubGroups.clear();
     m_MomInertia = 0;
     m_pOwnerMO = 0;
@@ -71,6 +160,7 @@ int AtomGroup::Create()
 		Atom * pAtom = new Atom(Vector(), m_pMaterial, m_pOwnerMO);
 
 		m_Atoms.push_back(pAtom);
+		m_AtomArraysDirty = true;
 	}
     else if (m_pMaterial->id != m_Atoms.front()->GetMaterial()->id)
         m_pMaterial = m_Atoms.front()->GetMaterial();
@@ -130,6 +220,8 @@ int AtomGroup::Create(const AtomGroup &reference, bool onlyCopyOwnerAtoms)
 	}
 
 
+    m_AtomArraysDirty = true;
+
     // Make sure the tansfer of material properties happens
     if (!reference.m_Atoms.empty())
     {
@@ -493,6 +585,8 @@ int AtomGroup::Create(MOSRotating *pOwnerMOSRotating, Material const *material,
 
 // TODO: Consider m_JointOffset!")
 
+    m_AtomArraysDirty = true;
+
     destroy_bitmap(checkBitmap); checkBitmap = 0;
 
     return 0;
@@ -507,7 +601,7 @@ int AtomGroup::Create(MOSRotating *pOwnerMOSRotating, Material const *material,
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int AtomGroup::ReadProperty(std::string propName, Reader &reader)
+int AtomGroup::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "AutoGenerate")
         reader >> m_AutoGenerate;
@@ -541,6 +635,7 @@ int AtomGroup::ReadProperty(std::string propName, Reader &reader)
         Atom *pAtom = new Atom;
         reader >> *pAtom;
         m_Atoms.push_back(pAtom);
+        m_AtomArraysDirty = true;
     }
     else if (propName == "JointOffset")
         reader >> m_JointOffset;
@@ -786,6 +881,7 @@ void AtomGroup::AddAtoms(const std::list<Atom *> &atomList, long int subID, cons
         // Add the atom to the subgroup in the SubGroups map, not transferring ownership
         m_SubGroups.find(subID)->second.push_back(pAtom);
     }
+    m_AtomArraysDirty = true;
 }
 
 
@@ -810,6 +906,7 @@ bool AtomGroup::UpdateSubAtoms(long int subID, const Vector &newOffset, const Ma
 		(*aItr)->SetSubID(subID); // Re-set ID just to make sure - TODO I don't think we need this?!
 		(*aItr)->SetOffset(newOffset + ((*aItr)->GetOriginalOffset() * newOffsetRotation));
 	}
+	m_AtomArraysDirty = true;
 
 	return true;
 }
@@ -842,11 +939,39 @@ bool AtomGroup::RemoveAtoms(long int removeID)
 
     // Try to erase the group from the subgroup map
     m_SubGroups.erase(removeID);
+    if (removedAny)
+        m_AtomArraysDirty = true;
 
     return removedAny;
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateAtomArrays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the contiguous atom arrays from m_Atoms, if the Atom:s or
+//                  their offsets have changed since they were last built.
+
+void AtomGroup::UpdateAtomArrays()
+{
+    if (!m_AtomArraysDirty)
+        return;
+
+    m_AtomPtrs.clear();
+    m_AtomOffsets.clear();
+    m_AtomNormals.clear();
+    m_AtomMaterials.clear();
+    for (list<Atom *>::const_iterator aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+    {
+        m_AtomPtrs.push_back(*aItr);
+        m_AtomOffsets.push_back((*aItr)->GetOffset());
+        m_AtomNormals.push_back((*aItr)->GetNormal());
+        m_AtomMaterials.push_back((*aItr)->GetMaterial());
+    }
+    m_AtomArraysDirty = false;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          AddMOIDToIgnore
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1038,12 +1163,18 @@ float AtomGroup::Travel(Vector &position,
     float segRatio, preHitRot, radMag, retardation;
     bool hitStep, newDir, halted = false, hitMOs = m_pOwnerMO->m_HitsMOs;
     Atom *pFastestAtom = 0;
-    map<MOID, list<Atom *> > hitMOAtoms;
-    map<MOID, list<Atom *> >::iterator mapMOItr;
-    list<Atom *> hitTerrAtoms;
-    list<Atom *> penetratingAtoms;
-    list<Atom *> hitResponseAtoms;
-    list<Atom *>::iterator aItr;
+    Atom *pAtom = 0;
+    int atom, keptCount;
+    // The hit lists, borrowed from this thread's scratch buffers so nothing is allocated for them here
+    AtomGroupScratchLease scratch;
+    vector<AtomHit> &hitMOAtoms = scratch->m_HitMOAtoms;
+    vector<AtomHit>::iterator hitItr;
+    vector<MOID> &hitMOIDs = scratch->m_HitMOIDs;
+    vector<MOID>::iterator moItr;
+    vector<int> &hitTerrAtoms = scratch->m_HitTerrAtoms;
+    vector<int> &penetratingAtoms = scratch->m_PenetratingAtoms;
+    vector<int> &hitResponseAtoms = scratch->m_HitResponseAtoms;
+    vector<int>::iterator aItr;
     Vector linSegTraj, startOff, targetOff, atomTraj, tempVec, tempVel, preHitPos, hitNormal;
     MOID tempMOID = g_NoMOID;
     HitData hitData;
@@ -1054,6 +1185,9 @@ float AtomGroup::Travel(Vector &position,
     didWrap = false;
     newDir = true;
 
+    UpdateAtomArrays();
+    const int atomCount = m_AtomPtrs.size();
+
     // Lock all bitmaps involved outside the loop.
     if (!scenePreLocked)
         g_SceneMan.LockScene();
@@ -1063,18 +1197,19 @@ float AtomGroup::Travel(Vector &position,
     do
     {
         // First see what atoms are inside either the terrain or another MO, and cause collisions responses before even starting the segment
-        for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+        for (atom = 0; atom < atomCount; ++atom)
         {
-            startOff = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+            pAtom = m_AtomPtrs[atom];
+            startOff = m_AtomOffsets[atom].GetXFlipped(hFlipped);
             startOff *= rotation;
 
-            if ((*aItr)->SetupPos(position + startOff))
+            if (pAtom->SetupPos(position + startOff))
             {
                 hitData.Reset();
-                if ((*aItr)->IsIgnoringTerrain())
+                if (pAtom->IsIgnoringTerrain())
                 {
                     // Calc and store the accurate hit radius of the Atom in relation to the CoM
-                    tempVec = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+                    tempVec = m_AtomOffsets[atom].GetXFlipped(hFlipped);
                     hitData.hitRadius[HITOR] = tempVec.RadRotate(rotation.GetRadAngle()) *= g_FrameMan.GetMPP();
                     // Figure out the pre-collision velocity of the hitting atom due to body translation and rotation.
                     hitData.hitVel[HITOR] = velocity + tempVec.Perpendicularize() * angVel;
@@ -1099,9 +1234,9 @@ float AtomGroup::Travel(Vector &position,
                     // Calc effects of moment of inertia will have on the impulse.
                     float MIhandle = m_LastHit.hitRadius[HITOR].GetPerpendicular().Dot(m_LastHit.bitmapNormal);
 */
-                    if (!(*aItr)->GetNormal().IsZero())
+                    if (!m_AtomNormals[atom].IsZero())
                     {
-                        hitData.resImpulse[HITOR] = m_pOwnerMO->RotateOffset((*aItr)->GetNormal());
+                        hitData.resImpulse[HITOR] = m_pOwnerMO->RotateOffset(m_AtomNormals[atom]);
                         hitData.resImpulse[HITOR] = -hitData.resImpulse[HITOR];
                         hitData.resImpulse[HITOR].SetMagnitude(hitData.hitVel[HITOR].GetMagnitude());
 //                        hitData.resImpulse[HITOR].SetMagnitude(hitData.hitVel[HITOR].GetMagnitude());
@@ -1119,7 +1254,7 @@ float AtomGroup::Travel(Vector &position,
             }
 #ifdef DEBUG_BUILD
             // Draw the positions of the atoms at the start of each segment, for visual debugging.
-            putpixel(g_SceneMan.GetMOColorBitmap(), (*aItr)->GetCurrentPos().m_X, (*aItr)->GetCurrentPos().m_Y, 122);
+            putpixel(g_SceneMan.GetMOColorBitmap(), pAtom->GetCurrentPos().m_X, pAtom->GetCurrentPos().m_Y, 122);
 #endif
         }
 
@@ -1150,6 +1285,7 @@ float AtomGroup::Travel(Vector &position,
             break;
 
         hitMOAtoms.clear();
+        hitMOIDs.clear();
         hitTerrAtoms.clear();
         penetratingAtoms.clear();
         hitData.Reset();
@@ -1157,12 +1293,13 @@ float AtomGroup::Travel(Vector &position,
 
         longestTrajMag = 0.0;
 
-        for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+        for (atom = 0; atom < atomCount; ++atom)
         {
+            pAtom = m_AtomPtrs[atom];
             // Calc the segment trajectory for each individual Atom, with rotations considered.
 //            startOff = (position + (*aItr)->GetOffset().GetXFlipped(hFlipped)) - position.GetFloored();
 // TODO: Get flipping working inside the matrix instead!")
-            startOff = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+            startOff = m_AtomOffsets[atom].GetXFlipped(hFlipped);
 //            startOff.RadRotate(/*hFlipped ? (c_PI + rotation) :*/ rotation);
             startOff *= rotation;
 
@@ -1172,10 +1309,10 @@ float AtomGroup::Travel(Vector &position,
             targetOff *= tan(rotDelta) * startOff.GetMagnitude();
 
             // Set up the inital rasterized step for each Atom and save the longest trajectory
-            if ((*aItr)->SetupSeg(position + startOff, linSegTraj + targetOff) > stepsOnSeg)
+            if (pAtom->SetupSeg(position + startOff, linSegTraj + targetOff) > stepsOnSeg)
             {
-                pFastestAtom = *aItr;
-                stepsOnSeg = (*aItr)->GetStepsLeft();
+                pFastestAtom = pAtom;
+                stepsOnSeg = pAtom->GetStepsLeft();
             }
         }
 
@@ -1183,9 +1320,9 @@ float AtomGroup::Travel(Vector &position,
 //        if (stepsOnSeg == 0)
 //            break;
 
-        for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+        for (atom = 0; atom < atomCount; ++atom)
 //            (*aItr)->SetStepRatio((*aItr)->GetSegLength() / longestTrajMag);
-            (*aItr)->SetStepRatio((float)(*aItr)->GetStepsLeft() / (float)stepsOnSeg);
+            m_AtomPtrs[atom]->SetStepRatio((float)m_AtomPtrs[atom]->GetStepsLeft() / (float)stepsOnSeg);
 
 
         // STEP LOOP //////////////////////////////////////////////////////////////////////////
@@ -1196,20 +1333,21 @@ float AtomGroup::Travel(Vector &position,
             // SCENE COLLISION DETECTION //////////////////////////////////////////////////////
             ///////////////////////////////////////////////////////////////////////////////////
 
-            for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+            for (atom = 0; atom < atomCount; ++atom)
             {
+                pAtom = m_AtomPtrs[atom];
                 // Take one step, and check if the atom hit anything
-                if ((*aItr)->StepForward())
+                if (pAtom->StepForward())
                 {
                     //  So something was hit, first check for terrain hit.
-                    if ((*aItr)->HitWhatTerrMaterial())
+                    if (pAtom->HitWhatTerrMaterial())
                     {
-						m_pOwnerMO->SetHitWhatTerrMaterial((*aItr)->HitWhatTerrMaterial());
-                        hitTerrAtoms.push_back(*aItr);
+						m_pOwnerMO->SetHitWhatTerrMaterial(pAtom->HitWhatTerrMaterial());
+                        hitTerrAtoms.push_back(atom);
                     }
 
                     // MO hits?
-                    if (hitMOs && (tempMOID = (*aItr)->HitWhatMOID()) != g_NoMOID)
+                    if (hitMOs && (tempMOID = pAtom->HitWhatMOID()) != g_NoMOID)
                     {
 						m_pOwnerMO->m_MOIDHit = tempMOID;
 
@@ -1220,21 +1358,10 @@ float AtomGroup::Travel(Vector &position,
 								pMO->SetHitWhatMOID(m_pOwnerMO->m_MOID);
 						}
 
-                        // Yes, MO hit. See if we already have another atom hitting this MO in this step.
-                        mapMOItr = hitMOAtoms.find(tempMOID);
-                        // If not, then create a new deque unique for that MO's ID
-                        // and insert into the map of MO-hitting Atom:s.
-                        if (mapMOItr == hitMOAtoms.end())
-                        {
-                            list<Atom *> newDeque;
-                            newDeque.push_back(*aItr);
-                            hitMOAtoms.insert(pair<MOID, list<Atom *> >(tempMOID, newDeque));
-                        }
-                        // If another Atom of this group has already hit this same MO
-                        // during this step, go ahead and add the new atom to the
-                        // corresponding deque for that MOID.
-                        else
-                            ((*mapMOItr).second).push_back(*aItr);
+                        // Yes, MO hit. Note it along with the other MO-hitting Atom:s of this step,
+                        // and keep track of which MOs were hit so they can be responded to in order.
+                        hitMOAtoms.push_back(AtomHit(atom, tempMOID, Vector()));
+                        AddHitMOID(hitMOIDs, tempMOID);
 
                         // Add the hit MO to the ignore list of ignored MOIDs
 //                        AddMOIDToIgnore(tempMOID);
@@ -1248,8 +1375,8 @@ float AtomGroup::Travel(Vector &position,
 //                      RTEAbort("Atom reported hit to AtomGroup, but then reported neither MO or Terr hit!");
 
 #ifdef DEBUG_BUILD
-                    Vector tPos = (*aItr)->GetCurrentPos();
-                    Vector tNorm = m_pOwnerMO->RotateOffset((*aItr)->GetNormal()) * 7;
+                    Vector tPos = pAtom->GetCurrentPos();
+                    Vector tNorm = m_pOwnerMO->RotateOffset(m_AtomNormals[atom]) * 7;
                     line(g_SceneMan.GetMOColorBitmap(), tPos.m_X, tPos.m_Y, tPos.m_X + tNorm.m_X, tPos.m_Y + tNorm.m_Y, 244);
                     // Draw the positions of the hitpoints on screen for easy debugging.
 //                    putpixel(g_SceneMan.GetMOColorBitmap(), tPos.m_X, tPos.m_Y, 5);
@@ -1301,10 +1428,13 @@ float AtomGroup::Travel(Vector &position,
                 distMass = mass / (hitTerrAtoms.size() * (m_Resolution ? m_Resolution : 1));
                 distMI = m_MomInertia / (hitTerrAtoms.size() * (m_Resolution ? m_Resolution : 1));
 
-                for (aItr = hitTerrAtoms.begin(); aItr != hitTerrAtoms.end(); )
+                // Compact the atoms that don't penetrate towards the front, keeping their order
+                keptCount = 0;
+                for (aItr = hitTerrAtoms.begin(); aItr != hitTerrAtoms.end(); ++aItr)
                 {
+                    pAtom = m_AtomPtrs[*aItr];
                     // Calc and store the accurate hit radius of the Atom in relation to the CoM
-                    tempVec = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+                    tempVec = m_AtomOffsets[*aItr].GetXFlipped(hFlipped);
                     hitData.hitRadius[HITOR] = tempVec.RadRotate(rotation.GetRadAngle()) *= g_FrameMan.GetMPP();
                     // Figure out the pre-collision velocity of the hitting atom due to body translation and rotation.
                     hitData.hitVel[HITOR] = velocity + tempVec.Perpendicularize() * angVel;
@@ -1314,19 +1444,17 @@ float AtomGroup::Travel(Vector &position,
                     hitData.hitDenominator = (1.0 / distMass) + ((radMag * radMag) / distMI);
                     hitData.preImpulse[HITOR] = hitData.hitVel[HITOR] / hitData.hitDenominator;
                     // Set the atom with the hit data with all the info we have so far.
-                    (*aItr)->SetHitData(hitData);
+                    pAtom->SetHitData(hitData);
 
 //                    float test1 = hitData.preImpulse[HITOR].GetMagnitude();
 
-                    if (g_SceneMan.WillPenetrate((*aItr)->GetCurrentPos().m_X, (*aItr)->GetCurrentPos().m_Y, hitData.preImpulse[HITOR]))
-                    {
+                    if (g_SceneMan.WillPenetrate(pAtom->GetCurrentPos().m_X, pAtom->GetCurrentPos().m_Y, hitData.preImpulse[HITOR]))
                         // Move the penetrating atom to the pen. list from the coll. list.
                         penetratingAtoms.push_back(*aItr);
-                        aItr = hitTerrAtoms.erase(aItr);
-                    }
                     else
-                        ++aItr;
+                        hitTerrAtoms[keptCount++] = *aItr;
                 }
+                hitTerrAtoms.erase(hitTerrAtoms.begin() + keptCount, hitTerrAtoms.end());
             }
             while (!hitTerrAtoms.empty() && !penetratingAtoms.empty());
 
@@ -1342,7 +1470,7 @@ float AtomGroup::Travel(Vector &position,
                 // This is so we aren't intersecting the hit MO anymore.
 //                for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
                 for (aItr = hitTerrAtoms.begin(); aItr != hitTerrAtoms.end(); ++aItr)
-                    (*aItr)->StepBack();
+                    m_AtomPtrs[*aItr]->StepBack();
 
                 // Calculate the distributed mass that each bouncing Atom has.
 //                distMass = mass /*/ (hitTerrAtoms.size() * (m_Resolution ? m_Resolution : 1))*/;
@@ -1352,22 +1480,23 @@ float AtomGroup::Travel(Vector &position,
                 // Gather the collision response effects so that the impulse force can be calculated.
                 for (aItr = hitTerrAtoms.begin(); aItr != hitTerrAtoms.end(); ++aItr)
                 {
-                    (*aItr)->GetHitData().mass[HITOR] = mass;
-                    (*aItr)->GetHitData().momInertia[HITOR] = m_MomInertia;
-                    (*aItr)->GetHitData().impFactor[HITOR] = hitFactor;
+                    pAtom = m_AtomPtrs[*aItr];
+                    pAtom->GetHitData().mass[HITOR] = mass;
+                    pAtom->GetHitData().momInertia[HITOR] = m_MomInertia;
+                    pAtom->GetHitData().impFactor[HITOR] = hitFactor;
 
                     // Get the hitdata so far gathered for this Atom.
 //                  hitData = (*aItr)->GetHitData();
 
                     // Call the call-on-bounce function, if requested.
                     if (m_pOwnerMO && callOnBounce)
-                        halted = halted || m_pOwnerMO->OnBounce((*aItr)->GetHitData());
+                        halted = halted || m_pOwnerMO->OnBounce(pAtom->GetHitData());
 
                     // Copy back the new hit data with all the info we have so far.
 //                  (*aItr)->SetHitData(hitData);
 
                     // Compute and store this Atom's collision response impulse force.
-                    (*aItr)->TerrHitResponse();
+                    pAtom->TerrHitResponse();
                     hitResponseAtoms.push_back(*aItr);
                 }
             }
@@ -1412,11 +1541,12 @@ float AtomGroup::Travel(Vector &position,
 //                  hitData.hitDenominator = (1.0 / distMass) + (hitData.squaredMIHandle[HITOR] / distMI);
 //                  hitData.preImpulse[HITOR] = hitData.hitVel[HITOR] / hitData.hitDenominator;
 
+                    pAtom = m_AtomPtrs[*aItr];
                     // Get the hitdata so far gathered for this Atom.
-                    hitData = (*aItr)->GetHitData();
+                    hitData = pAtom->GetHitData();
 
-                    if (g_SceneMan.TryPenetrate((*aItr)->GetCurrentPos().m_X,
-                                                (*aItr)->GetCurrentPos().m_Y,
+                    if (g_SceneMan.TryPenetrate(pAtom->GetCurrentPos().m_X,
+                                                pAtom->GetCurrentPos().m_Y,
                                                 hitData.preImpulse[HITOR],
                                                 hitData.hitVel[HITOR],
                                                 retardation,
@@ -1440,7 +1570,7 @@ float AtomGroup::Travel(Vector &position,
                             halted = halted || m_pOwnerMO->OnSink(hitData);
 
                         // Copy back the new hit data with all the info we have so far.
-                        (*aItr)->SetHitData(hitData);
+                        pAtom->SetHitData(hitData);
                         // Save the atom for later application of its hit data to the body.
                         hitResponseAtoms.push_back(*aItr);
                     }
@@ -1455,13 +1585,10 @@ float AtomGroup::Travel(Vector &position,
 
                 // Step back all atoms that hit MO:s during this step iteration.
                 // This is so we aren't intersecting the hit MO anymore.
-                for (mapMOItr = hitMOAtoms.begin(); mapMOItr != hitMOAtoms.end(); ++mapMOItr)
-                {
-					for (aItr = (*mapMOItr).second.begin(); aItr != (*mapMOItr).second.end(); ++aItr)
-						(*aItr)->StepBack();
+                for (hitItr = hitMOAtoms.begin(); hitItr != hitMOAtoms.end(); ++hitItr)
+					m_AtomPtrs[(*hitItr).m_AtomIndex]->StepBack();
 //                    for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
 //                      (*aItr)->StepBack();
-                }
 
                 // Set the mass and other data pertaining to the hitor,
                 // aka this AtomGroup's owner MO.
@@ -1469,33 +1596,43 @@ float AtomGroup::Travel(Vector &position,
                 hitData.momInertia[HITOR] = m_MomInertia;
                 hitData.impFactor[HITOR] = 1.0 / (float)atomsHitMOsCount;
 
-                for (mapMOItr = hitMOAtoms.begin(); mapMOItr != hitMOAtoms.end(); ++mapMOItr)
+                // Go through the hit MOs in ascending MOID order, and the Atom:s that hit each in the order they hit it
+                for (moItr = hitMOIDs.begin(); moItr != hitMOIDs.end(); ++moItr)
                 {
                     // The denominator that the MovableObject being hit should
                     // divide its mass with for each atom of this AtomGroup that is
                     // colliding with it during this step.
-                    hitData.impFactor[HITEE] = 1.0 / (float)((*mapMOItr).second.size());
+                    int moHitCount = 0;
+                    for (hitItr = hitMOAtoms.begin(); hitItr != hitMOAtoms.end(); ++hitItr)
+                    {
+                        if ((*hitItr).m_MOID == *moItr)
+                            ++moHitCount;
+                    }
+                    hitData.impFactor[HITEE] = 1.0 / (float)moHitCount;
 
-                    for (aItr = (*mapMOItr).second.begin(); aItr != (*mapMOItr).second.end(); ++aItr)
+                    for (hitItr = hitMOAtoms.begin(); hitItr != hitMOAtoms.end(); ++hitItr)
                     {
+                        if ((*hitItr).m_MOID != *moItr)
+                            continue;
+                        pAtom = m_AtomPtrs[(*hitItr).m_AtomIndex];
 //                      hitData.hitPoint = (*aItr)->GetCurrentPos();
                         // Calc and store the accurate hit radius of the Atom in relation to the CoM
-                        tempVec = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+                        tempVec = m_AtomOffsets[(*hitItr).m_AtomIndex].GetXFlipped(hFlipped);
                         hitData.hitRadius[HITOR] = tempVec.RadRotate(rotation.GetRadAngle()) *= g_FrameMan.GetMPP();
                         // Figure out the pre-collision velocity of the hitting atom due to body translation and rotation.
                         hitData.hitVel[HITOR] = velocity + tempVec.Perpendicularize() * angVel;
                         // Set the atom with the hit data with all the info we have so far.
-                        (*aItr)->SetHitData(hitData);
+                        pAtom->SetHitData(hitData);
                         // Let the atom calc the impulse force resulting from the collision., and only add it if collision is valid
-                        if ((*aItr)->MOHitResponse())
+                        if (pAtom->MOHitResponse())
                         {
                             // Report the hit to both MO's in collision
-                            HitData &hd = (*aItr)->GetHitData();
+                            HitData &hd = pAtom->GetHitData();
                             // Don't count collision if either says tehy got terminated
                             if (!hd.pRootBody[HITOR]->OnMOHit(hd) && !hd.pRootBody[HITEE]->OnMOHit(hd))
                             {
                                 // Save the filled out atom in the list for later application in this step.
-                                hitResponseAtoms.push_back(*aItr);
+                                hitResponseAtoms.push_back((*hitItr).m_AtomIndex);
                             }
                         }
                     }
@@ -1515,7 +1652,7 @@ float AtomGroup::Travel(Vector &position,
             {
 // TODO: Investigate damping!")
 // TODO: Clean up here!#$#$#$#")
-                hitData = (*aItr)->GetHitData();
+                hitData = m_AtomPtrs[*aItr]->GetHitData();
 //                  tempVec = hitData.resImpulse[HITOR];
                 velocity += hitData.resImpulse[HITOR] / mass;
                 angVel += hitData.hitRadius[HITOR].GetPerpendicular().Dot(hitData.resImpulse[HITOR]) / m_MomInertia;
@@ -1567,7 +1704,7 @@ float AtomGroup::Travel(Vector &position,
     // If too many Atom:s are ignoring terrain, make a hole for the body so they won't
     int ignoreCount = 0;
     int maxIgnore = m_Atoms.size() / 2;
-    for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+    for (list<Atom *>::const_iterator aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
     {
         if ((*aItr)->IsIgnoringTerrain())
         {
@@ -1635,18 +1772,21 @@ Vector AtomGroup::PushTravel(Vector &position,
 	Material const * hitMaterial = g_SceneMan.GetMaterialFromID(g_MaterialAir);
 	Material const * domMaterial = g_SceneMan.GetMaterialFromID(g_MaterialAir);
 	Material const * subMaterial = g_SceneMan.GetMaterialFromID(g_MaterialAir);
-    map<MOID, set<Atom *> >MOIgnoreMap;
-    map<MOID, set<Atom *> >::iterator igItr;
-    map<MOID, deque<pair<Atom *, Vector> > > hitMOAtoms;
-    map<MOID, deque<pair<Atom *, Vector> > >::iterator mapItr;
-    deque<pair<Atom *, Vector> > hitTerrAtoms;
-    deque<pair<Atom *, Vector> > penetratingAtoms;
-    deque<pair<Atom *, Vector> >::iterator aoItr;
-    list<Atom *>::iterator aItr;
+    int atom, keptCount;
+    // The hit lists, borrowed from this thread's scratch buffers so nothing is allocated for them here
+    AtomGroupScratchLease scratch;
+    vector<AtomHit> &MOIgnoreHits = scratch->m_IgnoredMOHits;
+    vector<AtomHit>::iterator igItr;
+    vector<AtomHit> &hitMOAtoms = scratch->m_HitMOAtoms;
+    vector<MOID> &hitMOIDs = scratch->m_HitMOIDs;
+    vector<MOID>::iterator moItr;
+    vector<AtomHit> &hitTerrAtoms = scratch->m_HitTerrOffsets;
+    vector<AtomHit> &penetratingAtoms = scratch->m_PenetratingOffsets;
+    vector<AtomHit>::iterator aoItr;
     // First Vector is the impulse force in kg * m/s, the second is force point,
     // or its offset from the origin of the AtomGroup.
-    deque<pair<Vector, Vector> > impulseForces;
-    deque<pair<Vector, Vector> >::iterator ifItr;
+    vector<pair<Vector, Vector> > &impulseForces = scratch->m_ImpulseForces;
+    vector<pair<Vector, Vector> >::iterator ifItr;
 //    deque<Vector> angVelResults;
     Vector rotatedOffset, tempVel, legProgress, forceVel, returnPush;
     MOID tempMOID = g_NoMOID;
@@ -1659,6 +1799,9 @@ Vector AtomGroup::PushTravel(Vector &position,
     didWrap = false;
     newDir = true;
 
+    UpdateAtomArrays();
+    const int atomCount = m_AtomPtrs.size();
+
     // Lock all bitmaps involved outside the loop.
     if (!scenePreLocked)
         g_SceneMan.LockScene();
@@ -1669,9 +1812,9 @@ Vector AtomGroup::PushTravel(Vector &position,
     // prevent MO's from getting stuck in each other.
     if (hitMOs)
     {
-        for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+        for (atom = 0; atom < atomCount; ++atom)
         {
-            rotatedOffset = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+            rotatedOffset = m_AtomOffsets[atom].GetXFlipped(hFlipped);
 //            rotatedOffset.AbsRadRotate(-rotation);
             rotatedOffset.Floor();
             // See if the atom is starting out on top of another MO
@@ -1689,17 +1832,8 @@ before adding them to the MovableMan.
                 if (m_pOwnerMO->m_GeneratingMO && tempMOID == m_pOwnerMO->GetID())
                     leftOwner = false;
 */
-                // Make the appropriate entry in the MO-Atom interaction ignore map
-                if (MOIgnoreMap.end() != (igItr = MOIgnoreMap.find(tempMOID)))
-                    // Found an entry for this MOID, so add the Atom entry to it
-                    (*igItr).second.insert(*aItr);
-                // There wasnt already an entry for this MOID,
-                // so create one and add the Atom to it.
-                else {
-                    set<Atom *> newSet;
-                    newSet.insert(*aItr);
-                    MOIgnoreMap.insert(pair<MOID, set<Atom *> >(tempMOID, newSet));
-                }
+                // Make the appropriate entry in the MO-Atom interaction ignore list
+                MOIgnoreHits.push_back(AtomHit(atom, tempMOID, Vector()));
             }
         }
     }
@@ -1809,12 +1943,13 @@ before adding them to the MovableMan.
             ///////////////////////////////////////////////////////////////////////////////////
 
             hitMOAtoms.clear();
+            hitMOIDs.clear();
             hitTerrAtoms.clear();
 
-            for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+            for (atom = 0; atom < atomCount; ++atom)
             {
 //                  rotatedOffset = (*aItr)->GetOffset().GetYFlipped(hFlipped);
-                rotatedOffset = (*aItr)->GetOffset().GetXFlipped(hFlipped);
+                rotatedOffset = m_AtomOffsets[atom].GetXFlipped(hFlipped);
 //                rotatedOffset.AbsRadRotate(-rotation);
                 rotatedOffset.Floor();
 
@@ -1825,28 +1960,20 @@ before adding them to the MovableMan.
                     tempMOID = g_SceneMan.GetMOIDPixel(intPos[X] + rotatedOffset.m_X,
                                                        intPos[Y] + rotatedOffset.m_Y);
 
-                    // Check the ignore map for Atom:s that should ignore hits against certain MO:s
-                    if (tempMOID != g_NoMOID && (igItr = MOIgnoreMap.find(tempMOID)) != MOIgnoreMap.end())
-                        ignoreHit = (*igItr).second.find(*aItr) != (*igItr).second.end();
+                    // Check the ignore list for Atom:s that should ignore hits against certain MO:s
+                    if (tempMOID != g_NoMOID)
+                    {
+                        for (igItr = MOIgnoreHits.begin(); igItr != MOIgnoreHits.end() && !ignoreHit; ++igItr)
+                            ignoreHit = (*igItr).m_MOID == tempMOID && (*igItr).m_AtomIndex == atom;
+                    }
                 }
 
                 if (hitMOs && tempMOID && !ignoreHit)
                 {
-                    // See if we already have another atom hitting this MO in this step.
-                    mapItr = hitMOAtoms.find(tempMOID);
-                    // If not, then create a new deque unique for that MO's ID
-                    // and insert into the map of MO-hitting Atom:s.
-                    if (mapItr == hitMOAtoms.end())
-                    {
-                        deque<pair<Atom *, Vector> > newDeque;
-                        newDeque.push_back(pair<Atom *, Vector>(*aItr, rotatedOffset));
-                        hitMOAtoms.insert(pair<MOID, deque<pair<Atom *, Vector> > >(tempMOID, newDeque));
-                    }
-                    // If another Atom of this group has already hit this same MO
-                    // during this step, go ahead and add the new atom to the
-                    // corresponding deque for that MOID.
-                    else
-                        ((*mapItr).second).push_back(pair<Atom *, Vector>(*aItr, rotatedOffset));
+                    // Note the hit along with the other MO-hitting Atom:s of this step,
+                    // and keep track of which MOs were hit so they can be responded to in order.
+                    hitMOAtoms.push_back(AtomHit(atom, tempMOID, rotatedOffset));
+                    AddHitMOID(hitMOIDs, tempMOID);
                     // Count the number of Atoms of this group that hit MO:s this step.
                     // Used to properly distribute the mass of the owner MO in later
                     // collision responses during this step.
@@ -1855,7 +1982,7 @@ before adding them to the MovableMan.
                 // If no MO has ever been hit yet during this step, then keep checking for terrain hits.
                 else if (atomsHitMOsCount == 0 && g_SceneMan.GetTerrMatter(intPos[X] + rotatedOffset.m_X,
                                                                            intPos[Y] + rotatedOffset.m_Y))
-                    hitTerrAtoms.push_back(pair<Atom *, Vector>(*aItr, rotatedOffset));
+                    hitTerrAtoms.push_back(AtomHit(atom, g_NoMOID, rotatedOffset));
 /*
 #ifdef DEBUG_BUILD
                 // Draw the positions of the hitpoints on screen for easy debugging.
@@ -1912,24 +2039,34 @@ before adding them to the MovableMan.
 //                                       (m_Resolution ? m_Resolution : 1));
 //                float hiteeMassDenom = 0;
 
-                for (mapItr = hitMOAtoms.begin(); mapItr != hitMOAtoms.end(); ++mapItr)
+                // Go through the hit MOs in ascending MOID order, and the Atom:s that hit each in the order they hit it
+                for (moItr = hitMOIDs.begin(); moItr != hitMOIDs.end(); ++moItr)
                 {
                     // The denominator that the MovableObject being hit should
                     // divide its mass with for each atom of this AtomGroup that is
                     // colliding with it during this step.
-                    hitData.impFactor[HITEE] = 1.0 / (float)((*mapItr).second.size());
+                    int moHitCount = 0;
+                    for (aoItr = hitMOAtoms.begin(); aoItr != hitMOAtoms.end(); ++aoItr)
+                    {
+                        if ((*aoItr).m_MOID == *moItr)
+                            ++moHitCount;
+                    }
+                    hitData.impFactor[HITEE] = 1.0 / (float)moHitCount;
 
-                    for (aoItr = (*mapItr).second.begin(); aoItr != (*mapItr).second.end(); ++aoItr)
+                    for (aoItr = hitMOAtoms.begin(); aoItr != hitMOAtoms.end(); ++aoItr)
                     {
+                        if ((*aoItr).m_MOID != *moItr)
+                            continue;
+
                         // Bake in current Atom's offset into the int positions.
-                        intPos[X] += (*aoItr).second.m_X;
-                        intPos[Y] += (*aoItr).second.m_Y;
-                        hitPos[X] += (*aoItr).second.m_X;
-                        hitPos[Y] += (*aoItr).second.m_Y;
+                        intPos[X] += (*aoItr).m_Offset.m_X;
+                        intPos[Y] += (*aoItr).m_Offset.m_Y;
+                        hitPos[X] += (*aoItr).m_Offset.m_X;
+                        hitPos[Y] += (*aoItr).m_Offset.m_Y;
 
 //                      hitData.hitPoint.SetXY(intPos[X], intPos[Y]);
                         // Calc and store the accurate hit radius of the Atom in relation to the CoM
-                        hitData.hitRadius[HITOR] = (*aoItr).second * g_FrameMan.GetMPP();
+                        hitData.hitRadius[HITOR] = (*aoItr).m_Offset * g_FrameMan.GetMPP();
                         hitData.hitPoint.Reset();
                         hitData.bitmapNormal.Reset();
 
@@ -1969,10 +2106,10 @@ before adding them to the MovableMan.
                         hitData.bitmapNormal.Normalize();
 
                         // Extract the current Atom's offset from the int positions.
-                        intPos[X] -= (*aoItr).second.m_X;
-                        intPos[Y] -= (*aoItr).second.m_Y;
-                        hitPos[X] -= (*aoItr).second.m_X;
-                        hitPos[Y] -= (*aoItr).second.m_Y;
+                        intPos[X] -= (*aoItr).m_Offset.m_X;
+                        intPos[Y] -= (*aoItr).m_Offset.m_Y;
+                        hitPos[X] -= (*aoItr).m_Offset.m_X;
+                        hitPos[Y] -= (*aoItr).m_Offset.m_Y;
 
                         MOID hitMOID = g_SceneMan.GetMOIDPixel(hitData.hitPoint.m_X, hitData.hitPoint.m_Y);
 
@@ -1985,7 +2122,7 @@ before adding them to the MovableMan.
                             hitData.pBody[HITEE]->CollideAtPoint(hitData);
 
                             // Save the impulse force resulting from the MO collision response calc.
-                            impulseForces.push_back(make_pair(hitData.resImpulse[HITOR], (*aoItr).second));
+                            impulseForces.push_back(make_pair(hitData.resImpulse[HITOR], (*aoItr).m_Offset));
                         }
                     }
                 }
@@ -2002,20 +2139,20 @@ before adding them to the MovableMan.
 
                 massDist = mass / hitTerrAtoms.size() * (m_Resolution ? m_Resolution : 1);
 
-                for (aoItr = hitTerrAtoms.begin(); aoItr != hitTerrAtoms.end(); )
+                // Compact the atoms that don't penetrate towards the front, keeping their order
+                keptCount = 0;
+                for (aoItr = hitTerrAtoms.begin(); aoItr != hitTerrAtoms.end(); ++aoItr)
                 {
-                    if (g_SceneMan.WillPenetrate(intPos[X] + (*aoItr).second.m_X,
-                                                 intPos[Y] + (*aoItr).second.m_Y,
+                    if (g_SceneMan.WillPenetrate(intPos[X] + (*aoItr).m_Offset.m_X,
+                                                 intPos[Y] + (*aoItr).m_Offset.m_Y,
                                                  forceVel,
                                                  massDist))
-                    {
                         // Move the penetrating atom to the pen. list from the coll. list.
-                        penetratingAtoms.push_back(pair<Atom *, Vector>((*aoItr).first, (*aoItr).second));
-                        aoItr = hitTerrAtoms.erase(aoItr);
-                    }
+                        penetratingAtoms.push_back(*aoItr);
                     else
-                        ++aoItr;
+                        hitTerrAtoms[keptCount++] = *aoItr;
                 }
+                hitTerrAtoms.erase(hitTerrAtoms.begin() + keptCount, hitTerrAtoms.end());
             } while (!hitTerrAtoms.empty() && !penetratingAtoms.empty());
 
             // TERRAIN BOUNCE //////////////////////////////////////////////////////////////////
@@ -2046,10 +2183,10 @@ before adding them to the MovableMan.
                 for (aoItr = hitTerrAtoms.begin(); aoItr != hitTerrAtoms.end(); ++aoItr)
                 {
                     // Bake in current Atom's offset into the int positions.
-                    intPos[X] += (*aoItr).second.m_X;
-                    intPos[Y] += (*aoItr).second.m_Y;
-                    hitPos[X] += (*aoItr).second.m_X;
-                    hitPos[Y] += (*aoItr).second.m_Y;
+                    intPos[X] += (*aoItr).m_Offset.m_X;
+                    intPos[Y] += (*aoItr).m_Offset.m_Y;
+                    hitPos[X] += (*aoItr).m_Offset.m_X;
+                    hitPos[Y] += (*aoItr).m_Offset.m_Y;
 
                     // Reset the temp velocity response vector to the unaltered velocity.
                     tempVel = forceVel;
@@ -2068,7 +2205,7 @@ before adding them to the MovableMan.
 
                         // Bounce according to the collision.
                         tempVel[dom] = -tempVel[dom] *
-                                       (*aoItr).first->GetMaterial()->restitution *
+                                       m_AtomMaterials[(*aoItr).m_AtomIndex]->restitution *
                                        domMaterial->restitution;
                     }
 
@@ -2083,7 +2220,7 @@ before adding them to the MovableMan.
 
                         // Bounce according to the collision.
                         tempVel[sub] = -tempVel[sub] *
-                                       (*aoItr).first->GetMaterial()->restitution *
+                                       m_AtomMaterials[(*aoItr).m_AtomIndex]->restitution *
                                        subMaterial->restitution;
                     }
 
@@ -2092,32 +2229,32 @@ before adding them to the MovableMan.
                     {
                         hit[dom] = true;
                         tempVel[dom] = -tempVel[dom] *
-                                       (*aoItr).first->GetMaterial()->restitution *
+                                       m_AtomMaterials[(*aoItr).m_AtomIndex]->restitution *
                                        hitMaterial->restitution;
                         hit[sub] = true;
                         tempVel[sub] = -tempVel[sub] *
-                                       (*aoItr).first->GetMaterial()->restitution *
+                                       m_AtomMaterials[(*aoItr).m_AtomIndex]->restitution *
                                        hitMaterial->restitution;
                     }
                     // Calculate the effects of friction.
                     else if (hit[dom] && !hit[sub])
                     {
-                        tempVel[sub] -= tempVel[sub] * (*aoItr).first->GetMaterial()->friction * domMaterial->friction;
+                        tempVel[sub] -= tempVel[sub] * m_AtomMaterials[(*aoItr).m_AtomIndex]->friction * domMaterial->friction;
                     }
                     else if (hit[sub] && !hit[dom])
                     {
-                        tempVel[dom] -= tempVel[dom] * (*aoItr).first->GetMaterial()->friction * subMaterial->friction;
+                        tempVel[dom] -= tempVel[dom] * m_AtomMaterials[(*aoItr).m_AtomIndex]->friction * subMaterial->friction;
                     }
 
                     // Compute and store this Atom's collision response impulse force.
                     impulseForces.push_back(make_pair((tempVel - forceVel) * massDist,
-                                                                      (*aoItr).second));
+                                                                      (*aoItr).m_Offset));
 
                     // Extract the current Atom's offset from the int positions.
-                    intPos[X] -= (*aoItr).second.m_X;
-                    intPos[Y] -= (*aoItr).second.m_Y;
-                    hitPos[X] -= (*aoItr).second.m_X;
-                    hitPos[Y] -= (*aoItr).second.m_Y;
+                    intPos[X] -= (*aoItr).m_Offset.m_X;
+                    intPos[Y] -= (*aoItr).m_Offset.m_Y;
+                    hitPos[X] -= (*aoItr).m_Offset.m_X;
+                    hitPos[Y] -= (*aoItr).m_Offset.m_Y;
                 }
             }
             // TERRAIN SINK ////////////////////////////////////////////////////////////////
@@ -2140,17 +2277,17 @@ before adding them to the MovableMan.
                 // Apply the collision response effects.
                 for (aoItr = penetratingAtoms.begin(); aoItr != penetratingAtoms.end(); ++aoItr)
                 {
-                    if (g_SceneMan.TryPenetrate(intPos[X] + (*aoItr).second.m_X,
-                                                intPos[Y] + (*aoItr).second.m_Y,
+                    if (g_SceneMan.TryPenetrate(intPos[X] + (*aoItr).m_Offset.m_X,
+                                                intPos[Y] + (*aoItr).m_Offset.m_Y,
                                                 forceVel * massDist,
                                                 forceVel,
                                                 retardation,
                                                 1.0,
-                                                (*aoItr).first->GetNumPenetrations()))
+                                                m_AtomPtrs[(*aoItr).m_AtomIndex]->GetNumPenetrations()))
                     {
                         
                         impulseForces.push_back(make_pair(forceVel * massDist * retardation,
-                                                                          (*aoItr).second));
+                                                                          (*aoItr).m_Offset));
                     }
                 }
             }
@@ -2338,12 +2475,14 @@ bool AtomGroup::InTerrain()
     if (!g_SceneMan.SceneIsLocked())
         g_SceneMan.LockScene();
 
+    UpdateAtomArrays();
+
     bool penetrates = false;
     Vector aPos;
 // TODO: UNCOMMENT
-    for (list<Atom *>::iterator aItr = m_Atoms.begin(); aItr != m_Atoms.end() && !penetrates; ++aItr)
+    for (int atom = 0; atom < m_AtomOffsets.size() && !penetrates; ++atom)
     {
-        aPos = (m_pOwnerMO->GetPos() + ((*aItr)->GetOffset().GetXFlipped(m_pOwnerMO->m_HFlipped) * m_pOwnerMO->GetRotMatrix())).GetFloored();
+        aPos = (m_pOwnerMO->GetPos() + (m_AtomOffsets[atom].GetXFlipped(m_pOwnerMO->m_HFlipped) * m_pOwnerMO->GetRotMatrix())).GetFloored();
         if (g_SceneMan.GetTerrMatter(aPos.m_X, aPos.m_Y) != g_MaterialAir)
             penetrates = true;
 /*
@@ -2371,12 +2510,14 @@ float AtomGroup::RatioInTerrain()
 {
     RTEAssert(m_pOwnerMO, "Using an AtomGroup without a parent MO!");
 
+    UpdateAtomArrays();
+
     int inTerrain = 0;
     Vector aPos;
 
-    for (list<Atom *>::iterator aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+    for (int atom = 0; atom < m_AtomOffsets.size(); ++atom)
     {
-        aPos = (m_pOwnerMO->GetPos() + ((*aItr)->GetOffset().GetXFlipped(m_pOwnerMO->m_HFlipped) * m_pOwnerMO->GetRotMatrix())).GetFloored();
+        aPos = (m_pOwnerMO->GetPos() + (m_AtomOffsets[atom].GetXFlipped(m_pOwnerMO->m_HFlipped) * m_pOwnerMO->GetRotMatrix())).GetFloored();
         if (g_SceneMan.GetTerrMatter(aPos.m_X, aPos.m_Y) != g_MaterialAir)
             inTerrain++;
     }
@@ -2395,8 +2536,10 @@ float AtomGroup::RatioInTerrain()
 bool AtomGroup::ResolveTerrainIntersection(Vector &position, Matrix &rotation, unsigned char strongerThan)
 {
     Vector atomOffset, atomPos, atomNormal, clearPos, exitDirection, atomExitVector, totalExitVector;
-    list<Atom *>::iterator aItr;
-    list<Atom *> intersectingAtoms;
+    vector<int>::iterator aItr;
+    // Borrowed from this thread's scratch buffers so nothing is allocated for it here
+    AtomGroupScratchLease scratch;
+    vector<int> &intersectingAtoms = scratch->m_IntersectingAtoms;
     MOID hitMaterial = g_MaterialAir;
     float strengthThreshold = strongerThan != g_MaterialAir ? g_SceneMan.GetMaterialFromID(strongerThan)->strength : 0;
     bool rayHit = false;
@@ -2404,22 +2547,24 @@ bool AtomGroup::ResolveTerrainIntersection(Vector &position, Matrix &rotation, u
     exitDirection.Reset();
     atomExitVector .Reset();
     totalExitVector.Reset();
-    intersectingAtoms.clear();
+
+    UpdateAtomArrays();
+    const int atomCount = m_AtomPtrs.size();
 
     // First go through all atoms to find the first intersection and get the intersected MO
-    for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+    for (int atom = 0; atom < atomCount; ++atom)
     {
-        atomOffset = (*aItr)->GetOffset().GetXFlipped(m_pOwnerMO->IsHFlipped());
+        atomOffset = m_AtomOffsets[atom].GetXFlipped(m_pOwnerMO->IsHFlipped());
         atomOffset *= rotation;
-        (*aItr)->SetupPos(position + atomOffset);
+        m_AtomPtrs[atom]->SetupPos(position + atomOffset);
 
-        atomPos = (*aItr)->GetCurrentPos();
+        atomPos = m_AtomPtrs[atom]->GetCurrentPos();
         if ((hitMaterial = g_SceneMan.GetTerrain()->GetPixel(atomPos.m_X, atomPos.m_Y)) != g_MaterialAir)
         {
             if (strengthThreshold > 0 && g_SceneMan.GetMaterialFromID(hitMaterial)->strength > strengthThreshold)
             {
                 // Add atom to list of intersecting ones
-                intersectingAtoms.push_back(*aItr);
+                intersectingAtoms.push_back(atom);
             }
         }
     }
@@ -2429,12 +2574,12 @@ bool AtomGroup::ResolveTerrainIntersection(Vector &position, Matrix &rotation, u
         return true;
 
     // If all atoms are intersecting, we're screwed?!
-    if (intersectingAtoms.size() >= m_Atoms.size())
+    if (intersectingAtoms.size() >= atomCount)
         return false;
 
     // Go through all intesecting atoms and find their average inverse normal
     for (aItr = intersectingAtoms.begin(); aItr != intersectingAtoms.end(); ++aItr)
-        exitDirection += m_pOwnerMO->RotateOffset((*aItr)->GetNormal());
+        exitDirection += m_pOwnerMO->RotateOffset(m_AtomNormals[*aItr]);
 
     // We don't have a direction to go, so quit
 // TODO: Maybe use previous position to create an exit direction instead then?
@@ -2450,7 +2595,7 @@ bool AtomGroup::ResolveTerrainIntersection(Vector &position, Matrix &rotation, u
     float longestDistance = 0;
     for (aItr = intersectingAtoms.begin(); aItr != intersectingAtoms.end(); ++aItr)
     {
-        atomPos = (*aItr)->GetCurrentPos();
+        atomPos = m_AtomPtrs[*aItr]->GetCurrentPos();
 
         if (strengthThreshold <= 0)
             rayHit = g_SceneMan.CastMaterialRay(atomPos, exitDirection, g_MaterialAir, clearPos, 0, false);
@@ -2499,8 +2644,10 @@ bool AtomGroup::ResolveMOSIntersection(Vector &position, Matrix &rotation)
         return true;
 
     Vector atomOffset, atomPos, atomNormal, clearPos, exitDirection, atomExitVector, totalExitVector;
-    list<Atom *>::iterator aItr;
-    list<Atom *> intersectingAtoms;
+    vector<int>::iterator aItr;
+    // Borrowed from this thread's scratch buffers so nothing is allocated for it here
+    AtomGroupScratchLease scratch;
+    vector<int> &intersectingAtoms = scratch->m_IntersectingAtoms;
     MOID hitMOID = g_NoMOID, currentMOID = g_NoMOID;
     MovableObject *pIntersectedMO = 0;
     MOSRotating *pIntersectedMOS = 0;
@@ -2512,20 +2659,22 @@ bool AtomGroup::ResolveMOSIntersection(Vector &position, Matrix &rotation)
     exitDirection.Reset();
     atomExitVector .Reset();
     totalExitVector.Reset();
-    intersectingAtoms.clear();
+
+    UpdateAtomArrays();
+    const int atomCount = m_AtomPtrs.size();
 
     // First go through all atoms to find the first intersection and get the intersected MO
-    for (aItr = m_Atoms.begin(); aItr != m_Atoms.end() && !pIntersectedMO; ++aItr)
+    for (int atom = 0; atom < atomCount && !pIntersectedMO; ++atom)
     {
-        atomOffset = (*aItr)->GetOffset().GetXFlipped(m_pOwnerMO->IsHFlipped());
+        atomOffset = m_AtomOffsets[atom].GetXFlipped(m_pOwnerMO->IsHFlipped());
         atomOffset *= rotation;
-        (*aItr)->SetupPos(position + atomOffset);
+        m_AtomPtrs[atom]->SetupPos(position + atomOffset);
 
-        atomPos = (*aItr)->GetCurrentPos();
+        atomPos = m_AtomPtrs[atom]->GetCurrentPos();
         if ((hitMOID = g_SceneMan.GetMOIDPixel(atomPos.m_X, atomPos.m_Y)) != g_NoMOID)
         {
             // Don't count MOIDs ignored
-            if (!(*aItr)->IsIgnoringMOID(hitMOID))
+            if (!m_AtomPtrs[atom]->IsIgnoringMOID(hitMOID))
             {
                 // Save the correct MOID to search for other atom intersections with
                 currentMOID = hitMOID;
@@ -2560,13 +2709,13 @@ bool AtomGroup::ResolveMOSIntersection(Vector &position, Matrix &rotation)
         return false;
 
     // Restart and go through all atoms to find all intersecting the specific intersected MO
-    for (aItr = m_Atoms.begin(); aItr != m_Atoms.end(); ++aItr)
+    for (int atom = 0; atom < atomCount; ++atom)
     {
-        atomPos = (*aItr)->GetCurrentPos();
+        atomPos = m_AtomPtrs[atom]->GetCurrentPos();
         if (g_SceneMan.GetMOIDPixel(atomPos.m_X, atomPos.m_Y) == currentMOID)
         {
             // Add atom to list of intersecting ones
-            intersectingAtoms.push_back(*aItr);
+            intersectingAtoms.push_back(atom);
         }
     }
 
@@ -2581,7 +2730,7 @@ bool AtomGroup::ResolveMOSIntersection(Vector &position, Matrix &rotation)
 
     // Go through all intesecting atoms and find their average inverse normal
     for (aItr = intersectingAtoms.begin(); aItr != intersectingAtoms.end(); ++aItr)
-        exitDirection += m_pOwnerMO->RotateOffset((*aItr)->GetNormal());
+        exitDirection += m_pOwnerMO->RotateOffset(m_AtomNormals[*aItr]);
 
     // We don't have a direction to go, so quit
 // TODO: Maybe use previous position to create an exit direction instead then?
@@ -2597,7 +2746,7 @@ bool AtomGroup::ResolveMOSIntersection(Vector &position, Matrix &rotation)
     float longestDistance = 0;
     for (aItr = intersectingAtoms.begin(); aItr != intersectingAtoms.end(); ++aItr)
     {
-        atomPos = (*aItr)->GetCurrentPos();
+        atomPos = m_AtomPtrs[*aItr]->GetCurrentPos();
         if (g_SceneMan.CastFindMORay(atomPos, exitDirection, g_NoMOID, clearPos, 0, true, 0))
         {
             // Determine the longest clearing distance so far
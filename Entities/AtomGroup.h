@@ -158,7 +158,7 @@ ENTITYALLOCATION(AtomGroup)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -438,7 +438,7 @@ ENTITYALLOCATION(AtomGroup)
 //                  The subgroup ID that the new atom will have within the group.
 // Return value:    None.
 
-    void AddAtom(Atom *newAtom, int atomID = 0) { newAtom->SetSubID(atomID); m_Atoms.push_back(newAtom); }
+    void AddAtom(Atom *newAtom, int atomID = 0) { newAtom->SetSubID(atomID); m_Atoms.push_back(newAtom); m_AtomArraysDirty = true; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -703,6 +703,18 @@ ENTITYALLOCATION(AtomGroup)
 private:
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateAtomArrays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Rebuilds the contiguous atom arrays from m_Atoms, if the Atom:s or
+//                  their offsets have changed since they were last built. Has to be
+//                  called before reading the arrays, and not while iterating them.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateAtomArrays();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -728,6 +740,15 @@ private:
     int m_Depth;
     // List of Atoms that constitute the group. Owned by this
     std::list<Atom *> m_Atoms;
+    // Contiguous copies of m_Atoms and of the per-atom data the travel and intersection loops
+    // read, in parallel arrays indexed the same way, in the same order as m_Atoms.
+    // The Atom:s are not owned in here. Only valid after UpdateAtomArrays.
+    std::vector<Atom *> m_AtomPtrs;
+    std::vector<Vector> m_AtomOffsets;
+    std::vector<Vector> m_AtomNormals;
+    std::vector<Material const *> m_AtomMaterials;
+    // Whether m_Atoms or any atom offsets have changed since the arrays above were built
+    bool m_AtomArraysDirty;
     // Sub groupings of atoms, not owned in here. Point to atoms owned in m_Atoms.
 	std::unordered_map<long int, std::list<Atom *> > m_SubGroups;
     // Moment of Inertia for this AtomGroup
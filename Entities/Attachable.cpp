@@ -100,7 +100,7 @@ int Attachable::Create(const Attachable &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Attachable::ReadProperty(std::string propName, Reader &reader)
+int Attachable::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "ParentOffset")
         reader >> m_ParentOffset;
@@ -92,7 +92,7 @@ int BunkerAssemblyScheme::Create(const BunkerAssemblyScheme &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int BunkerAssemblyScheme::ReadProperty(std::string propName, Reader &reader)
+int BunkerAssemblyScheme::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "BitmapFile")
     {
@@ -94,7 +94,7 @@ int Emission::Create(const Emission &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Emission::ReadProperty(std::string propName, Reader &reader)
+int Emission::ReadProperty(const std::string &propName, Reader &reader)
 {
 	if (propName == "EmittedParticle")
 	{
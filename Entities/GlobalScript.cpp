@@ -14,6 +14,7 @@
 #include "GlobalScript.h"
 #include "PresetMan.h"
 #include "LuaMan.h"
+#include "ProfilerMan.h"
 #include "MovableMan.h"
 
 namespace RTE {
@@ -34,6 +35,9 @@ void GlobalScript::Clear()
 	m_pPieMenuActor = 0;
 	m_IsActive = false;
 	m_LateUpdate = false;
+	m_LuaObjectRef = NO_LUA_REF;
+	m_UpdateScriptRef = NO_LUA_REF;
+	m_LuaStateGeneration = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -63,7 +67,7 @@ int GlobalScript::Create(const GlobalScript &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the Reader's position is untouched.
 
-int GlobalScript::ReadProperty(std::string propName, Reader &reader)
+int GlobalScript::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "ScriptPath")
         reader >> m_ScriptPath;
@@ -123,6 +127,8 @@ int GlobalScript::ReloadScripts()
         // Load and run the file, defining all the scripted functions of this Activity
         if ((error = g_LuaMan.RunScriptFile(m_ScriptPath)) < 0)
             return error;
+
+        ResolveScriptReferences();
     }
 
     return error;
@@ -195,6 +201,9 @@ int GlobalScript::Start()
         return error;
 	}
 
+	// StartScript may still have added functions, so only look them up now
+	ResolveScriptReferences();
+
 	return error;
 }
 
@@ -231,8 +240,15 @@ void GlobalScript::End()
 
 void GlobalScript::Update()
 {
-    // Call the defined function, but only after first checking if it exists
-    int error = g_LuaMan.RunScriptString("if " + m_LuaClassName + ".UpdateScript then " + m_LuaClassName + ":UpdateScript(); end");
+    // The references are only good for the Lua state they were made in
+    if (m_LuaStateGeneration != g_LuaMan.GetStateGeneration())
+        ResolveScriptReferences();
+
+    // Only a handful of these run each update, so looking the zone up every time is fine
+    ProfileZone profileZone(g_ProfilerMan.IsCapturing() ? g_ProfilerMan.RegisterZone("Global Script: " + GetPresetName()) : 0);
+
+    // Call the defined function straight through its reference, if it exists
+    int error = g_LuaMan.CallFunctionRef(m_UpdateScriptRef, m_LuaObjectRef);
 	// Kill script on any error to avoid spamming the console with error messages
 	if (error)
 		Deactivate();
@@ -245,9 +261,29 @@ void GlobalScript::Update()
 
 void GlobalScript::Destroy(bool notInherited)
 {
+    g_LuaMan.ReleaseRef(m_UpdateScriptRef, m_LuaStateGeneration);
+    g_LuaMan.ReleaseRef(m_LuaObjectRef, m_LuaStateGeneration);
+
     if (!notInherited)
         Entity::Destroy();
     Clear();
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResolveScriptReferences
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases any existing references into the Lua state and makes new ones
+//                  to the Lua representation of this and its UpdateScript function.
+
+void GlobalScript::ResolveScriptReferences()
+{
+    g_LuaMan.ReleaseRef(m_UpdateScriptRef, m_LuaStateGeneration);
+    g_LuaMan.ReleaseRef(m_LuaObjectRef, m_LuaStateGeneration);
+
+    m_LuaStateGeneration = g_LuaMan.GetStateGeneration();
+    m_LuaObjectRef = g_LuaMan.GetGlobalRef(m_LuaClassName);
+    m_UpdateScriptRef = g_LuaMan.GetFunctionRef(m_LuaObjectRef, "UpdateScript");
+}
+
 } // namespace RTE
\ No newline at end of file
@@ -96,7 +96,7 @@ ENTITYALLOCATION(GlobalScript)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -285,6 +285,12 @@ protected:
 	// Whether the script should Update before MovableMan or after
 	bool m_LateUpdate;
 
+	// Registry references to the Lua representation of this and its UpdateScript function, so they don't have to be looked up every frame
+	int m_LuaObjectRef;
+	int m_UpdateScriptRef;
+	// The generation of the Lua state the above references were made in
+	unsigned int m_LuaStateGeneration;
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
 
@@ -300,6 +306,17 @@ private:
 
     void Clear();
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResolveScriptReferences
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases any existing references into the Lua state and makes new ones
+//                  to the Lua representation of this and its UpdateScript function.
+// Arguments:       None.
+// Return value:    None.
+
+	void ResolveScriptReferences();
+
 };
 
 } // namespace RTE
@@ -152,7 +152,7 @@ int HDFirearm::Create(const HDFirearm &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int HDFirearm::ReadProperty(std::string propName, Reader &reader)
+int HDFirearm::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Magazine")
     {
@@ -149,7 +149,7 @@ int HeldDevice::Create(const HeldDevice &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int HeldDevice::ReadProperty(std::string propName, Reader &reader)
+int HeldDevice::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "HeldDeviceType")
         reader >> m_HeldDeviceType;
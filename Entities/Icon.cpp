@@ -95,7 +95,7 @@ int Icon::Create(const Icon &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Icon::ReadProperty(std::string propName, Reader &reader)
+int Icon::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "BitmapFile")
         reader >> m_BitmapFile;
@@ -145,7 +145,7 @@ int LimbPath::Create(const LimbPath &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int LimbPath::ReadProperty(std::string propName, Reader &reader)
+int LimbPath::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "StartOffset")
         reader >> m_Start;
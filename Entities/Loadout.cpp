@@ -83,7 +83,7 @@ int Loadout::Create(const Loadout &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Loadout::ReadProperty(std::string propName, Reader &reader)
+int Loadout::ReadProperty(const std::string &propName, Reader &reader)
 {
     // Need to load all this stuff without the assumption that it all is available. Mods might have changed etc so things might still not be around, and that's ok.
     if (propName == "DeliveryCraft")
@@ -114,7 +114,7 @@ int MOPixel::Create(const MOPixel &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MOPixel::ReadProperty(std::string propName, Reader &reader)
+int MOPixel::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Color")
         reader >> m_Color;
@@ -139,7 +139,7 @@ ENTITYALLOCATION(MOPixel)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -364,6 +364,18 @@ ENTITYALLOCATION(MOPixel)
     virtual void RestDetection();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  CanUpdateInParallel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether this MO's travel and update only ever touch its own
+//                  state plus read-only scene data, so it can be processed on a worker
+//                  thread alongside others.
+// Arguments:       None.
+// Return value:    Whether this can be travelled and updated in a parallel pass.
+
+    virtual bool CanUpdateInParallel() const { return !m_HitsMOs && !m_GetsHitByMOs && m_ScriptPath.empty(); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  Travel
 //////////////////////////////////////////////////////////////////////////////////////////
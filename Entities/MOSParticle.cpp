@@ -95,7 +95,7 @@ int MOSParticle::Create(const MOSParticle &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MOSParticle::ReadProperty(std::string propName, Reader &reader)
+int MOSParticle::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Atom")
     {
@@ -398,6 +398,7 @@ void MOSParticle::Draw(BITMAP *pTargetBitmap,
                        DrawMode mode,
                        bool onlyPhysical) const
 {
+    LoadSpriteFrames();
     Vector spritePos(m_Pos + m_SpriteOffset - targetPos);
 
     // Draw the requested material sihouette on the material bitmap
@@ -103,7 +103,7 @@ int MOSRotating::Gib::Create(const Gib &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MOSRotating::Gib::ReadProperty(std::string propName, Reader &reader)
+int MOSRotating::Gib::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "GibParticle")
     {
@@ -429,7 +429,7 @@ int MOSRotating::Create(const MOSRotating &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MOSRotating::ReadProperty(std::string propName, Reader &reader)
+int MOSRotating::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "AtomGroup")
     {
@@ -1339,6 +1339,23 @@ void MOSRotating::RestDetection()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  ReleaseSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Lets go of the sprite frames of this and all its Attachables and
+//                  wounds, so they can be unloaded while this isn't being used.
+
+void MOSRotating::ReleaseSpriteFrames()
+{
+    MOSprite::ReleaseSpriteFrames();
+
+    for (list<Attachable *>::iterator aItr = m_AllAttachables.begin(); aItr != m_AllAttachables.end(); ++aItr)
+        (*aItr)->ReleaseSpriteFrames();
+    for (list<AEmitter *>::iterator wItr = m_Wounds.begin(); wItr != m_Wounds.end(); ++wItr)
+        (*wItr)->ReleaseSpriteFrames();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  IsOnScenePoint
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1347,6 +1364,7 @@ void MOSRotating::RestDetection()
 
 bool MOSRotating::IsOnScenePoint(Vector &scenePoint) const
 {
+    LoadSpriteFrames();
     if (!m_aSprite[m_Frame])
         return false;
 // TODO: TAKE CARE OF WRAPPING
@@ -1733,6 +1751,25 @@ bool MOSRotating::DrawMOIDIfOverlapping(MovableObject *pOverlapMO)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetMOIDDrawHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of everything about this that affects what it draws onto
+//                  the MOID layer, not counting any attached children.
+
+unsigned long MOSRotating::GetMOIDDrawHash() const
+{
+    unsigned long hash = MOSprite::GetMOIDDrawHash();
+    // The recoil offset shifts the whole sprite while it's in effect
+    if (m_Recoiled)
+    {
+        hash = HashMOIDDrawFloat(hash, m_RecoilOffset.m_X);
+        hash = HashMOIDDrawFloat(hash, m_RecoilOffset.m_Y);
+    }
+    return HashMOIDDrawValue(hash, m_Recoiled ? 1UL : 0UL);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateChildMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1909,6 +1946,7 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
                        DrawMode mode,
                        bool onlyPhysical) const
 {
+    LoadSpriteFrames();
     RTEAssert(m_aSprite, "No sprite bitmaps loaded to draw!");
     RTEAssert(m_Frame >= 0 && m_Frame < m_FrameCount, "Frame is out of bounds!");
     
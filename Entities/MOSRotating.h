@@ -113,7 +113,7 @@ friend class LuaMan;
     //                  read or not. 0 means it was read successfully, and any nonzero indicates
     //                  that a property of that name could not be found in this or base classes.
 
-        virtual int ReadProperty(std::string propName, Reader &reader);
+        virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -357,7 +357,7 @@ ENTITYALLOCATION(MOSRotating)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -757,6 +757,17 @@ ENTITYALLOCATION(MOSRotating)
     virtual bool IsOnScenePoint(Vector &scenePoint) const;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  ReleaseSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Lets go of the sprite frames of this and all its Attachables and
+//                  wounds, so they can be unloaded while this isn't being used.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void ReleaseSpriteFrames();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  EraseFromTerrain
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -834,6 +845,17 @@ ENTITYALLOCATION(MOSRotating)
     virtual bool DrawMOIDIfOverlapping(MovableObject *pOverlapMO);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetMOIDDrawHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of everything about this that affects what it draws onto
+//                  the MOID layer, not counting any attached children.
+// Arguments:       None.
+// Return value:    The hash of this' current MOID drawing state.
+
+    virtual unsigned long GetMOIDDrawHash() const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  Draw
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1084,6 +1106,18 @@ ENTITYALLOCATION(MOSRotating)
 	virtual void SetTravelImpulse(Vector impulse) { m_TravelImpulse = impulse; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetScreenEffectReach
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how far from this' position the screen effects registered when
+//                  drawing this can reach, including those of anything attached to it.
+//                  Errs on the side of too far.
+// Arguments:       None.
+// Return value:    The reach of this' screen effects, in pixels.
+
+    virtual float GetScreenEffectReach() const { return m_sMaxScreenEffectReach; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
 
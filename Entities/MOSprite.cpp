@@ -31,6 +31,7 @@ void MOSprite::Clear()
 {
     m_SpriteFile.Reset();
     m_aSprite = 0;
+    m_ReferencedFrameCount = 0;
     m_FrameCount = 1;
     m_SpriteOffset.Reset();
     m_Frame = 0;
@@ -63,8 +64,8 @@ int MOSprite::Create()
         return -1;
 
     // Post-process reading
-    delete [] m_aSprite;
-    m_aSprite = m_SpriteFile.GetAsAnimation(m_FrameCount);
+    ClearSpriteFrames();
+    LoadSpriteFrames();
 
     if (m_aSprite && m_aSprite[0])
     {
@@ -103,8 +104,8 @@ int MOSprite::Create(ContentFile spriteFile,
 
     m_SpriteFile = spriteFile;
     m_FrameCount = frameCount;
-    delete [] m_aSprite;
-    m_aSprite = m_SpriteFile.GetAsAnimation(m_FrameCount);
+    ClearSpriteFrames();
+    LoadSpriteFrames();
     m_SpriteOffset = Vector(-m_aSprite[0]->w / 2, -m_aSprite[0]->h / 2);
 
     m_HFlipped = false;
@@ -128,21 +129,33 @@ int MOSprite::Create(const MOSprite &reference)
 {
     MovableObject::Create(reference);
 
-    if (!reference.m_aSprite)
-        return -1;
-
     m_SpriteFile = reference.m_SpriteFile;
 
     m_FrameCount = reference.m_FrameCount;
     m_Frame = reference.m_Frame;
-    // Allocate a new array of pointers (owned by this),
-    // and copy the pointers' values themselves over by shallow copy (the BITMAPs are not owned by this)
-    delete [] m_aSprite;
-    m_aSprite = new BITMAP *[m_FrameCount];
-    for (int i = 0; i < m_FrameCount; ++i)
+    ClearSpriteFrames();
+    if (reference.m_aSprite)
     {
-        m_aSprite[i] = reference.m_aSprite[i];
+        // Allocate a new array of pointers (owned by this),
+        // and copy the pointers' values themselves over by shallow copy (the BITMAPs are not owned by this)
+        m_aSprite = new BITMAP *[m_FrameCount];
+        for (int i = 0; i < m_FrameCount; ++i)
+        {
+            m_aSprite[i] = reference.m_aSprite[i];
+        }
+        // Hold on to the frames the same way the reference does
+        if (reference.m_ReferencedFrameCount > 0)
+        {
+            ContentFile::AcquireBitmaps(m_aSprite, m_FrameCount);
+            m_ReferencedFrameCount = m_FrameCount;
+        }
     }
+    // The reference let go of its frames, so this is the first use of them in a while
+    else
+        LoadSpriteFrames();
+
+    if (!m_aSprite)
+        return -1;
 
     m_SpriteOffset = reference.m_SpriteOffset;
     m_SpriteAnimMode = reference.m_SpriteAnimMode;
@@ -171,7 +184,7 @@ int MOSprite::Create(const MOSprite &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MOSprite::ReadProperty(std::string propName, Reader &reader)
+int MOSprite::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "SpriteFile")
         reader >> m_SpriteFile;
@@ -311,7 +324,7 @@ int MOSprite::Save(Writer &writer) const
 void MOSprite::Destroy(bool notInherited)
 {
     //  Delete only the array of pointers, not the BITMAP:s themselves... owned by static contentfile maps
-    delete[] m_aSprite;
+    ClearSpriteFrames();
 //    delete m_pEntryWound; Not doing this anymore since we're not owning
 //    delete m_pExitWound;
 
@@ -321,6 +334,45 @@ void MOSprite::Destroy(bool notInherited)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LoadSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Loads the sprite frames of this from its sprite file, if they aren't
+//                  already.
+
+void MOSprite::LoadSpriteFrames() const
+{
+    if (m_aSprite)
+        return;
+
+    // GetAs methods aren't const since they use the path of the file to step through animation frames
+    ContentFile spriteFile(m_SpriteFile);
+    if (g_SettingsMan.LoadSpritesOnDemand())
+    {
+        m_aSprite = spriteFile.GetAsReferencedAnimation(m_FrameCount);
+        m_ReferencedFrameCount = m_aSprite ? m_FrameCount : 0;
+    }
+    else
+        m_aSprite = spriteFile.GetAsAnimation(m_FrameCount);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases any references to the sprite frames of this and deletes the
+//                  array of them.
+
+void MOSprite::ClearSpriteFrames()
+{
+    if (m_aSprite && m_ReferencedFrameCount > 0)
+        ContentFile::ReleaseBitmaps(m_aSprite, m_ReferencedFrameCount);
+    delete [] m_aSprite;
+    m_aSprite = 0;
+    m_ReferencedFrameCount = 0;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SetFrame
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -363,6 +415,7 @@ bool MOSprite::SetNextFrame()
 
 bool MOSprite::IsOnScenePoint(Vector &scenePoint) const
 {
+    LoadSpriteFrames();
     if (!m_aSprite[m_Frame])
         return false;
 // TODO: TAKE CARE OF WRAPPING
@@ -512,6 +565,7 @@ void MOSprite::Draw(BITMAP *pTargetBitmap,
                     DrawMode mode,
                     bool onlyPhysical) const
 {
+    LoadSpriteFrames();
     if (!m_aSprite[m_Frame])
         RTEAbort("Sprite frame pointer is null when drawing MOSprite!");
 
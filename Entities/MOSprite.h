@@ -135,7 +135,7 @@ ENTITYALLOCATION(MOSprite)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -243,7 +243,7 @@ ENTITYALLOCATION(MOSprite)
 // Return value:    A pointer to the requested frame of this MOSprite's BITMAP array.
 //                  Ownership is NOT transferred!
 
-    BITMAP * GetSpriteFrame(int whichFrame = 0) const { return (whichFrame >= 0 && whichFrame < m_FrameCount) ? m_aSprite[whichFrame] : 0; }
+    BITMAP * GetSpriteFrame(int whichFrame = 0) const { LoadSpriteFrames(); return (whichFrame >= 0 && whichFrame < m_FrameCount) ? m_aSprite[whichFrame] : 0; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -253,7 +253,7 @@ ENTITYALLOCATION(MOSprite)
 // Arguments:       0.
 // Return value:    Sprite width if loaded.
 
-    int GetSpriteWidth() const { return m_aSprite[0] ? m_aSprite[0]->w : 0; }
+    int GetSpriteWidth() const { LoadSpriteFrames(); return m_aSprite[0] ? m_aSprite[0]->w : 0; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -263,7 +263,7 @@ ENTITYALLOCATION(MOSprite)
 // Arguments:       0.
 // Return value:    Sprite height if loaded.
 
-    int GetSpriteHeight() const { return m_aSprite[0] ? m_aSprite[0]->h : 0; }
+    int GetSpriteHeight() const { LoadSpriteFrames(); return m_aSprite[0] ? m_aSprite[0]->h : 0; }
 
 
 
@@ -445,7 +445,19 @@ ENTITYALLOCATION(MOSprite)
 // Return value:    A good identifyable graphical representation of this in a BITMAP, if
 //                  available. If not, 0 is returned. Ownership is NOT TRANSFERRED!
 
-    virtual BITMAP * GetGraphicalIcon() { return m_aSprite[0]; }
+    virtual BITMAP * GetGraphicalIcon() { LoadSpriteFrames(); return m_aSprite[0]; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  ReleaseSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Lets go of the sprite frames of this, so they can be unloaded while
+//                  this isn't being used. They're loaded again as soon as anything
+//                  needs them. Only makes a difference when loading sprites on demand.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void ReleaseSpriteFrames() { ClearSpriteFrames(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -614,6 +626,17 @@ ENTITYALLOCATION(MOSprite)
                       bool onlyPhysical = false) const = 0;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetMOIDDrawHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of everything about this that affects what it draws onto
+//                  the MOID layer, not counting any attached children.
+// Arguments:       None.
+// Return value:    The hash of this' current MOID drawing state.
+
+    virtual unsigned long GetMOIDDrawHash() const { return HashMOIDDrawValue(MovableObject::GetMOIDDrawHash(), m_Frame); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  GetFlipFactor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -637,8 +660,10 @@ protected:
     float m_AngularVel; // The angular velocity by which this MovableObject rotates, in radians per second (r/s).
     float m_PrevAngVel; // Previous frame's angular velocity.
     ContentFile m_SpriteFile;
-    // Array of pointers to BITMAP:s representing the multiple frames of this sprite
-    BITMAP **m_aSprite;
+    // Array of pointers to BITMAP:s representing the multiple frames of this sprite. Loaded lazily if 0
+    mutable BITMAP **m_aSprite;
+    // How many of the frames in m_aSprite are referenced through the ContentFile, and need releasing. 0 if they're kept loaded for good
+    mutable unsigned int m_ReferencedFrameCount;
     // Number of frames, or elements in the m_aSprite array.
     unsigned int m_FrameCount;
     Vector m_SpriteOffset;
@@ -667,6 +692,29 @@ protected:
     const AEmitter *m_pExitWound;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LoadSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Loads the sprite frames of this from its sprite file, if they aren't
+//                  already. When loading sprites on demand, the frames are referenced
+//                  so they stay loaded until this lets go of them.
+// Arguments:       None.
+// Return value:    None.
+
+    void LoadSpriteFrames() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearSpriteFrames
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases any references to the sprite frames of this and deletes the
+//                  array of them, leaving them to be loaded again when next needed.
+// Arguments:       None.
+// Return value:    None.
+
+    void ClearSpriteFrames();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
 
@@ -122,7 +122,7 @@ int Round::Create(const Round &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Round::ReadProperty(std::string propName, Reader &reader)
+int Round::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "ParticleCount")
         reader >> m_ParticleCount;
@@ -317,7 +317,7 @@ int Magazine::Create(const Magazine &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Magazine::ReadProperty(std::string propName, Reader &reader)
+int Magazine::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "RoundCount")
     {
@@ -102,7 +102,7 @@ int Material::Create(const Material &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Material::ReadProperty(std::string propName, Reader &reader)
+int Material::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Index")
     {
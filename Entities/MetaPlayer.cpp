@@ -99,7 +99,7 @@ int MetaPlayer::Create(const MetaPlayer &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MetaPlayer::ReadProperty(std::string propName, Reader &reader)
+int MetaPlayer::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Name")
         reader >> m_Name;
@@ -23,6 +23,7 @@ namespace RTE {
 ABSTRACTCLASSINFO(MovableObject, SceneObject)
 
 unsigned long int MovableObject::m_UniqueIDCounter = 1;
+float MovableObject::m_sMaxScreenEffectReach = 0;
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
@@ -73,7 +74,9 @@ void MovableObject::Clear()
     m_HUDVisible = true;
     m_ScriptPath.clear();
     m_ScriptPresetName.clear();
-    m_ScriptObjectName.clear();
+    m_pScriptCallbacks = 0;
+    m_ScriptObjectRef = NO_LUA_REF;
+    m_ScriptStateGeneration = 0;
     m_ScreenEffectFile.Reset();
     m_pScreenEffect = 0;
 	m_EffectRotAngle = 0;
@@ -208,7 +211,7 @@ int MovableObject::Create(const MovableObject &reference)
     m_ScriptPath = reference.m_ScriptPath;
     m_ScriptPresetName = reference.m_ScriptPresetName;
     // Should be unique to the object, will be created lazily upon first UpdateScript
-//    m_ScriptObjectName
+//    m_ScriptObjectRef
     if (reference.m_pScreenEffect)
     {
         m_ScreenEffectFile = reference.m_ScreenEffectFile;
@@ -259,7 +262,7 @@ int MovableObject::Create(const MovableObject &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MovableObject::ReadProperty(std::string propName, Reader &reader)
+int MovableObject::ReadProperty(const std::string &propName, Reader &reader)
 {
 	if (propName == "Mass")
 	{
@@ -338,6 +341,7 @@ int MovableObject::ReadProperty(std::string propName, Reader &reader)
         reader >> m_ScreenEffectFile;
         m_pScreenEffect = m_ScreenEffectFile.GetAsBitmap();
 		m_ScreenEffectHash = m_ScreenEffectFile.GetHash();
+        m_sMaxScreenEffectReach = MAX(m_sMaxScreenEffectReach, MovableObject::GetScreenEffectReach());
     }
     else if (propName == "EffectStartTime")
         reader >> m_EffectStartTime;
@@ -457,14 +461,11 @@ int MovableObject::Save(Writer &writer) const
 
 void MovableObject::Destroy(bool notInherited)
 {
-    // Clean up the existence of this in the script state
-    if (!m_ScriptObjectName.empty())
-    {
-        // Call the scripted destruction function, but only after first checking if it and this instance's Lua representation really exists
-        g_LuaMan.RunScriptString("if " + m_ScriptPresetName + " and " + m_ScriptPresetName + ".Destroy and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Destroy(" + m_ScriptObjectName + "); end");
-        // Assign nil to the variable that held this' representation in Lua
-        g_LuaMan.RunScriptString("if " + m_ScriptObjectName + " then " + m_ScriptObjectName + " = nil; end");
-    }
+    // Clean up the existence of this in the script state, if it still is the one this' representation was created in
+    if (m_ScriptObjectRef != NO_LUA_REF && m_pScriptCallbacks && m_ScriptStateGeneration == g_LuaMan.GetStateGeneration())
+        g_LuaMan.CallFunctionRef(m_pScriptCallbacks->m_FunctionRefs[LuaMan::CALLBACK_DESTROY], m_ScriptObjectRef);
+    // Let go of this' representation in Lua
+    ClearScriptReferences();
 
     if (!notInherited)
         SceneObject::Destroy();
@@ -502,11 +503,14 @@ int MovableObject::LoadScripts(string scriptPath)
     if ((error = g_LuaMan.RunScriptString("if not " + GetClassName() + "s then " + GetClassName() + "s = {}; end")) < 0)
         return error;
 // TODO WAIT A MINUTE.. is this an original preset????!! .. does it matter? A: not really
+    // The functions resolved for the old preset can go once everything still running them is gone
+    if (!m_ScriptPresetName.empty())
+        g_LuaMan.SupersedePresetCallbacks(m_ScriptPresetName);
     // Get a new ID for this original preset so we can assign the read-in function definitions to it
     m_ScriptPresetName = GetClassName() + "s." + g_LuaMan.GetNewPresetID();
 
-    // Clear out the instance object name so it gets created in the state upon first UpdateScript
-    m_ScriptObjectName.clear();
+    // Clear out the instance object and the resolved functions of the old preset so they get created in the state upon first UpdateScript
+    ClearScriptReferences();
 
     // Under the class' table, create a new table for all functions of this specific preset and its unique ID
     if ((error = g_LuaMan.RunScriptString(m_ScriptPresetName + " = {};")) < 0)
@@ -825,34 +829,76 @@ int MovableObject::UpdateScript()
 
     int error = 0;
 
-    // Check to make sure the preset of this is still defined in the Lua state. If not, re-create it and recover gracefully
-    if (!g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false))
-        ReloadScripts();
-
     // First see if we even have a representation stored in the Lua state, and if not, create one
-    if (m_ScriptObjectName.empty())
+    if ((error = PrepareScriptObject()) < 0)
+        return error;
+
+    // Call the defined function straight through its reference, if it and this instance's Lua representation exist
+    ProfileZone profileZone(m_pScriptCallbacks->m_ProfilerZoneIDs[LuaMan::CALLBACK_UPDATE]);
+    if ((error = g_LuaMan.CallFunctionRef(m_pScriptCallbacks->m_FunctionRefs[LuaMan::CALLBACK_UPDATE], m_ScriptObjectRef)) < 0)
+        return error;
+
+    return error;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrepareScriptObject
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes sure this' preset functions are resolved and that this has a
+//                  representation in the Lua state, creating it and calling the scripted
+//                  Create function the first time around.
+
+int MovableObject::PrepareScriptObject()
+{
+    // The references are only good for the Lua state they were made in, so drop them if it has been recreated since
+    if (m_ScriptStateGeneration != g_LuaMan.GetStateGeneration())
     {
-        // Get the unique object identifier for this object and construct the object isntance name in Lua that points to this object so we can pass it into the preset functions
-        m_ScriptObjectName = GetClassName() + "s." + g_LuaMan.GetNewObjectID();
+        ClearScriptReferences();
+        m_ScriptStateGeneration = g_LuaMan.GetStateGeneration();
+    }
 
-        // Give access to this in the Lua state
-        g_MovableMan.SetScriptedEntity(this);
-        // Create the Lua variable which will hold the object instance of this instance for as long as it exists
-        if ((error = g_LuaMan.RunScriptString(m_ScriptObjectName + " = To" + GetClassName() + "(MovableMan.ScriptedEntity);")) < 0)
-            return error;
+    if (!m_pScriptCallbacks)
+    {
+        // Check to make sure the preset of this is still defined in the Lua state. If not, re-create it and recover gracefully
+        if (!(m_pScriptCallbacks = g_LuaMan.GetPresetCallbacks(m_ScriptPresetName, GetPresetName())))
+        {
+            ReloadScripts();
+            if (!(m_pScriptCallbacks = g_LuaMan.GetPresetCallbacks(m_ScriptPresetName, GetPresetName())))
+                return -1;
+        }
+    }
 
-        // Call the scripted creation function, but only after first checking if it and this instance's Lua representation really exists
-        if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".Create and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Create(" + m_ScriptObjectName + "); end")) < 0)
+    int error = 0;
+
+    if (m_ScriptObjectRef == NO_LUA_REF)
+    {
+        // Create the Lua representation of this instance, which is held on to for as long as this exists
+        if ((m_ScriptObjectRef = g_LuaMan.CreateEntityProxyRef(this, GetClassName())) == NO_LUA_REF)
+            return -1;
+
+        // Call the scripted creation function, if it's defined
+        if ((error = g_LuaMan.CallFunctionRef(m_pScriptCallbacks->m_FunctionRefs[LuaMan::CALLBACK_CREATE], m_ScriptObjectRef)) < 0)
             return error;
     }
 
-    // Call the defined function, but only after first checking if it and this instance's Lua representation exists
-    if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".Update and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".Update(" + m_ScriptObjectName + "); end")) < 0)
-        return error;
-
     return error;
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearScriptReferences
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases this' references into the Lua state, so they get resolved and
+//                  created anew next time they're needed.
+
+void MovableObject::ClearScriptReferences()
+{
+    // The preset functions are owned by LuaMan and shared between instances, it lets go of them once no one uses them
+    g_LuaMan.ReleasePresetCallbacks(m_pScriptCallbacks, m_ScriptStateGeneration);
+    g_LuaMan.ReleaseRef(m_ScriptObjectRef, m_ScriptStateGeneration);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  OnPieMenu
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -867,14 +913,14 @@ int MovableObject::OnPieMenu(Actor * pActor)
 	if (m_ScriptPath.empty() || m_ScriptPresetName.empty())
 		return -1;
 
-	if (m_ScriptObjectName.empty())
+	if (m_ScriptObjectRef == NO_LUA_REF || !m_pScriptCallbacks || m_ScriptStateGeneration != g_LuaMan.GetStateGeneration())
 		return -1;
 
 	m_pPieMenuActor = pActor;
 
 	int error = 0;
 
-	if ((error = g_LuaMan.RunScriptString("if " + m_ScriptPresetName + ".OnPieMenu and " + m_ScriptObjectName + " then " + m_ScriptPresetName + ".OnPieMenu(" + m_ScriptObjectName + "); end")) < 0)
+	if ((error = g_LuaMan.CallFunctionRef(m_pScriptCallbacks->m_FunctionRefs[LuaMan::CALLBACK_ONPIEMENU], m_ScriptObjectRef)) < 0)
 		return error;
 
 	return error;
@@ -907,6 +953,24 @@ void MovableObject::UpdateMOID(vector<MovableObject *> &MOIDIndex,
 
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetMOIDDrawHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of everything about this that affects what it draws onto
+//                  the MOID layer, not counting any attached children.
+
+unsigned long MovableObject::GetMOIDDrawHash() const
+{
+    unsigned long hash = HashMOIDDrawValue(2166136261UL, static_cast<unsigned long>(m_UniqueID));
+    hash = HashMOIDDrawValue(hash, static_cast<unsigned long>(m_MOID));
+    hash = HashMOIDDrawFloat(hash, m_Pos.m_X);
+    hash = HashMOIDDrawFloat(hash, m_Pos.m_Y);
+    hash = HashMOIDDrawFloat(hash, m_Scale);
+    hash = HashMOIDDrawFloat(hash, GetRotAngle());
+    return HashMOIDDrawValue(hash, IsHFlipped() ? 1UL : 0UL);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  GetMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,7 @@
 #include "Timer.h"
 #include "Material.h"
 #include "MovableMan.h"
+#include "LuaMan.h"
 
 struct BITMAP;
 
@@ -142,7 +143,7 @@ ENTITYALLOCATION(MovableObject)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -614,6 +615,18 @@ ENTITYALLOCATION(MovableObject)
     BITMAP * GetScreenEffect() const { return m_pScreenEffect; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetScreenEffectReach
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how far from this' position the screen effects registered when
+//                  drawing this can reach, including those of anything attached to it.
+//                  Errs on the side of too far.
+// Arguments:       None.
+// Return value:    The reach of this' screen effects, in pixels.
+
+    virtual float GetScreenEffectReach() const { return m_pScreenEffect ? 0.5F * sqrtf(static_cast<float>(m_pScreenEffect->w * m_pScreenEffect->w + m_pScreenEffect->h * m_pScreenEffect->h)) : 0; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetScreenEffectHash
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1121,6 +1134,19 @@ ENTITYALLOCATION(MovableObject)
     virtual void RestDetection();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  CanUpdateInParallel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether this MO's travel and update only ever touch its own
+//                  state plus read-only scene data, so it can be processed on a worker
+//                  thread alongside others. Writes to the scene it makes while doing so
+//                  must go through ThreadMan::DeferCommand.
+// Arguments:       None.
+// Return value:    Whether this can be travelled and updated in a parallel pass.
+
+    virtual bool CanUpdateInParallel() const { return false; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  NotResting
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1502,6 +1528,18 @@ ENTITYALLOCATION(MovableObject)
     virtual bool DrawMOIDIfOverlapping(MovableObject *pOverlapMO) { return false; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetMOIDDrawHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a hash of everything about this that affects what it draws onto
+//                  the MOID layer, not counting any attached children. If it is the same
+//                  as when this was last drawn there, so is the drawn silhouette.
+// Arguments:       None.
+// Return value:    The hash of this' current MOID drawing state.
+
+    virtual unsigned long GetMOIDDrawHash() const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  DrawHUD
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1705,6 +1743,29 @@ ENTITYALLOCATION(MovableObject)
 protected:
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   HashMOIDDrawValue
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Mixes a value into a MOID draw state hash, FNV-1a style.
+// Arguments:       The hash so far.
+//                  The value to mix in.
+// Return value:    The new hash.
+
+    static unsigned long HashMOIDDrawValue(unsigned long hash, unsigned long value) { return (hash ^ value) * 16777619UL; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   HashMOIDDrawFloat
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Mixes the exact bits of a float into a MOID draw state hash, so even
+//                  sub-pixel changes that may affect rotated drawing are noticed.
+// Arguments:       The hash so far.
+//                  The value to mix in.
+// Return value:    The new hash.
+
+    static unsigned long HashMOIDDrawFloat(unsigned long hash, float value) { unsigned int bits; memcpy(&bits, &value, sizeof(bits)); return HashMOIDDrawValue(hash, bits); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateChildMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1738,6 +1799,30 @@ protected:
                          MOID rootMOID = g_NoMOID,
                          bool makeNewMOID = true);
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrepareScriptObject
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes sure this' preset functions are resolved and that this has a
+//                  representation in the Lua state, creating it and calling the scripted
+//                  Create function the first time around.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int PrepareScriptObject();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearScriptReferences
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases this' references into the Lua state, so they get resolved and
+//                  created anew next time they're needed.
+// Arguments:       None.
+// Return value:    None.
+
+    void ClearScriptReferences();
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor:     MovableObject
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1753,6 +1838,8 @@ protected:
     static Entity::ClassInfo m_sClass;
 	// Global counter with unique ID's
 	static unsigned long int m_UniqueIDCounter;
+    // The largest GetScreenEffectReach of any screen effect loaded so far
+    static float m_sMaxScreenEffectReach;
     // The type of MO this is, either Actor, Item, or Particle
     int m_MOType;
     float m_Mass; // In metric kilograms (kg).
@@ -1835,8 +1922,12 @@ protected:
     std::string m_ScriptPath;
     // The ID name unique to this' preset and its defined scripted functions in the lua state.
     std::string m_ScriptPresetName;
-    // The ID name unique to this' object instance representation in the Lua state.
-    std::string m_ScriptObjectName;
+    // The resolved functions of this' preset in the Lua state, shared by all instances of it. Not owned.
+    const LuaMan::PresetCallbacks *m_pScriptCallbacks;
+    // The registry reference to this' object instance representation in the Lua state.
+    int m_ScriptObjectRef;
+    // The generation of the Lua state the above were resolved and created in.
+    unsigned int m_ScriptStateGeneration;
 
     // Special post processing flash effect file and Bitmap. Shuold be loaded from a 32bpp bitmap
     ContentFile m_ScreenEffectFile;
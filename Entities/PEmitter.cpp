@@ -115,7 +115,7 @@ namespace RTE {
 	//                  is called. If the property isn't recognized by any of the base classes,
 	//                  false is returned, and the reader's position is untouched.
 
-	int PEmitter::ReadProperty(std::string propName, Reader &reader)
+	int PEmitter::ReadProperty(const std::string &propName, Reader &reader)
 	{
 		if (propName == "AddEmission")
 		{
@@ -98,7 +98,7 @@ public:
 	//                  read or not. 0 means it was read successfully, and any nonzero indicates
 	//                  that a property of that name could not be found in this or base classes.
 
-	virtual int ReadProperty(std::string propName, Reader &reader);
+	virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 	//////////////////////////////////////////////////////////////////////////////////////////
@@ -508,6 +508,17 @@ public:
 	virtual void Update();
 
 
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Virtual method:  CanUpdateInParallel
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Description:     Indicates whether this can be processed in a parallel pass. Emitters
+	//                  spawn particles and play sounds during their update, so never.
+	// Arguments:       None.
+	// Return value:    Whether this can be travelled and updated in a parallel pass.
+
+	virtual bool CanUpdateInParallel() const { return false; }
+
+
 	//////////////////////////////////////////////////////////////////////////////////////////
 	// Virtual method:  Draw
 	//////////////////////////////////////////////////////////////////////////////////////////
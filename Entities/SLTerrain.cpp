@@ -22,6 +22,8 @@
 #include "MOSprite.h"
 #include "Atom.h"
 
+#include <emmintrin.h>
+
 namespace RTE {
 
 CONCRETECLASSINFO(SLTerrain, SceneLayer, 0)
@@ -35,6 +37,58 @@ BITMAP * SLTerrain::m_spTempBitmap256 = 0;
 BITMAP * SLTerrain::m_spTempBitmap512 = 0;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Finds the first pixel in a row, from start up to end, that isn't a specific value.
+// Compares 16 pixels at a time so empty stretches are skipped quickly. Returns end if all
+// of them are that value.
+
+static int FindFirstNotOf(const unsigned char *pRow, int start, int end, unsigned char value)
+{
+    const __m128i values = _mm_set1_epi8(static_cast<char>(value));
+    while (start + 16 <= end && _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pRow + start)), values)) == 0xFFFF)
+        start += 16;
+    while (start < end && pRow[start] == value)
+        ++start;
+    return start;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Finds the first pixel in a row, from start up to end, that is either of two values.
+// Compares 16 pixels at a time so stretches without them are skipped quickly. Returns end
+// if there are none.
+
+static int FindFirstOfEither(const unsigned char *pRow, int start, int end, unsigned char firstValue, unsigned char secondValue)
+{
+    const __m128i firstValues = _mm_set1_epi8(static_cast<char>(firstValue));
+    const __m128i secondValues = _mm_set1_epi8(static_cast<char>(secondValue));
+    while (start + 16 <= end)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pRow + start));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(pixels, firstValues), _mm_cmpeq_epi8(pixels, secondValues))) != 0)
+            break;
+        start += 16;
+    }
+    while (start < end && pRow[start] != firstValue && pRow[start] != secondValue)
+        ++start;
+    return start;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Turns all cavity pixels in a stretch of a material layer row into air, and clears the
+// color layer row wherever there's air. Only the air and cavity pixels are visited.
+
+static void CleanAirRun(unsigned char *pMatRow, unsigned char *pColorRow, int start, int end)
+{
+    for (int x = FindFirstOfEither(pMatRow, start, end, g_MaterialAir, g_MaterialCavity); x < end; x = FindFirstOfEither(pMatRow, x + 1, end, g_MaterialAir, g_MaterialCavity))
+    {
+        pMatRow[x] = g_MaterialAir;
+        pColorRow[x] = g_KeyColor;
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -90,7 +144,7 @@ int SLTerrain::TerrainFrosting::Create(const TerrainFrosting &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int SLTerrain::TerrainFrosting::ReadProperty(std::string propName, Reader &reader)
+int SLTerrain::TerrainFrosting::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "TargetMaterial")
         reader >> m_TargetMaterial;
@@ -577,7 +631,7 @@ int SLTerrain::ClearData()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int SLTerrain::ReadProperty(std::string propName, Reader &reader)
+int SLTerrain::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "BackgroundTexture")
         reader >> m_BGTextureFile;
@@ -785,21 +839,29 @@ unsigned char SLTerrain::GetMaterialPixel(const int pixelX, const int pixelY) co
 {
     int posX = pixelX;
     int posY = pixelY;
+    int width = m_pMainBitmap->w;
+    int height = m_pMainBitmap->h;
 
-    WrapPosition(posX, posY);
-
-    // If it's still below or to the sides out of bounds after
-    // wrapping what is supposed to be wrapped, shit is out of bounds.
-    if (posX < 0 || posX >= m_pMainBitmap->w || posY >= m_pMainBitmap->h)
-//        return g_MaterialOutOfBounds;
-        return g_MaterialAir;
+    // Wrap right here instead of through WrapPosition, this gets called for a lot of pixels. The terrain is never scaled, so the bitmap dimensions are the ones to wrap to
+    if (m_WrapX && (posX < 0 || posX >= width))
+    {
+        posX %= width;
+        if (posX < 0)
+            posX += width;
+    }
+    if (m_WrapY && (posY < 0 || posY >= height))
+    {
+        posY %= height;
+        if (posY < 0)
+            posY += height;
+    }
 
-    // If above terrain bitmap, return air material.
-    if (posY < 0)
+    // If it's still out of bounds after wrapping what is supposed to be wrapped, it's air
+    if (posX < 0 || posX >= width || posY < 0 || posY >= height)
         return g_MaterialAir;
 
 //    RTEAssert(m_pMainBitmap->m_LockCount > 0, "Trying to access unlocked terrain bitmap");
-    return _getpixel(m_pMainBitmap, posX, posY);
+    return m_pMainBitmap->line[posY][posX];
 }
 
 
@@ -810,23 +872,8 @@ unsigned char SLTerrain::GetMaterialPixel(const int pixelX, const int pixelY) co
 
 bool SLTerrain::IsAirPixel(const int pixelX, const int pixelY) const
 {
-    int posX = pixelX;
-    int posY = pixelY;
-
-    WrapPosition(posX, posY);
-
-    // If it's still below or to the sides out of bounds after
-    // wrapping what is supposed to be wrapped, shit is out of bounds.
-    if (posX < 0 || posX >= m_pMainBitmap->w || posY >= m_pMainBitmap->h)
-//        return g_MaterialOutOfBounds;
-        return true;
-
-    // If above terrain bitmap, return air material.
-    if (posY < 0)
-        return true;
-
-	int checkPixel = _getpixel(m_pMainBitmap, posX, posY);
-//    RTEAssert(m_pMainBitmap->m_LockCount > 0, "Trying to access unlocked terrain bitmap");
+    // Out of bounds pixels come back as air
+	int checkPixel = GetMaterialPixel(pixelX, pixelY);
     return checkPixel == g_MaterialAir || checkPixel == g_MaterialCavity;
 }
 
@@ -908,6 +955,8 @@ void SLTerrain::SetMaterialPixel(const int pixelX, const int pixelY, const unsig
        return;
 //    RTEAssert(m_pMainBitmap->m_LockCount > 0, "Trying to access unlocked terrain bitmap");
     _putpixel(m_pMainBitmap, posX, posY, material);
+    if (material != g_MaterialAir)
+        g_SceneMan.MarkRayTilesOccupied(posX, posY, posX, posY, true);
 }
 
 
@@ -927,124 +976,120 @@ deque<MOPixel *> SLTerrain::EraseSilhouette(BITMAP *pSprite,
                                             int skipMOP,
                                             int maxMOPs)
 {
-// TODO: OPTIMIZE THIS, IT'S A TIME HOG. MAYBE JSUT STAMP THE OUTLINE AND SAMPLE SOME RANDOM PARTICLES?
-
     RTEAssert(pSprite, "Null BITMAP passed to SLTerrain::EraseSilhouette");
 
     deque<MOPixel *> MOPDeque;
 
-    // This will point to the chosen intermediate test bitmap
-    BITMAP *pTempBitmap = 0;
-
     // Find the maximum possible sized bitmap that the passed-in sprite will need
-
     int halfWidth = pSprite->w / 2;
     int halfHeight = pSprite->h / 2;
-    double SinA = sin(rotation.GetRadAngle());
-    double CosA = cos(rotation.GetRadAngle());
     int maxWidth = (pSprite->w + abs(pivot.m_X - halfWidth)) * scale;
     int maxHeight = (pSprite->h + abs(pivot.m_Y - halfHeight)) * scale;
     int maxDiameter = sqrt((float)(maxWidth * maxWidth + maxHeight * maxHeight)) * 2;
     int skipCount = skipMOP;
 
-    // Choose an appropriate size
-    if (maxDiameter  >= 256)
-        pTempBitmap = m_spTempBitmap512;
-    if (maxDiameter  >= 128)
-        pTempBitmap = m_spTempBitmap256;
-    else if (maxDiameter  >= 64)
-        pTempBitmap = m_spTempBitmap128;
-    else if (maxDiameter >= 32)
-        pTempBitmap = m_spTempBitmap64;
-    else if (maxDiameter >= 16)
-        pTempBitmap = m_spTempBitmap32;
-    else
-        pTempBitmap = m_spTempBitmap16;
+    // This will point to the chosen intermediate test bitmap
+    BITMAP *pTempBitmap = GetTempBitmap(maxDiameter);
 
     // Clear and draw the source sprite onto the test bitmap
     clear_bitmap(pTempBitmap);
     pivot_scaled_sprite(pTempBitmap, pSprite, pTempBitmap->w / 2, pTempBitmap->h / 2, pivot.m_X, pivot.m_Y,  ftofix(rotation.GetAllegroAngle()), ftofix(scale));
 
+    halfWidth = pTempBitmap->w / 2;
+    halfHeight = pTempBitmap->h / 2;
+
+    // Only the part of the test bitmap the rotated sprite can reach needs scanning, which is within half the diameter of the pivot
+    int reach = maxDiameter / 2 + 2;
+    int testLeft = MAX(halfWidth - reach, 0);
+    int testTop = MAX(halfHeight - reach, 0);
+    int testWidth = MIN(halfWidth + reach, pTempBitmap->w) - testLeft;
+    int testHeight = MIN(halfHeight + reach, pTempBitmap->h) - testTop;
+
+    // Find the at most four rectangles of the terrain that part covers, once for all its pixels
+    TerrainSpan columnSpans[2];
+    TerrainSpan rowSpans[2];
+    int columnSpanCount = GetTerrainSpans(static_cast<int>(pos.m_X - halfWidth + testLeft), testWidth, m_pMainBitmap->w, m_WrapX, columnSpans);
+    int rowSpanCount = GetTerrainSpans(static_cast<int>(pos.m_Y - halfHeight + testTop), testHeight, m_pMainBitmap->h, m_WrapY, rowSpans);
+
     // Do the test of intersection between color pixels of the test bitmap and non-air pixels of the terrain
     // Generate and collect MOPixels that represent the terrain overlap and clear the same pixels out of the terrain
-    int testX, testY, terrX, terrY;
+    BITMAP *pFGColorBitmap = m_pFGColor->GetBitmap();
     MOPixel *pPixel = 0;
 	Material const * sceneMat = g_SceneMan.GetMaterialFromID(g_MaterialAir); 
 	Material const * spawnMat = g_SceneMan.GetMaterialFromID(g_MaterialAir);
-    halfWidth = pTempBitmap->w / 2;
-    halfHeight = pTempBitmap->h / 2;
-    unsigned char testPixel = 0, matPixel = 0, colorPixel = 0;
+    unsigned char matPixel = 0, colorPixel = 0;
+    // Bounds of the color pixels cleared, so the change is registered once for all of them
+    int changedLeft = pTempBitmap->w, changedTop = pTempBitmap->h, changedRight = -1, changedBottom = -1;
 
-    for (testY = 0; testY < pTempBitmap->h; ++testY)
+    for (int rowSpan = 0; rowSpan < rowSpanCount; ++rowSpan)
     {
-        for (testX = 0; testX < pTempBitmap->w; ++testX)
+        for (int row = 0; row < rowSpans[rowSpan].m_Length; ++row)
         {
-            terrX = pos.m_X - halfWidth + testX;
-            terrY = pos.m_Y - halfHeight + testY;
-
-            // Make sure we're checking within bounds
-            if (terrX < 0) {
-                if (m_WrapX)
-                    while (terrX < 0)
-                        terrX += m_pMainBitmap->w;
-                else
-                    continue;
-            }
-            if (terrY < 0) {
-                if (m_WrapY)
-                    while (terrY < 0)
-                        terrY += m_pMainBitmap->h;
-                else
-                    continue;
-            }
-            if (terrX >= m_pMainBitmap->w) {
-                if (m_WrapX)
-                    terrX %= m_pMainBitmap->w;
-                else
-                    continue;
-            }
-            if (terrY >= m_pMainBitmap->h) {
-                if (m_WrapY)
-                    terrY %= m_pMainBitmap->h;
-                else
-                    continue;
-            }
-
-            testPixel = getpixel(pTempBitmap, testX, testY);
-            matPixel = getpixel(m_pMainBitmap, terrX, terrY);
-            colorPixel = getpixel(m_pFGColor->GetBitmap(), terrX, terrY);
+            int testY = testTop + rowSpans[rowSpan].m_TestStart + row;
+            int terrY = rowSpans[rowSpan].m_TerrainStart + row;
+            const unsigned char *pTestRow = pTempBitmap->line[testY];
+            unsigned char *pMatRow = m_pMainBitmap->line[terrY];
+            unsigned char *pColorRow = pFGColorBitmap->line[terrY];
 
-            if (testPixel != g_KeyColor)
+            for (int columnSpan = 0; columnSpan < columnSpanCount; ++columnSpan)
             {
-                // Only add PixelMO if we're not due to skip any
-                if (makeMOPs && matPixel != g_MaterialAir && colorPixel != g_KeyColor && ++skipCount > skipMOP && MOPDeque.size() < maxMOPs)
+                int spanStart = testLeft + columnSpans[columnSpan].m_TestStart;
+                int spanEnd = spanStart + columnSpans[columnSpan].m_Length;
+                // Offset from the test bitmap's columns to the terrain's
+                int terrOffset = columnSpans[columnSpan].m_TerrainStart - spanStart;
+
+                for (int testX = FindFirstNotOf(pTestRow, spanStart, spanEnd, g_KeyColor); testX < spanEnd; testX = FindFirstNotOf(pTestRow, testX + 1, spanEnd, g_KeyColor))
                 {
-                    skipCount = 0;
-                    sceneMat = g_SceneMan.GetMaterialFromID(matPixel);
-                    spawnMat = sceneMat->spawnMaterial ? g_SceneMan.GetMaterialFromID(sceneMat->spawnMaterial) : sceneMat;
-                    // Create the MOPixel based off the Terrain data.
-                    pPixel = new MOPixel(colorPixel,
-                                         spawnMat->pixelDensity,
-                                         Vector(terrX, terrY),
-                                         Vector(),
-                                         new Atom(Vector(), spawnMat->id, 0, colorPixel, 2),
-                                         0);
-
-                    pPixel->SetToHitMOs(false);
-                    MOPDeque.push_back(pPixel);
-                    pPixel = 0;
+                    int terrX = testX + terrOffset;
+                    matPixel = pMatRow[terrX];
+                    colorPixel = pColorRow[terrX];
+
+                    // Only add PixelMO if we're not due to skip any
+                    if (makeMOPs && matPixel != g_MaterialAir && colorPixel != g_KeyColor && ++skipCount > skipMOP && MOPDeque.size() < maxMOPs)
+                    {
+                        skipCount = 0;
+                        sceneMat = g_SceneMan.GetMaterialFromID(matPixel);
+                        spawnMat = sceneMat->spawnMaterial ? g_SceneMan.GetMaterialFromID(sceneMat->spawnMaterial) : sceneMat;
+                        // Create the MOPixel based off the Terrain data.
+                        pPixel = new MOPixel(colorPixel,
+                                             spawnMat->pixelDensity,
+                                             Vector(terrX, terrY),
+                                             Vector(),
+                                             new Atom(Vector(), spawnMat->id, 0, colorPixel, 2),
+                                             0);
+
+                        pPixel->SetToHitMOs(false);
+                        MOPDeque.push_back(pPixel);
+                        pPixel = 0;
+                    }
+
+                    // Clear the terrain pixels
+                    if (matPixel != g_MaterialAir)
+                        pMatRow[terrX] = g_MaterialAir;
+                    if (colorPixel != g_KeyColor)
+                    {
+                        pColorRow[terrX] = g_KeyColor;
+                        changedLeft = MIN(changedLeft, testX);
+                        changedTop = MIN(changedTop, testY);
+                        changedRight = MAX(changedRight, testX);
+                        changedBottom = MAX(changedBottom, testY);
+                    }
                 }
-
-                // Clear the terrain pixels
-                if (matPixel != g_MaterialAir)
-                    putpixel(m_pMainBitmap, terrX, terrY, g_MaterialAir);
-				if (colorPixel != g_KeyColor)
-				{
-					putpixel(m_pFGColor->GetBitmap(), terrX, terrY, g_KeyColor);
-					g_SceneMan.RegisterTerrainChange(terrX, terrY, 1, 1, g_KeyColor, false);
-				}
             }
-        }    
+        }
+    }
+
+    // Register terrain change, SceneMan takes care of wrapping it around the horizontal seam but the vertical one needs doing here
+    if (changedRight >= changedLeft)
+    {
+        int changedX = pos.m_X - halfWidth + changedLeft;
+        int changedY = pos.m_Y - halfHeight + changedTop;
+        g_SceneMan.RegisterTerrainChange(changedX, changedY, changedRight - changedLeft + 1, changedBottom - changedTop + 1, false);
+        if (m_WrapY)
+        {
+            g_SceneMan.RegisterTerrainChange(changedX, changedY - m_pMainBitmap->h, changedRight - changedLeft + 1, changedBottom - changedTop + 1, false);
+            g_SceneMan.RegisterTerrainChange(changedX, changedY + m_pMainBitmap->h, changedRight - changedLeft + 1, changedBottom - changedTop + 1, false);
+        }
     }
 
     // Add a box to the updated areas list to show there's been change to the materials layer
@@ -1107,20 +1152,8 @@ void SLTerrain::ApplyMovableObject(MovableObject *pMObject)
         BITMAP *pSprite = pMOSprite->GetSpriteFrame();
 
 // TODO: Make the diameter more accurate.. now we have to double it because it's not taking into account anything attached to the MO
-        float diameter = pMOSprite->GetDiameter() * 2;
         // Choose an appropriate size
-        if (diameter >= 256)
-            pTempBitmap = m_spTempBitmap512;
-        if (diameter >= 128)
-            pTempBitmap = m_spTempBitmap256;
-        else if (diameter >= 64)
-            pTempBitmap = m_spTempBitmap128;
-        else if (diameter >= 32)
-            pTempBitmap = m_spTempBitmap64;
-        else if (diameter >= 16)
-            pTempBitmap = m_spTempBitmap32;
-        else
-            pTempBitmap = m_spTempBitmap16;
+        pTempBitmap = GetTempBitmap(pMOSprite->GetDiameter() * 2);
 
         // The position of the upper left corner of the temporary bitmap in the scene
         Vector bitmapScroll = pMOSprite->GetPos().GetFloored() - (pTempBitmap->w / 2);
@@ -1133,68 +1166,116 @@ void SLTerrain::ApplyMovableObject(MovableObject *pMObject)
         // Draw the actor and then the scene foreground to temp bitmap
         pMOSprite->Draw(pTempBitmap, bitmapScroll, g_DrawColor, true);
         m_pFGColor->Draw(pTempBitmap, notUsed, bitmapScroll);
-        // Finally draw temporary bitmap to the Scene
-        masked_blit(pTempBitmap, GetFGColorBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
+        // Finally draw temporary bitmap to the Scene, over the seams too
+        BlitWrapped(pTempBitmap, GetFGColorBitmap(), bitmapScroll.m_X, bitmapScroll.m_Y);
 
 		// Register terrain change
-		g_SceneMan.RegisterTerrainChange(bitmapScroll.m_X, bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h, g_KeyColor, false);
-
-
-// TODO: centralize seam drawing!
-        // Draw over seams
-        if (g_SceneMan.SceneWrapsX())
-        {
-            if (bitmapScroll.m_X < 0)
-                masked_blit(pTempBitmap, GetFGColorBitmap(), 0, 0, bitmapScroll.m_X + g_SceneMan.GetSceneWidth(), bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
-            else if (bitmapScroll.m_X + pTempBitmap->w > g_SceneMan.GetSceneWidth())
-                masked_blit(pTempBitmap, GetFGColorBitmap(), 0, 0, bitmapScroll.m_X - g_SceneMan.GetSceneWidth(), bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
-        }
-        if (g_SceneMan.SceneWrapsY())
-        {
-            if (bitmapScroll.m_Y < 0)
-                masked_blit(pTempBitmap, GetFGColorBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y + g_SceneMan.GetSceneHeight(), pTempBitmap->w, pTempBitmap->h);
-            else if (bitmapScroll.m_Y + pTempBitmap->h > g_SceneMan.GetSceneHeight())
-                masked_blit(pTempBitmap, GetFGColorBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y - g_SceneMan.GetSceneHeight(), pTempBitmap->w, pTempBitmap->h);
-        }
+		g_SceneMan.RegisterTerrainChange(bitmapScroll.m_X, bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h, false);
 
         // Material
         clear_to_color(pTempBitmap, g_MaterialAir);
         // Draw the actor and then the scene material layer to temp bitmap
         pMOSprite->Draw(pTempBitmap, bitmapScroll, g_DrawMaterial, true);
         SceneLayer::Draw(pTempBitmap, notUsed, bitmapScroll);
-        // Finally draw temporary bitmap to the Scene
-        masked_blit(pTempBitmap, GetMaterialBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
+        // Finally draw temporary bitmap to the Scene, over the seams too
+        BlitWrapped(pTempBitmap, GetMaterialBitmap(), bitmapScroll.m_X, bitmapScroll.m_Y);
         // Add a box to the updated areas list to show there's been change to the materials layer
         m_UpdatedMateralAreas.push_back(Box(bitmapScroll, pTempBitmap->w, pTempBitmap->h));
-// TODO: centralize seam drawing!
-        // Draw over seams
-        if (g_SceneMan.SceneWrapsX())
-        {
-            if (bitmapScroll.m_X < 0)
-                masked_blit(pTempBitmap, GetMaterialBitmap(), 0, 0, bitmapScroll.m_X + g_SceneMan.GetSceneWidth(), bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
-            else if (bitmapScroll.m_X + pTempBitmap->w > g_SceneMan.GetSceneWidth())
-                masked_blit(pTempBitmap, GetMaterialBitmap(), 0, 0, bitmapScroll.m_X - g_SceneMan.GetSceneWidth(), bitmapScroll.m_Y, pTempBitmap->w, pTempBitmap->h);
-        }
-        if (g_SceneMan.SceneWrapsY())
-        {
-            if (bitmapScroll.m_Y < 0)
-                masked_blit(pTempBitmap, GetMaterialBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y + g_SceneMan.GetSceneHeight(), pTempBitmap->w, pTempBitmap->h);
-            else if (bitmapScroll.m_Y + pTempBitmap->h > g_SceneMan.GetSceneHeight())
-                masked_blit(pTempBitmap, GetMaterialBitmap(), 0, 0, bitmapScroll.m_X, bitmapScroll.m_Y - g_SceneMan.GetSceneHeight(), pTempBitmap->w, pTempBitmap->h);
-        }
     }
     // Not a big sprite, so just draw the representations
     else
     {
         pMObject->Draw(GetFGColorBitmap(), Vector(), g_DrawColor, true);
 		// Register terrain change
-		g_SceneMan.RegisterTerrainChange(pMObject->GetPos().m_X, pMObject->GetPos().m_Y, 1, 1, g_DrawColor, false);
+		int changeRadius = static_cast<int>(pMObject->GetRadius()) + 1;
+		g_SceneMan.RegisterTerrainChange(pMObject->GetPos().m_X - changeRadius, pMObject->GetPos().m_Y - changeRadius, changeRadius * 2 + 1, changeRadius * 2 + 1, false);
 
         pMObject->Draw(GetMaterialBitmap(), Vector(), g_DrawMaterial, true);
     }
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetTempBitmap
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the smallest intermediate test bitmap that can hold something of
+//                  a specific diameter.
+
+BITMAP * SLTerrain::GetTempBitmap(float diameter)
+{
+    if (diameter >= 256)
+        return m_spTempBitmap512;
+    else if (diameter >= 128)
+        return m_spTempBitmap256;
+    else if (diameter >= 64)
+        return m_spTempBitmap128;
+    else if (diameter >= 32)
+        return m_spTempBitmap64;
+    else if (diameter >= 16)
+        return m_spTempBitmap32;
+    return m_spTempBitmap16;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetTerrainSpans
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clips a run of pixels along one axis to the terrain, splitting it in
+//                  two where it crosses the seam if the terrain wraps.
+
+int SLTerrain::GetTerrainSpans(int terrainStart, int length, int terrainSize, bool wraps, TerrainSpan *pSpans)
+{
+    if (length <= 0 || terrainSize <= 0)
+        return 0;
+
+    if (wraps)
+    {
+        int wrappedStart = ((terrainStart % terrainSize) + terrainSize) % terrainSize;
+        pSpans[0].m_TestStart = 0;
+        pSpans[0].m_TerrainStart = wrappedStart;
+        pSpans[0].m_Length = MIN(length, terrainSize - wrappedStart);
+        if (pSpans[0].m_Length == length)
+            return 1;
+
+        // The rest continues from the other side of the seam
+        pSpans[1].m_TestStart = pSpans[0].m_Length;
+        pSpans[1].m_TerrainStart = 0;
+        pSpans[1].m_Length = MIN(length - pSpans[0].m_Length, wrappedStart);
+        return 2;
+    }
+
+    int clippedStart = MAX(terrainStart, 0);
+    int clippedEnd = MIN(terrainStart + length, terrainSize);
+    if (clippedEnd <= clippedStart)
+        return 0;
+
+    pSpans[0].m_TestStart = clippedStart - terrainStart;
+    pSpans[0].m_TerrainStart = clippedStart;
+    pSpans[0].m_Length = clippedEnd - clippedStart;
+    return 1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BlitWrapped
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws an intermediate test bitmap onto a layer of this terrain with
+//                  its key colored pixels left out, wrapping it around the seams.
+
+void SLTerrain::BlitWrapped(BITMAP *pTempBitmap, BITMAP *pTargetLayer, int posX, int posY) const
+{
+    TerrainSpan columnSpans[2];
+    TerrainSpan rowSpans[2];
+    int columnSpanCount = GetTerrainSpans(posX, pTempBitmap->w, pTargetLayer->w, m_WrapX, columnSpans);
+    int rowSpanCount = GetTerrainSpans(posY, pTempBitmap->h, pTargetLayer->h, m_WrapY, rowSpans);
+
+    for (int rowSpan = 0; rowSpan < rowSpanCount; ++rowSpan)
+    {
+        for (int columnSpan = 0; columnSpan < columnSpanCount; ++columnSpan)
+            masked_blit(pTempBitmap, pTargetLayer, columnSpans[columnSpan].m_TestStart, rowSpans[rowSpan].m_TestStart, columnSpans[columnSpan].m_TerrainStart, rowSpans[rowSpan].m_TerrainStart, columnSpans[columnSpan].m_Length, rowSpans[rowSpan].m_Length);
+    }
+}
+
 
 void SLTerrain::RegisterTerrainChange(TerrainObject *pTObject)
 {
@@ -1205,11 +1286,28 @@ void SLTerrain::RegisterTerrainChange(TerrainObject *pTObject)
 
 	if (pTObject->HasBGColor())
 	{
-		g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), g_KeyColor, true);
+		g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), true);
 	}
 
 	// Register terrain change
-	g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), g_KeyColor, false);
+	g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), false);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddUpdatedMaterialArea
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a notification that an area of the material terrain has been
+//                  updated.
+
+void SLTerrain::AddUpdatedMaterialArea(const Box &newArea)
+{
+    m_UpdatedMateralAreas.push_back(newArea);
+
+    // Whatever was drawn there may be in the way of rays now
+    Box area = newArea;
+    area.Unflip();
+    g_SceneMan.MarkRayTilesOccupied(floorf(area.GetCorner().m_X), floorf(area.GetCorner().m_Y), ceilf(area.GetCorner().m_X + area.GetWidth()), ceilf(area.GetCorner().m_Y + area.GetHeight()), true);
 }
 
 
@@ -1248,11 +1346,11 @@ void SLTerrain::ApplyTerrainObject(TerrainObject *pTObject)
 	if (pTObject->HasBGColor())
 	{
 		draw_sprite(m_pBGColor->GetBitmap(), pTObject->GetBGColorBitmap(), loc.m_X, loc.m_Y);
-		g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), g_KeyColor, true);
+		g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), true);
 	}
 
 	// Register terrain change
-	g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), g_KeyColor, false);
+	g_SceneMan.RegisterTerrainChange(loc.m_X, loc.m_Y, pTObject->GetBitmapWidth(), pTObject->GetBitmapHeight(), false);
 
     // Add a box to the updated areas list to show there's been change to the materials layer
     m_UpdatedMateralAreas.push_back(Box(loc, pTObject->GetMaterialBitmap()->w, pTObject->GetMaterialBitmap()->h));
@@ -1303,45 +1401,20 @@ void SLTerrain::CleanAirBox(Box box, bool wrapsX, bool wrapsY)
     acquire_bitmap(m_pMainBitmap);
     acquire_bitmap(m_pFGColor->GetBitmap());
 
-    int width = m_pMainBitmap->w;
-    int height = m_pMainBitmap->h;
-    unsigned char matPixel;
-
-	for (int y = box.m_Corner.m_Y; y < box.m_Corner.m_Y + box.m_Height; ++y) {
-		for (int x = box.m_Corner.m_X; x < box.m_Corner.m_X + box.m_Width; ++x) {
-			float wrapX = x;
-			float wrapY = y;
-
-			//Fix coords in case of seam
-			if (wrapsX)
-			{
-				if (wrapX < 0)
-					wrapX = wrapX + m_pMainBitmap->w;
-
-				if (wrapX >= m_pMainBitmap->w)
-					wrapX = wrapX - m_pMainBitmap->w;
-			}
-
-			if (wrapsY)
-			{
-				if (wrapY < 0)
-					wrapY = wrapY + m_pMainBitmap->h;
-
-				if (wrapY >= m_pMainBitmap->h)
-					wrapY = wrapY - m_pMainBitmap->h;
-			}
-
-			if (wrapX >= 0 && wrapY >=0 && wrapX < width && wrapY < height)
-			{
-				matPixel = _getpixel(m_pMainBitmap, wrapX, wrapY);
-				if (matPixel == g_MaterialCavity) {
-					_putpixel(m_pMainBitmap, wrapX, wrapY, g_MaterialAir);
-					matPixel = g_MaterialAir;
-				}
-				if (matPixel == g_MaterialAir)
-					_putpixel(m_pFGColor->GetBitmap(), wrapX, wrapY, g_KeyColor);
-			}
+    BITMAP *pColorBitmap = m_pFGColor->GetBitmap();
+
+    // Split the box where it crosses the seams, so each part can be walked a row at a time
+    TerrainSpan columnSpans[2];
+    TerrainSpan rowSpans[2];
+    int columnSpanCount = GetTerrainSpans(box.m_Corner.m_X, box.m_Width, m_pMainBitmap->w, wrapsX, columnSpans);
+    int rowSpanCount = GetTerrainSpans(box.m_Corner.m_Y, box.m_Height, m_pMainBitmap->h, wrapsY, rowSpans);
 
+    for (int rowSpan = 0; rowSpan < rowSpanCount; ++rowSpan)
+    {
+        for (int y = rowSpans[rowSpan].m_TerrainStart; y < rowSpans[rowSpan].m_TerrainStart + rowSpans[rowSpan].m_Length; ++y)
+        {
+            for (int columnSpan = 0; columnSpan < columnSpanCount; ++columnSpan)
+                CleanAirRun(m_pMainBitmap->line[y], pColorBitmap->line[y], columnSpans[columnSpan].m_TerrainStart, columnSpans[columnSpan].m_TerrainStart + columnSpans[columnSpan].m_Length);
         }
     }
 
@@ -1361,21 +1434,10 @@ void SLTerrain::CleanAir()
     acquire_bitmap(m_pMainBitmap);
     acquire_bitmap(m_pFGColor->GetBitmap());
 
-    int width = m_pMainBitmap->w;
-    int height = m_pMainBitmap->h;
-    unsigned char matPixel;
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            matPixel = _getpixel(m_pMainBitmap, x, y);
-            if (matPixel == g_MaterialCavity) {
-                _putpixel(m_pMainBitmap, x, y, g_MaterialAir);
-                matPixel = g_MaterialAir;
-            }
-            if (matPixel == g_MaterialAir)
-                _putpixel(m_pFGColor->GetBitmap(), x, y, g_KeyColor);
-        }
-    }
+    BITMAP *pColorBitmap = m_pFGColor->GetBitmap();
+
+    for (int y = 0; y < m_pMainBitmap->h; ++y)
+        CleanAirRun(m_pMainBitmap->line[y], pColorBitmap->line[y], 0, m_pMainBitmap->w);
 
     release_bitmap(m_pMainBitmap);
     release_bitmap(m_pFGColor->GetBitmap());
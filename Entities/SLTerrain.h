@@ -110,7 +110,7 @@ class SLTerrain:
     //                  read or not. 0 means it was read successfully, and any nonzero indicates
     //                  that a property of that name could not be found in this or base classes.
 
-        virtual int ReadProperty(std::string propName, Reader &reader);
+        virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -367,7 +367,7 @@ ENTITYALLOCATION(SLTerrain)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -671,7 +671,7 @@ ENTITYALLOCATION(SLTerrain)
 //                  and may be out of bounds of the scene.
 // Return value:    None.
 
-    void AddUpdatedMaterialArea(const Box &newArea) { m_UpdatedMateralAreas.push_back(newArea); }
+    void AddUpdatedMaterialArea(const Box &newArea);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -809,6 +809,14 @@ protected:
     static BITMAP *m_spTempBitmap256;
     static BITMAP *m_spTempBitmap512;
 
+    // A run of pixels along one axis of an intermediate test bitmap, and where on the terrain it lands after wrapping
+    struct TerrainSpan
+    {
+        int m_TestStart;
+        int m_TerrainStart;
+        int m_Length;
+    };
+
 	// Indicates, that before processing frostings-related properties for this terrain
 	// derived list with frostings must be cleared to avoid duplication when loading scenes
 	bool m_NeedToClearFrostings;
@@ -817,6 +825,47 @@ protected:
 	bool m_NeedToClearDebris;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetTempBitmap
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the smallest intermediate test bitmap that can hold something of
+//                  a specific diameter.
+// Arguments:       The diameter in pixels.
+// Return value:    The intermediate test bitmap. Ownership is NOT transferred!
+
+    static BITMAP * GetTempBitmap(float diameter);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetTerrainSpans
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clips a run of pixels along one axis to the terrain. If the terrain
+//                  wraps along that axis, the run is split in two where it crosses the
+//                  seam, otherwise the part off the terrain is cut off. Doing this for
+//                  both axes gives the at most four rectangles a box covers on the terrain.
+// Arguments:       The terrain coordinate the run starts at, can be off the terrain.
+//                  The length of the run. Should be no longer than the terrain.
+//                  The size of the terrain along the axis.
+//                  Whether the terrain wraps along the axis.
+//                  An array of at least two spans to fill out, in order along the run.
+// Return value:    How many spans were filled out, from 0 to 2.
+
+    static int GetTerrainSpans(int terrainStart, int length, int terrainSize, bool wraps, TerrainSpan *pSpans);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BlitWrapped
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws an intermediate test bitmap onto a layer of this terrain with
+//                  its key colored pixels left out, wrapping it around the seams.
+// Arguments:       The intermediate test bitmap to draw.
+//                  The layer of this terrain to draw onto.
+//                  Where on the terrain the upper left corner of the bitmap goes.
+// Return value:    None.
+
+    void BlitWrapped(BITMAP *pTempBitmap, BITMAP *pTargetLayer, int posX, int posY) const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
 
@@ -90,7 +90,7 @@ int Scene::Area::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Scene::Area::ReadProperty(std::string propName, Reader &reader)
+int Scene::Area::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "AddBox")
     {
@@ -1262,7 +1262,7 @@ int Scene::ClearData()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Scene::ReadProperty(std::string propName, Reader &reader)
+int Scene::ReadProperty(const std::string &propName, Reader &reader)
 {
 
     if (propName == "LocationOnPlanet")
@@ -1831,34 +1831,30 @@ void Scene::ClearSeenPixels(int team)
 {
     if (team != Activity::NOTEAM)
     {
-        // Clear all the pixels off the map, set them to key color
+        // Clear all the runs of pixels off the map, set them to key color
         if (m_apUnseenLayer[team])
         {
-            for (list<Vector>::iterator itr = m_SeenPixels[team].begin(); itr != m_SeenPixels[team].end(); ++itr)
+            for (vector<PixelSpan>::const_iterator itr = m_SeenPixels[team].begin(); itr != m_SeenPixels[team].end(); ++itr)
             {
-                putpixel(m_apUnseenLayer[team]->GetBitmap(), (*itr).m_X, (*itr).m_Y, g_KeyColor);
-
-                // Clean up around the removed pixels too
-                CleanOrphanPixel((*itr).m_X + 1, (*itr).m_Y, W, team);
-                CleanOrphanPixel((*itr).m_X - 1, (*itr).m_Y, E, team);
-                CleanOrphanPixel((*itr).m_X, (*itr).m_Y + 1, N, team);
-                CleanOrphanPixel((*itr).m_X, (*itr).m_Y - 1, S, team);
-                CleanOrphanPixel((*itr).m_X + 1, (*itr).m_Y + 1, NW, team);
-                CleanOrphanPixel((*itr).m_X - 1, (*itr).m_Y + 1, NE, team);
-                CleanOrphanPixel((*itr).m_X - 1, (*itr).m_Y - 1, SE, team);
-                CleanOrphanPixel((*itr).m_X + 1, (*itr).m_Y - 1, SW, team);
+                int left = (*itr).m_X;
+                int right = (*itr).m_X + (*itr).m_Width - 1;
+                int row = (*itr).m_Y;
+                hline(m_apUnseenLayer[team]->GetBitmap(), left, row, right, g_KeyColor);
+
+                // Clean up around the removed pixels too. Only the ones bordering the run can have lost support, the ones inside it are all seen now
+                CleanOrphanPixel(right + 1, row, W, team);
+                CleanOrphanPixel(left - 1, row, E, team);
+                for (int posX = left - 1; posX <= right + 1; ++posX)
+                {
+                    CleanOrphanPixel(posX, row + 1, posX < left ? NE : (posX > right ? NW : N), team);
+                    CleanOrphanPixel(posX, row - 1, posX < left ? SE : (posX > right ? SW : S), team);
+                }
             }
         }
 
-        // Now actually clear the list too
+        // Now actually clear the list too, and transfer all cleaned pixels from orphans to the seen pixels for next frame
         m_SeenPixels[team].clear();
-
-        // Transfer all cleaned pixels from orphans to the seen pixels for next frame
-        for (list<Vector>::iterator itr = m_CleanedPixels[team].begin(); itr != m_CleanedPixels[team].end(); ++itr)
-            m_SeenPixels[team].push_back(*itr);
-
-        // We have moved the cleaned pixels to the seen pixels list, now clean up the list for next frame
-        m_CleanedPixels[team].clear();
+        m_SeenPixels[team].swap(m_CleanedPixels[team]);
     }
 }
 
@@ -1945,7 +1941,7 @@ bool Scene::CleanOrphanPixel(int posX, int posY, NeighborDirection checkingFrom,
     if (support <= 2.5)
     {
         putpixel(m_apUnseenLayer[team]->GetBitmap(), posX, posY, g_KeyColor);
-        m_CleanedPixels[team].push_back(Vector(posX, posY));
+        AddPixelSpan(m_CleanedPixels[team], posX, posY, 1);
         return true;
     }    
 
@@ -1953,6 +1949,24 @@ bool Scene::CleanOrphanPixel(int posX, int posY, NeighborDirection checkingFrom,
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddPixelSpan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a run of pixels to a list of them, merging it into the last one
+//                  if it continues it on the same row.
+
+void Scene::AddPixelSpan(vector<PixelSpan> &spans, int posX, int posY, int width)
+{
+    if (width <= 0)
+        return;
+
+    if (!spans.empty() && spans.back().m_Y == posY && spans.back().m_X + spans.back().m_Width == posX)
+        spans.back().m_Width += width;
+    else
+        spans.push_back(PixelSpan(posX, posY, width));
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetDimensions
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3051,6 +3065,76 @@ int Scene::CalculateScenePath(const Vector start, const Vector end, bool movePat
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up the least difficult path between two points on the current
+//                  scene to be calculated on the pathfinding thread.
+
+int Scene::RequestPath(const Vector &start, const Vector &end, float digStrength)
+{
+    return m_pPathFinder ? m_pPathFinder->RequestPath(start, end, digStrength) : -1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the result of a path request made with RequestPath, if it's done.
+
+bool Scene::GetPathResult(int requestID, std::list<Vector> &pathResult, float &totalCostResult)
+{
+    return m_pPathFinder && m_pPathFinder->GetPathResult(requestID, pathResult, totalCostResult);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FetchScenePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the result of a path request made with RequestPath into the
+//                  ScenePath, if it's done. For exposing RequestPath to Lua.
+
+int Scene::FetchScenePath(int requestID, bool movePathToGround)
+{
+    float notUsed;
+    if (!GetPathResult(requestID, m_ScenePath, notUsed))
+        return -1;
+
+    if (movePathToGround)
+    {
+        // Smash all airborne waypoints down to just above the ground
+        for (list<Vector>::iterator lItr = m_ScenePath.begin(); lItr != m_ScenePath.end(); ++lItr)
+            (*lItr) = g_SceneMan.MovePointToGround((*lItr), 20, 15);
+    }
+    return m_ScenePath.size();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a path request made with RequestPath is still waiting
+//                  to be calculated.
+
+bool Scene::IsPathRequestPending(int requestID) const
+{
+    return m_pPathFinder && m_pPathFinder->IsPathRequestPending(requestID);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels a path request made with RequestPath, or throws away its
+//                  result if it's already done.
+
+void Scene::CancelPathRequest(int requestID)
+{
+    if (m_pPathFinder)
+        m_pPathFinder->CancelPathRequest(requestID);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Lock
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3098,8 +3182,6 @@ void Scene::Unlock()
 
 void Scene::Update()
 {
-    m_PathfindingUpdated = false;
-
 	if (g_SettingsMan.BlipOnRevealUnseen())
 	{
 		// Highlight the pixels that have been revealed on the unseen maps
@@ -3107,13 +3189,27 @@ void Scene::Update()
 		{
 			if (m_apUnseenLayer[team])
 			{
-				for (list<Vector>::iterator itr = m_SeenPixels[team].begin(); itr != m_SeenPixels[team].end(); ++itr)
+				for (vector<PixelSpan>::const_iterator itr = m_SeenPixels[team].begin(); itr != m_SeenPixels[team].end(); ++itr)
 				{
-					putpixel(m_apUnseenLayer[team]->GetBitmap(), (*itr).m_X, (*itr).m_Y, g_WhiteColor);
+					hline(m_apUnseenLayer[team]->GetBitmap(), (*itr).m_X, (*itr).m_Y, (*itr).m_X + (*itr).m_Width - 1, g_WhiteColor);
 				}
 			}
 		}
 	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSim
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the parts of this Scene that go along with the simulation,
+//                  ie the pathfinding costs and path requests.
+
+void Scene::UpdateSim()
+{
+    m_PathfindingUpdated = false;
+    if (!m_pPathFinder)
+        return;
 
     // Do full update every two minutes
     if (m_FullPathUpdateTimer.IsPastSimMS(120000))
@@ -3123,9 +3219,12 @@ void Scene::Update()
         m_PathfindingUpdated = true;
     }
 
-    // Do partial update every 10 seconds
-    if (m_PartialPathUpdateTimer.IsPastRealMS(10000))
+    // Do partial update every 10 seconds, or right away if there are path requests to be solved, so they see any changes to the terrain
+    if (m_PartialPathUpdateTimer.IsPastRealMS(10000) || m_pPathFinder->HasQueuedPathRequests())
         UpdatePathFinding();
+
+    // Collect the paths solved since last update and hand over the ones requested since
+    m_pPathFinder->Update();
 }
 
 } // namespace RTE
@@ -61,6 +61,26 @@ public:
 	const static int PREVIEW_WIDTH = 140;
 	const static int PREVIEW_HEIGHT = 55;
 
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // Nested struct:   PixelSpan
+    //////////////////////////////////////////////////////////////////////////////////////////
+    // Description:     A horizontal run of pixels on an unseen layer, in the coordinates of
+    //                  that layer.
+    // Parent(s):       None.
+    // Class history:   10/18/2020 PixelSpan created.
+
+    struct PixelSpan
+    {
+        // The leftmost pixel of the run and its row
+        int m_X;
+        int m_Y;
+        // How many pixels the run is across
+        int m_Width;
+
+        PixelSpan() { m_X = m_Y = m_Width = 0; }
+        PixelSpan(int posX, int posY, int width) { m_X = posX; m_Y = posY; m_Width = width; }
+    };
+
     //////////////////////////////////////////////////////////////////////////////////////////
     // Nested class:    Area
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -129,7 +149,7 @@ public:
     //                  read or not. 0 means it was read successfully, and any nonzero indicates
     //                  that a property of that name could not be found in this or base classes.
 
-        virtual int ReadProperty(std::string propName, Reader &reader);
+        virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -474,7 +494,7 @@ ENTITYALLOCATION(Scene)
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -751,11 +771,25 @@ ENTITYALLOCATION(Scene)
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetSeenPixels
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Gets the list of pixels that have been seen on a team's unseen layer.
+// Description:     Gets the runs of pixels that have been seen on a team's unseen layer.
 // Arguments:       Which team to get the unseen layer for.
-// Return value:    The list of pixel coordinates in the unseen layer's scale.
+// Return value:    The runs of pixels, in the unseen layer's scale.
+
+    const std::vector<PixelSpan> & GetSeenPixels(int team = Activity::TEAM_1) const { return m_SeenPixels[team]; }
 
-    std::list<Vector> & GetSeenPixels(int team = Activity::TEAM_1) { return m_SeenPixels[team]; }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddSeenPixels
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a run of pixels that have been seen on a team's unseen layer, so
+//                  they get flashed and cleaned up around. Runs continuing the last one
+//                  added are merged into it.
+// Arguments:       The leftmost pixel of the run, in the unseen layer's scale.
+//                  How many pixels the run is across.
+//                  Which team's unseen layer the pixels were seen on.
+// Return value:    None.
+
+    void AddSeenPixels(int posX, int posY, int width = 1, int team = Activity::TEAM_1) { AddPixelSpan(m_SeenPixels[team], posX, posY, width); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1310,6 +1344,71 @@ const SceneObject * PickPlacedActorInRange(int whichSet, Vector &scenePoint, int
     int CalculateScenePath(const Vector start, const Vector end, bool movePathToGround, float digStrength = 1);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up the least difficult path between two points on the current
+//                  scene to be calculated on the pathfinding thread. The result can be
+//                  gotten with GetPathResult or FetchScenePath from the update after the
+//                  next one on.
+// Arguments:       Start and end positions on the scene to find the path between.
+//                  The maximum material strength any actor traveling along the path can
+//                  dig through.
+// Return value:    The ID of the request, or -1 if there's no pathfinding on this Scene.
+
+    int RequestPath(const Vector &start, const Vector &end, float digStrength = 1);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPathResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the result of a path request made with RequestPath, if it's done.
+//                  Each result can only be gotten once.
+// Arguments:       The ID of the request.
+//                  A list which will be filled out with waypoints between the start and
+//                  end, if the result is ready.
+//                  The total minimum difficulty cost calculated between the two points on
+//                  the scene, or -1 if there is no path.
+// Return value:    Whether the result was ready.
+
+    bool GetPathResult(int requestID, std::list<Vector> &pathResult, float &totalCostResult);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FetchScenePath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the result of a path request made with RequestPath into the
+//                  ScenePath, if it's done. For exposing RequestPath to Lua.
+// Arguments:       The ID of the request.
+//                  If the path should be moved to the ground or not.
+// Return value:    The number of waypoints from start to goal, or -1 if the result isn't
+//                  ready.
+
+    int FetchScenePath(int requestID, bool movePathToGround);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a path request made with RequestPath is still waiting
+//                  to be calculated.
+// Arguments:       The ID of the request.
+// Return value:    Whether the request is still pending.
+
+    bool IsPathRequestPending(int requestID) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels a path request made with RequestPath, or throws away its
+//                  result if it's already done.
+// Arguments:       The ID of the request.
+// Return value:    None.
+
+    void CancelPathRequest(int requestID);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetScenePathSize
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1368,6 +1467,18 @@ const SceneObject * PickPlacedActorInRange(int whichSet, Vector &scenePoint, int
     void Update();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSim
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the parts of this Scene that go along with the simulation,
+//                  ie the pathfinding costs and path requests. Supposed to be done once
+//                  every sim update, after the MovableMan update.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateSim();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsMetagameInternal
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1450,10 +1561,10 @@ protected:
     Vector m_UnseenPixelSize[Activity::MAXTEAMCOUNT];
     // Layers representing the unknown areas for each team
     SceneLayer *m_apUnseenLayer[Activity::MAXTEAMCOUNT];
-    // Which pixels of the unseen map have just been revealed this frame, in the coordinates of the unseen map
-    std::list<Vector> m_SeenPixels[Activity::MAXTEAMCOUNT];
-    // Pixels on the unseen map deemed to be orphans and cleaned up, will be moved to seen pixels next update
-    std::list<Vector> m_CleanedPixels[Activity::MAXTEAMCOUNT];
+    // Which runs of pixels of the unseen map have just been revealed this frame, in the coordinates of the unseen map
+    std::vector<PixelSpan> m_SeenPixels[Activity::MAXTEAMCOUNT];
+    // Runs of pixels on the unseen map deemed to be orphans and cleaned up, will be moved to seen pixels next update
+    std::vector<PixelSpan> m_CleanedPixels[Activity::MAXTEAMCOUNT];
     // Whether this Scene is scheduled to be orbitally scanned by any team
     bool m_ScanScheduled[Activity::MAXTEAMCOUNT];
 
@@ -1496,6 +1607,19 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddPixelSpan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a run of pixels to a list of them, merging it into the last one
+//                  if it continues it on the same row.
+// Arguments:       The list of runs to add to.
+//                  The leftmost pixel of the run.
+//                  How many pixels the run is across.
+// Return value:    None.
+
+    static void AddPixelSpan(std::vector<PixelSpan> &spans, int posX, int posY, int width);
+
+
     // Disallow the use of some implicit methods.
     Scene(const Scene &reference) { RTEAbort("Tried to use forbidden method"); }
     void operator=(const Scene &rhs) { RTEAbort("Tried to use forbidden method"); }
@@ -42,7 +42,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int SoundContainer::ReadProperty(std::string propName, Reader &reader) {
+	int SoundContainer::ReadProperty(const std::string &propName, Reader &reader) {
 		if (propName == "AddSound") {
 			ContentFile newFile;
 			reader >> newFile;
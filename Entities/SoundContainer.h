@@ -95,7 +95,7 @@ namespace RTE {
 		/// An error return value signaling whether the property was successfully read or not.
 		/// 0 means it was read successfully, and any nonzero indicates that a property of that name could not be found in this or base classes.
 		/// </returns>
-		virtual int ReadProperty(std::string propName, Reader &reader);
+		virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 		/// <summary>
 		/// Saves the complete state of this SoundContainer to an output stream for later recreation with Create(Reader &reader).
@@ -28,7 +28,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int TDExplosive::ReadProperty(std::string propName, Reader &reader) {
+	int TDExplosive::ReadProperty(const std::string &propName, Reader &reader) {
 		if (propName == "DetonationSound") //TODO Consider removing this as GibSound already exists and could be used in its place
 			reader >> m_GibSound;
 		else if (propName == "IsAnimatedManually")
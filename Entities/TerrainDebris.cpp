@@ -91,7 +91,7 @@ int TerrainDebris::Create(const TerrainDebris &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int TerrainDebris::ReadProperty(std::string propName, Reader &reader)
+int TerrainDebris::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "DebrisFile")
         reader >> m_DebrisFile;
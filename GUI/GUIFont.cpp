@@ -36,6 +36,10 @@ GUIFont::GUIFont(std::string Name)
     m_CurrentBitmap = 0;
 
     m_CharIndexCap = 256;
+
+    m_BackgroundColor = 0;
+    m_TextCacheUsable = false;
+    m_TextCachePixels = 0;
 }
 
 
@@ -58,6 +62,7 @@ bool GUIFont::Load(GUIScreen *Screen, const std::string Filename)
 
     // Clear the cache
     m_ColorCache.clear();
+    ClearTextCache();
 
     // Convert the MainColor
     m_MainColor = Screen->ConvertColor(m_MainColor, m_CurrentBitmap->GetColorDepth());
@@ -66,6 +71,27 @@ bool GUIFont::Load(GUIScreen *Screen, const std::string Filename)
     // Set the color key to be the same color as the Top-Right hand corner pixel
     unsigned long BackG = m_Font->GetPixel(m_Font->GetWidth()-1, 0);
     m_Font->SetColorKey(BackG);
+    m_BackgroundColor = BackG;
+
+    // Text can only be cached in bitmaps made by the screen if they hold the glyphs as they are,
+    // and if the background color is left out when they're drawn, like it is for the glyphs
+    m_TextCacheUsable = false;
+    GUIBitmap *TestBitmap = m_Screen->CreateBitmap(1, 1);
+    GUIBitmap *TestTarget = m_Screen->CreateBitmap(1, 1);
+    if (TestBitmap && TestTarget && TestBitmap->GetColorDepth() == m_Font->GetColorDepth()) {
+        TestBitmap->SetPixel(0, 0, BackG);
+        TestTarget->SetPixel(0, 0, BackG ^ 1);
+        TestBitmap->DrawTrans(TestTarget, 0, 0, 0);
+        m_TextCacheUsable = TestTarget->GetPixel(0, 0) == (BackG ^ 1);
+    }
+    if (TestBitmap) {
+        TestBitmap->Destroy();
+        delete TestBitmap;
+    }
+    if (TestTarget) {
+        TestTarget->Destroy();
+        delete TestTarget;
+    }
 
     // The red seperator MUST be on the Top-Left hand corner
     unsigned long Red = m_Font->GetPixel(0, 0);
@@ -144,12 +170,10 @@ bool GUIFont::Load(GUIScreen *Screen, const std::string Filename)
 
 void GUIFont::Draw(GUIBitmap *Bitmap, int X, int Y, const std::string Text, unsigned long Shadow)
 {
-    unsigned char c;
-    int i;
-    GUIRect Rect;
     GUIBitmap *Surf = m_CurrentBitmap;
-    int initX = X;
-    
+    int Width = 0;
+    int Height = 0;
+
     assert(Surf);
 
     // Make the shadow color
@@ -161,37 +185,70 @@ void GUIFont::Draw(GUIBitmap *Bitmap, int X, int Y, const std::string Text, unsi
             FSC = GetFontColor(Shadow);
         }
     }
+    GUIBitmap *ShadowSurf = FSC ? FSC->m_Bitmap : 0;
+    unsigned long ShadowColor = FSC ? Shadow : 0;
 
-    // Go through every character
-    for(i=0; i<Text.length(); i++) {
-        c = Text.at(i);
+    if (!m_TextCacheUsable || Text.empty()) {
+        LayoutText(Text, m_GlyphRun, Width, Height);
+        DrawGlyphs(Bitmap, X, Y, m_GlyphRun, Surf, ShadowSurf);
+        return;
+    }
 
-        if (c == '\n') {
-            Y += m_FontHeight;
-            X = initX;
+    // Look for the text among the ones drawn recently, in the same colors
+    size_t Hash = std::hash<std::string>()(Text);
+    Hash ^= std::hash<unsigned long>()(m_CurrentColor) + 0x9E3779B9 + (Hash << 6) + (Hash >> 2);
+    Hash ^= std::hash<unsigned long>()(ShadowColor) + 0x9E3779B9 + (Hash << 6) + (Hash >> 2);
+
+    std::unordered_map<size_t, std::list<CachedText>::iterator>::iterator Found = m_TextCacheLookup.find(Hash);
+    if (Found == m_TextCacheLookup.end()) {
+        // Only remember it the first time, most text that's drawn once is never drawn again
+        CachedText NewText;
+        NewText.m_Hash = Hash;
+        NewText.m_Text = Text;
+        NewText.m_Color = m_CurrentColor;
+        NewText.m_Shadow = ShadowColor;
+        NewText.m_Bitmap = 0;
+        NewText.m_Pixels = 0;
+        m_TextCache.push_front(NewText);
+        m_TextCacheLookup[Hash] = m_TextCache.begin();
+        TrimTextCache();
+
+        LayoutText(Text, m_GlyphRun, Width, Height);
+        DrawGlyphs(Bitmap, X, Y, m_GlyphRun, Surf, ShadowSurf);
+        return;
+    }
+
+    std::list<CachedText>::iterator Cached = Found->second;
+    if (Cached->m_Text != Text || Cached->m_Color != m_CurrentColor || Cached->m_Shadow != ShadowColor) {
+        // Some other text with the same hash, just leave it be
+        LayoutText(Text, m_GlyphRun, Width, Height);
+        DrawGlyphs(Bitmap, X, Y, m_GlyphRun, Surf, ShadowSurf);
+        return;
+    }
+    m_TextCache.splice(m_TextCache.begin(), m_TextCache, Cached);
+
+    // Drawn a second time, so draw it into its own bitmap to be blitted from now on
+    if (!Cached->m_Bitmap) {
+        LayoutText(Text, m_GlyphRun, Width, Height);
+        if (m_Kerning >= 0 && Width > 0 && Height > 0 && Width * Height <= c_TextCacheMaxPixels / 4) {
+            Cached->m_Bitmap = m_Screen->CreateBitmap(Width, Height);
+            if (Cached->m_Bitmap) {
+                Cached->m_Bitmap->DrawRectangle(0, 0, Width, Height, m_BackgroundColor, true);
+                DrawGlyphs(Cached->m_Bitmap, 0, 0, m_GlyphRun, Surf, ShadowSurf);
+                Cached->m_Pixels = Width * Height;
+                m_TextCachePixels += Cached->m_Pixels;
+                TrimTextCache();
+            }
         }
-        if (c == '\t') {
-            X += m_Characters[' '].m_Width * 4;
+        if (!Cached->m_Bitmap) {
+            DrawGlyphs(Bitmap, X, Y, m_GlyphRun, Surf, ShadowSurf);
+            return;
         }
-        if (c < 0)
-            c += m_CharIndexCap;
-        if (c < 32 || c >= m_CharIndexCap)
-            continue;
-
-        int CharWidth = m_Characters[c].m_Width;
-        int offX = m_Characters[c].m_Offset;
-        int offY = ((c-32)/16) * m_FontHeight;
-        SetRect(&Rect, offX, offY, offX+CharWidth, offY+m_FontHeight);
-
-        // Draw the shadow
-        if (Shadow && FSC)
-            FSC->m_Bitmap->DrawTrans(Bitmap, X+1, Y+1, &Rect);
-        // Draw the main color
-        Surf->DrawTrans(Bitmap, X, Y, &Rect);
-
-        // Find the starting position
-        X += CharWidth + m_Kerning;
     }
+
+    GUIRect Rect;
+    SetRect(&Rect, 0, 0, Cached->m_Bitmap->GetWidth(), Cached->m_Bitmap->GetHeight());
+    Cached->m_Bitmap->DrawTrans(Bitmap, X, Y, &Rect);
 }
 
 
@@ -285,6 +342,38 @@ void GUIFont::DrawAligned(GUIBitmap *Bitmap, int X, int Y, const std::string Tex
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawBatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws many pieces of text to a bitmap in one go, in order.
+
+void GUIFont::DrawBatch(GUIBitmap *Bitmap, const std::vector<TextDraw> &Texts)
+{
+    unsigned long PrevColor = m_CurrentColor;
+    GUIBitmap *PrevBitmap = m_CurrentBitmap;
+
+    vector<TextDraw>::const_iterator it;
+    for(it = Texts.begin(); it != Texts.end(); it++) {
+        if (it->m_Color) {
+            CacheColor(it->m_Color);
+            SetColor(it->m_Color);
+        } else {
+            m_CurrentColor = PrevColor;
+            m_CurrentBitmap = PrevBitmap;
+        }
+
+        // Left aligned text comes out the same drawn as a whole, which keeps multi-line text in one piece in the cache
+        if (it->m_HAlign == Left)
+            Draw(Bitmap, it->m_X, it->m_Y, it->m_Text, it->m_Shadow);
+        else
+            DrawAligned(Bitmap, it->m_X, it->m_Y, it->m_Text, it->m_HAlign, Top, 0, it->m_Shadow);
+    }
+
+    m_CurrentColor = PrevColor;
+    m_CurrentBitmap = PrevBitmap;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SetColor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -544,4 +633,116 @@ void GUIFont::Destroy(void)
     }
 
     m_ColorCache.clear();
+
+    ClearTextCache();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LayoutText
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Places every character of a piece of text the way Draw does, and
+//                  measures the area it covers including the drop-shadow.
+
+void GUIFont::LayoutText(const std::string &Text, std::vector<PlacedGlyph> &Glyphs, int &Width, int &Height)
+{
+    unsigned char c;
+    int X = 0;
+    int Y = 0;
+
+    Glyphs.clear();
+    Width = 0;
+    Height = 0;
+
+    // Go through every character
+    for(int i=0; i<Text.length(); i++) {
+        c = Text.at(i);
+
+        if (c == '\n') {
+            Y += m_FontHeight;
+            X = 0;
+        }
+        if (c == '\t') {
+            X += m_Characters[' '].m_Width * 4;
+        }
+        if (c < 32 || c >= m_CharIndexCap)
+            continue;
+
+        PlacedGlyph Glyph = { X, Y, c };
+        Glyphs.push_back(Glyph);
+
+        // The drop-shadow reaches one pixel further right and down
+        Width = MAX(Width, X + m_Characters[c].m_Width + 1);
+        Height = MAX(Height, Y + m_FontHeight + 1);
+
+        // Find the starting position
+        X += m_Characters[c].m_Width + m_Kerning;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawGlyphs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws a laid out run of glyphs to a bitmap, one character at a time.
+
+void GUIFont::DrawGlyphs(GUIBitmap *Bitmap, int X, int Y, const std::vector<PlacedGlyph> &Glyphs, GUIBitmap *Surf, GUIBitmap *ShadowSurf)
+{
+    GUIRect Rect;
+
+    vector<PlacedGlyph>::const_iterator it;
+    for(it = Glyphs.begin(); it != Glyphs.end(); it++) {
+        int CharWidth = m_Characters[it->m_Char].m_Width;
+        int offX = m_Characters[it->m_Char].m_Offset;
+        int offY = ((it->m_Char-32)/16) * m_FontHeight;
+        SetRect(&Rect, offX, offY, offX+CharWidth, offY+m_FontHeight);
+
+        // Draw the shadow
+        if (ShadowSurf)
+            ShadowSurf->DrawTrans(Bitmap, X+it->m_X+1, Y+it->m_Y+1, &Rect);
+        // Draw the main color
+        Surf->DrawTrans(Bitmap, X+it->m_X, Y+it->m_Y, &Rect);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TrimTextCache
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Drops the least recently drawn cached pieces of text until the cache
+//                  is within its limits.
+
+void GUIFont::TrimTextCache(void)
+{
+    while (m_TextCache.size() > 1 && (static_cast<int>(m_TextCache.size()) > c_TextCacheMaxEntries || m_TextCachePixels > c_TextCacheMaxPixels)) {
+        CachedText &Oldest = m_TextCache.back();
+        if (Oldest.m_Bitmap) {
+            Oldest.m_Bitmap->Destroy();
+            delete Oldest.m_Bitmap;
+        }
+        m_TextCachePixels -= Oldest.m_Pixels;
+        m_TextCacheLookup.erase(Oldest.m_Hash);
+        m_TextCache.pop_back();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearTextCache
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destroys all the cached pieces of text.
+
+void GUIFont::ClearTextCache(void)
+{
+    list<CachedText>::iterator it;
+    for(it = m_TextCache.begin(); it != m_TextCache.end(); it++) {
+        if (it->m_Bitmap) {
+            it->m_Bitmap->Destroy();
+            delete it->m_Bitmap;
+        }
+    }
+
+    m_TextCache.clear();
+    m_TextCacheLookup.clear();
+    m_TextCachePixels = 0;
 }
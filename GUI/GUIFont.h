@@ -56,6 +56,19 @@ public:
         GUIBitmap    *m_Bitmap;
     } FontColor;
 
+    // A piece of text to draw with DrawBatch
+    struct TextDraw {
+        int            m_X;
+        int            m_Y;
+        std::string    m_Text;
+        int            m_HAlign;
+        unsigned long  m_Color;            // 0 = the current color
+        unsigned long  m_Shadow;           // 0 = no drop-shadow
+
+        TextDraw(int X, int Y, const std::string &Text, int HAlign = Left, unsigned long Color = 0, unsigned long Shadow = 0) :
+            m_X(X), m_Y(Y), m_Text(Text), m_HAlign(HAlign), m_Color(Color), m_Shadow(Shadow) {}
+    };
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor:     GUIFont
@@ -112,6 +125,17 @@ public:
     void DrawAligned(GUIBitmap *Bitmap, int X, int Y, const std::string Text, int HAlign, int VAlign = Top, int maxWidth = 0, unsigned long Shadow = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawBatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws many pieces of text to a bitmap in one go, in order. Each can
+//                  have its own color, which gets cached if it isn't already. The current
+//                  color is left as it was.
+// Arguments:       Bitmap, the pieces of text.
+
+    void DrawBatch(GUIBitmap *Bitmap, const std::vector<TextDraw> &Texts);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SetColor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -192,7 +216,7 @@ public:
 //                  between chars, 0 = chars are touching.
 // Arguments:       None.
 
-    void SetKerning(int newKerning = 1) { m_Kerning = newKerning; }
+    void SetKerning(int newKerning = 1) { if (newKerning != m_Kerning) { m_Kerning = newKerning; ClearTextCache(); } }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -200,6 +224,28 @@ public:
 
 private:
 
+    // A character placed by LayoutText
+    typedef struct {
+        int            m_X;                // Relative to where the text is drawn
+        int            m_Y;
+        unsigned char  m_Char;
+    } PlacedGlyph;
+
+    // A piece of text drawn recently, which gets drawn into its own bitmap the second time
+    // around so it can be drawn with a single blit after that
+    typedef struct {
+        size_t         m_Hash;
+        std::string    m_Text;
+        unsigned long  m_Color;
+        unsigned long  m_Shadow;
+        GUIBitmap      *m_Bitmap;          // The text over the font's background color, 0 until it's drawn a second time
+        int            m_Pixels;           // How many pixels m_Bitmap has
+    } CachedText;
+
+    // How many pieces of text, and how many pixels of their bitmaps, are cached before the least recently drawn ones are dropped
+    static const int c_TextCacheMaxEntries = 256;
+    static const int c_TextCacheMaxPixels = 1024 * 1024;
+
     GUIBitmap        *m_Font;
     GUIScreen        *m_Screen;
     std::vector<FontColor >    m_ColorCache;
@@ -215,6 +261,52 @@ private:
 
     int                m_Kerning;            // Spacing between characters
     int                m_Leading;            // Spacing between lines
+
+    unsigned long      m_BackgroundColor;    // The color key of the font bitmap
+    bool               m_TextCacheUsable;    // Whether bitmaps made by the screen can hold this font's glyphs
+    std::list<CachedText> m_TextCache;       // The most recently drawn first
+    std::unordered_map<size_t, std::list<CachedText>::iterator> m_TextCacheLookup;
+    int                m_TextCachePixels;
+    std::vector<PlacedGlyph> m_GlyphRun;     // Reused by Draw for laying out text
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LayoutText
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Places every character of a piece of text the way Draw does, and
+//                  measures the area it covers including the drop-shadow.
+// Arguments:       Text, the run of glyphs to fill, the width and height to set.
+
+    void LayoutText(const std::string &Text, std::vector<PlacedGlyph> &Glyphs, int &Width, int &Height);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawGlyphs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Draws a laid out run of glyphs to a bitmap, one character at a time.
+// Arguments:       Bitmap, Position, the glyphs, the colored font bitmaps for the main
+//                  color and the drop-shadow, 0 = none.
+
+    void DrawGlyphs(GUIBitmap *Bitmap, int X, int Y, const std::vector<PlacedGlyph> &Glyphs, GUIBitmap *Surf, GUIBitmap *ShadowSurf);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TrimTextCache
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Drops the least recently drawn cached pieces of text until the cache
+//                  is within its limits. The most recently drawn one is always kept.
+// Arguments:       None.
+
+    void TrimTextCache(void);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearTextCache
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destroys all the cached pieces of text.
+// Arguments:       None.
+
+    void ClearTextCache(void);
 };
 
 
@@ -39,6 +39,7 @@
 #include "MOSParticle.h"
 #include "MOSRotating.h"
 #include "Controller.h"
+#include "GameActivity.h"
 
 #include "MultiplayerServerLobby.h"
 #include "NetworkServer.h"
@@ -131,6 +132,18 @@ int g_DifficultySetting = 4;
 int g_StationOffsetX;
 int g_StationOffsetY;
 
+bool g_RunBenchmark = false; //!< Flag for running a headless benchmark instead of the game.
+std::string g_BenchmarkActivity = ""; //!< The preset name of the Activity to benchmark.
+std::string g_BenchmarkScene = ""; //!< The preset name of the Scene to benchmark the Activity on.
+int g_BenchmarkFrames = 0; //!< How many sim updates to run the benchmark for.
+unsigned int g_BenchmarkSeed = 1; //!< The seed for the random number generators during the benchmark.
+std::string g_BenchmarkOutput = "Benchmark"; //!< The path, without extension, of the files to write the benchmark results to.
+std::string g_BenchmarkGibPreset = ""; //!< The preset name of the MOSRotating to spawn and gib at the start of the benchmark, if any.
+int g_BenchmarkGibCount = 0; //!< How many of the above to spawn and gib.
+bool g_RunReaderBenchmark = false; //!< Flag for timing how fast a Data Module's ini files are read instead of running the game.
+std::string g_ReaderBenchmarkModule = ""; //!< The Data Module to read for the reader benchmark.
+int g_ReaderBenchmarkPasses = 0; //!< How many times to read the whole Data Module for the reader benchmark.
+
 MainMenuGUI *g_pMainMenuGUI = 0;
 ScenarioGUI *g_pScenarioGUI = 0;
 Controller *g_pMainMenuController = 0;
@@ -1717,6 +1730,7 @@ bool RunGameLoop() {
 		// Simulation update, as many times as the fixed update step allows in the span since last frame draw
 		while (g_TimerMan.TimeForSimUpdate()) {
 			serverUpdated = false;
+			g_ProfilerMan.NewFrame();
 			g_FrameMan.NewPerformanceSample();
 
 			// Advance the simulation time by the fixed amount
@@ -1738,6 +1752,7 @@ bool RunGameLoop() {
 			g_ActivityMan.Update();
 			g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTIVITY);
 			g_MovableMan.Update();
+			g_SceneMan.UpdateSim();
 
 			g_ActivityMan.LateUpdateGlobalScripts();
 
@@ -1797,6 +1812,274 @@ bool RunGameLoop() {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// <summary>
+/// Everything recorded for a single sim update of a benchmark run.
+/// </summary>
+struct BenchmarkFrame {
+	int64_t m_CounterTimes[FrameMan::PERF_COUNT]; //!< The time spent in each performance counter, in microseconds.
+	long m_ActorCount; //!< The number of Actors at the end of the update.
+	long m_ItemCount; //!< The number of items at the end of the update.
+	long m_ParticleCount; //!< The number of particles at the end of the update.
+	int m_MOIDCount; //!< The number of MOIDs in use at the end of the update.
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Writes the results of a benchmark run out as a CSV file with a row per frame, and a JSON file with a per-counter summary and all the samples.
+/// </summary>
+/// <param name="frames">The recorded frames.</param>
+/// <returns>Whether both files were written successfully.</returns>
+bool WriteBenchmarkResults(const std::vector<BenchmarkFrame> &frames) {
+	std::ofstream csvFile(g_BenchmarkOutput + ".csv");
+	if (!csvFile.good()) {
+		return false;
+	}
+	csvFile << "Frame";
+	for (int counter = 0; counter < FrameMan::PERF_COUNT; ++counter) {
+		csvFile << "," << g_FrameMan.GetPerformanceCounterName(static_cast<FrameMan::PerformanceCounters>(counter));
+	}
+	csvFile << ",Actors,Items,Particles,MOIDs\n";
+	for (int frame = 0; frame < frames.size(); ++frame) {
+		csvFile << frame;
+		for (int counter = 0; counter < FrameMan::PERF_COUNT; ++counter) {
+			csvFile << "," << frames[frame].m_CounterTimes[counter];
+		}
+		csvFile << "," << frames[frame].m_ActorCount << "," << frames[frame].m_ItemCount << "," << frames[frame].m_ParticleCount << "," << frames[frame].m_MOIDCount << "\n";
+	}
+	csvFile.close();
+
+	std::ofstream jsonFile(g_BenchmarkOutput + ".json");
+	if (!jsonFile.good()) {
+		return false;
+	}
+	jsonFile << "{\n";
+	jsonFile << "\t\"activity\": \"" << EscapeJSONString(g_BenchmarkActivity) << "\",\n";
+	jsonFile << "\t\"scene\": \"" << EscapeJSONString(g_BenchmarkScene) << "\",\n";
+	jsonFile << "\t\"frames\": " << frames.size() << ",\n";
+	jsonFile << "\t\"seed\": " << g_BenchmarkSeed << ",\n";
+	jsonFile << "\t\"deltaTimeMS\": " << g_TimerMan.GetDeltaTimeMS() << ",\n";
+	jsonFile << "\t\"threads\": " << g_ThreadMan.GetThreadCount() << ",\n";
+
+	jsonFile << "\t\"counters\": {\n";
+	std::vector<int64_t> sortedTimes;
+	for (int counter = 0; counter < FrameMan::PERF_COUNT; ++counter) {
+		sortedTimes.clear();
+		int64_t totalTime = 0;
+		for (const BenchmarkFrame &frame : frames) {
+			sortedTimes.push_back(frame.m_CounterTimes[counter]);
+			totalTime += frame.m_CounterTimes[counter];
+		}
+		std::sort(sortedTimes.begin(), sortedTimes.end());
+
+		jsonFile << "\t\t\"" << EscapeJSONString(g_FrameMan.GetPerformanceCounterName(static_cast<FrameMan::PerformanceCounters>(counter))) << "\": { ";
+		if (sortedTimes.empty()) {
+			jsonFile << "\"meanUS\": 0, \"minUS\": 0, \"maxUS\": 0, \"p50US\": 0, \"p99US\": 0 }";
+		} else {
+			jsonFile << "\"meanUS\": " << static_cast<double>(totalTime) / static_cast<double>(sortedTimes.size());
+			jsonFile << ", \"minUS\": " << sortedTimes.front();
+			jsonFile << ", \"maxUS\": " << sortedTimes.back();
+			jsonFile << ", \"p50US\": " << sortedTimes[(sortedTimes.size() - 1) / 2];
+			jsonFile << ", \"p99US\": " << sortedTimes[((sortedTimes.size() - 1) * 99) / 100] << " }";
+		}
+		jsonFile << (counter + 1 < FrameMan::PERF_COUNT ? ",\n" : "\n");
+	}
+	jsonFile << "\t},\n";
+
+	jsonFile << "\t\"samples\": [\n";
+	for (int frame = 0; frame < frames.size(); ++frame) {
+		jsonFile << "\t\t{ \"counterTimesUS\": [";
+		for (int counter = 0; counter < FrameMan::PERF_COUNT; ++counter) {
+			jsonFile << (counter > 0 ? ", " : "") << frames[frame].m_CounterTimes[counter];
+		}
+		jsonFile << "], \"actors\": " << frames[frame].m_ActorCount << ", \"items\": " << frames[frame].m_ItemCount << ", \"particles\": " << frames[frame].m_ParticleCount << ", \"moids\": " << frames[frame].m_MOIDCount << " }";
+		jsonFile << (frame + 1 < frames.size() ? ",\n" : "\n");
+	}
+	jsonFile << "\t]\n}\n";
+	jsonFile.close();
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Spawns the MOSRotating bodies asked for with -benchmarkgibs evenly spread across the Scene, a little above the ground, and gibs them all right away.
+/// This makes a benchmark run mostly about the gibs' AtomGroups travelling against the terrain.
+/// </summary>
+/// <returns>Whether the preset was found and the bodies were spawned and gibbed.</returns>
+bool SpawnBenchmarkGibs() {
+	const MOSRotating *pPreset = dynamic_cast<const MOSRotating *>(g_PresetMan.GetEntityPreset("MOSRotating", g_BenchmarkGibPreset));
+	if (!pPreset) {
+		return false;
+	}
+	for (int body = 0; body < g_BenchmarkGibCount; ++body) {
+		MOSRotating *pBody = dynamic_cast<MOSRotating *>(pPreset->Clone());
+		Vector spawnPos((static_cast<float>(body) + 0.5F) * static_cast<float>(g_SceneMan.GetSceneWidth()) / static_cast<float>(g_BenchmarkGibCount), 0);
+		pBody->SetPos(g_SceneMan.MovePointToGround(spawnPos, 50, 5));
+		g_MovableMan.AddParticle(pBody);
+		pBody->GibThis();
+	}
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Runs the Activity and Scene specified with -benchmark for a fixed number of sim updates, without drawing anything or taking any input, and writes out how long each part of every update took.
+/// Time is advanced by exactly one DeltaTime per update and the random number generators are seeded with a fixed seed, so the same run can be repeated to compare performance between builds.
+/// </summary>
+/// <returns>The exit code for the program; 0 on success, 2 if the benchmark couldn't be started or its results couldn't be written.</returns>
+int RunBenchmark() {
+	const Activity *pActivityPreset = 0;
+	std::list<Entity *> activityList;
+	g_PresetMan.GetAllOfType(activityList, "Activity");
+	for (const Entity *pEntity : activityList) {
+		if (pEntity->GetPresetName() == g_BenchmarkActivity) {
+			pActivityPreset = dynamic_cast<const Activity *>(pEntity);
+			break;
+		}
+	}
+	if (!pActivityPreset) {
+		g_System.PrintToCLI("ERROR: Couldn't find the Activity named " + g_BenchmarkActivity + " to benchmark!");
+		return 2;
+	}
+	if (g_SceneMan.SetSceneToLoad(g_BenchmarkScene) < 0) {
+		g_System.PrintToCLI("ERROR: Couldn't find the Scene named " + g_BenchmarkScene + " to benchmark!");
+		return 2;
+	}
+
+	// Nobody is at the controls, so both teams are left to the AI
+	Activity *pActivity = dynamic_cast<Activity *>(pActivityPreset->Clone());
+	pActivity->ClearPlayers(false);
+	pActivity->AddPlayer(Activity::PLAYER_1, false, Activity::TEAM_1, 0);
+	if (GameActivity *pGameActivity = dynamic_cast<GameActivity *>(pActivity)) { pGameActivity->SetCPUTeam(Activity::TEAM_2); }
+	g_ActivityMan.SetStartActivity(pActivity);
+
+	SeedRand(g_BenchmarkSeed);
+	g_LuaMan.RunScriptString("math.randomseed(" + std::to_string(g_BenchmarkSeed) + ")");
+
+	g_MovableMan.PurgeAllMOs();
+	g_TimerMan.ResetTime();
+	g_TimerMan.PauseSim(false);
+	if (g_ActivityMan.RestartActivity() < 0) {
+		g_System.PrintToCLI("ERROR: Couldn't start the Activity named " + g_BenchmarkActivity + " to benchmark!");
+		return 2;
+	}
+	g_InActivity = true;
+
+	if (!g_BenchmarkGibPreset.empty() && !SpawnBenchmarkGibs()) {
+		g_System.PrintToCLI("ERROR: Couldn't find the MOSRotating named " + g_BenchmarkGibPreset + " to gib!");
+		return 2;
+	}
+
+	std::vector<BenchmarkFrame> frames;
+	frames.reserve(g_BenchmarkFrames);
+
+	for (int frame = 0; frame < g_BenchmarkFrames && !g_Quit; ++frame) {
+		g_TimerMan.UpdateFixedStep();
+		g_ProfilerMan.NewFrame();
+		g_FrameMan.NewPerformanceSample();
+		g_TimerMan.UpdateSim();
+
+		g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_SIM_TOTAL);
+		g_FrameMan.Update();
+		g_AudioMan.Update();
+		g_LuaMan.Update();
+		g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_ACTIVITY);
+		g_ActivityMan.Update();
+		g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTIVITY);
+		g_MovableMan.Update();
+		g_SceneMan.UpdateSim();
+		g_ActivityMan.LateUpdateGlobalScripts();
+		g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_SIM_TOTAL);
+
+		BenchmarkFrame frameResult;
+		for (int counter = 0; counter < FrameMan::PERF_COUNT; ++counter) {
+			frameResult.m_CounterTimes[counter] = g_FrameMan.GetPerformanceSample(static_cast<FrameMan::PerformanceCounters>(counter));
+		}
+		frameResult.m_ActorCount = g_MovableMan.GetActorCount();
+		frameResult.m_ItemCount = g_MovableMan.GetItemCount();
+		frameResult.m_ParticleCount = g_MovableMan.GetParticleCount();
+		frameResult.m_MOIDCount = g_MovableMan.GetMOIDCount();
+		frames.push_back(frameResult);
+	}
+	g_InActivity = false;
+
+	if (!WriteBenchmarkResults(frames)) {
+		g_System.PrintToCLI("ERROR: Couldn't write the benchmark results to " + g_BenchmarkOutput + "!");
+		return 2;
+	}
+	g_System.PrintToCLI("Benchmark results written to " + g_BenchmarkOutput + ".csv and " + g_BenchmarkOutput + ".json");
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Reads every property of a Data Module's Index.ini and all the files it includes a number of times over, without creating any Entities, and writes out how long each pass took.
+/// This times just the Reader's tokenizing, separately from everything else that goes into loading a Data Module.
+/// </summary>
+/// <returns>The exit code the program should return with, 0 if the benchmark ran through.</returns>
+int RunReaderBenchmark() {
+	std::vector<int64_t> passTimes;
+	passTimes.reserve(g_ReaderBenchmarkPasses);
+	long propertyCount = 0;
+
+	for (int pass = 0; pass < g_ReaderBenchmarkPasses; ++pass) {
+		int64_t startTime = g_TimerMan.GetAbsoulteTime();
+
+		Reader reader;
+		if (reader.Create((g_ReaderBenchmarkModule + "/Index.ini").c_str(), true, 0, true) < 0 || !reader.IsOK()) {
+			g_System.PrintToCLI("ERROR: Couldn't open " + g_ReaderBenchmarkModule + "/Index.ini to read!");
+			return 2;
+		}
+		// Skip the DataModule type name, then read every property at every level of indentation until the last included file runs out
+		reader.ReadPropValue();
+		propertyCount = 0;
+		while (reader.DiscardEmptySpace()) {
+			if (reader.ReadPropName() != "") {
+				reader.ReadPropValue();
+				++propertyCount;
+			}
+		}
+		passTimes.push_back(g_TimerMan.GetAbsoulteTime() - startTime);
+	}
+	std::vector<int64_t> sortedTimes = passTimes;
+	std::sort(sortedTimes.begin(), sortedTimes.end());
+	int64_t totalTime = 0;
+	for (const int64_t &passTime : passTimes) {
+		totalTime += passTime;
+	}
+	double meanTime = static_cast<double>(totalTime) / static_cast<double>(passTimes.size());
+
+	char report[512];
+	sprintf_s(report, sizeof(report), "Read %li properties from %s in %.2f ms on average (%.2f ms at best), %.0f properties per second", propertyCount, g_ReaderBenchmarkModule.c_str(), meanTime / 1000.0, static_cast<double>(sortedTimes.front()) / 1000.0, meanTime > 0 ? static_cast<double>(propertyCount) * 1000000.0 / meanTime : 0.0);
+	g_System.PrintToCLI(report);
+
+	std::ofstream jsonFile(g_BenchmarkOutput + ".json");
+	if (!jsonFile.good()) {
+		g_System.PrintToCLI("ERROR: Couldn't write the benchmark results to " + g_BenchmarkOutput + "!");
+		return 2;
+	}
+	jsonFile << "{\n";
+	jsonFile << "\t\"module\": \"" << EscapeJSONString(g_ReaderBenchmarkModule) << "\",\n";
+	jsonFile << "\t\"passes\": " << passTimes.size() << ",\n";
+	jsonFile << "\t\"properties\": " << propertyCount << ",\n";
+	jsonFile << "\t\"meanUS\": " << meanTime << ", \"minUS\": " << sortedTimes.front() << ", \"maxUS\": " << sortedTimes.back() << ", \"p50US\": " << sortedTimes[(sortedTimes.size() - 1) / 2] << ",\n";
+	jsonFile << "\t\"passTimesUS\": [";
+	for (int pass = 0; pass < passTimes.size(); ++pass) {
+		jsonFile << (pass > 0 ? ", " : "") << passTimes[pass];
+	}
+	jsonFile << "]\n}\n";
+	jsonFile.close();
+
+	g_System.PrintToCLI("Benchmark results written to " + g_BenchmarkOutput + ".json");
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// <summary>
 /// Command-line argument handling.
 /// </summary>
@@ -1834,6 +2117,36 @@ bool HandleMainArgs(int argc, char *argv[], int &appExitVar) {
 						g_EditorToLaunch = editorName;
 						g_LaunchIntoEditor = true;
 					}
+				// Run a headless benchmark of an activity on a scene for a number of frames and quit
+				} else if (std::strcmp(argv[i], "-benchmark") == 0 && i + 3 < argc) {
+					g_BenchmarkActivity = argv[++i];
+					g_BenchmarkScene = argv[++i];
+					g_BenchmarkFrames = std::atoi(argv[++i]);
+					if (g_BenchmarkFrames <= 0) {
+						return false;
+					}
+					g_RunBenchmark = true;
+					g_System.SetLogToCLI(true);
+				} else if (std::strcmp(argv[i], "-benchmarkseed") == 0 && i + 1 < argc) {
+					g_BenchmarkSeed = std::strtoul(argv[++i], 0, 10);
+				} else if (std::strcmp(argv[i], "-benchmarkoutput") == 0 && i + 1 < argc) {
+					g_BenchmarkOutput = argv[++i];
+				// Spawn and gib a number of bodies at the start of the benchmark, to measure how fast their gibs collide with the terrain
+				} else if (std::strcmp(argv[i], "-benchmarkgibs") == 0 && i + 2 < argc) {
+					g_BenchmarkGibPreset = argv[++i];
+					g_BenchmarkGibCount = std::atoi(argv[++i]);
+					if (g_BenchmarkGibCount <= 0) {
+						return false;
+					}
+				// Time reading all of a Data Module's ini files a number of times over and quit
+				} else if (std::strcmp(argv[i], "-benchmarkreader") == 0 && i + 2 < argc) {
+					g_ReaderBenchmarkModule = argv[++i];
+					g_ReaderBenchmarkPasses = std::atoi(argv[++i]);
+					if (g_ReaderBenchmarkPasses <= 0) {
+						return false;
+					}
+					g_RunReaderBenchmark = true;
+					g_System.SetLogToCLI(true);
 				}
             }
         }
@@ -1877,6 +2190,8 @@ int main(int argc, char *argv[]) {
     new LuaMan();
     new SettingsMan();
     new TimerMan();
+    new ThreadMan();
+    new ProfilerMan();
     new PresetMan();
     new FrameMan();
     new AudioMan();
@@ -1905,7 +2220,15 @@ int main(int argc, char *argv[]) {
 		return exitVar;
 	}
     g_TimerMan.Create();
+    g_ThreadMan.Create(g_SettingsMan.GetWorkerThreadCount());
+    g_ProfilerMan.Create();
     g_PresetMan.Create();
+	if (g_RunBenchmark || g_RunReaderBenchmark) {
+		g_FrameMan.SetHeadless(true);
+		g_AudioMan.SetSilentOutput(true);
+		// Nothing is shown, so don't spend any of the measured time drawing the MO layer or gathering screen effects either
+		g_TimerMan.SetSimUpdatesDrawn(false);
+	}
     g_FrameMan.Create();
     g_AudioMan.Create(); //NOTE: By necessity of when things can be instantiated, this internally does: new GUISound()
 	g_GUISound.Create();
@@ -1941,28 +2264,39 @@ int main(int argc, char *argv[]) {
 	}
 
     new LoadingGUI();
-	g_LoadingGUI.InitLoadingScreen();
-	InitMainMenu();
-
-	if (g_LaunchIntoEditor) { 
-		// Force mouse + keyboard with default mapping so we won't need to change manually if player 1 is set to keyboard only or gamepad.
-		g_UInputMan.GetControlScheme(0)->SetDevice(1);
-		g_UInputMan.GetControlScheme(0)->SetPreset(1);
-		// Disable intro sequence.
-		g_SettingsMan.SetPlayIntro(false);
-		// Start the specified editor activity.
-		EnterEditorActivity(g_EditorToLaunch);
-	}
 
-    if (g_SettingsMan.PlayIntro() && !g_NetworkServer.IsServerModeEnabled()) { PlayIntroTitle(); }
+	int benchmarkExitVar = 0;
+	if (g_RunReaderBenchmark) {
+		// Only the Readers are timed, so nothing is loaded beforehand
+		benchmarkExitVar = RunReaderBenchmark();
+	} else if (g_RunBenchmark) {
+		// No loading screen, menus or intro; just the data and the benchmark itself
+		g_LoadingGUI.LoadDataModules();
+		benchmarkExitVar = RunBenchmark();
+	} else {
+		g_LoadingGUI.InitLoadingScreen();
+		InitMainMenu();
+
+		if (g_LaunchIntoEditor) {
+			// Force mouse + keyboard with default mapping so we won't need to change manually if player 1 is set to keyboard only or gamepad.
+			g_UInputMan.GetControlScheme(0)->SetDevice(1);
+			g_UInputMan.GetControlScheme(0)->SetPreset(1);
+			// Disable intro sequence.
+			g_SettingsMan.SetPlayIntro(false);
+			// Start the specified editor activity.
+			EnterEditorActivity(g_EditorToLaunch);
+		}
 
-	// NETWORK Create multiplayer lobby activity to start as default if server is running
-	if (g_NetworkServer.IsServerModeEnabled()) { EnterMultiplayerLobby(); }
+		if (g_SettingsMan.PlayIntro() && !g_NetworkServer.IsServerModeEnabled()) { PlayIntroTitle(); }
 
-    // If we fail to start/reset the activity, then revert to the intro/menu
-    if (!ResetActivity()) { PlayIntroTitle(); }
-	
-    RunGameLoop();
+		// NETWORK Create multiplayer lobby activity to start as default if server is running
+		if (g_NetworkServer.IsServerModeEnabled()) { EnterMultiplayerLobby(); }
+
+		// If we fail to start/reset the activity, then revert to the intro/menu
+		if (!ResetActivity()) { PlayIntroTitle(); }
+
+		RunGameLoop();
+	}
 
     ///////////////////////////////////////////////////////////////////
     // Clean up
@@ -1979,6 +2313,8 @@ int main(int argc, char *argv[]) {
     g_PresetMan.Destroy();
     g_UInputMan.Destroy();
     g_FrameMan.Destroy();
+    g_ThreadMan.Destroy();
+    g_ProfilerMan.Destroy();
     g_TimerMan.Destroy();
     g_SettingsMan.Destroy();
     g_LuaMan.Destroy();
@@ -1990,7 +2326,7 @@ int main(int argc, char *argv[]) {
     Entity::ClassInfo::DumpPoolMemoryInfo(Writer("MemCleanupInfo.txt"));
 #endif
 	
-    return 0;
+    return benchmarkExitVar;
 }
 
 int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) { return main(__argc, __argv); }
\ No newline at end of file
@@ -204,7 +204,7 @@ int Activity::Create(const Activity &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int Activity::ReadProperty(std::string propName, Reader &reader)
+int Activity::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Description")
         reader >> m_Description;
@@ -1,6 +1,7 @@
 #include "AudioMan.h"
 #include "ConsoleMan.h"
 #include "SettingsMan.h"
+#include "ProfilerMan.h"
 #include "SceneMan.h"
 #include "SoundContainer.h"
 #include "GUISound.h"
@@ -13,6 +14,7 @@ namespace RTE {
 
 	void AudioMan::Clear() {
 		m_AudioEnabled = false;
+		m_SilentOutput = false;
 
 		m_MusicPath.clear();
 		m_SoundsVolume = 1.0;
@@ -35,6 +37,7 @@ namespace RTE {
 	int AudioMan::Create() {
 		FMOD_RESULT soundSystemSetupResult = FMOD::System_Create(&m_AudioSystem);
 		soundSystemSetupResult = (soundSystemSetupResult == FMOD_OK) ? m_AudioSystem->set3DSettings(1, g_FrameMan.GetPPM(), 1) : soundSystemSetupResult;
+		if (m_SilentOutput) { soundSystemSetupResult = (soundSystemSetupResult == FMOD_OK) ? m_AudioSystem->setOutput(FMOD_OUTPUTTYPE_NOSOUND) : soundSystemSetupResult; }
 
 		soundSystemSetupResult = (soundSystemSetupResult == FMOD_OK) ? m_AudioSystem->init(c_MaxAudioChannels, FMOD_INIT_NORMAL, 0) : soundSystemSetupResult;
 		soundSystemSetupResult = (soundSystemSetupResult == FMOD_OK) ? m_AudioSystem->getMasterChannelGroup(&m_MasterChannelGroup) : soundSystemSetupResult;
@@ -71,6 +74,9 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void AudioMan::Update() {
+		static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("AudioMan::Update");
+		ProfileZone profileZone(s_ProfilerZoneID);
+
 		if (m_AudioEnabled) {
 
 			//TODO handle splitscreen - do m_AudioSystem->set3DNumListeners(numPlayers); and set each player's position
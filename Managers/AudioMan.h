@@ -119,6 +119,12 @@ namespace RTE {
 		/// <returns>Whether audio is enabled.</returns>
 		bool IsAudioEnabled() { return m_AudioEnabled; }
 
+		/// <summary>
+		/// Sets whether the audio system should be created without any output device. Everything is still processed as usual, but nothing is heard. Must be set before Create is called.
+		/// </summary>
+		/// <param name="silentOutput">Whether to create the audio system without an output device.</param>
+		void SetSilentOutput(bool silentOutput) { m_SilentOutput = silentOutput; }
+
 		/// <summary>
 		/// Returns the number of audio channels currently used.
 		/// </summary>
@@ -406,6 +412,7 @@ namespace RTE {
 		FMOD::ChannelGroup *m_SoundChannelGroup; //!< The FMOD ChannelGroup for sounds.
 
 		bool m_AudioEnabled; //!< Bool to tell whether audio is enabled or not.
+		bool m_SilentOutput; //!< Whether the audio system is created without an output device.
 
 		double m_SoundsVolume; //!< Global sounds effects volume.
 		double m_MusicVolume; //!< Global music volume.
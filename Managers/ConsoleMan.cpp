@@ -14,6 +14,7 @@
 #include "ConsoleMan.h"
 #include "RTEManagers.h"
 #include "Writer.h"
+#include "ContentFile.h"
 #include "System.h"
 
 #include "GUI/GUI.h"
@@ -120,7 +121,7 @@ int ConsoleMan::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int ConsoleMan::ReadProperty(std::string propName, Reader &reader)
+int ConsoleMan::ReadProperty(const std::string &propName, Reader &reader)
 {
 //    if (propName == "AddEffect")
 //        g_PresetMan.GetEntityPreset(reader);
@@ -286,6 +287,34 @@ void ConsoleMan::SaveAllText(std::string filePath)
     }
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrintLoadedBitmapReport
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prints how much memory the loaded bitmaps take up for each data
+//                  module, and how much of that is unused and could be unloaded.
+
+void ConsoleMan::PrintLoadedBitmapReport()
+{
+    map<int, size_t> loadedBytes;
+    map<int, size_t> unusedBytes;
+    ContentFile::GetLoadedBitmapMemory(loadedBytes, unusedBytes);
+
+    char reportLine[512];
+    size_t totalLoadedBytes = 0;
+    size_t totalUnusedBytes = 0;
+    for (map<int, size_t>::const_iterator itr = loadedBytes.begin(); itr != loadedBytes.end(); ++itr)
+    {
+        string moduleName = (itr->first >= 0 && itr->first < g_PresetMan.GetTotalModuleCount()) ? g_PresetMan.GetDataModuleName(itr->first) : "Other";
+        sprintf_s(reportLine, sizeof(reportLine), "SYSTEM: %s: %.2f MB of bitmaps loaded, %.2f MB unused", moduleName.c_str(), static_cast<double>(itr->second) / (1024 * 1024), static_cast<double>(unusedBytes[itr->first]) / (1024 * 1024));
+        PrintString(reportLine);
+        totalLoadedBytes += itr->second;
+        totalUnusedBytes += unusedBytes[itr->first];
+    }
+    sprintf_s(reportLine, sizeof(reportLine), "SYSTEM: Total: %.2f MB of bitmaps loaded, %.2f MB unused", static_cast<double>(totalLoadedBytes) / (1024 * 1024), static_cast<double>(totalUnusedBytes) / (1024 * 1024));
+    PrintString(reportLine);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ForceVisibility
 //////////////////////////////////////////////////////////////////////////////////////////
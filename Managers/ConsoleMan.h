@@ -92,7 +92,7 @@ public:
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -238,6 +238,17 @@ public:
     void SaveAllText(std::string filePath);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrintLoadedBitmapReport
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prints how much memory the loaded bitmaps take up for each data
+//                  module, and how much of that is unused and could be unloaded.
+// Arguments:       None.
+// Return value:    None.
+
+    void PrintLoadedBitmapReport();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +18,7 @@
 #include "AudioMan.h"
 #include "SceneMan.h"
 #include "SettingsMan.h"
+#include "ThreadMan.h"
 #include "BuyMenuGUI.h"
 #include "SceneEditorGUI.h"
 #include "MovableMan.h"
@@ -31,6 +32,8 @@
 #include "GUI/AllegroBitmap.h"
 #include "GUI/AllegroScreen.h"
 
+#include <emmintrin.h>
+
 
 // I know this is a crime, but if I include it in FrameMan.h the whole thing will collapse due to int redefinitions in Allegro
 std::mutex ScreenRelativeEffectsMutex[MAXSCREENCOUNT];
@@ -45,6 +48,41 @@ namespace RTE
 
 const string FrameMan::m_ClassName = "FrameMan";
 
+// The width and height of the tiles glows are added to the 32bpp back buffer in
+static const int c_GlowTileSize = 64;
+
+// Where each thread adds up the glows of the tile it's working on, before adding them to the 32bpp back buffer
+static thread_local std::vector<unsigned short> s_GlowTileAccumulator;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Hashes a pixel position and frame number into a number that's random enough to decide
+// whether a pixel glows this frame, and always the same no matter which thread asks.
+
+static inline unsigned int GlowHash(int x, int y, unsigned int frame)
+{
+    unsigned int hash = (static_cast<unsigned int>(x) * 73856093u) ^ (static_cast<unsigned int>(y) * 19349663u) ^ (frame * 83492791u);
+    hash ^= hash >> 13;
+    hash *= 0x5BD1E995u;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Finds the first non-zero byte in a row, from start up to end. Compares 16 bytes at a
+// time so empty stretches are skipped quickly. Returns end if there are none.
+
+static inline int FindFirstNonZero(const unsigned char *pRow, int start, int end)
+{
+    const __m128i zeros = _mm_setzero_si128();
+    while (start + 16 <= end && _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pRow + start)), zeros)) == 0xFFFF)
+        start += 16;
+    while (start < end && pRow[start] == 0)
+        ++start;
+    return start;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Callback function for the allegro set_display_switch_callback. It will be called when
 // focus is swtiched away to the game window. 
@@ -401,6 +439,7 @@ void FrameMan::Clear()
     m_pPaletteDataFile = 0;
     m_BlackColor = 245;
     m_AlmostBlackColor = 245;
+    m_Headless = false;
     m_Fullscreen = false;
     m_NxWindowed = 1;
     m_NxFullscreen = 1;
@@ -413,6 +452,18 @@ void FrameMan::Clear()
     m_RedGlowHash = 0;
     m_pBlueGlow = 0;
     m_BlueGlowHash = 0;
+    memset(m_GlowTypes, GLOW_NONE, sizeof(m_GlowTypes));
+    memset(m_GlowChances, 0, sizeof(m_GlowChances));
+    m_GlowColors.clear();
+    for (int glowType = 0; glowType < GLOW_TYPECOUNT; ++glowType)
+        m_GlowKernels[glowType].clear();
+    m_GlowReachLeft = 0;
+    m_GlowReachTop = 0;
+    m_GlowReachRight = 0;
+    m_GlowReachBottom = 0;
+    m_GlowMask.clear();
+    m_GlowMaskRowHits.clear();
+    m_GlowFrame = 0;
     m_PostScreenEffects.clear();
     m_HSplit = false;
     m_VSplit = false;
@@ -452,10 +503,16 @@ void FrameMan::Clear()
 		for (int f = 0; f < 2; f++)
 		{
 			m_pNetworkBackBufferIntermediate8[f][i] = 0;
-			m_pNetworkBackBufferFinal8[f][i] = 0;
 			m_pNetworkBackBufferIntermediateGUI8[f][i] = 0;
+		}
+		for (int f = 0; f < NETWORK_FRAME_SLOTS; f++)
+		{
+			m_pNetworkBackBufferFinal8[f][i] = 0;
 			m_pNetworkBackBufferFinalGUI8[f][i] = 0;
 		}
+		m_NetworkSlotWriting[i] = 0;
+		m_NetworkSlotReady[i] = 1;
+		m_NetworkSlotSending[i] = 2;
 		m_NetworkBitmapIsLocked[i] = false;
 
 		m_ScreenRelativeEffects->clear();
@@ -527,7 +584,8 @@ int FrameMan::Create()
 		windowedGfxDriver = GFX_DIRECTX_WIN_BORDERLESS;
 
 
-    if (set_gfx_mode(m_Fullscreen ? fullscreenGfxDriver : windowedGfxDriver, m_Fullscreen ? m_ResX * m_NxFullscreen : m_ResX * m_NxWindowed, m_Fullscreen ? m_ResY * m_NxFullscreen : m_ResY * m_NxWindowed, 0, 0) != 0)
+    // No window to set up when headless, the memory bitmaps below are all that's needed
+    if (!m_Headless && set_gfx_mode(m_Fullscreen ? fullscreenGfxDriver : windowedGfxDriver, m_Fullscreen ? m_ResX * m_NxFullscreen : m_ResX * m_NxWindowed, m_Fullscreen ? m_ResY * m_NxFullscreen : m_ResY * m_NxWindowed, 0, 0) != 0)
     {
 		g_ConsoleMan.PrintString("Failed to set gfx mode, trying different windowed scaling.");
 
@@ -560,10 +618,13 @@ int FrameMan::Create()
     }
 
     // Clear the screen buffer so it doesn't flash pink
-    if (m_BPP == 8)
-        clear_to_color(screen, m_BlackColor);
-    else
-        clear_to_color(screen, 0);
+    if (!m_Headless)
+    {
+        if (m_BPP == 8)
+            clear_to_color(screen, m_BlackColor);
+        else
+            clear_to_color(screen, 0);
+    }
 
     // Sets the allowed color conversions when loading bitmaps from files
     set_color_conversion(COLORCONV_MOST);
@@ -573,10 +634,13 @@ int FrameMan::Create()
         return -1;
 
     // Set the switching mode; what happens when the app window is switched to and fro
-    set_display_switch_mode(SWITCH_BACKGROUND);
-//    set_display_switch_mode(SWITCH_PAUSE);
-    set_display_switch_callback(SWITCH_OUT, DisplaySwitchOut);
-    set_display_switch_callback(SWITCH_IN, DisplaySwitchIn);
+    if (!m_Headless)
+    {
+        set_display_switch_mode(SWITCH_BACKGROUND);
+//        set_display_switch_mode(SWITCH_PAUSE);
+        set_display_switch_callback(SWITCH_OUT, DisplaySwitchOut);
+        set_display_switch_callback(SWITCH_IN, DisplaySwitchIn);
+    }
 
     // Create transparency color table
     PALETTE ccpal;
@@ -599,7 +663,9 @@ int FrameMan::Create()
 			clear_to_color(m_pNetworkBackBufferIntermediate8[f][i], m_BlackColor);
 			m_pNetworkBackBufferIntermediateGUI8[f][i] = create_bitmap_ex(8, m_ResX, m_ResY);
 			clear_to_color(m_pNetworkBackBufferIntermediateGUI8[f][i], g_KeyColor);
-
+		}
+		for (int f = 0; f < NETWORK_FRAME_SLOTS; f++)
+		{
 			m_pNetworkBackBufferFinal8[f][i] = create_bitmap_ex(8, m_ResX, m_ResY);
 			clear_to_color(m_pNetworkBackBufferFinal8[f][i], m_BlackColor);
 			m_pNetworkBackBufferFinalGUI8[f][i] = create_bitmap_ex(8, m_ResX, m_ResY);
@@ -624,6 +690,7 @@ int FrameMan::Create()
         glowFile.SetDataPath("Base.rte/Effects/Glows/BlueTiny.bmp");
         m_pBlueGlow = glowFile.GetAsBitmap();
         m_BlueGlowHash = glowFile.GetHash();
+        SetupGlows();
 
 		m_pTempEffectBitmap_16 = create_bitmap_ex(32, 16, 16);
 		m_pTempEffectBitmap_32 = create_bitmap_ex(32, 32, 32);
@@ -659,6 +726,7 @@ int FrameMan::Create()
 		}
 		m_PerfMeasureStart[c] = 0;
 		m_PerfMeasureStop[c] = 0;
+		m_PerfZoneEntered[c] = false;
 	}
 
 	//Set up performance counter's names
@@ -670,6 +738,10 @@ int FrameMan::Create()
 	m_PerfCounterNames[PERF_ACTORS_AI] = "Act AI";
     m_PerfCounterNames[PERF_ACTIVITY] = "Activity";
 	m_PerfCounterNames[PERF_SOUND] = "Sound";
+
+	// The counters show up in profiler traces too, wrapped around whatever zones are entered while they're measuring
+	for (int c = 0; c < PERF_COUNT; ++c)
+		m_PerfZoneIDs[c] = g_ProfilerMan.RegisterZone("Sim: " + m_PerfCounterNames[c]);
     return 0;
 }
 
@@ -704,7 +776,7 @@ bool FrameMan::IsValidResolution(int width, int height) const
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int FrameMan::ReadProperty(std::string propName, Reader &reader)
+int FrameMan::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "ResolutionX")
     {
@@ -862,6 +934,9 @@ void FrameMan::Destroy()
 		{
 			destroy_bitmap(m_pNetworkBackBufferIntermediate8[f][i]);
 			destroy_bitmap(m_pNetworkBackBufferIntermediateGUI8[f][i]);
+		}
+		for (int f = 0; f < NETWORK_FRAME_SLOTS; f++)
+		{
 			destroy_bitmap(m_pNetworkBackBufferFinal8[f][i]);
 			destroy_bitmap(m_pNetworkBackBufferFinalGUI8[f][i]);
 		}
@@ -1183,7 +1258,15 @@ int FrameMan::SaveWorldToBMP(const char *namebase)
 		draw_sprite(pWorldBitmap, g_SceneMan.GetTerrain()->GetBGColorBitmap(), 0, 0);
 		draw_sprite(pWorldBitmap, g_SceneMan.GetTerrain()->GetFGColorBitmap(), 0, 0);
 
-		//Draw objects
+		//Draw objects, all of them if only those around the views are on the MO color layer
+		if (g_MovableMan.IsViewportMOColorLayerEnabled())
+		{
+			g_SceneMan.ClearMOColorLayer();
+			// The effects of everything drawn for this frame are registered already, don't add them a second time
+			g_SceneMan.SetRegisterPostEffects(false);
+			g_MovableMan.Draw(g_SceneMan.GetMOColorBitmap());
+			g_SceneMan.SetRegisterPostEffects(true);
+		}
 		draw_sprite(pWorldBitmap, g_SceneMan.GetMOColorBitmap(), 0, 0);
 
 		g_SceneMan.GetPostScreenEffectsWrapped(targetPos, pWorldBitmap->w, pWorldBitmap->h, postEffects,-1);
@@ -1490,18 +1573,11 @@ void FrameMan::PostProcess()
     // First copy the current 8bpp backbuffer to the 32bpp buffer; we'll add effects to it
     blit(m_pBackBuffer8, m_pBackBuffer32, 0, 0, 0, 0, m_pBackBuffer8->w, m_pBackBuffer8->h);
 
-	// Set the screen blender mode for glows
-//    set_alpha_blender();
-    set_screen_blender(128, 128, 128, 128);
-
-//    acquire_bitmap(m_pBackBuffer8);
-//    acquire_bitmap(m_pBackBuffer32);
-
-    // Randomly sample the entire backbuffer, looking for pixels to put a glow on
-    // NOTE THIS IS SLOW, especially on higher resolutions!
+    // Add the glows of the glowing pixels within the glow boxes
     if (m_PostPixelGlow)
     {
-        int x = 0, y = 0, startX = 0, startY = 0, endX = 0, endY = 0, testpixel = 0;
+        ++m_GlowFrame;
+        int startX = 0, startY = 0, endX = 0, endY = 0;
 
         for (list<Box>::iterator bItr = m_PostScreenGlowBoxes.begin(); bItr != m_PostScreenGlowBoxes.end(); ++bItr)
         {
@@ -1509,55 +1585,15 @@ void FrameMan::PostProcess()
             startY = (*bItr).m_Corner.m_Y;
             endX = startX + (*bItr).m_Width;
             endY = startY + (*bItr).m_Height;
-            testpixel = 0;
 
             // Sanity check a little at least
             if (startX < 0 || startX >= m_pBackBuffer8->w || startY < 0 || startY >= m_pBackBuffer8->h ||
                 endX < 0 || endX >= m_pBackBuffer8->w || endY < 0 || endY >= m_pBackBuffer8->h)
                 continue;
 
-// TODO: REMOVE TEMP DEBUG
-//            rect(m_pBackBuffer32, startX, startY, endX, endY, g_RedColor);
-
-            for (y = startY; y < endY; ++y)
-            {
-                for (x = startX; x < endX; ++x)
-                {
-                    testpixel = _getpixel(m_pBackBuffer8, x, y);
-
-                    // YELLOW
-                    if ((testpixel == g_YellowGlowColor && PosRand() < 0.9) || testpixel == 98 || (testpixel == 120 && PosRand() < 0.7))// || testpixel == 39 || testpixel == 86 || testpixel == 47 || testpixel == 48 || testpixel == 116)
-                        draw_trans_sprite(m_pBackBuffer32, m_pYellowGlow, x - 2, y - 2);
-                    // RED
-        //            if (testpixel == 13)
-        //                draw_trans_sprite(m_pBackBuffer32, m_pRedGlow, x - 2, y - 2);
-                    // BLUE
-                    if (testpixel == 166)
-                        draw_trans_sprite(m_pBackBuffer32, m_pBlueGlow, x - 2, y - 2);
-                }
-            }            
+            DrawGlowBox(startX, startY, endX, endY);
         }
     }
-/* This one is even slower than above method
-    // How many samples to make
-    int samples = 640 * 480 * 0.7;
-
-    for (int i = 0; i < samples; ++i)
-    {
-        x = m_pBackBuffer8->w * PosRand();
-//        y = m_pBackBuffer8->h * PosRand();
-        testpixel = _getpixel(m_pBackBuffer8, x, y);
-        // YELLOW
-        if (testpixel == g_YellowGlowColor || testpixel == 98 || testpixel == 120)// || testpixel == 39 || testpixel == 86 || testpixel == 47 || testpixel == 48 || testpixel == 116)
-            draw_trans_sprite(m_pBackBuffer32, m_pYellowGlow, x - 2, y - 2);
-        // RED
-//            if (testpixel == 13)
-//                draw_trans_sprite(m_pBackBuffer32, m_pRedGlow, x - 2, y - 2);
-        // BLUE
-        if (testpixel == 166)
-            draw_trans_sprite(m_pBackBuffer32, m_pBlueGlow, x - 2, y - 2);
-    }
-*/
 
     // Draw all the scene screen effects accumulated this frame
     BITMAP *pBitmap = 0;
@@ -1622,6 +1658,223 @@ void FrameMan::PostProcess()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetupGlows
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets up which palette indices glow and how, and makes the glow kernels
+//                  from the glow bitmaps.
+
+void FrameMan::SetupGlows()
+{
+    memset(m_GlowTypes, GLOW_NONE, sizeof(m_GlowTypes));
+    memset(m_GlowChances, 0, sizeof(m_GlowChances));
+
+    // YELLOW, some of which only glow some of the time
+    m_GlowTypes[g_YellowGlowColor] = GLOW_YELLOW;
+    m_GlowChances[g_YellowGlowColor] = 230;
+    m_GlowTypes[98] = GLOW_YELLOW;
+    m_GlowChances[98] = 255;
+    m_GlowTypes[120] = GLOW_YELLOW;
+    m_GlowChances[120] = 179;
+    // BLUE
+    m_GlowTypes[166] = GLOW_BLUE;
+    m_GlowChances[166] = 255;
+
+    m_GlowColors.clear();
+    for (int index = 0; index < 256; ++index)
+    {
+        if (m_GlowTypes[index] != GLOW_NONE)
+            m_GlowColors.push_back(index);
+    }
+
+    m_GlowKernels[GLOW_NONE].clear();
+    LoadGlowKernel(m_pYellowGlow, m_GlowKernels[GLOW_YELLOW]);
+    LoadGlowKernel(m_pBlueGlow, m_GlowKernels[GLOW_BLUE]);
+
+    m_GlowReachLeft = m_GlowReachTop = m_GlowReachRight = m_GlowReachBottom = 0;
+    for (int glowType = 0; glowType < GLOW_TYPECOUNT; ++glowType)
+    {
+        for (const GlowKernelTap &tap : m_GlowKernels[glowType])
+        {
+            m_GlowReachLeft = MAX(m_GlowReachLeft, -tap.m_OffsetX);
+            m_GlowReachTop = MAX(m_GlowReachTop, -tap.m_OffsetY);
+            m_GlowReachRight = MAX(m_GlowReachRight, tap.m_OffsetX);
+            m_GlowReachBottom = MAX(m_GlowReachBottom, tap.m_OffsetY);
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LoadGlowKernel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a glow kernel from a glow bitmap, centered two pixels in from its
+//                  top left corner the same way the glow bitmaps have always been drawn.
+
+void FrameMan::LoadGlowKernel(BITMAP *pGlow, std::vector<GlowKernelTap> &kernel)
+{
+    kernel.clear();
+    if (!pGlow)
+        return;
+
+    int depth = bitmap_color_depth(pGlow);
+    int maskColor = bitmap_mask_color(pGlow);
+    for (int y = 0; y < pGlow->h; ++y)
+    {
+        for (int x = 0; x < pGlow->w; ++x)
+        {
+            int pixel = getpixel(pGlow, x, y);
+            if (pixel == maskColor)
+                continue;
+
+            // The glows were always drawn with the screen blender at half strength
+            GlowKernelTap tap = { x - 2, y - 2, getr_depth(depth, pixel) / 2, getg_depth(depth, pixel) / 2, getb_depth(depth, pixel) / 2 };
+            if (tap.m_R > 0 || tap.m_G > 0 || tap.m_B > 0)
+                kernel.push_back(tap);
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawGlowBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds the glows of all glowing pixels of the 8bpp back buffer within a
+//                  box to the 32bpp back buffer.
+
+void FrameMan::DrawGlowBox(int startX, int startY, int endX, int endY)
+{
+    if (m_GlowColors.empty() || endX <= startX || endY <= startY)
+        return;
+
+    int width = m_pBackBuffer8->w;
+    if (m_GlowMask.size() < width * m_pBackBuffer8->h)
+    {
+        m_GlowMask.resize(width * m_pBackBuffer8->h, GLOW_NONE);
+        m_GlowMaskRowHits.resize(m_pBackBuffer8->h, 0);
+    }
+
+    unsigned int frame = m_GlowFrame;
+
+    // First mark which pixels of the box glow this frame, a row at a time. Stretches of 16 pixels with none of the glowing colors in them are skipped in one go
+    g_ThreadMan.ParallelFor(endY - startY, [this, startX, endX, startY, width, frame](int row) {
+        // Kept in a local array rather than a vector, the heap doesn't guarantee the 16 byte alignment the compares load them with
+        __m128i glowColorValues[c_PaletteEntriesNumber];
+        int glowColorCount = m_GlowColors.size();
+        for (int i = 0; i < glowColorCount; ++i)
+            glowColorValues[i] = _mm_set1_epi8(static_cast<char>(m_GlowColors[i]));
+
+        int y = startY + row;
+        const unsigned char *pPixels = m_pBackBuffer8->line[y];
+        unsigned char *pMask = &m_GlowMask[y * width];
+        bool rowHit = false;
+
+        int x = startX;
+        while (x < endX)
+        {
+            int stretchEnd = MIN(x + 16, endX);
+            if (stretchEnd - x == 16)
+            {
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pPixels + x));
+                __m128i matches = _mm_setzero_si128();
+                for (int i = 0; i < glowColorCount; ++i)
+                    matches = _mm_or_si128(matches, _mm_cmpeq_epi8(pixels, glowColorValues[i]));
+                if (_mm_movemask_epi8(matches) == 0)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(pMask + x), _mm_setzero_si128());
+                    x = stretchEnd;
+                    continue;
+                }
+            }
+            for (; x < stretchEnd; ++x)
+            {
+                unsigned char glowType = m_GlowTypes[pPixels[x]];
+                if (glowType != GLOW_NONE && m_GlowChances[pPixels[x]] != 255 && (GlowHash(x, y, frame) & 255) >= m_GlowChances[pPixels[x]])
+                    glowType = GLOW_NONE;
+                pMask[x] = glowType;
+                rowHit = rowHit || glowType != GLOW_NONE;
+            }
+        }
+        m_GlowMaskRowHits[y] = rowHit;
+    }, 16);
+
+    // Then add the glows tile by tile, each thread adding up the glows landing in its tile from the glowing pixels in and around it
+    int areaLeft = MAX(startX - m_GlowReachLeft, 0);
+    int areaTop = MAX(startY - m_GlowReachTop, 0);
+    int areaRight = MIN(endX + m_GlowReachRight, width);
+    int areaBottom = MIN(endY + m_GlowReachBottom, m_pBackBuffer32->h);
+    int tilesX = (areaRight - areaLeft + c_GlowTileSize - 1) / c_GlowTileSize;
+    int tilesY = (areaBottom - areaTop + c_GlowTileSize - 1) / c_GlowTileSize;
+
+    g_ThreadMan.ParallelFor(tilesX * tilesY, [this, startX, startY, endX, endY, areaLeft, areaTop, areaRight, areaBottom, tilesX, width](int tile) {
+        int tileLeft = areaLeft + (tile % tilesX) * c_GlowTileSize;
+        int tileTop = areaTop + (tile / tilesX) * c_GlowTileSize;
+        int tileRight = MIN(tileLeft + c_GlowTileSize, areaRight);
+        int tileBottom = MIN(tileTop + c_GlowTileSize, areaBottom);
+        int tileWidth = tileRight - tileLeft;
+
+        // The glowing pixels whose glows can land in this tile
+        int sourceLeft = MAX(tileLeft - m_GlowReachRight, startX);
+        int sourceTop = MAX(tileTop - m_GlowReachBottom, startY);
+        int sourceRight = MIN(tileRight + m_GlowReachLeft, endX);
+        int sourceBottom = MIN(tileBottom + m_GlowReachTop, endY);
+
+        bool tileHit = false;
+        for (int y = sourceTop; y < sourceBottom && !tileHit; ++y)
+            tileHit = m_GlowMaskRowHits[y] != 0;
+        if (!tileHit)
+            return;
+
+        std::vector<unsigned short> &accumulator = s_GlowTileAccumulator;
+        accumulator.assign(c_GlowTileSize * c_GlowTileSize * 3, 0);
+
+        for (int y = sourceTop; y < sourceBottom; ++y)
+        {
+            if (!m_GlowMaskRowHits[y])
+                continue;
+
+            const unsigned char *pMask = &m_GlowMask[y * width];
+            for (int x = FindFirstNonZero(pMask, sourceLeft, sourceRight); x < sourceRight; x = FindFirstNonZero(pMask, x + 1, sourceRight))
+            {
+                for (const GlowKernelTap &tap : m_GlowKernels[pMask[x]])
+                {
+                    int glowX = x + tap.m_OffsetX;
+                    int glowY = y + tap.m_OffsetY;
+                    if (glowX < tileLeft || glowX >= tileRight || glowY < tileTop || glowY >= tileBottom)
+                        continue;
+
+                    unsigned short *pAccumulated = &accumulator[((glowY - tileTop) * c_GlowTileSize + (glowX - tileLeft)) * 3];
+                    pAccumulated[0] += tap.m_R;
+                    pAccumulated[1] += tap.m_G;
+                    pAccumulated[2] += tap.m_B;
+                }
+            }
+        }
+
+        // Screen the added up glows onto the 32bpp back buffer
+        for (int y = tileTop; y < tileBottom; ++y)
+        {
+            unsigned int *pPixels = reinterpret_cast<unsigned int *>(m_pBackBuffer32->line[y]);
+            const unsigned short *pAccumulated = &accumulator[(y - tileTop) * c_GlowTileSize * 3];
+            for (int x = 0; x < tileWidth; ++x, pAccumulated += 3)
+            {
+                if (pAccumulated[0] == 0 && pAccumulated[1] == 0 && pAccumulated[2] == 0)
+                    continue;
+
+                int pixel = pPixels[tileLeft + x];
+                int red = getr32(pixel);
+                int green = getg32(pixel);
+                int blue = getb32(pixel);
+                red += MIN(pAccumulated[0], 255) * (255 - red) / 255;
+                green += MIN(pAccumulated[1], 255) * (255 - green) / 255;
+                blue += MIN(pAccumulated[2], 255) * (255 - blue) / 255;
+                pPixels[tileLeft + x] = makecol32(red, green, blue);
+            }
+        }
+    }, 1);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          FlipFrameBuffers
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1629,6 +1882,10 @@ void FrameMan::PostProcess()
 
 void FrameMan::FlipFrameBuffers()
 {
+    // Nowhere to flip to
+    if (m_Headless)
+        return;
+
     if (get_color_depth() == 32 && m_BPP == 32 && m_pBackBuffer32)
     {
         if (g_InActivity)
@@ -2017,6 +2274,9 @@ void FrameMan::DrawPrimitives(int player, BITMAP *pTargetBitmap, const Vector &t
 
 void FrameMan::Draw()
 {
+    static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("FrameMan::Draw");
+    ProfileZone profileZone(s_ProfilerZoneID);
+
     // Count how many split screens we'll need
     int screenCount = (m_HSplit ? 2 : 1) * (m_VSplit ? 2 : 1);
 
@@ -2174,40 +2434,47 @@ void FrameMan::Draw()
 
                 // Calcualte teh fps from the average
                 float fps = 1.0f / ((float)m_MSPFAverage / 1000.0f);
+
+                // Gather the lines of stats to draw them all in one go
+                vector<GUIFont::TextDraw> statLines;
                 sprintf_s(str, sizeof(str), "FPS: %.0f", fps);
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 14, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 14, str));
 
                 // Display the average
                 sprintf_s(str, sizeof(str), "MSPF: %i", m_MSPFAverage);
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 24, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 24, str));
 
                 sprintf_s(str, sizeof(str), "Time Scale: x%.2f ([1]-, [2]+)", g_TimerMan.IsOneSimUpdatePerFrame() ? m_SimSpeed : g_TimerMan.GetTimeScale());
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 34, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 34, str));
 
                 sprintf_s(str, sizeof(str), "Real to Sim Cap: %.2f ms ([3]-, [4]+)", g_TimerMan.GetRealToSimCap() * 1000.0f);
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 44, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 44, str));
 
                 float dt = g_TimerMan.GetDeltaTimeMS();
                 sprintf_s(str, sizeof(str), "DeltaTime: %.2f ms ([5]-, [6]+)", dt);
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 54, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 54, str));
 
                 sprintf_s(str, sizeof(str), "Particles: %i", g_MovableMan.GetParticleCount());
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 64, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 64, str));
 
 				sprintf_s(str, sizeof(str), "Objects: %i", g_MovableMan.GetKnownObjectsCount());
-				GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 74, str, GUIFont::Left);
+				statLines.push_back(GUIFont::TextDraw(17, 74, str));
 
-                sprintf_s(str, sizeof(str), "MOIDs: %i", g_MovableMan.GetMOIDCount());
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 84, str, GUIFont::Left);
+                sprintf_s(str, sizeof(str), "MOIDs: %i (Redrawn %i / %i, incremental %s)", g_MovableMan.GetMOIDCount(), g_MovableMan.GetMOIDRedrawCount(), g_MovableMan.GetMOIDDrawCount(), g_MovableMan.IsIncrementalMOIDLayerEnabled() ? "ON" : "OFF");
+                statLines.push_back(GUIFont::TextDraw(17, 84, str));
 
                 sprintf_s(str, sizeof(str), "Sim Updates Since Last Drawn: %i", g_TimerMan.SimUpdatesSinceDrawn());
-                GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 94, str, GUIFont::Left);
+                statLines.push_back(GUIFont::TextDraw(17, 94, str));
 
                 if (g_TimerMan.IsOneSimUpdatePerFrame())
-                    GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 104, "ONE Sim Update Per Frame!", GUIFont::Left);
+                    statLines.push_back(GUIFont::TextDraw(17, 104, "ONE Sim Update Per Frame!"));
 
 				sprintf_s(str, sizeof(str), "Sound channels: %d / %d ", g_AudioMan.GetPlayingChannelCount(), g_AudioMan.GetTotalChannelCount());
-				GetLargeFont()->DrawAligned(&pPlayerGUIBitmap, 17, 114, str, GUIFont::Left);
+				statLines.push_back(GUIFont::TextDraw(17, 114, str));
+
+				sprintf_s(str, sizeof(str), "Threads: %i (Parallel particles %s)", g_ThreadMan.GetThreadCount(), g_MovableMan.IsParallelParticlesEnabled() ? "ON" : "OFF");
+				statLines.push_back(GUIFont::TextDraw(17, 124, str));
+				GetLargeFont()->DrawBatch(&pPlayerGUIBitmap, statLines);
 
 				int xOffset = 17;
 				int yOffset = 134;
@@ -2457,14 +2724,24 @@ void FrameMan::Draw()
 
 			//m_TargetPos[i] = g_SceneMan.GetOffset(i);
 
+			// Copy into the slot neither the latest finished frame nor the one being sent is in, so the sending thread never sees a half-copied frame
+			int slot = m_NetworkSlotWriting[i];
+
 			m_NetworkBitmapIsLocked[i] = true;
-			blit(m_pNetworkBackBufferIntermediate8[m_NetworkFrameCurrent][i], m_pNetworkBackBufferFinal8[m_NetworkFrameCurrent][i], 0, 0, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameCurrent][i]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameCurrent][i]->h);
-			blit(m_pNetworkBackBufferIntermediateGUI8[m_NetworkFrameCurrent][i], m_pNetworkBackBufferFinalGUI8[m_NetworkFrameCurrent][i], 0, 0, 0, 0, m_pNetworkBackBufferFinalGUI8[m_NetworkFrameCurrent][i]->w, m_pNetworkBackBufferFinalGUI8[m_NetworkFrameCurrent][i]->h);
+			blit(m_pNetworkBackBufferIntermediate8[m_NetworkFrameCurrent][i], m_pNetworkBackBufferFinal8[slot][i], 0, 0, 0, 0, m_pNetworkBackBufferFinal8[slot][i]->w, m_pNetworkBackBufferFinal8[slot][i]->h);
+			blit(m_pNetworkBackBufferIntermediateGUI8[m_NetworkFrameCurrent][i], m_pNetworkBackBufferFinalGUI8[slot][i], 0, 0, 0, 0, m_pNetworkBackBufferFinalGUI8[slot][i]->w, m_pNetworkBackBufferFinalGUI8[slot][i]->h);
+
+			m_NetworkSlotTargetPos[slot][i] = m_TargetPos[m_NetworkFrameCurrent][i];
+			for (int layer = 0; layer < MAX_LAYERS_STORED_FOR_NETWORK; layer++)
+				m_NetworkSlotSLOffset[slot][i][layer] = SLOffset[i][layer];
+
+			// Publish it, and take back the previously finished slot if the sending thread didn't pick that up in the meantime, or the one it just let go of otherwise
+			m_NetworkSlotWriting[i] = m_NetworkSlotReady[i].exchange(slot | NETWORK_SLOT_FRESH) & ~NETWORK_SLOT_FRESH;
 			m_NetworkBitmapIsLocked[i] = false;
 
 			// Draw all player's screen into one
 			if (g_UInputMan.KeyHeld(KEY_5))
-				stretch_blit(m_pNetworkBackBufferFinal8[m_NetworkFrameCurrent][i], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][i]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][i]->h, dx, dy, dw, dh);
+				stretch_blit(m_pNetworkBackBufferFinal8[slot][i], m_pBackBuffer8, 0, 0, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][i]->w, m_pNetworkBackBufferFinal8[m_NetworkFrameReady][i]->h, dx, dy, dw, dh);
 		}
 
 		if (g_UInputMan.KeyHeld(KEY_1))
@@ -2542,6 +2819,22 @@ void FrameMan::SetPostEffectsList(int whichScreen, list<PostEffect> & inputList)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AcquireNetworkBackBuffer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands the latest finished network frame of a player over to the calling
+//                  thread, which owns it until its next call.
+
+bool FrameMan::AcquireNetworkBackBuffer(int player)
+{
+	if (!(m_NetworkSlotReady[player] & NETWORK_SLOT_FRESH))
+		return false;
+
+	m_NetworkSlotSending[player] = m_NetworkSlotReady[player].exchange(m_NetworkSlotSending[player]) & ~NETWORK_SLOT_FRESH;
+	return true;
+}
+
+
 void FrameMan::CreateNewPlayerBackBuffer(int player, int w, int h)
 {
 	for (int f = 0; f < 2; f++)
@@ -2550,7 +2843,9 @@ void FrameMan::CreateNewPlayerBackBuffer(int player, int w, int h)
 		m_pNetworkBackBufferIntermediate8[f][player] = create_bitmap_ex(8, w, h);
 		destroy_bitmap(m_pNetworkBackBufferIntermediateGUI8[f][player]);
 		m_pNetworkBackBufferIntermediateGUI8[f][player] = create_bitmap_ex(8, w, h);
-
+	}
+	for (int f = 0; f < NETWORK_FRAME_SLOTS; f++)
+	{
 		destroy_bitmap(m_pNetworkBackBufferFinal8[f][player]);
 		m_pNetworkBackBufferFinal8[f][player] = create_bitmap_ex(8, w, h);
 		destroy_bitmap(m_pNetworkBackBufferFinalGUI8[f][player]);
@@ -49,6 +49,7 @@ enum DotGlowColor
 #include "Box.h"
 #include "Material.h"
 #include "SceneMan.h"
+#include "ProfilerMan.h"
 
 #include "MovableMan.h"
 
@@ -60,6 +61,10 @@ class GUIFont;
 
 #define MAXSCREENCOUNT 4
 #define MAX_LAYERS_STORED_FOR_NETWORK 10
+// Copies of each player's final network frame, so the one being drawn, the latest finished one and the one being sent never overlap
+#define NETWORK_FRAME_SLOTS 3
+// Marks a finished network frame slot that hasn't been acquired for sending yet
+#define NETWORK_SLOT_FRESH 0x4
 
 enum TransperencyPreset
 {
@@ -747,7 +752,7 @@ public:
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -982,6 +987,28 @@ public:
 
 	bool IsNetworkBitmapLocked(int player) const { return m_NetworkBitmapIsLocked[player]; }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AcquireNetworkBackBuffer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands the latest finished network frame of a player over to the calling
+//                  thread, which owns it until its next call. The previously acquired frame
+//                  is handed back to be drawn into again. Only one thread may acquire
+//                  frames for each player.
+// Arguments:       Which player's frame to acquire.
+// Return value:    Whether a new frame was finished since the last call. If not, the
+//                  previously acquired frame stays acquired.
+
+	bool AcquireNetworkBackBuffer(int player);
+
+	BITMAP * GetNetworkBackBuffer8Acquired(int player) const { return m_pNetworkBackBufferFinal8[m_NetworkSlotSending[player]][player]; }
+
+	BITMAP * GetNetworkBackBufferGUI8Acquired(int player) const { return m_pNetworkBackBufferFinalGUI8[m_NetworkSlotSending[player]][player]; }
+
+	Vector GetNetworkTargetPosAcquired(int player) const { return m_NetworkSlotTargetPos[m_NetworkSlotSending[player]][player]; }
+
+	Vector GetNetworkSLOffsetAcquired(int player, int layer) const { return m_NetworkSlotSLOffset[m_NetworkSlotSending[player]][player][layer]; }
+
 	bool GetDrawNetworkBackBuffer() { return m_DrawNetworkBackBuffer; }
 
 	void SetDrawNetworkBackBuffer(bool value) { m_DrawNetworkBackBuffer = value; }
@@ -1198,6 +1225,28 @@ public:
     bool IsFullscreen() const { return m_Fullscreen; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetHeadless
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether to run without setting up a graphics mode or window at
+//                  all. Everything is still drawn to the memory back buffers, but nothing
+//                  is ever shown. Must be set before Create is called.
+// Arguments:       Whether to run headless or not.
+// Return value:    None.
+
+    void SetHeadless(bool headless = true) { m_Headless = headless; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsHeadless
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether we're running without a graphics mode or window.
+// Arguments:       None.
+// Return value:    Whether we're running headless.
+
+    bool IsHeadless() const { return m_Headless; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          NxWindowed
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1634,9 +1683,16 @@ public:
 // Method:          StartPerformanceMeasurement
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Saves current absolute time in microseconds as a start of performance measurerement.
+//					Also enters the counter's profiler zone if a trace is being captured.
 // Arguments:       Counter to start measurement for.
 // Return value:    None.
-	void StartPerformanceMeasurement(PerformanceCounters counter) { m_PerfMeasureStart[counter] = g_TimerMan.GetAbsoulteTime(); }
+	void StartPerformanceMeasurement(PerformanceCounters counter)
+	{
+		m_PerfZoneEntered[counter] = g_ProfilerMan.IsCapturing();
+		if (m_PerfZoneEntered[counter])
+			g_ProfilerMan.BeginZone(m_PerfZoneIDs[counter]);
+		m_PerfMeasureStart[counter] = g_TimerMan.GetAbsoulteTime();
+	}
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          StopPerformanceMeasurement
@@ -1649,8 +1705,27 @@ public:
 	{ 
 		m_PerfMeasureStop[counter] = g_TimerMan.GetAbsoulteTime(); 
 		AddPerformanceSample(counter, m_PerfMeasureStop[counter] - m_PerfMeasureStart[counter]);
+		if (m_PerfZoneEntered[counter])
+			g_ProfilerMan.EndZone();
+		m_PerfZoneEntered[counter] = false;
 	}
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPerformanceSample
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns the value of the current performance sample of a counter.
+// Arguments:       Counter to get the current sample of.
+// Return value:    Time measured for the counter in the current sample, in microseconds.
+	int64_t GetPerformanceSample(PerformanceCounters counter) const { return m_PerfData[counter][m_Sample]; }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPerformanceCounterName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns the name of a performance counter, as displayed on screen.
+// Arguments:       Counter to get the name of.
+// Return value:    The name of the counter.
+	const string & GetPerformanceCounterName(PerformanceCounters counter) const { return m_PerfCounterNames[counter]; }
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsValidResolution	
@@ -1673,6 +1748,27 @@ public:
 
 protected:
 
+    // One pixel of a glow, as added to the 32bpp buffer around each glowing pixel
+    struct GlowKernelTap
+    {
+        // Offset from the glowing pixel
+        int m_OffsetX;
+        int m_OffsetY;
+        // Color of the glow at this offset, already scaled by the glow strength
+        int m_R;
+        int m_G;
+        int m_B;
+    };
+
+    // The kinds of glow a pixel of the 8bpp back buffer can give off
+    enum GlowTypes
+    {
+        GLOW_NONE = 0,
+        GLOW_YELLOW,
+        GLOW_BLUE,
+        GLOW_TYPECOUNT
+    };
+
     // Member variables
     static const std::string m_ClassName;
 
@@ -1699,10 +1795,21 @@ protected:
 
 
 	// Per-player allocated frame buffer to copy Intermediate before sending
-	BITMAP *m_pNetworkBackBufferFinal8[2][MAXSCREENCOUNT];
+	BITMAP *m_pNetworkBackBufferFinal8[NETWORK_FRAME_SLOTS][MAXSCREENCOUNT];
 
 	// Per-player allocated frame buffer to copy Intermediate before sending used to draw UI only
-	BITMAP *m_pNetworkBackBufferFinalGUI8[2][MAXSCREENCOUNT];
+	BITMAP *m_pNetworkBackBufferFinalGUI8[NETWORK_FRAME_SLOTS][MAXSCREENCOUNT];
+
+	// Which final frame slot is being copied into, only touched by the drawing thread
+	int m_NetworkSlotWriting[MAXSCREENCOUNT];
+	// The latest finished slot, shared between the drawing and the sending thread. Flagged while not yet picked up by the sending thread
+	std::atomic<int> m_NetworkSlotReady[MAXSCREENCOUNT];
+	// Which slot is acquired for sending, only touched by the sending thread
+	int m_NetworkSlotSending[MAXSCREENCOUNT];
+
+	// What each slot's frame was drawn with
+	Vector m_NetworkSlotTargetPos[NETWORK_FRAME_SLOTS][MAXSCREENCOUNT];
+	Vector m_NetworkSlotSLOffset[NETWORK_FRAME_SLOTS][MAXSCREENCOUNT][MAX_LAYERS_STORED_FOR_NETWORK];
 
 
 	// If true, draws the contents of the m_pNetworkBackBuffer8 on top of m_pBackBuffer8 every frame in FrameMan.Draw
@@ -1727,6 +1834,8 @@ protected:
     unsigned char m_BlackColor;
     unsigned char m_AlmostBlackColor;
 
+    // Whether running without a graphics mode or window at all
+    bool m_Headless;
     // Whether in fullscreen mode or not
     bool m_Fullscreen;
     // The number of times the windowed mode resoltion should be multiplied and streched across for better visibility
@@ -1747,6 +1856,25 @@ protected:
 	size_t m_RedGlowHash;
 	BITMAP *m_pBlueGlow;
 	size_t m_BlueGlowHash;
+    // The glow type of each palette index of the 8bpp back buffer
+    unsigned char m_GlowTypes[256];
+    // The chance out of 255 that a pixel of each palette index glows on any given frame, 255 meaning always
+    unsigned char m_GlowChances[256];
+    // The palette indices that glow at all, for quickly skipping over stretches of pixels that don't
+    std::vector<unsigned char> m_GlowColors;
+    // The pixels of each glow type's glow, made from the glow bitmaps
+    std::vector<GlowKernelTap> m_GlowKernels[GLOW_TYPECOUNT];
+    // How far the glows reach out from the glowing pixel in each direction
+    int m_GlowReachLeft;
+    int m_GlowReachTop;
+    int m_GlowReachRight;
+    int m_GlowReachBottom;
+    // The glow type of every pixel of the glow boxes being processed this frame, the same size as the back buffer
+    std::vector<unsigned char> m_GlowMask;
+    // Whether each row of the glow mask has any glowing pixels in it
+    std::vector<unsigned char> m_GlowMaskRowHits;
+    // Counts the frames post processed, so the glows that only show some of the time change from frame to frame
+    unsigned int m_GlowFrame;
 
     // List of effects to apply at the end of each frame, Vector is in total absolute screen coordinates, and the BITMAP is not owned.
     // This list gets cleared out and re-filled each frame.
@@ -1842,6 +1970,9 @@ protected:
 	int64_t m_PerfMeasureStart[PERF_COUNT];
 	// Current measurement stop time in microseconds
 	int64_t m_PerfMeasureStop[PERF_COUNT];
+	// The profiler zone of each counter, and whether it was entered by the measurement in progress
+	int m_PerfZoneIDs[PERF_COUNT];
+	bool m_PerfZoneEntered[PERF_COUNT];
 	// Array to store percentages from PERF_SIM_TOTAL
 	int m_PerfPercentages[PERF_COUNT][MAXSAMPLES];
 	// Perormance counter's names displayed on screen
@@ -1903,6 +2034,42 @@ protected:
 	}
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetupGlows
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets up which palette indices glow and how, and makes the glow kernels
+//                  from the glow bitmaps. The glow bitmaps must be loaded first.
+// Arguments:       None.
+// Return value:    None.
+
+    void SetupGlows();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LoadGlowKernel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a glow kernel from a glow bitmap, centered two pixels in from its
+//                  top left corner the same way the glow bitmaps have always been drawn.
+// Arguments:       The glow bitmap.
+//                  The glow kernel to fill out.
+// Return value:    None.
+
+    void LoadGlowKernel(BITMAP *pGlow, std::vector<GlowKernelTap> &kernel);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawGlowBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds the glows of all glowing pixels of the 8bpp back buffer within a
+//                  box to the 32bpp back buffer. First marks which pixels glow in the glow
+//                  mask, then adds their glows tile by tile, both split across all threads.
+// Arguments:       The left and top edges of the box.
+//                  The right and bottom edges of the box, exclusive.
+// Return value:    None.
+
+    void DrawGlowBox(int startX, int startY, int endX, int endY);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
 
@@ -49,6 +49,72 @@ extern "C"
 
 using namespace luabind;
 
+// Like luabind's return_stl_iterator, but for containers returned by value. The iterator keeps its own copy of the container,
+// so nothing done inside the loop body, including making the same query again, can leave it pointing at freed memory.
+
+namespace luabind { namespace detail
+{
+    template <class Container>
+    struct owning_iterator
+    {
+        static int next(lua_State *L)
+        {
+            owning_iterator *self = static_cast<owning_iterator *>(lua_touserdata(L, lua_upvalueindex(1)));
+            if (self->m_Current != self->m_Container.end())
+            {
+                convert_to_lua(L, *self->m_Current);
+                ++self->m_Current;
+            }
+            else
+                lua_pushnil(L);
+            return 1;
+        }
+
+        static int destroy(lua_State *L)
+        {
+            static_cast<owning_iterator *>(lua_touserdata(L, lua_upvalueindex(1)))->~owning_iterator();
+            return 0;
+        }
+
+        owning_iterator(const Container &container) : m_Container(container), m_Current(m_Container.begin()) {}
+
+        Container m_Container;
+        typename Container::const_iterator m_Current;
+    };
+
+    struct owning_iterator_converter
+    {
+        typedef boost::mpl::bool_<false> is_value_converter;
+        typedef owning_iterator_converter type;
+
+        template <class Container>
+        void apply(lua_State *L, const Container &container)
+        {
+            void *storage = lua_newuserdata(L, sizeof(owning_iterator<Container>));
+            lua_newtable(L);
+            lua_pushcclosure(L, owning_iterator<Container>::destroy, 0);
+            lua_setfield(L, -2, "__gc");
+            lua_setmetatable(L, -2);
+            lua_pushcclosure(L, owning_iterator<Container>::next, 1);
+            new (storage) owning_iterator<Container>(container);
+        }
+    };
+
+    struct owning_iterator_policy : conversion_policy<0>
+    {
+        static void precall(lua_State *, const index_map &) {}
+        static void postcall(lua_State *, const index_map &) {}
+
+        template <class T, class Direction>
+        struct apply { typedef owning_iterator_converter type; };
+    };
+}}
+
+namespace luabind { namespace
+{
+    LUABIND_ANONYMOUS_FIX detail::policy_cons<detail::owning_iterator_policy, detail::null_type> return_stl_iterator_copy;
+}}
+
 // From LuaBind documentation:
 // If you want to add file name and line number to the error messages generated by luabind you can define your own pcall errorfunc.
 // You may want to modify this callback to better suit your needs, but the basic functionality could be implemented like this:
@@ -116,6 +182,9 @@ const string LuaMan::m_ClassName = "LuaMan";
 // myNewActor = CreateActor("Soldier Light");
 // or for a randomly selected Preset within a group:
 // myNewActor = RandomActor("Light Troops");
+// or, when spawning the same Preset many times, without looking it up by name each time:
+// soldierHandle = PresetMan:GetPresetHandle("AHuman", "Soldier Light", "All");
+// myNewActor = CreateActor(soldierHandle);
 
 #define LUAENTITYCREATE(TYPE) \
     TYPE * Create##TYPE(std::string preset, std::string module) \
@@ -129,6 +198,16 @@ const string LuaMan::m_ClassName = "LuaMan";
         return dynamic_cast<TYPE *>(pPreset->Clone()); \
     } \
     TYPE * Create##TYPE(std::string preset) { return Create##TYPE(preset, "All"); } \
+    TYPE * Create##TYPE(int presetHandle) \
+    { \
+        const TYPE *pPreset = dynamic_cast<const TYPE *>(g_PresetMan.GetPresetFromHandle(presetHandle)); \
+        if (!pPreset) \
+        { \
+            g_ConsoleMan.PrintString(string("ERROR: There is no ") + string(#TYPE) + string(" Preset with the handle ") + std::to_string(presetHandle) + string("!")); \
+            return 0; \
+        } \
+        return dynamic_cast<TYPE *>(pPreset->Clone()); \
+    } \
     TYPE * Random##TYPE(std::string group, int moduleSpaceID) \
     { \
         const Entity *pPreset = g_PresetMan.GetRandomBuyableOfGroupFromTech(group, #TYPE, moduleSpaceID); \
@@ -305,6 +384,7 @@ LUAENTITYCAST(TerrainObject)
 #define CONCRETELUABINDING(TYPE, PARENT) \
     def((string("Create") + string(#TYPE)).c_str(), (TYPE *(*)(string, string))&Create##TYPE, adopt(result)), \
     def((string("Create") + string(#TYPE)).c_str(), (TYPE *(*)(string))&Create##TYPE, adopt(result)), \
+    def((string("Create") + string(#TYPE)).c_str(), (TYPE *(*)(int))&Create##TYPE, adopt(result)), \
     def((string("Random") + string(#TYPE)).c_str(), (TYPE *(*)(string, int))&Random##TYPE, adopt(result)), \
     def((string("Random") + string(#TYPE)).c_str(), (TYPE *(*)(string, string))&Random##TYPE, adopt(result)), \
     def((string("Random") + string(#TYPE)).c_str(), (TYPE *(*)(string))&Random##TYPE, adopt(result)), \
@@ -394,6 +474,7 @@ void LuaMan::Clear()
     m_NextPresetID = 0;
     m_NextObjectID = 0;
     m_pTempEntity = 0;
+    m_PresetCallbacks.clear();
 
 	//Clear files list
 	for (int i = 0; i < MAX_OPEN_FILES; ++i)
@@ -937,6 +1018,8 @@ int LuaMan::Create()
             .def("DrawWaypoints", &Actor::DrawWaypoints)
             .def("SetMovePathToUpdate", &Actor::SetMovePathToUpdate)
             .def("UpdateMovePath", &Actor::UpdateMovePath)
+            .property("IsWaitingForMovePath", &Actor::IsWaitingForMovePath)
+            .def("CancelMovePathRequest", &Actor::CancelMovePathRequest)
             .property("MovePathSize", &Actor::GetMovePathSize)
             .def_readwrite("MOMoveTarget", &Actor::m_pMOMoveTarget)
             .def_readwrite("MovePath", &Actor::m_MovePath, return_stl_iterator)
@@ -1412,6 +1495,11 @@ int LuaMan::Create()
             .def("TimeForSimUpdate", &TimerMan::TimeForSimUpdate)
             .def("DrawnSimUpdate", &TimerMan::DrawnSimUpdate),
 
+        class_<ProfilerMan>("ProfilerManager")
+            .property("IsCapturing", &ProfilerMan::IsCapturing)
+            .def("CaptureTrace", &ProfilerMan::CaptureTrace)
+            .def("StopCapture", &ProfilerMan::StopCapture),
+
         class_<FrameMan>("FrameManager")
             .def("ResetSplitScreens", &FrameMan::ResetSplitScreens)
             .property("PPM", &FrameMan::GetPPM, &FrameMan::SetPPM)
@@ -1475,6 +1563,7 @@ int LuaMan::Create()
             .def("GetLoadout", (Actor * (PresetMan::*)(std::string, std::string, bool))&PresetMan::GetLoadout, adopt(result))
             .def("GetLoadout", (Actor * (PresetMan::*)(std::string, int, bool))&PresetMan::GetLoadout, adopt(result))
             .def("GetRandomOfGroup", &PresetMan::GetRandomOfGroup)
+            .def("GetPresetHandle", &PresetMan::GetPresetHandle)
             .def("GetRandomOfGroupInModuleSpace", &PresetMan::GetRandomOfGroupInModuleSpace)
             .def("GetEntityDataLocation", &PresetMan::GetEntityDataLocation)
             .def("ReadReflectedPreset", &PresetMan::ReadReflectedPreset)
@@ -1669,6 +1758,10 @@ int LuaMan::Create()
             .def("UpdatePathFinding", &Scene::UpdatePathFinding)
             .def("PathFindingUpdated", &Scene::PathFindingUpdated)
             .def("CalculatePath", &Scene::CalculateScenePath)
+            .def("RequestPath", &Scene::RequestPath)
+            .def("FetchPath", &Scene::FetchScenePath)
+            .def("IsPathRequestPending", &Scene::IsPathRequestPending)
+            .def("CancelPathRequest", &Scene::CancelPathRequest)
             .def_readwrite("ScenePath", &Scene::m_ScenePath, return_stl_iterator)
 			.def_readwrite("Deployments", &Scene::m_Deployments, return_stl_iterator)
 			.property("ScenePathSize", &Scene::GetScenePathSize),
@@ -2131,6 +2224,8 @@ int LuaMan::Create()
         class_<MovableMan>("MovableManager")
             .def("GetMOFromID", &MovableMan::GetMOFromID)
 			.def("FindObjectByUniqueID", &MovableMan::FindObjectByUniqueID)
+			.def("GetObjectHandle", &MovableMan::GetObjectHandle)
+			.def("GetObjectFromHandle", &MovableMan::GetObjectFromHandle)
 			.def("GetMOIDCount", &MovableMan::GetMOIDCount)
 			.def("GetTeamMOIDCount", &MovableMan::GetTeamMOIDCount)
             .def("PurgeAllMOs", &MovableMan::PurgeAllMOs)
@@ -2142,6 +2237,10 @@ int LuaMan::Create()
             .def("GetClosestEnemyActor", &MovableMan::GetClosestEnemyActor)
             .def("GetFirstTeamActor", &MovableMan::GetFirstTeamActor)
             .def("GetClosestActor", &MovableMan::GetClosestActor)
+            .def("GetActorsInRadius", &MovableMan::GetActorsInRadius, return_stl_iterator_copy)
+            .def("GetActorsInBox", &MovableMan::GetActorsInBox, return_stl_iterator_copy)
+            .def("GetItemsInRadius", &MovableMan::GetItemsInRadius, return_stl_iterator_copy)
+            .def("GetItemsInBox", &MovableMan::GetItemsInBox, return_stl_iterator_copy)
             .def("GetClosestBrainActor", &MovableMan::GetClosestBrainActor)
             .def("GetFirstBrainActor", &MovableMan::GetFirstBrainActor)
             .def("GetClosestOtherBrainActor", &MovableMan::GetClosestOtherBrainActor)
@@ -2186,6 +2285,7 @@ int LuaMan::Create()
             .def("PrintString", &ConsoleMan::PrintString)
             .def("SaveInputLog", &ConsoleMan::SaveInputLog)
             .def("SaveAllText", &ConsoleMan::SaveAllText)
+            .def("PrintLoadedBitmapReport", &ConsoleMan::PrintLoadedBitmapReport)
             .def("Clear", &ConsoleMan::ClearLog)
 			.property("ForceVisibility", &ConsoleMan::IsForceVisible, &ConsoleMan::ForceVisibility)
 			.property("ScreenSize", &ConsoleMan::GetConsoleScreenSize, &ConsoleMan::SetConsoleScreenSize),
@@ -2217,6 +2317,7 @@ int LuaMan::Create()
 
     // Assign the manager instances to globals in the lua master state
     globals(m_pMasterState)["TimerMan"] = &g_TimerMan;
+    globals(m_pMasterState)["ProfilerMan"] = &g_ProfilerMan;
     globals(m_pMasterState)["FrameMan"] = &g_FrameMan;
     globals(m_pMasterState)["PresetMan"] = &g_PresetMan;
     globals(m_pMasterState)["AudioMan"] = &g_AudioMan;
@@ -2255,7 +2356,7 @@ void LuaMan::ClearUserModuleCache()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int LuaMan::ReadProperty(std::string propName, Reader &reader)
+int LuaMan::ReadProperty(const std::string &propName, Reader &reader)
 {
 //    if (propName == "AddEffect")
 //        g_PresetMan.GetEntityPreset(reader);
@@ -2289,7 +2390,13 @@ int LuaMan::Save(Writer &writer) const
 
 void LuaMan::Destroy()
 {
+    for (std::unordered_map<string, PresetCallbacks>::iterator itr = m_PresetCallbacks.begin(); itr != m_PresetCallbacks.end(); ++itr)
+        ReleasePresetCallbackRefs(itr->second);
+    m_PresetCallbacks.clear();
+
     lua_close(m_pMasterState);
+    // All the registry references handed out went away with the state
+    ++m_StateGeneration;
 
 	//Close all opened files
 	for (int i = 0; i < MAX_OPEN_FILES; ++i)
@@ -2558,6 +2665,292 @@ string LuaMan::GetNewObjectID()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPresetCallbacks
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the registry references to the functions of a scripted preset,
+//                  resolving them the first time they're asked for.
+
+const LuaMan::PresetCallbacks * LuaMan::GetPresetCallbacks(const string &presetName, const string &profilerName)
+{
+    std::unordered_map<string, PresetCallbacks>::iterator itr = m_PresetCallbacks.find(presetName);
+    if (itr != m_PresetCallbacks.end())
+    {
+        ++itr->second.m_UserCount;
+        return &(itr->second);
+    }
+
+    // Don't remember misses, the preset may well get defined later
+    int presetRef = GetGlobalRef(presetName);
+    if (presetRef == NO_LUA_REF)
+        return 0;
+
+    // Same order as the PresetCallback enum
+    static const char *s_CallbackNames[CALLBACK_COUNT] = { "Create", "Destroy", "Update", "UpdateAI", "OnPieMenu" };
+
+    PresetCallbacks &callbacks = m_PresetCallbacks[presetName];
+    for (int i = 0; i < CALLBACK_COUNT; ++i)
+    {
+        callbacks.m_FunctionRefs[i] = GetFunctionRef(presetRef, s_CallbackNames[i]);
+        callbacks.m_ProfilerZoneIDs[i] = g_ProfilerMan.RegisterZone("Script: " + profilerName + ":" + s_CallbackNames[i]);
+    }
+    callbacks.m_PresetName = presetName;
+    callbacks.m_UserCount = 1;
+    callbacks.m_Superseded = false;
+
+    // The functions are held on to by their own references, so the table itself isn't needed anymore
+    ReleaseRef(presetRef, m_StateGeneration);
+
+    return &callbacks;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleasePresetCallbacks
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases resolved preset functions gotten from GetPresetCallbacks.
+
+void LuaMan::ReleasePresetCallbacks(const PresetCallbacks *&pCallbacks, unsigned int stateGeneration)
+{
+    // Anything from an older state is gone already, map entry and all
+    if (pCallbacks && stateGeneration == m_StateGeneration)
+    {
+        std::unordered_map<string, PresetCallbacks>::iterator itr = m_PresetCallbacks.find(pCallbacks->m_PresetName);
+        if (itr != m_PresetCallbacks.end() && --itr->second.m_UserCount <= 0 && itr->second.m_Superseded)
+        {
+            ReleasePresetCallbackRefs(itr->second);
+            m_PresetCallbacks.erase(itr);
+        }
+    }
+
+    pCallbacks = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SupersedePresetCallbacks
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the resolved functions of a preset as no longer being asked for.
+
+void LuaMan::SupersedePresetCallbacks(const string &presetName)
+{
+    std::unordered_map<string, PresetCallbacks>::iterator itr = m_PresetCallbacks.find(presetName);
+    if (itr == m_PresetCallbacks.end())
+        return;
+
+    if (itr->second.m_UserCount <= 0)
+    {
+        ReleasePresetCallbackRefs(itr->second);
+        m_PresetCallbacks.erase(itr);
+    }
+    else
+        itr->second.m_Superseded = true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleasePresetCallbackRefs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases all the registry references of resolved preset functions.
+
+void LuaMan::ReleasePresetCallbackRefs(PresetCallbacks &callbacks)
+{
+    for (int i = 0; i < CALLBACK_COUNT; ++i)
+        ReleaseRef(callbacks.m_FunctionRefs[i], m_StateGeneration);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetGlobalRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a registry reference to whatever is stored at a global var, which
+//                  may be nested inside tables.
+
+int LuaMan::GetGlobalRef(const string &globalName)
+{
+    if (!PushGlobal(globalName))
+    {
+        lua_pop(m_pMasterState, 1);
+        return NO_LUA_REF;
+    }
+
+    // Pops the value off the stack
+    return luaL_ref(m_pMasterState, LUA_REGISTRYINDEX);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetFunctionRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a registry reference to a function stored in a field of an already
+//                  referenced table or object.
+
+int LuaMan::GetFunctionRef(int tableRef, const string &functionName)
+{
+    if (tableRef == NO_LUA_REF)
+        return NO_LUA_REF;
+
+    lua_rawgeti(m_pMasterState, LUA_REGISTRYINDEX, tableRef);
+    if (!lua_istable(m_pMasterState, -1) && !lua_isuserdata(m_pMasterState, -1))
+    {
+        lua_pop(m_pMasterState, 1);
+        return NO_LUA_REF;
+    }
+
+    // Not a raw get, so fields of luabind objects are found too
+    lua_getfield(m_pMasterState, -1, functionName.c_str());
+    if (!lua_isfunction(m_pMasterState, -1))
+    {
+        lua_pop(m_pMasterState, 2);
+        return NO_LUA_REF;
+    }
+
+    // Pops the function off the stack, then get rid of the table under it
+    int functionRef = luaL_ref(m_pMasterState, LUA_REGISTRYINDEX);
+    lua_pop(m_pMasterState, 1);
+
+    return functionRef;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CreateEntityProxyRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Creates the Lua representation of an Entity, cast to its actual class,
+//                  and makes a registry reference to it.
+
+int LuaMan::CreateEntityProxyRef(Entity *pEntity, const string &className)
+{
+    if (!pEntity)
+        return NO_LUA_REF;
+
+    // Equivalent of running "To<Class>(LuaMan.TempEntity)", without having to compile anything
+    lua_getglobal(m_pMasterState, ("To" + className).c_str());
+    if (!lua_isfunction(m_pMasterState, -1))
+    {
+        m_LastError = "There is no To" + className + " function to create the Lua representation of a " + className + " with!";
+        g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+        ClearErrors();
+        lua_pop(m_pMasterState, 1);
+        return NO_LUA_REF;
+    }
+
+    SetTempEntity(pEntity);
+    PushGlobal("LuaMan.TempEntity");
+
+    int proxyRef = NO_LUA_REF;
+    if (lua_pcall(m_pMasterState, 1, 1, 0))
+    {
+        m_LastError = lua_tostring(m_pMasterState, -1);
+        g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+        ClearErrors();
+        lua_pop(m_pMasterState, 1);
+    }
+    else if (lua_isnil(m_pMasterState, -1))
+        lua_pop(m_pMasterState, 1);
+    else
+        proxyRef = luaL_ref(m_pMasterState, LUA_REGISTRYINDEX);
+
+    SetTempEntity(0);
+
+    return proxyRef;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases a registry reference so what it referred to can be collected.
+
+void LuaMan::ReleaseRef(int &ref, unsigned int stateGeneration)
+{
+    if (ref != NO_LUA_REF && m_pMasterState && stateGeneration == m_StateGeneration)
+        luaL_unref(m_pMasterState, LUA_REGISTRYINDEX, ref);
+
+    ref = NO_LUA_REF;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CallFunctionRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Calls a referenced function on the master state, passing in a referenced
+//                  value as its only argument.
+
+int LuaMan::CallFunctionRef(int functionRef, int argumentRef, bool consoleErrors)
+{
+    // Same as the "if X.Function and Y then" guards around the script strings this replaces
+    if (functionRef == NO_LUA_REF || argumentRef == NO_LUA_REF)
+        return 0;
+
+    int error = 0;
+    // Whatever fails, the stack is put back the way it was
+    int stackTop = lua_gettop(m_pMasterState);
+
+    try
+    {
+        lua_rawgeti(m_pMasterState, LUA_REGISTRYINDEX, functionRef);
+        lua_rawgeti(m_pMasterState, LUA_REGISTRYINDEX, argumentRef);
+        if (lua_pcall(m_pMasterState, 1, 0, 0))
+        {
+            // Retrieve the error message off the stack
+            m_LastError = lua_tostring(m_pMasterState, -1);
+            lua_settop(m_pMasterState, stackTop);
+            if (consoleErrors)
+            {
+                g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+                ClearErrors();
+            }
+            error = -1;
+        }
+    }
+    catch(const std::exception &e)
+    {
+        m_LastError = e.what();
+        lua_settop(m_pMasterState, stackTop);
+        if (consoleErrors)
+        {
+            g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+            ClearErrors();
+        }
+        error = -1;
+    }
+
+    return error;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PushGlobal
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Pushes whatever is stored at a global var onto the stack, which may be
+//                  nested inside tables.
+
+bool LuaMan::PushGlobal(const string &globalName)
+{
+    size_t start = 0;
+    size_t dot = globalName.find('.');
+    lua_getglobal(m_pMasterState, globalName.substr(0, dot).c_str());
+
+    // Walk down the nested tables, replacing each one on the stack with the next
+    while (dot != string::npos && !lua_isnil(m_pMasterState, -1))
+    {
+        start = dot + 1;
+        dot = globalName.find('.', start);
+        if (!lua_istable(m_pMasterState, -1) && !lua_isuserdata(m_pMasterState, -1))
+        {
+            lua_pop(m_pMasterState, 1);
+            lua_pushnil(m_pMasterState);
+            break;
+        }
+        lua_getfield(m_pMasterState, -1, globalName.substr(start, dot == string::npos ? string::npos : dot - start).c_str());
+        lua_remove(m_pMasterState, -2);
+    }
+
+    return !lua_isnil(m_pMasterState, -1);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2566,6 +2959,9 @@ string LuaMan::GetNewObjectID()
 
 void LuaMan::Update()
 {
+	static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("LuaMan::Update");
+	ProfileZone profileZone(s_ProfilerZoneID);
+
 	lua_gc(m_pMasterState, LUA_GCSTEP, 1);
 }
 
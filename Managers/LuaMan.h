@@ -28,6 +28,8 @@ namespace RTE
 {
 
 #define MAX_OPEN_FILES 10
+// The value of a Lua registry reference that doesn't refer to anything, same as LUA_NOREF
+#define NO_LUA_REF -2
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Class:           LuaMan
@@ -47,6 +49,31 @@ class LuaMan:
 
 public:
 
+// The functions a scripted MovableObject preset can define, in the order they're stored in PresetCallbacks
+enum PresetCallback
+{
+    CALLBACK_CREATE = 0,
+    CALLBACK_DESTROY,
+    CALLBACK_UPDATE,
+    CALLBACK_UPDATEAI,
+    CALLBACK_ONPIEMENU,
+    CALLBACK_COUNT
+};
+
+// Registry references to the functions defined by a scripted preset, NO_LUA_REF for any it doesn't define,
+// along with the profiler zones the calls to them are timed in
+struct PresetCallbacks
+{
+    int m_FunctionRefs[CALLBACK_COUNT];
+    int m_ProfilerZoneIDs[CALLBACK_COUNT];
+    // The name of the preset's table these were resolved from
+    std::string m_PresetName;
+    // How many of the handed out pointers to these haven't been released yet
+    int m_UserCount;
+    // Whether the preset has since had its scripts loaded anew under another name, so these can go once no one uses them
+    bool m_Superseded;
+};
+
 /*
 enum ServerResult
 {
@@ -69,7 +96,7 @@ enum ServerResult
 //                  memory. Create() should be called before using the object.
 // Arguments:       None.
 
-    LuaMan() { Clear(); }
+    LuaMan() { m_StateGeneration = 0; Clear(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -106,7 +133,7 @@ enum ServerResult
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -277,6 +304,126 @@ enum ServerResult
     std::string GetNewObjectID();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetStateGeneration
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the generation of the master state, which changes every time it is
+//                  destroyed. Registry references and PresetCallbacks handed out are only
+//                  valid for as long as the generation they were made in is current.
+// Arguments:       None.
+// Return value:    The current generation of the master state.
+
+    unsigned int GetStateGeneration() const { return m_StateGeneration; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPresetCallbacks
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the registry references to the functions of a scripted preset,
+//                  resolving them the first time they're asked for so calling them later
+//                  doesn't need any lookups or script compilation.
+// Arguments:       The name of the preset's table in the Lua state, eg "MOPixels.Pre00001".
+//                  The name to show the preset's functions as in profiler traces.
+// Return value:    The resolved functions, or 0 if the preset's table isn't defined.
+//                  Ownership is NOT transferred! Only valid for the current state generation.
+//                  Has to be released with ReleasePresetCallbacks when no longer needed.
+
+    const PresetCallbacks * GetPresetCallbacks(const std::string &presetName, const std::string &profilerName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleasePresetCallbacks
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases resolved preset functions gotten from GetPresetCallbacks. Once
+//                  the preset has been superseded and no one uses them anymore, their
+//                  registry references are released. Nothing is done if they were resolved
+//                  in a state that has since been destroyed.
+// Arguments:       The resolved functions to release, will be set to 0.
+//                  The state generation they were resolved in.
+// Return value:    None.
+
+    void ReleasePresetCallbacks(const PresetCallbacks *&pCallbacks, unsigned int stateGeneration);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SupersedePresetCallbacks
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the resolved functions of a preset as no longer being asked for,
+//                  because its scripts are being loaded anew under another name. They're
+//                  released as soon as no one uses them anymore.
+// Arguments:       The name of the old preset's table in the Lua state.
+// Return value:    None.
+
+    void SupersedePresetCallbacks(const std::string &presetName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetGlobalRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a registry reference to whatever is stored at a global var, which
+//                  may be nested inside tables, eg "MOPixels.Pre00001".
+// Arguments:       The name of the global var, with nested tables separated by dots.
+// Return value:    The registry reference, or NO_LUA_REF if the var isn't defined.
+//                  Has to be released with ReleaseRef when no longer needed.
+
+    int GetGlobalRef(const std::string &globalName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetFunctionRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes a registry reference to a function stored in a field of an already
+//                  referenced table or object.
+// Arguments:       The registry reference to the table or object to look in.
+//                  The name of the field holding the function.
+// Return value:    The registry reference, or NO_LUA_REF if there is no function there.
+//                  Has to be released with ReleaseRef when no longer needed.
+
+    int GetFunctionRef(int tableRef, const std::string &functionName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CreateEntityProxyRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Creates the Lua representation of an Entity, cast to its actual class,
+//                  and makes a registry reference to it.
+// Arguments:       The Entity to create the representation of. Ownership is NOT transferred!
+//                  The class name of the Entity, used to pick the To<Class> cast function.
+// Return value:    The registry reference, or NO_LUA_REF if it couldn't be created.
+//                  Has to be released with ReleaseRef when no longer needed.
+
+    int CreateEntityProxyRef(Entity *pEntity, const std::string &className);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases a registry reference so what it referred to can be collected.
+//                  Nothing is done if the reference was made in a state that has since
+//                  been destroyed.
+// Arguments:       The registry reference to release, will be set to NO_LUA_REF.
+//                  The state generation the reference was made in.
+// Return value:    None.
+
+    void ReleaseRef(int &ref, unsigned int stateGeneration);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CallFunctionRef
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Calls a referenced function on the master state, passing in a referenced
+//                  value as its only argument. Nothing is called if either reference is
+//                  NO_LUA_REF, which is not treated as an error.
+// Arguments:       The registry reference to the function to call.
+//                  The registry reference to the value to pass in, usually the object the
+//                  function belongs to.
+//                  Whether to report any errors to the console immediately.
+// Return value:    Returns less than zero if any errors encountered when calling the function.
+//                  To get the actual error string, call GetLastError.
+
+    int CallFunctionRef(int functionRef, int argumentRef, bool consoleErrors = true);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SetTempEntity
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -399,6 +546,10 @@ protected:
     long m_NextObjectID;
     // Temporary holder for an Entity object that we want to pass into the Lua state without fuss
     Entity *m_pTempEntity;
+    // Incremented every time the master state is destroyed, to tell stale registry references from valid ones
+    unsigned int m_StateGeneration;
+    // The resolved functions of each scripted preset, by the name of the preset's table
+    std::unordered_map<std::string, PresetCallbacks> m_PresetCallbacks;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -417,6 +568,28 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PushGlobal
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Pushes whatever is stored at a global var onto the stack, which may be
+//                  nested inside tables, eg "MOPixels.Pre00001".
+// Arguments:       The name of the global var, with nested tables separated by dots.
+// Return value:    Whether anything other than nil was pushed. Either way, exactly one
+//                  value is left on the stack.
+
+    bool PushGlobal(const std::string &globalName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleasePresetCallbackRefs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Releases all the registry references of resolved preset functions.
+// Arguments:       The resolved functions to release the references of.
+// Return value:    None.
+
+    void ReleasePresetCallbackRefs(PresetCallbacks &callbacks);
+
+
     // Disallow the use of some implicit methods.
     LuaMan(const LuaMan &reference);
     LuaMan & operator=(const LuaMan &rhs);
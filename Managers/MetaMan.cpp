@@ -266,7 +266,7 @@ int MetaMan::Load(const MetaSave *pSave)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the Reader's position is untouched.
 
-int MetaMan::ReadProperty(string propName, Reader &reader)
+int MetaMan::ReadProperty(const string &propName, Reader &reader)
 {
     if (propName == "GameState")
         reader >> m_GameState;
@@ -1627,7 +1627,7 @@ int MetaSave::Create(const MetaSave &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MetaSave::ReadProperty(std::string propName, Reader &reader)
+int MetaSave::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "SavePath")
         reader >> m_SavePath;
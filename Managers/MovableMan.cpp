@@ -22,11 +22,66 @@
 #include "Actor.h"
 #include "ADoor.h"
 #include "Atom.h"
+#include "ThreadMan.h"
+#include "SettingsMan.h"
+#include "ConsoleMan.h"
 
 namespace RTE {
 
 const string MovableMan::m_ClassName = "MovableMan";
 
+// The size of the coarse tiles the MOID layer is split into to track what the incremental update has touched
+static const int c_MOIDTileSize = 32;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static method:   GetMOIDTileSpans
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the ranges of coarse MOID layer tiles that a span of scene
+//                  coordinates covers along one axis, wrapping or clipping it to the Scene.
+// Arguments:       The first and last scene coordinates of the span.
+//                  The size of the Scene along the axis, and how many tiles that makes.
+//                  Whether the Scene wraps along the axis.
+//                  The array to fill with the first and last tile of each range.
+// Return value:    How many ranges were filled in, up to two if the span crosses the seam.
+
+static int GetMOIDTileSpans(int low, int high, int sceneSize, int tileCount, bool wraps, int spans[2][2])
+{
+    if (high < low || sceneSize <= 0 || tileCount <= 0)
+        return 0;
+
+    if (!wraps)
+    {
+        low = MAX(low, 0);
+        high = MIN(high, sceneSize - 1);
+        if (low > high)
+            return 0;
+        spans[0][0] = low / c_MOIDTileSize;
+        spans[0][1] = high / c_MOIDTileSize;
+        return 1;
+    }
+
+    if (high - low + 1 >= sceneSize)
+    {
+        spans[0][0] = 0;
+        spans[0][1] = tileCount - 1;
+        return 1;
+    }
+
+    int wrappedLow = ((low % sceneSize) + sceneSize) % sceneSize;
+    int wrappedHigh = wrappedLow + (high - low);
+    spans[0][0] = wrappedLow / c_MOIDTileSize;
+    if (wrappedHigh < sceneSize)
+    {
+        spans[0][1] = wrappedHigh / c_MOIDTileSize;
+        return 1;
+    }
+    spans[0][1] = tileCount - 1;
+    spans[1][0] = 0;
+    spans[1][1] = (wrappedHigh - sceneSize) / c_MOIDTileSize;
+    return 2;
+}
+
 
 // Comparison functor for sorting movable objects by their X position using STL's sort
 struct MOXPosComparison:
@@ -58,10 +113,12 @@ void MovableMan::Clear()
     m_SortTeamRoster[Activity::TEAM_2] = false;
     m_SortTeamRoster[Activity::TEAM_3] = false;
     m_SortTeamRoster[Activity::TEAM_4] = false;
-    m_ValiditySearchResults.clear();
     m_AddedAlarmEvents.clear();
     m_AlarmEvents.clear();
     m_MOIDIndex.clear();
+    m_ObjectSlots.clear();
+    m_FreeObjectSlots.clear();
+    m_ObjectSlotsByPointer.clear();
     m_AGResolution = 1;
     m_SplashRatio = 0.75;
     m_MaxDroppedItems = 25;
@@ -70,6 +127,24 @@ void MovableMan::Clear()
     m_SloMoDuration = 1000;
     m_SettlingEnabled = true;
     m_MOSubtractionEnabled = true;
+    m_ParallelParticlesEnabled = false;
+    m_ParallelParticleBatch.clear();
+    m_InParallelParticleBatch.clear();
+    m_ActorGrid.Reset();
+    m_ItemGrid.Reset();
+    m_IncrementalMOIDLayerEnabled = false;
+    m_MOIDLayerValidationEnabled = false;
+    m_ViewportMOColorLayerEnabled = false;
+    m_MOIDDrawQueue.clear();
+    m_MOIDFootprints.clear();
+    m_MOIDUpdateStamp = 0;
+    m_pMOIDFootprintBitmap = 0;
+    m_DirtyMOIDTiles.clear();
+    m_DirtyMOIDTileCountX = 0;
+    m_DirtyMOIDTileCountY = 0;
+    m_StrayMOIDRects.clear();
+    m_pMOIDValidationBitmap = 0;
+    m_MOIDRedrawCount = 0;
     m_pObjectToScriptUpdate = 0;
 }
 
@@ -100,7 +175,7 @@ int MovableMan::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int MovableMan::ReadProperty(std::string propName, Reader &reader)
+int MovableMan::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "AddEffect")
         g_PresetMan.GetEntityPreset(reader);
@@ -124,6 +199,14 @@ int MovableMan::ReadProperty(std::string propName, Reader &reader)
         reader >> m_SettlingEnabled;
     else if (propName == "EnableMOSubtraction")
         reader >> m_MOSubtractionEnabled;
+    else if (propName == "EnableParallelParticles")
+        reader >> m_ParallelParticlesEnabled;
+    else if (propName == "EnableIncrementalMOIDLayer")
+        reader >> m_IncrementalMOIDLayerEnabled;
+    else if (propName == "EnableMOIDLayerValidation")
+        reader >> m_MOIDLayerValidationEnabled;
+    else if (propName == "EnableViewportMOColorLayer")
+        reader >> m_ViewportMOColorLayerEnabled;
     else
         // See if the base class(es) can find a match instead
         return Serializable::ReadProperty(propName, reader);
@@ -177,6 +260,8 @@ void MovableMan::Destroy()
     for (deque<MovableObject *>::iterator it3 = m_Particles.begin(); it3 != m_Particles.end(); ++it3)
         delete (*it3);
 
+    destroy_bitmap(m_pMOIDValidationBitmap);
+
     Clear();
 }
 
@@ -208,8 +293,31 @@ MovableObject * MovableMan::GetMOFromID(MOID whichID)
 
 void MovableMan::RegisterObject(MovableObject * mo) 
 { 
-	if (mo) 
-		m_KnownObjects[mo->GetUniqueID()] = mo; 
+	if (!mo)
+		return;
+
+	m_KnownObjects[mo->GetUniqueID()] = mo;
+
+	// Objects can be created more than once, they keep their slot
+	if (m_ObjectSlotsByPointer.find(mo) != m_ObjectSlotsByPointer.end())
+		return;
+
+	unsigned int slot;
+	if (!m_FreeObjectSlots.empty())
+	{
+		slot = m_FreeObjectSlots.front();
+		m_FreeObjectSlots.pop_front();
+	}
+	else
+	{
+		RTEAssert(m_ObjectSlots.size() < (1 << c_ObjectHandleSlotBits), "Too many MovableObjects to give handles to!");
+		slot = m_ObjectSlots.size();
+		ObjectSlot newSlot = { 0, 1, NOT_HELD };
+		m_ObjectSlots.push_back(newSlot);
+	}
+	m_ObjectSlots[slot].m_pObject = mo;
+	m_ObjectSlots[slot].m_Category = NOT_HELD;
+	m_ObjectSlotsByPointer[mo] = slot;
 }
 
 
@@ -226,7 +334,87 @@ void MovableMan::UnregisterObject(MovableObject * mo)
 	{
 		m_KnownObjects.erase(mo->GetUniqueID());
 		//g_ConsoleMan.PrintString(std::to_string(mo->GetUniqueID()));
+
+		std::unordered_map<const MovableObject *, unsigned int>::iterator slotItr = m_ObjectSlotsByPointer.find(mo);
+		if (slotItr != m_ObjectSlotsByPointer.end())
+		{
+			ObjectSlot &slot = m_ObjectSlots[slotItr->second];
+			slot.m_pObject = 0;
+			slot.m_Category = NOT_HELD;
+			// Once the generation runs out the slot is retired rather than wrapped around, or old handles to it would start leading to new objects
+			if (slot.m_Generation < (1U << (32 - c_ObjectHandleSlotBits)) - 1)
+			{
+				++slot.m_Generation;
+				m_FreeObjectSlots.push_back(slotItr->second);
+			}
+			m_ObjectSlotsByPointer.erase(slotItr);
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetObjectHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a handle to a registered object, which can be held on to instead
+//                  of a pointer.
+
+unsigned int MovableMan::GetObjectHandle(const MovableObject *pMO) const
+{
+	std::unordered_map<const MovableObject *, unsigned int>::const_iterator slotItr = m_ObjectSlotsByPointer.find(pMO);
+	if (slotItr == m_ObjectSlotsByPointer.end())
+		return 0;
+
+	return (m_ObjectSlots[slotItr->second].m_Generation << c_ObjectHandleSlotBits) | slotItr->second;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetObjectFromHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the object a handle from GetObjectHandle leads to.
+
+MovableObject * MovableMan::GetObjectFromHandle(unsigned int handle) const
+{
+	unsigned int slot = handle & ((1 << c_ObjectHandleSlotBits) - 1);
+	if (handle == 0 || slot >= m_ObjectSlots.size() || m_ObjectSlots[slot].m_Generation != (handle >> c_ObjectHandleSlotBits))
+		return 0;
+
+	return m_ObjectSlots[slot].m_pObject;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetObjectCategory
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records which of the lists of this MovableMan an object was put in or
+//                  taken out of.
+
+void MovableMan::SetObjectCategory(MovableObject *pMO, ObjectCategory category)
+{
+	if (!pMO)
+		return;
+
+	std::unordered_map<const MovableObject *, unsigned int>::iterator slotItr = m_ObjectSlotsByPointer.find(pMO);
+	if (slotItr == m_ObjectSlotsByPointer.end())
+	{
+		RegisterObject(pMO);
+		slotItr = m_ObjectSlotsByPointer.find(pMO);
 	}
+	m_ObjectSlots[slotItr->second].m_Category = category;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseAllObjectCategories
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records that no objects are in any of the lists of this MovableMan
+//                  anymore.
+
+void MovableMan::ReleaseAllObjectCategories()
+{
+	for (vector<ObjectSlot>::iterator slotItr = m_ObjectSlots.begin(); slotItr != m_ObjectSlots.end(); ++slotItr)
+		slotItr->m_Category = NOT_HELD;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -258,10 +446,15 @@ void MovableMan::PurgeAllMOs()
     m_SortTeamRoster[Activity::TEAM_2] = false;
     m_SortTeamRoster[Activity::TEAM_3] = false;
     m_SortTeamRoster[Activity::TEAM_4] = false;
-    m_ValiditySearchResults.clear();
+    ReleaseAllObjectCategories();
     m_AddedAlarmEvents.clear();
     m_AlarmEvents.clear();
     m_MOIDIndex.clear();
+    m_MOIDDrawQueue.clear();
+    // The scene may be on its way out, so leave the footprints for SceneMan to clear along with whatever else was drawn
+    ReleaseMOIDFootprints();
+    m_ActorGrid.RemoveAllObjects();
+    m_ItemGrid.RemoveAllObjects();
 
     // Set the time limit to 0 so it will report as being past it from the start of simulation
     m_SloMoTimer.SetRealTimeLimitMS(0);
@@ -561,45 +754,36 @@ Actor * MovableMan::GetPrevTeamActor(int team, Actor *pBeforeThis)
 
 Actor * MovableMan::GetClosestTeamActor(int team, int player, const Vector &scenePoint, int maxRadius, float &getDistance, const Actor *pExcludeThis)
 {
-    if (team < Activity::NOTEAM || team >= Activity::MAXTEAMCOUNT || m_Actors.empty() ||  m_ActorRoster[team].empty())
+    if (team < Activity::NOTEAM || team >= Activity::MAXTEAMCOUNT || m_Actors.empty() || (team != Activity::NOTEAM && m_ActorRoster[team].empty()))
         return 0;
 
-    Activity *pActivity = g_ActivityMan.GetActivity();
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
 
-    Vector distanceVec;
-    float distance;
-    float shortestDistance = maxRadius;
-    Actor *pClosestActor = 0;
+    Activity *pActivity = g_ActivityMan.GetActivity();
 
-    // If we're looking for a noteam actor, then go through the entire actor list instead
-    if (team == Activity::NOTEAM)
+    // Actors of specific teams that are controlled by the player or are other players' brains are left out
+    std::function<bool(MovableObject *)> filter = [team, player, pExcludeThis, pActivity](MovableObject *pObject)
     {
-        for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-        {
-            if ((*aIt) == pExcludeThis || (*aIt)->GetTeam() != Activity::NOTEAM)
-                continue;
+        Actor *pActor = static_cast<Actor *>(pObject);
+        if (pActor == pExcludeThis || pActor->GetTeam() != team)
+            return false;
+        return team == Activity::NOTEAM || !(pActor->GetController()->IsPlayerControlled(player) || (pActivity && pActivity->IsOtherPlayerBrain(pActor, player)));
+    };
 
-            distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-            distance = distanceVec.GetMagnitude();
+    Vector distanceVec;
+    Actor *pClosestActor = static_cast<Actor *>(m_ActorGrid.GetClosestObject(scenePoint, maxRadius, filter, distanceVec));
+    float shortestDistance = pClosestActor ? distanceVec.GetMagnitude() : maxRadius;
 
-            // Check if even within search radius
-            if (distance < shortestDistance)
-            {
-                shortestDistance = distance;
-                pClosestActor = *aIt;
-            }
-        }
-    }
-    // A specific team, so use the rosters instead
-    else
+    // Actors added this frame are already on their team's roster, but don't make it into the grid until the end of the frame
+    if (team != Activity::NOTEAM)
     {
-        for (list<Actor *>::iterator aIt = m_ActorRoster[team].begin(); aIt != m_ActorRoster[team].end(); ++aIt)
+        for (deque<Actor *>::iterator aIt = m_AddedActors.begin(); aIt != m_AddedActors.end(); ++aIt)
         {
-            if ((*aIt) == pExcludeThis || (*aIt)->GetController()->IsPlayerControlled(player) || (pActivity && pActivity->IsOtherPlayerBrain(*aIt, player)))
+            if (!filter(*aIt))
                 continue;
 
-            distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-            distance = distanceVec.GetMagnitude();
+            float distance = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint).GetMagnitude();
 
             // Check if even within search radius
             if (distance < shortestDistance)
@@ -623,33 +807,19 @@ Actor * MovableMan::GetClosestTeamActor(int team, int player, const Vector &scen
 
 Actor * MovableMan::GetClosestEnemyActor(int team, const Vector &scenePoint, int maxRadius, Vector &getDistance)
 {
-    if (team < Activity::NOTEAM || team >= Activity::MAXTEAMCOUNT || m_Actors.empty() ||  m_ActorRoster[team].empty())
+    if (team < Activity::NOTEAM || team >= Activity::MAXTEAMCOUNT || m_Actors.empty() || (team != Activity::NOTEAM && m_ActorRoster[team].empty()))
         return 0;
-    
-    Activity *pActivity = g_ActivityMan.GetActivity();
-    
+
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
+
+    std::function<bool(MovableObject *)> filter = [team](MovableObject *pObject) { return pObject->GetTeam() != team; };
+
     Vector distanceVec;
-    float distance;
-    float shortestDistance = maxRadius;
-    Actor *pClosestActor = 0;
-    
-    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-    {
-        if ((*aIt)->GetTeam() == team)
-            continue;
+    Actor *pClosestActor = static_cast<Actor *>(m_ActorGrid.GetClosestObject(scenePoint, maxRadius, filter, distanceVec));
+    if (pClosestActor)
+        getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
 
-        distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-        distance = distanceVec.GetMagnitude();
-        
-        // Check if even within search radius
-        if (distance < shortestDistance)
-        {
-            shortestDistance = distance;
-            pClosestActor = *aIt;
-            getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
-        }
-    }
-    
     return pClosestActor;
 }
 
@@ -665,31 +835,94 @@ Actor * MovableMan::GetClosestActor(Vector &scenePoint, int maxRadius, float &ge
     if (m_Actors.empty())
         return 0;
 
-    Activity *pActivity = g_ActivityMan.GetActivity();
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
+
+    std::function<bool(MovableObject *)> filter = [pExcludeThis](MovableObject *pObject) { return pObject != pExcludeThis; };
 
     Vector distanceVec;
-    float distance;
-    float shortestDistance = maxRadius;
-    Actor *pClosestActor = 0;
+    Actor *pClosestActor = static_cast<Actor *>(m_ActorGrid.GetClosestObject(scenePoint, maxRadius, filter, distanceVec));
 
-    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-    {
-        if ((*aIt) == pExcludeThis)
-            continue;
+    getDistance = pClosestActor ? distanceVec.GetMagnitude() : maxRadius;
+    return pClosestActor;
+}
 
-        distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-        distance = distanceVec.GetMagnitude();
 
-        // Check if even within search radius
-        if (distance < shortestDistance)
-        {
-            shortestDistance = distance;
-            pClosestActor = *aIt;
-        }
-    }
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the Actors in the internal Actor list whose positions are
+//                  within a radius of a scene point.
 
-    getDistance = shortestDistance;
-    return pClosestActor;
+vector<Actor *> MovableMan::GetActorsInRadius(const Vector &center, float radius)
+{
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
+
+    vector<MovableObject *> gridResults;
+    m_ActorGrid.GetObjectsInRadius(center, radius, gridResults);
+
+    vector<Actor *> actors;
+    actors.reserve(gridResults.size());
+    for (vector<MovableObject *>::iterator itr = gridResults.begin(); itr != gridResults.end(); ++itr)
+        actors.push_back(static_cast<Actor *>(*itr));
+    return actors;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the Actors in the internal Actor list whose positions are
+//                  inside a box on the scene.
+
+vector<Actor *> MovableMan::GetActorsInBox(const Box &box)
+{
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
+
+    vector<MovableObject *> gridResults;
+    m_ActorGrid.GetObjectsInBox(box, gridResults);
+
+    vector<Actor *> actors;
+    actors.reserve(gridResults.size());
+    for (vector<MovableObject *>::iterator itr = gridResults.begin(); itr != gridResults.end(); ++itr)
+        actors.push_back(static_cast<Actor *>(*itr));
+    return actors;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetItemsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the pickup-able items in the internal Item list whose
+//                  positions are within a radius of a scene point.
+
+vector<MovableObject *> MovableMan::GetItemsInRadius(const Vector &center, float radius)
+{
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
+
+    vector<MovableObject *> items;
+    m_ItemGrid.GetObjectsInRadius(center, radius, items);
+    return items;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetItemsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the pickup-able items in the internal Item list whose
+//                  positions are inside a box on the scene.
+
+vector<MovableObject *> MovableMan::GetItemsInBox(const Box &box)
+{
+    if (!SpatialGridsMatchScene())
+        UpdateSpatialGrids();
+
+    vector<MovableObject *> items;
+    m_ItemGrid.GetObjectsInBox(box, items);
+    return items;
 }
 
 
@@ -845,6 +1078,13 @@ void MovableMan::AddActor(Actor *pActorToAdd)
 {
     if (pActorToAdd)
     {
+        // Adding to the lists from a worker thread would race, and make the list order depend on thread timing
+        if (ThreadMan::IsInParallelJob())
+        {
+            g_ThreadMan.DeferCommand([=]() { AddActor(pActorToAdd); });
+            return;
+        }
+
 //        pActorToAdd->SetPrevPos(pActorToAdd->GetPos());
 //        pActorToAdd->Update();
 //        pActorToAdd->PostTravel();
@@ -864,6 +1104,7 @@ void MovableMan::AddActor(Actor *pActorToAdd)
             pActorToAdd->SetAge(0);
         }
         m_AddedActors.push_back(pActorToAdd);
+        SetObjectCategory(pActorToAdd, HELD_ACTOR);
 
 		AddActorToTeamRoster(pActorToAdd);
     }
@@ -881,6 +1122,12 @@ void MovableMan::AddItem(MovableObject *pItemToAdd)
 {
     if (pItemToAdd)
     {
+        if (ThreadMan::IsInParallelJob())
+        {
+            g_ThreadMan.DeferCommand([=]() { AddItem(pItemToAdd); });
+            return;
+        }
+
 //        pItemToAdd->SetPrevPos(pItemToAdd->GetPos());
 //        pItemToAdd->Update();
 //        pItemToAdd->PostTravel();
@@ -902,6 +1149,7 @@ void MovableMan::AddItem(MovableObject *pItemToAdd)
             pItemToAdd->SetAge(0);
         }
         m_AddedItems.push_back(pItemToAdd);
+        SetObjectCategory(pItemToAdd, HELD_ITEM);
     }
 }
 
@@ -917,6 +1165,12 @@ void MovableMan::AddParticle(MovableObject *pMOToAdd)
 {
     if (pMOToAdd)
     {
+        if (ThreadMan::IsInParallelJob())
+        {
+            g_ThreadMan.DeferCommand([=]() { AddParticle(pMOToAdd); });
+            return;
+        }
+
 //        pMOToAdd->SetPrevPos(pMOToAdd->GetPos());
 //        pMOToAdd->Update();
 //        pMOToAdd->Travel();
@@ -936,9 +1190,15 @@ void MovableMan::AddParticle(MovableObject *pMOToAdd)
             pMOToAdd->SetAge(0);
         }
         if (pMOToAdd->IsDevice())
+        {
             m_AddedItems.push_back(pMOToAdd);
+            SetObjectCategory(pMOToAdd, HELD_ITEM);
+        }
         else
+        {
             m_AddedParticles.push_back(pMOToAdd);
+            SetObjectCategory(pMOToAdd, HELD_PARTICLE);
+        }
     }
 }
 
@@ -978,7 +1238,10 @@ bool MovableMan::RemoveActor(MovableObject *pActorToRem)
                 }
             }
         }
+        if (removed)
+            SetObjectCategory(pActorToRem, NOT_HELD);
 		RemoveActorFromTeamRoster(dynamic_cast<Actor *>(pActorToRem));
+        m_ActorGrid.RemoveObject(pActorToRem);
     }
     return removed;
 }
@@ -1019,6 +1282,9 @@ bool MovableMan::RemoveItem(MovableObject *pItemToRem)
                 }
             }
         }
+        if (removed)
+            SetObjectCategory(pItemToRem, NOT_HELD);
+        m_ItemGrid.RemoveObject(pItemToRem);
     }
     return removed;
 }
@@ -1121,6 +1387,8 @@ bool MovableMan::RemoveParticle(MovableObject *pMOToRem)
                 }
             }
         }
+        if (removed)
+            SetObjectCategory(pMOToRem, NOT_HELD);
     }
     return removed;
 }
@@ -1147,155 +1415,6 @@ bool MovableMan::ValidateMOIDs()
 }
 
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          ValidMO
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Indicates whether the passed in MovableObject pointer points to an
-//                  MO that's currently active in the simulation, and kept by this
-//                  MovableMan. Internal optimization is made so that the same MO can
-//                  efficiently be checked many times during the same frame.
-
-bool MovableMan::ValidMO(const MovableObject *pMOToCheck)
-{
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-
-        // See if this MO has been found earlier this frame
-        for (deque<pair <const MovableObject *, bool> >::iterator itr = m_ValiditySearchResults.begin(); !found && itr != m_ValiditySearchResults.end(); ++itr)
-        {
-            // If the MO is found to have been searched for earlier this frame, then just return the search results
-            if (itr->first == pMOToCheck)
-                return itr->second;
-        }
-
-        // Check actors
-        found = found ? true : IsActor(pMOToCheck);
-        // Check Items
-        found = found ? true : IsDevice(pMOToCheck);
-        // Check particles
-        found = found ? true : IsParticle(pMOToCheck);
-
-        // Save search result for future requests this frame
-        m_ValiditySearchResults.push_back(pair<const MovableObject *, bool>(pMOToCheck, found));
-    }
-
-    return found;
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          IsActor
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Indicates whether the passed in MovableObject is an active Actor kept
-//                  by this MovableMan or not.                  
-
-bool MovableMan::IsActor(const MovableObject *pMOToCheck)
-{
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-        for (deque<Actor *>::iterator itr = m_Actors.begin(); !found && itr != m_Actors.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the actors just added this frame
-        if (!found)
-        {
-            for (deque<Actor *>::iterator itr = m_AddedActors.begin(); !found && itr != m_AddedActors.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          IsDevice
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Indicates whether the passed in MovableObject is an active Item kept
-//                  by this MovableMan or not.                  
-
-bool MovableMan::IsDevice(const MovableObject *pMOToCheck)
-{
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-        for (deque<MovableObject *>::iterator itr = m_Items.begin(); !found && itr != m_Items.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the items just added this frame
-        if (!found)
-        {
-            for (deque<MovableObject *>::iterator itr = m_AddedItems.begin(); !found && itr != m_AddedItems.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          IsParticle
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Indicates whether the passed in MovableObject is an active Item kept
-//                  by this MovableMan or not.                      
-
-bool MovableMan::IsParticle(const MovableObject *pMOToCheck)
-{
-    bool found = false;
-
-    if (pMOToCheck)
-    {
-        for (deque<MovableObject *>::iterator itr = m_Particles.begin(); !found && itr != m_Particles.end(); ++itr)
-        {
-            if (*itr == pMOToCheck)
-            {
-                found = true;
-                break;
-            }
-        }
-        // Try the items just added this frame
-        if (!found)
-        {
-            for (deque<MovableObject *>::iterator itr = m_AddedParticles.begin(); !found && itr != m_AddedParticles.end(); ++itr)
-            {
-                if (*itr == pMOToCheck)
-                {
-                    found = true;
-                    break;
-                }
-            }
-        }
-    }
-    return found;
-}
-
-
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsOfActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1438,6 +1557,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
         if ((onlyTeam == Activity::NOTEAM || (*aIt)->GetTeam() == onlyTeam) && (!noBrains || !(*aIt)->HasObjectInGroup("Brains")))
         {
             actorList.push_back((*aIt));
+            SetObjectCategory(*aIt, NOT_HELD);
             addedCount++;
         }
         else
@@ -1453,6 +1573,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
         if ((onlyTeam == Activity::NOTEAM || (*aIt)->GetTeam() == onlyTeam) && (!noBrains || !(*aIt)->HasObjectInGroup("Brains")))
         {
             actorList.push_back((*aIt));
+            SetObjectCategory(*aIt, NOT_HELD);
             addedCount++;
         }
         else
@@ -1464,6 +1585,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
     // Also clear the actor rosters
     for (int team = Activity::TEAM_1; team < Activity::MAXTEAMCOUNT; ++team)
         m_ActorRoster[team].clear();
+    m_ActorGrid.RemoveAllObjects();
 
     return addedCount;
 }
@@ -1483,6 +1605,7 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     for (deque<MovableObject *>::iterator iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt)
     {
         itemList.push_back((*iIt));
+        SetObjectCategory(*iIt, NOT_HELD);
         addedCount++;
     }
     // Clear the internal Actor list; we transferred the ownership of them
@@ -1492,10 +1615,12 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     for (deque<MovableObject *>::iterator iIt = m_AddedItems.begin(); iIt != m_AddedItems.end(); ++iIt)
     {
         itemList.push_back((*iIt));
+        SetObjectCategory(*iIt, NOT_HELD);
         addedCount++;
     }
     // Clear the internal Item list; we transferred the ownership of them
     m_AddedItems.clear();
+    m_ItemGrid.RemoveAllObjects();
 
     return addedCount;
 }
@@ -1652,7 +1777,7 @@ void MovableMan::Update()
 
     // Clear the MO color layer only if this is a drawn update
     if (g_TimerMan.DrawnSimUpdate())
-        g_SceneMan.ClearMOColorLayer();
+        g_SceneMan.ClearMOColorLayer(m_ViewportMOColorLayerEnabled);
 
     // If this is the first sim update since a drawn one, then clear the post effects
     if (g_TimerMan.SimUpdatesSinceDrawn() == 0)
@@ -1666,8 +1791,6 @@ void MovableMan::Update()
     m_SortTeamRoster[Activity::TEAM_2] = false;
     m_SortTeamRoster[Activity::TEAM_3] = false;
     m_SortTeamRoster[Activity::TEAM_4] = false;
-    // Clear out MO finding optimization buffer - will be added to each frame as thigns are searched for as curently exisitng in the manager
-    m_ValiditySearchResults.clear();
 
     // Move all last frame's alarm events into the proper buffer, and clear out the new one to fill up with this frame's
     m_AlarmEvents.clear();
@@ -1733,11 +1856,48 @@ void MovableMan::Update()
         // Travel particles
 		g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_PARTICLES_PASS1);
         {
-            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
+            // First travel all the particles that can be across all threads. Their PostTravel marks them as updated so they're skipped below.
+            m_InParallelParticleBatch.assign(m_Particles.size(), false);
+            if (m_ParallelParticlesEnabled)
+            {
+                m_ParallelParticleBatch.clear();
+                for (int i = 0; i < m_Particles.size(); ++i)
+                {
+                    if (!(m_Particles[i]->IsUpdated()) && m_Particles[i]->CanUpdateInParallel())
+                    {
+                        m_ParallelParticleBatch.push_back(m_Particles[i]);
+                        m_InParallelParticleBatch[i] = true;
+                    }
+                }
+                // Apply the forces first so we know how fast each one will travel. Only the ones that can't knock loose even the weakest
+                // terrain pixel travel in parallel, penetration digs out terrain the others are reading. The rest travel in the loop below.
+                g_ThreadMan.ParallelFor(m_ParallelParticleBatch.size(), [this](int index) { m_ParallelParticleBatch[index]->ApplyForces(); });
+                float weakestStrength = g_SceneMan.GetWeakestMaterialStrength();
+                m_ParallelParticleBatch.erase(remove_if(m_ParallelParticleBatch.begin(), m_ParallelParticleBatch.end(), [weakestStrength](const MovableObject *pParticle) {
+                    return pParticle->GetVel().GetMagnitude() * pParticle->GetMass() * pParticle->GetSharpness() >= weakestStrength;
+                }), m_ParallelParticleBatch.end());
+
+                unsigned int frameSeed = m_SimUpdateFrameNumber * 2;
+                g_ThreadMan.ParallelFor(m_ParallelParticleBatch.size(), [this, frameSeed](int index) {
+                    MovableObject *pParticle = m_ParallelParticleBatch[index];
+                    // Seed per particle so the outcome doesn't depend on which thread got it
+                    SeedThreadLocalRand(frameSeed ^ (pParticle->GetUniqueID() * 2654435761u));
+                    pParticle->PreTravel();
+                    pParticle->Travel();
+                    pParticle->PostTravel();
+                    ClearThreadLocalRand();
+                });
+                g_ThreadMan.FlushDeferredCommands();
+            }
+
+            int particleIndex = 0;
+            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt, ++particleIndex)
             {
                 if (!((*parIt)->IsUpdated()))
                 {
-                    (*parIt)->ApplyForces();
+                    // The forces of the parallel candidates were already applied above, whether they traveled there or not
+                    if (!m_InParallelParticleBatch[particleIndex])
+                        (*parIt)->ApplyForces();
                     (*parIt)->PreTravel();
                     (*parIt)->Travel();
                     (*parIt)->PostTravel();
@@ -1769,6 +1929,9 @@ void MovableMan::Update()
 				//g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTORS_AI);
                 (*aIt)->ApplyImpulses();
             }
+
+            // Reveal what the Actors looked at with their visibility fans, all at once
+            g_SceneMan.UpdateVisibility();
         }
 		g_FrameMan.StopPerformanceMeasurement(FrameMan::PERF_ACTORS_PASS2);
 
@@ -1791,8 +1954,39 @@ void MovableMan::Update()
         // Particles
 		g_FrameMan.StartPerformanceMeasurement(FrameMan::PERF_PARTICLES_PASS2);
         {
-            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
+            m_InParallelParticleBatch.assign(m_Particles.size(), false);
+            if (m_ParallelParticlesEnabled)
+            {
+                m_ParallelParticleBatch.clear();
+                for (int i = 0; i < m_Particles.size(); ++i)
+                {
+                    if (m_Particles[i]->CanUpdateInParallel())
+                    {
+                        m_ParallelParticleBatch.push_back(m_Particles[i]);
+                        m_InParallelParticleBatch[i] = true;
+                    }
+                }
+                unsigned int frameSeed = m_SimUpdateFrameNumber * 2 + 1;
+                g_ThreadMan.ParallelFor(m_ParallelParticleBatch.size(), [this, frameSeed](int index) {
+                    MovableObject *pParticle = m_ParallelParticleBatch[index];
+                    SeedThreadLocalRand(frameSeed ^ (pParticle->GetUniqueID() * 2654435761u));
+                    // No UpdateScript, particles with scripts are never in the batch
+                    pParticle->Update();
+                    pParticle->ApplyImpulses();
+                    pParticle->RestDetection();
+                    if (pParticle->IsAtRest())
+                        pParticle->SetToSettle(true);
+                    ClearThreadLocalRand();
+                });
+                g_ThreadMan.FlushDeferredCommands();
+            }
+
+            int particleIndex = 0;
+            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt, ++particleIndex)
             {
+                if (m_InParallelParticleBatch[particleIndex])
+                    continue;
+
                 (*parIt)->Update();
                 (*parIt)->UpdateScript();
                 (*parIt)->ApplyImpulses();
@@ -1811,7 +2005,16 @@ void MovableMan::Update()
     ///////////////////////////////////////////////////
     // Clear the MOID layer before starting to delete stuff which may be in the MOIDIndex
 
-    g_SceneMan.ClearAllMOIDDrawings();
+    if (UsingIncrementalMOIDLayer())
+    {
+        // The layer is kept and only touched up once everything has settled, so make sure the stale IDs on it don't lead to anything deleted below
+        std::fill(m_MOIDIndex.begin(), m_MOIDIndex.end(), static_cast<MovableObject *>(0));
+    }
+    else
+    {
+        ClearMOIDFootprints();
+        g_SceneMan.ClearAllMOIDDrawings();
+    }
 //    g_SceneMan.MOIDClearCheck();
 
     ///////////////////////////////////////////////////
@@ -1891,6 +2094,9 @@ void MovableMan::Update()
 
                 // Add to the particles list
                 m_Particles.push_back(*aIt);
+                SetObjectCategory(*aIt, HELD_PARTICLE);
+                // Particles can be deleted before the grids are next updated, so don't leave it to be found by queries until then
+                m_ActorGrid.RemoveObject(*aIt);
                 // Remove from the team roster
 
                 if ((*aIt)->GetTeam() >= 0)
@@ -1917,6 +2123,8 @@ void MovableMan::Update()
 				// Disable TDExplosive's immunity to settling
 				if ((*iIt)->GetRestThreshold()< 0)
 					(*iIt)->SetRestThreshold(500);
+                SetObjectCategory(*iIt, HELD_PARTICLE);
+                m_ItemGrid.RemoveObject(*iIt);
                 m_Particles.push_back(*(iIt++));
             }
             m_Items.erase(imidIt, m_Items.end());
@@ -1945,6 +2153,8 @@ void MovableMan::Update()
                 //m_ActorRoster[(*aIt)->GetTeam()].remove(*aIt);
 				RemoveActorFromTeamRoster(*aIt);
 
+            // Take it out of the grid first, deleting it can run Lua that queries the grid
+            m_ActorGrid.RemoveObject(*aIt);
             // Delete
             delete *aIt;
             aIt++;
@@ -1958,7 +2168,10 @@ void MovableMan::Update()
         imidIt = iIt;
 
         while (iIt != m_Items.end())
+        {
+            m_ItemGrid.RemoveObject(*iIt);
             delete *(iIt++);
+        }
         m_Items.erase(imidIt, m_Items.end());
 
         // Particles
@@ -2008,6 +2221,10 @@ void MovableMan::Update()
 
     release_bitmap(g_SceneMan.GetTerrain()->GetMaterialBitmap());
 
+    // SPATIAL GRIDS //////////////////////////////////////////////////
+    // Everything that's going to be deleted this frame is gone now, so sort what's left into the grids for next frame's queries
+    UpdateSpatialGrids();
+
     ////////////////////////////////////////////////////////////////////////
     // Draw the MO matter and IDs to their layers for next frame
 
@@ -2114,9 +2331,7 @@ void MovableMan::VerifyMOIDIndex()
 
 void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
 {
-    int aCount = m_Actors.size();
-    int iCount = m_Items.size();
-    int parCount = m_Particles.size();
+    bool incremental = UsingIncrementalMOIDLayer();
 
     // Clear the index each frame and do it over because MO's get added and
     // deleted between each frame.
@@ -2124,43 +2339,373 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
     // Add a null and start counter at 1 because MOID == 0 means no MO.
     // - Update: This isnt' true anymore, but still keep 0 free just to be safe
     m_MOIDIndex.push_back(0);
+    m_MOIDDrawQueue.clear();
 
-    MOID currentMOID = 1;
-    int i = 0;
-
-    for (i = 0; i < aCount; ++i) {
-		if (m_Actors[i]->GetsHitByMOs() && !m_Actors[i]->IsSetToDelete())
+    // Give out the IDs first and queue up the roots to draw, so the incremental update can see what's changed before drawing anything
+    auto queueMOIDDraw = [this, incremental](MovableObject *pMO)
+    {
+        if (pMO->GetsHitByMOs() && !pMO->IsSetToDelete())
         {
-			Vector notUsed;
-            m_Actors[i]->UpdateMOID(m_MOIDIndex);
-            m_Actors[i]->Draw(pTargetBitmap, notUsed, g_DrawMOID, true);
-            currentMOID = m_MOIDIndex.size();
+            int firstMOID = m_MOIDIndex.size();
+            pMO->UpdateMOID(m_MOIDIndex);
+
+            MOIDDrawEntry entry;
+            entry.m_pRoot = pMO;
+            entry.m_DrawHash = 2166136261UL;
+            entry.m_pFootprint = 0;
+            entry.m_Changed = true;
+            // The root's children all got their IDs right after it, so they can be hashed together without going through the attachables again
+            if (incremental)
+            {
+                for (int id = firstMOID; id < m_MOIDIndex.size(); ++id)
+                {
+                    if (m_MOIDIndex[id])
+                        entry.m_DrawHash = (entry.m_DrawHash ^ m_MOIDIndex[id]->GetMOIDDrawHash()) * 16777619UL;
+                }
+            }
+            m_MOIDDrawQueue.push_back(entry);
         }
         else
-            m_Actors[i]->SetID(g_NoMOID);
+            pMO->SetID(g_NoMOID);
+    };
+
+    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+        queueMOIDDraw(*aIt);
+    for (deque<MovableObject *>::iterator iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt)
+        queueMOIDDraw(*iIt);
+    for (deque<MovableObject *>::iterator parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
+        queueMOIDDraw(*parIt);
+
+    if (incremental)
+    {
+        DrawMOIDsIncrementally(pTargetBitmap);
+
+        if (m_MOIDLayerValidationEnabled)
+            ValidateMOIDLayer(pTargetBitmap);
+    }
+    else
+    {
+        ClearMOIDFootprints();
+
+        for (vector<MOIDDrawEntry>::iterator eItr = m_MOIDDrawQueue.begin(); eItr != m_MOIDDrawQueue.end(); ++eItr)
+            eItr->m_pRoot->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
+        m_MOIDRedrawCount = m_MOIDDrawQueue.size();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UsingIncrementalMOIDLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the MOID layer can be updated incrementally right now.
+
+bool MovableMan::UsingIncrementalMOIDLayer() const
+{
+    return m_IncrementalMOIDLayerEnabled && !g_SettingsMan.PreciseCollisions();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawMOIDsIncrementally
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Brings the MOID layer up to date with the roots in the draw queue,
+//                  only erasing and redrawing what has changed since last update, and
+//                  whatever those changes have touched.
+
+void MovableMan::DrawMOIDsIncrementally(BITMAP *pTargetBitmap)
+{
+    // A new layer has none of the old footprints on it
+    if (pTargetBitmap != m_pMOIDFootprintBitmap)
+    {
+        m_MOIDFootprints.clear();
+        m_pMOIDFootprintBitmap = pTargetBitmap;
+    }
+
+    ResetDirtyMOIDTiles();
+    ++m_MOIDUpdateStamp;
+    m_MOIDRedrawCount = 0;
+
+    // Whatever got drawn outside of this since last update, like the overlap checks during travel, is cleared just like the full redraw would
+    g_SceneMan.TakeMOIDDrawings(m_StrayMOIDRects);
+    for (list<IntRect>::iterator rItr = m_StrayMOIDRects.begin(); rItr != m_StrayMOIDRects.end(); ++rItr)
+    {
+        g_SceneMan.ClearMOIDRect(rItr->m_Left, rItr->m_Top, rItr->m_Right, rItr->m_Bottom);
+        VisitDirtyMOIDTiles(*rItr, true);
     }
-    for (i = 0; i < iCount; ++i)
+    m_StrayMOIDRects.clear();
+
+    // Erase the roots that have changed since they were last drawn
+    for (vector<MOIDDrawEntry>::iterator eItr = m_MOIDDrawQueue.begin(); eItr != m_MOIDDrawQueue.end(); ++eItr)
+    {
+        pair<std::unordered_map<const MovableObject *, MOIDFootprint>::iterator, bool> inserted = m_MOIDFootprints.insert(make_pair(eItr->m_pRoot, MOIDFootprint()));
+        MOIDFootprint &footprint = inserted.first->second;
+        footprint.m_UpdateStamp = m_MOIDUpdateStamp;
+        eItr->m_pFootprint = &footprint;
+        // If a root got deleted and its address reused, the unique ID in the hash tells them apart
+        eItr->m_Changed = inserted.second || footprint.m_DrawHash != eItr->m_DrawHash;
+        if (eItr->m_Changed)
+            EraseMOIDFootprint(footprint);
+    }
+
+    // Erase the roots that aren't on the layer anymore at all
+    for (std::unordered_map<const MovableObject *, MOIDFootprint>::iterator fItr = m_MOIDFootprints.begin(); fItr != m_MOIDFootprints.end();)
     {
-        if (m_Items[i]->GetsHitByMOs() && !m_Items[i]->IsSetToDelete())
+        if (fItr->second.m_UpdateStamp != m_MOIDUpdateStamp)
         {
-            m_Items[i]->UpdateMOID(m_MOIDIndex);
-            m_Items[i]->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
-            currentMOID = m_MOIDIndex.size();
+            EraseMOIDFootprint(fItr->second);
+            fItr = m_MOIDFootprints.erase(fItr);
         }
         else
-            m_Items[i]->SetID(g_NoMOID);
+            ++fItr;
     }
-    for (i = 0; i < parCount; ++i)
+
+    // Draw in the same order as a full redraw so overlaps come out the same. Unchanged roots only need drawing if anything erased or drawn before them may have touched them
+    for (vector<MOIDDrawEntry>::iterator eItr = m_MOIDDrawQueue.begin(); eItr != m_MOIDDrawQueue.end(); ++eItr)
     {
-        if (m_Particles[i]->GetsHitByMOs() && !m_Particles[i]->IsSetToDelete())
+        MOIDFootprint &footprint = *(eItr->m_pFootprint);
+        if (!eItr->m_Changed)
         {
-            m_Particles[i]->UpdateMOID(m_MOIDIndex);
-            m_Particles[i]->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
-            currentMOID = m_MOIDIndex.size();
+            bool touched = false;
+            for (list<IntRect>::iterator rItr = footprint.m_Rects.begin(); rItr != footprint.m_Rects.end() && !touched; ++rItr)
+                touched = VisitDirtyMOIDTiles(*rItr, false);
+
+            if (!touched)
+                continue;
+            // Drawn right back where it was, so the same areas get registered again below
+            footprint.m_Rects.clear();
         }
-        else
-            m_Particles[i]->SetID(g_NoMOID);
+
+        eItr->m_pRoot->Draw(pTargetBitmap, Vector(), g_DrawMOID, true);
+        g_SceneMan.TakeMOIDDrawings(footprint.m_Rects);
+        for (list<IntRect>::iterator rItr = footprint.m_Rects.begin(); rItr != footprint.m_Rects.end(); ++rItr)
+            VisitDirtyMOIDTiles(*rItr, true);
+
+        footprint.m_DrawHash = eItr->m_DrawHash;
+        ++m_MOIDRedrawCount;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ValidateMOIDLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Redraws everything in the draw queue from scratch onto a separate
+//                  bitmap and compares it against the incrementally kept MOID layer,
+//                  reporting any differences and replacing the layer with the full redraw.
+
+int MovableMan::ValidateMOIDLayer(BITMAP *pTargetBitmap)
+{
+    if (!m_pMOIDValidationBitmap || m_pMOIDValidationBitmap->w != pTargetBitmap->w || m_pMOIDValidationBitmap->h != pTargetBitmap->h || bitmap_color_depth(m_pMOIDValidationBitmap) != bitmap_color_depth(pTargetBitmap))
+    {
+        destroy_bitmap(m_pMOIDValidationBitmap);
+        m_pMOIDValidationBitmap = create_bitmap_ex(bitmap_color_depth(pTargetBitmap), pTargetBitmap->w, pTargetBitmap->h);
+    }
+
+    // Exactly what the full redraw would have done on a freshly cleared layer
+    clear_to_color(m_pMOIDValidationBitmap, g_NoMOID);
+    for (vector<MOIDDrawEntry>::iterator eItr = m_MOIDDrawQueue.begin(); eItr != m_MOIDDrawQueue.end(); ++eItr)
+        eItr->m_pRoot->Draw(m_pMOIDValidationBitmap, Vector(), g_DrawMOID, true);
+    // None of that went onto the actual layer, and the footprints already cover the same areas
+    g_SceneMan.TakeMOIDDrawings(m_StrayMOIDRects);
+    m_StrayMOIDRects.clear();
+
+    int rowBytes = pTargetBitmap->w * ((bitmap_color_depth(pTargetBitmap) + 7) / 8);
+    int differingPixels = 0;
+    int firstX = 0;
+    int firstY = 0;
+    for (int y = 0; y < pTargetBitmap->h; ++y)
+    {
+        if (memcmp(pTargetBitmap->line[y], m_pMOIDValidationBitmap->line[y], rowBytes) == 0)
+            continue;
+
+        for (int x = 0; x < pTargetBitmap->w; ++x)
+        {
+            if (getpixel(pTargetBitmap, x, y) != getpixel(m_pMOIDValidationBitmap, x, y))
+            {
+                if (differingPixels == 0)
+                {
+                    firstX = x;
+                    firstY = y;
+                }
+                ++differingPixels;
+            }
+        }
+    }
+
+    if (differingPixels > 0)
+    {
+        char message[256];
+        sprintf_s(message, sizeof(message), "ERROR: Incremental MOID layer differed from a full redraw in %i pixels, first at (%i, %i)! Replacing it with the full redraw.", differingPixels, firstX, firstY);
+        g_ConsoleMan.PrintString(message);
+        blit(m_pMOIDValidationBitmap, pTargetBitmap, 0, 0, 0, 0, pTargetBitmap->w, pTargetBitmap->h);
     }
+
+    return differingPixels;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EraseMOIDFootprint
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the areas of a footprint off the MOID layer and marks
+//                  them as dirty for this incremental update.
+
+void MovableMan::EraseMOIDFootprint(MOIDFootprint &footprint)
+{
+    for (list<IntRect>::iterator rItr = footprint.m_Rects.begin(); rItr != footprint.m_Rects.end(); ++rItr)
+    {
+        g_SceneMan.ClearMOIDRect(rItr->m_Left, rItr->m_Top, rItr->m_Right, rItr->m_Bottom);
+        VisitDirtyMOIDTiles(*rItr, true);
+    }
+    footprint.m_Rects.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearMOIDFootprints
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the areas of all footprints off the MOID layer and forgets
+//                  about them, so the layer can go back to being fully redrawn.
+
+void MovableMan::ClearMOIDFootprints()
+{
+    if (m_MOIDFootprints.empty())
+        return;
+
+    // Only bother if the footprints are actually on the current layer
+    if (m_pMOIDFootprintBitmap == g_SceneMan.GetMOIDBitmap())
+    {
+        for (std::unordered_map<const MovableObject *, MOIDFootprint>::iterator fItr = m_MOIDFootprints.begin(); fItr != m_MOIDFootprints.end(); ++fItr)
+        {
+            for (list<IntRect>::iterator rItr = fItr->second.m_Rects.begin(); rItr != fItr->second.m_Rects.end(); ++rItr)
+                g_SceneMan.ClearMOIDRect(rItr->m_Left, rItr->m_Top, rItr->m_Right, rItr->m_Bottom);
+        }
+    }
+    m_MOIDFootprints.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseMOIDFootprints
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands all the areas of all footprints back to SceneMan's registered
+//                  MOID drawings, so they get cleared along with those, and forgets
+//                  about them.
+
+void MovableMan::ReleaseMOIDFootprints()
+{
+    for (std::unordered_map<const MovableObject *, MOIDFootprint>::iterator fItr = m_MOIDFootprints.begin(); fItr != m_MOIDFootprints.end(); ++fItr)
+    {
+        for (list<IntRect>::iterator rItr = fItr->second.m_Rects.begin(); rItr != fItr->second.m_Rects.end(); ++rItr)
+            g_SceneMan.RegisterMOIDDrawing(rItr->m_Left, rItr->m_Top, rItr->m_Right, rItr->m_Bottom);
+    }
+    m_MOIDFootprints.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResetDirtyMOIDTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks all the coarse tiles of the MOID layer as clean, resizing the
+//                  tile map to the current Scene if needed.
+
+void MovableMan::ResetDirtyMOIDTiles()
+{
+    m_DirtyMOIDTileCountX = (g_SceneMan.GetSceneWidth() + c_MOIDTileSize - 1) / c_MOIDTileSize;
+    m_DirtyMOIDTileCountY = (g_SceneMan.GetSceneHeight() + c_MOIDTileSize - 1) / c_MOIDTileSize;
+    m_DirtyMOIDTiles.assign(m_DirtyMOIDTileCountX * m_DirtyMOIDTileCountY, 0);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          VisitDirtyMOIDTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Goes through all the coarse tiles of the MOID layer that an area
+//                  touches, taking wrapping into account, and either marks them as dirty
+//                  or checks whether any of them are.
+
+bool MovableMan::VisitDirtyMOIDTiles(const IntRect &rect, bool markDirty)
+{
+    int xSpans[2][2];
+    int ySpans[2][2];
+    int xSpanCount = GetMOIDTileSpans(rect.m_Left, rect.m_Right, g_SceneMan.GetSceneWidth(), m_DirtyMOIDTileCountX, g_SceneMan.SceneWrapsX(), xSpans);
+    int ySpanCount = GetMOIDTileSpans(rect.m_Top, rect.m_Bottom, g_SceneMan.GetSceneHeight(), m_DirtyMOIDTileCountY, g_SceneMan.SceneWrapsY(), ySpans);
+
+    bool wasDirty = false;
+    for (int ySpan = 0; ySpan < ySpanCount; ++ySpan)
+    {
+        for (int y = ySpans[ySpan][0]; y <= ySpans[ySpan][1]; ++y)
+        {
+            unsigned char *pRow = &m_DirtyMOIDTiles[y * m_DirtyMOIDTileCountX];
+            for (int xSpan = 0; xSpan < xSpanCount; ++xSpan)
+            {
+                for (int x = xSpans[xSpan][0]; x <= xSpans[xSpan][1]; ++x)
+                {
+                    if (pRow[x])
+                    {
+                        if (!markDirty)
+                            return true;
+                        wasDirty = true;
+                    }
+                    else if (markDirty)
+                        pRow[x] = 1;
+                }
+            }
+        }
+    }
+    return wasDirty;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSpatialGrids
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Brings the Actor and Item grids up to date with the current positions
+//                  of everything in the Actor and Item lists.
+
+void MovableMan::UpdateSpatialGrids()
+{
+    int sceneWidth = g_SceneMan.GetSceneWidth();
+    int sceneHeight = g_SceneMan.GetSceneHeight();
+    if (sceneWidth <= 0 || sceneHeight <= 0)
+    {
+        m_ActorGrid.Reset();
+        m_ItemGrid.Reset();
+        return;
+    }
+
+    if (!SpatialGridsMatchScene())
+    {
+        m_ActorGrid.Create(sceneWidth, sceneHeight, g_SceneMan.SceneWrapsX(), g_SceneMan.SceneWrapsY());
+        m_ItemGrid.Create(sceneWidth, sceneHeight, g_SceneMan.SceneWrapsX(), g_SceneMan.SceneWrapsY());
+    }
+
+    // Only the objects that changed cells get moved, and anything no longer in the lists is dropped at the end
+    m_ActorGrid.StartUpdate();
+    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
+        m_ActorGrid.UpdateObject(*aIt);
+    m_ActorGrid.FinishUpdate();
+
+    m_ItemGrid.StartUpdate();
+    for (deque<MovableObject *>::iterator iIt = m_Items.begin(); iIt != m_Items.end(); ++iIt)
+        m_ItemGrid.UpdateObject(*iIt);
+    m_ItemGrid.FinishUpdate();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SpatialGridsMatchScene
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the Actor and Item grids were made for the current
+//                  Scene.
+
+bool MovableMan::SpatialGridsMatchScene() const
+{
+    int sceneWidth = g_SceneMan.GetSceneWidth();
+    int sceneHeight = g_SceneMan.GetSceneHeight();
+    bool wrapsX = g_SceneMan.SceneWrapsX();
+    bool wrapsY = g_SceneMan.SceneWrapsY();
+    return m_ActorGrid.MatchesArea(sceneWidth, sceneHeight, wrapsX, wrapsY) && m_ItemGrid.MatchesArea(sceneWidth, sceneHeight, wrapsX, wrapsY);
 }
 
 
@@ -2172,15 +2717,63 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
 
 void MovableMan::Draw(BITMAP *pTargetBitmap, const Vector &targetPos)
 {
+    // Anything entirely outside of the target's clipping rectangle wouldn't show up anyway, which is most of everything when the MO color layer is scoped to the views
+    IntRect clipRect;
+    get_clip_rect(pTargetBitmap, &clipRect.m_Left, &clipRect.m_Top, &clipRect.m_Right, &clipRect.m_Bottom);
+    bool cull = clipRect.m_Left > 0 || clipRect.m_Top > 0 || clipRect.m_Right < pTargetBitmap->w - 1 || clipRect.m_Bottom < pTargetBitmap->h - 1;
+
     // Draw objects to accumulation bitmap, in reverse order so actors appear on top.
     for (deque<MovableObject *>::iterator parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
-        (*parIt)->Draw(pTargetBitmap, targetPos);
+    {
+        if (!cull || IsInDrawArea(*parIt, clipRect, targetPos))
+            (*parIt)->Draw(pTargetBitmap, targetPos);
+    }
 
 	for (deque<MovableObject *>::reverse_iterator itmIt = m_Items.rbegin(); itmIt != m_Items.rend(); ++itmIt)
-        (*itmIt)->Draw(pTargetBitmap, targetPos);
+    {
+        if (!cull || IsInDrawArea(*itmIt, clipRect, targetPos))
+            (*itmIt)->Draw(pTargetBitmap, targetPos);
+    }
 
     for (deque<Actor *>::reverse_iterator aIt = m_Actors.rbegin(); aIt != m_Actors.rend(); ++aIt)
-        (*aIt)->Draw(pTargetBitmap, targetPos);
+    {
+        if (!cull || IsInDrawArea(*aIt, clipRect, targetPos))
+            (*aIt)->Draw(pTargetBitmap, targetPos);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsInDrawArea
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether any part of an MO could be drawn within an area of the
+//                  target bitmap, counting its copies across the Scene seams.
+
+bool MovableMan::IsInDrawArea(const MovableObject *pMO, const IntRect &area, const Vector &targetPos) const
+{
+    // The sprite radius doesn't count anything attached, like limbs and held devices, so leave plenty of room for those.
+    // Screen effects get registered when drawing and go on screen separately from this target, so anything whose effects could reach into it is drawn too
+    float reach = pMO->GetDiameter() + c_DrawCullPadding + pMO->GetScreenEffectReach();
+    Vector drawPos = pMO->GetPos() - targetPos;
+
+    int sceneWidth = g_SceneMan.GetSceneWidth();
+    int sceneHeight = g_SceneMan.GetSceneHeight();
+    int shiftCountX = g_SceneMan.SceneWrapsX() ? 3 : 1;
+    int shiftCountY = g_SceneMan.SceneWrapsY() ? 3 : 1;
+    const int shifts[3] = { 0, -1, 1 };
+    for (int shiftY = 0; shiftY < shiftCountY; ++shiftY)
+    {
+        float posY = drawPos.m_Y + shifts[shiftY] * sceneHeight;
+        if (posY + reach < area.m_Top || posY - reach > area.m_Bottom)
+            continue;
+        for (int shiftX = 0; shiftX < shiftCountX; ++shiftX)
+        {
+            float posX = drawPos.m_X + shifts[shiftX] * sceneWidth;
+            if (posX + reach >= area.m_Left && posX - reach <= area.m_Right)
+                return true;
+        }
+    }
+    return false;
 }
 
 
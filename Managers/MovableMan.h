@@ -25,6 +25,7 @@
 #include "LuaMan.h"
 #include "ActivityMan.h"
 #include "Vector.h"
+#include "SpatialPartitionGrid.h"
 //#include "MOPixel.h"
 //#include "AHuman.h"
 //#include "MovableObject.h"
@@ -42,6 +43,7 @@ class AHuman;
 //class AtomGroup;
 //class Atom;
 class SceneLayer;
+struct IntRect;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -129,7 +131,7 @@ public:
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -354,6 +356,53 @@ public:
     Actor * GetClosestActor(Vector &scenePoint, int maxRadius, float &getDistance, const Actor *pExcludeThis = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the Actors in the internal Actor list whose positions are
+//                  within a radius of a scene point.
+// Arguments:       The Scene point to search around.
+//                  The radius around that scene point to search.
+// Return value:    The Actors found. Ownership is NOT transferred!
+
+    std::vector<Actor *> GetActorsInRadius(const Vector &center, float radius);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the Actors in the internal Actor list whose positions are
+//                  inside a box on the scene. The box is wrapped if the scene wraps.
+// Arguments:       The Scene box to search within.
+// Return value:    The Actors found. Ownership is NOT transferred!
+
+    std::vector<Actor *> GetActorsInBox(const Box &box);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetItemsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the pickup-able items in the internal Item list whose
+//                  positions are within a radius of a scene point.
+// Arguments:       The Scene point to search around.
+//                  The radius around that scene point to search.
+// Return value:    The items found. Ownership is NOT transferred!
+
+    std::vector<MovableObject *> GetItemsInRadius(const Vector &center, float radius);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetItemsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gathers all the pickup-able items in the internal Item list whose
+//                  positions are inside a box on the scene. The box is wrapped if the
+//                  scene wraps.
+// Arguments:       The Scene box to search within.
+// Return value:    The items found. Ownership is NOT transferred!
+
+    std::vector<MovableObject *> GetItemsInBox(const Box &box);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetClosestBrainActor
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -441,6 +490,26 @@ public:
     long GetParticleCount() const { return m_Particles.size(); }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetActorCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of Actor:s currently held.
+// Arguments:       None.
+// Return value:    The number of actors.
+
+    long GetActorCount() const { return m_Actors.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetItemCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of items (HeldDevice:s etc) currently held.
+// Arguments:       None.
+// Return value:    The number of items.
+
+    long GetItemCount() const { return m_Items.size(); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetAGResolution
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -652,13 +721,13 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Indicates whether the passed in MovableObject pointer points to an
 //                  MO that's currently active in the simulation, and kept by this
-//                  MovableMan. Internal optimization is made so that the same MO can
-//                  efficiently be checked many times during the same frame.
+//                  MovableMan. The pointer is only looked up, never dereferenced, so it
+//                  can be safely called with pointers to deleted MOs.
 // Arguments:       A pointer to the MovableObject to check for being actively kept by
 //                  this MovableMan.
 // Return value:    Whether the MO instance was found in the active list or not.
 
-    bool ValidMO(const MovableObject *pMOToCheck);
+    bool ValidMO(const MovableObject *pMOToCheck) const { return GetObjectCategory(pMOToCheck) != NOT_HELD; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -669,7 +738,7 @@ public:
 // Arguments:       A pointer to the MovableObject to check for Actorness.
 // Return value:    Whether the object was found in the Actor list or not.
 
-    bool IsActor(const MovableObject *pMOToCheck);
+    bool IsActor(const MovableObject *pMOToCheck) const { return GetObjectCategory(pMOToCheck) == HELD_ACTOR; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -680,18 +749,18 @@ public:
 // Arguments:       A pointer to the MovableObject to check for Itemness.
 // Return value:    Whether the object was found in the Item list or not.
 
-    bool IsDevice(const MovableObject *pMOToCheck);
+    bool IsDevice(const MovableObject *pMOToCheck) const { return GetObjectCategory(pMOToCheck) == HELD_ITEM; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsParticle
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Indicates whether the passed in MovableObject is an active Item kept
-//                  by this MovableMan or not.                  
-// Arguments:       A pointer to the MovableObject to check for Itemness.
+// Description:     Indicates whether the passed in MovableObject is an active particle
+//                  kept by this MovableMan or not.
+// Arguments:       A pointer to the MovableObject to check for Particleness.
 // Return value:    Whether the object was found in the Particle list or not.
 
-    bool IsParticle(const MovableObject *pMOToCheck);
+    bool IsParticle(const MovableObject *pMOToCheck) const { return GetObjectCategory(pMOToCheck) == HELD_PARTICLE; }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -865,6 +934,117 @@ public:
     bool IsMOSubtractionEnabled() { return m_MOSubtractionEnabled; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsParallelParticlesEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether particles that don't interact with other MO's are
+//                  travelled and updated across all of ThreadMan's threads.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsParallelParticlesEnabled() const { return m_ParallelParticlesEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableParallelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether particles that don't interact with other MO's are
+//                  travelled and updated across all of ThreadMan's threads.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableParallelParticles(bool enable = true) { m_ParallelParticlesEnabled = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsIncrementalMOIDLayerEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the MOID layer is kept up to date incrementally, only
+//                  erasing and redrawing the MO's that have changed since last update.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsIncrementalMOIDLayerEnabled() const { return m_IncrementalMOIDLayerEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableIncrementalMOIDLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether the MOID layer is kept up to date incrementally, only
+//                  erasing and redrawing the MO's that have changed since last update.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableIncrementalMOIDLayer(bool enable = true) { m_IncrementalMOIDLayerEnabled = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsViewportMOColorLayerEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the MO color layer is only cleared and drawn on around
+//                  what the screens are showing, instead of all over the Scene.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsViewportMOColorLayerEnabled() const { return m_ViewportMOColorLayerEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableViewportMOColorLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether the MO color layer is only cleared and drawn on around
+//                  what the screens are showing, instead of all over the Scene.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableViewportMOColorLayer(bool enable = true) { m_ViewportMOColorLayerEnabled = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsMOIDLayerValidationEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether each incremental MOID layer update is checked against
+//                  a full redraw, reporting and fixing any differences. Slow, for
+//                  debugging only.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsMOIDLayerValidationEnabled() const { return m_MOIDLayerValidationEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableMOIDLayerValidation
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether each incremental MOID layer update is checked against
+//                  a full redraw, reporting and fixing any differences. Slow, for
+//                  debugging only.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableMOIDLayerValidation(bool enable = true) { m_MOIDLayerValidationEnabled = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOIDRedrawCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many root MO's had to be drawn onto the MOID layer during
+//                  the last update. Without the incremental MOID layer, that's all of them.
+// Arguments:       None.
+// Return value:    The number of root MO's drawn onto the MOID layer last update.
+
+    int GetMOIDRedrawCount() const { return m_MOIDRedrawCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOIDDrawCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets how many root MO's are on the MOID layer after the last update.
+// Arguments:       None.
+// Return value:    The number of root MO's on the MOID layer.
+
+    int GetMOIDDrawCount() const { return m_MOIDDrawQueue.size(); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RedrawOverlappingMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -986,7 +1166,29 @@ public:
 // Arguments:       Unique Id to look for.
 // Return value:    Object found or 0 if not found any.
 
-	MovableObject * FindObjectByUniqueID(long int id) { if (m_KnownObjects.count(id) > 0) return m_KnownObjects[id]; else return 0; }
+	MovableObject * FindObjectByUniqueID(long int id) const { std::unordered_map<long int, MovableObject *>::const_iterator itr = m_KnownObjects.find(id); return itr != m_KnownObjects.end() ? itr->second : 0; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetObjectHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a handle to a registered object, which can be held on to instead
+//                  of a pointer. Once the object is deleted the handle no longer leads to
+//                  anything, even if another object is made in the same place.
+// Arguments:       The object to get the handle of.
+// Return value:    The handle of the object, or 0 if it isn't registered.
+
+	unsigned int GetObjectHandle(const MovableObject *pMO) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetObjectFromHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the object a handle from GetObjectHandle leads to.
+// Arguments:       The handle of the object.
+// Return value:    The object, or 0 if it has been deleted since the handle was gotten.
+
+	MovableObject * GetObjectFromHandle(unsigned int handle) const;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1038,11 +1240,6 @@ protected:
 	// Every team's MO footprint
 	int m_TeamMOIDCount[Activity::MAXTEAMCOUNT];
 
-    // Optimization implementation
-    // MO's that have already been asked whether they exist in the manager this frame, and the search result.
-    // Gets cleaned out each frame. Does NOT own any instances.
-    std::deque<std::pair<const MovableObject *, bool> > m_ValiditySearchResults;
-
     // The alarm events on the scene where something alarming happened, for use with AI firings awareness os they react to shots fired etc.
     // This is the last frame's events, is the one for Actors to poll for events, should be cleaned out and refilled each frame.
     std::list<AlarmEvent> m_AlarmEvents;
@@ -1071,6 +1268,68 @@ protected:
     bool m_SettlingEnabled;
     // Whtehr MO's vcanng et subtracted form the terrain at all
     bool m_MOSubtractionEnabled;
+    // Whether particles that can be are travelled and updated in parallel
+    bool m_ParallelParticlesEnabled;
+    // The particles picked out for the current parallel pass. Does NOT own any instances.
+    std::vector<MovableObject *> m_ParallelParticleBatch;
+    // Which of m_Particles, by index, were picked for the current parallel pass, including those sent back to the serial loop after their forces were applied
+    std::vector<bool> m_InParallelParticleBatch;
+
+    // Grids of the positions of all Actors and Items, for proximity queries that don't have to go through every one of them.
+    // Brought up to date at the end of each Update. Do NOT own any instances.
+    SpatialPartitionGrid m_ActorGrid;
+    SpatialPartitionGrid m_ItemGrid;
+
+    // What a root MO and all its children drew onto the MOID layer the last time it was drawn there, kept around by the incremental MOID layer
+    struct MOIDFootprint
+    {
+        // The combined MOID draw hash of the root and all its children when they were last drawn
+        unsigned long m_DrawHash;
+        // The areas of the MOID layer that were registered when they were last drawn
+        std::list<IntRect> m_Rects;
+        // The MOID layer update the root was last seen in
+        unsigned int m_UpdateStamp;
+    };
+
+    // A root MO to be drawn onto the MOID layer this update
+    struct MOIDDrawEntry
+    {
+        // The root MO. Not owned
+        MovableObject *m_pRoot;
+        // The combined MOID draw hash of the root and all its children as of this update
+        unsigned long m_DrawHash;
+        // What the root drew last time, if it's being drawn incrementally. Not owned
+        MOIDFootprint *m_pFootprint;
+        // Whether the root has changed and so definitely has to be redrawn
+        bool m_Changed;
+    };
+
+    // Whether the MOID layer is kept up to date incrementally instead of being cleared and redrawn completely each update
+    bool m_IncrementalMOIDLayerEnabled;
+    // Whether the incremental MOID layer is checked against a full redraw each update
+    bool m_MOIDLayerValidationEnabled;
+    // Whether the MO color layer is only cleared and drawn on around the screens' views
+    bool m_ViewportMOColorLayerEnabled;
+    // How far beyond its diameter an MO is assumed to reach when culling it from drawing, to cover what's attached to it
+    static const int c_DrawCullPadding = 64;
+    // The roots that are on the MOID layer this update, in the order they're drawn. Does NOT own any instances.
+    std::vector<MOIDDrawEntry> m_MOIDDrawQueue;
+    // What every root currently on the MOID layer drew there, when it's kept incrementally. Keys are never dereferenced, only compared
+    std::unordered_map<const MovableObject *, MOIDFootprint> m_MOIDFootprints;
+    // The current incremental MOID layer update, for noticing which footprints' roots are gone
+    unsigned int m_MOIDUpdateStamp;
+    // The MOID layer bitmap the footprints were drawn onto, to notice when it gets replaced. Not owned
+    BITMAP *m_pMOIDFootprintBitmap;
+    // Which coarse tiles of the MOID layer have been erased or drawn on during the current incremental update
+    std::vector<unsigned char> m_DirtyMOIDTiles;
+    int m_DirtyMOIDTileCountX;
+    int m_DirtyMOIDTileCountY;
+    // Scratch list of the MOID layer areas drawn outside of the MOID update itself
+    std::list<IntRect> m_StrayMOIDRects;
+    // Scratch bitmap for the full redraw the incremental MOID layer is validated against. Owned
+    BITMAP *m_pMOIDValidationBitmap;
+    // How many roots were drawn onto the MOID layer during the last update
+    int m_MOIDRedrawCount;
 
 	unsigned int m_SimUpdateFrameNumber;
 
@@ -1079,7 +1338,74 @@ protected:
     Entity *m_pObjectToScriptUpdate;
 
 	// Global map which stores all objects so they could be foud by their unique ID
-	std::map<long int, MovableObject *> m_KnownObjects;
+	std::unordered_map<long int, MovableObject *> m_KnownObjects;
+
+    // Which of the lists of this MovableMan a registered object is in
+    enum ObjectCategory
+    {
+        NOT_HELD = 0,
+        HELD_ACTOR,
+        HELD_ITEM,
+        HELD_PARTICLE
+    };
+
+    // A slot of the object table, which every registered object has one of
+    struct ObjectSlot
+    {
+        // The object in this slot, 0 if the slot is free. Not owned
+        MovableObject *m_pObject;
+        // Bumped every time the slot is freed, so handles to objects that used to be in it stop working
+        unsigned int m_Generation;
+        // Which list the object is in, either the regular or the added this frame one
+        ObjectCategory m_Category;
+    };
+
+    // How many of the low bits of an object handle are the slot index, the rest are the generation
+    static const int c_ObjectHandleSlotBits = 20;
+
+    // All the slots of the object table
+    std::vector<ObjectSlot> m_ObjectSlots;
+    // The indices of the free slots of the object table, to be reused before adding more. Reused oldest first, so each slot goes as long as possible between generations
+    std::deque<unsigned int> m_FreeObjectSlots;
+    // The slot of each registered object. Looked up by pointer only, so pointers to deleted objects can be checked safely
+    std::unordered_map<const MovableObject *, unsigned int> m_ObjectSlotsByPointer;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetObjectCategory
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets which of the lists of this MovableMan an object is in.
+// Arguments:       The object to look up. Doesn't have to point to anything that exists.
+// Return value:    Which list the object is in, NOT_HELD if none or it isn't registered.
+
+    ObjectCategory GetObjectCategory(const MovableObject *pMO) const
+    {
+        std::unordered_map<const MovableObject *, unsigned int>::const_iterator itr = m_ObjectSlotsByPointer.find(pMO);
+        return itr != m_ObjectSlotsByPointer.end() ? m_ObjectSlots[itr->second].m_Category : NOT_HELD;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetObjectCategory
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records which of the lists of this MovableMan an object was put in or
+//                  taken out of. Registers the object if it isn't already.
+// Arguments:       The object that was moved.
+//                  Which list it's in now.
+// Return value:    None.
+
+    void SetObjectCategory(MovableObject *pMO, ObjectCategory category);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseAllObjectCategories
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Records that no objects are in any of the lists of this MovableMan
+//                  anymore, for when the lists are all cleared at once.
+// Arguments:       None.
+// Return value:    None.
+
+    void ReleaseAllObjectCategories();
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1098,6 +1424,137 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSpatialGrids
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Brings the Actor and Item grids up to date with the current positions
+//                  of everything in the Actor and Item lists, recreating the grids first
+//                  if the Scene has changed.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateSpatialGrids();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SpatialGridsMatchScene
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the Actor and Item grids were made for the current
+//                  Scene. If not, they need updating before they can be queried.
+// Arguments:       None.
+// Return value:    Whether the grids cover the current Scene.
+
+    bool SpatialGridsMatchScene() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UsingIncrementalMOIDLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the MOID layer can be updated incrementally right now.
+//                  Precise collisions draw and erase MOIDs mid-update without registering
+//                  what they touch, so they always need the full clear and redraw.
+// Arguments:       None.
+// Return value:    Whether to update the MOID layer incrementally.
+
+    bool UsingIncrementalMOIDLayer() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsInDrawArea
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether any part of an MO could be drawn within an area of the
+//                  target bitmap, counting its copies across the Scene seams. Errs on the
+//                  side of yes.
+// Arguments:       The MO to check.
+//                  The area of the target bitmap, with all edges inclusive.
+//                  The absolute position of the target bitmap's upper left corner in the scene.
+// Return value:    Whether the MO may show up within the area when drawn.
+
+    bool IsInDrawArea(const MovableObject *pMO, const IntRect &area, const Vector &targetPos) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawMOIDsIncrementally
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Brings the MOID layer up to date with the roots in the draw queue,
+//                  only erasing and redrawing what has changed since last update, and
+//                  whatever those changes have touched.
+// Arguments:       The MOID layer bitmap to draw on.
+// Return value:    None.
+
+    void DrawMOIDsIncrementally(BITMAP *pTargetBitmap);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ValidateMOIDLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Redraws everything in the draw queue from scratch onto a separate
+//                  bitmap and compares it against the incrementally kept MOID layer,
+//                  reporting any differences and replacing the layer with the full redraw.
+// Arguments:       The MOID layer bitmap to validate.
+// Return value:    The number of pixels that differed.
+
+    int ValidateMOIDLayer(BITMAP *pTargetBitmap);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EraseMOIDFootprint
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the areas of a footprint off the MOID layer and marks
+//                  them as dirty for this incremental update.
+// Arguments:       The footprint to erase. Its list of areas is emptied.
+// Return value:    None.
+
+    void EraseMOIDFootprint(MOIDFootprint &footprint);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ClearMOIDFootprints
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the areas of all footprints off the MOID layer and forgets
+//                  about them, so the layer can go back to being fully redrawn.
+// Arguments:       None.
+// Return value:    None.
+
+    void ClearMOIDFootprints();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ReleaseMOIDFootprints
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands all the areas of all footprints back to SceneMan's registered
+//                  MOID drawings, so they get cleared along with those, and forgets
+//                  about them. For when the layer can't be touched right now.
+// Arguments:       None.
+// Return value:    None.
+
+    void ReleaseMOIDFootprints();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ResetDirtyMOIDTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks all the coarse tiles of the MOID layer as clean, resizing the
+//                  tile map to the current Scene if needed.
+// Arguments:       None.
+// Return value:    None.
+
+    void ResetDirtyMOIDTiles();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          VisitDirtyMOIDTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Goes through all the coarse tiles of the MOID layer that an area
+//                  touches, taking wrapping into account the same way ClearMOIDRect does,
+//                  and either marks them as dirty or checks whether any of them are.
+// Arguments:       The area of the MOID layer, in scene coordinates.
+//                  Whether to mark the tiles dirty, or just check them.
+// Return value:    Whether any of the tiles were dirty before this.
+
+    bool VisitDirtyMOIDTiles(const IntRect &rect, bool markDirty);
+
+
     // Disallow the use of some implicit methods.
     MovableMan(const MovableMan &reference);
     MovableMan & operator=(const MovableMan &rhs);
@@ -62,6 +62,10 @@ namespace RTE
 			m_TargetPos[f].Reset();
 		m_CurrentSceneLayerReceived = -1;
 		m_CurrentFrame = 0;
+		m_FrameSequence = 0;
+		m_FrameIsKeyframe = false;
+		m_FrameBoxesReceived = 0;
+		m_DeltaConsistent = false;
 		m_UseNATPunchThroughService = false;
 		m_ServerGuid = RakNet::UNASSIGNED_RAKNET_GUID;
 
@@ -251,6 +255,15 @@ namespace RTE
 	}
 
 
+	void NetworkClient::SendFrameAckMsg(unsigned int frameSequence)
+	{
+		RTE::MsgFrameAck msg;
+		msg.Id = ID_CLT_FRAME_ACK;
+		msg.FrameSequence = frameSequence;
+
+		m_Client->Send((const char *)&msg, sizeof(RTE::MsgFrameAck), HIGH_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ServerID, false);
+	}
+
 	void NetworkClient::SendInputMsg()
 	{
 		MsgInput msg;
@@ -361,41 +374,27 @@ namespace RTE
 		//sprintf_s(buf, sizeof(buf), "+ %d %d %d %d", frameData->X, frameData->Y, frameData->W, frameData->H);
 		//g_ConsoleMan.PrintString(buf);
 
-		if (frameData->W == 1 && frameData->H == 1)
-		{
-			BITMAP * bmp = 0;
-
-			if (frameData->Back)
-				bmp = m_pSceneBackgroundBitmap;
-			else
-				bmp = m_pSceneForegroundBitmap;
+		int size = frameData->UncompressedSize;
 
-			putpixel(bmp, frameData->X, frameData->Y, frameData->Color);
-		}
+		if (frameData->DataSize == frameData->UncompressedSize)
+			memcpy_s(m_aPixelLineBuffer, size, p->data + sizeof(MsgTerrainChange), size);
 		else
-		{
-			int size = frameData->UncompressedSize;
+			LZ4_decompress_safe((char *)(p->data + sizeof(MsgTerrainChange)), (char *)m_aPixelLineBuffer, frameData->DataSize, size);
 
-			if (frameData->DataSize == frameData->UncompressedSize)
-				memcpy_s(m_aPixelLineBuffer, size, p->data + sizeof(MsgTerrainChange), size);
-			else
-				LZ4_decompress_safe((char *)(p->data + sizeof(MsgTerrainChange)), (char *)m_aPixelLineBuffer, frameData->DataSize, size);
-
-			// Copy bitmap data to scene bitmap
-			BITMAP * bmp = 0;
+		// Copy bitmap data to scene bitmap
+		BITMAP * bmp = 0;
 
-			if (frameData->Back)
-				bmp = m_pSceneBackgroundBitmap;
-			else
-				bmp = m_pSceneForegroundBitmap;
+		if (frameData->Back)
+			bmp = m_pSceneBackgroundBitmap;
+		else
+			bmp = m_pSceneForegroundBitmap;
 
-			unsigned char * src = m_aPixelLineBuffer;
+		unsigned char * src = m_aPixelLineBuffer;
 
-			for (int y = 0; y < frameData->H && frameData->Y + y < bmp->h; y++)
-			{
-				memcpy(bmp->line[frameData->Y + y] + frameData->X, src, frameData->W);
-				src += frameData->W;
-			}
+		for (int y = 0; y < frameData->H && frameData->Y + y < bmp->h; y++)
+		{
+			memcpy(bmp->line[frameData->Y + y] + frameData->X, src, frameData->W);
+			src += frameData->W;
 		}
 	}
 
@@ -858,6 +857,9 @@ namespace RTE
 
 		m_CurrentSceneLayerReceived = -1;
 
+		if (frameData->FrameNumber == m_CurrentFrame)
+			m_FrameBoxesReceived++;
+
 		// Looks like we've started receiving a new frame, time to draw current frame then
 		//if (lineNumber < m_LastLineReceived/* && frameData->Layer == 1*/)
 		/*if (m_CurrentFrame != frameData->FrameNumber)
@@ -903,12 +905,26 @@ namespace RTE
 				else
 					LZ4_decompress_safe((char *)(p->data + sizeof(MsgFrameBox)), (char *)(m_aPixelLineBuffer), size, frameData->UncompressedSize);
 
-				// Copy box to bitmap line by line
 				unsigned char * lineAddr = m_aPixelLineBuffer;
-				for (int y = 0; y < maxHeight; y++)
+				if (frameData->Id == ID_SRV_FRAME_BOX_DELTA)
+				{
+					// Delta boxes hold the difference to what we already have, apply it line by line
+					for (int y = 0; y < maxHeight; y++)
+					{
+						unsigned char * pDest = bmp->line[bpy + y] + bpx;
+						for (int x = 0; x < maxWidth; x++)
+							pDest[x] ^= lineAddr[x];
+						lineAddr += maxWidth;
+					}
+				}
+				else
 				{
-					memcpy_s(bmp->line[bpy + y] + bpx, maxWidth, lineAddr, maxWidth);
-					lineAddr += maxWidth;
+					// Copy box to bitmap line by line
+					for (int y = 0; y < maxHeight; y++)
+					{
+						memcpy_s(bmp->line[bpy + y] + bpx, maxWidth, lineAddr, maxWidth);
+						lineAddr += maxWidth;
+					}
 				}
 
 				if (g_UInputMan.KeyHeld(KEY_0))
@@ -992,6 +1008,20 @@ namespace RTE
 
 		DrawFrame();
 
+		// Only once a whole keyframe made it through can we trust our picture, and any box lost after that means we can't anymore
+		if (m_FrameBoxesReceived != frameData->PreviousFrameBoxCount)
+			m_DeltaConsistent = false;
+		else if (m_FrameIsKeyframe)
+			m_DeltaConsistent = true;
+
+		// Let the server know it can keep sending deltas, otherwise it will send a keyframe after a while
+		if (m_DeltaConsistent)
+			SendFrameAckMsg(m_FrameSequence);
+
+		m_FrameSequence = frameData->FrameSequence;
+		m_FrameIsKeyframe = frameData->Keyframe;
+		m_FrameBoxesReceived = 0;
+
 		m_PostEffects[m_CurrentFrame].clear();
 		m_CurrentFrame = frameData->FrameNumber;
 
@@ -1010,6 +1040,9 @@ namespace RTE
 		clear_to_color(g_FrameMan.GetNetworkBackBufferIntermediateGUI8Ready(0), g_KeyColor);
 		clear_to_color(g_FrameMan.GetNetworkBackBufferGUI8Ready(0), g_KeyColor);
 
+		// Just wiped the GUI layer, so wait for the next keyframe before acking anything
+		m_DeltaConsistent = false;
+
 		RTE::MsgSceneSetup * frameData = (RTE::MsgSceneSetup *)p->data;
 
 		m_SceneId = frameData->SceneId;
@@ -1209,6 +1242,7 @@ namespace RTE
 				break;
 
 			case ID_SRV_FRAME_BOX:
+			case ID_SRV_FRAME_BOX_DELTA:
 				ReceiveFrameBoxMsg(p);
 				break;
 
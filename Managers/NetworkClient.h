@@ -183,6 +183,8 @@ namespace RTE
 
 		void SendInputMsg();
 
+		void SendFrameAckMsg(unsigned int frameSequence);
+
 		void ReceiveFrameSetupMsg(RakNet::Packet * p);
 
 		void ReceiveFrameLineMsg(RakNet::Packet * p);
@@ -246,6 +248,14 @@ namespace RTE
 
 		int m_CurrentFrame;
 
+		// Sequence number of the frame currently being received and whether the server sent it in full
+		unsigned int m_FrameSequence;
+		bool m_FrameIsKeyframe;
+		// How many boxes of the current frame have arrived so far
+		unsigned short int m_FrameBoxesReceived;
+		// Whether every box since the last keyframe arrived, meaning our picture matches what the server bases its deltas on
+		bool m_DeltaConsistent;
+
 		Vector m_TargetPos[FRAMES_TO_REMEMBER];
 		std::list<PostEffect> m_PostEffects[FRAMES_TO_REMEMBER];
 
@@ -21,6 +21,8 @@ namespace RTE
 		ID_SRV_FRAME_SETUP,
 		ID_SRV_FRAME_LINE,
 		ID_SRV_FRAME_BOX,
+		ID_SRV_FRAME_BOX_DELTA,
+		ID_CLT_FRAME_ACK,
 		ID_SRV_SCENE_SETUP,
 		ID_CLT_SCENE_SETUP_ACCEPTED,
 		ID_SRV_SCENE,
@@ -88,6 +90,13 @@ namespace RTE
 
 		float OffsetX[MAX_BACKGROUND_LAYERS_TRANSMITTED];
 		float OffsetY[MAX_BACKGROUND_LAYERS_TRANSMITTED];
+
+		// Keeps counting up unlike FrameNumber, so the client can acknowledge complete frames
+		unsigned int FrameSequence;
+		// Whether every box of this frame is sent in full, so the client can resync its delta reference
+		bool Keyframe;
+		// How many box messages were sent for the previous frame, so the client can tell if any were lost
+		unsigned short int PreviousFrameBoxCount;
 	};
 
 	struct MsgFrameLine
@@ -115,6 +124,14 @@ namespace RTE
 		unsigned short int UncompressedSize;
 	};
 
+	// ID_SRV_FRAME_BOX_DELTA uses MsgFrameBox as well, but its data is XORed with what was last sent for that box
+	struct MsgFrameAck
+	{
+		unsigned char Id;
+
+		unsigned int FrameSequence;
+	};
+
 	struct MsgDisconnect
 	{
 		unsigned char Id;
@@ -194,7 +211,6 @@ namespace RTE
 		unsigned short int W;
 		unsigned short int H;
 		bool Back;
-		unsigned char Color;
 		unsigned char SceneId;
 		unsigned short int DataSize;
 		unsigned short int UncompressedSize;
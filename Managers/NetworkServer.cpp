@@ -13,6 +13,7 @@
 // Inclusions of header files
 #include "ConsoleMan.h"
 #include "SettingsMan.h"
+#include "ProfilerMan.h"
 #include "GUI/GUIInput.h"
 
 #include "NetworkClient.h"
@@ -43,8 +44,33 @@ namespace RTE
 {
 	const std::string NetworkServer::m_ClassName = "NetworkServer";
 
+	// Hashes a box worth of pixels 8 at a time, to tell whether it changed since it was last sent
+	static unsigned long long HashBoxData(const unsigned char * pData, int size)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		int counter = 0;
+		for (; counter + (int)sizeof(unsigned long long) <= size; counter += sizeof(unsigned long long))
+		{
+			unsigned long long chunk;
+			memcpy(&chunk, pData + counter, sizeof(unsigned long long));
+			hash = (hash ^ chunk) * 1099511628211ULL;
+			hash ^= hash >> 29;
+		}
+		for (; counter < size; counter++)
+			hash = (hash ^ pData[counter]) * 1099511628211ULL;
+
+		return hash;
+	}
+
+	void BackgroundEncodeThreadFunction(NetworkServer * ns, int contextIndex)
+	{
+		g_ProfilerMan.SetThreadName("Frame Encoder " + std::to_string(contextIndex));
+		ns->EncodeFrameBoxRows(contextIndex);
+	}
+
 	void BackgroundSendThreadFunction(NetworkServer * ns, int player)
 	{
+		g_ProfilerMan.SetThreadName("Send Player " + std::to_string(player));
 		while (ns->IsServerModeEnabled() && ns->IsPlayerConnected(player))
 		{
 			if (ns->NeedToSendSceneSetupData(player) && ns->IsSceneAvailable(player))
@@ -99,6 +125,10 @@ namespace RTE
 		{
 			m_pBackBuffer8[i] = 0;
 			m_pBackBufferGUI8[i] = 0;
+			m_pDeltaReference8[i] = 0;
+			m_pDeltaReferenceGUI8[i] = 0;
+			m_BoxHashes[i][0].clear();
+			m_BoxHashes[i][1].clear();
 
 			m_LastFrameSentTime[i] = 0;
 			m_LastStatResetTime[i] = 0;
@@ -106,6 +136,16 @@ namespace RTE
 			m_DelayedFrames[i] = 0;
 			m_MsecPerFrame[i] = 0;
 			m_MsecPerSendCall[i] = 0;
+			m_UsecFrameEncode[i] = 0;
+			m_UsecFrameSend[i] = 0;
+			m_UsecFrameAux[i] = 0;
+
+			m_EncodedRows[i].clear();
+			m_NextEncodeRow[i] = 0;
+			m_EncodeRowCount[i] = 0;
+			m_EncodeRowsLeft[i] = 0;
+			m_EncodeUseDelta[i] = false;
+			m_EncodeSendDelta[i] = false;
 
 			m_pLZ4CompressionState[i] = 0;
 			m_pLZ4FastCompressionState[i] = 0;
@@ -132,6 +172,13 @@ namespace RTE
 			m_ResetActivityVotes[i] = false;
 
 			m_FrameNumbers[i] = 0;
+			m_FrameSequence[i] = 0;
+			m_LastKeyframe[i] = 0;
+			m_LastAckedFrame[i] = 0;
+			m_KeyframeRequested[i] = true;
+			m_SendKeyframe[i] = true;
+			m_FrameBoxesSent[i] = 0;
+			m_PreviousFrameBoxesSent[i] = 0;
 
 			m_Ping[i] = 0;
 			m_PingTimer[i].Reset();
@@ -152,6 +199,8 @@ namespace RTE
 				m_PostEffectDataSentCurrent[i][j] = 0;
 				m_SoundDataSentCurrent[i][j] = 0;
 				m_TerrainDataSentCurrent[i][j] = 0;
+				m_TerrainTilesSentCurrent[i][j] = 0;
+				m_TerrainTileDataSentCurrent[i][j] = 0;
 				m_OtherDataSentCurrent[i][j] = 0;
 			}
 
@@ -168,6 +217,9 @@ namespace RTE
 
 			m_EmptyBlocks[i] = 0;
 			m_FullBlocks[i] = 0;
+			m_DeltaBlocks[i] = 0;
+			m_UnchangedBlocks[i] = 0;
+			m_KeyframesSent[i] = 0;
 		}
 
 		m_UseHighCompression = true;
@@ -175,6 +227,9 @@ namespace RTE
 		m_HighCompressionLevel = LZ4HC_CLEVEL_OPT_MIN;
 		m_FastAccelerationFactor = 1;
 		m_UseInterlacing = false;
+		m_UseDeltaCompression = true;
+		m_KeyframeInterval = 60;
+		m_StopEncodeThreads = false;
 		m_EncodingFps = 30;
 		m_ShowInput = false;
 		m_ShowStats = false;
@@ -183,6 +238,11 @@ namespace RTE
 		m_BoxHeight = 44;
 		m_NatServerConnected = false;
 		m_LastPackedReceived.Reset();
+		m_ChangedTerrainTileLayers.clear();
+		m_ChangedTerrainTiles.clear();
+		m_TerrainTileCountX = 0;
+		m_TerrainTileCountY = 0;
+		m_TerrainTilesPerFrame = 0;
 	}
 
 	//////////////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +272,8 @@ namespace RTE
 		m_HighCompressionLevel = g_SettingsMan.GetServerHighCompressionLevel();
 		m_FastAccelerationFactor = g_SettingsMan.GetServerFastAccelerationFactor();
 		m_UseInterlacing = g_SettingsMan.GetServerUseInterlacing();
+		m_UseDeltaCompression = g_SettingsMan.GetServerUseDeltaCompression();
+		m_KeyframeInterval = g_SettingsMan.GetServerKeyframeInterval();
 		m_EncodingFps = g_SettingsMan.GetServerEncodingFps();
 
 		m_TransmitAsBoxes = g_SettingsMan.GetServerTransmitAsBoxes();
@@ -235,6 +297,8 @@ namespace RTE
 			m_PostEffectDataSentCurrent[player][STAT_SHOWN] = m_PostEffectDataSentCurrent[player][STAT_CURRENT];
 			m_SoundDataSentCurrent[player][STAT_SHOWN] = m_SoundDataSentCurrent[player][STAT_CURRENT];
 			m_TerrainDataSentCurrent[player][STAT_SHOWN] = m_TerrainDataSentCurrent[player][STAT_CURRENT];
+			m_TerrainTilesSentCurrent[player][STAT_SHOWN] = m_TerrainTilesSentCurrent[player][STAT_CURRENT];
+			m_TerrainTileDataSentCurrent[player][STAT_SHOWN] = m_TerrainTileDataSentCurrent[player][STAT_CURRENT];
 			m_OtherDataSentCurrent[player][STAT_SHOWN] = m_OtherDataSentCurrent[player][STAT_CURRENT];
 
 			m_DataUncompressedCurrent[player][STAT_CURRENT] = 0;
@@ -243,6 +307,8 @@ namespace RTE
 			m_PostEffectDataSentCurrent[player][STAT_CURRENT] = 0;
 			m_SoundDataSentCurrent[player][STAT_CURRENT] = 0;
 			m_TerrainDataSentCurrent[player][STAT_CURRENT] = 0;
+			m_TerrainTilesSentCurrent[player][STAT_CURRENT] = 0;
+			m_TerrainTileDataSentCurrent[player][STAT_CURRENT] = 0;
 			m_OtherDataSentCurrent[player][STAT_CURRENT] = 0;
 		}
 
@@ -264,6 +330,7 @@ namespace RTE
 		m_IsInServerMode = false;
 		// Wait for thread to shut down
 		Sleep(250);
+		StopEncodeThreads();
 		m_Server->Shutdown(300);
 		// We're done with the network
 		RakNet::RakPeerInterface::DestroyInstance(m_Server);
@@ -353,10 +420,16 @@ namespace RTE
 
 		m_Server->SetOccasionalPing(true);
 		m_Server->SetUnreliableTimeout(50);
+
+		if (m_TransmitAsBoxes)
+			StartEncodeThreads();
 	}
 
 	void NetworkServer::Update(bool processInput)
 	{
+		static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("NetworkServer::Update");
+		ProfileZone profileZone(s_ProfilerZoneID);
+
 		RakNet::Packet *p;
 
 		for (p = m_Server->Receive(); p; m_Server->DeallocatePacket(p), p = m_Server->Receive())
@@ -412,6 +485,10 @@ namespace RTE
 				ReceiveInputMsg(p);
 				break;
 
+			case ID_CLT_FRAME_ACK:
+				ReceiveFrameAckMsg(p);
+				break;
+
 			case ID_CLT_SCENE_ACCEPTED:
 				ReceiveSceneAcceptedMsg(p);
 				break;
@@ -527,6 +604,8 @@ namespace RTE
 			}
 		}
 
+		FlushTerrainChanges();
+
 		DrawStatisticsData();
 
 		// Clear sound events for unconnected players because AudioMan does not know about their state and stores broadcast sounds to their event lists
@@ -578,7 +657,7 @@ namespace RTE
 		guid += GetServerGuid().ToString();
 		g_FrameMan.GetLargeFont()->DrawAligned(&pGUIBitmap, midX, 5, guid, GUIFont::Centre);
 
-		char buf[256];
+		char buf[512];
 
 		if (m_NatServerConnected)
 		{
@@ -612,6 +691,8 @@ namespace RTE
 		m_DataSentCurrent[STATS_SUM][STAT_SHOWN] = 0;
 		m_FrameDataSentCurrent[STATS_SUM][STAT_SHOWN] = 0;
 		m_TerrainDataSentCurrent[STATS_SUM][STAT_SHOWN] = 0;
+		m_TerrainTilesSentCurrent[STATS_SUM][STAT_SHOWN] = 0;
+		m_TerrainTileDataSentCurrent[STATS_SUM][STAT_SHOWN] = 0;
 		m_OtherDataSentCurrent[STATS_SUM][STAT_SHOWN] = 0;
 
 		m_FrameDataSentTotal[STATS_SUM] = 0;
@@ -626,6 +707,9 @@ namespace RTE
 
 		m_FullBlocks[STATS_SUM] = 0;
 		m_EmptyBlocks[STATS_SUM] = 0;
+		m_DeltaBlocks[STATS_SUM] = 0;
+		m_UnchangedBlocks[STATS_SUM] = 0;
+		m_KeyframesSent[STATS_SUM] = 0;
 
 
 		for (int i = 0; i < MAX_STAT_RECORDS; i++)
@@ -640,6 +724,8 @@ namespace RTE
 				m_DataSentCurrent[STATS_SUM][STAT_SHOWN] += m_DataSentCurrent[i][STAT_SHOWN];
 				m_FrameDataSentCurrent[STATS_SUM][STAT_SHOWN] += m_FrameDataSentCurrent[i][STAT_SHOWN];
 				m_TerrainDataSentCurrent[STATS_SUM][STAT_SHOWN] += m_TerrainDataSentCurrent[i][STAT_SHOWN];
+				m_TerrainTilesSentCurrent[STATS_SUM][STAT_SHOWN] += m_TerrainTilesSentCurrent[i][STAT_SHOWN];
+				m_TerrainTileDataSentCurrent[STATS_SUM][STAT_SHOWN] += m_TerrainTileDataSentCurrent[i][STAT_SHOWN];
 				m_OtherDataSentCurrent[STATS_SUM][STAT_SHOWN] += m_OtherDataSentCurrent[i][STAT_SHOWN];
 
 				m_FrameDataSentTotal[STATS_SUM] += m_FrameDataSentTotal[i];
@@ -654,6 +740,9 @@ namespace RTE
 
 				m_FullBlocks[STATS_SUM] += m_FullBlocks[i];
 				m_EmptyBlocks[STATS_SUM] += m_EmptyBlocks[i];
+				m_DeltaBlocks[STATS_SUM] += m_DeltaBlocks[i];
+				m_UnchangedBlocks[STATS_SUM] += m_UnchangedBlocks[i];
+				m_KeyframesSent[STATS_SUM] += m_KeyframesSent[i];
 			}
 
 			// Update compression ratio
@@ -664,7 +753,9 @@ namespace RTE
 			if (m_MsecPerFrame[i] > 0)
 				fps = 1000 / m_MsecPerFrame[i];
 
-			sprintf_s(buf, sizeof(buf), "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nTotal Data %lu MB",
+			unsigned long int bytesPerTile = m_TerrainTilesSentCurrent[i][STAT_SHOWN] > 0 ? m_TerrainTileDataSentCurrent[i][STAT_SHOWN] / m_TerrainTilesSentCurrent[i][STAT_SHOWN] : 0;
+
+			sprintf_s(buf, sizeof(buf), "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlocks delta: %uK\nBlocks unchgd: %uK\nKeyframes: %u\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nEnc Ms %.1f\nSnd Ms %.1f\nAux Ms %.1f\nTiles/frame: %d\nTiles sent: %lu\nBytes/tile: %lu\nTotal Data %lu MB",
 				i == STATS_SUM ? "- TOTALS - " : IsPlayerConnected(i) ? GetPlayerName(i).c_str() : "- NO PLAYER -",
 				i < c_MaxClients ? m_Ping[i] : 0,
 				(double)m_DataSentCurrent[i][STAT_SHOWN] / (125000),
@@ -678,9 +769,18 @@ namespace RTE
 				m_FramesSkipped[i] / 1000,
 				m_FullBlocks[i] / 1000,
 				m_EmptyBlocks[i] / 1000,
+				m_DeltaBlocks[i] / 1000,
+				m_UnchangedBlocks[i] / 1000,
+				m_KeyframesSent[i],
 				emptyRatio,
 				i < c_MaxClients ? fps : 0,
 				i < c_MaxClients ? m_MsecPerSendCall[i] : 0,
+				i < c_MaxClients ? (double)m_UsecFrameEncode[i] / 1000 : 0,
+				i < c_MaxClients ? (double)m_UsecFrameSend[i] / 1000 : 0,
+				i < c_MaxClients ? (double)m_UsecFrameAux[i] / 1000 : 0,
+				m_TerrainTilesPerFrame,
+				m_TerrainTilesSentCurrent[i][STAT_SHOWN],
+				bytesPerTile,
 				m_DataSentTotal[i] / (1024 * 1024));
 
 				g_FrameMan.GetLargeFont()->DrawAligned(&pGUIBitmap, 10 + i * g_FrameMan.GetResX() / 5, 75, buf, GUIFont::Left);
@@ -688,9 +788,9 @@ namespace RTE
 
 				if (i < c_MaxClients)
 				{
-					int lines = 2;
-					sprintf_s(buf, sizeof(buf), "Thread: %d\nBuffer: %d / %d",
-						m_ThreadExitReason[i], m_SendBufferMessages[i], m_SendBufferBytes[i] / 1024);
+					int lines = 3;
+					sprintf_s(buf, sizeof(buf), "Thread: %d\nBuffer: %d / %d\nEncoders: %d",
+						m_ThreadExitReason[i], m_SendBufferMessages[i], m_SendBufferBytes[i] / 1024, (int)m_EncodeThreads.size() + 1);
 					g_FrameMan.GetLargeFont()->DrawAligned(&pGUIBitmap, 10 + i * g_FrameMan.GetResX() / 5, g_FrameMan.GetResY() - lines * 15, buf, GUIFont::Left);
 				}
 		}
@@ -715,23 +815,52 @@ namespace RTE
 
 	void NetworkServer::CreateBackBuffer(int player, int w, int h)
 	{
-		m_pBackBuffer8[player] = create_bitmap_ex(8, w, h);
-		m_pBackBufferGUI8[player] = create_bitmap_ex(8, w, h);
+		m_pDeltaReference8[player] = create_bitmap_ex(8, w, h);
+		m_pDeltaReferenceGUI8[player] = create_bitmap_ex(8, w, h);
+		clear_to_color(m_pDeltaReference8[player], 0);
+		clear_to_color(m_pDeltaReferenceGUI8[player], 0);
+
+		// One extra box each way for the partial boxes at the edges
+		int boxCount = (w / m_BoxWidth + 1) * (h / m_BoxHeight + 1);
+		m_BoxHashes[player][0].assign(boxCount, 0);
+		m_BoxHashes[player][1].assign(boxCount, 0);
+
+		// Room for every box of a row in both layers, even if none of them compress at all
+		m_EncodedRows[player].resize(h / m_BoxHeight + 1);
+		for (std::vector<EncodedRow>::iterator rItr = m_EncodedRows[player].begin(); rItr != m_EncodedRows[player].end(); ++rItr)
+		{
+			rItr->Data.resize((w / m_BoxWidth + 1) * 2 * (sizeof(RTE::MsgFrameBox) + m_BoxWidth * m_BoxHeight));
+			rItr->MessageSizes.reserve((w / m_BoxWidth + 1) * 2);
+		}
+
+		// The references are blank, so the client has to get everything in full first
+		m_KeyframeRequested[player] = true;
 	}
 
 	void NetworkServer::DestroyBackBuffer(int player)
 	{
-		if (m_pBackBuffer8)
-			destroy_bitmap(m_pBackBuffer8[player]);
+		// These belong to FrameMan
 		m_pBackBuffer8[player] = 0;
-
-		if (m_pBackBufferGUI8)
-			destroy_bitmap(m_pBackBufferGUI8[player]);
 		m_pBackBufferGUI8[player] = 0;
+
+		if (m_pDeltaReference8[player])
+			destroy_bitmap(m_pDeltaReference8[player]);
+		m_pDeltaReference8[player] = 0;
+
+		if (m_pDeltaReferenceGUI8[player])
+			destroy_bitmap(m_pDeltaReferenceGUI8[player]);
+		m_pDeltaReferenceGUI8[player] = 0;
+
+		m_BoxHashes[player][0].clear();
+		m_BoxHashes[player][1].clear();
+		m_EncodedRows[player].clear();
 	}
 
 	void NetworkServer::SendSceneSetupData(int player)
 	{
+		// The client clears its GUI layer when it gets a new scene, so the delta references are off after this
+		m_KeyframeRequested[player] = true;
+
 		RTE::MsgSceneSetup msgSceneSetup;
 		msgSceneSetup.Id = ID_SRV_SCENE_SETUP;
 		msgSceneSetup.SceneId = m_SceneId;
@@ -835,18 +964,79 @@ namespace RTE
 
 	void NetworkServer::RegisterTerrainChange(SceneMan::TerrainChange tc)
 	{
-		if (m_IsInServerMode)
+		if (!m_IsInServerMode)
+			return;
+
+		// Start over with a new tile grid if the scene changed size
+		int tileCountX = (g_SceneMan.GetSceneWidth() + c_TerrainTileSize - 1) / c_TerrainTileSize;
+		int tileCountY = (g_SceneMan.GetSceneHeight() + c_TerrainTileSize - 1) / c_TerrainTileSize;
+		if (tileCountX != m_TerrainTileCountX || tileCountY != m_TerrainTileCountY)
 		{
-			for (int p = 0; p < c_MaxClients; p++)
+			m_TerrainTileCountX = tileCountX;
+			m_TerrainTileCountY = tileCountY;
+			m_ChangedTerrainTileLayers.assign(tileCountX * tileCountY, 0);
+			m_ChangedTerrainTiles.clear();
+		}
+
+		// Just mark every tile the change touches, they're sent once per frame no matter how many changes hit them
+		unsigned char layer = tc.back ? 2 : 1;
+		int lastTileX = MIN((tc.x + tc.w - 1) / c_TerrainTileSize, m_TerrainTileCountX - 1);
+		int lastTileY = MIN((tc.y + tc.h - 1) / c_TerrainTileSize, m_TerrainTileCountY - 1);
+		for (int tileY = MAX(tc.y / c_TerrainTileSize, 0); tileY <= lastTileY; tileY++)
+		{
+			for (int tileX = MAX(tc.x / c_TerrainTileSize, 0); tileX <= lastTileX; tileX++)
 			{
-				if (IsPlayerConnected(p))
+				int tile = tileY * m_TerrainTileCountX + tileX;
+				if (m_ChangedTerrainTileLayers[tile] == 0)
+					m_ChangedTerrainTiles.push_back(tile);
+				m_ChangedTerrainTileLayers[tile] |= layer;
+			}
+		}
+	}
+
+	void NetworkServer::FlushTerrainChanges()
+	{
+		m_TerrainTilesPerFrame = m_ChangedTerrainTiles.size();
+		if (m_ChangedTerrainTiles.empty())
+			return;
+
+		for (int p = 0; p < c_MaxClients; p++)
+		{
+			if (!IsPlayerConnected(p))
+				continue;
+
+			m_Mutex[p].lock();
+			if (m_QueuedTerrainTileLayers[p].size() != m_ChangedTerrainTileLayers.size())
+				m_QueuedTerrainTileLayers[p].assign(m_ChangedTerrainTileLayers.size(), 0);
+
+			for (int tile : m_ChangedTerrainTiles)
+			{
+				// Skip the layers of the tile that are already waiting to be sent, they'll be read from the terrain as it is when they are
+				unsigned char newLayers = m_ChangedTerrainTileLayers[tile] & ~m_QueuedTerrainTileLayers[p][tile];
+				if (newLayers == 0)
+					continue;
+				m_QueuedTerrainTileLayers[p][tile] |= newLayers;
+
+				SceneMan::TerrainChange tc;
+				tc.x = (tile % m_TerrainTileCountX) * c_TerrainTileSize;
+				tc.y = (tile / m_TerrainTileCountX) * c_TerrainTileSize;
+				tc.w = MIN(c_TerrainTileSize, g_SceneMan.GetSceneWidth() - tc.x);
+				tc.h = MIN(c_TerrainTileSize, g_SceneMan.GetSceneHeight() - tc.y);
+				for (int layer = 0; layer < 2; layer++)
 				{
-					m_Mutex[p].lock();
-					m_PendingTerrainChanges[p].push(tc);
-					m_Mutex[p].unlock();
+					if (newLayers & (1 << layer))
+					{
+						tc.back = layer == 1;
+						m_PendingTerrainChanges[p].push(tc);
+					}
 				}
 			}
+			m_Mutex[p].unlock();
 		}
+
+		for (int tile : m_ChangedTerrainTiles)
+			m_ChangedTerrainTileLayers[tile] = 0;
+		m_ChangedTerrainTiles.clear();
 	}
 
 	bool NetworkServer::NeedToProcessTerrainChanges(int player)
@@ -868,138 +1058,75 @@ namespace RTE
 			m_CurrentTerrainChanges[player].push(m_PendingTerrainChanges[player].front());
 			m_PendingTerrainChanges[player].pop();
 		}
+		// Everything queued is about to be sent, so any tile that changes from here on has to be queued again
+		std::fill(m_QueuedTerrainTileLayers[player].begin(), m_QueuedTerrainTileLayers[player].end(), 0);
 		m_Mutex[player].unlock();
 
+		// Each tile fits in a single message, so they're sent as they are
 		while (!m_CurrentTerrainChanges[player].empty())
 		{
-			int maxSize = 1280;
-
-			SceneMan::TerrainChange tc = m_CurrentTerrainChanges[player].front();
+			SendTerrainChangeMsg(player, m_CurrentTerrainChanges[player].front());
 			m_CurrentTerrainChanges[player].pop();
-
-			// Fragment region if it does not fit one packet
-			if (tc.w * tc.h > maxSize)
-			{
-				int size = 0;
-				int height = 1;
-				int heightStart = 0;
-
-				for (int y = 0; y < tc.h; y++)
-				{
-					height++;
-					size += tc.w;
-
-					// Store changed block if the size is over the MTU or if it's the last block.
-					if (size + tc.w >= maxSize || y == tc.h - 1)
-					{
-						SceneMan::TerrainChange tcf;
-						tcf.x = tc.x;
-						tcf.y = tc.y + heightStart;
-						tcf.w = tc.w;
-						tcf.h = height;
-						tcf.back = tc.back;
-						tcf.color = tc.color;
-
-						SendTerrainChangeMsg(player, tcf);
-
-						size = 0;
-						heightStart = y;
-						height = 1;
-					}
-				}
-			}
-			else 
-			{
-				SendTerrainChangeMsg(player, tc);
-			}
 		}
 	}
 
 	void NetworkServer::SendTerrainChangeMsg(int player, SceneMan::TerrainChange tc)
 	{
-		if (tc.w == 1 && tc.h == 1)
-		{
-			RTE::MsgTerrainChange msg;
-			msg.Id = ID_SRV_TERRAIN;
-			msg.X = tc.x;
-			msg.Y = tc.y;
-			msg.W = tc.w;
-			msg.H = tc.h;
-			msg.DataSize = 0;
-			msg.UncompressedSize = 0;
-			msg.SceneId = m_SceneId;
-			msg.Color = tc.color;
-			msg.Back = tc.back;
-
-			int payloadSize = sizeof(RTE::MsgTerrainChange);
-
-			m_Server->Send((const char *)&msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
-
-			m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataSentTotal[player] += payloadSize;
+		RTE::MsgTerrainChange * msg = (RTE::MsgTerrainChange *)m_aPixelLineBuffer[player];
+		msg->Id = ID_SRV_TERRAIN;
+		msg->X = tc.x;
+		msg->Y = tc.y;
+		msg->W = tc.w;
+		msg->H = tc.h;
+		int size = msg->W * msg->H;
+		msg->DataSize = size;
+		msg->UncompressedSize = size;
+		msg->SceneId = m_SceneId;
+		msg->Back = tc.back;
 
-			m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_TerrainDataSentTotal[player] += payloadSize;
+		Scene * pScene = g_SceneMan.GetScene();
+		SLTerrain * pTerrain = pScene->GetTerrain();
 
-			m_DataUncompressedCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataUncompressedTotal[player] += payloadSize;
-		}
+		BITMAP * bmp = 0;
+		if (msg->Back)
+			bmp = pTerrain->GetBGColorBitmap();
 		else 
-		{
-			RTE::MsgTerrainChange * msg = (RTE::MsgTerrainChange *)m_aPixelLineBuffer[player];
-			msg->Id = ID_SRV_TERRAIN;
-			msg->X = tc.x;
-			msg->Y = tc.y;
-			msg->W = tc.w;
-			msg->H = tc.h;
-			int size = msg->W * msg->H;
-			msg->DataSize = size;
-			msg->UncompressedSize = size;
-			msg->SceneId = m_SceneId;
-			msg->Color = tc.color;
-			msg->Back = tc.back;
-
-			Scene * pScene = g_SceneMan.GetScene();
-			SLTerrain * pTerrain = pScene->GetTerrain();
+			bmp = pTerrain->GetFGColorBitmap();
 
-			BITMAP * bmp = 0;
-			if (msg->Back)
-				bmp = pTerrain->GetBGColorBitmap();
-			else 
-				bmp = pTerrain->GetFGColorBitmap();
+		unsigned char * pDest = (unsigned char *)(m_aTerrainChangeBuffer[player]);
 
-			unsigned char * pDest = (unsigned char *)(m_aTerrainChangeBuffer[player]);
+		// Copy bitmap data
+		for (int y = 0; y < msg->H && msg->Y + y < bmp->h; y++)
+		{
+			memcpy(pDest, bmp->line[msg->Y + y] + msg->X, msg->W);
+			pDest += msg->W;
+		}
 
-			// Copy bitmap data
-			for (int y = 0; y < msg->H && msg->Y + y < bmp->h; y++)
-			{
-				memcpy(pDest, bmp->line[msg->Y + y] + msg->X, msg->W);
-				pDest += msg->W;
-			}
+		int result = 0;
 
-			int result = 0;
+		result = LZ4_compress_HC_extStateHC(m_pLZ4CompressionState[player], (char *)m_aTerrainChangeBuffer[player] , (char *)(m_aPixelLineBuffer[player] + sizeof(RTE::MsgTerrainChange)), size, size, LZ4HC_CLEVEL_OPT_MIN);
 
-			result = LZ4_compress_HC_extStateHC(m_pLZ4CompressionState[player], (char *)m_aTerrainChangeBuffer[player] , (char *)(m_aPixelLineBuffer[player] + sizeof(RTE::MsgTerrainChange)), size, size, LZ4HC_CLEVEL_OPT_MIN);
+		// Compression failed or ineffective, send as is
+		if (result == 0 || result == size)
+			memcpy_s(m_aPixelLineBuffer[player] + sizeof(RTE::MsgTerrainChange), MAX_PIXEL_LINE_BUFFER_SIZE, m_aTerrainChangeBuffer[player], size);
+		else
+			msg->DataSize = result;
 
-			// Compression failed or ineffective, send as is
-			if (result == 0 || result == size)
-				memcpy_s(m_aPixelLineBuffer[player] + sizeof(RTE::MsgTerrainChange), MAX_PIXEL_LINE_BUFFER_SIZE, m_aTerrainChangeBuffer[player], size);
-			else
-				msg->DataSize = result;
+		int payloadSize = sizeof(RTE::MsgTerrainChange) + msg->DataSize;
 
-			int payloadSize = sizeof(RTE::MsgTerrainChange) + msg->DataSize;
+		m_Server->Send((const char *)msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
 
-			m_Server->Send((const char *)msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
+		m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_DataSentTotal[player] += payloadSize;
 
-			m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataSentTotal[player] += payloadSize;
+		m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_TerrainDataSentTotal[player] += payloadSize;
 
-			m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_TerrainDataSentTotal[player] += payloadSize;
+		m_TerrainTilesSentCurrent[player][STAT_CURRENT]++;
+		m_TerrainTileDataSentCurrent[player][STAT_CURRENT] += payloadSize;
 
-			m_DataUncompressedCurrent[player][STAT_CURRENT] += msg->UncompressedSize;
-			m_DataUncompressedTotal[player] += msg->UncompressedSize;
-		}
+		m_DataUncompressedCurrent[player][STAT_CURRENT] += msg->UncompressedSize;
+		m_DataUncompressedTotal[player] += msg->UncompressedSize;
 	}
 
 	void NetworkServer::ClearTerrainChangeQueue(int player)
@@ -1009,6 +1136,7 @@ namespace RTE
 			m_PendingTerrainChanges[player].pop();
 		while (!m_CurrentTerrainChanges[player].empty())
 			m_CurrentTerrainChanges[player].pop();
+		std::fill(m_QueuedTerrainTileLayers[player].begin(), m_QueuedTerrainTileLayers[player].end(), 0);
 		m_Mutex[player].unlock();
 	}
 
@@ -1353,16 +1481,21 @@ namespace RTE
 		RTE::MsgFrameSetup msgFrameSetup;
 		msgFrameSetup.Id = ID_SRV_FRAME_SETUP;
 		msgFrameSetup.FrameNumber = m_FrameNumbers[player];
-		msgFrameSetup.TargetPosX = g_FrameMan.GetTargetPos(player).m_X;
-		msgFrameSetup.TargetPosY = g_FrameMan.GetTargetPos(player).m_Y;
+		// Use the positions the acquired frame was drawn with, not whatever FrameMan is drawing now
+		msgFrameSetup.TargetPosX = g_FrameMan.GetNetworkTargetPosAcquired(player).m_X;
+		msgFrameSetup.TargetPosY = g_FrameMan.GetNetworkTargetPosAcquired(player).m_Y;
 
 		for (int i = 0; i < MAX_BACKGROUND_LAYERS_TRANSMITTED; i++)
 		{
-			msgFrameSetup.OffsetX[i] = g_FrameMan.SLOffset[player][i].m_X;
-			msgFrameSetup.OffsetY[i] = g_FrameMan.SLOffset[player][i].m_Y;
+			msgFrameSetup.OffsetX[i] = g_FrameMan.GetNetworkSLOffsetAcquired(player, i).m_X;
+			msgFrameSetup.OffsetY[i] = g_FrameMan.GetNetworkSLOffsetAcquired(player, i).m_Y;
 		}
 
-		int payloadSize = sizeof(RTE::MsgSceneSetup);
+		msgFrameSetup.FrameSequence = m_FrameSequence[player];
+		msgFrameSetup.Keyframe = m_SendKeyframe[player];
+		msgFrameSetup.PreviousFrameBoxCount = m_PreviousFrameBoxesSent[player];
+
+		int payloadSize = sizeof(RTE::MsgFrameSetup);
 
 		m_Server->Send((const char *)&msgFrameSetup, payloadSize, MEDIUM_PRIORITY, RELIABLE_ORDERED, 0, m_ClientConnections[player].ClientId, false);
 
@@ -1380,6 +1513,9 @@ namespace RTE
 
 	int NetworkServer::SendFrame(int player)
 	{
+		static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("NetworkServer::SendFrame");
+		ProfileZone profileZone(s_ProfilerZoneID);
+
 		// Calc timing stuff
 		int64_t currentTicks = g_TimerMan.GetRealTickCount();
 		double fps = (double)m_EncodingFps;
@@ -1403,6 +1539,14 @@ namespace RTE
 			return (secsPerFrame - secsSinceLastFrame) * m_MicroSecs;
 		}
 
+		// Take over the latest frame FrameMan finished for this player. It won't draw into it again until we acquire the next one, so no copy is needed to avoid tearing.
+		// The previous frame is handed back to FrameMan at the same time, and stays untouched here from now on.
+		if (!g_FrameMan.AcquireNetworkBackBuffer(player))
+		{
+			SetThreadExitReason(player, NetworkServer::WAITING_FOR_FRAME);
+			return m_MicroSecs / 1000;
+		}
+
 		// Accaumulate delayed frames counter for stats
 		if (secsSinceLastFrame > secsPerFrame * 1.5f)
 			m_DelayedFrames[player]++;
@@ -1433,21 +1577,18 @@ namespace RTE
 			return 0;
 		}
 
-		// Wait till frameman releases bitmap
-		SetThreadExitReason(player, NetworkServer::LOCKED);
-		//while (g_FrameMan.IsNetworkBitmapLocked(player));
 		SetThreadExitReason(player, NetworkServer::NORMAL);
 
 		// Get backbuffer bitmap for this player
-		BITMAP * frameManBmp = g_FrameMan.GetNetworkBackBuffer8Ready(player);
-		BITMAP * frameManGUIBmp = g_FrameMan.GetNetworkBackBufferGUI8Ready(player);
+		BITMAP * frameManBmp = g_FrameMan.GetNetworkBackBuffer8Acquired(player);
+		BITMAP * frameManGUIBmp = g_FrameMan.GetNetworkBackBufferGUI8Acquired(player);
 
-		if (!m_pBackBuffer8[player])
+		if (!m_pDeltaReference8[player])
 			CreateBackBuffer(player, frameManBmp->w, frameManBmp->h);
 		else
 		{
-			// If for whatever reasons frameMans back buffer changed dimensions, recreate our internal backbuffer
-			if (m_pBackBuffer8[player]->w != frameManBmp->w || m_pBackBuffer8[player]->h != frameManBmp->h)
+			// If for whatever reasons frameMans back buffer changed dimensions, recreate our internal buffers
+			if (m_pDeltaReference8[player]->w != frameManBmp->w || m_pDeltaReference8[player]->h != frameManBmp->h)
 			{
 				DestroyBackBuffer(player);
 				CreateBackBuffer(player, frameManBmp->w, frameManBmp->h);
@@ -1455,19 +1596,42 @@ namespace RTE
 			}
 		}
 
+		m_pBackBuffer8[player] = frameManBmp;
+		m_pBackBufferGUI8[player] = frameManGUIBmp;
+
 		m_FrameNumbers[player]++;
 		if (m_FrameNumbers[player] >= FRAMES_TO_REMEMBER)
 			m_FrameNumbers[player] = 0;
 
-		// Save a copy of buffer to avoid tearing when the original is updated by frame man
-		blit(frameManBmp, m_pBackBuffer8[player], 0, 0, 0, 0, frameManBmp->w, frameManBmp->h);
-		blit(frameManGUIBmp, m_pBackBufferGUI8[player], 0, 0, 0, 0, frameManGUIBmp->w, frameManGUIBmp->h);
+		m_FrameSequence[player]++;
+		m_PreviousFrameBoxesSent[player] = m_FrameBoxesSent[player];
+		m_FrameBoxesSent[player] = 0;
+
+		// Decide whether this frame goes out in full. Besides the regular interval, if the client hasn't confirmed having a consistent
+		// picture in longer than it takes a frame to get there and back, it probably lost some boxes and needs a fresh start.
+		bool useDelta = m_UseDeltaCompression && m_TransmitAsBoxes;
+		unsigned int ackTimeout = FRAMES_TO_REMEMBER + m_Ping[player] * m_EncodingFps / 500;
+		unsigned int sinceKeyframe = m_FrameSequence[player] - m_LastKeyframe[player];
+		unsigned int sinceAck = m_FrameSequence[player] - m_LastAckedFrame[player];
+
+		m_SendKeyframe[player] = !useDelta || m_KeyframeRequested[player] || sinceKeyframe >= (unsigned int)m_KeyframeInterval || (sinceAck > ackTimeout && sinceKeyframe > ackTimeout);
+		if (m_SendKeyframe[player])
+		{
+			m_KeyframeRequested[player] = false;
+			m_LastKeyframe[player] = m_FrameSequence[player];
+			if (useDelta)
+				m_KeyframesSent[player]++;
+		}
+
+		int64_t auxStartTicks = g_TimerMan.GetRealTickCount();
 
 		SendFrameSetupMsg(player);
 		SendPostEffectData(player);
 		SendSoundData(player);
 		SendMusicData(player);
 
+		m_UsecFrameAux[player] = (g_TimerMan.GetRealTickCount() - auxStartTicks) * m_MicroSecs / g_TimerMan.GetTicksPerSecond();
+
 		m_FramesSent[player]++;
 
 		// Compression section
@@ -1478,159 +1642,75 @@ namespace RTE
 
 		if (m_TransmitAsBoxes)
 		{
-			RTE::MsgFrameBox * frameData = (RTE::MsgFrameBox *)m_aPixelLineBuffer[player];
-			frameData->FrameNumber = m_FrameNumbers[player];
+			int64_t encodeStartTicks = g_TimerMan.GetRealTickCount();
 
-			// Save msg ID
-			frameData->Id = ID_SRV_FRAME_BOX;
-			frameData->BoxWidth = m_BoxWidth;
-			frameData->BoxHeight = m_BoxHeight;
-
-			int bw = m_pBackBuffer8[player]->w / m_BoxWidth;
-			int bh = m_pBackBuffer8[player]->h / m_BoxHeight;
-
-			for (int by = 0; by <= bh; by++)
+			// Hand the rows of boxes out to the encoding threads and pitch in on them here as well, so one player's compression doesn't hold up everyone else's frame
+			m_EncodeUseDelta[player] = useDelta;
+			m_EncodeSendDelta[player] = useDelta && !m_SendKeyframe[player];
 			{
-				int step = 1;
-				int startLine = 0;
+				std::unique_lock<std::mutex> lock(m_EncodeMutex);
+				m_NextEncodeRow[player] = 0;
+				m_EncodeRowCount[player] = m_pBackBuffer8[player]->h / m_BoxHeight + 1;
+				m_EncodeRowsLeft[player] = m_EncodeRowCount[player];
+			}
+			m_EncodeWorkPosted.notify_all();
 
-				if (m_UseInterlacing)
+			EncoderContext context;
+			context.pLZ4CompressionState = m_pLZ4CompressionState[player];
+			context.pLZ4FastCompressionState = m_pLZ4FastCompressionState[player];
+			context.pPixelBuffer = m_aTerrainChangeBuffer[player];
+			{
+				std::unique_lock<std::mutex> lock(m_EncodeMutex);
+				while (m_NextEncodeRow[player] < m_EncodeRowCount[player])
 				{
-					step = 2;
-					if (m_SendEven[player])
-						startLine = by % 2 == 0 ? 1 : 0;
-					else
-						startLine = by % 2 == 0 ? 0 : 1;
+					int row = m_NextEncodeRow[player]++;
+					lock.unlock();
+					EncodeFrameBoxRow(player, row, context);
+					lock.lock();
+					m_EncodeRowsLeft[player]--;
 				}
+				m_EncodeWorkDone.wait(lock, [this, player]() { return m_EncodeRowsLeft[player] == 0; });
+			}
 
-				for (int bx = startLine; bx <= bw; bx += step)
-				{
-					int bpx = bx * m_BoxWidth;
-					int bpy = by * m_BoxHeight;
-
-					if (bpx >= m_pBackBuffer8[player]->w || bpy >= m_pBackBuffer8[player]->h)
-						break;
-
-					frameData->BoxX = bpx;
-					frameData->BoxY = bpy;
-
-					int maxWidth = m_BoxWidth;
-					if (bpx + m_BoxWidth >= m_pBackBuffer8[player]->w)
-					{
-						maxWidth = m_pBackBuffer8[player]->w - bpx;
-						frameData->BoxWidth = maxWidth;
-					}
-
-					int maxHeight = m_BoxHeight;
-					if (bpy + m_BoxHeight >= m_pBackBuffer8[player]->h)
-					{
-						maxHeight = m_pBackBuffer8[player]->h - bpy;
-						frameData->BoxHeight = maxHeight;
-					}
-
-					int size = maxWidth * maxHeight;
-					frameData->UncompressedSize = size;
-					frameData->DataSize = size;
-
-					for (int layer = 0; layer < 2; layer++)
-					{
-						bool boxIsEmpty = true;
-						int line = 0;
-
-						BITMAP * backBuffer = 0;
-						if (layer == 0)
-							backBuffer = m_pBackBuffer8[player];
-						if (layer == 1)
-							backBuffer = m_pBackBufferGUI8[player];
-
-						frameData->Layer = layer;
-
-						unsigned char * pDest = (unsigned char *)(m_aTerrainChangeBuffer[player]);
-
-						// Copy block to line buffer and aso check if block is empty
-						for (line = 0; line < maxHeight; line++)
-						{
-							// Copy bitmap data
-							memcpy(pDest, backBuffer->line[bpy + line] + bpx, maxWidth);
-							pDest += maxWidth;
-						}
-						// Check if block is empty
-						unsigned long int * pixelInt = (unsigned long int *)m_aTerrainChangeBuffer[player];
-						int counter = 0;
-						for (counter = 0; counter < size; counter += sizeof(unsigned long int))
-						{
-							if (*pixelInt > 0)
-							{
-								boxIsEmpty = false;
-								break;
-							}
-							pixelInt++;
-						}
-						if (boxIsEmpty && counter > size)
-						{
-							pixelInt--;
-							counter -= sizeof(unsigned long int);
-
-							unsigned char * pixelChr = (unsigned char *)pixelInt;
-							for (; counter < size; counter++)
-							{
-								if (*pixelChr > 0)
-								{
-									boxIsEmpty = false;
-									break;
-								}
-								pixelChr++;
-							}
-						}
-
-						if (!boxIsEmpty)
-						{
-							int result = 0;
-
-							if (m_UseHighCompression)
-								result = LZ4_compress_HC_extStateHC(m_pLZ4CompressionState[player], (char *)m_aTerrainChangeBuffer[player], (char *)(m_aPixelLineBuffer[player] + sizeof(RTE::MsgFrameBox)), size, size, compressionMethod);
-							else if (m_UseFastCompression)
-								result = LZ4_compress_fast_extState(m_pLZ4FastCompressionState[player], (char *)m_aTerrainChangeBuffer[player], (char *)(m_aPixelLineBuffer[player] + sizeof(RTE::MsgFrameBox)), size, size, accelerationFactor);
+			int64_t sendStartTicks = g_TimerMan.GetRealTickCount();
 
-							// Compression failed or ineffective, send as is
-							if (result == 0 || result == backBuffer->w)
-							{
-								memcpy_s(m_aPixelLineBuffer[player] + sizeof(RTE::MsgFrameBox), MAX_PIXEL_LINE_BUFFER_SIZE, m_aTerrainChangeBuffer[player], size);
-							}
-							else
-							{
-								frameData->DataSize = result;
-							}
+			// Send the rows in order, since out of order sequenced messages would be dropped by the client
+			for (int row = 0; row < m_EncodeRowCount[player]; row++)
+			{
+				const EncodedRow & encodedRow = m_EncodedRows[player][row];
+				const unsigned char * pMessage = encodedRow.Data.data();
 
-							m_FullBlocks[player]++;
-						}
-						else
-						{
-							frameData->DataSize = 0;
-							m_EmptyBlocks[player]++;
-						}
+				for (std::vector<int>::const_iterator sItr = encodedRow.MessageSizes.begin(); sItr != encodedRow.MessageSizes.end(); ++sItr)
+				{
+					int payloadSize = *sItr;
+					m_Server->Send((const char *)pMessage, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
+					pMessage += payloadSize;
 
-						int payloadSize = frameData->DataSize + sizeof(RTE::MsgFrameBox);
+					m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+					m_DataSentTotal[player] += payloadSize;
 
-						//if (!boxIsEmpty)
-							m_Server->Send((const char *)frameData, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
-						//else
-						//	payloadSize = 0;
-						
-						m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_DataSentTotal[player] += payloadSize;
+					m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+					m_FrameDataSentTotal[player] += payloadSize;
+				}
 
-						m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_FrameDataSentTotal[player] += payloadSize;
+				m_DataUncompressedCurrent[player][STAT_CURRENT] += encodedRow.UncompressedSize;
+				m_DataUncompressedTotal[player] += encodedRow.UncompressedSize;
 
-						m_DataUncompressedCurrent[player][STAT_CURRENT] += frameData->UncompressedSize;
-						m_DataUncompressedTotal[player] += frameData->UncompressedSize;
-					}
-				}
+				m_FullBlocks[player] += encodedRow.FullBlocks;
+				m_EmptyBlocks[player] += encodedRow.EmptyBlocks;
+				m_DeltaBlocks[player] += encodedRow.DeltaBlocks;
+				m_UnchangedBlocks[player] += encodedRow.UnchangedBlocks;
+				m_FrameBoxesSent[player] += encodedRow.MessageSizes.size();
 			}
+
+			m_UsecFrameEncode[player] = (sendStartTicks - encodeStartTicks) * m_MicroSecs / g_TimerMan.GetTicksPerSecond();
+			m_UsecFrameSend[player] = (g_TimerMan.GetRealTickCount() - sendStartTicks) * m_MicroSecs / g_TimerMan.GetTicksPerSecond();
 		}
 		else
 		{
+			// Lines are compressed and sent as they go, so it all counts as encoding
+			int64_t encodeStartTicks = g_TimerMan.GetRealTickCount();
+
 			RTE::MsgFrameLine * frameData = (RTE::MsgFrameLine *)m_aPixelLineBuffer[player];
 			frameData->FrameNumber = m_FrameNumbers[player];
 
@@ -1746,6 +1826,9 @@ namespace RTE
 					m_DataUncompressedTotal[player] += frameData->UncompressedSize;
 				}
 			}
+
+			m_UsecFrameEncode[player] = (g_TimerMan.GetRealTickCount() - encodeStartTicks) * m_MicroSecs / g_TimerMan.GetTicksPerSecond();
+			m_UsecFrameSend[player] = 0;
 		}
 
 		ProcessTerrainChanges(player);
@@ -1757,6 +1840,290 @@ namespace RTE
 		return 0;
 	}
 
+	void NetworkServer::EncodeFrameBoxRow(int player, int row, EncoderContext & context)
+	{
+		EncodedRow & encodedRow = m_EncodedRows[player][row];
+		encodedRow.MessageSizes.clear();
+		encodedRow.FullBlocks = 0;
+		encodedRow.EmptyBlocks = 0;
+		encodedRow.DeltaBlocks = 0;
+		encodedRow.UnchangedBlocks = 0;
+		encodedRow.UncompressedSize = 0;
+
+		int bw = m_pBackBuffer8[player]->w / m_BoxWidth;
+		int by = row;
+		int bpy = by * m_BoxHeight;
+
+		if (bpy >= m_pBackBuffer8[player]->h)
+			return;
+
+		int compressionMethod = m_HighCompressionLevel;
+		int accelerationFactor = m_FastAccelerationFactor;
+
+		bool useDelta = m_EncodeUseDelta[player];
+		bool sendDelta = m_EncodeSendDelta[player];
+
+		int step = 1;
+		int startLine = 0;
+
+		// Keyframes have to cover the whole picture, so no interlacing for them
+		if (m_UseInterlacing && !m_SendKeyframe[player])
+		{
+			step = 2;
+			if (m_SendEven[player])
+				startLine = by % 2 == 0 ? 1 : 0;
+			else
+				startLine = by % 2 == 0 ? 0 : 1;
+		}
+
+		unsigned char * pOutput = encodedRow.Data.data();
+
+		for (int bx = startLine; bx <= bw; bx += step)
+		{
+			int bpx = bx * m_BoxWidth;
+
+			if (bpx >= m_pBackBuffer8[player]->w)
+				break;
+
+			int maxWidth = m_BoxWidth;
+			if (bpx + m_BoxWidth >= m_pBackBuffer8[player]->w)
+				maxWidth = m_pBackBuffer8[player]->w - bpx;
+
+			int maxHeight = m_BoxHeight;
+			if (bpy + m_BoxHeight >= m_pBackBuffer8[player]->h)
+				maxHeight = m_pBackBuffer8[player]->h - bpy;
+
+			int size = maxWidth * maxHeight;
+			int boxIndex = by * (bw + 1) + bx;
+
+			for (int layer = 0; layer < 2; layer++)
+			{
+				bool boxIsEmpty = true;
+				int line = 0;
+
+				BITMAP * backBuffer = 0;
+				BITMAP * reference = 0;
+				if (layer == 0)
+				{
+					backBuffer = m_pBackBuffer8[player];
+					reference = m_pDeltaReference8[player];
+				}
+				if (layer == 1)
+				{
+					backBuffer = m_pBackBufferGUI8[player];
+					reference = m_pDeltaReferenceGUI8[player];
+				}
+
+				// Messages are built right in the row's output buffer
+				RTE::MsgFrameBox * frameData = (RTE::MsgFrameBox *)pOutput;
+				frameData->Id = ID_SRV_FRAME_BOX;
+				frameData->FrameNumber = m_FrameNumbers[player];
+				frameData->Layer = layer;
+				frameData->BoxX = bpx;
+				frameData->BoxY = bpy;
+				frameData->BoxWidth = maxWidth;
+				frameData->BoxHeight = maxHeight;
+				frameData->UncompressedSize = size;
+				frameData->DataSize = size;
+
+				unsigned char * pDest = context.pPixelBuffer;
+
+				// Copy block to line buffer and aso check if block is empty
+				for (line = 0; line < maxHeight; line++)
+				{
+					// Copy bitmap data
+					memcpy(pDest, backBuffer->line[bpy + line] + bpx, maxWidth);
+					pDest += maxWidth;
+				}
+
+				unsigned long long boxHash = 0;
+				if (useDelta)
+				{
+					boxHash = HashBoxData(context.pPixelBuffer, size);
+
+					// Client already has exactly this, nothing to send
+					if (sendDelta && boxHash == m_BoxHashes[player][layer][boxIndex])
+					{
+						encodedRow.UnchangedBlocks++;
+						continue;
+					}
+				}
+
+				// Check if block is empty
+				unsigned long int * pixelInt = (unsigned long int *)context.pPixelBuffer;
+				int counter = 0;
+				for (counter = 0; counter < size; counter += sizeof(unsigned long int))
+				{
+					if (*pixelInt > 0)
+					{
+						boxIsEmpty = false;
+						break;
+					}
+					pixelInt++;
+				}
+				if (boxIsEmpty && counter > size)
+				{
+					pixelInt--;
+					counter -= sizeof(unsigned long int);
+
+					unsigned char * pixelChr = (unsigned char *)pixelInt;
+					for (; counter < size; counter++)
+					{
+						if (*pixelChr > 0)
+						{
+							boxIsEmpty = false;
+							break;
+						}
+						pixelChr++;
+					}
+				}
+
+				bool boxIsDelta = sendDelta && !boxIsEmpty;
+
+				if (useDelta)
+				{
+					// Whatever happens below, the client will end up with this box as it is now
+					m_BoxHashes[player][layer][boxIndex] = boxHash;
+
+					unsigned char * pPixels = context.pPixelBuffer;
+					for (line = 0; line < maxHeight; line++)
+					{
+						unsigned char * pReference = reference->line[bpy + line] + bpx;
+						if (boxIsDelta)
+						{
+							// XOR against what the client has, mostly zeroes for small changes which LZ4 loves
+							for (int x = 0; x < maxWidth; x++)
+							{
+								unsigned char current = pPixels[x];
+								pPixels[x] ^= pReference[x];
+								pReference[x] = current;
+							}
+						}
+						else
+							memcpy(pReference, pPixels, maxWidth);
+						pPixels += maxWidth;
+					}
+				}
+
+				if (!boxIsEmpty)
+				{
+					int result = 0;
+
+					if (boxIsDelta)
+						frameData->Id = ID_SRV_FRAME_BOX_DELTA;
+
+					if (m_UseHighCompression)
+						result = LZ4_compress_HC_extStateHC(context.pLZ4CompressionState, (char *)context.pPixelBuffer, (char *)(pOutput + sizeof(RTE::MsgFrameBox)), size, size, compressionMethod);
+					else if (m_UseFastCompression)
+						result = LZ4_compress_fast_extState(context.pLZ4FastCompressionState, (char *)context.pPixelBuffer, (char *)(pOutput + sizeof(RTE::MsgFrameBox)), size, size, accelerationFactor);
+
+					// Compression failed or ineffective, send as is
+					if (result == 0 || result >= size)
+						memcpy(pOutput + sizeof(RTE::MsgFrameBox), context.pPixelBuffer, size);
+					else
+						frameData->DataSize = result;
+
+					if (boxIsDelta)
+						encodedRow.DeltaBlocks++;
+					else
+						encodedRow.FullBlocks++;
+				}
+				else
+				{
+					frameData->DataSize = 0;
+					encodedRow.EmptyBlocks++;
+				}
+
+				int payloadSize = frameData->DataSize + sizeof(RTE::MsgFrameBox);
+				encodedRow.MessageSizes.push_back(payloadSize);
+				encodedRow.UncompressedSize += size;
+				pOutput += payloadSize;
+			}
+		}
+	}
+
+	void NetworkServer::EncodeFrameBoxRows(int contextIndex)
+	{
+		EncoderContext & context = m_EncoderContexts[contextIndex];
+
+		std::unique_lock<std::mutex> lock(m_EncodeMutex);
+		while (true)
+		{
+			int player = -1;
+			m_EncodeWorkPosted.wait(lock, [this, &player]()
+			{
+				if (m_StopEncodeThreads)
+					return true;
+				for (player = 0; player < c_MaxClients; player++)
+				{
+					if (m_NextEncodeRow[player] < m_EncodeRowCount[player])
+						return true;
+				}
+				return false;
+			});
+
+			if (m_StopEncodeThreads)
+				return;
+
+			int row = m_NextEncodeRow[player]++;
+			lock.unlock();
+			{
+				static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("NetworkServer::EncodeFrameBoxRow");
+				ProfileZone profileZone(s_ProfilerZoneID);
+				EncodeFrameBoxRow(player, row, context);
+			}
+			lock.lock();
+
+			if (--m_EncodeRowsLeft[player] == 0)
+				m_EncodeWorkDone.notify_all();
+		}
+	}
+
+	void NetworkServer::StartEncodeThreads()
+	{
+		StopEncodeThreads();
+
+		int threadCount = g_SettingsMan.GetServerEncodingThreads();
+		if (threadCount < 0)
+			threadCount = MAX(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1);
+
+		m_StopEncodeThreads = false;
+		m_EncoderContexts.resize(threadCount);
+		for (int i = 0; i < threadCount; i++)
+		{
+			m_EncoderContexts[i].pLZ4CompressionState = malloc(LZ4_sizeofStateHC());
+			m_EncoderContexts[i].pLZ4FastCompressionState = malloc(LZ4_sizeofState());
+			m_EncoderContexts[i].pPixelBuffer = (unsigned char *)malloc(MAX_PIXEL_LINE_BUFFER_SIZE);
+		}
+		// Only start the threads once all the contexts are in place, resizing the vector after would pull them out from under the threads
+		for (int i = 0; i < threadCount; i++)
+			m_EncodeThreads.push_back(new boost::thread(BackgroundEncodeThreadFunction, this, i));
+	}
+
+	void NetworkServer::StopEncodeThreads()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_EncodeMutex);
+			m_StopEncodeThreads = true;
+		}
+		m_EncodeWorkPosted.notify_all();
+
+		for (std::vector<boost::thread *>::iterator tItr = m_EncodeThreads.begin(); tItr != m_EncodeThreads.end(); ++tItr)
+		{
+			(*tItr)->join();
+			delete *tItr;
+		}
+		m_EncodeThreads.clear();
+
+		for (std::vector<EncoderContext>::iterator cItr = m_EncoderContexts.begin(); cItr != m_EncoderContexts.end(); ++cItr)
+		{
+			free(cItr->pLZ4CompressionState);
+			free(cItr->pLZ4FastCompressionState);
+			free(cItr->pPixelBuffer);
+		}
+		m_EncoderContexts.clear();
+	}
+
 	void NetworkServer::ReceiveDisconnection(RakNet::Packet * p)
 	{
 		std::string msg = "ID_CONNECTION_LOST from";
@@ -1865,6 +2232,12 @@ namespace RTE
 				m_SendSceneSetupData[index] = true;
 				m_SendSceneData[index] = false;
 				m_SendFrameData[index] = false;
+
+				// Start the new client off with a clean slate for delta compression
+				m_FrameSequence[index] = 0;
+				m_LastKeyframe[index] = 0;
+				m_LastAckedFrame[index] = 0;
+				m_KeyframeRequested[index] = true;
 			}
 		}
 
@@ -1949,6 +2322,24 @@ namespace RTE
 		}
 	}
 
+	void NetworkServer::ReceiveFrameAckMsg(RakNet::Packet * p)
+	{
+		RTE::MsgFrameAck * m = (RTE::MsgFrameAck *)p->data;
+
+		int player = -1;
+
+		for (int index = 0; index < c_MaxClients; index++)
+			if (m_ClientConnections[index].ClientId == p->systemAddress)
+				player = index;
+
+		if (player >= 0 && player < c_MaxClients)
+		{
+			// Acks are unreliable, so an older one may well show up after a newer one
+			if ((int)(m->FrameSequence - m_LastAckedFrame[player]) > 0)
+				m_LastAckedFrame[player] = m->FrameSequence;
+		}
+	}
+
 	void NetworkServer::ReceiveInputMsg(RakNet::Packet * p)
 	{
 		NetworkClient::MsgInput * m = (NetworkClient::MsgInput *)p->data;
@@ -60,7 +60,8 @@ namespace RTE
 			TOO_EARLY_TO_SEND,
 			SEND_BUFFER_IS_FULL,
 			SEND_BUFFER_IS_LIMITED_BY_CONGESTION,
-			LOCKED
+			LOCKED,
+			WAITING_FOR_FRAME
 		};
 
 
@@ -155,6 +156,8 @@ namespace RTE
 
 		void ReceiveInputMsg(RakNet::Packet * p);
 
+		void ReceiveFrameAckMsg(RakNet::Packet * p);
+
 		void SendAcceptedMsg(int player);
 
 		int SendFrame(int player);
@@ -193,6 +196,8 @@ namespace RTE
 
 		void RegisterTerrainChange(SceneMan::TerrainChange tc);
 
+		void FlushTerrainChanges();
+
 		void NetworkServer::ClearTerrainChangeQueue(int player);
 
 		bool NeedToProcessTerrainChanges(int player);
@@ -205,6 +210,10 @@ namespace RTE
 
 		void SetInterlacingMode(bool newMode) { m_UseInterlacing = newMode; }
 
+		void SetDeltaCompressionMode(bool newMode) { m_UseDeltaCompression = newMode; }
+
+		void RequestKeyframe(int player) { m_KeyframeRequested[player] = true; }
+
 		void SendNATServerRegistrationMsg(RakNet::SystemAddress addr);
 
 		void ClearInputMessages(int player);
@@ -229,6 +238,16 @@ namespace RTE
 
 		unsigned int GetPing(int player) const { return m_Ping[player]; }
 
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          EncodeFrameBoxRows
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     The loop each encoding thread runs, picking up rows of frame boxes
+		//                  of any player and encoding them until the threads are stopped.
+		// Arguments:       Which encoder context the calling thread uses.
+		// Return value:    None.
+
+		void EncodeFrameBoxRows(int contextIndex);
+
 		//////////////////////////////////////////////////////////////////////////////////////////
 		// Protected member variable and method declarations
 
@@ -248,6 +267,26 @@ namespace RTE
 
 		ClientConnection m_ClientConnections[c_MaxClients];
 
+		// Compression states and scratch space for one thread encoding frame boxes
+		struct EncoderContext
+		{
+			void * pLZ4CompressionState;
+			void * pLZ4FastCompressionState;
+			unsigned char * pPixelBuffer;
+		};
+
+		// The finished messages of one row of frame boxes, encoded by whichever thread picked the row up
+		struct EncodedRow
+		{
+			std::vector<unsigned char> Data;
+			std::vector<int> MessageSizes;
+			int FullBlocks;
+			int EmptyBlocks;
+			int DeltaBlocks;
+			int UnchangedBlocks;
+			unsigned long int UncompressedSize;
+		};
+
 		// Member variables
 		static const std::string m_ClassName;
 
@@ -293,6 +332,9 @@ namespace RTE
 		unsigned long int m_TerrainDataSentCurrent[MAX_STAT_RECORDS][2];
 		unsigned long int m_TerrainDataSentTotal[MAX_STAT_RECORDS];
 
+		unsigned long int m_TerrainTilesSentCurrent[MAX_STAT_RECORDS][2];
+		unsigned long int m_TerrainTileDataSentCurrent[MAX_STAT_RECORDS][2];
+
 		unsigned long int m_OtherDataSentCurrent[MAX_STAT_RECORDS][2];
 		unsigned long int m_OtherDataSentTotal[MAX_STAT_RECORDS];
 
@@ -301,6 +343,12 @@ namespace RTE
 
 		int m_FullBlocks[MAX_STAT_RECORDS];
 
+		int m_DeltaBlocks[MAX_STAT_RECORDS];
+
+		int m_UnchangedBlocks[MAX_STAT_RECORDS];
+
+		unsigned int m_KeyframesSent[MAX_STAT_RECORDS];
+
 		int m_SendBufferBytes[MAX_STAT_RECORDS];
 
 		int m_SendBufferMessages[MAX_STAT_RECORDS];
@@ -311,14 +359,48 @@ namespace RTE
 
 		int m_MsecPerSendCall[c_MaxClients];
 
+		// How long the last frame took to encode, to send and to send everything else along with it, in microseconds
+		int m_UsecFrameEncode[c_MaxClients];
+		int m_UsecFrameSend[c_MaxClients];
+		int m_UsecFrameAux[c_MaxClients];
+
+		// The frame currently being sent, acquired from FrameMan which still owns the bitmaps
 		BITMAP * m_pBackBuffer8[c_MaxClients];
 
 		BITMAP * m_pBackBufferGUI8[c_MaxClients];
 
+		// What the client should have in each box as of the last time it was sent, which delta boxes are XORed against
+		BITMAP * m_pDeltaReference8[c_MaxClients];
+
+		BITMAP * m_pDeltaReferenceGUI8[c_MaxClients];
+
+		// Hashes of the reference contents of each box of each layer, so unchanged boxes can be skipped without reading the reference
+		std::vector<unsigned long long> m_BoxHashes[c_MaxClients][2];
+
 		void * m_pLZ4CompressionState[c_MaxClients];
 
 		void * m_pLZ4FastCompressionState[c_MaxClients];
 
+		// The threads helping the send threads encode frame boxes, and their contexts
+		std::vector<boost::thread *> m_EncodeThreads;
+		std::vector<EncoderContext> m_EncoderContexts;
+		bool m_StopEncodeThreads;
+
+		// Guards the row counters below and goes with the condition variables
+		std::mutex m_EncodeMutex;
+		std::condition_variable m_EncodeWorkPosted;
+		std::condition_variable m_EncodeWorkDone;
+
+		// Each player's encoded rows of the current frame, the next row not yet picked up, how many rows there are and how many aren't done yet
+		std::vector<EncodedRow> m_EncodedRows[c_MaxClients];
+		int m_NextEncodeRow[c_MaxClients];
+		int m_EncodeRowCount[c_MaxClients];
+		int m_EncodeRowsLeft[c_MaxClients];
+
+		// Whether the current frame uses delta compression, and whether it's sent as deltas rather than a keyframe
+		bool m_EncodeUseDelta[c_MaxClients];
+		bool m_EncodeSendDelta[c_MaxClients];
+
 		const int m_MicroSecs = 1000000;
 
 		int m_MouseState1[c_MaxClients];
@@ -340,6 +422,12 @@ namespace RTE
 
 		bool m_UseInterlacing;
 
+		// Send only the boxes that changed since they were last sent, as a diff against what was sent
+		bool m_UseDeltaCompression;
+
+		// How many frames apart every box is sent in full when using delta compression
+		int m_KeyframeInterval;
+
 		int m_EncodingFps;
 
 		bool m_SendEven[c_MaxClients];
@@ -363,6 +451,21 @@ namespace RTE
 
 		std::queue<SceneMan::TerrainChange> m_CurrentTerrainChanges[c_MaxClients];
 
+		// Terrain changes are gathered into square tiles of this size, and each changed tile is sent whole, once per sent frame
+		static const int c_TerrainTileSize = 32;
+
+		// Which layers of each terrain tile changed since the last flush, as bit 0 for foreground and bit 1 for background, and those tiles in the order they first changed. Only touched by the main thread
+		std::vector<unsigned char> m_ChangedTerrainTileLayers;
+		std::vector<int> m_ChangedTerrainTiles;
+		int m_TerrainTileCountX;
+		int m_TerrainTileCountY;
+
+		// How many tiles had changed in the last flush
+		int m_TerrainTilesPerFrame;
+
+		// Which layers of each terrain tile are already queued to be sent to a player, so a tile changed again before it's sent isn't queued twice. Guarded by m_Mutex
+		std::vector<unsigned char> m_QueuedTerrainTileLayers[c_MaxClients];
+
 		std::mutex m_Mutex[c_MaxClients];
 
 		//std::mutex m_InputQueueMutex[c_MaxClients];
@@ -377,6 +480,23 @@ namespace RTE
 
 		int m_FrameNumbers[c_MaxClients];
 
+		// Frame counter that doesn't wrap around like m_FrameNumbers, used to match acknowledgements to frames
+		unsigned int m_FrameSequence[c_MaxClients];
+
+		unsigned int m_LastKeyframe[c_MaxClients];
+
+		// The last frame the client reported as fully received on top of a complete keyframe. Written by the main thread
+		std::atomic<unsigned int> m_LastAckedFrame[c_MaxClients];
+
+		// Set when the client's picture can't be trusted anymore, eg. after scene changes, to send the next frame in full
+		std::atomic<bool> m_KeyframeRequested[c_MaxClients];
+
+		bool m_SendKeyframe[c_MaxClients];
+
+		unsigned short int m_FrameBoxesSent[c_MaxClients];
+
+		unsigned short int m_PreviousFrameBoxesSent[c_MaxClients];
+
 		unsigned int m_Ping[c_MaxClients];
 
 		Timer m_PingTimer[c_MaxClients];
@@ -411,6 +531,37 @@ namespace RTE
 		NetworkServer & operator=(const NetworkServer &rhs);
 
 		unsigned char GetPacketIdentifier(RakNet::Packet *p);
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          EncodeFrameBoxRow
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Encodes one row of boxes of a player's current frame into messages
+		//                  ready to send. Safe to run on any thread, for different rows at once.
+		// Arguments:       The player whose frame to encode.
+		//                  Which row of boxes to encode.
+		//                  The compression states and scratch space of the calling thread.
+		// Return value:    None.
+
+		void EncodeFrameBoxRow(int player, int row, EncoderContext & context);
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          StartEncodeThreads
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Starts the threads that help encode frame boxes, as many as set in
+		//                  the settings.
+		// Arguments:       None.
+		// Return value:    None.
+
+		void StartEncodeThreads();
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          StopEncodeThreads
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Stops and joins the encoding threads and frees their contexts.
+		// Arguments:       None.
+		// Return value:    None.
+
+		void StopEncodeThreads();
 	};
 
 } // namespace RTE
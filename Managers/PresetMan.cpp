@@ -43,6 +43,8 @@ void PresetMan::Clear()
     m_DataModuleIDs.clear();
     m_OfficialModuleCount = 0;
     m_TotalGroupRegister.clear();
+    m_PresetHandles.clear();
+    m_PresetHandleIDs.clear();
 }
 
 /*
@@ -181,45 +183,70 @@ bool PresetMan::LoadDataModule(string moduleName, bool official, ProgressCallbac
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool PresetMan::LoadAllDataModules() {
-	// Load all the official modules first!
-	if (!LoadDataModule("Base.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-
-	if (!LoadDataModule("Coalition.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Imperatus.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Techion.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Dummy.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Ronin.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Browncoats.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Uzira.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("MuIlaak.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!LoadDataModule("Missions.rte", true, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
+	// Official modules are loaded first, in this order!
+	const std::vector<std::string> officialModules = { "Base.rte", "Coalition.rte", "Imperatus.rte", "Techion.rte", "Dummy.rte", "Ronin.rte", "Browncoats.rte", "Uzira.rte", "MuIlaak.rte", "Missions.rte" };
+	std::vector<std::string> unofficialModules;
 
 	// If a single module is specified, skip loading all other unofficial modules and load specified module only.
-	if (m_SingleModuleToLoad != "Base.rte" && m_SingleModuleToLoad != "") {
-		if (!LoadDataModule(m_SingleModuleToLoad, false, &LoadingGUI::LoadingSplashProgressReport)) { return false; } else { return true; }
+	bool singleModule = m_SingleModuleToLoad != "Base.rte" && m_SingleModuleToLoad != "";
+	if (singleModule) {
+		unofficialModules.push_back(m_SingleModuleToLoad);
 	} else {
 		al_ffblk moduleInfo;
-		int moduleID = 0;
 
 		for (int result = al_findfirst("*.rte", &moduleInfo, FA_DIREC | FA_RDONLY); result == 0; result = al_findnext(&moduleInfo)) {
 			if (!g_SettingsMan.IsModDisabled(moduleInfo.name)) {
-				moduleID = GetModuleID(moduleInfo.name);
-				// Make sure we don't load properties of already loaded official modules
-				if (strlen(moduleInfo.name) > 0 && (moduleID < 0 || moduleID >= GetOfficialModuleCount()) && string(moduleInfo.name) != "Metagames.rte" && string(moduleInfo.name) != "Scenes.rte") {
-					// NOTE: LoadDataModule can return false (especially since it may try to load already loaded modules, which is okay) and shouldn't cause stop, so we can ignore its return value here.
-                    LoadDataModule(string(moduleInfo.name), false, &LoadingGUI::LoadingSplashProgressReport);
+				std::string moduleName = moduleInfo.name;
+				// Make sure we don't load properties of official modules again
+				bool isOfficial = false;
+				for (const std::string &officialModule : officialModules) {
+					isOfficial = isOfficial || (moduleName.size() == officialModule.size() && std::equal(moduleName.begin(), moduleName.end(), officialModule.begin(), [](char moduleChar, char officialChar) { return std::tolower(moduleChar) == std::tolower(officialChar); }));
 				}
+				if (!moduleName.empty() && !isOfficial && moduleName != "Metagames.rte" && moduleName != "Scenes.rte") { unofficialModules.push_back(moduleName); }
 			}
 		}
 		// Close the file search to avoid memory leaks
 		al_findclose(&moduleInfo);
 	}
 
+	// Have the files of every module read in ahead on other threads while the modules before them are being loaded. The modules themselves are still loaded one by one in the same order as always.
+	m_FilePrefetcher.Create(2, 256 * 1024 * 1024);
+	for (const std::string &moduleName : officialModules) { m_FilePrefetcher.QueueModule(moduleName); }
+	for (const std::string &moduleName : unofficialModules) { m_FilePrefetcher.QueueModule(moduleName); }
+	if (!singleModule) {
+		m_FilePrefetcher.QueueModule("Scenes.rte");
+		m_FilePrefetcher.QueueModule("Metagames.rte");
+	}
+
+	bool allLoaded = true;
+	for (const std::string &moduleName : officialModules) {
+		allLoaded = LoadDataModule(moduleName, true, &LoadingGUI::LoadingSplashProgressReport);
+		m_FilePrefetcher.ReleaseModule(moduleName);
+		if (!allLoaded) {
+			break;
+		}
+	}
+	if (allLoaded) {
+		for (const std::string &moduleName : unofficialModules) {
+			// NOTE: LoadDataModule can return false (especially since it may try to load already loaded modules, which is okay) and shouldn't cause stop, so we can ignore its return value here, unless it's the single specified module.
+			bool moduleLoaded = LoadDataModule(moduleName, false, &LoadingGUI::LoadingSplashProgressReport);
+			m_FilePrefetcher.ReleaseModule(moduleName);
+			if (singleModule) { allLoaded = moduleLoaded; }
+		}
+	}
 	// Load scenes and MetaGames AFTER all other techs etc are loaded; might be referring to stuff in user mods
-	if (!g_PresetMan.LoadDataModule("Scenes.rte", false, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
-	if (!g_PresetMan.LoadDataModule("Metagames.rte", false, &LoadingGUI::LoadingSplashProgressReport)) { return false; }
+	if (allLoaded && !singleModule) {
+		for (const std::string &moduleName : { "Scenes.rte", "Metagames.rte" }) {
+			allLoaded = LoadDataModule(moduleName, false, &LoadingGUI::LoadingSplashProgressReport);
+			m_FilePrefetcher.ReleaseModule(moduleName);
+			if (!allLoaded) {
+				break;
+			}
+		}
+	}
+	m_FilePrefetcher.Destroy();
 
-	return true;
+	return allLoaded;
 }
 
 
@@ -384,6 +411,29 @@ const Entity * PresetMan::GetEntityPreset(string type, string preset, int whichM
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPresetHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a handle to a previously read in (defined) Entity, by type and
+//                  instance name.
+
+int PresetMan::GetPresetHandle(string type, string preset, string module)
+{
+    const Entity *pPreset = GetEntityPreset(type, preset, module);
+    if (!pPreset)
+        return -1;
+
+    std::unordered_map<const Entity *, int>::const_iterator handleItr = m_PresetHandleIDs.find(pPreset);
+    if (handleItr != m_PresetHandleIDs.end())
+        return handleItr->second;
+
+    int presetHandle = m_PresetHandles.size();
+    m_PresetHandles.push_back(pPreset);
+    m_PresetHandleIDs.insert(pair<const Entity *, int>(pPreset, presetHandle));
+    return presetHandle;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetEntityPreset
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -419,8 +469,8 @@ const Entity * PresetMan::GetEntityPreset(Reader &reader)
 		// Try to read in the preset instance's data from the reader
 		if (pNewInstance && pNewInstance->Create(reader, false) < 0)
 		{
-			// Abort loading if we can't create entity and it's not in Scenes.rte
-			if (!g_PresetMan.GetDataModule(whichModule)->GetIgnoreMissingItems())
+			// Abort loading if we can't create entity and it's not in Scenes.rte, or it was only half played back from a preset cache that's being thrown away for the ini files
+			if (!g_PresetMan.GetDataModule(whichModule)->GetIgnoreMissingItems() && !reader.IsPresetCacheAbandoned())
 				RTEAbort("Reading of a preset instance \"" + pNewInstance->GetPresetName() + "\" of class " + pNewInstance->GetClassName() + " failed in file " + reader.GetCurrentFilePath() + ", shortly before line #" + reader.GetCurrentFileLineString());
 		}
 		else if (pNewInstance)
@@ -479,8 +529,10 @@ Entity * PresetMan::ReadReflectedPreset(Reader &reader)
         // Try to read in the preset instance's data from the reader
         if (pNewInstance && pNewInstance->Create(reader, false) < 0)
 		{
-			if (!g_PresetMan.GetDataModule(whichModule)->GetIgnoreMissingItems())
+			if (!g_PresetMan.GetDataModule(whichModule)->GetIgnoreMissingItems() && !reader.IsPresetCacheAbandoned())
 	            RTEAbort("Reading of a preset instance \"" + pNewInstance->GetPresetName() + "\" of class " + pNewInstance->GetClassName() + " failed in file " + reader.GetCurrentFilePath() + ", shortly before line #" + reader.GetCurrentFileLineString());
+			// Nothing is returned, so get rid of the half read instance
+			delete pNewInstance;
 		}
 		else
 		{
@@ -597,41 +649,34 @@ Entity * PresetMan::GetRandomOfGroup(string group, string type, int whichModule)
 {
     RTEAssert(!group.empty(), "Looking for empty group!");
 
-    bool foundAny = false;
-    // The total list we'll select a random one from
-    list<Entity *> entityList;
+    // The indexed group lists of each module we'll select a random one from, without copying them together
+    vector<const vector<Entity *> *> groupLists;
+    int totalCount = 0;
 
     // All modules
     if (whichModule < 0)
     {
         // Get from all modules
         for (int i = 0; i < m_pDataModules.size(); ++i)
-            // Send the list to each module, let them add
-            foundAny = m_pDataModules[i]->GetAllOfGroup(entityList, group, type) || foundAny;
+        {
+            groupLists.push_back(&m_pDataModules[i]->GetPresetsOfGroup(group, type));
+            totalCount += groupLists.back()->size();
+        }
     }
     // Specific one
     else
     {
         RTEAssert(whichModule < m_pDataModules.size(), "Trying to get from an out of bounds DataModule ID!");
-        foundAny = m_pDataModules[whichModule]->GetAllOfGroup(entityList, group, type);
+        groupLists.push_back(&m_pDataModules[whichModule]->GetPresetsOfGroup(group, type));
+        totalCount += groupLists.back()->size();
     }
 
     // Didn't find any of that group in those module(s)
-    if (!foundAny)
+    if (totalCount == 0)
         return 0;
 
     // Pick one and return it
-    int current = 0;
-    int selection = SelectRand(0, entityList.size() - 1);
-    for (list<Entity *>::iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
-    {
-        if (current == selection)
-            return (*itr);
-        current++;
-    }
-
-    RTEAssert(0, "Tried selecting randomly but didn't?");
-    return 0;
+    return PickFromGroupLists(groupLists, SelectRand(0, totalCount - 1));
 }
 
 
@@ -645,122 +690,67 @@ Entity * PresetMan::GetRandomBuyableOfGroupFromTech(string group, string type, i
 {
     RTEAssert(!group.empty(), "Looking for empty group!");
 
-    bool foundAny = false;
-    // The total list we'll select a random one from
-    list<Entity *> entityList;
-    list<Entity *> tempList;
-
-
-    string techString = " Tech";
-    string techName;
-    string::size_type techPos = string::npos;
+    // The indexed buyable lists of each module we'll select a random one from, without copying them together
+    vector<const vector<Entity *> *> groupLists;
+    int totalCount = 0;
 
     // All modules
     if (whichModule < 0)
     {
         // Get from all modules
         for (int i = 0; i < m_pDataModules.size(); ++i)
-		{
-			// Select from tech-only modules
-			techName = m_pDataModules[i]->GetFriendlyName();
-			if (techName.find(techString) != string::npos)
-				// Send the list to each module, let them add
-				foundAny = m_pDataModules[i]->GetAllOfGroup(tempList, group, type) || foundAny;
-		}
+        {
+            // Select from tech-only modules
+            if (m_pDataModules[i]->GetFriendlyName().find(" Tech") != string::npos)
+            {
+                groupLists.push_back(&m_pDataModules[i]->GetBuyablePresetsOfGroup(group, type));
+                totalCount += groupLists.back()->size();
+            }
+        }
     }
     // Specific one
     else
     {
         RTEAssert(whichModule < m_pDataModules.size(), "Trying to get from an out of bounds DataModule ID!");
-        foundAny = m_pDataModules[whichModule]->GetAllOfGroup(tempList, group, type);
+        groupLists.push_back(&m_pDataModules[whichModule]->GetBuyablePresetsOfGroup(group, type));
+        totalCount += groupLists.back()->size();
     }
 
-	//Filter found entities, we need only buyables
-	if (foundAny)
-	{
-		//Do not filter anything if we're looking for brains
-		if (group == "Brains")
-		{
-			foundAny = false;
-			for (list<Entity *>::iterator oItr = tempList.begin(); oItr != tempList.end(); ++oItr)
-			{
-				entityList.push_back(*oItr);
-				foundAny = true;
-			}
-		}
-		else
-		{
-			foundAny = false;
-			for (list<Entity *>::iterator oItr = tempList.begin(); oItr != tempList.end(); ++oItr)
-			{
-				SceneObject * pSObject = dynamic_cast<SceneObject *>(*oItr);
-				// Buyable and not brain?
-				if (pSObject && pSObject->IsBuyable() && !pSObject->IsInGroup("Brains"))
-				{
-					entityList.push_back(*oItr);
-					foundAny = true;
-				}
-			}
-		}
-	}
-
-	// Didn't find any of that group in those module(s)
-    if (!foundAny)
+    // Didn't find any of that group in those module(s)
+    if (totalCount == 0)
         return 0;
 
     // Pick one and return it
-    int current = 0;
-    int selection = SelectRand(0, entityList.size() - 1);
-
-	int totalWeight = 0;
-	for (list<Entity *>::iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
-		totalWeight += (*itr)->GetRandomWeight();
+    int selection = SelectRand(0, totalCount - 1);
 
-	// Use random weights if looking in specific modules
-	if (whichModule >= 0)
-	{
-		if (totalWeight == 0)
-			return 0;
+    // Use random weights if looking in specific modules
+    if (whichModule >= 0)
+    {
+        const vector<Entity *> &entityList = *groupLists.front();
 
-		selection = SelectRand(0, totalWeight - 1);
+        int totalWeight = 0;
+        for (vector<Entity *>::const_iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
+            totalWeight += (*itr)->GetRandomWeight();
 
-		for (list<Entity *>::iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
-		{
-			bool found = false;
-			int bucketCounter = 0;
+        if (totalWeight == 0)
+            return 0;
 
-			if ((*itr)->GetRandomWeight() > 0)
-			{
-				while (bucketCounter < (*itr)->GetRandomWeight())
-				{
-					if (current == selection)
-					{
-						found = true;
-						break;
-					}
-
-					current++;
-					bucketCounter++;
-				}
-			}
+        selection = SelectRand(0, totalWeight - 1);
 
-			if (found)
-				return (*itr);
-		}
-	}
-	else 
-	{
-		for (list<Entity *>::iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
-		{
-			if (current == selection)
-				return (*itr);
+        for (vector<Entity *>::const_iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
+        {
+            if ((*itr)->GetRandomWeight() <= 0)
+                continue;
+            if (selection < (*itr)->GetRandomWeight())
+                return (*itr);
+            selection -= (*itr)->GetRandomWeight();
+        }
 
-			current++;
-		}
-	}
+        RTEAssert(0, "Tried selecting randomly but didn't?");
+        return 0;
+    }
 
-    RTEAssert(0, "Tried selecting randomly but didn't?");
-    return 0;
+    return PickFromGroupLists(groupLists, selection);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -805,36 +795,46 @@ Entity * PresetMan::GetRandomOfGroupInModuleSpace(string group, string type, int
 {
     RTEAssert(!group.empty(), "Looking for empty group!");
 
-    bool foundAny = false;
-    // The total list we'll select a random one from
-    list<Entity *> entityList;
-
     // All modules
     if (whichModuleSpace < 0)
-        foundAny = GetAllOfGroup(entityList, group, type, whichModuleSpace);
-    // Specific module space
-    else
-    {
-        // Get all entitys of the specific group the official modules loaded before the specified one
-        for (int module = 0; module < m_OfficialModuleCount && module < whichModuleSpace; ++module)
-            foundAny = GetAllOfGroup(entityList, group, type, module) || foundAny;
+        return GetRandomOfGroup(group, type, whichModuleSpace);
 
-        // Now get the groups of the specified module (official or not)
-        foundAny = GetAllOfGroup(entityList, group, type, whichModuleSpace) || foundAny;
+    // The indexed group lists of each module we'll select a random one from, without copying them together
+    vector<const vector<Entity *> *> groupLists;
+    int totalCount = 0;
+
+    // Get all entitys of the specific group the official modules loaded before the specified one, and then of the specified module (official or not)
+    for (int module = 0; module < m_OfficialModuleCount && module < whichModuleSpace; ++module)
+    {
+        groupLists.push_back(&m_pDataModules[module]->GetPresetsOfGroup(group, type));
+        totalCount += groupLists.back()->size();
     }
+    RTEAssert(whichModuleSpace < m_pDataModules.size(), "Trying to get from an out of bounds DataModule ID!");
+    groupLists.push_back(&m_pDataModules[whichModuleSpace]->GetPresetsOfGroup(group, type));
+    totalCount += groupLists.back()->size();
 
     // Didn't find any of that group in those module(s)
-    if (!foundAny)
+    if (totalCount == 0)
         return 0;
 
     // Pick one and return it
-    int current = 0;
-    int selection = SelectRand(0, entityList.size() - 1);
-    for (list<Entity *>::iterator itr = entityList.begin(); itr != entityList.end(); ++itr)
+    return PickFromGroupLists(groupLists, SelectRand(0, totalCount - 1));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PickFromGroupLists
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the Entity at a specific position of several lists of Entities
+//                  laid end to end.
+
+Entity * PresetMan::PickFromGroupLists(const vector<const vector<Entity *> *> &groupLists, int selection) const
+{
+    for (vector<const vector<Entity *> *>::const_iterator listItr = groupLists.begin(); listItr != groupLists.end(); ++listItr)
     {
-        if (current == selection)
-            return (*itr);
-        current++;
+        if (selection < static_cast<int>((*listItr)->size()))
+            return (**listItr)[selection];
+        selection -= (*listItr)->size();
     }
 
     RTEAssert(0, "Tried selecting randomly but didn't?");
@@ -21,6 +21,7 @@
 //#include "Serializable.h"
 #include "Entity.h"
 #include "Actor.h"
+#include "FilePrefetcher.h"
 //#include "FrameMan.h"
 //#include "SceneMan.h"
 //#include "Vector.h"
@@ -169,6 +170,14 @@ public:
 	/// <param name="moduleName">Name of the module to load.</param>
 	void SetSingleModuleToLoad(std::string moduleName) { m_SingleModuleToLoad = moduleName; }
 
+	/// <summary>
+	/// Takes the contents of a file that was read in ahead while loading all the DataModules, so it doesn't have to be read from disk.
+	/// </summary>
+	/// <param name="filePath">The path of the file.</param>
+	/// <param name="fileData">Filled with the contents of the file, if it was read in.</param>
+	/// <returns>Whether the file was read in ahead and its contents were taken. If not, it should be read from disk as usual.</returns>
+	bool TakePrefetchedFile(const std::string &filePath, std::vector<char> &fileData) { return m_FilePrefetcher.TakeFile(filePath, fileData); }
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetDataModule
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -267,6 +276,35 @@ public:
     // Helper for passing in string module name instead of ID
     const Entity * GetEntityPreset(std::string type, std::string preset, std::string module) { return GetEntityPreset(type, preset, GetModuleID(module)); }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPresetHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a handle to a previously read in (defined) Entity, by type and
+//                  instance name. The handle can be used to get the same Entity again
+//                  with GetPresetFromHandle without looking it up by name, eg to spawn
+//                  it from Lua over and over. The same Entity always gets the same handle.
+// Arguments:       The type name of the derived Entity.
+//                  The instance name of the derived Entity instance.
+//                  The name of the module to try to get the entity from. If it's not
+//                  found there, the official modules will be searched also.
+// Return value:    The handle of the requested Entity, or -1 if no Entity with that
+//                  derived type or instance name was found.
+
+    int GetPresetHandle(std::string type, std::string preset, std::string module);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetPresetFromHandle
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a previously read in (defined) Entity from a handle gotten from
+//                  GetPresetHandle.
+// Arguments:       The handle of the Entity.
+// Return value:    A pointer to the Entity, or 0 if the handle isn't valid. Ownership is
+//                  NOT transferred!
+
+    const Entity * GetPresetFromHandle(int presetHandle) const { return (presetHandle >= 0 && presetHandle < static_cast<int>(m_PresetHandles.size())) ? m_PresetHandles[presetHandle] : 0; }
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetEntityPreset
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -534,10 +572,27 @@ protected:
 
 	std::string m_SingleModuleToLoad; //!< Name of the single module to load after the official modules.
 
+	FilePrefetcher m_FilePrefetcher; //!< Reads the files of DataModules in ahead of them being loaded, while loading all of them.
+
     // List of all Entity groups ever registered, all uniques
     // This is just a handy total of all the groups registered in all the individual DataModule:s
     std::list<std::string> m_TotalGroupRegister;
 
+	std::vector<const Entity *> m_PresetHandles; //!< Every preset a handle was given out for, indexed by handle.
+	std::unordered_map<const Entity *, int> m_PresetHandleIDs; //!< The handle given out for each preset, so the same preset always gets the same one.
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PickFromGroupLists
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the Entity at a specific position of several lists of Entities
+//                  laid end to end, as if they were one list.
+// Arguments:       The lists of Entities, in order.
+//                  The position of the Entity to get, counting through all the lists.
+// Return value:    The Entity at that position. Ownership is NOT transferred!
+
+    Entity * PickFromGroupLists(const std::vector<const std::vector<Entity *> *> &groupLists, int selection) const;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Private member variable and method declarations
@@ -0,0 +1,365 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            ProfilerMan.cpp
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Source file for the ProfilerMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+
+#include "ProfilerMan.h"
+#include "TimerMan.h"
+#include "ConsoleMan.h"
+#include "RTETools.h"
+
+using namespace std;
+
+namespace RTE
+{
+
+const string ProfilerMan::m_ClassName = "ProfilerMan";
+
+// The record of the calling thread, and which incarnation of the ProfilerMan it was made by so
+// records thrown away by Destroy aren't used again
+static thread_local void *s_pThreadRecord = 0;
+static thread_local unsigned int s_ThreadRecordGeneration = 0;
+// Bumped every time the ProfilerMan is cleared. Starts at 1 so fresh threads never match
+static std::atomic<unsigned int> s_RecordGeneration(1);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this ProfilerMan, effectively
+//                  resetting the members of this abstraction level only.
+
+void ProfilerMan::Clear()
+{
+    m_ZoneNames.clear();
+    m_ZoneIDs.clear();
+    m_ThreadRecords.clear();
+    ++s_RecordGeneration;
+    m_Capturing = false;
+    m_PendingCaptureFrames = 0;
+    m_CapturedFrames = 0;
+    m_CaptureFrameCount = 0;
+    m_CaptureStartTime = 0;
+    m_CaptureFileName.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the ProfilerMan object ready for use.
+
+int ProfilerMan::Create()
+{
+    SetThreadName("Main");
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destroys and resets (through Clear()) the ProfilerMan object.
+
+void ProfilerMan::Destroy()
+{
+    m_Capturing = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_ZoneMutex);
+        for (vector<ThreadRecord *>::iterator itr = m_ThreadRecords.begin(); itr != m_ThreadRecords.end(); ++itr)
+            delete (*itr);
+        m_ThreadRecords.clear();
+    }
+
+    Clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the ID of a named zone, registering it the first time the name is
+//                  seen.
+
+int ProfilerMan::RegisterZone(const string &zoneName)
+{
+    std::lock_guard<std::mutex> lock(m_ZoneMutex);
+
+    unordered_map<string, int>::iterator itr = m_ZoneIDs.find(zoneName);
+    if (itr != m_ZoneIDs.end())
+        return itr->second;
+
+    int zoneID = m_ZoneNames.size();
+    m_ZoneNames.push_back(zoneName);
+    m_ZoneIDs.insert(pair<string, int>(zoneName, zoneID));
+    return zoneID;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetThreadName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Names the calling thread in the traces.
+
+void ProfilerMan::SetThreadName(const string &threadName)
+{
+    ThreadRecord *pRecord = GetThreadRecord();
+    std::lock_guard<std::mutex> lock(pRecord->m_EventMutex);
+    pRecord->m_ThreadName = threadName;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BeginZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Enters a zone on the calling thread.
+
+void ProfilerMan::BeginZone(int zoneID)
+{
+    GetThreadRecord()->m_OpenZones.push_back(pair<int, int64_t>(zoneID, g_TimerMan.GetAbsoulteTime()));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EndZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Leaves the zone last entered on the calling thread, recording it.
+
+void ProfilerMan::EndZone()
+{
+    int64_t endTime = g_TimerMan.GetAbsoulteTime();
+    ThreadRecord *pRecord = GetThreadRecord();
+    if (pRecord->m_OpenZones.empty())
+        return;
+
+    ZoneEvent zoneEvent;
+    zoneEvent.m_ZoneID = pRecord->m_OpenZones.back().first;
+    zoneEvent.m_StartTime = pRecord->m_OpenZones.back().second - m_CaptureStartTime;
+    zoneEvent.m_Duration = endTime - pRecord->m_OpenZones.back().second;
+    pRecord->m_OpenZones.pop_back();
+
+    std::lock_guard<std::mutex> lock(pRecord->m_EventMutex);
+    pRecord->m_Events.push_back(zoneEvent);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CaptureTrace
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts recording every zone entered for a number of sim updates,
+//                  beginning with the next one.
+
+int ProfilerMan::CaptureTrace(int frameCount, const string &fileName)
+{
+    if (frameCount <= 0 || fileName.empty())
+    {
+        g_ConsoleMan.PrintString("ERROR: Need a positive number of sim updates and a file name to capture a profiler trace!");
+        return -1;
+    }
+    if (IsCapturing() || m_PendingCaptureFrames > 0)
+    {
+        g_ConsoleMan.PrintString("ERROR: A profiler trace is already being captured!");
+        return -1;
+    }
+
+    m_PendingCaptureFrames = frameCount;
+    m_CaptureFileName = fileName;
+    g_ConsoleMan.PrintString("Capturing a profiler trace of the next " + std::to_string(frameCount) + " sim updates...");
+
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StopCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Ends the capture in progress early, and writes out what was recorded
+//                  so far.
+
+void ProfilerMan::StopCapture()
+{
+    m_PendingCaptureFrames = 0;
+    if (IsCapturing())
+        m_CaptureFrameCount = m_CapturedFrames;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          NewFrame
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the start of a new sim update, starting or finishing captures as
+//                  needed.
+
+void ProfilerMan::NewFrame()
+{
+    if (IsCapturing() && ++m_CapturedFrames >= m_CaptureFrameCount)
+        FinishCapture();
+
+    if (!IsCapturing() && m_PendingCaptureFrames > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_ZoneMutex);
+            for (vector<ThreadRecord *>::iterator itr = m_ThreadRecords.begin(); itr != m_ThreadRecords.end(); ++itr)
+            {
+                std::lock_guard<std::mutex> eventLock((*itr)->m_EventMutex);
+                (*itr)->m_Events.clear();
+            }
+        }
+
+        m_CaptureFrameCount = m_PendingCaptureFrames;
+        m_PendingCaptureFrames = 0;
+        m_CapturedFrames = 0;
+        m_CaptureStartTime = g_TimerMan.GetAbsoulteTime();
+        m_Capturing.store(true);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetThreadRecord
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the record of the calling thread, making one the first time.
+
+ProfilerMan::ThreadRecord * ProfilerMan::GetThreadRecord()
+{
+    if (s_pThreadRecord && s_ThreadRecordGeneration == s_RecordGeneration.load())
+        return static_cast<ThreadRecord *>(s_pThreadRecord);
+
+    ThreadRecord *pRecord = new ThreadRecord;
+    {
+        std::lock_guard<std::mutex> lock(m_ZoneMutex);
+        pRecord->m_ThreadID = m_ThreadRecords.size();
+        pRecord->m_ThreadName = "Thread " + std::to_string(pRecord->m_ThreadID);
+        m_ThreadRecords.push_back(pRecord);
+    }
+
+    s_pThreadRecord = pRecord;
+    s_ThreadRecordGeneration = s_RecordGeneration.load();
+    return pRecord;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FinishCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops recording, writes out the trace and prints the summary.
+
+void ProfilerMan::FinishCapture()
+{
+    m_Capturing.store(false);
+
+    // Take the events out so other threads can't add to them while they're being written
+    vector<vector<ZoneEvent>> threadEvents;
+    {
+        std::lock_guard<std::mutex> lock(m_ZoneMutex);
+        threadEvents.resize(m_ThreadRecords.size());
+        for (int thread = 0; thread < m_ThreadRecords.size(); ++thread)
+        {
+            std::lock_guard<std::mutex> eventLock(m_ThreadRecords[thread]->m_EventMutex);
+            threadEvents[thread].swap(m_ThreadRecords[thread]->m_Events);
+        }
+    }
+
+    if (WriteTrace(threadEvents))
+        g_ConsoleMan.PrintString("Profiler trace of " + std::to_string(m_CapturedFrames) + " sim updates written to " + m_CaptureFileName);
+    else
+        g_ConsoleMan.PrintString("ERROR: Couldn't write the profiler trace to " + m_CaptureFileName + "!");
+
+    PrintSummary(threadEvents);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteTrace
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the recorded events of all threads to a Chrome trace file.
+
+bool ProfilerMan::WriteTrace(const vector<vector<ZoneEvent>> &threadEvents) const
+{
+    ofstream traceFile(m_CaptureFileName);
+    if (!traceFile.good())
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_ZoneMutex);
+
+    traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool firstEvent = true;
+    for (int thread = 0; thread < threadEvents.size(); ++thread)
+    {
+        traceFile << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\"" << EscapeJSONString(m_ThreadRecords[thread]->m_ThreadName) << "\"}}";
+        firstEvent = false;
+
+        for (vector<ZoneEvent>::const_iterator itr = threadEvents[thread].begin(); itr != threadEvents[thread].end(); ++itr)
+            traceFile << ",\n{\"name\":\"" << EscapeJSONString(m_ZoneNames[itr->m_ZoneID]) << "\",\"cat\":\"RTE\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << itr->m_StartTime << ",\"dur\":" << itr->m_Duration << "}";
+    }
+    traceFile << "\n]}\n";
+
+    return traceFile.good();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrintSummary
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prints the zones that took the most time per sim update on average to
+//                  the console, not counting time spent in nested zones.
+
+void ProfilerMan::PrintSummary(const vector<vector<ZoneEvent>> &threadEvents) const
+{
+    std::lock_guard<std::mutex> lock(m_ZoneMutex);
+
+    vector<int64_t> selfTimes(m_ZoneNames.size(), 0);
+    vector<int> callCounts(m_ZoneNames.size(), 0);
+
+    // Events are recorded as they end, so the nested zones of each event come right before it. Keep the
+    // ones not yet claimed by an enclosing zone on a stack, and take the time of those that started after
+    // each event off its own
+    vector<const ZoneEvent *> unclaimedEvents;
+    for (int thread = 0; thread < threadEvents.size(); ++thread)
+    {
+        unclaimedEvents.clear();
+        for (vector<ZoneEvent>::const_iterator itr = threadEvents[thread].begin(); itr != threadEvents[thread].end(); ++itr)
+        {
+            int64_t selfTime = itr->m_Duration;
+            while (!unclaimedEvents.empty() && unclaimedEvents.back()->m_StartTime >= itr->m_StartTime)
+            {
+                selfTime -= unclaimedEvents.back()->m_Duration;
+                unclaimedEvents.pop_back();
+            }
+            unclaimedEvents.push_back(&(*itr));
+            selfTimes[itr->m_ZoneID] += selfTime;
+            ++callCounts[itr->m_ZoneID];
+        }
+    }
+
+    vector<int> zoneOrder;
+    for (int zone = 0; zone < selfTimes.size(); ++zone)
+    {
+        if (callCounts[zone] > 0)
+            zoneOrder.push_back(zone);
+    }
+    sort(zoneOrder.begin(), zoneOrder.end(), [&selfTimes](int lhs, int rhs) { return selfTimes[lhs] > selfTimes[rhs]; });
+
+    int frameCount = max(m_CapturedFrames, 1);
+    g_ConsoleMan.PrintString("Most expensive zones, in self time per sim update:");
+    char line[512];
+    for (int i = 0; i < zoneOrder.size() && i < 10; ++i)
+    {
+        int zone = zoneOrder[i];
+        std::snprintf(line, sizeof(line), "%8.3f ms  %6d calls  %s", static_cast<double>(selfTimes[zone]) / (1000.0 * frameCount), callCounts[zone] / frameCount, m_ZoneNames[zone].c_str());
+        g_ConsoleMan.PrintString(line);
+    }
+}
+
+} // namespace RTE
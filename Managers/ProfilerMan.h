@@ -0,0 +1,352 @@
+#ifndef _RTEProfilerMan_
+#define _RTEProfilerMan_
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// File:            ProfilerMan.h
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Header file for the ProfilerMan class.
+// Project:         Retro Terrain Engine
+// Author(s):
+//
+//
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inclusions of header files
+
+#include "Singleton.h"
+#define g_ProfilerMan ProfilerMan::Instance()
+
+namespace RTE
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           ProfilerMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The centralized singleton manager of the zone profiler. Zones are named
+//                  spans of code registered at runtime, which can be nested and entered
+//                  from any thread. While a capture is running, every zone entered is
+//                  recorded with its thread, start time and duration, and when the capture
+//                  is done the whole thing is written out in the Chrome trace event format
+//                  (open it in chrome://tracing or ui.perfetto.dev). When no capture is
+//                  running, entering a zone costs one atomic load.
+// Parent(s):       Singleton
+// Class history:   10/18/2020  ProfilerMan created.
+
+
+class ProfilerMan:
+    public Singleton<ProfilerMan>
+{
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Public member variable, method and friend function declarations
+
+public:
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Constructor:     ProfilerMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Constructor method used to instantiate a ProfilerMan object in system
+//                  memory. Create() should be called before using the object.
+// Arguments:       None.
+
+    ProfilerMan() { Clear(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Destructor:      ~ProfilerMan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destructor method used to clean up a ProfilerMan object before deletion
+//                  from system memory.
+// Arguments:       None.
+
+    virtual ~ProfilerMan() { Destroy(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Create
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes the ProfilerMan object ready for use. Has to be called from the
+//                  main thread, which is named as such in the traces.
+// Arguments:       None.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    virtual int Create();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  Reset
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Resets the entire ProfilerMan, including its inherited members, to
+//                  their default settings or values.
+// Arguments:       None.
+// Return value:    None.
+
+    virtual void Reset() { Destroy(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Destroy
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Destroys and resets (through Clear()) the ProfilerMan object. Any
+//                  capture in progress is thrown away.
+// Arguments:       None.
+// Return value:    None.
+
+    void Destroy();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Virtual method:  GetClassName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the class name of this Entity.
+// Arguments:       None.
+// Return value:    A string with the friendly-formatted type name of this object.
+
+    virtual const std::string & GetClassName() const { return m_ClassName; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the ID of a named zone, registering it the first time the name is
+//                  seen. Involves a lookup under a lock, so the ID should be kept around,
+//                  eg in a function-local static, rather than registered every time.
+//                  Thread safe.
+// Arguments:       The name of the zone, as it should show up in the traces.
+// Return value:    The ID of the zone, valid until this is destroyed.
+
+    int RegisterZone(const std::string &zoneName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetThreadName
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Names the calling thread in the traces. Threads that aren't named show
+//                  up by number.
+// Arguments:       The name of the calling thread.
+// Return value:    None.
+
+    void SetThreadName(const std::string &threadName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsCapturing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether zones entered right now are being recorded.
+// Arguments:       None.
+// Return value:    Whether a capture is in progress.
+
+    bool IsCapturing() const { return m_Capturing.load(std::memory_order_acquire); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          BeginZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Enters a zone on the calling thread. Has to be matched with an EndZone
+//                  on the same thread, and zones have to be ended in the reverse order they
+//                  were begun. Should only be called if IsCapturing, ProfileZone takes care
+//                  of all this.
+// Arguments:       The ID of the zone to enter, as gotten from RegisterZone.
+// Return value:    None.
+
+    void BeginZone(int zoneID);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EndZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Leaves the zone last entered on the calling thread, recording it.
+// Arguments:       None.
+// Return value:    None.
+
+    void EndZone();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CaptureTrace
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Starts recording every zone entered for a number of sim updates,
+//                  beginning with the next one. The trace is written to a file once done,
+//                  and a summary of the most expensive zones printed to the console.
+// Arguments:       How many sim updates to capture.
+//                  The path of the file to write the trace to.
+// Return value:    An error return value signaling sucess or any particular failure.
+//                  Anything below 0 is an error signal.
+
+    int CaptureTrace(int frameCount, const std::string &fileName);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          StopCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Ends the capture in progress early, at the start of the next sim update,
+//                  and writes out what was recorded so far.
+// Arguments:       None.
+// Return value:    None.
+
+    void StopCapture();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          NewFrame
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Marks the start of a new sim update, starting or finishing captures as
+//                  needed. Has to be called from the main thread, outside of any zone.
+// Arguments:       None.
+// Return value:    None.
+
+    void NewFrame();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protected member variable and method declarations
+
+protected:
+
+    // A zone that was entered and left while capturing
+    struct ZoneEvent
+    {
+        int m_ZoneID;
+        // When the zone was entered, in microseconds since the capture started
+        int64_t m_StartTime;
+        int64_t m_Duration;
+    };
+
+    // Everything recorded on a single thread. Only ever touched by that thread, except under
+    // m_EventMutex when the events are collected
+    struct ThreadRecord
+    {
+        int m_ThreadID;
+        std::string m_ThreadName;
+        // The zones currently entered on the thread, and when they were
+        std::vector<std::pair<int, int64_t>> m_OpenZones;
+        std::vector<ZoneEvent> m_Events;
+        std::mutex m_EventMutex;
+    };
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetThreadRecord
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the record of the calling thread, making one the first time.
+// Arguments:       None.
+// Return value:    The calling thread's record. Ownership is NOT transferred!
+
+    ThreadRecord * GetThreadRecord();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FinishCapture
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Stops recording, writes out the trace and prints the summary.
+// Arguments:       None.
+// Return value:    None.
+
+    void FinishCapture();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WriteTrace
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Writes the recorded events of all threads to a Chrome trace file.
+// Arguments:       The events of each thread, in the same order as m_ThreadRecords.
+// Return value:    Whether the file was written successfully.
+
+    bool WriteTrace(const std::vector<std::vector<ZoneEvent>> &threadEvents) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrintSummary
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Prints the zones that took the most time per sim update on average to
+//                  the console, not counting time spent in nested zones.
+// Arguments:       The events of each thread, in the same order as m_ThreadRecords.
+// Return value:    None.
+
+    void PrintSummary(const std::vector<std::vector<ZoneEvent>> &threadEvents) const;
+
+
+    // Member variables
+    static const std::string m_ClassName;
+
+    // Guards the zone names and the thread records list
+    mutable std::mutex m_ZoneMutex;
+    // The names of all registered zones, indexed by zone ID, and the other way around
+    std::vector<std::string> m_ZoneNames;
+    std::unordered_map<std::string, int> m_ZoneIDs;
+    // The records of every thread that has entered a zone or been named. Owned
+    std::vector<ThreadRecord *> m_ThreadRecords;
+
+    // Whether zones are being recorded right now
+    std::atomic<bool> m_Capturing;
+    // How many more sim updates to start recording for, 0 if no capture has been asked for
+    int m_PendingCaptureFrames;
+    // How many sim updates have been recorded so far, and how many to record in total
+    int m_CapturedFrames;
+    int m_CaptureFrameCount;
+    // When the capture started, in absolute microseconds
+    int64_t m_CaptureStartTime;
+    // Where the trace of the current capture is written to
+    std::string m_CaptureFileName;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Private member variable and method declarations
+
+private:
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Clear
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Clears all the member variables of this ProfilerMan, effectively
+//                  resetting the members of this abstraction level only.
+// Arguments:       None.
+// Return value:    None.
+
+    void Clear();
+
+
+    // Disallow the use of some implicit methods.
+    ProfilerMan(const ProfilerMan &reference);
+    ProfilerMan & operator=(const ProfilerMan &rhs);
+
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Class:           ProfileZone
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Enters a profiler zone for as long as it's in scope, if a capture is in
+//                  progress when it's made. Usage:
+//                      static const int s_ZoneID = g_ProfilerMan.RegisterZone("Name");
+//                      ProfileZone profileZone(s_ZoneID);
+// Parent(s):       None.
+// Class history:   10/18/2020  ProfileZone created.
+
+class ProfileZone
+{
+
+public:
+
+    explicit ProfileZone(int zoneID) : m_Entered(g_ProfilerMan.IsCapturing()) { if (m_Entered) { g_ProfilerMan.BeginZone(zoneID); } }
+
+    ~ProfileZone() { if (m_Entered) { g_ProfilerMan.EndZone(); } }
+
+private:
+
+    // Whether the zone was entered, so it's left even if the capture ended in the meantime
+    bool m_Entered;
+
+    // Disallow the use of some implicit methods.
+    ProfileZone(const ProfileZone &reference);
+    ProfileZone & operator=(const ProfileZone &rhs);
+
+};
+
+} // namespace RTE
+
+#endif // File
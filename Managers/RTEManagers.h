@@ -12,6 +12,8 @@
 
 #include "SettingsMan.h"
 #include "TimerMan.h"
+#include "ThreadMan.h"
+#include "ProfilerMan.h"
 #include "FrameMan.h"
 #include "PresetMan.h"
 #include "AudioMan.h"
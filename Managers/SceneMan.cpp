@@ -18,6 +18,8 @@
 #include "UInputMan.h"
 #include "ConsoleMan.h"
 #include "SettingsMan.h"
+#include "ThreadMan.h"
+#include "ProfilerMan.h"
 #include "Scene.h"
 #include "SLTerrain.h"
 #include "TerrainObject.h"
@@ -31,6 +33,9 @@
 // Temp
 #include "Controller.h"
 
+#include <emmintrin.h>
+#include <algorithm>
+
 namespace RTE
 {
 
@@ -40,6 +45,166 @@ namespace RTE
 const std::string SceneMan::m_ClassName = "SceneMan";
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static function: RowIsAll
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a run of 8 or 16 bit pixels all have the same value,
+//                  comparing 16 bytes at a time.
+
+static bool RowIsAll(const unsigned char *pRow, int count, unsigned char value)
+{
+    const __m128i values = _mm_set1_epi8(static_cast<char>(value));
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pRow + x)), values)) != 0xFFFF)
+            return false;
+    }
+    for (; x < count; ++x)
+    {
+        if (pRow[x] != value)
+            return false;
+    }
+    return true;
+}
+
+static bool RowIsAll(const unsigned short *pRow, int count, unsigned short value)
+{
+    const __m128i values = _mm_set1_epi16(static_cast<short>(value));
+    int x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pRow + x)), values)) != 0xFFFF)
+            return false;
+    }
+    for (; x < count; ++x)
+    {
+        if (pRow[x] != value)
+            return false;
+    }
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static function: SameSceneView
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether two SceneSamplers look at the same bitmaps the same way.
+
+static bool SameSceneView(const SceneSampler &first, const SceneSampler &second)
+{
+    return first.m_ppMaterialRows == second.m_ppMaterialRows && first.m_ppMOIDRows == second.m_ppMOIDRows &&
+           first.m_Width == second.m_Width && first.m_Height == second.m_Height && first.m_MOIDWidth == second.m_MOIDWidth && first.m_MOIDHeight == second.m_MOIDHeight &&
+           first.m_WrapsX == second.m_WrapsX && first.m_WrapsY == second.m_WrapsY;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static function: GetRayTileSpans
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the ranges of ray tile indices that an inclusive pixel range
+//                  touches along one axis, splitting it at the seam if it wraps. Returns
+//                  how many ranges there are, 0 if it's entirely out of bounds.
+
+static int GetRayTileSpans(int low, int high, int size, bool wraps, int tileSize, int spans[2][2])
+{
+    if (high < low || size <= 0)
+        return 0;
+
+    if (!wraps)
+    {
+        low = MAX(low, 0);
+        high = MIN(high, size - 1);
+        if (high < low)
+            return 0;
+        spans[0][0] = low / tileSize;
+        spans[0][1] = high / tileSize;
+        return 1;
+    }
+
+    // A range at least a whole scene across covers all of it
+    if (high - low + 1 >= size)
+    {
+        spans[0][0] = 0;
+        spans[0][1] = (size - 1) / tileSize;
+        return 1;
+    }
+
+    int length = high - low;
+    low %= size;
+    if (low < 0)
+        low += size;
+    high = low + length;
+
+    spans[0][0] = low / tileSize;
+    spans[0][1] = MIN(high, size - 1) / tileSize;
+    if (high < size)
+        return 1;
+
+    spans[1][0] = 0;
+    spans[1][1] = (high - size) / tileSize;
+    return 2;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Static function: AddTriangleSpans
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds a run for every row of pixels a triangle touches, from the leftmost
+//                  to the rightmost pixel it touches on that row. Thin triangles still get
+//                  a run on every row they pass through.
+
+static void AddTriangleSpans(std::vector<VisibilityFan::Span> &spans, const Vector &cornerA, const Vector &cornerB, const Vector &cornerC)
+{
+    const Vector *corners[3] = { &cornerA, &cornerB, &cornerC };
+    int topRow = static_cast<int>(floorf(MIN(cornerA.m_Y, MIN(cornerB.m_Y, cornerC.m_Y))));
+    int bottomRow = static_cast<int>(floorf(MAX(cornerA.m_Y, MAX(cornerB.m_Y, cornerC.m_Y))));
+
+    for (int row = topRow; row <= bottomRow; ++row)
+    {
+        float rowTop = static_cast<float>(row);
+        float rowBottom = rowTop + 1.0F;
+        float leftX = 0;
+        float rightX = 0;
+        bool touched = false;
+
+        // The triangle's extent across the row is where its edges enter and leave it
+        for (int edge = 0; edge < 3; ++edge)
+        {
+            const Vector &edgeStart = *corners[edge];
+            const Vector &edgeEnd = *corners[(edge + 1) % 3];
+            float edgeTop = MIN(edgeStart.m_Y, edgeEnd.m_Y);
+            float edgeBottom = MAX(edgeStart.m_Y, edgeEnd.m_Y);
+            if (edgeBottom < rowTop || edgeTop > rowBottom)
+                continue;
+
+            float enterX = edgeStart.m_X;
+            float leaveX = edgeEnd.m_X;
+            float edgeHeight = edgeEnd.m_Y - edgeStart.m_Y;
+            if (fabs(edgeHeight) > 0.0001F)
+            {
+                float slope = (edgeEnd.m_X - edgeStart.m_X) / edgeHeight;
+                enterX = edgeStart.m_X + (MAX(edgeTop, rowTop) - edgeStart.m_Y) * slope;
+                leaveX = edgeStart.m_X + (MIN(edgeBottom, rowBottom) - edgeStart.m_Y) * slope;
+            }
+            if (!touched)
+            {
+                leftX = rightX = enterX;
+                touched = true;
+            }
+            leftX = MIN(leftX, MIN(enterX, leaveX));
+            rightX = MAX(rightX, MAX(enterX, leaveX));
+        }
+
+        if (touched)
+        {
+            VisibilityFan::Span span = { row, static_cast<int>(floorf(leftX)), static_cast<int>(floorf(rightX)) };
+            spans.push_back(span);
+        }
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IntersectionCut
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -77,8 +242,17 @@ void SceneMan::Clear()
     m_pCurrentScene = 0;
     m_pMOColorLayer = 0;
     m_pMOIDLayer = 0;
+    m_MOColorDrawnArea = IntRect();
+    m_SceneSampler = SceneSampler();
+    m_SceneSamplerLocked = false;
+    m_aRayTiles = 0;
+    m_RayTileCountX = 0;
+    m_RayTileCountY = 0;
+    m_RayTileStamp = 0;
+    m_RayTileSampler = SceneSampler();
     m_MOIDDrawings.clear();
     m_PostSceneEffects.clear();
+    m_RegisterPostEffects = true;
     m_pDebugLayer = 0;
     m_LastRayHitPos.Reset();
 
@@ -105,14 +279,18 @@ void SceneMan::Clear()
     }
 
     m_pUnseenRevealSound = 0;
+    m_VisibilityFansEnabled = false;
+    m_VisibilityFans.clear();
+    m_VisibilityFanCount = 0;
     m_LastUpdatedScreen = 0;
     m_SecondStructPass = false;
 //    m_CalcTimer.Reset();
     m_CleanTimer.Reset();
 
-	if (m_pOrphanSearchBitmap)
-		destroy_bitmap(m_pOrphanSearchBitmap);
-	m_pOrphanSearchBitmap = create_bitmap_ex(8, MAXORPHANRADIUS , MAXORPHANRADIUS);
+    m_ComponentSearchStamps.clear();
+    m_ComponentSearchGeneration = 0;
+    m_ComponentSearchStack.clear();
+    m_OrphanComponent.m_Pixels.clear();
 }
 
 /*
@@ -163,6 +341,29 @@ Material * SceneMan::AddMaterialCopy(Material *mat)
 	return matCopy;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RemoveModuleMaterials
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes all the Material:s a DataModule added to the palette, freeing
+//                  up their slots, for when the DataModule is loaded over again.
+
+void SceneMan::RemoveModuleMaterials(int whichModule)
+{
+    for (int i = 0; i < c_PaletteEntriesNumber; ++i)
+    {
+        if (m_apMatPalette[i] && m_apMatPalette[i]->GetModuleID() == whichModule)
+        {
+            map<std::string, unsigned char>::iterator itr = m_MatNameMap.find(m_apMatPalette[i]->GetPresetName());
+            if (itr != m_MatNameMap.end() && (*itr).second == i)
+                m_MatNameMap.erase(itr);
+
+            delete m_apMatPalette[i];
+            m_apMatPalette[i] = 0;
+            --m_MaterialCount;
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  LoadScene
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -174,12 +375,21 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits)
     if (!pNewScene)
         return -1;
 
+    static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("SceneMan::LoadScene");
+    ProfileZone profileZone(s_ProfilerZoneID);
+
     // Unload and destroy any scene we might have loaded already
     if (m_pCurrentScene)
     {
         delete m_pCurrentScene;
         m_pCurrentScene = 0;
     }
+    // The new terrain may well end up at the same addresses as the old one, so the ray tiles can't tell on their own
+    delete[] m_aRayTiles;
+    m_aRayTiles = 0;
+    m_RayTileSampler = SceneSampler();
+    // Fans queued in the old scene have nothing to reveal in the new one
+    m_VisibilityFanCount = 0;
 
     // Clear out all the MO's in the scene
     g_MovableMan.PurgeAllMOs();
@@ -225,6 +435,7 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits)
     clear_to_color(pBitmap, g_KeyColor);
     m_pMOColorLayer = new SceneLayer();
     m_pMOColorLayer->Create(pBitmap, true, Vector(), m_pCurrentScene->WrapsX(), m_pCurrentScene->WrapsY(), Vector(1.0, 1.0));
+    m_MOColorDrawnArea = IntRect(0, 0, pBitmap->w - 1, pBitmap->h - 1);
     pBitmap = 0;
 
     // Re-create the MoveableObject:s ID SceneLayer
@@ -329,7 +540,7 @@ int SceneMan::LoadScene(std::string sceneName, bool placeObjects, bool placeUnit
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int SceneMan::ReadProperty(std::string propName, Reader &reader)
+int SceneMan::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "AddScene")
         g_PresetMan.GetEntityPreset(reader);
@@ -381,6 +592,8 @@ int SceneMan::ReadProperty(std::string propName, Reader &reader)
             }
         }
     }
+    else if (propName == "EnableVisibilityFans")
+        reader >> m_VisibilityFansEnabled;
     else
         // See if the base class(es) can find a match instead
         return Serializable::ReadProperty(propName, reader);
@@ -439,9 +652,7 @@ void SceneMan::Destroy()
     delete m_pMOIDLayer;
     delete m_pMOColorLayer;
     delete m_pUnseenRevealSound;
-
-	destroy_bitmap(m_pOrphanSearchBitmap);
-	m_pOrphanSearchBitmap = 0;
+    delete[] m_aRayTiles;
 
     Clear();
 }
@@ -595,6 +806,9 @@ bool SceneMan::MOIDClearCheck()
 
 unsigned char SceneMan::GetTerrMatter(int pixelX, int pixelY)
 {
+    if (m_SceneSamplerLocked)
+        return m_SceneSampler.GetTerrMatter(pixelX, pixelY);
+
     RTEAssert(m_pCurrentScene, "Trying to get terrain matter before there is a scene or terrain!");
 
     WrapPosition(pixelX, pixelY);
@@ -623,6 +837,9 @@ unsigned char SceneMan::GetTerrMatter(int pixelX, int pixelY)
 
 MOID SceneMan::GetMOIDPixel(int pixelX, int pixelY)
 {
+    if (m_SceneSamplerLocked)
+        return m_SceneSampler.GetMOIDPixel(pixelX, pixelY);
+
     WrapPosition(pixelX, pixelY);
 
     if (pixelX < 0 ||
@@ -652,6 +869,23 @@ Material const * SceneMan::GetMaterial(const std::string &matName)
         return m_apMatPalette[(*itr).second];
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetWeakestMaterialStrength
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the lowest strength of all the non-air Material:s in the palette.
+
+float SceneMan::GetWeakestMaterialStrength() const
+{
+    float weakestStrength = FLT_MAX;
+    for (int i = 0; i < c_PaletteEntriesNumber; ++i)
+    {
+        if (i != g_MaterialAir && m_apMatPalette[i])
+            weakestStrength = MIN(weakestStrength, m_apMatPalette[i]->strength);
+    }
+    return weakestStrength;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetGlobalAcc
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -850,6 +1084,12 @@ void SceneMan::LockScene()
         m_pCurrentScene->Lock();
         m_pMOColorLayer->LockBitmaps();
         m_pMOIDLayer->LockBitmaps();
+
+        // The bitmaps can't be swapped out while locked, so the view stays good until unlocked
+        m_SceneSampler = CaptureSceneSampler();
+        m_SceneSamplerLocked = true;
+        // Anything could have been drawn since the last lock, so the ray tiles have to be looked at again
+        PrepareRayTiles(m_SceneSampler, true);
     }
 }
 
@@ -870,6 +1110,143 @@ void SceneMan::UnlockScene()
         m_pCurrentScene->Unlock();
         m_pMOColorLayer->UnlockBitmaps();
         m_pMOIDLayer->UnlockBitmaps();
+        m_SceneSamplerLocked = false;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CaptureSceneSampler
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Captures a SceneSampler of the current state of the Scene's material
+//                  and MOID bitmaps.
+
+SceneSampler SceneMan::CaptureSceneSampler() const
+{
+    static_assert(c_MOIDLayerBitDepth == 16, "SceneSampler reads the MOID layer as 16 bpp!");
+    RTEAssert(m_pCurrentScene && m_pMOIDLayer, "Trying to sample the scene before there is one!");
+
+    BITMAP *pMaterialBitmap = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+    BITMAP *pMOIDBitmap = m_pMOIDLayer->GetBitmap();
+
+    SceneSampler sampler;
+    sampler.m_ppMaterialRows = pMaterialBitmap->line;
+    sampler.m_ppMOIDRows = pMOIDBitmap->line;
+    // The terrain is never scaled, so its bitmap dimensions are what positions get wrapped to
+    sampler.m_Width = pMaterialBitmap->w;
+    sampler.m_Height = pMaterialBitmap->h;
+    sampler.m_MOIDWidth = pMOIDBitmap->w;
+    sampler.m_MOIDHeight = pMOIDBitmap->h;
+    sampler.m_WrapsX = m_pCurrentScene->GetTerrain()->WrapsX();
+    sampler.m_WrapsY = m_pCurrentScene->GetTerrain()->WrapsY();
+    return sampler;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrepareRayTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes sure the ray tiles fit the Scene as seen by a SceneSampler,
+//                  recreating them if not, and optionally marks them all for being looked
+//                  at again.
+
+void SceneMan::PrepareRayTiles(const SceneSampler &sampler, bool newFrame)
+{
+    RTEAssert(!ThreadMan::IsInParallelJob(), "Trying to prepare the ray tiles from inside a parallel job!");
+
+    if (!sampler.m_ppMaterialRows)
+        return;
+
+    if (!m_aRayTiles || !SameSceneView(sampler, m_RayTileSampler))
+    {
+        delete[] m_aRayTiles;
+        m_RayTileSampler = sampler;
+        m_RayTileCountX = (m_RayTileSampler.m_Width + c_RayTileSize - 1) / c_RayTileSize;
+        m_RayTileCountY = (m_RayTileSampler.m_Height + c_RayTileSize - 1) / c_RayTileSize;
+        m_aRayTiles = new std::atomic<unsigned int>[m_RayTileCountX * m_RayTileCountY];
+        for (int tile = 0; tile < m_RayTileCountX * m_RayTileCountY; ++tile)
+            m_aRayTiles[tile].store(0, std::memory_order_relaxed);
+        m_RayTileStamp = 1;
+    }
+    else if (newFrame)
+    {
+        // Clear out all the old stamps once they run out, so none of them can become current again
+        if (++m_RayTileStamp >= (1U << (32 - RAYTILE_FLAGBITS)))
+        {
+            for (int tile = 0; tile < m_RayTileCountX * m_RayTileCountY; ++tile)
+                m_aRayTiles[tile].store(0, std::memory_order_relaxed);
+            m_RayTileStamp = 1;
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetRayTileFlags
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the summary flags of a ray tile, looking through its pixels first if
+//                  it hasn't been summarized this frame.
+
+unsigned int SceneMan::GetRayTileFlags(int tileX, int tileY) const
+{
+    const unsigned int flagMask = (1U << RAYTILE_FLAGBITS) - 1;
+    std::atomic<unsigned int> &tile = m_aRayTiles[tileY * m_RayTileCountX + tileX];
+    unsigned int summary = tile.load(std::memory_order_acquire);
+    if ((summary >> RAYTILE_FLAGBITS) == m_RayTileStamp)
+        return summary & flagMask;
+
+    const SceneSampler &sampler = m_RayTileSampler;
+    int left = tileX * c_RayTileSize;
+    int top = tileY * c_RayTileSize;
+    int width = MIN(left + c_RayTileSize, sampler.m_Width) - left;
+    int bottom = MIN(top + c_RayTileSize, sampler.m_Height);
+    int moidWidth = MIN(left + c_RayTileSize, sampler.m_MOIDWidth) - left;
+
+    unsigned int flags = RAYTILE_AIR | RAYTILE_NOMO;
+    for (int y = top; y < bottom && flags != 0; ++y)
+    {
+        if ((flags & RAYTILE_AIR) && !RowIsAll(sampler.m_ppMaterialRows[y] + left, width, static_cast<unsigned char>(g_MaterialAir)))
+            flags &= ~RAYTILE_AIR;
+        if ((flags & RAYTILE_NOMO) && y < sampler.m_MOIDHeight && moidWidth > 0 && !RowIsAll(reinterpret_cast<const unsigned short *>(sampler.m_ppMOIDRows[y]) + left, moidWidth, static_cast<unsigned short>(g_NoMOID)))
+            flags &= ~RAYTILE_NOMO;
+    }
+
+    // If anything marked the tile while it was being looked through, what was seen may already be out of date, so only trust what's there now
+    if (!tile.compare_exchange_strong(summary, (m_RayTileStamp << RAYTILE_FLAGBITS) | flags))
+        return (summary >> RAYTILE_FLAGBITS) == m_RayTileStamp ? (summary & flags) : 0;
+
+    return flags;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkRayTilesOccupied
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells CastRays that something may have been drawn within an area of the
+//                  terrain material or MOID layer.
+
+void SceneMan::MarkRayTilesOccupied(int left, int top, int right, int bottom, bool terrain)
+{
+    if (!m_aRayTiles)
+        return;
+
+    int spansX[2][2];
+    int spansY[2][2];
+    int spanCountX = GetRayTileSpans(left, right, m_RayTileSampler.m_Width, m_RayTileSampler.m_WrapsX, c_RayTileSize, spansX);
+    int spanCountY = GetRayTileSpans(top, bottom, m_RayTileSampler.m_Height, m_RayTileSampler.m_WrapsY, c_RayTileSize, spansY);
+
+    // Tiles that aren't current keep their stale stamp, so clearing a flag on them does no harm
+    unsigned int keptFlags = ~static_cast<unsigned int>(terrain ? RAYTILE_AIR : RAYTILE_NOMO);
+    for (int spanY = 0; spanY < spanCountY; ++spanY)
+    {
+        for (int tileY = spansY[spanY][0]; tileY <= spansY[spanY][1]; ++tileY)
+        {
+            for (int spanX = 0; spanX < spanCountX; ++spanX)
+            {
+                for (int tileX = spansX[spanX][0]; tileX <= spansX[spanX][1]; ++tileX)
+                    m_aRayTiles[tileY * m_RayTileCountX + tileX].fetch_and(keptFlags);
+            }
+        }
     }
 }
 
@@ -995,211 +1372,230 @@ int SceneMan::RemoveOrphans(int posX, int posY, int radius, int maxArea, bool re
 	if (radius > MAXORPHANRADIUS)
 		radius = MAXORPHANRADIUS;
 
-	clear_to_color(m_pOrphanSearchBitmap, g_MaterialAir);
-	int area = RemoveOrphans(posX, posY, posX, posY, 0, radius, maxArea, false);
-	if (remove && area <= maxArea)
-	{
-		clear_to_color(m_pOrphanSearchBitmap, g_MaterialAir);
-		RemoveOrphans(posX, posY, posX, posY, 0, radius, maxArea, true);
-	}
+	int area = FindTerrainComponent(posX, posY, radius, maxArea, m_OrphanComponent);
+	if (remove && m_OrphanComponent.m_Complete && area <= maxArea)
+		RemoveTerrainComponent(m_OrphanComponent);
 
 	return area;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          RemoveOrphans
+// Method:          FindTerrainComponent
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Returns the area of an orphaned region at specified coordinates. 
+// Description:     Finds the piece of terrain connected to a pixel, diagonals included,
+//                  within a square search area centered on it.
 
-int SceneMan::RemoveOrphans(int posX, int posY, 
-							int centerPosX, int centerPosY, 
-							int accumulatedArea, int radius, int maxArea, bool remove)
+int SceneMan::FindTerrainComponent(int posX, int posY, int searchSize, int maxArea, TerrainComponent &component)
 {
-	int area = 0;
-	int bmpX = 0;
-	int bmpY = 0;
-
-	BITMAP * mat = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+	component.m_Pixels.clear();
+	component.m_Bounds = IntRect(posX, posY, posX, posY);
+	component.m_Complete = false;
 
-	if (posX < 0 || posY < 0 || posX >= mat->w || posY >= mat->h) return 0;
+	// What's returned when the piece isn't orphaned, which has to be more than any area that could be asked for
+	int notOrphanedArea = MAX(searchSize * searchSize, maxArea) + 1;
+	if (searchSize <= 0)
+		return notOrphanedArea;
 
-    unsigned char materialID = _getpixel(mat, posX, posY);
-    if (materialID == g_MaterialAir && (posX != centerPosX || posY != centerPosY))
+	BITMAP *pMaterial = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+	if (posX < 0 || posY < 0 || posX >= pMaterial->w || posY >= pMaterial->h)
 		return 0;
-	else
+
+	// Start a new generation of visited stamps, only clearing them when the generation wraps around
+	if (m_ComponentSearchStamps.size() < searchSize * searchSize)
+		m_ComponentSearchStamps.resize(searchSize * searchSize, 0);
+	if (++m_ComponentSearchGeneration == 0)
 	{
-		bmpX = posX - (centerPosX - radius / 2);
-		bmpY = posY - (centerPosY - radius / 2);
+		std::fill(m_ComponentSearchStamps.begin(), m_ComponentSearchStamps.end(), 0);
+		m_ComponentSearchGeneration = 1;
+	}
 
-		// We reached the border of orphan-searching area and 
-		// there are still material pixels there -> the area is not an orphaned teran piece, abort search
-		if (bmpX <= 0 || bmpY <= 0 || bmpX >= radius - 1 || bmpY >= radius - 1)
-			return MAXORPHANRADIUS * MAXORPHANRADIUS + 1;
-		else
-		// Check if pixel was already checked
+	int originX = posX - searchSize / 2;
+	int originY = posY - searchSize / 2;
+	int startX = posX - originX;
+	int startY = posY - originY;
+
+	// We reached the border of orphan-searching area and there are still material pixels there -> the area is not an orphaned terrain piece, abort search
+	if (startX <= 0 || startY <= 0 || startX >= searchSize - 1 || startY >= searchSize - 1)
+		return notOrphanedArea;
+
+	m_ComponentSearchStack.clear();
+	m_ComponentSearchStamps[startY * searchSize + startX] = m_ComponentSearchGeneration;
+	m_ComponentSearchStack.push_back(startY * searchSize + startX);
+
+	const int xOffsets[8] = { -1,  0,  1, -1,  1, -1,  0,  1 };
+	const int yOffsets[8] = { -1, -1, -1,  0,  0,  1,  1,  1 };
+
+	while (!m_ComponentSearchStack.empty())
+	{
+		int searchIndex = m_ComponentSearchStack.back();
+		m_ComponentSearchStack.pop_back();
+
+		TerrainComponent::Pixel pixel = { originX + searchIndex % searchSize, originY + searchIndex / searchSize };
+		component.m_Pixels.push_back(pixel);
+		component.m_Bounds.m_Left = MIN(component.m_Bounds.m_Left, pixel.m_X);
+		component.m_Bounds.m_Top = MIN(component.m_Bounds.m_Top, pixel.m_Y);
+		component.m_Bounds.m_Right = MAX(component.m_Bounds.m_Right, pixel.m_X + 1);
+		component.m_Bounds.m_Bottom = MAX(component.m_Bounds.m_Bottom, pixel.m_Y + 1);
+
+		// Too big to be worth looking at any further
+		if (component.m_Pixels.size() > maxArea)
+			return component.m_Pixels.size();
+
+		for (int neighbor = 0; neighbor < 8; ++neighbor)
 		{
-			if (_getpixel(m_pOrphanSearchBitmap, bmpX, bmpY) != g_MaterialAir)
-				return 0;
+			int neighborX = pixel.m_X + xOffsets[neighbor];
+			int neighborY = pixel.m_Y + yOffsets[neighbor];
+			if (neighborX < 0 || neighborY < 0 || neighborX >= pMaterial->w || neighborY >= pMaterial->h)
+				continue;
+
+			int searchX = neighborX - originX;
+			int searchY = neighborY - originY;
+			int neighborIndex = searchY * searchSize + searchX;
+			// Pixels on the border of the search area are never stamped, so only check the stamps within it
+			bool onBorder = searchX <= 0 || searchY <= 0 || searchX >= searchSize - 1 || searchY >= searchSize - 1;
+			if ((!onBorder && m_ComponentSearchStamps[neighborIndex] == m_ComponentSearchGeneration) || _getpixel(pMaterial, neighborX, neighborY) == g_MaterialAir)
+				continue;
+
+			if (onBorder)
+				return notOrphanedArea;
+
+			m_ComponentSearchStamps[neighborIndex] = m_ComponentSearchGeneration;
+			m_ComponentSearchStack.push_back(neighborIndex);
 		}
 	}
 
-	_putpixel(m_pOrphanSearchBitmap, bmpX, bmpY, materialID);
-	area++;
+	component.m_Complete = true;
+	return component.m_Pixels.size();
+}
 
-	// We're clear to remove the pixel
-	if (remove)
-	{
-		Material const * sceneMat = GetMaterialFromID(materialID);
-		Material const * spawnMat;
-        spawnMat = sceneMat->spawnMaterial ? GetMaterialFromID(sceneMat->spawnMaterial) : sceneMat;
-		float sprayScale = 0.1;
-        Color spawnColor;
-        if (spawnMat->UsesOwnColor())
-            spawnColor = spawnMat->color;
-        else
-            spawnColor.SetRGBWithIndex(m_pCurrentScene->GetTerrain()->GetFGColorPixel(posX, posY));
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RemoveTerrainComponent
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes all the pixels of a piece of terrain found by
+//                  FindTerrainComponent, turning them into MOPixels.
 
-        // No point generating a key-colored MOPixel
-        if (spawnColor.GetIndex() != g_KeyColor)
-        {
-			// TEST COLOR
-			// spawnColor = 5;
-
-            // Get the new pixel from the pre-allocated pool, should be faster than dynamic allocation
-            // Density is used as the mass for the new MOPixel
-            MOPixel *pixelMO = new MOPixel(spawnColor,
-                                           spawnMat->pixelDensity,
-                                           Vector(posX, posY),
-                                           Vector(-RangeRand((2 * sprayScale) / 2 , 2 * sprayScale),
-                                                  -RangeRand((2 * sprayScale) / 2 , 2 * sprayScale)),
-                                           new Atom(Vector(), spawnMat->id, 0, spawnColor, 2),
-                                           0);
-
-            pixelMO->SetToHitMOs(spawnMat->id == c_GoldMaterialID);
-            pixelMO->SetToGetHitByMOs(false);
-            g_MovableMan.AddParticle(pixelMO);
-            pixelMO = 0;
-        }
-        m_pCurrentScene->GetTerrain()->SetFGColorPixel(posX, posY, g_KeyColor);
-		RegisterTerrainChange(posX, posY, 1, 1, g_KeyColor, false);
-        m_pCurrentScene->GetTerrain()->SetMaterialPixel(posX, posY, g_MaterialAir);
-	}
+void SceneMan::RemoveTerrainComponent(const TerrainComponent &component)
+{
+	if (component.m_Pixels.empty())
+		return;
 
-	int xoff[8] = { -1,  0,  1, -1,  1, -1,  0,  1};
-	int yoff[8] = { -1, -1, -1,  0,  0,  1,  1,  1};
+	BITMAP *pFGColor = m_pCurrentScene->GetTerrain()->GetFGColorBitmap();
+	BITMAP *pMaterial = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+	float sprayScale = 0.1;
+	Color spawnColor;
 
-	for (int c = 0; c < 8; c++)
+	for (const TerrainComponent::Pixel &pixel : component.m_Pixels)
 	{
-		area += RemoveOrphans(posX + xoff[c], posY + yoff[c], centerPosX, centerPosY, area, radius, maxArea, remove);
-		if (accumulatedArea + area > maxArea)
-			break;
+		Material const * sceneMat = GetMaterialFromID(_getpixel(pMaterial, pixel.m_X, pixel.m_Y));
+		Material const * spawnMat = sceneMat->spawnMaterial ? GetMaterialFromID(sceneMat->spawnMaterial) : sceneMat;
+		if (spawnMat->UsesOwnColor())
+			spawnColor = spawnMat->color;
+		else
+			spawnColor.SetRGBWithIndex(_getpixel(pFGColor, pixel.m_X, pixel.m_Y));
+
+		// No point generating a key-colored MOPixel
+		if (spawnColor.GetIndex() != g_KeyColor)
+		{
+			// Density is used as the mass for the new MOPixel
+			MOPixel *pixelMO = new MOPixel(spawnColor,
+										   spawnMat->pixelDensity,
+										   Vector(pixel.m_X, pixel.m_Y),
+										   Vector(-RangeRand((2 * sprayScale) / 2 , 2 * sprayScale),
+												  -RangeRand((2 * sprayScale) / 2 , 2 * sprayScale)),
+										   new Atom(Vector(), spawnMat->id, 0, spawnColor, 2),
+										   0);
+
+			pixelMO->SetToHitMOs(spawnMat->id == c_GoldMaterialID);
+			pixelMO->SetToGetHitByMOs(false);
+			g_MovableMan.AddParticle(pixelMO);
+			pixelMO = 0;
+		}
+		_putpixel(pFGColor, pixel.m_X, pixel.m_Y, g_KeyColor);
+		_putpixel(pMaterial, pixel.m_X, pixel.m_Y, g_MaterialAir);
 	}
 
-	return area;
+	// One change covering the whole piece instead of one per pixel
+	RegisterTerrainChange(component.m_Bounds.m_Left, component.m_Bounds.m_Top, component.m_Bounds.m_Right - component.m_Bounds.m_Left, component.m_Bounds.m_Bottom - component.m_Bounds.m_Top, false);
 }
 
-void SceneMan::RegisterTerrainChange(int x, int y, int w, int h, unsigned char color, bool back) 
+void SceneMan::RegisterTerrainChange(int x, int y, int w, int h, bool back) 
 {
+	if (!back)
+		MarkRayTilesOccupied(x, y, x + w - 1, y + h - 1, true);
+
 	if (!g_NetworkServer.IsServerModeEnabled())
 		return;
 
+	if (ThreadMan::IsInParallelJob())
+	{
+		g_ThreadMan.DeferCommand([=]() { RegisterTerrainChange(x, y, w, h, back); });
+		return;
+	}
+
 	// Crop if it's out of scene as both the client and server will not tolerate out of bitmap coords while packing/unpacking
 	if (y < 0)
+	{
+		h += y;
 		y = 0;
+	}
 
-	if (y + h >= GetSceneHeight())
-		h = GetSceneHeight() - y - 1;
+	if (y + h > GetSceneHeight())
+		h = GetSceneHeight() - y;
 
-	if (y >= GetSceneHeight() || h <= 0)
+	if (y >= GetSceneHeight() || h <= 0 || w <= 0)
 		return;
 
-	if (w == 1)
+	TerrainChange tc;
+	tc.y = y;
+	tc.h = h;
+	tc.back = back;
+
+	// Wrap a lone pixel back onto the scene, or divide the region if it's crossing the seam
+	if (w == 1 && SceneWrapsX())
+		x = ((x % GetSceneWidth()) + GetSceneWidth()) % GetSceneWidth();
+
+	if (x + w > GetSceneWidth())
 	{
-		if (x >= GetSceneWidth())
+		if (x < GetSceneWidth())
 		{
-			if (!SceneWrapsX())
-				return;
-			x = x - GetSceneWidth();
+			// Left part, on the scene
+			tc.x = x;
+			tc.w = GetSceneWidth() - x;
+			g_NetworkServer.RegisterTerrainChange(tc);
 		}
-		if (x < 0)
+		// Discard out of scene part if scene is not wrapped
+		if (SceneWrapsX())
 		{
-			if (!SceneWrapsX())
-				return;
-			x = GetSceneWidth() + x;
+			// Right part, out of scene
+			tc.x = MAX(x - GetSceneWidth(), 0);
+			tc.w = MIN(x + w - GetSceneWidth(), GetSceneWidth()) - tc.x;
+			g_NetworkServer.RegisterTerrainChange(tc);
 		}
+		return;
 	}
-	else
+
+	if (x < 0)
 	{
-		// Divide region if crossing the seam
-		if (x + w >= GetSceneWidth() || x < 0)
+		if (x + w > 0)
 		{
-			// Crossing right part of the scene
-			if (x + w >= GetSceneWidth())
-			{
-				// Left part, on the scene
-				TerrainChange tc1;
-				tc1.x = x;
-				tc1.y = y;
-				tc1.w = GetSceneWidth() - x;
-				tc1.h = h;
-				tc1.back = back;
-				tc1.color = color;
-				g_NetworkServer.RegisterTerrainChange(tc1);
-
-				// Discard out of scene part if scene is not wrapped
-				if (!SceneWrapsX())
-					return;
-
-				// Right part, out of scene
-				TerrainChange tc2;
-				tc2.x = 0;
-				tc2.y = y;
-				tc2.w = w - (GetSceneWidth() - x);
-				tc2.h = h;
-				tc2.back = back;
-				tc2.color = color;
-
-				g_NetworkServer.RegisterTerrainChange(tc2);
-				return;
-			}
-
-			if (x < 0)
-			{
-				// Right part, on the scene
-				TerrainChange tc2;
-				tc2.x = 0;
-				tc2.y = y;
-				tc2.w = w + x;
-				tc2.h = h;
-				tc2.back = back;
-				tc2.color = color;
-				g_NetworkServer.RegisterTerrainChange(tc2);
-
-				// Discard out of scene part if scene is not wrapped
-				if (!SceneWrapsX())
-					return;
-
-				// Left part, out of the scene
-				TerrainChange tc1;
-				tc1.x = GetSceneWidth() + x;
-				tc1.y = y;
-				tc1.w = -x;
-				tc1.h = h;
-				tc1.back = back;
-				tc1.color = color;
-				g_NetworkServer.RegisterTerrainChange(tc1);
-				return;
-			}
+			// Right part, on the scene
+			tc.x = 0;
+			tc.w = x + w;
+			g_NetworkServer.RegisterTerrainChange(tc);
+		}
+		// Discard out of scene part if scene is not wrapped
+		if (SceneWrapsX())
+		{
+			// Left part, out of the scene
+			tc.x = MAX(GetSceneWidth() + x, 0);
+			tc.w = MIN(GetSceneWidth() + x + w, GetSceneWidth()) - tc.x;
+			g_NetworkServer.RegisterTerrainChange(tc);
 		}
+		return;
 	}
 
-	TerrainChange tc;
 	tc.x = x;
-	tc.y = y;
 	tc.w = w;
-	tc.h = h;
-	tc.back = back;
-	tc.color = color;
 	g_NetworkServer.RegisterTerrainChange(tc);
 }
 
@@ -1242,6 +1638,12 @@ bool SceneMan::TryPenetrate(const int posX,
 //    float spraySpread = 10.0;
     float impMag = impulse.GetMagnitude();
 
+    // Penetration digs out terrain that other threads may be reading, so it's never done in a parallel pass.
+    // MovableMan only travels particles in parallel that are too weak to knock loose any Material, see GetWeakestMaterialStrength.
+    // Should one speed up while traveling anyway (Material restitution over 1), it's refused like too weak a hit, the same way regardless of thread count.
+    if (ThreadMan::IsInParallelJob())
+        return false;
+
     // Test if impulse force is enough to penetrate
     if (impMag >= sceneMat->strength)
     {
@@ -1285,7 +1687,7 @@ bool SceneMan::TryPenetrate(const int posX,
                 pixelMO = 0;
             }
             m_pCurrentScene->GetTerrain()->SetFGColorPixel(posX, posY, g_KeyColor);
-			RegisterTerrainChange(posX, posY, 1, 1, g_KeyColor, false);
+			RegisterTerrainChange(posX, posY, 1, 1, false);
 
             m_pCurrentScene->GetTerrain()->SetMaterialPixel(posX, posY, g_MaterialAir);
         }
@@ -1293,7 +1695,7 @@ bool SceneMan::TryPenetrate(const int posX,
         else if (PosRand() <= airRatio)
         {
             m_pCurrentScene->GetTerrain()->SetFGColorPixel(posX, posY, g_KeyColor);
-			RegisterTerrainChange(posX, posY, 1, 1, g_KeyColor, false);
+			RegisterTerrainChange(posX, posY, 1, 1, false);
 
 			m_pCurrentScene->GetTerrain()->SetMaterialPixel(posX, posY, g_MaterialAir);
         }
@@ -1358,7 +1760,7 @@ bool SceneMan::TryPenetrate(const int posX,
 						}
 
                         // Clear the terrain pixel now when the particle has been generated from it
-						RegisterTerrainChange(posX, testY, 1, 1, g_KeyColor, false);
+						RegisterTerrainChange(posX, testY, 1, 1, false);
                         _putpixel(pFGColor, posX, testY, g_KeyColor);
                         _putpixel(pMaterial, posX, testY, g_MaterialAir);
                     }
@@ -1373,9 +1775,6 @@ bool SceneMan::TryPenetrate(const int posX,
 		if (removeOrphansRadius && removeOrphansMaxArea && removeOrphansRate > 0 && PosRand() < removeOrphansRate)
 		{
 			RemoveOrphans(posX, posY, removeOrphansRadius, removeOrphansMaxArea, true);
-			/*PALETTE palette;
-			get_palette(palette);
-			save_bmp("Orphan.bmp", m_pOrphanSearchBitmap, palette);*/
 		}
 
         return true;
@@ -1514,7 +1913,7 @@ bool SceneMan::RevealUnseen(const int posX, const int posY, const int team)
         if (pixel != g_KeyColor && pixel != -1)
         {
             // Add the pixel to the list of now seen pixels so it can be visually flashed
-            m_pCurrentScene->GetSeenPixels(team).push_back(Vector(scaledX, scaledY));
+            m_pCurrentScene->AddSeenPixels(scaledX, scaledY, 1, team);
             // Clear to key color that pixel on the map so it won't be detected as unseen again
             putpixel(pUnseenLayer->GetBitmap(), scaledX, scaledY, g_KeyColor);
             // Play the reveal sound, if there's not too many already revealed this frame
@@ -1553,7 +1952,7 @@ bool SceneMan::RestoreUnseen(const int posX, const int posY, const int team)
         if (pixel != g_BlackColor && pixel != -1)
         {
             // Add the pixel to the list of now seen pixels so it can be visually flashed
-            m_pCurrentScene->GetSeenPixels(team).push_back(Vector(scaledX, scaledY));
+            m_pCurrentScene->AddSeenPixels(scaledX, scaledY, 1, team);
             // Clear to key color that pixel on the map so it won't be detected as unseen again
             putpixel(pUnseenLayer->GetBitmap(), scaledX, scaledY, g_BlackColor);
             // Play the reveal sound, if there's not too many already revealed this frame
@@ -1694,6 +2093,8 @@ bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, V
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -1708,7 +2109,7 @@ bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, V
         if (++skipped > skip || domSteps + 1 == delta[dom])
         {
             // Scene wrapping
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            sampler.WrapPosition(intPos[X], intPos[Y]);
             // Reveal if we can, save the result
 			if (reveal)
 				affectedAny = RevealUnseen(intPos[X], intPos[Y], team) || affectedAny;
@@ -1716,7 +2117,7 @@ bool SceneMan::CastUnseenRay(int team, const Vector &start, const Vector &ray, V
 				affectedAny = RestoreUnseen(intPos[X], intPos[Y], team) || affectedAny;
 
             // Check the strength of the terrain to see if we can penetrate further
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
+            materialID = sampler.GetTerrMatter(intPos[X], intPos[Y]);
             // Get the material object
             foundMaterial = GetMaterialFromID(materialID);
             // Add the encountered material's strength to the tally
@@ -1771,6 +2172,126 @@ bool SceneMan::CastUnseeRay(int team, const Vector &start, const Vector &ray, Ve
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddVisibilityFan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a fan of seeing rays for a team, to be traced together with all
+//                  the others queued this frame on the next UpdateVisibility.
+
+bool SceneMan::AddVisibilityFan(int team, const Vector &start, const Vector &ray, float spreadAngle, int strengthLimit, long int seerID)
+{
+    RTEAssert(m_pCurrentScene, "Checking scene before the scene exists!");
+    if (team < Activity::TEAM_1 || team >= Activity::MAXTEAMCOUNT)
+        return false;
+
+    SceneLayer *pUnseenLayer = m_pCurrentScene->GetUnseenLayer(team);
+    float range = ray.GetMagnitude();
+    if (!pUnseenLayer || range < 1.0F)
+        return false;
+
+    if (static_cast<size_t>(m_VisibilityFanCount) >= m_VisibilityFans.size())
+        m_VisibilityFans.push_back(VisibilityFan());
+    VisibilityFan &fan = m_VisibilityFans[m_VisibilityFanCount++];
+
+    // Space the rays so their ends are no further apart than the unseen layer's pixels are across
+    float pixelSize = MAX(pUnseenLayer->GetScaleFactor().GetSmallest(), 1.0F);
+    float spreadRadians = MIN(fabs(spreadAngle), 180.0F) * c_PI / 180.0F;
+    int rayCount = static_cast<int>(ceil(2.0F * spreadRadians * range / pixelSize)) + 1;
+
+    fan.m_Team = team;
+    fan.m_SeerID = seerID;
+    fan.m_Start = start;
+    fan.m_RayCount = MIN(rayCount, c_MaxVisibilityFanRays);
+    fan.m_StartAngle = atan2(ray.m_Y, ray.m_X) - spreadRadians;
+    fan.m_AngleStep = fan.m_RayCount > 1 ? 2.0F * spreadRadians / static_cast<float>(fan.m_RayCount - 1) : 0;
+    fan.m_Range = range;
+    fan.m_StrengthLimit = strengthLimit;
+    // Check the terrain as often along the rays as single seeing rays do
+    fan.m_Step = static_cast<int>(pixelSize) / 2 + 1;
+    fan.m_UnseenScale = pUnseenLayer->GetScaleInverse();
+
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateVisibility
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces all the visibility fans queued since the last update across all
+//                  threads, then reveals what they reached on the unseen layers a run of
+//                  pixels at a time. Should be called while the Scene is locked.
+
+void SceneMan::UpdateVisibility()
+{
+    if (m_VisibilityFanCount == 0 || !m_pCurrentScene)
+    {
+        m_VisibilityFanCount = 0;
+        return;
+    }
+
+    static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("SceneMan::UpdateVisibility");
+    ProfileZone profileZone(s_ProfilerZoneID);
+
+    // Tracing only reads the terrain, and each fan is plenty of work on its own
+    const SceneSampler &sampler = GetSceneSampler();
+    g_ThreadMan.ParallelFor(m_VisibilityFanCount, [this, &sampler](int index) { TraceVisibilityFan(m_VisibilityFans[index], sampler); }, 1);
+
+    // The fans overlap, so they have to be revealed one after another
+    for (int fanIndex = 0; fanIndex < m_VisibilityFanCount; ++fanIndex)
+    {
+        const VisibilityFan &fan = m_VisibilityFans[fanIndex];
+        SceneLayer *pUnseenLayer = m_pCurrentScene->GetUnseenLayer(fan.m_Team);
+        if (!pUnseenLayer)
+            continue;
+
+        int layerWidth = pUnseenLayer->GetBitmap()->w;
+        int layerHeight = pUnseenLayer->GetBitmap()->h;
+        size_t seenSpanCount = m_pCurrentScene->GetSeenPixels(fan.m_Team).size();
+        bool revealedAny = false;
+        Vector revealedPos;
+
+        for (vector<VisibilityFan::Span>::const_iterator itr = fan.m_Spans.begin(); itr != fan.m_Spans.end(); ++itr)
+        {
+            int row = (*itr).m_Row;
+            if (pUnseenLayer->WrapsY())
+            {
+                row %= layerHeight;
+                if (row < 0)
+                    row += layerHeight;
+            }
+            else if (row < 0 || row >= layerHeight)
+                continue;
+
+            // Runs crossing the seam are split in two, and ones off the edge are cut
+            int ranges[2][2];
+            int rangeCount = GetRayTileSpans((*itr).m_Left, (*itr).m_Right, layerWidth, pUnseenLayer->WrapsX(), 1, ranges);
+            for (int rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+            {
+                if (RevealUnseenRow(fan.m_Team, row, ranges[rangeIndex][0], ranges[rangeIndex][1]) > 0 && !revealedAny)
+                {
+                    revealedAny = true;
+                    revealedPos.SetXY(static_cast<float>(ranges[rangeIndex][0]) / fan.m_UnseenScale.m_X, static_cast<float>(row) / fan.m_UnseenScale.m_Y);
+                }
+            }
+        }
+
+        // Play the reveal sound, if there's not too many already revealed this frame
+        if (revealedAny && g_SettingsMan.BlipOnRevealUnseen() && m_pUnseenRevealSound && seenSpanCount < 5)
+            m_pUnseenRevealSound->Play(revealedPos);
+
+        // The Actor may have been deleted since it queued the fan, so look it up again
+        if (revealedAny && fan.m_SeerID != 0)
+        {
+            Actor *pSeer = dynamic_cast<Actor *>(g_MovableMan.FindObjectByUniqueID(fan.m_SeerID));
+            if (pSeer)
+                pSeer->SetLookFanRevealed();
+        }
+    }
+
+    m_VisibilityFanCount = 0;
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          CastMaterialRay
@@ -1835,6 +2356,8 @@ bool SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -1850,10 +2373,10 @@ bool SceneMan::CastMaterialRay(const Vector &start, const Vector &ray, unsigned
         {
             // Scene wrapping, if necessary
             if (wrap)
-                g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+                sampler.WrapPosition(intPos[X], intPos[Y]);
 
             // See if we found the looked-for pixel of the correct material
-            if (GetTerrMatter(intPos[X], intPos[Y]) == material)
+            if (sampler.GetTerrMatter(intPos[X], intPos[Y]) == material)
             {
                 // Save result and report success
                 foundPixel = true;
@@ -1966,6 +2489,8 @@ bool SceneMan::CastNotMaterialRay(const Vector &start, const Vector &ray, unsign
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -1980,12 +2505,12 @@ bool SceneMan::CastNotMaterialRay(const Vector &start, const Vector &ray, unsign
         if (++skipped > skip || domSteps + 1 == delta[dom])
         {
             // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            sampler.WrapPosition(intPos[X], intPos[Y]);
 
             // See if we found the looked-for pixel of the correct material,
             // Or an MO is blocking the way
-            if (GetTerrMatter(intPos[X], intPos[Y]) != material ||
-                (checkMOs && g_SceneMan.GetMOIDPixel(intPos[X], intPos[Y]) != g_NoMOID))
+            if (sampler.GetTerrMatter(intPos[X], intPos[Y]) != material ||
+                (checkMOs && sampler.GetMOIDPixel(intPos[X], intPos[Y]) != g_NoMOID))
             {
                 // Save result and report success
                 foundPixel = true;
@@ -2098,6 +2623,8 @@ float SceneMan::CastStrengthSumRay(const Vector &start, const Vector &end, int s
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -2112,10 +2639,10 @@ float SceneMan::CastStrengthSumRay(const Vector &start, const Vector &end, int s
         if (++skipped > skip || domSteps + 1 == delta[dom])
         {
             // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            sampler.WrapPosition(intPos[X], intPos[Y]);
 
             // Sum all strengths
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
+            materialID = sampler.GetTerrMatter(intPos[X], intPos[Y]);
             if (materialID != g_MaterialAir && materialID != ignoreMaterial)
                 strengthSum += GetMaterialFromID(materialID)->strength;
 
@@ -2192,6 +2719,8 @@ float SceneMan::CastMaxStrengthRay(const Vector &start, const Vector &end, int s
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -2206,10 +2735,10 @@ float SceneMan::CastMaxStrengthRay(const Vector &start, const Vector &end, int s
         if (++skipped > skip || domSteps + 1 == delta[dom])
         {
             // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            sampler.WrapPosition(intPos[X], intPos[Y]);
 
             // Sum all strengths
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
+            materialID = sampler.GetTerrMatter(intPos[X], intPos[Y]);
             if (materialID != g_MaterialDoor)
                 maxStrength = MAX(maxStrength, GetMaterialFromID(materialID)->strength);
 
@@ -2288,6 +2817,8 @@ bool SceneMan::CastStrengthRay(const Vector &start, const Vector &ray, float str
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -2303,9 +2834,9 @@ bool SceneMan::CastStrengthRay(const Vector &start, const Vector &ray, float str
         {
             // Scene wrapping, if necessary
             if (wrap)
-                g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+                sampler.WrapPosition(intPos[X], intPos[Y]);
 
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
+            materialID = sampler.GetTerrMatter(intPos[X], intPos[Y]);
             // Ignore the ignore material
             if (materialID != ignoreMaterial)
             {
@@ -2412,6 +2943,8 @@ bool SceneMan::CastWeaknessRay(const Vector &start, const Vector &ray, float str
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
+    const SceneSampler &sampler = GetSceneSampler();
+
     for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
     {
         intPos[dom] += increment[dom];
@@ -2427,9 +2960,9 @@ bool SceneMan::CastWeaknessRay(const Vector &start, const Vector &ray, float str
         {
             // Scene wrapping, if necessary
             if (wrap)
-                g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+                sampler.WrapPosition(intPos[X], intPos[Y]);
 
-            materialID = GetTerrMatter(intPos[X], intPos[Y]);
+            materialID = sampler.GetTerrMatter(intPos[X], intPos[Y]);
             foundMaterial = GetMaterialFromID(materialID);
 
             // See if we found a pixel of equal or less strength than the threshold
@@ -2475,165 +3008,166 @@ bool SceneMan::CastWeaknessRay(const Vector &start, const Vector &ray, float str
 
 MOID SceneMan::CastMORay(const Vector &start, const Vector &ray, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
 {
-#ifdef DEBUG_BUILD
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif
+    RayQuery query;
+    query.m_Type = RayQuery::MORAY;
+    query.m_Start = start;
+    query.m_Ray = ray;
+    query.m_MOID = ignoreMOID;
+    query.m_IgnoreTeam = ignoreTeam;
+    query.m_IgnoreMaterial = ignoreMaterial;
+    query.m_IgnoreAllTerrain = ignoreAllTerrain;
+    query.m_Skip = skip;
+
+    RayHit hit;
+    CastRays(&query, &hit, 1);
+
+    // Save last ray pos
+    if (hit.m_Stopped)
+        m_LastRayHitPos = hit.m_StopPos;
+
+    return hit.m_HitMOID;
+}
 
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    MOID hitMOID = g_NoMOID;
-    unsigned char hitTerrain = 0;
 
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
-    if (delta[X] == 0 && delta[Y] == 0)
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastFindMORay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and shows where a specific MOID has been found.
+
+bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID targetMOID, Vector &resultPos, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
+{
+    RayQuery query;
+    query.m_Type = RayQuery::FINDMORAY;
+    query.m_Start = start;
+    query.m_Ray = ray;
+    query.m_MOID = targetMOID;
+    query.m_IgnoreMaterial = ignoreMaterial;
+    query.m_IgnoreAllTerrain = ignoreAllTerrain;
+    query.m_Skip = skip;
+
+    RayHit hit;
+    CastRays(&query, &hit, 1);
+
+    // This has always reported a find for rays that don't go anywhere
+    if (hit.m_ZeroLength)
         return g_NoMOID;
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
+    if (!hit.m_Stopped)
+        return false;
 
-    if (delta[X] < 0)
-    {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
+    // Save last ray pos
+    m_LastRayHitPos = hit.m_StopPos;
 
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
+    // Stopped by terrain before the target was found
+    if (hit.m_HitTerrain)
+        return false;
 
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
+    resultPos = hit.m_StopPos;
+    return true;
+}
 
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
 
-    error = delta2[sub] - delta[dom];
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastObstacleRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces along a vector and returns the length of how far the trace went
+//                  without hitting any non-ignored terrain material or MOID at all.
 
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
+float SceneMan::CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip)
+{
+    RayQuery query;
+    query.m_Type = RayQuery::OBSTACLERAY;
+    query.m_Start = start;
+    query.m_Ray = ray;
+    query.m_MOID = ignoreMOID;
+    query.m_IgnoreTeam = ignoreTeam;
+    query.m_IgnoreMaterial = ignoreMaterial;
+    query.m_Skip = skip;
+
+    RayHit hit;
+    CastRays(&query, &hit, 1);
+
+    if (hit.m_ZeroLength)
+        return false;
 
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
-        {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
+    // The fraction of a pixel that we start from, to be added to the integer result positions for accuracy
+    Vector startFraction(start.m_X - floorf(start.m_X), start.m_Y - floorf(start.m_Y));
 
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
+    // Add the pixel fraction to the free position if there were any free pixels
+    if (hit.m_Steps != 0)
+        freePos = hit.m_FreePos + startFraction;
 
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+    if (hit.m_Stopped)
+    {
+        // Save last ray pos
+        m_LastRayHitPos = hit.m_StopPos;
+        // Add the pixel fraction to the obstacle position, to acoid losing precision
+        obstaclePos = hit.m_StopPos + startFraction;
+        // If there was an obstacle on the start position, return 0 as the distance to obstacle
+        if (hit.m_Steps == 0)
+            return 0;
+        // Calculate the length between the start and the found material pixel coords
+        else
+            return g_SceneMan.ShortestDistance(obstaclePos, start).GetMagnitude();
+    }
 
-            // Detect MOIDs
-            hitMOID = GetMOIDPixel(intPos[X], intPos[Y]);
-            if (hitMOID != g_NoMOID && hitMOID != ignoreMOID && g_MovableMan.GetRootMOID(hitMOID) != ignoreMOID)
-            {
-                // Check if we're supposed to ignore the team of what we hit
-                if (ignoreTeam != Activity::NOTEAM)
-                {
-                    const MovableObject *pHitMO = g_MovableMan.GetMOFromID(hitMOID);
-                    pHitMO = pHitMO ? pHitMO->GetRootParent() : 0;
-                    // Yup, we are supposed to ignore this!
-                    if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == ignoreTeam)
-                    {
-                        ;
-                    }
-                    else
-                    {
-                        // Save last ray pos
-                        m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                        return hitMOID;
-                    }
-                }
-                // Legit hit
-                else
-                {
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    return hitMOID;
-                }
-            }
+    // Didn't hit anything but air
+    return -1.0;
+}
 
-            // Detect terrain hits
-            if (!ignoreAllTerrain)
-            {
-                hitTerrain = g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]);
-                if (hitTerrain != g_MaterialAir && hitTerrain != ignoreMaterial)
-                {
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    return g_NoMOID;
-                }
-            }
 
-            skipped = 0;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces a whole batch of rays, filling out a hit record for each.
 
-#ifdef DEBUG_BUILD
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 120);
-#endif
-        }
-    }
+void SceneMan::CastRays(const RayQuery *pQueries, RayHit *pHits, int count)
+{
+    if (count <= 0)
+        return;
 
-#ifdef DEBUG_BUILD
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif
+    const SceneSampler &sampler = GetSceneSampler();
+    bool inParallelJob = ThreadMan::IsInParallelJob();
+    if (!inParallelJob)
+        PrepareRayTiles(sampler, false);
+    bool useTiles = m_aRayTiles && SameSceneView(sampler, m_RayTileSampler);
 
-    // Didn't hit anything but air
-    return g_NoMOID;
+    // Each ray is quick enough that only big batches are worth spreading out, and parallel jobs can't start others anyway
+    const int batchSize = 16;
+    if (inParallelJob || count <= batchSize)
+    {
+        for (int index = 0; index < count; ++index)
+            TraceRay(pQueries[index], pHits[index], sampler, useTiles);
+    }
+    else
+        g_ThreadMan.ParallelFor(count, [this, pQueries, pHits, &sampler, useTiles](int index) { TraceRay(pQueries[index], pHits[index], sampler, useTiles); }, batchSize);
 }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastFindMORay
+// Method:          TraceRay
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and shows where a specific MOID has been found.
+// Description:     Traces one ray for CastRays.
 
-bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID targetMOID, Vector &resultPos, unsigned char ignoreMaterial, bool ignoreAllTerrain, int skip)
+void SceneMan::TraceRay(const RayQuery &query, RayHit &hit, const SceneSampler &sampler, bool useTiles) const
 {
-#ifdef DEBUG_BUILD
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif
+    hit = RayHit();
 
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;;
+    // Skipping less than nothing is the same as skipping nothing
+    int skip = MAX(query.m_Skip, 0);
+    int error, dom, sub, domSteps, skipped = skip;
     int intPos[2], delta[2], delta2[2], increment[2];
-    MOID hitMOID = g_NoMOID;
-    unsigned char hitTerrain = 0;
 
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    
+    intPos[X] = floorf(query.m_Start.m_X);
+    intPos[Y] = floorf(query.m_Start.m_Y);
+    delta[X] = floorf(query.m_Start.m_X + query.m_Ray.m_X) - intPos[X];
+    delta[Y] = floorf(query.m_Start.m_Y + query.m_Ray.m_Y) - intPos[Y];
+
     if (delta[X] == 0 && delta[Y] == 0)
-        return g_NoMOID;
+    {
+        hit.m_ZeroLength = true;
+        return;
+    }
 
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm preparation
@@ -2670,6 +3204,13 @@ bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID target
 
     error = delta2[sub] - delta[dom];
 
+    // What a tile must be clear of for this ray to pass through it without finding anything. Looking for no MO at all finds one everywhere there's nothing
+    unsigned int clearFlags = RAYTILE_NOMO;
+    if (query.m_Type == RayQuery::OBSTACLERAY || !query.m_IgnoreAllTerrain)
+        clearFlags |= RAYTILE_AIR;
+    if (query.m_Type == RayQuery::FINDMORAY && query.m_MOID == g_NoMOID)
+        useTiles = false;
+
     /////////////////////////////////////////////////////
     // Bresenham's line drawing algorithm execution
 
@@ -2683,205 +3224,229 @@ bool SceneMan::CastFindMORay(const Vector &start, const Vector &ray, MOID target
         }
         error += delta2[sub];
 
+        // Walk straight through tiles with nothing to hit in them without looking at any pixels, up to the last pixel within the tile, which is handled as usual below
+        if (useTiles && domSteps + 1 < delta[dom])
+        {
+            int tilePos[2] = { intPos[X], intPos[Y] };
+            sampler.WrapPosition(tilePos[X], tilePos[Y]);
+            if (tilePos[X] >= 0 && tilePos[X] < sampler.m_Width && tilePos[Y] >= 0 && tilePos[Y] < sampler.m_Height &&
+                (GetRayTileFlags(tilePos[X] / c_RayTileSize, tilePos[Y] / c_RayTileSize) & clearFlags) == clearFlags)
+            {
+                // The tile in the same unwrapped space as the ray, which all wraps back by the same amount since tiles don't straddle the seams
+                int wrapOffset[2] = { tilePos[X] - intPos[X], tilePos[Y] - intPos[Y] };
+                int tileMin[2] = { (tilePos[X] / c_RayTileSize) * c_RayTileSize - wrapOffset[X], (tilePos[Y] / c_RayTileSize) * c_RayTileSize - wrapOffset[Y] };
+                int tileMax[2] = { MIN(tileMin[X] + c_RayTileSize, sampler.m_Width - wrapOffset[X]), MIN(tileMin[Y] + c_RayTileSize, sampler.m_Height - wrapOffset[Y]) };
+                bool wouldHaveWrapped = false;
+
+                while (domSteps + 1 < delta[dom])
+                {
+                    int nextPos[2] = { intPos[X], intPos[Y] };
+                    nextPos[dom] += increment[dom];
+                    if (error >= 0)
+                        nextPos[sub] += increment[sub];
+                    if (nextPos[X] < tileMin[X] || nextPos[X] >= tileMax[X] || nextPos[Y] < tileMin[Y] || nextPos[Y] >= tileMax[Y])
+                        break;
+
+                    // Keep count of the skipping just as if the pixel we're leaving had been looked at
+                    if (++skipped > skip)
+                    {
+                        skipped = 0;
+                        wouldHaveWrapped = true;
+                    }
+
+                    intPos[X] = nextPos[X];
+                    intPos[Y] = nextPos[Y];
+                    if (error >= 0)
+                        error -= delta2[dom];
+                    error += delta2[sub];
+                    ++domSteps;
+                }
+
+                // Looking at any pixel would have wrapped the position, which changes where the rest of the ray's positions are reported
+                if (wouldHaveWrapped)
+                {
+                    intPos[X] += wrapOffset[X];
+                    intPos[Y] += wrapOffset[Y];
+                }
+            }
+        }
+
         // Only check pixel if we're not due to skip any, or if this is the last pixel
         if (++skipped > skip || domSteps + 1 == delta[dom])
         {
             // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+            sampler.WrapPosition(intPos[X], intPos[Y]);
+
+            MOID hitMOID = sampler.GetMOIDPixel(intPos[X], intPos[Y]);
+            bool stopped = false;
 
-            // Detect MOIDs
-            hitMOID = GetMOIDPixel(intPos[X], intPos[Y]);
-            if (hitMOID == targetMOID || g_MovableMan.GetRootMOID(hitMOID) == targetMOID)
+            if (query.m_Type == RayQuery::MORAY)
             {
-                // Found target MOID, so save result and report success
-                resultPos.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                return true;
+                // Detect MOIDs
+                if (hitMOID != g_NoMOID && hitMOID != query.m_MOID && g_MovableMan.GetRootMOID(hitMOID) != query.m_MOID)
+                {
+                    stopped = true;
+                    // Check if we're supposed to ignore the team of what we hit
+                    if (query.m_IgnoreTeam != Activity::NOTEAM)
+                    {
+                        const MovableObject *pHitMO = g_MovableMan.GetMOFromID(hitMOID);
+                        pHitMO = pHitMO ? pHitMO->GetRootParent() : 0;
+                        if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == query.m_IgnoreTeam)
+                            stopped = false;
+                    }
+                }
+                if (stopped)
+                    hit.m_HitMOID = hitMOID;
             }
-
-            // Detect terrain hits
-            if (!ignoreAllTerrain)
+            else if (query.m_Type == RayQuery::FINDMORAY)
             {
-                hitTerrain = g_SceneMan.GetTerrMatter(intPos[X], intPos[Y]);
-                if (hitTerrain != g_MaterialAir && hitTerrain != ignoreMaterial)
+                // Detect the target MOID
+                if (hitMOID == query.m_MOID || g_MovableMan.GetRootMOID(hitMOID) == query.m_MOID)
                 {
-                    // Save last ray pos
-                    m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
-                    return false;
+                    stopped = true;
+                    hit.m_HitMOID = query.m_MOID;
+                }
+            }
+            else
+            {
+                // Translate any found MOID into the root MOID of that hit MO
+                if (hitMOID != g_NoMOID)
+                {
+                    const MovableObject *pHitMO = g_MovableMan.GetMOFromID(hitMOID);
+                    if (pHitMO)
+                    {
+                        hitMOID = pHitMO->GetRootID();
+                        // Check if we're supposed to ignore the team of what we hit
+                        if (query.m_IgnoreTeam != Activity::NOTEAM)
+                        {
+                            pHitMO = pHitMO->GetRootParent();
+                            // We are indeed supposed to ignore this object because of its ignoring of its specific team
+                            if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == query.m_IgnoreTeam)
+                                hitMOID = g_NoMOID;
+                        }
+                    }
+                }
+                // An MO is blocking the way
+                if (hitMOID != g_NoMOID && hitMOID != query.m_MOID)
+                {
+                    stopped = true;
+                    hit.m_HitMOID = hitMOID;
                 }
             }
 
-            skipped = 0;
+            // Detect terrain hits
+            if (!stopped && (query.m_Type == RayQuery::OBSTACLERAY || !query.m_IgnoreAllTerrain))
+            {
+                unsigned char hitTerrain = sampler.GetTerrMatter(intPos[X], intPos[Y]);
+                stopped = hitTerrain != g_MaterialAir && hitTerrain != query.m_IgnoreMaterial;
+                hit.m_HitTerrain = stopped;
+            }
 
-#ifdef DEBUG_BUILD
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 120);
-#endif
+            if (stopped)
+            {
+                hit.m_Stopped = true;
+                hit.m_StopPos.SetXY(intPos[X], intPos[Y]);
+                hit.m_Steps = domSteps;
+                return;
+            }
+
+            skipped = 0;
         }
+        hit.m_FreePos.SetXY(intPos[X], intPos[Y]);
     }
 
-#ifdef DEBUG_BUILD
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif
-
-    // Didn't hit the target
-    return false;
+    // Didn't hit anything but air
+    hit.m_Steps = domSteps;
 }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          CastObstacleRay
+// Method:          TraceVisibilityFan
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Traces along a vector and returns the length of how far the trace went
-//                  without hitting any non-ignored terrain material or MOID at all.
+// Description:     Traces the rays of a visibility fan and works out the runs of unseen
+//                  layer pixels they reach. Only reads the terrain, so it's safe to call
+//                  from several threads on different fans.
 
-float SceneMan::CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID, int ignoreTeam, unsigned char ignoreMaterial, int skip)
+void SceneMan::TraceVisibilityFan(VisibilityFan &fan, const SceneSampler &sampler) const
 {
-#ifdef DEBUG_BUILD
-    if (m_pDebugLayer)
-        m_pDebugLayer->LockBitmaps();
-#endif
-
-    int hitCount = 0, error, dom, sub, domSteps, skipped = skip;
-    int intPos[2], delta[2], delta2[2], increment[2];
-    bool hitObstacle = false;
+    fan.m_RayEnds.resize(fan.m_RayCount);
+    fan.m_Spans.clear();
 
-    intPos[X] = floorf(start.m_X);
-    intPos[Y] = floorf(start.m_Y);
-    delta[X] = floorf(start.m_X + ray.m_X) - intPos[X];
-    delta[Y] = floorf(start.m_Y + ray.m_Y) - intPos[Y];
-    // The fraction of a pixel that we start from, to be added to the integer result positions for accuracy
-    Vector startFraction(start.m_X - intPos[X], start.m_Y - intPos[Y]);
-
-    if (delta[X] == 0 && delta[Y] == 0)
-        return false;
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm preparation
-
-    if (delta[X] < 0)
+    for (int ray = 0; ray < fan.m_RayCount; ++ray)
     {
-        increment[X] = -1;
-        delta[X] = -delta[X];
-    }
-    else
-        increment[X] = 1;
-
-    if (delta[Y] < 0)
-    {
-        increment[Y] = -1;
-        delta[Y] = -delta[Y];
-    }
-    else
-        increment[Y] = 1;
-
-    // Scale by 2, for better accuracy of the error at the first pixel
-    delta2[X] = delta[X] << 1;
-    delta2[Y] = delta[Y] << 1;
-
-    // If X is dominant, Y is submissive, and vice versa.
-    if (delta[X] > delta[Y]) {
-        dom = X;
-        sub = Y;
-    }
-    else {
-        dom = Y;
-        sub = X;
-    }
-
-    error = delta2[sub] - delta[dom];
-
-    /////////////////////////////////////////////////////
-    // Bresenham's line drawing algorithm execution
-
-    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
-    {
-        intPos[dom] += increment[dom];
-        if (error >= 0)
+        float angle = fan.m_StartAngle + fan.m_AngleStep * static_cast<float>(ray);
+        float directionX = cos(angle);
+        float directionY = sin(angle);
+        float reach = fan.m_Range;
+        int totalStrength = 0;
+
+        // Add up the strengths of the materials along the ray until they're too much to see through, always checking the very end
+        for (float distance = static_cast<float>(fan.m_Step); ; distance += static_cast<float>(fan.m_Step))
         {
-            intPos[sub] += increment[sub];
-            error -= delta2[dom];
-        }
-        error += delta2[sub];
-
-        // Only check pixel if we're not due to skip any, or if this is the last pixel
-        if (++skipped > skip || domSteps + 1 == delta[dom])
-        {
-            // Scene wrapping, if necessary
-            g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
-
-            unsigned char checkMat = GetTerrMatter(intPos[X], intPos[Y]);
-            MOID checkMOID = GetMOIDPixel(intPos[X], intPos[Y]);
-
-            // Translate any found MOID into the root MOID of that hit MO
-            if (checkMOID != g_NoMOID)
+            bool lastCheck = distance >= fan.m_Range;
+            if (lastCheck)
+                distance = fan.m_Range;
+
+            unsigned char materialID = sampler.GetTerrMatter(static_cast<int>(floorf(fan.m_Start.m_X + directionX * distance)), static_cast<int>(floorf(fan.m_Start.m_Y + directionY * distance)));
+            const Material *pMaterial = m_apMatPalette[materialID] ? m_apMatPalette[materialID] : m_apMatPalette[g_MaterialAir];
+            totalStrength += pMaterial->strength;
+            if (totalStrength >= fan.m_StrengthLimit)
             {
-                MovableObject *pHitMO = g_MovableMan.GetMOFromID(checkMOID);
-                if (pHitMO)
-                {
-                    checkMOID = pHitMO->GetRootID();
-                    // Check if we're supposed to ignore the team of what we hit
-                    if (ignoreTeam != Activity::NOTEAM)
-                    {
-                        pHitMO = pHitMO->GetRootParent();
-                        // We are indeed supposed to ignore this object because of its ignoring of its specific team
-                        if (pHitMO && pHitMO->IgnoresTeamHits() && pHitMO->GetTeam() == ignoreTeam)
-                            checkMOID = g_NoMOID;
-                    }
-                }
-            }
-
-            // See if we found the looked-for pixel of the correct material,
-            // Or an MO is blocking the way
-            if ((checkMat != g_MaterialAir && checkMat != ignoreMaterial) || (checkMOID != g_NoMOID && checkMOID != ignoreMOID))
-            {
-                hitObstacle = true;
-                obstaclePos.SetXY(intPos[X], intPos[Y]);
-                // Save last ray pos
-                m_LastRayHitPos.SetIntXY(intPos[X], intPos[Y]);
+                reach = distance;
                 break;
             }
-            else
-                freePos.SetXY(intPos[X], intPos[Y]);
+            if (lastCheck)
+                break;
+        }
 
-            skipped = 0;
+        fan.m_RayEnds[ray].SetXY((fan.m_Start.m_X + directionX * reach) * fan.m_UnseenScale.m_X, (fan.m_Start.m_Y + directionY * reach) * fan.m_UnseenScale.m_Y);
+    }
 
-#ifdef DEBUG_BUILD
-            // Draw debug graphics, if applicable
-            if (m_pDebugLayer)
-                m_pDebugLayer->SetPixel(intPos[X], intPos[Y], 13);
-#endif
-        }
+    // Everything between the start and each pair of neighboring ray ends was seen. A lone ray still covers the line to its end
+    Vector start(fan.m_Start.m_X * fan.m_UnseenScale.m_X, fan.m_Start.m_Y * fan.m_UnseenScale.m_Y);
+    for (int ray = 0; ray < MAX(fan.m_RayCount - 1, 1); ++ray)
+        AddTriangleSpans(fan.m_Spans, start, fan.m_RayEnds[ray], fan.m_RayEnds[MIN(ray + 1, fan.m_RayCount - 1)]);
+
+    // Merge the runs that overlap or touch, so each pixel is only looked at once when revealing
+    std::sort(fan.m_Spans.begin(), fan.m_Spans.end());
+    size_t mergedCount = 0;
+    for (size_t span = 0; span < fan.m_Spans.size(); ++span)
+    {
+        if (mergedCount > 0 && fan.m_Spans[mergedCount - 1].m_Row == fan.m_Spans[span].m_Row && fan.m_Spans[span].m_Left <= fan.m_Spans[mergedCount - 1].m_Right + 1)
+            fan.m_Spans[mergedCount - 1].m_Right = MAX(fan.m_Spans[mergedCount - 1].m_Right, fan.m_Spans[span].m_Right);
         else
-            freePos.SetXY(intPos[X], intPos[Y]);
+            fan.m_Spans[mergedCount++] = fan.m_Spans[span];
     }
+    fan.m_Spans.resize(mergedCount);
+}
 
-#ifdef DEBUG_BUILD
-    if (m_pDebugLayer)
-        m_pDebugLayer->UnlockBitmaps();
-#endif
 
-    // Add the pixel fraction to the free position if there were any free pixels
-    if (domSteps != 0)
-        freePos += startFraction;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RevealUnseenRow
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reveals all the unseen pixels on part of a row of a team's unseen layer,
+//                  and adds the runs revealed to the Scene's seen pixels.
 
-    if (hitObstacle)
+int SceneMan::RevealUnseenRow(int team, int row, int left, int right)
+{
+    // The unseen layers are 8 bit memory bitmaps, so their rows can be poked at directly
+    unsigned char *pRow = m_pCurrentScene->GetUnseenLayer(team)->GetBitmap()->line[row];
+    int revealedCount = 0;
+
+    for (int posX = left; posX <= right; ++posX)
     {
-        // Add the pixel fraction to the obstacle position, to acoid losing precision
-        obstaclePos += startFraction;
-        // If there was an obstacle on the start position, return 0 as the distance to obstacle
-        if (domSteps == 0)
-            return 0;
-        // Calculate the length between the start and the found material pixel coords
-        else
-            return g_SceneMan.ShortestDistance(obstaclePos, start).GetMagnitude();
+        if (pRow[posX] == g_KeyColor)
+            continue;
+
+        int runStart = posX;
+        while (posX <= right && pRow[posX] != g_KeyColor)
+            ++posX;
+        memset(pRow + runStart, g_KeyColor, posX - runStart);
+        m_pCurrentScene->AddSeenPixels(runStart, row, posX - runStart, team);
+        revealedCount += posX - runStart;
     }
 
-    // Didn't hit anything but air
-    return -1.0;
+    return revealedCount;
 }
 
 
@@ -3392,8 +3957,16 @@ void SceneMan::RegisterPostEffect(const Vector &effectPos, BITMAP *pEffect, size
 {
     // These effects get applied when there's a drawn frame that followed one or more sim updates
     // They are not only registered on drawn sim updates; flashes and stuff could be missed otherwise if they occur on undrawn sim updates
-    if (pEffect && /*g_TimerMan.DrawnSimUpdate()) && */g_TimerMan.SimUpdatesSinceDrawn() >= 0)
-        m_PostSceneEffects.push_back(PostEffect(effectPos, pEffect, hash, strength, angle));
+    if (pEffect && m_RegisterPostEffects && /*g_TimerMan.DrawnSimUpdate()) && */g_TimerMan.SimUpdatesSinceDrawn() >= 0)
+    {
+        if (ThreadMan::IsInParallelJob())
+        {
+            Vector pos = effectPos;
+            g_ThreadMan.DeferCommand([=]() { m_PostSceneEffects.push_back(PostEffect(pos, pEffect, hash, strength, angle)); });
+        }
+        else
+            m_PostSceneEffects.push_back(PostEffect(effectPos, pEffect, hash, strength, angle));
+    }
 }
 
 
@@ -3610,6 +4183,24 @@ bool SceneMan::AddSceneObject(SceneObject *pObject)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSim
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the parts of the current Scene that go along with the
+//                  simulation, like handing path requests to the pathfinding thread.
+
+void SceneMan::UpdateSim()
+{
+    if (!m_pCurrentScene)
+        return;
+
+    static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("SceneMan::UpdateSim");
+    ProfileZone profileZone(s_ProfilerZoneID);
+
+    m_pCurrentScene->UpdateSim();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3620,6 +4211,9 @@ void SceneMan::Update(int screen)
 {
 	RTEAssert(m_pCurrentScene, "Trying to access scene before there is one!");
 
+    static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("SceneMan::Update");
+    ProfileZone profileZone(s_ProfilerZoneID);
+
     // Record screen was the last updated screen
     m_LastUpdatedScreen = screen;
 
@@ -3843,14 +4437,100 @@ void SceneMan::Draw(BITMAP *pTargetBitmap, BITMAP *pTargetGUIBitmap, const Vecto
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOColorViewArea
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the bounding box of what all the screens are showing of the Scene,
+//                  and where they're scrolling to, plus a margin.
+
+IntRect SceneMan::GetMOColorViewArea() const
+{
+    int sceneWidth = m_pMOColorLayer->GetBitmap()->w;
+    int sceneHeight = m_pMOColorLayer->GetBitmap()->h;
+    bool wrapsX = SceneWrapsX();
+    bool wrapsY = SceneWrapsY();
+
+    // Brings one axis of a view onto the Scene, returning whether any of it is left
+    auto placeSpan = [](int &low, int &high, int size, bool wraps) {
+        if (wraps)
+        {
+            int length = high - low;
+            low %= size;
+            if (low < 0)
+                low += size;
+            high = low + length;
+            // Straddling the seam or bigger than the whole Scene, so all of it
+            if (high >= size)
+            {
+                low = 0;
+                high = size - 1;
+            }
+        }
+        else
+        {
+            low = MAX(low, 0);
+            high = MIN(high, size - 1);
+        }
+        return low <= high;
+    };
+
+    IntRect area(sceneWidth, sceneHeight, -1, -1);
+    for (int screen = 0; screen < g_FrameMan.GetScreenCount(); ++screen)
+    {
+        int viewWidth = g_FrameMan.GetPlayerFrameBufferWidth(screen);
+        int viewHeight = g_FrameMan.GetPlayerFrameBufferHeight(screen);
+        // Both where the view is now and where it's scrolling to, in case it jumps there before being drawn
+        Vector viewCorners[2] = { m_Offset[screen], m_ScrollTarget[screen] - Vector(viewWidth / 2, viewHeight / 2) };
+
+        for (int view = 0; view < 2; ++view)
+        {
+            int left = viewCorners[view].GetFloorIntX() - c_MOColorViewMargin;
+            int top = viewCorners[view].GetFloorIntY() - c_MOColorViewMargin;
+            int right = left + viewWidth + c_MOColorViewMargin * 2;
+            int bottom = top + viewHeight + c_MOColorViewMargin * 2;
+            if (placeSpan(left, right, sceneWidth, wrapsX) && placeSpan(top, bottom, sceneHeight, wrapsY))
+            {
+                area.m_Left = MIN(area.m_Left, left);
+                area.m_Top = MIN(area.m_Top, top);
+                area.m_Right = MAX(area.m_Right, right);
+                area.m_Bottom = MAX(area.m_Bottom, bottom);
+            }
+        }
+    }
+
+    // No views on the Scene at all, so leave just a single pixel to draw in
+    if (area.m_Right < area.m_Left || area.m_Bottom < area.m_Top)
+        area = IntRect(0, 0, 0, 0);
+
+    return area;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOColorLayer
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears the color MO layer. Should be done every frame.
+// Description:     Clears the color MO layer. Should be done every frame. Can be scoped to
+//                  the areas around what the screens are showing.
 
-void SceneMan::ClearMOColorLayer()
+void SceneMan::ClearMOColorLayer(bool viewportsOnly)
 {
-    clear_to_color(m_pMOColorLayer->GetBitmap(), g_KeyColor);
+    BITMAP *pLayerBitmap = m_pMOColorLayer->GetBitmap();
+
+    if (!viewportsOnly)
+    {
+        set_clip_rect(pLayerBitmap, 0, 0, pLayerBitmap->w - 1, pLayerBitmap->h - 1);
+        clear_to_color(pLayerBitmap, g_KeyColor);
+        m_MOColorDrawnArea = IntRect(0, 0, pLayerBitmap->w - 1, pLayerBitmap->h - 1);
+    }
+    else
+    {
+        // Nothing could've been drawn outside of last time's area, so that's all there is to clear
+        set_clip_rect(pLayerBitmap, 0, 0, pLayerBitmap->w - 1, pLayerBitmap->h - 1);
+        rectfill(pLayerBitmap, m_MOColorDrawnArea.m_Left, m_MOColorDrawnArea.m_Top, m_MOColorDrawnArea.m_Right, m_MOColorDrawnArea.m_Bottom, g_KeyColor);
+
+        m_MOColorDrawnArea = GetMOColorViewArea();
+        set_clip_rect(pLayerBitmap, m_MOColorDrawnArea.m_Left, m_MOColorDrawnArea.m_Top, m_MOColorDrawnArea.m_Right, m_MOColorDrawnArea.m_Bottom);
+    }
 
 #ifdef DEBUG_BUILD
     clear_to_color(m_pDebugLayer->GetBitmap(), g_KeyColor);
@@ -104,6 +104,245 @@ struct IntRect
 };
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          SceneSampler
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A direct view into the current Scene's terrain material and MOID
+//                  bitmaps: their raw row pointers, dimensions and wrapping, captured once
+//                  so that tight per-pixel loops can sample them without re-fetching the
+//                  bitmaps, bounds checking through several layers and calling getpixel.
+//                  Behaves exactly like SceneMan's WrapPosition, GetTerrMatter and
+//                  GetMOIDPixel. Get it from SceneMan::GetSceneSampler.
+// Parent(s):       None.
+// Class history:   10/18/2020 SceneSampler created.
+
+struct SceneSampler
+{
+    // Row pointers of the terrain material bitmap (8 bpp) and the MOID layer bitmap (c_MOIDLayerBitDepth bpp). Not owned
+    unsigned char **m_ppMaterialRows;
+    unsigned char **m_ppMOIDRows;
+    // Dimensions of the terrain, which are also what positions are wrapped to
+    int m_Width;
+    int m_Height;
+    // Dimensions of the MOID layer
+    int m_MOIDWidth;
+    int m_MOIDHeight;
+    // Whether the terrain wraps in each axis
+    bool m_WrapsX;
+    bool m_WrapsY;
+
+    SceneSampler() { m_ppMaterialRows = m_ppMOIDRows = 0; m_Width = m_Height = m_MOIDWidth = m_MOIDHeight = 0; m_WrapsX = m_WrapsY = false; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WrapPosition
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Only wraps a pixel position if it is off bounds of the terrain and
+//                  wrapping in the corresponding axis is turned on.
+// Arguments:       The X and Y coordinates of the position to wrap, in place.
+// Return value:    Whether wrapping was performed or not.
+
+    bool WrapPosition(int &posX, int &posY) const
+    {
+        bool wrapped = false;
+        if (m_WrapsX && (posX < 0 || posX >= m_Width))
+        {
+            posX %= m_Width;
+            if (posX < 0)
+                posX += m_Width;
+            wrapped = true;
+        }
+        if (m_WrapsY && (posY < 0 || posY >= m_Height))
+        {
+            posY %= m_Height;
+            if (posY < 0)
+                posY += m_Height;
+            wrapped = true;
+        }
+        return wrapped;
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetTerrMatter
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the terrain material at a pixel position, which will be wrapped
+//                  first. Anything out of bounds is air.
+// Arguments:       The X and Y coordinates of the pixel.
+// Return value:    The material ID at that pixel.
+
+    unsigned char GetTerrMatter(int posX, int posY) const
+    {
+        WrapPosition(posX, posY);
+        if (posX < 0 || posX >= m_Width || posY < 0 || posY >= m_Height)
+            return g_MaterialAir;
+        return m_ppMaterialRows[posY][posX];
+    }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOIDPixel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the MOID at a pixel position, which will be wrapped first.
+//                  Anything out of bounds is g_NoMOID.
+// Arguments:       The X and Y coordinates of the pixel.
+// Return value:    The MOID at that pixel.
+
+    MOID GetMOIDPixel(int posX, int posY) const
+    {
+        WrapPosition(posX, posY);
+        if (posX < 0 || posX >= m_MOIDWidth || posY < 0 || posY >= m_MOIDHeight)
+            return g_NoMOID;
+        return reinterpret_cast<unsigned short *>(m_ppMOIDRows[posY])[posX];
+    }
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          TerrainComponent
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A connected piece of terrain, as found by
+//                  SceneMan::FindTerrainComponent. Can be reused between searches so its
+//                  pixel list doesn't have to be reallocated each time.
+// Parent(s):       None.
+// Class history:   10/18/2020 TerrainComponent created.
+
+struct TerrainComponent
+{
+    // A pixel of the piece, in scene coordinates
+    struct Pixel
+    {
+        int m_X;
+        int m_Y;
+    };
+
+    // All the pixels of the piece, in the order they were found
+    std::vector<Pixel> m_Pixels;
+    // The bounding box of the pixels, with the right and bottom edges exclusive
+    IntRect m_Bounds;
+    // Whether the whole piece was found, ie the search didn't reach the edge of its area or give up because the piece grew too big
+    bool m_Complete;
+
+    TerrainComponent() { m_Complete = false; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          RayQuery
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     One ray for SceneMan::CastRays to trace, and what it is looking for.
+//                  The fields mean the same as the arguments of the Cast*Ray method
+//                  corresponding to its type.
+// Parent(s):       None.
+// Class history:   10/18/2020 RayQuery created.
+
+struct RayQuery
+{
+    // What the ray is looking for
+    enum RayType
+    {
+        // The first MO not ignored, stopping at any non-ignored terrain. Like CastMORay
+        MORAY = 0,
+        // A specific MO, stopping at any non-ignored terrain. Like CastFindMORay
+        FINDMORAY,
+        // The first MO or non-ignored terrain at all. Like CastObstacleRay
+        OBSTACLERAY
+    };
+
+    RayType m_Type;
+    // The starting position and the vector to trace along
+    Vector m_Start;
+    Vector m_Ray;
+    // The MOID to ignore, along with its children, or the one to find for FINDMORAY
+    MOID m_MOID;
+    // The team whose MOs that ignore team hits are ignored, or Activity::NOTEAM
+    int m_IgnoreTeam;
+    // A material to not stop at
+    unsigned char m_IgnoreMaterial;
+    // Whether to go through all terrain. Not used by OBSTACLERAY
+    bool m_IgnoreAllTerrain;
+    // How many pixels to skip between each one checked. The last pixel is always checked
+    int m_Skip;
+
+    RayQuery() { m_Type = MORAY; m_MOID = g_NoMOID; m_IgnoreTeam = Activity::NOTEAM; m_IgnoreMaterial = 0; m_IgnoreAllTerrain = false; m_Skip = 0; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          RayHit
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     What SceneMan::CastRays found along one RayQuery.
+// Parent(s):       None.
+// Class history:   10/18/2020 RayHit created.
+
+struct RayHit
+{
+    // Whether the ray was stopped by anything before reaching its end
+    bool m_Stopped;
+    // The MOID of what stopped the ray, or g_NoMOID if it was terrain or nothing. For OBSTACLERAY this is the root MOID
+    MOID m_HitMOID;
+    // Whether it was terrain that stopped the ray
+    bool m_HitTerrain;
+    // The wrapped pixel position the ray was stopped at
+    Vector m_StopPos;
+    // The last pixel position before the stop, or the end of the ray. Only valid if m_Steps isn't 0
+    Vector m_FreePos;
+    // How many pixels the ray went along before being stopped, or its whole length
+    int m_Steps;
+    // Whether the start and end of the ray are in the same pixel, in which case nothing was traced
+    bool m_ZeroLength;
+
+    RayHit() { m_Stopped = false; m_HitMOID = g_NoMOID; m_HitTerrain = false; m_Steps = 0; m_ZeroLength = false; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Struct:          VisibilityFan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     A fan of seeing rays queued with SceneMan::AddVisibilityFan, and the
+//                  runs of unseen layer pixels it was found to reach.
+// Parent(s):       None.
+// Class history:   10/18/2020 VisibilityFan created.
+
+struct VisibilityFan
+{
+    // A run of pixels on one row of the unseen layer, with both ends inclusive and not wrapped
+    struct Span
+    {
+        int m_Row;
+        int m_Left;
+        int m_Right;
+
+        bool operator<(const Span &rhs) const { return m_Row < rhs.m_Row || (m_Row == rhs.m_Row && m_Left < rhs.m_Left); }
+    };
+
+    // The team seeing
+    int m_Team;
+    // The unique ID of the Actor the fan is for, to let know whether it revealed anything, or 0 if none
+    long int m_SeerID;
+    // Where the rays start from
+    Vector m_Start;
+    // The angle in radians of the first ray, and the angle between each ray and the next
+    float m_StartAngle;
+    float m_AngleStep;
+    int m_RayCount;
+    // How far the rays go if nothing stops them
+    float m_Range;
+    // The accumulated material strength that stops a ray
+    int m_StrengthLimit;
+    // How many pixels apart the terrain is checked along the rays
+    int m_Step;
+    // What to multiply Scene positions by to get positions on the team's unseen layer
+    Vector m_UnseenScale;
+    // Where each ray was stopped, on the unseen layer and not wrapped
+    std::vector<Vector> m_RayEnds;
+    // The runs of unseen layer pixels the rays reach, sorted and merged
+    std::vector<Span> m_Spans;
+
+    VisibilityFan() { m_Team = Activity::NOTEAM; m_SeerID = 0; m_StartAngle = m_AngleStep = m_Range = 0; m_RayCount = m_StrengthLimit = 0; m_Step = 1; }
+};
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Class:           SceneMan
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -130,7 +369,7 @@ public:
 //                  memory. Create() should be called before using the object.
 // Arguments:       None.
 
-    SceneMan() { m_pOrphanSearchBitmap = 0; Clear(); }
+    SceneMan() { Clear(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -288,7 +527,7 @@ public:
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -407,6 +646,17 @@ public:
     Material const * GetMaterialFromID(unsigned char screen) { return screen >= 0 && screen < c_PaletteEntriesNumber && m_apMatPalette[screen] ?  m_apMatPalette[screen] : m_apMatPalette[g_MaterialAir]; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetWeakestMaterialStrength
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the lowest strength of all the non-air Material:s in the palette.
+//                  An impulse weaker than this can't knock loose any pixel of terrain.
+// Arguments:       None.
+// Return value:    The strength of the weakest Material.
+
+    float GetWeakestMaterialStrength() const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SceneWrapsX
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -571,6 +821,20 @@ public:
     MOID GetMOIDPixel(int pixelX, int pixelY);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetSceneSampler
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a direct view into the current Scene's material and MOID
+//                  bitmaps for fast per-pixel sampling. While the Scene is locked, this
+//                  is a copy of the view captured by LockScene(). Otherwise a fresh view is
+//                  captured for each call, so it can be called from several threads at once.
+// Arguments:       None.
+// Return value:    The SceneSampler of the current Scene. Only valid until the Scene is
+//                  unlocked, or as long as its bitmaps aren't replaced if it isn't locked.
+
+    SceneSampler GetSceneSampler() const { return m_SceneSamplerLocked ? m_SceneSampler : CaptureSceneSampler(); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetGlobalAcc
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -821,7 +1085,7 @@ public:
 //                  end of this sim update.
 // Return value:    None.
 
-    void RegisterMOIDDrawing(int left, int top, int right, int bottom) { m_MOIDDrawings.push_back(IntRect(left, top, right, bottom)); }
+    void RegisterMOIDDrawing(int left, int top, int right, int bottom) { m_MOIDDrawings.push_back(IntRect(left, top, right, bottom)); MarkRayTilesOccupied(left, top, right, bottom, false); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -847,6 +1111,18 @@ public:
     void ClearAllMOIDDrawings();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakeMOIDDrawings
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Moves all registered drawn areas of the MOID layer over to the end of
+//                  a list, without clearing anything on the layer. The caller becomes
+//                  responsible for clearing those areas again when appropriate.
+// Arguments:       The list to move the registered areas to.
+// Return value:    None.
+
+    void TakeMOIDDrawings(std::list<IntRect> &drawings) { drawings.splice(drawings.end(), m_MOIDDrawings); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOIDRect
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -936,38 +1212,44 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RemoveOrphans
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Returns the area of an orphaned region at specified coordinates. 
-// Arguments:       Coordinates to check for region, whether the orphaned region should be converted into MOPixels and region removed.
-//					Area of orphaned object calculated during recursve function call to check if we're out of limits
-//					Size of the are to look for orphaned objects
+// Description:     Returns the area of an orphaned region at specified coordinates and removes the region if requested.
+// Arguments:       Coordinates to check for region.
+//					Size of the are to look for orphaned objects, up to MAXORPHANRADIUS.
 //					Max area of orphaned object to remove
 //					Whether to actually remove orphaned pixels or not
-//					Whether to clear internal terrain tracking bitmap or not
 // Return value:    The area of orphaned region at posX,posY
 
     int RemoveOrphans(int posX, int posY, int radius, int maxArea, bool remove = false);
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          RemoveOrphans
+// Method:          FindTerrainComponent
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Returns the area of an orphaned region at specified coordinates. 
-// Arguments:       Coordinates to check for region, whether the orphaned region should be converted into MOPixels and region removed.
-//					Coordinates of initial terrain penetration to check, which serves as a center of orphaned object detection.
-//					Area of orphaned object calculated during recursve function call to check if we're out of limits
-//					Size of the are to look for orphaned objects
-//					Max area of orphaned object to remove
-//					Whether to actually remove orphaned pixels or not
-//					Whether to clear internal terrain tracking bitmap or not
-// Return value:    The area of orphaned region at posX,posY
+// Description:     Finds the piece of terrain connected to a pixel, diagonals included,
+//                  within a square search area centered on it. Nothing is changed, the
+//                  piece can be removed afterwards with RemoveTerrainComponent. The search
+//                  is iterative, so the search area can be as big as needed.
+// Arguments:       The scene coordinates of the pixel to start from. It's always part of
+//                  the piece, even if it's air.
+//                  The width and height of the square area to search.
+//                  The max area of the piece to look for. The search gives up as soon as
+//                  the piece grows bigger than this.
+//                  The TerrainComponent to fill out with the found piece.
+// Return value:    The area of the piece. If the search reached the edge of the search
+//                  area, ie the piece isn't orphaned, or gave up, this is more than
+//                  maxArea and the TerrainComponent isn't complete.
+
+    int FindTerrainComponent(int posX, int posY, int searchSize, int maxArea, TerrainComponent &component);
 
-    int RemoveOrphans(int posX,
-					  int posY,
-					  int centerPosX,
-					  int centerPosY,
-					  int accumulatedArea,
-					  int radius,
-					  int maxArea,
-					  bool remove = false);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RemoveTerrainComponent
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes all the pixels of a piece of terrain found by
+//                  FindTerrainComponent, turning them into MOPixels.
+// Arguments:       The piece of terrain to remove.
+// Return value:    None.
+
+    void RemoveTerrainComponent(const TerrainComponent &component);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          MakeAllUnseen
@@ -1137,6 +1419,59 @@ public:
 	bool CastUnseeRay(int team, const Vector &start, const Vector &ray, Vector &endPos, int strengthLimit, int skip = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddVisibilityFan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a fan of seeing rays for a team, to be traced together with all
+//                  the others queued this frame on the next UpdateVisibility. The rays are
+//                  spread closely enough to not miss any pixel of the team's unseen layer,
+//                  and everything between them and the start gets revealed.
+// Arguments:       The team to see for.
+//                  The starting position.
+//                  The middle ray of the fan, as long as all the rays should go.
+//                  How many degrees the fan spreads to each side of the middle ray.
+//                  The material strength limit where the rays are stopped.
+//                  The unique ID of the Actor to let know whether the fan revealed
+//                  anything once it's been traced, or 0 for none.
+// Return value:    Whether the fan was queued. It isn't if the team has no unseen layer.
+
+    bool AddVisibilityFan(int team, const Vector &start, const Vector &ray, float spreadAngle, int strengthLimit, long int seerID = 0);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateVisibility
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces all the visibility fans queued since the last update across all
+//                  threads, then reveals what they reached on the unseen layers a run of
+//                  pixels at a time. Should be called while the Scene is locked.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateVisibility();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsVisibilityFansEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether Actors look around with visibility fans instead of single
+//                  random seeing rays.
+// Arguments:       None.
+// Return value:    Whether visibility fans are enabled.
+
+    bool IsVisibilityFansEnabled() const { return m_VisibilityFansEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableVisibilityFans
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether Actors look around with visibility fans instead of single
+//                  random seeing rays.
+// Arguments:       Whether to enable visibility fans.
+// Return value:    None.
+
+    void EnableVisibilityFans(bool enable = true) { m_VisibilityFansEnabled = enable; }
+
+
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1349,6 +1684,39 @@ public:
     float CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID = g_NoMOID, int ignoreTeam = Activity::NOTEAM, unsigned char ignoreMaterial = 0, int skip = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces a whole batch of rays, filling out a hit record for each. Stretches
+//                  of the Scene with nothing a ray could hit are stepped over using a
+//                  coarse summary of the terrain and MOID layers, and big batches are
+//                  spread across threads. Doesn't touch any shared state, so it can also
+//                  be called from inside a parallel job, in which case it all runs on the
+//                  calling thread. Doesn't set the last ray hit position.
+// Arguments:       The rays to trace.
+//                  Where to put the hit records, one for each ray.
+//                  How many rays there are.
+// Return value:    None.
+
+    void CastRays(const RayQuery *pQueries, RayHit *pHits, int count);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          MarkRayTilesOccupied
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells CastRays that something may have been drawn within an area of the
+//                  terrain material or MOID layer, so it won't step over that area without
+//                  looking until it has been summarized again. Anything that adds to either
+//                  layer mid-frame must call this, which the terrain change and MOID drawing
+//                  registrations already do. Safe to call from inside parallel jobs.
+// Arguments:       The area that can be unwrapped and may be out of bounds of the Scene,
+//                  with all edges inclusive.
+//                  Whether it was the terrain material that was drawn to, or the MOID layer.
+// Return value:    None.
+
+    void MarkRayTilesOccupied(int left, int top, int right, int bottom, bool terrain);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetLastRayHitPos
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1617,6 +1985,17 @@ public:
     void RegisterPostEffect(const Vector &effectPos, BITMAP *pEffect, size_t hash, int strength = 255, float angle = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetRegisterPostEffects
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether post effects and glow areas get registered at all, so
+//                  things can be drawn again without their effects being added twice.
+// Arguments:       Whether to register post effects and glow areas.
+// Return value:    None.
+
+    void SetRegisterPostEffects(bool registerEffects = true) { m_RegisterPostEffects = registerEffects; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RegisterGlowDotEffect
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1656,7 +2035,7 @@ public:
 // Arguments:       The IntRect to have special color pixels glow in, in scene coordinates.
 // Return value:    None.
 
-    void RegisterGlowArea(const IntRect &glowArea) { if (g_TimerMan.DrawnSimUpdate() && g_TimerMan.SimUpdatesSinceDrawn() >= 0) m_GlowAreas.push_back(glowArea); }
+    void RegisterGlowArea(const IntRect &glowArea) { if (m_RegisterPostEffects && g_TimerMan.DrawnSimUpdate() && g_TimerMan.SimUpdatesSinceDrawn() >= 0) m_GlowAreas.push_back(glowArea); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1721,6 +2100,18 @@ public:
     void Update(int screen = 0);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateSim
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the parts of the current Scene that go along with the
+//                  simulation, like handing path requests to the pathfinding thread.
+//                  Supposed to be done once every sim update, after the MovableMan update.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateSim();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Draw
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1738,11 +2129,14 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearMOColorLayer
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears the color MO layer. Should be done every frame.
-// Arguments:       None.
+// Description:     Clears the color MO layer. Should be done every frame. Can be scoped to
+//                  the areas around what the screens are showing, in which case only what
+//                  could have been drawn on last time is cleared, and the layer's clipping
+//                  rectangle is set so nothing is drawn anywhere else until next time.
+// Arguments:       Whether to only clear and draw around the screens' views.
 // Return value:    None.
 
-    void ClearMOColorLayer();
+    void ClearMOColorLayer(bool viewportsOnly = false);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1786,16 +2180,28 @@ public:
     Material * AddMaterialCopy(Material *mat);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RemoveModuleMaterials
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Removes all the Material:s a DataModule added to the palette, freeing
+//                  up their slots, for when the DataModule is loaded over again.
+// Arguments:       The ID of the DataModule whose Material:s to remove.
+// Return value:    None.
+
+    void RemoveModuleMaterials(int whichModule);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RegisterTerrainChange
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Registers terrain change event for the network server to be then sent to clients.
+//                  The server gathers these into tiles and sends each changed tile once
+//                  per frame, so registering many small changes is cheap.
 // Arguments:       x,y - scene coordinates of change, w,h - size of the changed region, 
-//					color - changed color for one-pixel events, 
 //					back - if true, then background bitmap was changed if false then foreground.
 // Return value:    None.
 
-	void RegisterTerrainChange(int x, int y, int w, int h, unsigned char color, bool back);
+	void RegisterTerrainChange(int x, int y, int w, int h, bool back);
 
 
 	//	Struct to register terrain change events
@@ -1805,7 +2211,6 @@ public:
 		int y;
 		int w;
 		int h;
-		unsigned char color;
 		bool back;
 	};
 
@@ -1866,12 +2271,47 @@ protected:
     SceneLayer *m_pMOColorLayer;
     // MovableObject ID layer
     SceneLayer *m_pMOIDLayer;
+    // The area of the color MO layer that could have been drawn on since it was last cleared, with all edges inclusive
+    IntRect m_MOColorDrawnArea;
+    // How far around the screens' views MOs are still drawn onto the color MO layer when it is scoped to them, to cover the views moving before they're drawn
+    static const int c_MOColorViewMargin = 128;
+    // Direct view of the terrain material and MOID bitmaps, for the innermost physics loops
+    SceneSampler m_SceneSampler;
+    // Whether the view above was captured by LockScene() and stays valid until the Scene is unlocked
+    bool m_SceneSamplerLocked;
+    // Stamps of which pixels of the search area FindTerrainComponent has visited. A pixel is visited if its stamp is the current generation, so nothing needs clearing between searches
+    std::vector<unsigned int> m_ComponentSearchStamps;
+    // The generation of the current FindTerrainComponent search
+    unsigned int m_ComponentSearchGeneration;
+    // The pixels FindTerrainComponent found but hasn't looked around yet, as indices into the search area
+    std::vector<int> m_ComponentSearchStack;
+    // The piece of terrain found by the last RemoveOrphans
+    TerrainComponent m_OrphanComponent;
+    // Width and height in pixels of the coarse tiles CastRays summarizes the Scene in
+    static const int c_RayTileSize = 32;
+    // Tile summary flags, kept in the low bits of each tile below
+    enum RayTileFlags
+    {
+        RAYTILE_AIR = 1,
+        RAYTILE_NOMO = 2,
+        RAYTILE_FLAGBITS = 2
+    };
+    // The summary of each tile, row by row: the frame stamp it was made in above the flag bits. Flags are only trusted if the stamp is current, otherwise the tile gets looked at again. Owned
+    std::atomic<unsigned int> *m_aRayTiles;
+    int m_RayTileCountX;
+    int m_RayTileCountY;
+    // The stamp of tiles that were summarized this frame
+    unsigned int m_RayTileStamp;
+    // The view of the bitmaps the tiles were made for, to tell when the Scene has changed under them
+    SceneSampler m_RayTileSampler;
     // All the areas drawn within on the MOID layer since last Update
     std::list<IntRect> m_MOIDDrawings;
     // All post-processing effects registered for this draw frame in the scene. Vector in scene coordinates, BITMAPs not owned
     std::list<PostEffect> m_PostSceneEffects;
     // All the areas to do post glow pixel effects on, in scene coordinates
     std::list<IntRect> m_GlowAreas;
+    // Whether post effects and glow areas get registered at all
+    bool m_RegisterPostEffects;
 
     // Debug layer for seeing cast rays etc
     SceneLayer *m_pDebugLayer;
@@ -1914,6 +2354,13 @@ protected:
 
     // Sound of an unseen pixel on an unseen layer being revealed.
     SoundContainer *m_pUnseenRevealSound;
+    // Whether Actors look around with visibility fans instead of single random seeing rays
+    bool m_VisibilityFansEnabled;
+    // The fans queued for the next UpdateVisibility. Only the first m_VisibilityFanCount are queued, the rest are kept around so their buffers get reused
+    std::vector<VisibilityFan> m_VisibilityFans;
+    int m_VisibilityFanCount;
+    // The most rays a single visibility fan is split into
+    static const int c_MaxVisibilityFanRays = 2048;
 
     // The last screen everything has been updated to
     int m_LastUpdatedScreen;
@@ -1928,8 +2375,6 @@ protected:
 
     // The Timer to measure time between cleanings of the color layer of the Terrain.
     Timer m_CleanTimer;
-	// Bitmap to look for orphaned regions
-	BITMAP * m_pOrphanSearchBitmap;
 
 
 // TODO TEMP REMOVE
@@ -1954,6 +2399,94 @@ private:
     void Clear();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CaptureSceneSampler
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Captures a SceneSampler of the current state of the Scene's material
+//                  and MOID bitmaps.
+// Arguments:       None.
+// Return value:    The new SceneSampler.
+
+    SceneSampler CaptureSceneSampler() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOColorViewArea
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the bounding box of what all the screens are showing of the Scene,
+//                  and where they're scrolling to, plus a margin. Any view straddling a
+//                  seam covers the whole Scene in that direction.
+// Arguments:       None.
+// Return value:    The area in Scene coordinates, clamped to the Scene, with all edges
+//                  inclusive.
+
+    IntRect GetMOColorViewArea() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          PrepareRayTiles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes sure the ray tiles fit the Scene as seen by a SceneSampler,
+//                  recreating them if not, and optionally marks them all for being looked
+//                  at again. Must not be called from inside a parallel job.
+// Arguments:       The view of the Scene the tiles should fit.
+//                  Whether to start over summarizing the tiles, because the layers may
+//                  have been changed without marking the tiles.
+// Return value:    None.
+
+    void PrepareRayTiles(const SceneSampler &sampler, bool newFrame);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetRayTileFlags
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the summary flags of a ray tile, looking through its pixels first if
+//                  it hasn't been summarized this frame. Safe to call from several threads.
+// Arguments:       The X and Y index of the tile.
+// Return value:    The RayTileFlags that hold for the whole tile.
+
+    unsigned int GetRayTileFlags(int tileX, int tileY) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces one ray for CastRays.
+// Arguments:       The ray to trace.
+//                  The hit record to fill out.
+//                  The view of the Scene to trace through.
+//                  Whether the ray tiles are up to date with that view and can be used.
+// Return value:    None.
+
+    void TraceRay(const RayQuery &query, RayHit &hit, const SceneSampler &sampler, bool useTiles) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceVisibilityFan
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Traces the rays of a visibility fan and works out the runs of unseen
+//                  layer pixels they reach. Only reads the terrain, so it's safe to call
+//                  from several threads on different fans.
+// Arguments:       The fan to trace and fill out the spans of.
+//                  The view of the Scene to trace through.
+// Return value:    None.
+
+    void TraceVisibilityFan(VisibilityFan &fan, const SceneSampler &sampler) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RevealUnseenRow
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Reveals all the unseen pixels on part of a row of a team's unseen layer,
+//                  and adds the runs revealed to the Scene's seen pixels.
+// Arguments:       The team whose unseen layer to reveal on. It must have one.
+//                  The row of the unseen layer, which must be on it.
+//                  The first and last pixel of the row to reveal, which must be on it.
+// Return value:    How many pixels were revealed.
+
+    int RevealUnseenRow(int team, int row, int left, int right);
+
+
     // Disallow the use of some implicit methods.
     SceneMan(const SceneMan &reference);
     SceneMan & operator=(const SceneMan &rhs);
@@ -56,6 +56,10 @@ void SettingsMan::Clear()
 	m_ForceNonOverlayedWindowGfxDriver = false;
 	m_AllowSavingToBase = false;
 	m_RecommendedMOIDCount = 240;
+	m_WorkerThreadCount = -1;
+	m_UsePresetCache = true;
+	m_LoadSpritesOnDemand = false;
+	m_UnusedSpriteMemoryBudget = 128;
     m_SoundPanningEffectStrength = 0.5;
 	m_NetworkServerName = "";
 	m_PlayerNetworkName = "";
@@ -74,6 +78,9 @@ void SettingsMan::Clear()
 	m_ServerTransmitAsBoxes = true;
 	m_ServerBoxWidth = 32;
 	m_ServerBoxHeight = 44;
+	m_ServerUseDeltaCompression = true;
+	m_ServerKeyframeInterval = 60;
+	m_ServerEncodingThreads = -1;
 
 	m_UseNATService = false;
 	m_DisableLoadingScreen = false;
@@ -128,7 +135,7 @@ int SettingsMan::Create(Reader &reader, bool checkType, bool doCreate)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int SettingsMan::ReadProperty(std::string propName, Reader &reader)
+int SettingsMan::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "ResolutionX")
         g_FrameMan.ReadProperty(propName, reader);
@@ -228,12 +235,30 @@ int SettingsMan::ReadProperty(std::string propName, Reader &reader)
         g_MovableMan.ReadProperty(propName, reader);
     else if (propName == "EnableMOSubtraction")
         g_MovableMan.ReadProperty(propName, reader);
+    else if (propName == "EnableParallelParticles")
+        g_MovableMan.ReadProperty(propName, reader);
+    else if (propName == "EnableIncrementalMOIDLayer")
+        g_MovableMan.ReadProperty(propName, reader);
+    else if (propName == "EnableMOIDLayerValidation")
+        g_MovableMan.ReadProperty(propName, reader);
+    else if (propName == "EnableViewportMOColorLayer")
+        g_MovableMan.ReadProperty(propName, reader);
+    else if (propName == "EnableVisibilityFans")
+        g_SceneMan.ReadProperty(propName, reader);
     else if (propName == "EndlessMode")
         reader >> m_EndlessMode;
     else if (propName == "PrintDebugInfo")
         reader >> m_PrintDebugInfo;
 	else if (propName == "RecommendedMOIDCount")
 		reader >> m_RecommendedMOIDCount;
+	else if (propName == "WorkerThreadCount")
+		reader >> m_WorkerThreadCount;
+	else if (propName == "UsePresetCache")
+		reader >> m_UsePresetCache;
+	else if (propName == "LoadSpritesOnDemand")
+		reader >> m_LoadSpritesOnDemand;
+	else if (propName == "UnusedSpriteMemoryBudget")
+		reader >> m_UnusedSpriteMemoryBudget;
     else if (propName == "SoundPanningEffectStrength")
         reader >> m_SoundPanningEffectStrength;
 	else if (propName == "PlayerNetworkName")
@@ -258,6 +283,12 @@ int SettingsMan::ReadProperty(std::string propName, Reader &reader)
 		reader >> m_ServerBoxWidth;
 	else if (propName == "ServerBoxHeight")
 		reader >> m_ServerBoxHeight;
+	else if (propName == "ServerUseDeltaCompression")
+		reader >> m_ServerUseDeltaCompression;
+	else if (propName == "ServerKeyframeInterval")
+		reader >> m_ServerKeyframeInterval;
+	else if (propName == "ServerEncodingThreads")
+		reader >> m_ServerEncodingThreads;
 	else if (propName == "ClientInputFps")
 		reader >> m_ClientInputFps;
 	else if (propName == "UseNATService")
@@ -390,6 +421,16 @@ int SettingsMan::Save(Writer &writer) const
     writer << g_MovableMan.IsParticleSettlingEnabled();
     writer.NewProperty("EnableMOSubtraction");
     writer << g_MovableMan.IsMOSubtractionEnabled();
+    writer.NewProperty("EnableParallelParticles");
+    writer << g_MovableMan.IsParallelParticlesEnabled();
+    writer.NewProperty("EnableIncrementalMOIDLayer");
+    writer << g_MovableMan.IsIncrementalMOIDLayerEnabled();
+    writer.NewProperty("EnableMOIDLayerValidation");
+    writer << g_MovableMan.IsMOIDLayerValidationEnabled();
+    writer.NewProperty("EnableViewportMOColorLayer");
+    writer << g_MovableMan.IsViewportMOColorLayerEnabled();
+    writer.NewProperty("EnableVisibilityFans");
+    writer << g_SceneMan.IsVisibilityFansEnabled();
     writer.NewProperty("ForceSoftwareGfxDriver");
     writer << m_ForceSoftwareGfxDriver;
     writer.NewProperty("ForceSafeGfxDriver");
@@ -406,6 +447,14 @@ int SettingsMan::Save(Writer &writer) const
     writer << m_PrintDebugInfo;
 	writer.NewProperty("RecommendedMOIDCount");
 	writer << m_RecommendedMOIDCount;
+	writer.NewProperty("WorkerThreadCount");
+	writer << m_WorkerThreadCount;
+	writer.NewProperty("UsePresetCache");
+	writer << m_UsePresetCache;
+	writer.NewProperty("LoadSpritesOnDemand");
+	writer << m_LoadSpritesOnDemand;
+	writer.NewProperty("UnusedSpriteMemoryBudget");
+	writer << m_UnusedSpriteMemoryBudget;
     writer.NewProperty("SoundPanningEffectStrength");
     writer << m_SoundPanningEffectStrength;
 	writer.NewProperty("PlayerNetworkName");
@@ -436,6 +485,12 @@ int SettingsMan::Save(Writer &writer) const
 	writer << m_ServerBoxWidth;
 	writer.NewProperty("ServerBoxHeight");
 	writer << m_ServerBoxHeight;
+	writer.NewProperty("ServerUseDeltaCompression");
+	writer << m_ServerUseDeltaCompression;
+	writer.NewProperty("ServerKeyframeInterval");
+	writer << m_ServerKeyframeInterval;
+	writer.NewProperty("ServerEncodingThreads");
+	writer << m_ServerEncodingThreads;
 	writer.NewProperty("ClientInputFps");
 	writer << m_ClientInputFps;
 	writer.NewProperty("UseNATService");
@@ -98,7 +98,7 @@ public:
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -400,6 +400,50 @@ public:
 	int RecommendedMOIDCount() const { return m_RecommendedMOIDCount; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:			GetWorkerThreadCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns how many worker threads ThreadMan should spawn for parallel
+//					jobs, in addition to the main thread.
+// Arguments:       None.
+// Return value:    Worker thread count. Negative means pick based on the hardware.
+
+	int GetWorkerThreadCount() const { return m_WorkerThreadCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:			UsePresetCache
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns whether DataModules are loaded from their saved PresetCaches
+//					when those are still valid, and have caches saved when they aren't.
+// Arguments:       None.
+// Return value:    Whether to use the PresetCaches.
+
+	bool UsePresetCache() const { return m_UsePresetCache; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:			LoadSpritesOnDemand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns whether the sprites of presets are only held in memory while
+//					something is using them, and loaded again when next needed.
+// Arguments:       None.
+// Return value:    Whether sprites are loaded on demand.
+
+	bool LoadSpritesOnDemand() const { return m_LoadSpritesOnDemand; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:			GetUnusedSpriteMemoryBudget
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Returns how many megabytes of sprites that nothing is using are kept
+//					loaded, in case they're needed again, when loading sprites on demand.
+// Arguments:       None.
+// Return value:    The budget for unused sprites, in megabytes.
+
+	int GetUnusedSpriteMemoryBudget() const { return m_UnusedSpriteMemoryBudget; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:			SetPrintDebugInfo
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -554,6 +598,24 @@ public:
 	//  
 	int GetServerBoxHeight() const { return m_ServerBoxHeight; }
 
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:			GetServerUseDeltaCompression
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Whether the server only sends the frame boxes that changed since they were last sent, diffed against what was sent.
+	bool GetServerUseDeltaCompression() const { return m_ServerUseDeltaCompression; }
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:			GetServerKeyframeInterval
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// How many frames apart the server sends every box in full when using delta compression.
+	int GetServerKeyframeInterval() const { return m_ServerKeyframeInterval; }
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:			GetServerEncodingThreads
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// How many extra threads help the per-player send threads compress frames. -1 means half the hardware threads.
+	int GetServerEncodingThreads() const { return m_ServerEncodingThreads; }
+
 	bool GetUseNATService() { return m_UseNATService; }
 
 	std::string & GetNATServiceAddress() { return m_NATServiceAddress; }
@@ -620,6 +682,14 @@ protected:
 	bool m_AllowSavingToBase;
 	// Recommended max MOID's before removing actors from scenes
 	int m_RecommendedMOIDCount;
+	// How many worker threads to use for parallel jobs, negative to pick based on the hardware
+	int m_WorkerThreadCount;
+	// Whether to load DataModules from their saved PresetCaches, and save new ones when those are out of date
+	bool m_UsePresetCache;
+	// Whether the sprites of presets are only held in memory while something is using them
+	bool m_LoadSpritesOnDemand;
+	// How many megabytes of sprites nothing is using are kept loaded when loading sprites on demand
+	int m_UnusedSpriteMemoryBudget;
 
 	std::string m_PlayerNetworkName;
 
@@ -645,6 +715,12 @@ protected:
 
 	int m_ServerBoxHeight;
 
+	bool m_ServerUseDeltaCompression;
+
+	int m_ServerKeyframeInterval;
+
+	int m_ServerEncodingThreads;
+
 	bool m_UseNATService;
 
 	std::string m_NATServiceAddress;
@@ -3,9 +3,9 @@
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Source file for the ThreadMan class.
 // Project:         Retro Terrain Engine
-// Author(s):       
-//                  
-//                  
+// Author(s):
+//
+//
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -13,16 +13,24 @@
 
 
 #include "ThreadMan.h"
+#include "ProfilerMan.h"
+#include "RTETools.h"
 
 using namespace std;
 
 namespace RTE
 {
 
-#define DELTABUFFERSIZE 30
-
 const string ThreadMan::m_ClassName = "ThreadMan";
 
+// The pool index of the thread, 0 for the main thread and any thread not owned by the pool
+static thread_local int s_ThreadIndex = 0;
+// Whether the thread is currently processing items of a parallel job
+static thread_local bool s_InParallelJob = false;
+// The job item currently being processed by this thread, and how many commands it has deferred so far
+static thread_local int s_CurrentItemIndex = 0;
+static thread_local int s_CurrentItemSequence = 0;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
@@ -32,6 +40,17 @@ const string ThreadMan::m_ClassName = "ThreadMan";
 
 void ThreadMan::Clear()
 {
+    m_Workers.clear();
+    m_JobGeneration = 0;
+    m_pJob = 0;
+    m_JobItemCount = 0;
+    m_JobBatchSize = 1;
+    m_NextJobItem = 0;
+    m_WorkersBusy = 0;
+    m_Quit = false;
+    // Always have a buffer for the main thread so commands can be deferred even without any workers
+    m_CommandBuffers.assign(1, vector<DeferredCommand>());
+    m_MergedCommands.clear();
 }
 
 
@@ -40,10 +59,19 @@ void ThreadMan::Clear()
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Makes the ThreadMan object ready for use.
 
-int ThreadMan::Create()
+int ThreadMan::Create(int workerCount)
 {
+    // Get rid of any existing pool first so this can be used to resize it
+    Destroy();
+
+    if (workerCount < 0)
+        workerCount = max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
 
-	return 0;
+    m_CommandBuffers.resize(workerCount + 1);
+    for (int i = 0; i < workerCount; ++i)
+        m_Workers.push_back(std::thread(&ThreadMan::WorkerThreadFunction, this, i + 1));
+
+    return 0;
 }
 
 
@@ -54,9 +82,207 @@ int ThreadMan::Create()
 
 void ThreadMan::Destroy()
 {
+    {
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        m_Quit = true;
+    }
+    m_JobPosted.notify_all();
 
+    for (vector<std::thread>::iterator itr = m_Workers.begin(); itr != m_Workers.end(); ++itr)
+    {
+        if (itr->joinable())
+            itr->join();
+    }
 
     Clear();
 }
 
-} // namespace RTE
\ No newline at end of file
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetCurrentThreadIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the index of the calling thread within the pool.
+
+int ThreadMan::GetCurrentThreadIndex()
+{
+    return s_ThreadIndex;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsInParallelJob
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the calling thread is currently executing a part of a
+//                  parallel job.
+
+bool ThreadMan::IsInParallelJob()
+{
+    return s_InParallelJob;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ParallelFor
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Runs a job for every index in [0, count), split in batches across the
+//                  worker threads and the calling thread.
+
+void ThreadMan::ParallelFor(int count, const std::function<void(int)> &job, int batchSize)
+{
+    RTEAssert(!s_InParallelJob, "Trying to start a parallel job from inside another one!");
+
+    if (count <= 0)
+        return;
+
+    // Not worth waking anyone up for, or no one to wake, so just run it all here
+    if (m_Workers.empty() || count <= batchSize)
+    {
+        s_InParallelJob = true;
+        for (int i = 0; i < count; ++i)
+        {
+            s_CurrentItemIndex = i;
+            s_CurrentItemSequence = 0;
+            job(i);
+        }
+        s_InParallelJob = false;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_JobMutex);
+        m_pJob = &job;
+        m_JobItemCount = count;
+        m_JobBatchSize = max(batchSize, 1);
+        m_NextJobItem = 0;
+        m_WorkersBusy = m_Workers.size();
+        ++m_JobGeneration;
+    }
+    m_JobPosted.notify_all();
+
+    // Pitch in on this thread as well
+    RunJobItems();
+
+    // Wait for the stragglers
+    std::unique_lock<std::mutex> lock(m_JobMutex);
+    m_JobDone.wait(lock, [this]() { return m_WorkersBusy == 0; });
+    m_pJob = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DeferCommand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a command into the calling thread's command buffer, to be run
+//                  on the main thread by FlushDeferredCommands.
+
+void ThreadMan::DeferCommand(const std::function<void()> &command)
+{
+    if (!s_InParallelJob)
+    {
+        command();
+        return;
+    }
+
+    DeferredCommand deferred;
+    deferred.m_ItemIndex = s_CurrentItemIndex;
+    deferred.m_Sequence = s_CurrentItemSequence++;
+    deferred.m_Command = command;
+    // Each thread only ever touches its own buffer, so no locking needed
+    m_CommandBuffers[s_ThreadIndex].push_back(deferred);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FlushDeferredCommands
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Merges the command buffers of all threads and runs the commands on the
+//                  calling thread, in a deterministic order.
+
+int ThreadMan::FlushDeferredCommands()
+{
+    RTEAssert(!s_InParallelJob, "Trying to flush deferred commands from inside a parallel job!");
+
+    m_MergedCommands.clear();
+    for (vector<vector<DeferredCommand>>::iterator bItr = m_CommandBuffers.begin(); bItr != m_CommandBuffers.end(); ++bItr)
+    {
+        for (vector<DeferredCommand>::iterator cItr = bItr->begin(); cItr != bItr->end(); ++cItr)
+            m_MergedCommands.push_back(*cItr);
+        bItr->clear();
+    }
+
+    // Each item is processed by exactly one thread so the keys are unique, and the order is the same as a serial run would produce
+    std::sort(m_MergedCommands.begin(), m_MergedCommands.end());
+
+    // Commands may themselves try to defer more, but since we're not in a job anymore they'll just run right away
+    for (vector<DeferredCommand>::iterator cItr = m_MergedCommands.begin(); cItr != m_MergedCommands.end(); ++cItr)
+        cItr->m_Command();
+
+    int commandCount = m_MergedCommands.size();
+    m_MergedCommands.clear();
+    return commandCount;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WorkerThreadFunction
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The loop each worker thread runs, waiting for jobs and processing them
+//                  until told to quit.
+
+void ThreadMan::WorkerThreadFunction(int threadIndex)
+{
+    s_ThreadIndex = threadIndex;
+    g_ProfilerMan.SetThreadName("Worker " + std::to_string(threadIndex));
+    unsigned int lastGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_JobMutex);
+            m_JobPosted.wait(lock, [this, lastGeneration]() { return m_Quit || m_JobGeneration != lastGeneration; });
+            if (m_Quit)
+                return;
+            lastGeneration = m_JobGeneration;
+        }
+
+        RunJobItems();
+
+        {
+            std::lock_guard<std::mutex> lock(m_JobMutex);
+            --m_WorkersBusy;
+        }
+        m_JobDone.notify_one();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunJobItems
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Grabs batches of items from the current job and processes them until
+//                  there are none left.
+
+void ThreadMan::RunJobItems()
+{
+    static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("ThreadMan Job");
+    ProfileZone profileZone(s_ProfilerZoneID);
+
+    const std::function<void(int)> &job = *m_pJob;
+    s_InParallelJob = true;
+
+    int start;
+    while ((start = m_NextJobItem.fetch_add(m_JobBatchSize)) < m_JobItemCount)
+    {
+        int end = min(start + m_JobBatchSize, m_JobItemCount);
+        for (int i = start; i < end; ++i)
+        {
+            s_CurrentItemIndex = i;
+            s_CurrentItemSequence = 0;
+            job(i);
+        }
+    }
+
+    s_InParallelJob = false;
+}
+
+} // namespace RTE
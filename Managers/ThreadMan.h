@@ -6,22 +6,14 @@
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Header file for the ThreadMan class.
 // Project:         Retro Terrain Engine
-// Author(s):       
-//                  
-//                  
+// Author(s):
+//
+//
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Inclusions of header files
 
-#include "global_types.h"
-
-
-#include <string>
-#include <deque>
-
-//#include <boost/thread.hpp>
-
 #include "Singleton.h"
 #define g_ThreadMan ThreadMan::Instance()
 
@@ -31,9 +23,13 @@ namespace RTE
 //////////////////////////////////////////////////////////////////////////////////////////
 // Class:           ThreadMan
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     The centralized singleton manager of all threads.
+// Description:     The centralized singleton manager of all threads. Owns a pool of worker
+//                  threads that data-parallel jobs can be split across, and the per-thread
+//                  command buffers that jobs use to defer writes to shared state until the
+//                  job is done.
 // Parent(s):       Singleton
 // Class history:   03/29/2014  ThreadMan created.
+//                  10/18/2020  Added worker pool, ParallelFor and deferred commands.
 
 
 class ThreadMan:
@@ -54,7 +50,7 @@ public:
 //                  memory. Create() should be called before using the object.
 // Arguments:       None.
 
-    ThreadMan() { Clear(); Create(); }
+    ThreadMan() { Clear(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -70,12 +66,13 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Create
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Makes the ThreadMan object ready for use.
-// Arguments:       None.
+// Description:     Makes the ThreadMan object ready for use, spawning the worker threads.
+// Arguments:       The number of worker threads to spawn in addition to the main thread.
+//                  Negative means one less than the number of hardware threads available.
 // Return value:    An error return value signaling sucess or any particular failure.
 //                  Anything below 0 is an error signal.
 
-    virtual int Create();
+    virtual int Create(int workerCount = -1);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -86,13 +83,13 @@ public:
 // Arguments:       None.
 // Return value:    None.
 
-    virtual void Reset() { Clear(); }
+    virtual void Reset() { Destroy(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Destroy
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Destroys and resets (through Clear()) the ThreadMan object.
+// Description:     Joins all worker threads and resets (through Clear()) the ThreadMan object.
 // Arguments:       None.
 // Return value:    None.
 
@@ -108,14 +105,137 @@ public:
 
     virtual const std::string & GetClassName() const { return m_ClassName; }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetWorkerCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of worker threads in the pool, not counting the main
+//                  thread which also takes part in every job.
+// Arguments:       None.
+// Return value:    The number of worker threads.
+
+    int GetWorkerCount() const { return m_Workers.size(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetThreadCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the total number of threads that jobs are split across, including
+//                  the main thread.
+// Arguments:       None.
+// Return value:    The number of threads jobs are run on.
+
+    int GetThreadCount() const { return m_Workers.size() + 1; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetCurrentThreadIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the index of the calling thread within the pool. The main thread
+//                  is always 0, workers are numbered from 1.
+// Arguments:       None.
+// Return value:    The pool index of the calling thread.
+
+    static int GetCurrentThreadIndex();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsInParallelJob
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the calling thread is currently executing a part of a
+//                  parallel job. Code that writes to shared state (the terrain, the MO
+//                  lists, post effects etc.) should defer the write with DeferCommand if so.
+// Arguments:       None.
+// Return value:    Whether the calling thread is inside a parallel job.
+
+    static bool IsInParallelJob();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          ParallelFor
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Runs a job for every index in [0, count), split in batches across the
+//                  worker threads and the calling thread. Blocks until all indices have
+//                  been processed. Jobs may not start other parallel jobs.
+// Arguments:       The number of items to process.
+//                  The job to run for each item index.
+//                  How many consecutive items each thread grabs at a time.
+// Return value:    None.
+
+    void ParallelFor(int count, const std::function<void(int)> &job, int batchSize = 64);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DeferCommand
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues a command into the calling thread's command buffer, to be run
+//                  on the main thread by FlushDeferredCommands. If not called from inside
+//                  a parallel job, the command is run immediately instead.
+// Arguments:       The command to run.
+// Return value:    None.
+
+    void DeferCommand(const std::function<void()> &command);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FlushDeferredCommands
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Merges the command buffers of all threads and runs the commands on the
+//                  calling thread, ordered by the index of the job item that queued them and
+//                  then by the order they were queued in. The result is thus the same no
+//                  matter how many threads there are or how the items were split between them.
+// Arguments:       None.
+// Return value:    The number of commands that were run.
+
+    int FlushDeferredCommands();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
 
 protected:
 
+    // A command queued from inside a parallel job, along with where in the job it was queued.
+    struct DeferredCommand
+    {
+        // The index of the job item that was being processed when this was queued
+        int m_ItemIndex;
+        // The order this was queued in while processing that item
+        int m_Sequence;
+        std::function<void()> m_Command;
+
+        bool operator<(const DeferredCommand &rhs) const { return m_ItemIndex < rhs.m_ItemIndex || (m_ItemIndex == rhs.m_ItemIndex && m_Sequence < rhs.m_Sequence); }
+    };
+
     // Member variables
     static const std::string m_ClassName;
 
+    // The worker threads
+    std::vector<std::thread> m_Workers;
+    // Guards the job state below and is used with the condition variables
+    std::mutex m_JobMutex;
+    // Signals the workers that a new job has been posted or that they should quit
+    std::condition_variable m_JobPosted;
+    // Signals the posting thread that a worker is done with the current job
+    std::condition_variable m_JobDone;
+    // Incremented each time a job is posted, so the workers can tell a new job from the one they just finished
+    unsigned int m_JobGeneration;
+    // The job currently being run, only valid while a ParallelFor is in progress
+    const std::function<void(int)> *m_pJob;
+    // The number of items in the current job and how many are grabbed at a time
+    int m_JobItemCount;
+    int m_JobBatchSize;
+    // The first item index not yet grabbed by any thread
+    std::atomic<int> m_NextJobItem;
+    // How many workers haven't finished the current job yet
+    int m_WorkersBusy;
+    // Tells the workers to exit
+    bool m_Quit;
+
+    // One command buffer per thread, indexed by GetCurrentThreadIndex
+    std::vector<std::vector<DeferredCommand>> m_CommandBuffers;
+    // Scratch space for merging the command buffers, kept around to avoid reallocating each flush
+    std::vector<DeferredCommand> m_MergedCommands;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -123,6 +243,28 @@ protected:
 
 private:
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          WorkerThreadFunction
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     The loop each worker thread runs, waiting for jobs and processing them
+//                  until told to quit.
+// Arguments:       The pool index of this worker.
+// Return value:    None.
+
+    void WorkerThreadFunction(int threadIndex);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunJobItems
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Grabs batches of items from the current job and processes them until
+//                  there are none left.
+// Arguments:       None.
+// Return value:    None.
+
+    void RunJobItems();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -141,4 +283,4 @@ private:
 
 } // namespace RTE
 
-#endif // File
\ No newline at end of file
+#endif // File
@@ -52,6 +52,7 @@ void TimerMan::Clear()
     m_SimUpdateCount = 0;
     m_SimUpdatesSinceDrawn = -1;
     m_DrawnSimUpdate = false;
+    m_SimUpdatesDrawn = true;
     m_TimeScale = 1.0;
     m_AveragingEnabled = false;
     m_DeltaBuffer.clear();
@@ -263,6 +264,24 @@ void TimerMan::Update()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateFixedStep
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Used instead of Update to advance time by exactly one DeltaTime,
+//                  regardless of how much actual time has passed.
+
+void TimerMan::UpdateFixedStep()
+{
+    m_RealTimeTicks += m_DeltaTime;
+
+    // Exactly one sim update's worth, no matter the TimeScale
+    if (!m_SimPaused)
+        m_SimAccumulator += m_DeltaTime;
+
+    m_SimUpdatesSinceDrawn = -1;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          UpdateSim
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -279,14 +298,16 @@ void TimerMan::UpdateSim()
         m_SimTimeTicks += m_DeltaTime;
         // Increment the sim update count
         ++m_SimUpdateCount;
-        ++m_SimUpdatesSinceDrawn;
+        // Without drawing there's never a drawn update to count from
+        if (m_SimUpdatesDrawn)
+            ++m_SimUpdatesSinceDrawn;
 
         // If after deducting the DeltaTime from the Accumulator, there is not enough time for another DeltaTime,
         // then flag this as the last sim update before the frame is drawn
-        m_DrawnSimUpdate = !TimeForSimUpdate();
+        m_DrawnSimUpdate = m_SimUpdatesDrawn && !TimeForSimUpdate();
     }
     else
-        m_DrawnSimUpdate = true;
+        m_DrawnSimUpdate = m_SimUpdatesDrawn;
 }
 
 
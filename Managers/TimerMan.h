@@ -379,6 +379,18 @@ public:
     bool DrawnSimUpdate() const { return m_DrawnSimUpdate; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SetSimUpdatesDrawn
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether sim updates ever get drawn. If not, no sim update is a
+//                  DrawnSimUpdate and none count as being since a drawn one, so nothing
+//                  purely graphical is done during them. For running without a screen.
+// Arguments:       Whether sim updates get drawn or not.
+// Return value:    None.
+
+    void SetSimUpdatesDrawn(bool drawn = true) { m_SimUpdatesDrawn = drawn; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          SimUpdatesSinceDrawn
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -403,6 +415,19 @@ public:
     void Update();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          UpdateFixedStep
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Used instead of Update to advance time by exactly one DeltaTime,
+//                  regardless of how much actual time has passed. Both the real time and
+//                  the sim accumulator are advanced, so that timers measuring either stay
+//                  in lockstep with the sim. Makes runs repeatable across machines.
+// Arguments:       None.
+// Return value:    None.
+
+    void UpdateFixedStep();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          UpdateSim
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -456,6 +481,8 @@ protected:
     int m_SimUpdatesSinceDrawn;
     // Tells whether the current simulation update will be drawn in a frame.
     bool m_DrawnSimUpdate;
+    // Whether any simulation updates get drawn at all
+    bool m_SimUpdatesDrawn;
     // Time scale. The relationship between the real world actual time, and the simulation time.
     // A value of 2.0 means simulation runs twice as fast as normal, as percieved by a player.
     float m_TimeScale;
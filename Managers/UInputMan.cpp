@@ -104,7 +104,7 @@ int UInputMan::InputScheme::InputMapping::Create(const InputMapping &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int UInputMan::InputScheme::InputMapping::ReadProperty(std::string propName, Reader &reader)
+int UInputMan::InputScheme::InputMapping::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "KeyMap")
     {
@@ -427,7 +427,7 @@ int UInputMan::InputScheme::Create(const InputScheme &reference)
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int UInputMan::InputScheme::ReadProperty(std::string propName, Reader &reader)
+int UInputMan::InputScheme::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Device")
         reader >> m_ActiveDevice;
@@ -854,7 +854,7 @@ int UInputMan::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int UInputMan::ReadProperty(std::string propName, Reader &reader)
+int UInputMan::ReadProperty(const std::string &propName, Reader &reader)
 {
     int mappedButton = 0;
 
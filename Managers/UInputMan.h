@@ -283,7 +283,7 @@ private:
         //                  read or not. 0 means it was read successfully, and any nonzero indicates
         //                  that a property of that name could not be found in this or base classes.
 
-            virtual int ReadProperty(std::string propName, Reader &reader);
+            virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
         //////////////////////////////////////////////////////////////////////////////////////////
@@ -535,7 +535,7 @@ private:
     //                  read or not. 0 means it was read successfully, and any nonzero indicates
     //                  that a property of that name could not be found in this or base classes.
 
-        virtual int ReadProperty(std::string propName, Reader &reader);
+        virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
     //////////////////////////////////////////////////////////////////////////////////////////
@@ -746,7 +746,7 @@ public:
 //                  read or not. 0 means it was read successfully, and any nonzero indicates
 //                  that a property of that name could not be found in this or base classes.
 
-    virtual int ReadProperty(std::string propName, Reader &reader);
+    virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
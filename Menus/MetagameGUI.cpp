@@ -771,7 +771,7 @@ void MetagameGUI::MoveLocationsIntoTheScreen()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the Reader's position is untouched.
 
-int MetagameGUI::ReadProperty(string propName, Reader &reader)
+int MetagameGUI::ReadProperty(const string &propName, Reader &reader)
 {
     Vector tempPos;
 
@@ -183,7 +183,7 @@ int PieMenuGUI::Slice::Create()
 //                  is called. If the property isn't recognized by any of the base classes,
 //                  false is returned, and the reader's position is untouched.
 
-int PieMenuGUI::Slice::ReadProperty(std::string propName, Reader &reader)
+int PieMenuGUI::Slice::ReadProperty(const std::string &propName, Reader &reader)
 {
     if (propName == "Description")
         reader >> m_Description;
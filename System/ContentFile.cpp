@@ -1,6 +1,7 @@
 #include "ContentFile.h"
 #include "PresetMan.h"
 #include "ConsoleMan.h"
+#include "SettingsMan.h"
 
 namespace RTE {
 
@@ -9,6 +10,44 @@ namespace RTE {
 	std::map<std::string, BITMAP *> ContentFile::m_sLoadedBitmaps[BitDepthCount];
 	std::map<std::string, FMOD::Sound *> ContentFile::m_sLoadedSamples;
 	std::map<size_t, std::string> ContentFile::m_PathHashes;
+	std::unordered_map<BITMAP *, ContentFile::LoadedBitmapInfo> ContentFile::m_sLoadedBitmapInfo;
+	std::list<BITMAP *> ContentFile::m_sUnusedBitmaps;
+	size_t ContentFile::m_sUnusedBitmapBytes = 0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// The contents of a file read into memory, wrapped so allegro can load from them through a PACKFILE as if they were the file itself.
+	/// </summary>
+	struct MemoryPackFile {
+		const unsigned char *m_Pos; //!< The next byte to be read.
+		const unsigned char *m_End; //!< One past the last byte.
+	};
+
+	static int MemoryPackFileClose(void *userData) { return 0; }
+	static int MemoryPackFileGetChar(void *userData) { MemoryPackFile *memFile = static_cast<MemoryPackFile *>(userData); return memFile->m_Pos < memFile->m_End ? *(memFile->m_Pos++) : EOF; }
+	static int MemoryPackFileUngetChar(int character, void *userData) { MemoryPackFile *memFile = static_cast<MemoryPackFile *>(userData); --memFile->m_Pos; return character; }
+	static long MemoryPackFileRead(void *buffer, long byteCount, void *userData) {
+		MemoryPackFile *memFile = static_cast<MemoryPackFile *>(userData);
+		long bytesRead = std::min(byteCount, static_cast<long>(memFile->m_End - memFile->m_Pos));
+		std::memcpy(buffer, memFile->m_Pos, bytesRead);
+		memFile->m_Pos += bytesRead;
+		return bytesRead;
+	}
+	static int MemoryPackFilePutChar(int character, void *userData) { return EOF; }
+	static long MemoryPackFileWrite(AL_CONST void *buffer, long byteCount, void *userData) { return 0; }
+	static int MemoryPackFileSeek(void *userData, int offset) {
+		MemoryPackFile *memFile = static_cast<MemoryPackFile *>(userData);
+		if (offset < 0 || offset > memFile->m_End - memFile->m_Pos) {
+			return -1;
+		}
+		memFile->m_Pos += offset;
+		return 0;
+	}
+	static int MemoryPackFileEOF(void *userData) { MemoryPackFile *memFile = static_cast<MemoryPackFile *>(userData); return memFile->m_Pos >= memFile->m_End; }
+	static int MemoryPackFileError(void *userData) { return 0; }
+
+	static const PACKFILE_VTABLE s_MemoryPackFileVTable = { MemoryPackFileClose, MemoryPackFileGetChar, MemoryPackFileUngetChar, MemoryPackFileRead, MemoryPackFilePutChar, MemoryPackFileWrite, MemoryPackFileSeek, MemoryPackFileEOF, MemoryPackFileError };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -50,12 +89,16 @@ namespace RTE {
 			for (std::map<std::string, BITMAP *>::iterator lbItr = m_sLoadedBitmaps[depth].begin(); lbItr != m_sLoadedBitmaps[depth].end(); ++lbItr) {
 				destroy_bitmap((*lbItr).second);
 			}
+			m_sLoadedBitmaps[depth].clear();
 		}
+		m_sLoadedBitmapInfo.clear();
+		m_sUnusedBitmaps.clear();
+		m_sUnusedBitmapBytes = 0;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int ContentFile::ReadProperty(std::string propName, Reader &reader) {
+	int ContentFile::ReadProperty(const std::string &propName, Reader &reader) {
 		if (propName == "Path" || propName == "FilePath") {
 			m_DataPath = reader.ReadPropValue();
 			m_DataModuleID = g_PresetMan.GetModuleIDFromPath(m_DataPath);
@@ -97,6 +140,12 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	BITMAP * ContentFile::GetAsBitmap(int conversionMode) {
+		return GetLoadedBitmap(conversionMode, true);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	BITMAP * ContentFile::GetLoadedBitmap(int conversionMode, bool keepLoaded) {
 		if (m_DataPath.empty()) {
 			return 0;
 		}
@@ -115,6 +164,25 @@ namespace RTE {
 
 			// Insert the bitmap into the map, PASSING OVER OWNERSHIP OF THE LOADED DATAFILE
 			m_sLoadedBitmaps[bitDepth].insert(std::pair<std::string, BITMAP *>(m_DataPath, pReturnBitmap));
+
+			LoadedBitmapInfo &bitmapInfo = m_sLoadedBitmapInfo[pReturnBitmap];
+			bitmapInfo.m_DataPath = m_DataPath;
+			bitmapInfo.m_BitDepth = bitDepth;
+			bitmapInfo.m_DataModuleID = g_PresetMan.GetModuleIDFromPath(m_DataPath);
+			bitmapInfo.m_Bytes = static_cast<size_t>(pReturnBitmap->w) * pReturnBitmap->h * ((bitmap_color_depth(pReturnBitmap) + 7) / 8);
+			bitmapInfo.m_References = 0;
+			bitmapInfo.m_KeepLoaded = false;
+			bitmapInfo.m_Unused = false;
+		}
+		if (keepLoaded) {
+			LoadedBitmapInfo &bitmapInfo = m_sLoadedBitmapInfo[pReturnBitmap];
+			bitmapInfo.m_KeepLoaded = true;
+			// Can't be unloaded anymore, so it's not unused either
+			if (bitmapInfo.m_Unused) {
+				m_sUnusedBitmaps.erase(bitmapInfo.m_UnusedItr);
+				m_sUnusedBitmapBytes -= bitmapInfo.m_Bytes;
+				bitmapInfo.m_Unused = false;
+			}
 		}
 		return pReturnBitmap;
 	}
@@ -134,7 +202,10 @@ namespace RTE {
 		if (separatorPos == m_DataPath.length()) {
 			RTEAbort("There was no object name following first pound sign in the ContentFile's datafile path, which means there was no actual object defined. The path was:\n\n" + m_DataPath);
 		} else if (separatorPos == -1) {
-			PACKFILE *pFile = pack_fopen(m_DataPath.c_str(), F_READ);
+			// The file might've been read in ahead already while loading the DataModules, in which case it's loaded from memory instead
+			std::vector<char> prefetchedData;
+			MemoryPackFile memFile;
+			PACKFILE *pFile = g_PresetMan.TakePrefetchedFile(m_DataPath, prefetchedData) ? pack_fopen_vtable(&s_MemoryPackFileVTable, &memFile) : pack_fopen(m_DataPath.c_str(), F_READ);
 			// If the file didn't open, try using animation naming scheme of adding 000 before the extension
 			if (!pFile) {
 				int extensionPos = m_DataPath.rfind('.');
@@ -142,9 +213,11 @@ namespace RTE {
 				std::string pathWithoutExtension = m_DataPath;
 				pathWithoutExtension.resize(extensionPos);
 
-				pFile = pack_fopen((pathWithoutExtension + "000.bmp").c_str(), F_READ);
+				pFile = g_PresetMan.TakePrefetchedFile(pathWithoutExtension + "000.bmp", prefetchedData) ? pack_fopen_vtable(&s_MemoryPackFileVTable, &memFile) : pack_fopen((pathWithoutExtension + "000.bmp").c_str(), F_READ);
 				RTEAssert(pFile, "Failed to load datafile object with following path and name:\n\n" + m_DataPath);
 			}
+			memFile.m_Pos = reinterpret_cast<const unsigned char *>(prefetchedData.data());
+			memFile.m_End = memFile.m_Pos + prefetchedData.size();
 			// Load the bitmap then close the file stream to clean up
 			PALETTE currentPalette;
 			get_palette(currentPalette);
@@ -168,7 +241,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	BITMAP ** ContentFile::GetAsAnimation(int frameCount, int conversionMode) {
+	BITMAP ** ContentFile::GetAnimation(int frameCount, int conversionMode, bool keepLoaded) {
 		if (m_DataPath.empty()) {
 			return 0;
 		}
@@ -177,7 +250,7 @@ namespace RTE {
 
 		// Don't try to append numbers if there's only one frame
 		if (frameCount == 1) {
-			aReturnBitmaps[0] = GetAsBitmap(conversionMode);
+			aReturnBitmaps[0] = GetLoadedBitmap(conversionMode, keepLoaded);
 			return aReturnBitmaps;
 		}
 		std::string extension = "";
@@ -199,13 +272,85 @@ namespace RTE {
 			sprintf_s(framePath, sizeof(framePath), "%s%03i%s", originalDataPath.c_str(), i, extension.c_str());
 			m_DataPath = framePath;
 
-			aReturnBitmaps[i] = GetAsBitmap(conversionMode);
+			aReturnBitmaps[i] = GetLoadedBitmap(conversionMode, keepLoaded);
 			RTEAssert(aReturnBitmaps[i], "Could not get a frame of animation with path and name:\n\n" + m_DataPath);
 		}
 		m_DataPath = originalDataPath + (extensionPos > 0 ? extension : "");
 		return aReturnBitmaps;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	BITMAP ** ContentFile::GetAsReferencedAnimation(int frameCount, int conversionMode) {
+		BITMAP **aReturnBitmaps = GetAnimation(frameCount, conversionMode, false);
+		if (aReturnBitmaps) { AcquireBitmaps(aReturnBitmaps, frameCount); }
+		return aReturnBitmaps;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ContentFile::AcquireBitmaps(BITMAP * const *bitmaps, int bitmapCount) {
+		for (int i = 0; i < bitmapCount; ++i) {
+			std::unordered_map<BITMAP *, LoadedBitmapInfo>::iterator infoItr = m_sLoadedBitmapInfo.find(bitmaps[i]);
+			if (infoItr == m_sLoadedBitmapInfo.end()) {
+				continue;
+			}
+			LoadedBitmapInfo &bitmapInfo = infoItr->second;
+			if (bitmapInfo.m_Unused) {
+				m_sUnusedBitmaps.erase(bitmapInfo.m_UnusedItr);
+				m_sUnusedBitmapBytes -= bitmapInfo.m_Bytes;
+				bitmapInfo.m_Unused = false;
+			}
+			++bitmapInfo.m_References;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ContentFile::ReleaseBitmaps(BITMAP * const *bitmaps, int bitmapCount) {
+		for (int i = 0; i < bitmapCount; ++i) {
+			std::unordered_map<BITMAP *, LoadedBitmapInfo>::iterator infoItr = m_sLoadedBitmapInfo.find(bitmaps[i]);
+			if (infoItr == m_sLoadedBitmapInfo.end() || infoItr->second.m_References <= 0) {
+				continue;
+			}
+			LoadedBitmapInfo &bitmapInfo = infoItr->second;
+			// The same BITMAP can be in an animation more than once, so it might've been made unused already by an earlier frame
+			if (--bitmapInfo.m_References == 0 && !bitmapInfo.m_KeepLoaded && !bitmapInfo.m_Unused) {
+				bitmapInfo.m_UnusedItr = m_sUnusedBitmaps.insert(m_sUnusedBitmaps.end(), infoItr->first);
+				bitmapInfo.m_Unused = true;
+				m_sUnusedBitmapBytes += bitmapInfo.m_Bytes;
+			}
+		}
+		UnloadUnusedBitmaps();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ContentFile::UnloadUnusedBitmaps() {
+		size_t budgetBytes = static_cast<size_t>(std::max(g_SettingsMan.GetUnusedSpriteMemoryBudget(), 0)) * 1024 * 1024;
+		while (m_sUnusedBitmapBytes > budgetBytes && !m_sUnusedBitmaps.empty()) {
+			BITMAP *pBitmap = m_sUnusedBitmaps.front();
+			m_sUnusedBitmaps.pop_front();
+
+			std::unordered_map<BITMAP *, LoadedBitmapInfo>::iterator infoItr = m_sLoadedBitmapInfo.find(pBitmap);
+			m_sUnusedBitmapBytes -= infoItr->second.m_Bytes;
+			m_sLoadedBitmaps[infoItr->second.m_BitDepth].erase(infoItr->second.m_DataPath);
+			m_sLoadedBitmapInfo.erase(infoItr);
+			destroy_bitmap(pBitmap);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ContentFile::GetLoadedBitmapMemory(std::map<int, size_t> &loadedBytes, std::map<int, size_t> &unusedBytes) {
+		loadedBytes.clear();
+		unusedBytes.clear();
+		for (const std::pair<BITMAP * const, LoadedBitmapInfo> &bitmapInfo : m_sLoadedBitmapInfo) {
+			loadedBytes[bitmapInfo.second.m_DataModuleID] += bitmapInfo.second.m_Bytes;
+			if (bitmapInfo.second.m_Unused) { unusedBytes[bitmapInfo.second.m_DataModuleID] += bitmapInfo.second.m_Bytes; }
+		}
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	FMOD::Sound * ContentFile::GetAsSample(bool abortGameForInvalidSound) {
@@ -230,27 +375,34 @@ namespace RTE {
 				g_ConsoleMan.PrintString("ERROR: " + errorMessage + m_DataPath);
 				return pReturnSample;
 			} else if (separatorPos == -1) {
-				// Open the file, allocate space for it, read it and load it in as a Sound object
-				fileSize = file_size(m_DataPath.c_str());
-				PACKFILE *pFile = pack_fopen(m_DataPath.c_str(), F_READ);
-
-				if (!pFile || fileSize <= 0) {
-					errorMessage = "Failed to load sound file with following path and name: ";
-					if (abortGameForInvalidSound) { RTEAbort(errorMessage + "\n\n" + m_DataPath); }
-					g_ConsoleMan.PrintString("ERROR: " + errorMessage + m_DataPath);
-					return pReturnSample;
+				// The file might've been read in ahead already while loading the DataModules, in which case there's no need to open it at all
+				std::vector<char> prefetchedData;
+				PACKFILE *pFile = 0;
+				if (g_PresetMan.TakePrefetchedFile(m_DataPath, prefetchedData) && !prefetchedData.empty()) {
+					fileSize = static_cast<long>(prefetchedData.size());
+				} else {
+					// Open the file, allocate space for it, read it and load it in as a Sound object
+					fileSize = file_size(m_DataPath.c_str());
+					pFile = pack_fopen(m_DataPath.c_str(), F_READ);
+
+					if (!pFile || fileSize <= 0) {
+						errorMessage = "Failed to load sound file with following path and name: ";
+						if (abortGameForInvalidSound) { RTEAbort(errorMessage + "\n\n" + m_DataPath); }
+						g_ConsoleMan.PrintString("ERROR: " + errorMessage + m_DataPath);
+						return pReturnSample;
+					}
+
+					pRawData = new char[fileSize];
+					int bytesRead = pack_fread(pRawData, fileSize, pFile);
+					RTEAssert(bytesRead == fileSize, "Tried to read a sound file but couldn't read the same amount of data as the reported file size! The path and name were: \n\n" +m_DataPath);
 				}
 
-				pRawData = new char[fileSize];
-				int bytesRead = pack_fread(pRawData, fileSize, pFile);
-				RTEAssert(bytesRead == fileSize, "Tried to read a sound file but couldn't read the same amount of data as the reported file size! The path and name were: \n\n" +m_DataPath);
-
 				// Setup fmod info, and make sure to use mode OPENMEMORY since we're doing the loading with ContentFile instead of fmod, and we're deleting the raw data after loading it
 				FMOD_CREATESOUNDEXINFO soundInfo = {};
 				soundInfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
 				soundInfo.length = fileSize;
 				//TODO Consider doing FMOD_CREATESAMPLE for dumping audio files into memory and FMOD_NONBLOCKING to async create sounds
-				FMOD_RESULT result = g_AudioMan.GetAudioSystem()->createSound(pRawData, FMOD_OPENMEMORY | FMOD_3D, &soundInfo, &pReturnSample);
+				FMOD_RESULT result = g_AudioMan.GetAudioSystem()->createSound(pRawData ? pRawData : prefetchedData.data(), FMOD_OPENMEMORY | FMOD_3D, &soundInfo, &pReturnSample);
 
 				if (result != FMOD_OK) {
 					errorMessage = "Unable to create sound because of FMOD error " + std::string(FMOD_ErrorString(result)) + ". Path and name was: ";
@@ -261,7 +413,7 @@ namespace RTE {
 
 				// Deallocate the intermediary data and close the file stream
 				delete[] pRawData;
-				pack_fclose(pFile);
+				if (pFile) { pack_fclose(pFile); }
 			} else if (separatorPos != m_DataPath.length() - 1) {
 				RTEAbort("Loading sounds from allegro datafiles isn't supported yet!");
 				/*
@@ -85,7 +85,7 @@ namespace RTE {
 		/// An error return value signaling whether the property was successfully read or not.
 		/// 0 means it was read successfully, and any nonzero indicates that a property of that name could not be found in this or base classes.
 		/// </returns>
-		virtual int ReadProperty(std::string propName, Reader &reader);
+		virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 		/// <summary>
 		/// Saves the complete state of this ContentFile to an output stream for later recreation with Create(Reader &reader).
@@ -185,7 +185,17 @@ namespace RTE {
 		/// The pointer to the beginning of the array of BITMAP pointers loaded from the allegro .dat datafile, the length of which is specified with the frameCount argument.
 		/// Ownership of the array IS transferred! Ownership of the BITMAPS is NOT transferred! If 0, the file could not be found/loaded.
 		/// </returns>
-		virtual BITMAP ** GetAsAnimation(int frameCount = 1, int conversionMode = 0);
+		virtual BITMAP ** GetAsAnimation(int frameCount = 1, int conversionMode = 0) { return GetAnimation(frameCount, conversionMode, true); }
+
+		/// <summary>
+		/// Gets the data represented by this ContentFile object as an array of Allegro BITMAPs like GetAsAnimation, but adds a reference to each BITMAP instead of keeping them loaded for good.
+		/// Every BITMAP gotten this way has to be released with ReleaseBitmaps once it's not used anymore, after which it can be unloaded if it isn't referenced anywhere else.
+		/// Note that ownership of the BITMAPS ARE NOT TRANSFERRED, BUT THE ARRAY ITSELF, IS!
+		/// </summary>
+		/// <param name="frameCount">The number of frames to attempt to load, more than 1 frame will mean 00# is appended to datapath to handle naming conventions.</param>
+		/// <param name="conversionMode">The Allegro color conversion mode to use when loading this bitmap. Only applies if the bitmaps aren't loaded already.</param>
+		/// <returns>The array of BITMAP pointers, the length of which is specified with the frameCount argument. Ownership of the array IS transferred! Ownership of the BITMAPS is NOT transferred! If 0, the file could not be found/loaded.</returns>
+		BITMAP ** GetAsReferencedAnimation(int frameCount = 1, int conversionMode = 0);
 
 		/// <summary>
 		/// Loads and gets the data represented by this ContentFile object as an FMOD FSOUND_SAMPLE. Note that ownership of the SAMPLE IS NOT TRANSFERRED!
@@ -201,6 +211,30 @@ namespace RTE {
 		//virtual char * GetAsRawBinary();
 #pragma endregion
 
+#pragma region Bitmap References
+		/// <summary>
+		/// Adds a reference to each of a number of BITMAPs that were loaded by GetAsReferencedAnimation, so they stay loaded until they're released again.
+		/// </summary>
+		/// <param name="bitmaps">The array of BITMAPs to reference.</param>
+		/// <param name="bitmapCount">The number of BITMAPs in the array.</param>
+		static void AcquireBitmaps(BITMAP * const *bitmaps, int bitmapCount);
+
+		/// <summary>
+		/// Removes a reference from each of a number of BITMAPs that were loaded by GetAsReferencedAnimation or acquired with AcquireBitmaps.
+		/// BITMAPs that end up without any references are kept loaded in case they're needed again, until the unused sprite memory budget runs out and the least recently used ones are unloaded.
+		/// </summary>
+		/// <param name="bitmaps">The array of BITMAPs to release. The BITMAP pointers in it shouldn't be used after this.</param>
+		/// <param name="bitmapCount">The number of BITMAPs in the array.</param>
+		static void ReleaseBitmaps(BITMAP * const *bitmaps, int bitmapCount);
+
+		/// <summary>
+		/// Gets how much memory the loaded BITMAPs take up, by the DataModule they were loaded from.
+		/// </summary>
+		/// <param name="loadedBytes">Filled with the bytes of all loaded BITMAPs, by DataModule ID. BITMAPs from outside any DataModule are under -1.</param>
+		/// <param name="unusedBytes">Filled with the bytes of the loaded BITMAPs that nothing is referencing and could be unloaded, by DataModule ID.</param>
+		static void GetLoadedBitmapMemory(std::map<int, size_t> &loadedBytes, std::map<int, size_t> &unusedBytes);
+#pragma endregion
+
 #pragma region Class Info
 		/// <summary>
 		/// Gets the class name of this Entity.
@@ -219,6 +253,24 @@ namespace RTE {
 		static std::map<size_t, std::string> m_PathHashes; //!< Hash value of the path to this ContentFile's Datafile Object.
 		static std::map<std::string, BITMAP *> m_sLoadedBitmaps[BitDepthCount]; //!< Static map containing all the already loaded BITMAPs and their paths, and there's two maps, for each bit depth.
 		static std::map<std::string, FMOD::Sound *> m_sLoadedSamples; //!< Static map containing all the already loaded FSOUND_SAMPLEs and their paths.
+
+		/// <summary>
+		/// Bookkeeping for a BITMAP in m_sLoadedBitmaps.
+		/// </summary>
+		struct LoadedBitmapInfo {
+			std::string m_DataPath; //!< The path the BITMAP is mapped to in m_sLoadedBitmaps.
+			int m_BitDepth; //!< Which of the m_sLoadedBitmaps maps the BITMAP is in.
+			int m_DataModuleID; //!< The ID of the DataModule the BITMAP was loaded from, or -1 if none.
+			size_t m_Bytes; //!< How much memory the BITMAP's pixels take up.
+			int m_References; //!< How many references were acquired to the BITMAP through GetAsReferencedAnimation and AcquireBitmaps and not released yet.
+			bool m_KeepLoaded; //!< Whether the BITMAP was handed out without being referenced, through GetAsBitmap or GetAsAnimation, meaning it can never be unloaded.
+			bool m_Unused; //!< Whether the BITMAP is in m_sUnusedBitmaps.
+			std::list<BITMAP *>::iterator m_UnusedItr; //!< Where the BITMAP is in m_sUnusedBitmaps, if it's in there.
+		};
+
+		static std::unordered_map<BITMAP *, LoadedBitmapInfo> m_sLoadedBitmapInfo; //!< Bookkeeping for all the BITMAPs in m_sLoadedBitmaps.
+		static std::list<BITMAP *> m_sUnusedBitmaps; //!< The loaded BITMAPs that aren't referenced and could be unloaded, least recently released first.
+		static size_t m_sUnusedBitmapBytes; //!< How much memory the BITMAPs in m_sUnusedBitmaps take up.
 		//TODO Potentially use this to handle storing base files packed as Allegro .dat files
 		//static std::map<std::string, std::pair<char *, long>> m_sLoadedBinary; //!< Static map containing all the already loaded binary data. First in pair is the data, second is size in bytes.
 
@@ -232,6 +284,28 @@ namespace RTE {
 
 		//DATAFILE *m_pDataFile; //!< This is only if the data is loaded from a datafile; needs to be saved so that it can be unloaded as some point.
 
+		/// <summary>
+		/// Gets the data represented by this ContentFile object as an Allegro BITMAP, loading it into the static maps if it's not already loaded.
+		/// </summary>
+		/// <param name="conversionMode">The Allegro color conversion mode to use when loading this bitmap. Only applies if the bitmap isn't loaded already.</param>
+		/// <param name="keepLoaded">Whether the BITMAP is being handed out without a reference, so it can never be unloaded.</param>
+		/// <returns>The pointer to the loaded BITMAP. Ownership is NOT transferred! If 0, the file could not be found/loaded.</returns>
+		BITMAP * GetLoadedBitmap(int conversionMode, bool keepLoaded);
+
+		/// <summary>
+		/// Gets the data represented by this ContentFile object as an array of Allegro BITMAPs, loading them into the static maps if they're not already loaded.
+		/// </summary>
+		/// <param name="frameCount">The number of frames to attempt to load, more than 1 frame will mean 00# is appended to datapath to handle naming conventions.</param>
+		/// <param name="conversionMode">The Allegro color conversion mode to use when loading this bitmap. Only applies if the bitmaps aren't loaded already.</param>
+		/// <param name="keepLoaded">Whether the BITMAPs are being handed out without references, so they can never be unloaded.</param>
+		/// <returns>The array of BITMAP pointers. Ownership of the array IS transferred! Ownership of the BITMAPS is NOT transferred! If 0, the file could not be found/loaded.</returns>
+		BITMAP ** GetAnimation(int frameCount, int conversionMode, bool keepLoaded);
+
+		/// <summary>
+		/// Unloads the least recently released unused BITMAPs until the rest of them fit in the unused sprite memory budget.
+		/// </summary>
+		static void UnloadUnusedBitmaps();
+
 	private:
 
 		/// <summary>
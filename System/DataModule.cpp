@@ -1,5 +1,6 @@
 #include "DataModule.h"
 #include "RTEManagers.h"
+#include "MOSprite.h"
 
 namespace RTE {
 
@@ -19,6 +20,9 @@ namespace RTE {
 		m_PresetList.clear();
 		m_EntityList.clear();
 		m_TypeMap.clear();
+		m_PresetIndex.clear();
+		m_GroupIndex.clear();
+		m_GroupIndexRevision = 0;
 		for (int i = 0; i < c_PaletteEntriesNumber; ++i) { 
 			m_MaterialMappings[i] = 0; 
 		}
@@ -42,13 +46,39 @@ namespace RTE {
 			fpProgressCallback(std::string(report), true);
 		}
 
-		Reader reader;
 		std::string indexPath(m_FileName + "/Index.ini");
 		std::string mergedIndexPath(m_FileName + "/MergedIndex.ini");
 
 		// NOTE: This looks for the MergedIndex.ini generated by the index merger tool. The tool is mostly superseded by disabling loading visuals, but still provides some benefit.
 		if (std::experimental::filesystem::exists(mergedIndexPath.c_str())) { indexPath = mergedIndexPath; }
 
+		// Play back everything the Readers read last time if nothing changed since, otherwise record it all for next time
+		PresetCache presetCache;
+		bool usePresetCache = g_SettingsMan.UsePresetCache() && presetCache.Create(m_FileName, indexPath) >= 0;
+		int result = ReadModuleFiles(indexPath, usePresetCache ? &presetCache : 0, fpProgressCallback);
+
+		// The saved cache stopped lining up partway through and was deleted, so nothing loaded from it can be trusted. Start over from the ini files and record a new one
+		if (usePresetCache && presetCache.HasReplayFailed()) {
+			if (fpProgressCallback) { fpProgressCallback("\tThe preset cache of " + m_FileName + " is out of date, reading the ini files instead", true); }
+			g_SceneMan.RemoveModuleMaterials(m_ModuleID);
+			Destroy();
+			m_FileName = moduleName;
+			m_ModuleID = g_PresetMan.GetModuleID(moduleName);
+
+			presetCache.Destroy();
+			usePresetCache = presetCache.Create(m_FileName, indexPath, false) >= 0;
+			result = ReadModuleFiles(indexPath, usePresetCache ? &presetCache : 0, fpProgressCallback);
+		}
+		if (usePresetCache && !presetCache.IsReplaying() && result >= 0) { presetCache.Save(); }
+		return result;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int DataModule::ReadModuleFiles(const std::string &indexPath, PresetCache *presetCache, ProgressCallback fpProgressCallback) {
+		Reader reader;
+		if (presetCache) { reader.SetPresetCache(presetCache); }
+
 		if (std::experimental::filesystem::exists(indexPath.c_str()) && reader.Create(indexPath.c_str(), true, fpProgressCallback) >= 0) {
 			int result = Serializable::Create(reader);
 
@@ -64,6 +94,7 @@ namespace RTE {
 
 				for (int result = al_findfirst(searchPath.c_str(), &fileInfo, FA_ALL); result == 0; result = al_findnext(&fileInfo)) {
 					Reader iniReader;
+					if (presetCache) { iniReader.SetPresetCache(presetCache); }
 					// Make sure we're not adding Index.ini again
 					if (std::strlen(fileInfo.name) > 0 && std::string(fileInfo.name) != "Index.ini") {
 						std::string iniPath(m_FileName + "/" + fileInfo.name);
@@ -125,7 +156,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int DataModule::ReadProperty(std::string propName, Reader &reader) {
+	int DataModule::ReadProperty(const std::string &propName, Reader &reader) {
 		if (propName == "ModuleName") {
 			reader >> m_FriendlyName;
 		} else if (propName == "Author") {
@@ -206,20 +237,7 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	const Entity * DataModule::GetEntityPreset(std::string exactType, std::string instance) {
-		if (exactType.empty() || instance == "None" || instance.empty()) {
-			return 0;
-		}
-
-		std::map<std::string, std::list<std::pair<std::string, Entity *>>>::iterator classItr = m_TypeMap.find(exactType);
-		if (classItr != m_TypeMap.end()) {
-			// Find an instance of that EXACT type and name; derived types are not matched
-			for (std::list<std::pair<std::string, Entity *>>::iterator instItr = (*classItr).second.begin(); instItr != (*classItr).second.end(); ++instItr) {
-				if ((*instItr).first == instance && (*instItr).second->GetClassName() == exactType) {
-					return (*instItr).second;
-				}
-			}
-		}
-		return 0;
+		return GetEntityIfExactType(exactType, instance);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -241,6 +259,9 @@ namespace RTE {
 				pEntToAdd->Clone(pExistingEntity);
 				// Make sure the existing one is still marked as the Original Preset
 				pExistingEntity->m_IsOriginalPreset = true;
+				ReleasePresetSprites(pExistingEntity);
+				// The groups of the existing one may have changed with the new definition
+				m_GroupIndex.clear();
 				// Alter the instance entry to reflect the data file location of the new definition
 				if (readFromFile != "Same") {
 					std::list<PresetEntry>::iterator itr = m_PresetList.begin();
@@ -262,6 +283,7 @@ namespace RTE {
 			Entity *pEntClone = pEntToAdd->Clone();
 			// Mark the one we are about to add to the list as the Original now - this is now the actual Original Preset instance
 			pEntClone->m_IsOriginalPreset = true;
+			ReleasePresetSprites(pEntClone);
 
 			if (readFromFile == "Same" && m_PresetList.empty()) {
 				RTEAbort("Tried to add first entity instance to data module " + m_FileName + " without specifying a data file!");
@@ -315,21 +337,10 @@ namespace RTE {
 			return false;
 		}
 
-		bool foundAny = false;
-
-		// Find either the Entity typelist that contains all entities in this DataModule, or the specific class' typelist (which will get all derived classes too)
-		std::map<std::string, std::list<std::pair<std::string, Entity *>>>::iterator classItr = m_TypeMap.find((type.empty() || type == "All") ? "Entity" : type);
-		
-		if (classItr != m_TypeMap.end()) {
-			RTEAssert(!classItr->second.empty(), "DataModule has class entry without instances in its map!?");
-			for (std::list<std::pair<std::string, Entity *>>::iterator instItr = classItr->second.begin(); instItr != classItr->second.end(); ++instItr) {
-				if (instItr->second->IsInGroup(group)) {
-					entityList.push_back(instItr->second); // Get the grouped entities, without transferring ownership
-					foundAny = true;
-				}
-			}
-		}
-		return foundAny;
+		// Get the grouped entities, without transferring ownership
+		const std::vector<Entity *> &groupPresets = GetPresetsOfGroup(group, type);
+		entityList.insert(entityList.end(), groupPresets.begin(), groupPresets.end());
+		return !groupPresets.empty();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -387,24 +398,67 @@ namespace RTE {
 			return 0;
 		}
 
-		std::map<std::string, std::list<std::pair<std::string, Entity *>>>::iterator classItr = m_TypeMap.find(exactType);
-		if (classItr != m_TypeMap.end()) {
-			// Find an instance of that EXACT type and name; derived types are not matched
-			for (std::list<std::pair<std::string, Entity *>>::iterator instItr = (*classItr).second.begin(); instItr != (*classItr).second.end(); ++instItr) {
-				if ((*instItr).first == instanceName && (*instItr).second->GetClassName() == exactType) {
-					return (*instItr).second;
-				}
+		// Only instances of that EXACT type are in the index; derived types are not matched
+		std::unordered_map<std::string, std::unordered_map<std::string, Entity *>>::const_iterator classItr = m_PresetIndex.find(exactType);
+		if (classItr != m_PresetIndex.end()) {
+			std::unordered_map<std::string, Entity *>::const_iterator instItr = classItr->second.find(instanceName);
+			if (instItr != classItr->second.end()) {
+				return instItr->second;
 			}
 		}
 		return 0;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void DataModule::ReleasePresetSprites(Entity *pPreset) const {
+		MOSprite *pSpritePreset = g_SettingsMan.LoadSpritesOnDemand() ? dynamic_cast<MOSprite *>(pPreset) : 0;
+		if (pSpritePreset) { pSpritePreset->ReleaseSpriteFrames(); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const DataModule::GroupPresets & DataModule::GetGroupPresets(const std::string &group, const std::string &type) {
+		if (m_GroupIndexRevision != Entity::GetPresetGroupsRevision()) {
+			m_GroupIndex.clear();
+			m_GroupIndexRevision = Entity::GetPresetGroupsRevision();
+		}
+		// Either the Entity typelist that contains all entities in this DataModule, or the specific class' typelist (which will get all derived classes too)
+		std::string typeName = (type.empty() || type == "All") ? "Entity" : type;
+
+		std::unordered_map<std::string, GroupPresets> &typeGroups = m_GroupIndex[typeName];
+		std::unordered_map<std::string, GroupPresets>::iterator groupItr = typeGroups.find(group);
+		if (groupItr != typeGroups.end()) {
+			return groupItr->second;
+		}
+		GroupPresets &groupPresets = typeGroups[group];
+
+		std::map<std::string, std::list<std::pair<std::string, Entity *>>>::iterator classItr = m_TypeMap.find(typeName);
+		if (!group.empty() && classItr != m_TypeMap.end()) {
+			RTEAssert(!classItr->second.empty(), "DataModule has class entry without instances in its map!?");
+			for (std::list<std::pair<std::string, Entity *>>::iterator instItr = classItr->second.begin(); instItr != classItr->second.end(); ++instItr) {
+				if (instItr->second->IsInGroup(group)) {
+					groupPresets.m_Presets.push_back(instItr->second);
+
+					// Brains are only buyable when they're exactly what's asked for
+					const SceneObject *pSceneObject = dynamic_cast<const SceneObject *>(instItr->second);
+					if (group == "Brains" || (pSceneObject && pSceneObject->IsBuyable() && !instItr->second->IsInGroup("Brains"))) {
+						groupPresets.m_BuyablePresets.push_back(instItr->second);
+					}
+				}
+			}
+		}
+		return groupPresets;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool DataModule::AddToTypeMap(Entity *pEntToAdd) {
 		if (!pEntToAdd || pEntToAdd->GetPresetName() == "None" || pEntToAdd->GetPresetName().empty()) {
 			return false;
 		}
+		m_PresetIndex[pEntToAdd->GetClassName()][pEntToAdd->GetPresetName()] = pEntToAdd;
+		m_GroupIndex.clear();
 
 		// Walk up the class hierarchy till we reach the top, adding an entry of the passed in entity into each typelist as we go along
 		for (const Entity::ClassInfo *pClass = &(pEntToAdd->GetClass()); pClass != 0; pClass = pClass->GetParent()) {
@@ -10,6 +10,7 @@ struct BITMAP;
 namespace RTE {
 
 	class Entity;
+	class PresetCache;
 
 	/// <summary>
 	/// A representation of a DataModule containing zero or many Material, Effect, Ammo, Device, Actor, or Scene definitions.
@@ -89,7 +90,7 @@ namespace RTE {
 		/// An error return value signaling whether the property was successfully read or not.
 		/// 0 means it was read successfully, and any nonzero indicates that a property of that name could not be found in this or base classes.
 		/// </returns>
-		virtual int ReadProperty(std::string propName, Reader &reader);
+		virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 		/// <summary>
 		/// Saves the complete state of this DataModule to an output stream for later recreation with Create(Reader &reader).
@@ -214,6 +215,22 @@ namespace RTE {
 		/// <returns>Whether any Entity:s were found and added to the list.</returns>
 		bool GetAllOfGroup(std::list<Entity *> &objectList, std::string group, std::string type);
 
+		/// <summary>
+		/// Gets all previously read in (defined) Entities which are associated with a specific group, in the same order GetAllOfGroup adds them. The result is indexed, so asking again for the same group and type is quick.
+		/// </summary>
+		/// <param name="group">The group to look for.</param>
+		/// <param name="type">The name of the least common denominator type of the Entities you want. "All" will look at all types.</param>
+		/// <returns>All the matching Entities. Only valid until Presets are added to this or to groups. Ownership of the Entities is NOT transferred!</returns>
+		const std::vector<Entity *> & GetPresetsOfGroup(const std::string &group, const std::string &type) { return GetGroupPresets(group, type).m_Presets; }
+
+		/// <summary>
+		/// Gets all previously read in (defined) Entities which are associated with a specific group and can be bought. Brains are left out unless the group is "Brains" itself, in which case nothing is left out.
+		/// </summary>
+		/// <param name="group">The group to look for.</param>
+		/// <param name="type">The name of the least common denominator type of the Entities you want. "All" will look at all types.</param>
+		/// <returns>All the matching buyable Entities. Only valid until Presets are added to this or to groups. Ownership of the Entities is NOT transferred!</returns>
+		const std::vector<Entity *> & GetBuyablePresetsOfGroup(const std::string &group, const std::string &type) { return GetGroupPresets(group, type).m_BuyablePresets; }
+
 		/// <summary>
 		/// Adds to a list all previously read in (defined) Entities, by inexact type.
 		/// </summary>
@@ -308,6 +325,18 @@ namespace RTE {
 		/// </summary>
 		std::map<std::string, std::list<std::pair<std::string, Entity *>>> m_TypeMap;
 
+		/// <summary>
+		/// The Entities of one group and type, as gathered from the type map.
+		/// </summary>
+		struct GroupPresets {
+			std::vector<Entity *> m_Presets; //!< All the Entities in the group, in type map order.
+			std::vector<Entity *> m_BuyablePresets; //!< The Entities in the group that can be bought.
+		};
+
+		std::unordered_map<std::string, std::unordered_map<std::string, Entity *>> m_PresetIndex; //!< Every Entity instance by exact class name and then instance name, for looking them up without going through the type map. Not owned.
+		std::unordered_map<std::string, std::unordered_map<std::string, GroupPresets>> m_GroupIndex; //!< The Entities of each group that was asked for, by type and then group. Filled as groups are asked for and thrown away when anything is added.
+		unsigned int m_GroupIndexRevision; //!< The Entity::GetPresetGroupsRevision() the group index was filled at, so it's thrown away when any Preset is added to a group.
+
 #pragma region Entity Mapping
 		/// <summary>
 		/// Checks if the type map has an instance added of a specific name and exact type.
@@ -327,8 +356,31 @@ namespace RTE {
 		/// <param name="pEntToAdd">The new object instance to add. OINT!</param>
 		/// <returns>Whether the Entity was added successfully or not.</returns>
 		bool AddToTypeMap(Entity *pEntToAdd);
+
+		/// <summary>
+		/// Has a newly added preset let go of its sprites when loading sprites on demand, so they aren't held in memory until the preset is actually used.
+		/// </summary>
+		/// <param name="pPreset">The preset that was added.</param>
+		void ReleasePresetSprites(Entity *pPreset) const;
+
+		/// <summary>
+		/// Gets the Entities of a group and type from the group index, gathering them from the type map first if they weren't asked for before.
+		/// </summary>
+		/// <param name="group">The group to look for.</param>
+		/// <param name="type">The name of the least common denominator type of the Entities. "All" or empty will look at all types.</param>
+		/// <returns>The Entities of the group and type.</returns>
+		const GroupPresets & GetGroupPresets(const std::string &group, const std::string &type);
 #pragma endregion
 
+		/// <summary>
+		/// Reads the index file of this DataModule and all the files it includes, as well as every other ini file in its folder if it scans its folder contents.
+		/// </summary>
+		/// <param name="indexPath">The path of the ini file to load the DataModule from.</param>
+		/// <param name="presetCache">The PresetCache to record everything read to or play it back from, or 0 to read the ini files without one.</param>
+		/// <param name="fpProgressCallback">A function pointer to a function that will be called and sent a string with information about the progress of this DataModule's creation.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int ReadModuleFiles(const std::string &indexPath, PresetCache *presetCache, ProgressCallback fpProgressCallback);
+
 	private:
 
 		/// <summary>
@@ -7,6 +7,7 @@ namespace RTE {
 
 	Entity::ClassInfo Entity::m_sClass("Entity");
 	Entity::ClassInfo * Entity::ClassInfo::m_sClassHead = 0;
+	unsigned int Entity::m_sPresetGroupsRevision = 0;
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -45,7 +46,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int Entity::ReadProperty(std::string propName, Reader &reader) {
+	int Entity::ReadProperty(const std::string &propName, Reader &reader) {
 		if (propName == "CopyOf") {
 			std::string refName = reader.ReadPropValue();
 			const Entity *pPreset = g_PresetMan.GetEntityPreset(GetClassName(), refName, reader.GetReadModuleID());
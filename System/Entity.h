@@ -261,7 +261,7 @@ namespace RTE {
 		/// An error return value signaling whether the property was successfully read or not.
 		/// 0 means it was read successfully, and any nonzero indicates that a property of that name could not be found in this or base classes.
 		/// </returns>
-		virtual int ReadProperty(std::string propName, Reader &reader);
+		virtual int ReadProperty(const std::string &propName, Reader &reader);
 
 		/// <summary>
 		/// Saves the complete state of this Entity to an output stream for later recreation with Create(istream &stream).
@@ -362,7 +362,13 @@ namespace RTE {
 		/// Adds this Entity to a new grouping.
 		/// </summary>
 		/// <param name="newGroup">A string which describes the group to add this to. Duplicates will be ignored.</param>
-		void AddToGroup(std::string newGroup) { m_Groups.push_back(newGroup); m_Groups.sort(); m_Groups.unique(); m_LastGroupSearch.clear(); }
+		void AddToGroup(std::string newGroup) { m_Groups.push_back(newGroup); m_Groups.sort(); m_Groups.unique(); m_LastGroupSearch.clear(); if (m_IsOriginalPreset) { ++m_sPresetGroupsRevision; } }
+
+		/// <summary>
+		/// Gets a number that changes whenever an original Preset is added to a group, so indexes of Presets by group know when they need to be rebuilt.
+		/// </summary>
+		/// <returns>The current revision of the groups of all original Presets.</returns>
+		static unsigned int GetPresetGroupsRevision() { return m_sPresetGroupsRevision; }
 
 		/// <summary>
 		/// Returns random weight used in PresetMan::GetRandomBuyableOfGroupFromTech.
@@ -423,6 +429,7 @@ namespace RTE {
 	protected:
 
 		static Entity::ClassInfo m_sClass; //!< Type description of this Entity.
+		static unsigned int m_sPresetGroupsRevision; //!< Bumped whenever an original Preset is added to a group after it was added to its DataModule.
 
 		std::string m_PresetName; //!< The name of the Preset data this was cloned from, if any.
 		std::string m_PresetDescription; //!< The description of the preset in user friendly plain text that will show up in menus etc.
@@ -0,0 +1,232 @@
+#include "FilePrefetcher.h"
+#include "ProfilerMan.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FilePrefetcher::Clear() {
+		m_Threads.clear();
+		m_ModuleQueue.clear();
+		m_QueuedModules.clear();
+		m_ReadQueue.clear();
+		m_Files.clear();
+		m_LookingThroughModule = false;
+		m_BufferedBytes = 0;
+		m_MaxBufferedBytes = 0;
+		m_Quit = false;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int FilePrefetcher::Create(int threadCount, size_t maxBufferedBytes) {
+		if (threadCount <= 0 || !m_Threads.empty()) {
+			return -1;
+		}
+		m_MaxBufferedBytes = maxBufferedBytes;
+		for (int thread = 0; thread < threadCount; ++thread) {
+			m_Threads.push_back(std::thread(&FilePrefetcher::ThreadFunction, this, thread));
+		}
+		return 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FilePrefetcher::Destroy() {
+		if (!m_Threads.empty()) {
+			{
+				std::lock_guard<std::mutex> prefetchLock(m_PrefetchMutex);
+				m_Quit = true;
+			}
+			m_WorkQueued.notify_all();
+			for (std::thread &thread : m_Threads) {
+				thread.join();
+			}
+		}
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FilePrefetcher::QueueModule(const std::string &moduleName) {
+		if (m_Threads.empty()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> prefetchLock(m_PrefetchMutex);
+			if (!m_QueuedModules.insert(moduleName).second) {
+				return;
+			}
+			m_ModuleQueue.push_back(moduleName);
+		}
+		m_WorkQueued.notify_all();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FilePrefetcher::ReleaseModule(const std::string &moduleName) {
+		if (m_Threads.empty()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> prefetchLock(m_PrefetchMutex);
+			m_QueuedModules.erase(moduleName);
+			m_ModuleQueue.erase(std::remove(m_ModuleQueue.begin(), m_ModuleQueue.end(), moduleName), m_ModuleQueue.end());
+
+			// Paths left in the read queue are skipped by the threads once their files are gone
+			for (std::unordered_map<std::string, PrefetchedFile>::iterator fileItr = m_Files.begin(); fileItr != m_Files.end();) {
+				if (fileItr->second.m_ModuleName == moduleName) {
+					m_BufferedBytes -= fileItr->second.m_Data.size();
+					fileItr = m_Files.erase(fileItr);
+				} else {
+					++fileItr;
+				}
+			}
+		}
+		m_WorkQueued.notify_all();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool FilePrefetcher::TakeFile(const std::string &filePath, std::vector<char> &fileData) {
+		if (m_Threads.empty()) {
+			return false;
+		}
+		std::string normalizedPath = NormalizePath(filePath);
+
+		std::unique_lock<std::mutex> prefetchLock(m_PrefetchMutex);
+		std::unordered_map<std::string, PrefetchedFile>::iterator fileItr = m_Files.find(normalizedPath);
+		if (fileItr == m_Files.end()) {
+			return false;
+		}
+		// It's quicker to wait for a file that's halfway read than to start reading it all over again
+		if (fileItr->second.m_State == Reading) {
+			m_FileRead.wait(prefetchLock, [this, &fileItr, &normalizedPath]() {
+				fileItr = m_Files.find(normalizedPath);
+				return fileItr == m_Files.end() || fileItr->second.m_State != Reading;
+			});
+			if (fileItr == m_Files.end()) {
+				return false;
+			}
+		}
+		bool wasRead = fileItr->second.m_State == Ready;
+		if (wasRead) {
+			fileData.swap(fileItr->second.m_Data);
+			std::vector<char>().swap(fileItr->second.m_Data);
+			m_BufferedBytes -= fileData.size();
+		}
+		// Files that weren't read yet are marked too, so the threads don't read them after all
+		fileItr->second.m_State = Taken;
+		prefetchLock.unlock();
+
+		if (wasRead) { m_WorkQueued.notify_all(); }
+		return wasRead;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string FilePrefetcher::NormalizePath(const std::string &filePath) {
+		std::string normalizedPath = filePath;
+		for (char &pathChar : normalizedPath) {
+			pathChar = (pathChar == '\\') ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(pathChar)));
+		}
+		while (normalizedPath.compare(0, 2, "./") == 0) {
+			normalizedPath.erase(0, 2);
+		}
+		return normalizedPath;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool FilePrefetcher::IsPrefetchedType(const std::string &filePath) {
+		size_t extensionPos = filePath.find_last_of('.');
+		if (extensionPos == std::string::npos) {
+			return false;
+		}
+		std::string extension = NormalizePath(filePath.substr(extensionPos));
+		return extension == ".ini" || extension == ".bmp" || extension == ".wav" || extension == ".ogg" || extension == ".flac" || extension == ".mp3";
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FilePrefetcher::ThreadFunction(int threadIndex) {
+		g_ProfilerMan.SetThreadName("FilePrefetcher " + std::to_string(threadIndex));
+
+		std::unique_lock<std::mutex> prefetchLock(m_PrefetchMutex);
+		while (true) {
+			m_WorkQueued.wait(prefetchLock, [this]() { return m_Quit || (!m_ModuleQueue.empty() && !m_LookingThroughModule) || (!m_ReadQueue.empty() && m_BufferedBytes < m_MaxBufferedBytes); });
+			if (m_Quit) {
+				return;
+			}
+			// Only one thread looks through modules at a time, so their files are queued in the same order the modules were
+			if (!m_ModuleQueue.empty() && !m_LookingThroughModule) {
+				std::string moduleName = m_ModuleQueue.front();
+				m_ModuleQueue.pop_front();
+				m_LookingThroughModule = true;
+				prefetchLock.unlock();
+
+				std::vector<std::string> iniFiles;
+				std::vector<std::string> otherFiles;
+				std::error_code error;
+				for (std::experimental::filesystem::recursive_directory_iterator fileItr(moduleName, error), fileEnd; !error && fileItr != fileEnd; fileItr.increment(error)) {
+					std::string filePath = fileItr->path().generic_string();
+					if (std::experimental::filesystem::is_regular_file(fileItr->status()) && IsPrefetchedType(filePath)) {
+						(NormalizePath(fileItr->path().extension().generic_string()) == ".ini" ? iniFiles : otherFiles).push_back(filePath);
+					}
+				}
+				prefetchLock.lock();
+				m_LookingThroughModule = false;
+
+				// The module might've been loaded and released already while it was being looked through
+				if (m_QueuedModules.find(moduleName) != m_QueuedModules.end()) {
+					iniFiles.insert(iniFiles.end(), otherFiles.begin(), otherFiles.end());
+					for (const std::string &filePath : iniFiles) {
+						std::string normalizedPath = NormalizePath(filePath);
+						PrefetchedFile prefetchedFile = { filePath, moduleName, Queued, std::vector<char>() };
+						if (m_Files.insert(std::pair<std::string, PrefetchedFile>(normalizedPath, prefetchedFile)).second) { m_ReadQueue.push_back(normalizedPath); }
+					}
+				}
+				m_WorkQueued.notify_all();
+				continue;
+			}
+			std::string normalizedPath = m_ReadQueue.front();
+			m_ReadQueue.pop_front();
+
+			std::unordered_map<std::string, PrefetchedFile>::iterator fileItr = m_Files.find(normalizedPath);
+			if (fileItr == m_Files.end() || fileItr->second.m_State != Queued) {
+				continue;
+			}
+			fileItr->second.m_State = Reading;
+			std::string filePath = fileItr->second.m_FilePath;
+			prefetchLock.unlock();
+
+			std::vector<char> fileData;
+			std::ifstream file(filePath, std::ios::binary);
+			bool readOK = file.good();
+			if (readOK) {
+				file.seekg(0, std::ios::end);
+				std::streamoff fileSize = file.tellg();
+				file.seekg(0, std::ios::beg);
+				if (fileSize > 0) {
+					fileData.resize(static_cast<size_t>(fileSize));
+					readOK = static_cast<bool>(file.read(fileData.data(), fileSize));
+				}
+			}
+			prefetchLock.lock();
+
+			// Look the file up again, it might've been released in the meantime
+			fileItr = m_Files.find(normalizedPath);
+			if (fileItr != m_Files.end()) {
+				if (readOK) {
+					fileItr->second.m_Data.swap(fileData);
+					fileItr->second.m_State = Ready;
+					m_BufferedBytes += fileItr->second.m_Data.size();
+				} else {
+					// Leave files that couldn't be read to whoever asks for them, so they get the proper error
+					m_Files.erase(fileItr);
+				}
+			}
+			m_FileRead.notify_all();
+		}
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef _RTEFILEPREFETCHER_
+#define _RTEFILEPREFETCHER_
+
+namespace RTE {
+
+	/// <summary>
+	/// Reads the files of DataModules into memory on background threads ahead of the modules being loaded, so that loading on the main thread is spent parsing and decoding instead of waiting on the disk.
+	/// Modules are still loaded one after another on the main thread, in the same order as always. This only makes sure their files are already in memory by the time they're asked for.
+	/// Files the main thread asks for before they've been read in are just read by the main thread itself.
+	/// </summary>
+	class FilePrefetcher {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a FilePrefetcher object in system memory. Create() should be called before using the object.
+		/// </summary>
+		FilePrefetcher() { Clear(); }
+
+		/// <summary>
+		/// Makes the FilePrefetcher object ready for use, starting its threads.
+		/// </summary>
+		/// <param name="threadCount">How many threads to read files on.</param>
+		/// <param name="maxBufferedBytes">How many bytes of files can be held in memory waiting to be taken before the threads stop reading more.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Create(int threadCount, size_t maxBufferedBytes);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a FilePrefetcher object before deletion from system memory.
+		/// </summary>
+		~FilePrefetcher() { Destroy(); }
+
+		/// <summary>
+		/// Destroys and resets (through Clear()) the FilePrefetcher object, stopping its threads and throwing away all files that weren't taken.
+		/// </summary>
+		void Destroy();
+#pragma endregion
+
+#pragma region Prefetching
+		/// <summary>
+		/// Queues all the files of a DataModule to be read in, after those of any modules queued before it. The module's ini files are read before anything else in it, since they're needed first.
+		/// </summary>
+		/// <param name="moduleName">The file name of the DataModule, eg "Base.rte".</param>
+		void QueueModule(const std::string &moduleName);
+
+		/// <summary>
+		/// Throws away all the files of a DataModule that weren't taken, and stops reading any that weren't read yet. Should be called once the module is done loading.
+		/// </summary>
+		/// <param name="moduleName">The file name of the DataModule, eg "Base.rte".</param>
+		void ReleaseModule(const std::string &moduleName);
+
+		/// <summary>
+		/// Takes the contents of a file if it's been read in already. If it's being read right now this waits for it, if it's not been read yet it's dropped from the queue so the caller can read it instead.
+		/// Each file can only be taken once. Thread safe, but meant to be called from the main thread.
+		/// </summary>
+		/// <param name="filePath">The path of the file, relative to the working directory.</param>
+		/// <param name="fileData">Filled with the contents of the file, if it was read in.</param>
+		/// <returns>Whether the file was read in and its contents were taken.</returns>
+		bool TakeFile(const std::string &filePath, std::vector<char> &fileData);
+#pragma endregion
+
+	protected:
+
+		/// <summary>
+		/// Where a queued file is at.
+		/// </summary>
+		enum FileState { Queued = 0, Reading, Ready, Taken };
+
+		/// <summary>
+		/// A file queued to be read in.
+		/// </summary>
+		struct PrefetchedFile {
+			std::string m_FilePath; //!< The path of the file as it was found, for reading it.
+			std::string m_ModuleName; //!< The DataModule the file belongs to.
+			FileState m_State; //!< Where the file is at.
+			std::vector<char> m_Data; //!< The contents of the file, once it's Ready.
+		};
+
+		std::vector<std::thread> m_Threads; //!< The threads files are read on.
+		std::mutex m_PrefetchMutex; //!< Guards everything below.
+		std::condition_variable m_WorkQueued; //!< Signals the threads that there's a module to look through or a file to read, that there's room to read more, or that they should quit.
+		std::condition_variable m_FileRead; //!< Signals the main thread that a file is done being read.
+
+		std::deque<std::string> m_ModuleQueue; //!< The modules that were queued but not looked through for files yet.
+		std::unordered_set<std::string> m_QueuedModules; //!< All the modules that were queued and not released yet.
+		bool m_LookingThroughModule; //!< Whether a thread is looking through a module for files right now.
+		std::deque<std::string> m_ReadQueue; //!< The normalized paths of the files to read, in order.
+		std::unordered_map<std::string, PrefetchedFile> m_Files; //!< All the files of modules that weren't released yet, by normalized path.
+		size_t m_BufferedBytes; //!< How many bytes of files are read in and waiting to be taken.
+		size_t m_MaxBufferedBytes; //!< How many bytes can be waiting to be taken before the threads stop reading more.
+		bool m_Quit; //!< Tells the threads to exit.
+
+		/// <summary>
+		/// Turns a file path into the form used for looking it up, so the same file is found no matter how its path was written in the ini files.
+		/// </summary>
+		/// <param name="filePath">The path of the file.</param>
+		/// <returns>The path in lower case with forward slashes.</returns>
+		static std::string NormalizePath(const std::string &filePath);
+
+		/// <summary>
+		/// Gets whether a file is one of the kinds read while loading DataModules, ie ini files, bitmaps and sounds.
+		/// </summary>
+		/// <param name="filePath">The path of the file.</param>
+		/// <returns>Whether the file should be read in ahead.</returns>
+		static bool IsPrefetchedType(const std::string &filePath);
+
+		/// <summary>
+		/// The loop each thread runs, looking through queued modules for files and reading them in until told to quit.
+		/// </summary>
+		/// <param name="threadIndex">The index of this thread, for naming it.</param>
+		void ThreadFunction(int threadIndex);
+
+	private:
+
+		/// <summary>
+		/// Clears all the member variables of this FilePrefetcher, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		FilePrefetcher(const FilePrefetcher &reference);
+		FilePrefetcher & operator=(const FilePrefetcher &rhs);
+	};
+}
+#endif
@@ -61,7 +61,7 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int Matrix::ReadProperty(std::string propName, Reader &reader) {
+	int Matrix::ReadProperty(const std::string &propName, Reader &reader) {
 		if (propName == "AngleDegrees") {
 			float degAngle;
 			reader >> degAngle;
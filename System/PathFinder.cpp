@@ -1,14 +1,42 @@
 #include "PathFinder.h"
+#include "ProfilerMan.h"
 
 namespace RTE {
 
+	// Request IDs are unique across PathFinders, so a request made on a previous scene can never be mistaken for one made on the current
+	static int s_NextPathRequestID = 0;
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::Clear() {
 		m_NodeGrid.clear();
 		m_NodeDimension = 20;
+		m_PatherAllocate = 2000;
+		m_SceneWidth = 0;
+		m_SceneHeight = 0;
+		m_WrapsX = false;
+		m_WrapsY = false;
 		m_DigStrength = 1;
 		m_pPather = 0;
+		m_CostVersion = 0;
+		m_PatherCostVersion = 0;
+		m_PatherDigStrength = 1;
+		m_ChangedNodes.clear();
+		m_BatchPending = false;
+		m_Quit = false;
+		m_QueuedRequests.clear();
+		m_QueuedCostUpdates.clear();
+		m_BatchRequests.clear();
+		m_BatchCostUpdates.clear();
+		m_Results.clear();
+		m_CancelledRequests.clear();
+		m_NextRequestID = 0;
+		m_FirstPendingRequestID = 0;
+		m_UpdateCount = 0;
+		m_SnapshotCosts.clear();
+		m_SnapshotVersion = 0;
+		m_BatchCount = 0;
+		m_Solvers.clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -17,8 +45,13 @@ namespace RTE {
 		RTEAssert(pScene, "Scene doesn't exist or isn't loaded when creating PathFinder!");
 
 		m_NodeDimension = nodeDimension;
+		m_PatherAllocate = allocate;
 		int sceneWidth = g_SceneMan.GetSceneWidth();
 		int sceneHeight = g_SceneMan.GetSceneHeight();
+		m_SceneWidth = static_cast<float>(sceneWidth);
+		m_SceneHeight = static_cast<float>(sceneHeight);
+		m_WrapsX = pScene->WrapsX();
+		m_WrapsY = pScene->WrapsY();
 
 		// Make overlapping nodes at seams if necessary, to make sure all scene pixels are covered
 		int nodeXCount = ceilf(static_cast<float>(sceneWidth) / static_cast<float>(m_NodeDimension));
@@ -39,6 +72,7 @@ namespace RTE {
 				if (nodePos.m_Y >= sceneHeight) { nodePos.m_Y = sceneHeight - 1; }
 				// Create the new node with its in-scene position in the center of it
 				pNode = new PathNode(nodePos);
+				pNode->m_Index = x * nodeYCount + y;
 				// Move current position down for the next node in the column
 				nodePos.m_Y += nodeDimension;
 				// Add the newly created node to the column, transferring ownership to it
@@ -91,8 +125,18 @@ namespace RTE {
 				if (pNode->m_pLeft) { pNode->m_pLeft->m_RightCost = CostAlongLine(pNode->m_Pos, pNode->m_pLeft->m_Pos); }
 			}
 		}
-		// Set up all the costs between all nodes
+		// Set up all the costs between all nodes, and hand the pathfinding thread its own copy of them to start from
 		RecalculateAllCosts();
+		m_SnapshotCosts.resize(nodeXCount * nodeYCount * PathNode::c_AdjacentCount);
+		for (int x = 0; x < nodeXCount; ++x) {
+			for (int y = 0; y < nodeYCount; ++y) {
+				m_NodeGrid[x][y]->GetCosts(&m_SnapshotCosts[m_NodeGrid[x][y]->m_Index * PathNode::c_AdjacentCount]);
+			}
+		}
+		m_QueuedCostUpdates.clear();
+
+		m_NextRequestID = m_FirstPendingRequestID = s_NextPathRequestID;
+		m_SolverThread = std::thread(&PathFinder::SolverThreadFunction, this);
 
 		return 0;
 	}
@@ -100,6 +144,11 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::Destroy() {
+		// The pathfinding thread works off the nodes, so it has to be gone before they are
+		StopSolverThread();
+		for (PathSolver *pSolver : m_Solvers) {
+			delete pSolver;
+		}
 		for (int x = 0; x < m_NodeGrid.size(); ++x) {
 			for (int y = 0; y < m_NodeGrid[x].size(); ++y) {
 				delete m_NodeGrid[x][y];
@@ -115,6 +164,9 @@ namespace RTE {
 	int PathFinder::CalculatePath(Vector start, Vector end, std::list<Vector> &pathResult, float &totalCostResult, float digStrength) {
 		RTEAssert(m_pPather, "No pather exists, can't calculate the path!");
 
+		static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("PathFinder::CalculatePath");
+		ProfileZone profileZone(s_ProfilerZoneID);
+
 		// Make sure start and end are within scene bounds
 		g_SceneMan.ForceBounds(start);
 		g_SceneMan.ForceBounds(end);
@@ -125,21 +177,35 @@ namespace RTE {
 		int endNodeX = floorf(end.m_X / static_cast<float>(m_NodeDimension));
 		int endNodeY = floorf(end.m_Y / static_cast<float>(m_NodeDimension));
 
-		// Clear out the results if it happens to contain anything
-		pathResult.clear();
-
 		// Actors capable of digging can use m_DigStrength to modify the node adjacency cost
 		m_DigStrength = digStrength;
 
+		// The pather caches the adjacent costs it's been given, so it has to be reset if they changed since, either because the costs did or because they're weighed for another dig strength
+		if (m_PatherCostVersion != m_CostVersion || m_PatherDigStrength != m_DigStrength) {
+			m_pPather->Reset();
+			m_PatherCostVersion = m_CostVersion;
+			m_PatherDigStrength = m_DigStrength;
+		}
+
 		// Do the actual pathfinding, fetch out the list of states that comprise the best path
 		std::vector<void *> statePath;
 		int result = m_pPather->Solve((void *)(m_NodeGrid[startNodeX][startNodeY]), (void *)(m_NodeGrid[endNodeX][endNodeY]), &statePath, &totalCostResult);
 
+		BuildPathResult(start, end, statePath, pathResult);
+		return result;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::BuildPathResult(const Vector &start, const Vector &end, const std::vector<void *> &statePath, std::list<Vector> &pathResult) {
+		// Clear out the results if it happens to contain anything
+		pathResult.clear();
+
 		// We got something back
 		if (!statePath.empty()) {
 			// Replace the approximate first point from the pathfound path with the exact starting point
 			pathResult.push_back(start);
-			std::vector<void *>::iterator itr = statePath.begin();
+			std::vector<void *>::const_iterator itr = statePath.begin();
 			itr++;
 
 			// Convert from a list of state void pointers to a list of scene position vectors
@@ -156,7 +222,6 @@ namespace RTE {
 			pathResult.push_back(end);
 		}
 		// TODO: Clean up the path, remove series of nodes in the same direction etc?
-		return result;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -164,18 +229,13 @@ namespace RTE {
 	void PathFinder::RecalculateAllCosts() {
 		RTEAssert(g_SceneMan.GetScene(), "Scene doesn't exist or isn't loaded when recalculating PathFinder!");
 
-		PathNode *pNode = 0;
 		for (int x = 0; x < m_NodeGrid.size(); ++x) {
 			// Update all the costs going out from each node
 			for (int y = 0; y < m_NodeGrid[x].size(); ++y) {
-				pNode = m_NodeGrid[x][y];
-				UpdateNodeCosts(pNode);
-				// Should reset the changed flag since we're about to reset the pather
-				pNode->m_IsChanged = false;
+				UpdateNodeCosts(m_NodeGrid[x][y]);
 			}
 		}
-		// Reset the pather when costs change, as per the docs
-		m_pPather->Reset();
+		ClearChangedNodes();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -216,81 +276,236 @@ namespace RTE {
 			}
 		}
 
-		// Reset the pather when costs change, as per the docs
-		m_pPather->Reset();
-
-		// Reset the changed flag on all nodes
-		for (int x = 0; x < m_NodeGrid.size(); ++x) {
-			for (int y = 0; y < m_NodeGrid[x].size(); ++y) {
-				m_NodeGrid[x][y]->m_IsChanged = false;
-			}
-		}
+		ClearChangedNodes();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	float PathFinder::LeastCostEstimate(void *pStartState, void *pEndState) {
 		// TODO: Not .GetLargest()?? - No, because we're calculating cost as the difference between pos's, PLUS the pixel material strength costs summed
-		return g_SceneMan.ShortestDistance(((PathNode *)pStartState)->m_Pos, ((PathNode *)pEndState)->m_Pos).GetMagnitude();
+		// Wrapped by hand rather than with SceneMan::ShortestDistance, since this is also called from the pathfinding thread, which shouldn't touch the current scene
+		Vector distance = ((PathNode *)pEndState)->m_Pos - ((PathNode *)pStartState)->m_Pos;
+		if (m_WrapsX && fabs(distance.m_X) > m_SceneWidth / 2) { distance.m_X += (distance.m_X > 0) ? -m_SceneWidth : m_SceneWidth; }
+		if (m_WrapsY && fabs(distance.m_Y) > m_SceneHeight / 2) { distance.m_Y += (distance.m_Y > 0) ? -m_SceneHeight : m_SceneHeight; }
+		return distance.GetMagnitude();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::AdjacentCost(void *pState, std::vector<micropather::StateCost> *pAdjacentList) {
-		PathNode *pNode = (PathNode *)pState;
-		micropather::StateCost adjCost;
-		float strength = 0;
-
-		// Add cost for digging upwards
-		if (pNode->m_pUp) {
-			strength = pNode->m_UpCost;
-			adjCost.cost = 1 + (strength > m_DigStrength ? strength * 2000 : strength * 4); // Four times more expensive when digging
-			adjCost.state = (void *)pNode->m_pUp;
-			pAdjacentList->push_back(adjCost);
+		float costs[PathNode::c_AdjacentCount];
+		static_cast<PathNode *>(pState)->GetCosts(costs);
+		AddAdjacentCosts(static_cast<PathNode *>(pState), costs, m_DigStrength, pAdjacentList);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::RequestPath(Vector start, Vector end, float digStrength) {
+		// Make sure start and end are within scene bounds
+		g_SceneMan.ForceBounds(start);
+		g_SceneMan.ForceBounds(end);
+
+		PathRequest request;
+		request.m_ID = m_NextRequestID++;
+		s_NextPathRequestID = m_NextRequestID;
+		request.m_Start = start;
+		request.m_End = end;
+		request.m_pStartNode = m_NodeGrid[static_cast<int>(floorf(start.m_X / static_cast<float>(m_NodeDimension)))][static_cast<int>(floorf(start.m_Y / static_cast<float>(m_NodeDimension)))];
+		request.m_pEndNode = m_NodeGrid[static_cast<int>(floorf(end.m_X / static_cast<float>(m_NodeDimension)))][static_cast<int>(floorf(end.m_Y / static_cast<float>(m_NodeDimension)))];
+		request.m_DigStrength = digStrength;
+		request.m_TotalCost = -1;
+		request.m_DoneUpdate = 0;
+		m_QueuedRequests.push_back(request);
+
+		return request.m_ID;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PathFinder::GetPathResult(int requestID, std::list<Vector> &pathResult, float &totalCostResult) {
+		std::unordered_map<int, PathRequest>::iterator resultItr = m_Results.find(requestID);
+		if (resultItr == m_Results.end()) {
+			return false;
+		}
+		pathResult.swap(resultItr->second.m_Path);
+		totalCostResult = resultItr->second.m_TotalCost;
+		m_Results.erase(resultItr);
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::CancelPathRequest(int requestID) {
+		if (m_Results.erase(requestID) > 0 || !IsPathRequestPending(requestID)) {
+			return;
+		}
+		for (std::vector<PathRequest>::iterator itr = m_QueuedRequests.begin(); itr != m_QueuedRequests.end(); ++itr) {
+			if (itr->m_ID == requestID) {
+				m_QueuedRequests.erase(itr);
+				break;
+			}
+		}
+		// Requests being solved can't be pulled out from under the pathfinding thread, so remember to throw away the result instead
+		m_CancelledRequests.insert(requestID);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::Update() {
+		static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("PathFinder::Update");
+		ProfileZone profileZone(s_ProfilerZoneID);
+
+		++m_UpdateCount;
+
+		// Wait for the batch handed over last update, if the pathfinding thread isn't done with it already
+		{
+			std::unique_lock<std::mutex> lock(m_SolverMutex);
+			m_BatchDone.wait(lock, [this] { return !m_BatchPending; });
+		}
+
+		// Throw away results nobody got in time, then collect the new ones
+		for (std::unordered_map<int, PathRequest>::iterator itr = m_Results.begin(); itr != m_Results.end();) {
+			if (m_UpdateCount - itr->second.m_DoneUpdate > c_ResultLifetime) {
+				itr = m_Results.erase(itr);
+			} else {
+				++itr;
+			}
+		}
+		for (PathRequest &request : m_BatchRequests) {
+			if (m_CancelledRequests.find(request.m_ID) == m_CancelledRequests.end()) {
+				PathRequest &result = m_Results[request.m_ID];
+				result.m_Path.swap(request.m_Path);
+				result.m_TotalCost = request.m_TotalCost;
+				result.m_DoneUpdate = m_UpdateCount;
+			}
 		}
-		if (pNode->m_pRight) {
-			strength = pNode->m_RightCost;
-			adjCost.cost = 1 + (strength > m_DigStrength ? strength * 1000 : strength);
-			adjCost.state = (void *)pNode->m_pRight;
-			pAdjacentList->push_back(adjCost);
+		m_BatchRequests.clear();
+
+		// Everything queued since gets handed over now, so only those can still be pending
+		m_FirstPendingRequestID = m_QueuedRequests.empty() ? m_NextRequestID : m_QueuedRequests.front().m_ID;
+		for (std::unordered_set<int>::iterator itr = m_CancelledRequests.begin(); itr != m_CancelledRequests.end();) {
+			if (*itr < m_FirstPendingRequestID) {
+				itr = m_CancelledRequests.erase(itr);
+			} else {
+				++itr;
+			}
 		}
-		if (pNode->m_pDown) {
-			strength = pNode->m_DownCost;
-			adjCost.cost = 1 + (strength > m_DigStrength ? strength * 1000 : strength);
-			adjCost.state = (void *)pNode->m_pDown;
-			pAdjacentList->push_back(adjCost);
+
+		// Hand over cost changes even without any requests, so they don't pile up while nobody is pathfinding
+		if (!m_QueuedRequests.empty() || !m_QueuedCostUpdates.empty()) {
+			m_BatchRequests.swap(m_QueuedRequests);
+			m_BatchCostUpdates.swap(m_QueuedCostUpdates);
+			{
+				std::lock_guard<std::mutex> lock(m_SolverMutex);
+				m_BatchPending = true;
+			}
+			m_BatchPosted.notify_one();
 		}
-		if (pNode->m_pLeft) {
-			strength = pNode->m_LeftCost;
-			adjCost.cost = 1 + (strength > m_DigStrength ? strength * 1000 : strength);
-			adjCost.state = (void *)pNode->m_pLeft;
-			pAdjacentList->push_back(adjCost);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::SolverThreadFunction() {
+		g_ProfilerMan.SetThreadName("PathFinder");
+
+		std::unique_lock<std::mutex> lock(m_SolverMutex);
+		while (true) {
+			m_BatchPosted.wait(lock, [this] { return m_Quit || m_BatchPending; });
+			if (m_Quit) {
+				return;
+			}
+			lock.unlock();
+			SolveBatch();
+			lock.lock();
+			m_BatchPending = false;
+			m_BatchDone.notify_all();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::SolveBatch() {
+		static const int s_ProfilerZoneID = g_ProfilerMan.RegisterZone("PathFinder::SolveBatch");
+		ProfileZone profileZone(s_ProfilerZoneID);
+
+		++m_BatchCount;
+
+		if (!m_BatchCostUpdates.empty()) {
+			for (const CostUpdate &costUpdate : m_BatchCostUpdates) {
+				std::copy(costUpdate.m_Costs, costUpdate.m_Costs + PathNode::c_AdjacentCount, &m_SnapshotCosts[costUpdate.m_NodeIndex * PathNode::c_AdjacentCount]);
+			}
+			m_BatchCostUpdates.clear();
+			++m_SnapshotVersion;
+		}
+
+		std::vector<void *> statePath;
+		for (PathRequest &request : m_BatchRequests) {
+			PathSolver *pSolver = GetSolver(request.m_DigStrength);
+			if (pSolver->m_CostVersion != m_SnapshotVersion) {
+				pSolver->m_pPather->Reset();
+				pSolver->m_CostVersion = m_SnapshotVersion;
+			}
+			statePath.clear();
+			int result = pSolver->m_pPather->Solve((void *)(request.m_pStartNode), (void *)(request.m_pEndNode), &statePath, &request.m_TotalCost);
+
+			BuildPathResult(request.m_Start, request.m_End, statePath, request.m_Path);
+			// It's ok if start and end nodes happen to be the same, the exact pixel locations are added at the front and end of the result regardless
+			if (result != MicroPather::SOLVED && result != MicroPather::START_END_SAME) { request.m_TotalCost = -1; }
 		}
+	}
 
-		// Add cost for digging at 45 degrees and for digging upwards
-		if (pNode->m_pUpRight) {
-			strength = pNode->m_UpRightCost;
-			adjCost.cost = 1.4 + (strength > m_DigStrength ? strength * 2828 : strength * 4.2);  // Three times more expensive when digging
-			adjCost.state = (void *)pNode->m_pUpRight;
-			pAdjacentList->push_back(adjCost);
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	PathFinder::PathSolver * PathFinder::GetSolver(float digStrength) {
+		PathSolver *pLeastRecentSolver = 0;
+		for (PathSolver *pSolver : m_Solvers) {
+			if (pSolver->m_DigStrength == digStrength) {
+				pSolver->m_LastUsedBatch = m_BatchCount;
+				return pSolver;
+			}
+			if (!pLeastRecentSolver || pSolver->m_LastUsedBatch < pLeastRecentSolver->m_LastUsedBatch) { pLeastRecentSolver = pSolver; }
 		}
-		if (pNode->m_pRightDown) {
-			strength = pNode->m_RightDownCost;
-			adjCost.cost = 1.4 + (strength > m_DigStrength ? strength * 1414 : strength * 1.4);
-			adjCost.state = (void *)pNode->m_pRightDown;
-			pAdjacentList->push_back(adjCost);
+		if (m_Solvers.size() >= c_MaxSolverCount) {
+			m_Solvers.erase(std::find(m_Solvers.begin(), m_Solvers.end(), pLeastRecentSolver));
+			delete pLeastRecentSolver;
 		}
-		if (pNode->m_pDownLeft) {
-			strength = pNode->m_DownLeftCost;
-			adjCost.cost = 1.4 + (strength > m_DigStrength ? strength * 1414 : strength * 1.4);
-			adjCost.state = (void *)pNode->m_pDownLeft;
-			pAdjacentList->push_back(adjCost);
+		PathSolver *pNewSolver = new PathSolver(this, digStrength, m_PatherAllocate);
+		pNewSolver->m_CostVersion = m_SnapshotVersion;
+		pNewSolver->m_LastUsedBatch = m_BatchCount;
+		m_Solvers.push_back(pNewSolver);
+		return pNewSolver;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::StopSolverThread() {
+		if (!m_SolverThread.joinable()) {
+			return;
 		}
-		if (pNode->m_pLeftUp) {
-			strength = pNode->m_LeftUpCost;
-			adjCost.cost = 1.4 + (strength > m_DigStrength ? strength * 2828 : strength * 4.2);  // Three times more expensive when digging
-			adjCost.state = (void *)pNode->m_pLeftUp;
-			pAdjacentList->push_back(adjCost);
+		{
+			std::lock_guard<std::mutex> lock(m_SolverMutex);
+			m_Quit = true;
+		}
+		m_BatchPosted.notify_one();
+		m_SolverThread.join();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::AddAdjacentCosts(const PathNode *pNode, const float *costs, float digStrength, std::vector<micropather::StateCost> *pAdjacentList) {
+		const PathNode *adjacentNodes[PathNode::c_AdjacentCount] = { pNode->m_pUp, pNode->m_pRight, pNode->m_pDown, pNode->m_pLeft, pNode->m_pUpRight, pNode->m_pRightDown, pNode->m_pDownLeft, pNode->m_pLeftUp };
+		// Going diagonally is longer, and digging upwards is more expensive: four times when straight up and three times at 45 degrees
+		static const double baseCosts[PathNode::c_AdjacentCount] = { 1, 1, 1, 1, 1.4, 1.4, 1.4, 1.4 };
+		static const double digCosts[PathNode::c_AdjacentCount] = { 2000, 1000, 1000, 1000, 2828, 1414, 1414, 2828 };
+		static const double passCosts[PathNode::c_AdjacentCount] = { 4, 1, 1, 1, 4.2, 1.4, 1.4, 4.2 };
+
+		micropather::StateCost adjCost;
+		for (int i = 0; i < PathNode::c_AdjacentCount; ++i) {
+			if (adjacentNodes[i]) {
+				adjCost.cost = baseCosts[i] + costs[i] * (costs[i] > digStrength ? digCosts[i] : passCosts[i]);
+				adjCost.state = (void *)adjacentNodes[i];
+				pAdjacentList->push_back(adjCost);
+			}
 		}
 	}
 
@@ -300,6 +515,9 @@ namespace RTE {
 		if (!pNode) {
 			return;
 		}
+		float oldCosts[PathNode::c_AdjacentCount];
+		pNode->GetCosts(oldCosts);
+
 		// Look at each existing adjacent node and calculate the cost for each, offset start and end to cover more terrain
 		if (pNode->m_pUp) { pNode->m_UpCost = max(pNode->m_pUp->m_DownCost, CostAlongLine(pNode->m_Pos + Vector(3, 0), pNode->m_pUp->m_Pos + Vector(3, 0))); }
 		if (pNode->m_pRight) { pNode->m_RightCost = CostAlongLine(pNode->m_Pos + Vector(0, 3), pNode->m_pRight->m_Pos + Vector(0, 3)); }
@@ -313,6 +531,25 @@ namespace RTE {
 
 		// Mark this as already changed so the above expensive calculation isn't done redundantly
 		pNode->m_IsChanged = true;
+		m_ChangedNodes.push_back(pNode);
+
+		// Only costs that actually changed need to invalidate the pathers and be copied to the pathfinding thread
+		CostUpdate costUpdate;
+		costUpdate.m_NodeIndex = pNode->m_Index;
+		pNode->GetCosts(costUpdate.m_Costs);
+		if (memcmp(oldCosts, costUpdate.m_Costs, sizeof(oldCosts)) != 0) {
+			m_QueuedCostUpdates.push_back(costUpdate);
+			++m_CostVersion;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::ClearChangedNodes() {
+		for (PathNode *pNode : m_ChangedNodes) {
+			pNode->m_IsChanged = false;
+		}
+		m_ChangedNodes.clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -15,7 +15,8 @@ namespace RTE {
 	struct PathNode {
 
 		Vector m_Pos; //!< Absolute position of the center of this node in the scene.    
-		bool m_IsChanged; //!< Whether this has been updated since last call to Reset the pather.
+		int m_Index; //!< The index of this node in the path grid, column-major. Used to look up its costs in the pathfinding thread's snapshot of them.
+		bool m_IsChanged; //!< Whether this has been updated during the current cost recalculation.
 
 		/// <summary>
 		/// Pointers to all adjacent nodes. These are not owned, and may be 0 if adjacent to non-wrapping scene border.
@@ -41,12 +42,25 @@ namespace RTE {
 		float m_DownLeftCost;
 		float m_LeftUpCost;
 
+		static const int c_AdjacentCount = 8; //!< The number of adjacent nodes and costs each node has, in the order they're declared above.
+
 		PathNode(Vector pos) {
 			m_Pos = pos;
+			m_Index = 0;
+			m_IsChanged = false;
 			m_pUp = m_pRight = m_pDown = m_pLeft = m_pUpRight = m_pRightDown = m_pDownLeft = m_pLeftUp = 0;
 			// Costs are infinite unless recalculated as otherwise
 			m_UpCost = m_RightCost = m_DownCost = m_LeftCost = m_UpRightCost = m_RightDownCost = m_DownLeftCost = m_LeftUpCost = FLT_MAX;
 		}
+
+		/// <summary>
+		/// Gets the costs to get to each of the adjacent nodes.
+		/// </summary>
+		/// <param name="costs">An array of c_AdjacentCount floats to fill out with the costs, in the order they're declared in.</param>
+		void GetCosts(float *costs) const {
+			costs[0] = m_UpCost; costs[1] = m_RightCost; costs[2] = m_DownCost; costs[3] = m_LeftCost;
+			costs[4] = m_UpRightCost; costs[5] = m_RightDownCost; costs[6] = m_DownLeftCost; costs[7] = m_LeftUpCost;
+		}
 	};
 
 	/// <summary>
@@ -105,12 +119,13 @@ namespace RTE {
 		int CalculatePath(Vector start, Vector end, std::list<Vector> &pathResult, float &totalCostResult, float digStrength = 1);
 
 		/// <summary>
-		/// Recalculates all the costs between all the nodes by tracing lines in the material layer and summing all the material strengths for each encountered pixel. Also resets the pather itself.
+		/// Recalculates all the costs between all the nodes by tracing lines in the material layer and summing all the material strengths for each encountered pixel.
 		/// </summary>
 		void RecalculateAllCosts();
 
 		/// <summary>
-		/// Recalculates the costs between all the nodes touching a list of specific rectangular areas (which will be wrapped). Also resets the pather itself.
+		/// Recalculates the costs between all the nodes touching a list of specific rectangular areas (which will be wrapped).
+		/// The pathers aren't reset here; costs that actually changed bump the cost version, and each pather resets itself before its next solve if it's behind.
 		/// </summary>
 		/// <param name="boxList">The list of Boxes representing the updated areas.</param>
 		void RecalculateAreaCosts(const std::list<Box> &boxList);
@@ -136,6 +151,52 @@ namespace RTE {
 		virtual void AdjacentCost(void *pState, std::vector<micropather::StateCost> *pAdjacentList);
 #pragma endregion
 
+#pragma region Asynchronous PathFinding
+		/// <summary>
+		/// Queues up a path to be calculated on the pathfinding thread, against the costs as they are at the next Update.
+		/// All requests made during a sim update are handed to the thread together at the next Update, and their results are available from the Update after that.
+		/// </summary>
+		/// <param name="start">Start position on the scene to find the path from.</param>
+		/// <param name="end">End position on the scene to find the path to.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <returns>The ID of the request, to get its result with.</returns>
+		int RequestPath(Vector start, Vector end, float digStrength = 1);
+
+		/// <summary>
+		/// Gets the result of a path request, if it's done. Results that aren't gotten within c_ResultLifetime updates of being done are thrown away.
+		/// </summary>
+		/// <param name="requestID">The ID of the request, as returned by RequestPath.</param>
+		/// <param name="pathResult">A list which will be filled out with waypoints between the start and end, if the result is ready.</param>
+		/// <param name="totalCostResult">The total minimum difficulty cost calculated between the two points, or -1 if there is no path.</param>
+		/// <returns>Whether the result was ready. It can only be gotten once.</returns>
+		bool GetPathResult(int requestID, std::list<Vector> &pathResult, float &totalCostResult);
+
+		/// <summary>
+		/// Indicates whether a path request is still waiting to be solved.
+		/// </summary>
+		/// <param name="requestID">The ID of the request, as returned by RequestPath.</param>
+		/// <returns>Whether the request is queued or being solved right now.</returns>
+		bool IsPathRequestPending(int requestID) const { return requestID >= m_FirstPendingRequestID && requestID < m_NextRequestID && m_CancelledRequests.find(requestID) == m_CancelledRequests.end(); }
+
+		/// <summary>
+		/// Cancels a path request, or throws away its result if it's already done.
+		/// </summary>
+		/// <param name="requestID">The ID of the request, as returned by RequestPath.</param>
+		void CancelPathRequest(int requestID);
+
+		/// <summary>
+		/// Indicates whether there are path requests waiting to be handed to the pathfinding thread at the next Update.
+		/// </summary>
+		/// <returns>Whether any path requests have been made since the last Update.</returns>
+		bool HasQueuedPathRequests() const { return !m_QueuedRequests.empty(); }
+
+		/// <summary>
+		/// Collects the results of the requests that were being solved, and hands the requests queued since then, along with any cost changes, over to the pathfinding thread.
+		/// Waits for the pathfinding thread if it isn't done yet. Has to be called once every sim update.
+		/// </summary>
+		void Update();
+#pragma endregion
+
 #pragma region Misc
 		/// <summary>
 		/// Implementation of the abstract interface of Graph. This function is only used in DEBUG mode - it dumps output to stdout.
@@ -147,13 +208,115 @@ namespace RTE {
 
 	protected:
 
-		MicroPather *m_pPather; //!< The actual pathing object that does the pathfinding work. Owned.
+		static const int c_MaxSolverCount = 8; //!< How many pathers with different dig strengths the pathfinding thread keeps around at most.
+		static const int c_ResultLifetime = 60; //!< How many updates path results are kept around for after they're done, if nobody gets them.
+
+		/// <summary>
+		/// A path requested with RequestPath, and its result once solved.
+		/// </summary>
+		struct PathRequest {
+			int m_ID; //!< The ID the request was given.
+			Vector m_Start; //!< Where the path starts, within scene bounds.
+			Vector m_End; //!< Where the path ends, within scene bounds.
+			PathNode *m_pStartNode; //!< The node the path starts in.
+			PathNode *m_pEndNode; //!< The node the path ends in.
+			float m_DigStrength; //!< What material strength the search is capable of digging through.
+			std::list<Vector> m_Path; //!< The waypoints of the path, filled out by the pathfinding thread.
+			float m_TotalCost; //!< The total cost of the path, or -1 if there is none, filled out by the pathfinding thread.
+			int m_DoneUpdate; //!< The update the result was collected in.
+		};
+
+		/// <summary>
+		/// The costs of a node that changed since the last batch of requests, to be copied into the pathfinding thread's snapshot.
+		/// </summary>
+		struct CostUpdate {
+			int m_NodeIndex; //!< The index of the node whose costs changed.
+			float m_Costs[PathNode::c_AdjacentCount]; //!< The new costs of the node.
+		};
+
+		/// <summary>
+		/// A MicroPather working off the pathfinding thread's snapshot of the costs, for a specific dig strength.
+		/// The pather caches the costs it sees, so there's one of these for each dig strength in use, and each is reset when the snapshot changes.
+		/// </summary>
+		class PathSolver : public Graph {
+
+		public:
+
+			PathSolver(PathFinder *pPathFinder, float digStrength, unsigned int allocate) : m_pPathFinder(pPathFinder), m_DigStrength(digStrength), m_CostVersion(0), m_LastUsedBatch(0) { m_pPather = new MicroPather(this, allocate); }
+			~PathSolver() { delete m_pPather; }
+
+			virtual float LeastCostEstimate(void *pStartState, void *pEndState) { return m_pPathFinder->LeastCostEstimate(pStartState, pEndState); }
+			virtual void AdjacentCost(void *pState, std::vector<micropather::StateCost> *pAdjacentList) { AddAdjacentCosts(static_cast<PathNode *>(pState), &m_pPathFinder->m_SnapshotCosts[static_cast<PathNode *>(pState)->m_Index * PathNode::c_AdjacentCount], m_DigStrength, pAdjacentList); }
+			virtual void PrintStateInfo(void *pState) { ; }
+
+			MicroPather *m_pPather; //!< The pather doing the work. Owned.
+			PathFinder *m_pPathFinder; //!< The PathFinder whose snapshot costs this works off. Not owned.
+			float m_DigStrength; //!< The dig strength this solves paths for.
+			unsigned int m_CostVersion; //!< The version of the snapshot costs the pather was last reset for.
+			unsigned int m_LastUsedBatch; //!< The last batch this was used in, for throwing out the least recently used solver when there are too many.
+
+		private:
+
+			PathSolver(const PathSolver &reference);
+			PathSolver & operator=(const PathSolver &rhs);
+		};
+
+		MicroPather *m_pPather; //!< The actual pathing object that does the pathfinding work for synchronous requests. Owned.
 		std::vector<std::vector<PathNode *>> m_NodeGrid;  //!< The array of PathNodes representing the grid on the scene. The nodes are owned by this.
 		int m_NodeDimension; //!< The width and height of each node, in pixels on the scene.
+		unsigned int m_PatherAllocate; //!< The block size the node caches of the pathers are allocated from.
+		float m_SceneWidth; //!< The width of the scene, in pixels.
+		float m_SceneHeight; //!< The height of the scene, in pixels.
+		bool m_WrapsX; //!< Whether the scene wraps horizontally.
+		bool m_WrapsY; //!< Whether the scene wraps vertically.
 
 		float m_DigStrength; //!< What material strength the search is capable of digging through.
+		unsigned int m_CostVersion; //!< Incremented every time any cost in the node grid actually changes.
+		unsigned int m_PatherCostVersion; //!< The cost version the synchronous pather was last reset for.
+		float m_PatherDigStrength; //!< The dig strength the synchronous pather was last reset for, since it caches adjacent costs which depend on it.
+		std::vector<PathNode *> m_ChangedNodes; //!< The nodes marked as changed during the current cost recalculation. Not owned.
+
+		std::thread m_SolverThread; //!< The pathfinding thread.
+		std::mutex m_SolverMutex; //!< Guards m_BatchPending and m_Quit.
+		std::condition_variable m_BatchPosted; //!< Signals the pathfinding thread that there's a batch to solve, or that it should quit.
+		std::condition_variable m_BatchDone; //!< Signals the main thread that the pathfinding thread is done with the batch.
+		bool m_BatchPending; //!< Whether the pathfinding thread has a batch it isn't done with yet.
+		bool m_Quit; //!< Tells the pathfinding thread to exit.
+
+		std::vector<PathRequest> m_QueuedRequests; //!< Requests made since the last Update. Main thread only.
+		std::vector<CostUpdate> m_QueuedCostUpdates; //!< Cost changes made since the last batch was handed over. Main thread only.
+		std::vector<PathRequest> m_BatchRequests; //!< The requests being solved. Only touched by the pathfinding thread while a batch is pending.
+		std::vector<CostUpdate> m_BatchCostUpdates; //!< The cost changes to apply before solving the batch. Only touched by the pathfinding thread while a batch is pending.
+		std::unordered_map<int, PathRequest> m_Results; //!< Solved requests that haven't been gotten yet, by ID. Main thread only.
+		std::unordered_set<int> m_CancelledRequests; //!< Pending requests that were cancelled, so their results are thrown away. Main thread only.
+		int m_NextRequestID; //!< The ID the next request will be given.
+		int m_FirstPendingRequestID; //!< The ID of the oldest request that could still be pending.
+		int m_UpdateCount; //!< How many times Update has been called.
+
+		std::vector<float> m_SnapshotCosts; //!< The pathfinding thread's copy of the costs of all nodes, c_AdjacentCount per node, indexed by node. Pathfinding thread only.
+		unsigned int m_SnapshotVersion; //!< Incremented every time cost changes are applied to the snapshot. Pathfinding thread only.
+		unsigned int m_BatchCount; //!< How many batches the pathfinding thread has solved. Pathfinding thread only.
+		std::vector<PathSolver *> m_Solvers; //!< The pathers of the pathfinding thread, one per dig strength. Owned. Pathfinding thread only.
 
 #pragma region Path Cost Updates
+		/// <summary>
+		/// Adds the costs of going to each existing adjacent node of a node to a list, weighed by how hard digging through them would be.
+		/// </summary>
+		/// <param name="pNode">The node to get the adjacent costs of.</param>
+		/// <param name="costs">The c_AdjacentCount costs of the node to go by.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <param name="pAdjacentList">The list to add the adjacent nodes and their costs to.</param>
+		static void AddAdjacentCosts(const PathNode *pNode, const float *costs, float digStrength, std::vector<micropather::StateCost> *pAdjacentList);
+
+		/// <summary>
+		/// Helper function for turning the states of a solved path into a list of scene positions, with the exact start and end points at either end.
+		/// </summary>
+		/// <param name="start">The exact start of the path.</param>
+		/// <param name="end">The exact end of the path.</param>
+		/// <param name="statePath">The states of the solved path, empty if there was none.</param>
+		/// <param name="pathResult">The list to fill out with the waypoints.</param>
+		static void BuildPathResult(const Vector &start, const Vector &end, const std::vector<void *> &statePath, std::list<Vector> &pathResult);
+
 		/// <summary>
 		/// Helper function for calculating the real actual cost of going in a straight line between any two points on the scene.
 		/// It takes into account distance traveled, as well as the strength of the materials the line has to pass through.
@@ -165,12 +328,17 @@ namespace RTE {
 		float CostAlongLine(const Vector &start, const Vector &end) { return g_SceneMan.CastMaxStrengthRay(start, end, 0); }
 
 		/// <summary>
-		/// Helper function for updating all the values of cost edges going out from a specific node.
-		/// This does NOT update the pather, which is required before solving more paths after calling this.
+		/// Helper function for updating all the values of cost edges going out from a specific node, and marking it as changed.
+		/// If any cost actually changed, the cost version is bumped and the new costs queued up for the pathfinding thread.
 		/// </summary>
 		/// <param name="pNode">The node to update all costs of. OINT. It's safe to pass 0 here.</param>
 		void UpdateNodeCosts(PathNode *pNode);
 
+		/// <summary>
+		/// Clears the changed flag of all the nodes that were marked as changed during the current cost recalculation.
+		/// </summary>
+		void ClearChangedNodes();
+
 		/// <summary>
 		/// Helper function for updating all the values of cost edges crossed by a specific box.
 		/// This does NOT update the pather, which is required before solving more paths after calling this. Also it does NOT wrap the box coming in here, only truncates it!
@@ -179,6 +347,30 @@ namespace RTE {
 		void UpdateNodeCostsInBox(Box &box);
 #pragma endregion
 
+#pragma region Pathfinding Thread
+		/// <summary>
+		/// The function the pathfinding thread runs, solving batches of requests as they're handed to it until told to quit.
+		/// </summary>
+		void SolverThreadFunction();
+
+		/// <summary>
+		/// Applies the cost changes of the current batch to the snapshot and solves all its requests. Pathfinding thread only.
+		/// </summary>
+		void SolveBatch();
+
+		/// <summary>
+		/// Gets the pather for a specific dig strength, making it if needed and throwing out the least recently used one if there are too many. Pathfinding thread only.
+		/// </summary>
+		/// <param name="digStrength">The dig strength to get the pather for.</param>
+		/// <returns>The pather for the dig strength. Ownership is NOT transferred!</returns>
+		PathSolver * GetSolver(float digStrength);
+
+		/// <summary>
+		/// Tells the pathfinding thread to quit and waits for it to.
+		/// </summary>
+		void StopSolverThread();
+#pragma endregion
+
 	private:
 
 		/// <summary>
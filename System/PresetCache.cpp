@@ -0,0 +1,391 @@
+#include "PresetCache.h"
+#include "Reader.h"
+#include "PresetMan.h"
+
+namespace RTE {
+
+	const std::string PresetCache::c_CacheDirectory = "PresetCache";
+	const uint32_t PresetCache::c_FormatVersion = 2;
+
+	/// <summary>
+	/// The first bytes of every cache file.
+	/// </summary>
+	static const char c_CacheFileMagic[8] = { 'R', 'T', 'E', 'P', 'C', 'A', 'C', 'H' };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::Clear() {
+		m_ModuleName.clear();
+		m_CachePath.clear();
+		m_IndexPath.clear();
+		m_LoadedModules.clear();
+		m_Replaying = false;
+		m_ReplayFailed = false;
+		m_SourceFiles.clear();
+		m_SourceFileIndices.clear();
+		m_PropNames.clear();
+		m_PropNameIndices.clear();
+		m_Tape.clear();
+		m_TapePos = 0;
+		m_TapeOverrun = false;
+		m_LastFileIndex = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PresetCache::Create(const std::string &moduleName, const std::string &indexPath, bool loadSavedCache) {
+		if (moduleName.empty()) {
+			return -1;
+		}
+		m_ModuleName = moduleName;
+		m_CachePath = c_CacheDirectory + "/" + moduleName + ".cache";
+		m_IndexPath = indexPath;
+
+		// What other modules are loaded can change how this one reads, eg by which presets it finds to copy
+		for (int module = 0; module < g_PresetMan.GetTotalModuleCount(); ++module) {
+			const std::string &loadedModule = g_PresetMan.GetDataModuleName(module);
+			if (loadedModule != moduleName) { m_LoadedModules.push_back(loadedModule); }
+		}
+		m_Replaying = loadSavedCache && LoadCacheFile();
+
+		// Start over clean if the saved cache couldn't be used, and record a new one instead
+		if (!m_Replaying) {
+			m_SourceFiles.clear();
+			m_SourceFileIndices.clear();
+			m_PropNames.clear();
+			m_PropNameIndices.clear();
+			m_Tape.clear();
+		}
+		m_TapePos = 0;
+		m_TapeOverrun = false;
+		m_LastFileIndex = 0;
+		return 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::AddSourceFile(const std::string &filePath) {
+		if (!m_Replaying && m_SourceFileIndices.find(filePath) == m_SourceFileIndices.end()) {
+			m_SourceFileIndices.insert(std::pair<std::string, uint32_t>(filePath, static_cast<uint32_t>(m_SourceFiles.size())));
+			SourceFile sourceFile = { filePath, 0, 0 };
+			m_SourceFiles.push_back(sourceFile);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::RecordOpen(const std::string &filePath) {
+		AddSourceFile(filePath);
+		WriteTapeValue(ReadOpen);
+		WriteTapeValue(filePath);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PresetCache::Save() {
+		if (m_Replaying || GetBuildStamp().empty()) {
+			return -1;
+		}
+		std::vector<SourceFile> sourceFiles = m_SourceFiles;
+		for (SourceFile &sourceFile : sourceFiles) {
+			if (!HashFile(sourceFile.m_FilePath, sourceFile.m_FileSize, sourceFile.m_FileHash)) {
+				return -1;
+			}
+		}
+		std::vector<std::string> moduleIniFiles = GetModuleIniFiles();
+
+		std::experimental::filesystem::create_directory(c_CacheDirectory);
+		std::ofstream cacheFile(m_CachePath, std::ios::binary);
+		if (!cacheFile.good()) {
+			return -1;
+		}
+		// The tape functions write to m_Tape, so borrow it to put the header together. It has to match what LoadCacheFile expects, in the same order
+		std::vector<char> recordedTape;
+		recordedTape.swap(m_Tape);
+
+		m_Tape.insert(m_Tape.end(), c_CacheFileMagic, c_CacheFileMagic + sizeof(c_CacheFileMagic));
+		WriteTapeValue(c_FormatVersion);
+		WriteTapeValue(GetBuildStamp());
+		WriteTapeValue(m_IndexPath);
+		WriteTapeValue(static_cast<uint32_t>(m_LoadedModules.size()));
+		for (const std::string &loadedModule : m_LoadedModules) {
+			WriteTapeValue(loadedModule);
+		}
+		WriteTapeValue(static_cast<uint32_t>(moduleIniFiles.size()));
+		for (const std::string &moduleIniFile : moduleIniFiles) {
+			WriteTapeValue(moduleIniFile);
+		}
+		WriteTapeValue(static_cast<uint32_t>(sourceFiles.size()));
+		for (const SourceFile &sourceFile : sourceFiles) {
+			WriteTapeValue(sourceFile.m_FilePath);
+			WriteTapeValue(sourceFile.m_FileSize);
+			WriteTapeValue(sourceFile.m_FileHash);
+		}
+		WriteTapeValue(static_cast<uint32_t>(m_PropNames.size()));
+		for (const std::string *propName : m_PropNames) {
+			WriteTapeValue(*propName);
+		}
+		std::vector<char> header;
+		header.swap(m_Tape);
+		m_Tape.swap(recordedTape);
+
+		cacheFile.write(header.data(), header.size());
+		cacheFile.write(m_Tape.data(), m_Tape.size());
+		cacheFile.close();
+
+		if (!cacheFile.good()) {
+			std::remove(m_CachePath.c_str());
+			return -1;
+		}
+		return 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::ReplayOpen(const std::string &filePath) {
+		ReadType recordedType;
+		ReadTapeValue(recordedType);
+		std::string recordedPath;
+		if (recordedType == ReadOpen) { ReadTapeValue(recordedPath); }
+		if (recordedType != ReadOpen || recordedPath != filePath) { AbandonReplay(); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::WriteTapeValue(const std::string &value) {
+		WriteTapeValue(static_cast<uint32_t>(value.size()));
+		m_Tape.insert(m_Tape.end(), value.begin(), value.end());
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::WriteTapeValue(const std::string * const &value) {
+		std::unordered_map<const std::string *, uint32_t>::const_iterator nameItr = m_PropNameIndices.find(value);
+		if (nameItr == m_PropNameIndices.end()) {
+			nameItr = m_PropNameIndices.insert(std::pair<const std::string *, uint32_t>(value, static_cast<uint32_t>(m_PropNames.size()))).first;
+			m_PropNames.push_back(value);
+		}
+		WriteTapeValue(nameItr->second);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::WriteTapePosition(const std::string &filePath, int fileLine) {
+		// Readers stay in the same file for long stretches, so only look the path up when it's changed
+		if (m_SourceFiles.empty() || m_SourceFiles[m_LastFileIndex].m_FilePath != filePath) {
+			AddSourceFile(filePath);
+			m_LastFileIndex = m_SourceFileIndices.at(filePath);
+		}
+		WriteTapeValue(m_LastFileIndex);
+		WriteTapeValue(static_cast<int32_t>(fileLine));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::ReadTapeValue(std::string &value) {
+		uint32_t length;
+		ReadTapeValue(length);
+		if (m_TapePos + length > m_Tape.size()) {
+			TapeOverrun();
+			value.clear();
+			return;
+		}
+		value.assign(m_Tape.data() + m_TapePos, length);
+		m_TapePos += length;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::ReadTapeValue(const std::string *&value) {
+		uint32_t nameIndex;
+		ReadTapeValue(nameIndex);
+		if (m_TapeOverrun || nameIndex >= m_PropNames.size()) {
+			TapeOverrun();
+			value = &Reader::InternPropName("");
+			return;
+		}
+		value = m_PropNames[nameIndex];
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::ReadTapePosition(std::string &filePath, int &fileLine) {
+		uint32_t fileIndex;
+		int32_t line;
+		ReadTapeValue(fileIndex);
+		ReadTapeValue(line);
+		if (m_TapeOverrun || fileIndex >= m_SourceFiles.size()) {
+			TapeOverrun();
+			return;
+		}
+		if (fileIndex != m_LastFileIndex || filePath != m_SourceFiles[fileIndex].m_FilePath) {
+			filePath = m_SourceFiles[fileIndex].m_FilePath;
+			m_LastFileIndex = fileIndex;
+		}
+		fileLine = line;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::TapeOverrun() {
+		if (m_Replaying) {
+			AbandonReplay();
+		} else {
+			m_TapeOverrun = true;
+			m_TapePos = m_Tape.size();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PresetCache::AbandonReplay() {
+		if (!m_ReplayFailed) {
+			std::remove(m_CachePath.c_str());
+			m_ReplayFailed = true;
+		}
+		m_TapeOverrun = true;
+		m_TapePos = m_Tape.size();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PresetCache::LoadCacheFile() {
+		std::ifstream cacheFile(m_CachePath, std::ios::binary);
+		if (!cacheFile.good()) {
+			return false;
+		}
+		cacheFile.seekg(0, std::ios::end);
+		std::streamoff fileSize = cacheFile.tellg();
+		cacheFile.seekg(0, std::ios::beg);
+		if (fileSize < static_cast<std::streamoff>(sizeof(c_CacheFileMagic))) {
+			return false;
+		}
+		m_Tape.resize(static_cast<size_t>(fileSize));
+		if (!cacheFile.read(m_Tape.data(), fileSize)) {
+			return false;
+		}
+		cacheFile.close();
+
+		// The header is read through the tape functions too, which only mark the tape as overrun while this isn't playing back yet
+		if (std::memcmp(m_Tape.data(), c_CacheFileMagic, sizeof(c_CacheFileMagic)) != 0) {
+			return false;
+		}
+		m_TapePos = sizeof(c_CacheFileMagic);
+		uint32_t formatVersion;
+		ReadTapeValue(formatVersion);
+		if (m_TapeOverrun || formatVersion != c_FormatVersion) {
+			return false;
+		}
+		std::string buildStamp;
+		std::string indexPath;
+		ReadTapeValue(buildStamp);
+		ReadTapeValue(indexPath);
+		if (m_TapeOverrun || buildStamp.empty() || buildStamp != GetBuildStamp() || indexPath != m_IndexPath) {
+			return false;
+		}
+		uint32_t count;
+		std::string name;
+		ReadTapeValue(count);
+		if (m_TapeOverrun || count != m_LoadedModules.size()) {
+			return false;
+		}
+		for (const std::string &loadedModule : m_LoadedModules) {
+			ReadTapeValue(name);
+			if (name != loadedModule) {
+				return false;
+			}
+		}
+		std::vector<std::string> moduleIniFiles = GetModuleIniFiles();
+		ReadTapeValue(count);
+		if (m_TapeOverrun || count != moduleIniFiles.size()) {
+			return false;
+		}
+		for (const std::string &moduleIniFile : moduleIniFiles) {
+			ReadTapeValue(name);
+			if (name != moduleIniFile) {
+				return false;
+			}
+		}
+		ReadTapeValue(count);
+		for (uint32_t file = 0; file < count; ++file) {
+			SourceFile sourceFile;
+			ReadTapeValue(sourceFile.m_FilePath);
+			ReadTapeValue(sourceFile.m_FileSize);
+			ReadTapeValue(sourceFile.m_FileHash);
+
+			uint64_t currentSize;
+			uint64_t currentHash;
+			if (m_TapeOverrun || !HashFile(sourceFile.m_FilePath, currentSize, currentHash) || currentSize != sourceFile.m_FileSize || currentHash != sourceFile.m_FileHash) {
+				return false;
+			}
+			m_SourceFileIndices.insert(std::pair<std::string, uint32_t>(sourceFile.m_FilePath, file));
+			m_SourceFiles.push_back(sourceFile);
+		}
+		ReadTapeValue(count);
+		for (uint32_t propName = 0; propName < count && !m_TapeOverrun; ++propName) {
+			ReadTapeValue(name);
+			m_PropNames.push_back(&Reader::InternPropName(name));
+		}
+		if (m_TapeOverrun) {
+			return false;
+		}
+		// Keep only the recorded reads, so playback starts from the beginning of the tape
+		m_Tape.erase(m_Tape.begin(), m_Tape.begin() + m_TapePos);
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::vector<std::string> PresetCache::GetModuleIniFiles() const {
+		std::vector<std::string> moduleIniFiles;
+		al_ffblk fileInfo;
+		std::string searchPath = m_ModuleName + "/*.ini";
+		for (int result = al_findfirst(searchPath.c_str(), &fileInfo, FA_ALL); result == 0; result = al_findnext(&fileInfo)) {
+			moduleIniFiles.push_back(fileInfo.name);
+		}
+		al_findclose(&fileInfo);
+
+		std::sort(moduleIniFiles.begin(), moduleIniFiles.end());
+		return moduleIniFiles;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const std::string & PresetCache::GetBuildStamp() {
+		// The executable doesn't change while running, so it only needs hashing once no matter how many DataModules are loaded
+		static const std::string buildStamp = []() {
+			char executablePath[1024];
+			get_executable_name(executablePath, sizeof(executablePath));
+			uint64_t executableSize;
+			uint64_t executableHash;
+			if (!HashFile(executablePath, executableSize, executableHash)) {
+				return std::string();
+			}
+			char stamp[64];
+			sprintf_s(stamp, sizeof(stamp), "%016llx-%016llx", static_cast<unsigned long long>(executableSize), static_cast<unsigned long long>(executableHash));
+			return std::string(stamp);
+		}();
+		return buildStamp;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PresetCache::HashFile(const std::string &filePath, uint64_t &fileSize, uint64_t &fileHash) {
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.good()) {
+			return false;
+		}
+		// 64 bit FNV-1a, it's plenty to tell an edited file apart and much faster than reading the file was in the first place
+		fileSize = 0;
+		fileHash = 14695981039346656037ULL;
+		char buffer[16384];
+		while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+			std::streamsize readSize = file.gcount();
+			for (std::streamsize i = 0; i < readSize; ++i) {
+				fileHash = (fileHash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ULL;
+			}
+			fileSize += static_cast<uint64_t>(readSize);
+		}
+		return !file.bad();
+	}
+}
@@ -0,0 +1,291 @@
+#ifndef _RTEPRESETCACHE_
+#define _RTEPRESETCACHE_
+
+namespace RTE {
+
+	/// <summary>
+	/// A recording of everything the Readers of a DataModule returned while it was loaded from its ini files, saved to disk so the module can be loaded again by playing it back instead of parsing any text.
+	/// The Entities are still made the same way, by their ReadProperty functions, they just get their property names and values handed over already parsed.
+	/// A saved cache is only played back if it was made by this same build of the game, with the same modules loaded before it, and none of the ini files it was made from have changed since.
+	/// </summary>
+	class PresetCache {
+
+	public:
+
+		/// <summary>
+		/// The different things a Reader can be asked to read, recorded along with each read value to make sure they are played back to the same reads they were recorded from.
+		/// </summary>
+		enum ReadType : unsigned char {
+			ReadOpen = 0,
+			ReadNextProperty,
+			ReadDiscardEmptySpace,
+			ReadPropName,
+			ReadPropValue,
+			ReadLine,
+			ReadTo,
+			ReadStatus,
+			ReadBool,
+			ReadChar,
+			ReadUChar,
+			ReadShort,
+			ReadUShort,
+			ReadInt,
+			ReadUInt,
+			ReadLong,
+			ReadULong,
+			ReadFloat,
+			ReadDouble,
+			ReadWord
+		};
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a PresetCache object in system memory. Create() should be called before using the object.
+		/// </summary>
+		PresetCache() { Clear(); }
+
+		/// <summary>
+		/// Makes the PresetCache object ready for use. Loads the saved cache of the DataModule if there is one that's still valid, in which case this is playing back.
+		/// Otherwise this is recording, and Save() should be called once the DataModule has loaded successfully.
+		/// </summary>
+		/// <param name="moduleName">The file name of the DataModule being loaded, eg "Base.rte".</param>
+		/// <param name="indexPath">The path of the ini file the DataModule is being loaded from.</param>
+		/// <param name="loadSavedCache">Whether to play back the saved cache if there's a valid one, or always record a new one.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Create(const std::string &moduleName, const std::string &indexPath, bool loadSavedCache = true);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a PresetCache object before deletion from system memory.
+		/// </summary>
+		~PresetCache() { Destroy(); }
+
+		/// <summary>
+		/// Destroys and resets (through Clear()) the PresetCache object.
+		/// </summary>
+		void Destroy() { Clear(); }
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Shows whether this is playing back a saved cache, or recording a new one.
+		/// </summary>
+		/// <returns>Whether this is playing back a saved cache.</returns>
+		bool IsReplaying() const { return m_Replaying; }
+
+		/// <summary>
+		/// Shows whether playing back the saved cache was given up on because it didn't line up with what was being read. If so, whatever was loaded from it is wrong and the DataModule has to be loaded from its ini files instead.
+		/// </summary>
+		/// <returns>Whether playing back the saved cache failed.</returns>
+		bool HasReplayFailed() const { return m_ReplayFailed; }
+
+		/// <summary>
+		/// Gets the path of the file this cache is saved to and loaded from.
+		/// </summary>
+		/// <returns>The path of the cache file.</returns>
+		const std::string & GetCachePath() const { return m_CachePath; }
+#pragma endregion
+
+#pragma region Recording
+		/// <summary>
+		/// Adds an ini file to the files this cache is made from, so the cache is thrown away if that file changes. Only does anything while recording.
+		/// </summary>
+		/// <param name="filePath">The path of the ini file that was opened.</param>
+		void AddSourceFile(const std::string &filePath);
+
+		/// <summary>
+		/// Records a Reader being opened on a file, which is checked against when playing back.
+		/// </summary>
+		/// <param name="filePath">The path of the file the Reader was opened on.</param>
+		void RecordOpen(const std::string &filePath);
+
+		/// <summary>
+		/// Records a value read by a Reader, along with where in the ini files the Reader was after reading it.
+		/// </summary>
+		/// <param name="readType">The kind of read the value came from.</param>
+		/// <param name="value">The value read.</param>
+		/// <param name="filePath">The file the Reader was in after the read.</param>
+		/// <param name="fileLine">The line the Reader was on after the read.</param>
+		template <typename Type> void Record(ReadType readType, const Type &value, const std::string &filePath, int fileLine) {
+			WriteTapeValue(readType);
+			WriteTapeValue(value);
+			WriteTapePosition(filePath, fileLine);
+		}
+
+		/// <summary>
+		/// Writes the recorded cache out to disk, to be played back next time the DataModule is loaded. Should only be called after the whole DataModule loaded successfully.
+		/// </summary>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Save();
+#pragma endregion
+
+#pragma region Playback
+		/// <summary>
+		/// Plays back a Reader being opened on a file, giving up on the cache if it recorded something else at this point.
+		/// </summary>
+		/// <param name="filePath">The path of the file the Reader is being opened on.</param>
+		void ReplayOpen(const std::string &filePath);
+
+		/// <summary>
+		/// Plays back the next value read, giving up on the cache if it recorded a different kind of read at this point. Once given up on, every value played back is empty.
+		/// </summary>
+		/// <param name="readType">The kind of read being played back.</param>
+		/// <param name="value">Filled out with the value that was read.</param>
+		/// <param name="filePath">Set to the file the Reader was in after the read.</param>
+		/// <param name="fileLine">Set to the line the Reader was on after the read.</param>
+		template <typename Type> void Replay(ReadType readType, Type &value, std::string &filePath, int &fileLine) {
+			ReadType recordedType;
+			ReadTapeValue(recordedType);
+			if (recordedType != readType) { AbandonReplay(); }
+			ReadTapeValue(value);
+			ReadTapePosition(filePath, fileLine);
+		}
+#pragma endregion
+
+	protected:
+
+		/// <summary>
+		/// An ini file a cache was made from, and what it contained at the time.
+		/// </summary>
+		struct SourceFile {
+			std::string m_FilePath; //!< The path of the ini file.
+			uint64_t m_FileSize; //!< The size of the file in bytes.
+			uint64_t m_FileHash; //!< Hash of the whole contents of the file.
+		};
+
+		static const std::string c_CacheDirectory; //!< The directory all the caches are saved in.
+		static const uint32_t c_FormatVersion; //!< The version of the cache file layout, bumped whenever it changes.
+
+		std::string m_ModuleName; //!< The file name of the DataModule this is the cache of.
+		std::string m_CachePath; //!< The path of the file this cache is saved to and loaded from.
+		std::string m_IndexPath; //!< The path of the ini file the DataModule is loaded from.
+		std::vector<std::string> m_LoadedModules; //!< The file names of all the other DataModules that were loaded before this one.
+		bool m_Replaying; //!< Whether this is playing back a saved cache, or recording a new one.
+		bool m_ReplayFailed; //!< Whether playing back the saved cache was given up on partway through.
+
+		std::vector<SourceFile> m_SourceFiles; //!< All the ini files the cache is made from. Only the paths are known while recording, the rest is filled in when saving.
+		std::unordered_map<std::string, uint32_t> m_SourceFileIndices; //!< The index of each ini file in m_SourceFiles, by path.
+		std::vector<const std::string *> m_PropNames; //!< All the property names read, interned. Recorded by index.
+		std::unordered_map<const std::string *, uint32_t> m_PropNameIndices; //!< The index of each property name in m_PropNames.
+
+		std::vector<char> m_Tape; //!< Every read value in order, along with the kind of read and the position in the files after it.
+		size_t m_TapePos; //!< Where in m_Tape the next value is played back from.
+		bool m_TapeOverrun; //!< Whether anything was read past the end of the tape, meaning the cache file is broken or playing it back was given up on.
+		uint32_t m_LastFileIndex; //!< The index of the file the last played back value was read in, so the Reader's file path is only set when it changes.
+
+#pragma region Tape Handling
+		/// <summary>
+		/// Appends a plain value to the tape, as is.
+		/// </summary>
+		/// <param name="value">The value to append.</param>
+		template <typename Type> void WriteTapeValue(const Type &value) {
+			const char *valueBytes = reinterpret_cast<const char *>(&value);
+			m_Tape.insert(m_Tape.end(), valueBytes, valueBytes + sizeof(Type));
+		}
+
+		/// <summary>
+		/// Appends a string to the tape, as its length followed by its characters.
+		/// </summary>
+		/// <param name="value">The string to append.</param>
+		void WriteTapeValue(const std::string &value);
+
+		/// <summary>
+		/// Appends an interned property name to the tape, as its index in m_PropNames.
+		/// </summary>
+		/// <param name="value">The interned property name to append.</param>
+		void WriteTapeValue(const std::string * const &value);
+
+		/// <summary>
+		/// Appends the position in the files after a read to the tape.
+		/// </summary>
+		/// <param name="filePath">The file the Reader was in.</param>
+		/// <param name="fileLine">The line the Reader was on.</param>
+		void WriteTapePosition(const std::string &filePath, int fileLine);
+
+		/// <summary>
+		/// Reads a plain value from the tape, handling it through TapeOverrun() if the tape runs out.
+		/// </summary>
+		/// <param name="value">Filled out with the read value.</param>
+		template <typename Type> void ReadTapeValue(Type &value) {
+			if (m_TapePos + sizeof(Type) > m_Tape.size()) {
+				TapeOverrun();
+				value = Type();
+				return;
+			}
+			std::memcpy(&value, &m_Tape[m_TapePos], sizeof(Type));
+			m_TapePos += sizeof(Type);
+		}
+
+		/// <summary>
+		/// Reads a string from the tape, handling it through TapeOverrun() if the tape runs out.
+		/// </summary>
+		/// <param name="value">Filled out with the read string.</param>
+		void ReadTapeValue(std::string &value);
+
+		/// <summary>
+		/// Reads an interned property name from the tape, handling it through TapeOverrun() if the tape runs out or the name doesn't exist.
+		/// </summary>
+		/// <param name="value">Set to the interned property name.</param>
+		void ReadTapeValue(const std::string *&value);
+
+		/// <summary>
+		/// Reads the position in the files after a read from the tape.
+		/// </summary>
+		/// <param name="filePath">Set to the file the Reader was in, if it's changed since the last read.</param>
+		/// <param name="fileLine">Set to the line the Reader was on.</param>
+		void ReadTapePosition(std::string &filePath, int &fileLine);
+
+		/// <summary>
+		/// Handles reading past the end of the tape. While loading the cache file this just marks the file as broken, while playing back it gives up on the cache.
+		/// </summary>
+		void TapeOverrun();
+
+		/// <summary>
+		/// Deletes the saved cache and stops playing it back, for when it doesn't line up with what's being read. The rest of the tape is skipped so the Readers run out of data and the DataModule finishes loading quickly, to then be loaded again from its ini files.
+		/// </summary>
+		void AbandonReplay();
+#pragma endregion
+
+#pragma region Validation
+		/// <summary>
+		/// Loads the saved cache file and checks that it's still valid, ie made by this build, with the same other modules loaded and from the same ini files as now.
+		/// </summary>
+		/// <returns>Whether the cache was loaded and can be played back.</returns>
+		bool LoadCacheFile();
+
+		/// <summary>
+		/// Gets the names of all the ini files directly inside the DataModule's directory, in case the DataModule scans its folder contents for them.
+		/// </summary>
+		/// <returns>The file names of all the ini files, sorted.</returns>
+		std::vector<std::string> GetModuleIniFiles() const;
+
+		/// <summary>
+		/// Gets what identifies the build of the game, since the recorded reads depend on how each Entity reads itself. It's made from the size and hash of the whole executable, so any change to the code makes a new one.
+		/// </summary>
+		/// <returns>The build stamp, or an empty string if the executable couldn't be read, in which case no cache can be trusted.</returns>
+		static const std::string & GetBuildStamp();
+
+		/// <summary>
+		/// Reads a whole file and hashes its contents.
+		/// </summary>
+		/// <param name="filePath">The path of the file to hash.</param>
+		/// <param name="fileSize">Set to the size of the file in bytes.</param>
+		/// <param name="fileHash">Set to the hash of the file's contents.</param>
+		/// <returns>Whether the file could be read.</returns>
+		static bool HashFile(const std::string &filePath, uint64_t &fileSize, uint64_t &fileHash);
+#pragma endregion
+
+	private:
+
+		/// <summary>
+		/// Clears all the member variables of this PresetCache, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		PresetCache(const PresetCache &reference);
+		PresetCache & operator=(const PresetCache &rhs);
+	};
+}
+#endif
@@ -3,17 +3,39 @@
 
 namespace RTE {
 
+	static thread_local bool s_UseThreadLocalRand = false;
+	static thread_local unsigned int s_ThreadLocalRandState = 1;
+
+	/// <summary>
+	/// Gets the next number from the calling thread's generator if it has one set up, or from the shared one otherwise.
+	/// </summary>
+	/// <returns>Random number between 0 and RAND_MAX.</returns>
+	static int NextRand() {
+		if (!s_UseThreadLocalRand) {
+			return rand();
+		}
+		// Xorshift32, plenty for gameplay randomness and cheap enough to call per particle
+		s_ThreadLocalRandState ^= s_ThreadLocalRandState << 13;
+		s_ThreadLocalRandState ^= s_ThreadLocalRandState >> 17;
+		s_ThreadLocalRandState ^= s_ThreadLocalRandState << 5;
+		return static_cast<int>(s_ThreadLocalRandState % (static_cast<unsigned int>(RAND_MAX) + 1));
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void SeedRand() { srand(time(0)); }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	double PosRand() { return (rand() / (RAND_MAX / 1000 + 1)) / 1000.0; }
+	void SeedRand(unsigned int seed) { srand(seed); }
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	double PosRand() { return (NextRand() / (RAND_MAX / 1000 + 1)) / 1000.0; }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	double NormalRand() { return (static_cast<double>(rand()) / (RAND_MAX / 2)) - 1.0; }
+	double NormalRand() { return (static_cast<double>(NextRand()) / (RAND_MAX / 2)) - 1.0; }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -23,6 +45,23 @@ namespace RTE {
 
 	int SelectRand(int min, int max) { return min + static_cast<int>((max - min) * PosRand() + 0.5); }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SeedThreadLocalRand(unsigned int seed) {
+		// Scramble the seed so consecutive seeds don't give similar sequences, and avoid the all-zero state xorshift gets stuck in
+		seed = (seed ^ 61) ^ (seed >> 16);
+		seed *= 9;
+		seed ^= seed >> 4;
+		seed *= 0x27D4EB2D;
+		seed ^= seed >> 15;
+		s_ThreadLocalRandState = seed ? seed : 1;
+		s_UseThreadLocalRand = true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ClearThreadLocalRand() { s_UseThreadLocalRand = false; }
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	float LERP(float xStart, float xEnd, float yStart, float yEnd, float progressScalar) {
@@ -173,4 +212,23 @@ namespace RTE {
 		pFile = 0;
 		return false;
 	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string EscapeJSONString(const std::string &text) {
+		std::string escaped;
+		for (const char &character : text) {
+			if (character == '"' || character == '\\') {
+				escaped += '\\';
+				escaped += character;
+			} else if (static_cast<unsigned char>(character) < 0x20) {
+				char unicodeEscape[8];
+				std::snprintf(unicodeEscape, sizeof(unicodeEscape), "\\u%04x", static_cast<unsigned char>(character));
+				escaped += unicodeEscape;
+			} else {
+				escaped += character;
+			}
+		}
+		return escaped;
+	}
 }
\ No newline at end of file
@@ -16,6 +16,12 @@ namespace RTE {
 	/// </summary>
 	void SeedRand();
 
+	/// <summary>
+	/// Seeds the rand with a specific seed, so the sequence of random numbers can be repeated.
+	/// </summary>
+	/// <param name="seed">The seed to use.</param>
+	void SeedRand(unsigned int seed);
+
 	/// <summary>
 	/// A good rand function that return a float between 0.0 and 0.999.
 	/// </summary>
@@ -43,6 +49,18 @@ namespace RTE {
 	/// <param name="max">Maximum value this can return.</param>
 	/// <returns>Random number between limits.</returns>
 	int SelectRand(int min, int max);
+
+	/// <summary>
+	/// Makes the random functions above use a generator local to the calling thread instead of the shared one, seeded with the given value.
+	/// Used by parallel jobs so their results don't depend on which thread ran what, or in which order.
+	/// </summary>
+	/// <param name="seed">The seed for this thread's generator.</param>
+	void SeedThreadLocalRand(unsigned int seed);
+
+	/// <summary>
+	/// Makes the random functions go back to using the shared generator on the calling thread.
+	/// </summary>
+	void ClearThreadLocalRand();
 #pragma endregion
 
 #pragma region Interpolation
@@ -142,6 +160,13 @@ namespace RTE {
 	/// <param name="">The exact string to look for. Case sensitive!</param>
 	/// <returns>Whether the file was found AND that string was found in that file.</returns>
 	bool ASCIIFileContainsString(std::string filePath, std::string findString);
+
+	/// <summary>
+	/// Escapes a string so it can be written between quotes in a JSON file.
+	/// </summary>
+	/// <param name="text">The string to escape.</param>
+	/// <returns>The escaped string.</returns>
+	std::string EscapeJSONString(const std::string &text);
 #pragma endregion
 }
 #endif
\ No newline at end of file
@@ -6,6 +6,49 @@ namespace RTE {
 
 	const std::string Reader::m_ClassName = "Reader";
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const std::string & Reader::InternPropName(const std::string &propName) {
+		static std::mutex s_PropNamesMutex;
+		static std::unordered_set<std::string> s_PropNames;
+
+		std::lock_guard<std::mutex> propNamesLock(s_PropNamesMutex);
+		std::unordered_set<std::string>::const_iterator nameItr = s_PropNames.find(propName);
+		return nameItr != s_PropNames.end() ? *nameItr : *s_PropNames.insert(propName).first;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Reader::FileStream::FileStream(const std::string &filePath) : std::istream(0) {
+		rdbuf(&m_Buffer);
+
+		// The file might've been read in ahead already while loading the DataModules
+		bool readOK = g_PresetMan.TakePrefetchedFile(filePath, m_Data);
+		if (!readOK) {
+			std::ifstream file(filePath.c_str(), std::ios::binary);
+			if (file.good()) {
+				file.seekg(0, std::ios::end);
+				std::streamoff fileSize = file.tellg();
+				file.seekg(0, std::ios::beg);
+				if (fileSize > 0) {
+					m_Data.resize(static_cast<size_t>(fileSize));
+					file.read(&m_Data[0], fileSize);
+					m_Data.resize(static_cast<size_t>(file.gcount()));
+				}
+			}
+			readOK = file.good() || file.eof();
+		}
+		// Drop the carriage returns of CRLF line endings, so the contents are the same as if the file was read in text mode
+		std::vector<char>::iterator lastKept = m_Data.begin();
+		for (std::vector<char>::const_iterator charItr = m_Data.begin(); charItr != m_Data.end(); ++charItr) {
+			if (*charItr != '\r' || charItr + 1 == m_Data.end() || *(charItr + 1) != '\n') { *(lastKept++) = *charItr; }
+		}
+		m_Data.erase(lastKept, m_Data.end());
+
+		m_Buffer.SetData(m_Data.data(), m_Data.data() + m_Data.size());
+		if (!readOK) { setstate(std::ios::failbit); }
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void Reader::Clear() {
@@ -16,6 +59,9 @@ namespace RTE {
 		m_PreviousIndent = 0;
 		m_IndentDifference = 0;
 		m_ObjectEndings = 0;
+		m_PropNameBuffer.clear();
+		m_pPresetCache = 0;
+		m_PresetCacheDepth = 0;
 		m_EndOfStreams = false;
 		m_fpReportProgress = 0;
 		m_ReportTabs = "\t";
@@ -46,11 +92,23 @@ namespace RTE {
 		m_DataModuleName = m_FilePath.substr(0, firstSlashPos);
 		m_DataModuleID = g_PresetMan.GetModuleID(m_DataModuleName);
 
-		m_pStream = new std::ifstream(fileName);
-		if (!failOK) { RTEAssert(m_pStream->good(), "Failed to open data file \'" + std::string(fileName) + "\'!"); }
-
 		m_OverwriteExisting = overwrites;
 
+		// Nothing is read from the file itself when playing back a PresetCache, just make sure it's the same file that was recorded
+		if (m_pPresetCache && m_pPresetCache->IsReplaying()) {
+			m_pPresetCache->ReplayOpen(m_FilePath);
+			m_fpReportProgress = fpProgressCallback;
+			if (m_fpReportProgress) {
+				char report[512];
+				sprintf_s(report, sizeof(report), "\t%s from the preset cache", m_FileName.c_str());
+				m_fpReportProgress(std::string(report), true);
+			}
+			return 0;
+		}
+		m_pStream = new FileStream(m_FilePath);
+		if (!failOK) { RTEAssert(m_pStream->good(), "Failed to open data file \'" + std::string(fileName) + "\'!"); }
+		if (m_pPresetCache) { m_pPresetCache->RecordOpen(m_FilePath); }
+
 		// Report that we're starting a new file
 		m_fpReportProgress = fpProgressCallback;
 		if (m_fpReportProgress && m_pStream->good()) {
@@ -79,85 +137,209 @@ namespace RTE {
 		return m_DataModuleID < 0 ? g_PresetMan.GetModuleID(m_DataModuleName) : m_DataModuleID;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template <typename Type, typename ReadFunction> Type Reader::CacheRead(PresetCache::ReadType readType, const ReadFunction &readFunction) {
+		if (!m_pPresetCache) {
+			return readFunction();
+		}
+		if (m_pPresetCache->IsReplaying()) {
+			Type value;
+			m_pPresetCache->Replay(readType, value, m_FilePath, m_CurrentLine);
+			return value;
+		}
+		// Reads are made of other reads, eg ReadPropName discards empty space first, but only what the caller asked for is recorded since that's all that's played back
+		++m_PresetCacheDepth;
+		Type value = readFunction();
+		--m_PresetCacheDepth;
+		if (m_PresetCacheDepth == 0) { m_pPresetCache->Record(readType, value, m_FilePath, m_CurrentLine); }
+		return value;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void Reader::ReadLine(char *locString, int size) {
+		std::string line = CacheRead<std::string>(PresetCache::ReadLine, [this, locString, size]() { ReadLineFromFile(locString, size); return std::string(locString); });
+		// The line is only in place already when it was read from the files, so copy it over for when it was played back
+		if (size > 0) {
+			int length = std::min(static_cast<int>(line.size()), size - 1);
+			std::memcpy(locString, line.c_str(), length);
+			locString[length] = '\0';
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string Reader::ReadLine() {
+		return CacheRead<std::string>(PresetCache::ReadLine, [this]() { return ReadLineFromFile(); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool Reader::DiscardEmptySpace() {
+		return CacheRead<bool>(PresetCache::ReadDiscardEmptySpace, [this]() { return DiscardEmptySpaceFromFile(); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string Reader::ReadTo(char terminator, bool discardTerminator) {
+		return CacheRead<std::string>(PresetCache::ReadTo, [this, terminator, discardTerminator]() { return ReadToFromFile(terminator, discardTerminator); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const std::string & Reader::ReadPropName() {
+		return *CacheRead<const std::string *>(PresetCache::ReadPropName, [this]() { return &ReadPropNameFromFile(); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::string Reader::ReadPropValue() {
+		return CacheRead<std::string>(PresetCache::ReadPropValue, [this]() { return ReadPropValueFromFile(); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool Reader::NextProperty() {
+		return CacheRead<bool>(PresetCache::ReadNextProperty, [this]() { return NextPropertyFromFile(); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool Reader::IsOK() {
+		return CacheRead<bool>(PresetCache::ReadStatus, [this]() { return m_pStream && m_pStream->good(); });
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Reader & Reader::operator>>(bool &var) {
+		var = CacheRead<bool>(PresetCache::ReadBool, [this, &var]() { bool value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(char &var) {
+		var = CacheRead<char>(PresetCache::ReadChar, [this, &var]() { char value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(unsigned char &var) {
+		var = CacheRead<unsigned char>(PresetCache::ReadUChar, [this, &var]() { int value = var; DiscardEmptySpace(); *m_pStream >> value; return static_cast<unsigned char>(value); });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(short &var) {
+		var = CacheRead<short>(PresetCache::ReadShort, [this, &var]() { short value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(unsigned short &var) {
+		var = CacheRead<unsigned short>(PresetCache::ReadUShort, [this, &var]() { unsigned short value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(int &var) {
+		var = CacheRead<int>(PresetCache::ReadInt, [this, &var]() { int value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(unsigned int &var) {
+		var = CacheRead<unsigned int>(PresetCache::ReadUInt, [this, &var]() { unsigned int value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(long &var) {
+		var = CacheRead<long>(PresetCache::ReadLong, [this, &var]() { long value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(unsigned long &var) {
+		var = CacheRead<unsigned long>(PresetCache::ReadULong, [this, &var]() { unsigned long value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(float &var) {
+		var = CacheRead<float>(PresetCache::ReadFloat, [this, &var]() { float value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(double &var) {
+		var = CacheRead<double>(PresetCache::ReadDouble, [this, &var]() { double value = var; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		return *this;
+	}
+
+	Reader & Reader::operator>>(char * var) {
+		std::string word = CacheRead<std::string>(PresetCache::ReadWord, [this]() { std::string value; DiscardEmptySpace(); *m_pStream >> value; return value; });
+		std::strcpy(var, word.c_str());
+		return *this;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Reader::ReadLineFromFile(char *locString, int size) {
 		DiscardEmptySpace();
 
-		char temp;
-		char peek = m_pStream->peek();
+		const char *pos = m_pStream->GetPos();
+		const char *end = m_pStream->GetEnd();
 		int i = 0;
 
-		for (i = 0; i < size - 1 && peek != '\n' && peek != '\r' && peek != '\t'; ++i) {
-			temp = m_pStream->get();
-			// Check for line comment "//"
-			if (peek == '/' && m_pStream->peek() == '/') {
-				m_pStream->putback(temp);
+		for (i = 0; i < size - 1; ++i) {
+			if (pos == end) {
+				m_pStream->SetPos(pos);
+				m_pStream->setstate(std::ios::eofbit | std::ios::failbit);
+				EndIncludeFile();
 				break;
 			}
-			if (m_pStream->eof()) {
-				EndIncludeFile();
+			// Stop at the end of the line, or at a line comment "//"
+			if (*pos == '\n' || *pos == '\r' || *pos == '\t' || (*pos == '/' && pos + 1 != end && *(pos + 1) == '/')) {
+				m_pStream->SetPos(pos);
 				break;
 			}
-			if (!m_pStream->good()) { ReportError("Stream failed for some reason"); }
-
-			locString[i] = temp;
-			peek = m_pStream->peek();
+			locString[i] = *(pos++);
 		}
+		if (i == size - 1) { m_pStream->SetPos(pos); }
 		locString[i] = '\0';
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	std::string Reader::ReadLine() {
+	std::string Reader::ReadLineFromFile() {
 		DiscardEmptySpace();
 
-		std::string retString;
-		char temp;
-		char peek = m_pStream->peek();
+		const char *start = m_pStream->GetPos();
+		const char *end = m_pStream->GetEnd();
+		const char *pos = start;
 
-		while (peek != '\n' && peek != '\r' && peek != '\t') {
-			temp = m_pStream->get();
-
-			// Check for line comment "//"
-			if (peek == '/' && m_pStream->peek() == '/') {
-				m_pStream->unget();
-				break;
-			}
-
-			if (m_pStream->eof()) { break; }
-			if (!m_pStream->good()) { ReportError("Stream failed for some reason"); }
-
-			retString.append(1, temp);
-			peek = m_pStream->peek();
+		// Read up to the end of the line, or to a line comment "//"
+		while (pos != end && *pos != '\n' && *pos != '\r' && *pos != '\t' && !(*pos == '/' && pos + 1 != end && *(pos + 1) == '/')) {
+			++pos;
 		}
-		return retString;
+		m_pStream->SetPos(pos);
+		if (pos == end) { m_pStream->setstate(std::ios::eofbit | std::ios::failbit); }
+
+		return std::string(start, pos);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	std::string Reader::ReadTo(char terminator, bool discardTerminator) {
-		std::string retString;
-		char temp;
-		char peek = m_pStream->peek();
-
-		while (peek != terminator) {
-			temp = m_pStream->get();
-
-			if (m_pStream->eof()) { break; }
-			if (!m_pStream->good()) { ReportError("Stream failed for some reason"); }
-
-			retString.append(1, temp);
-			peek = m_pStream->peek();
+	std::string Reader::ReadToFromFile(char terminator, bool discardTerminator) {
+		const char *start = m_pStream->GetPos();
+		const char *end = m_pStream->GetEnd();
+		const char *pos = std::find(start, end, terminator);
+
+		std::string retString(start, pos);
+		if (pos == end) {
+			m_pStream->setstate(std::ios::eofbit | std::ios::failbit);
+		} else if (discardTerminator) {
+			// Discard the terminator if instructed to
+			++pos;
 		}
-		// Discard the terminator if instructed to
-		if (discardTerminator && peek == terminator) { m_pStream->get(); }
+		m_pStream->SetPos(pos);
 		return retString;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool Reader::NextProperty() {
+	bool Reader::NextPropertyFromFile() {
 		if (!DiscardEmptySpace() || m_EndOfStreams) {
 			return false;
 		}
@@ -173,53 +355,56 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	std::string Reader::ReadPropName() {
+	const std::string & Reader::ReadPropNameFromFile() {
 		DiscardEmptySpace();
 
-		std::string retString;
-		char temp;
-		char peek;
+		const char *start = m_pStream->GetPos();
+		const char *end = m_pStream->GetEnd();
+		const char *pos = start;
 
-		while (true) {
-			peek = m_pStream->peek();
-			if (peek == '=') {
-				m_pStream->ignore(1);
-				break;
-			}
-			if (peek == '\n' || peek == '\r' || peek == '\t') {
+		while (pos != end && *pos != '=') {
+			if (*pos == '\n' || *pos == '\r' || *pos == '\t') {
+				m_pStream->SetPos(pos);
 				ReportError("Property name wasn't followed by a value");
 			}
-			temp = m_pStream->get();
-			if (m_pStream->eof()) {
-				EndIncludeFile();
-				break;
-			}
-			if (!m_pStream->good()) { ReportError("Stream failed for some reason"); }
-			retString.append(1, temp);
+			++pos;
 		}
-		// Trim the string of whitespace
-		retString = TrimString(retString);
-		
+		// Trim the name of whitespace
+		const char *nameStart = start;
+		const char *nameEnd = pos;
+		while (nameStart != nameEnd && *nameStart == ' ') { ++nameStart; }
+		while (nameEnd != nameStart && *(nameEnd - 1) == ' ') { --nameEnd; }
+		m_PropNameBuffer.assign(nameStart, nameEnd);
+
+		// The name is copied out now, so it's safe to move on to the parent file if this one ended
+		if (pos == end) {
+			m_pStream->SetPos(pos);
+			m_pStream->setstate(std::ios::eofbit | std::ios::failbit);
+			EndIncludeFile();
+		} else {
+			m_pStream->SetPos(pos + 1);
+		}
+
 		// If the property name turns out to be the special IncludeFile,and we're not skipping include files then open that file and read the first property from it instead.
-		if (retString == "IncludeFile") {
+		if (m_PropNameBuffer == "IncludeFile") {
 			if (m_SkipIncludes) {
 				// Discard IncludeFile value
 				std::string val = ReadPropValue();
 				DiscardEmptySpace();
-				retString = ReadPropName();
+				return ReadPropName();
 			} else {
 				StartIncludeFile();
 				// Return the first property name in the new file, this is to make the file inclusion seamless.
 				// Alternatively, if StartIncludeFile failed, this will just grab the next prop name and ignore the failed IncludeFile property.
-				retString = ReadPropName();
+				return ReadPropName();
 			}
 		}
-		return retString;
+		return InternPropName(m_PropNameBuffer);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	std::string Reader::ReadPropValue() {
+	std::string Reader::ReadPropValueFromFile() {
 		std::string fullLine = ReadLine();
 		int begin = fullLine.find_first_of('=');
 		std::string subStr = (begin == std::string::npos ? fullLine : fullLine.substr(begin + 1));
@@ -228,72 +413,74 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool Reader::DiscardEmptySpace() {
-		char peek;
+	bool Reader::DiscardEmptySpaceFromFile() {
 		int indent = 0;
 		bool ateLine = false;
 		char report[512];
 
-		while (true) {
-			peek = m_pStream->peek();
+		// If we're at the end already and don't have any files to resume, then quit and indicate that
+		if (m_pStream->eof()) {
+			return EndIncludeFile();
+		}
+		// Not end-of-file but the stream still failed... something went to shit
+		if (m_pStream->fail()) { ReportError("Something went wrong reading the line; make sure it is providing the expected type"); }
+
+		const char *pos = m_pStream->GetPos();
+		const char *end = m_pStream->GetEnd();
 
+		while (true) {
 			// If we have hit the end and don't have any files to resume, then quit and indicate that
-			if (m_pStream->eof()) {
+			if (pos == end) {
+				m_pStream->SetPos(pos);
+				m_pStream->setstate(std::ios::eofbit);
 				return EndIncludeFile();
 			}
-			// Not end-of-file but still got junk back... something went to shit
-			if (peek == -1) { ReportError("Something went wrong reading the line; make sure it is providing the expected type"); }
 
 			// Discard spaces
-			if (peek == ' ') {
-				m_pStream->ignore(1);
+			if (*pos == ' ') {
+				++pos;
 			// Discard tabs, and count them
-			} else if (peek == '\t') {
+			} else if (*pos == '\t') {
 				indent++;
-				m_pStream->ignore(1);
+				++pos;
 			// Discard newlines and reset the tab count for the new line, also count the lines
-			} else if (peek == '\n' || peek == '\r') {
+			} else if (*pos == '\n' || *pos == '\r') {
 				// So we don't count lines twice when there are both newline and carriage return at the end of lines
-				if (peek == '\n') {
+				if (*pos == '\n') {
 					m_CurrentLine++;
 					// Only report every few lines
 					if (m_fpReportProgress && (m_CurrentLine % 100 == 0)) {
-						//char report[512];
 						sprintf_s(report, sizeof(report), "%s%s reading line %i", m_ReportTabs.c_str(), m_FileName.c_str(), m_CurrentLine);
 						m_fpReportProgress(std::string(report), false);
 					}
 				}
 				indent = 0;
 				ateLine = true;
-				m_pStream->ignore(1);
+				++pos;
 
 			// Comment line?
-			} else if (m_pStream->peek() == '/') {
-				char temp = m_pStream->get();
-				char temp2;
-
-				// Confirm that it's a comment line, if so discard it and continue
-				if (m_pStream->peek() == '/') {
-					while (m_pStream->peek() != '\n' && m_pStream->peek() != '\r' && !m_pStream->eof()) { m_pStream->ignore(1); }
+			} else if (*pos == '/' && pos + 1 != end && (*(pos + 1) == '/' || *(pos + 1) == '*')) {
+				// Line comment, discard up to the end of the line and continue
+				if (*(pos + 1) == '/') {
+					while (pos != end && *pos != '\n' && *pos != '\r') { ++pos; }
 				// Block comment
-				} else if (m_pStream->peek() == '*') {
-					// Find the matching "*/"
-					while (!((temp2 = m_pStream->get()) == '*' && m_pStream->peek() == '/') && !m_pStream->eof()) {
-						// Count the lines within the comment though
-						if (temp2 == '\n') { ++m_CurrentLine; }
-					}
-					// Discard that final '/'
-					if (!m_pStream->eof()) { m_pStream->ignore(1); }
-
-				// Not a comment, so it's data, so quit.
 				} else {
-					m_pStream->putback(temp);
-					break;
+					// Find the matching "*/", counting the lines within the comment though
+					for (++pos; pos != end; ++pos) {
+						if (*pos == '*' && pos + 1 != end && *(pos + 1) == '/') {
+							// Discard that final '/'
+							pos += 2;
+							break;
+						}
+						if (*pos == '\n') { ++m_CurrentLine; }
+					}
 				}
-			} else { 
+			// Not a comment, so it's data, so quit.
+			} else {
 				break;
 			}
 		}
+		m_pStream->SetPos(pos);
 
 		// This precaution enables us to use DiscardEmptySpace repeatedly without messing up the indentation tracking logic
 		if (ateLine) {
@@ -325,6 +512,10 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void Reader::ReportError(std::string errorDesc) {
+		// Everything read after a PresetCache was given up on is empty and gets read again from the ini files, so it's expected to not make sense
+		if (IsPresetCacheAbandoned()) {
+			return;
+		}
 		char error[1024];
 		sprintf_s(error, sizeof(error), "%s Error happened in %s at line %i!", errorDesc.c_str(), m_FilePath.c_str(), m_CurrentLine);
 		RTEAbort(error);
@@ -344,7 +535,8 @@ namespace RTE {
 
 		// Get the file path from the stream
 		m_FilePath = ReadPropValue();
-		m_pStream = new std::ifstream(m_FilePath.c_str());
+		m_pStream = new FileStream(m_FilePath);
+		if (m_pPresetCache) { m_pPresetCache->AddSourceFile(m_FilePath); }
 		if (m_pStream->fail()) {
 			// Backpedal and set up to read the next property in the old stream
 			delete m_pStream;
@@ -1,12 +1,14 @@
 #ifndef _RTEREADER_
 #define _RTEREADER_
 
+#include "PresetCache.h"
+
 namespace RTE {
 
 	typedef std::function<void(std::string, bool)> ProgressCallback; //!< Convenient name definition for the progress report callback function.
 
 	/// <summary>
-	/// Reads RTE objects from std::istreams.
+	/// Reads RTE objects from files. Each file is read into memory in one go when opened, and scanned straight out of memory from then on.
 	/// </summary>
 	class Reader {
 
@@ -75,7 +77,7 @@ namespace RTE {
 		/// <summary>
 		/// Gets a pointer to the istream of this reader.
 		/// </summary>
-		/// <returns>A pointer to the istream object for this reader.</returns>
+		/// <returns>A pointer to the istream object for this reader. 0 if this is playing back a PresetCache, since there are no files open then.</returns>
 		std::istream * GetStream() { return m_pStream; }
 
 		/// <summary>
@@ -119,6 +121,19 @@ namespace RTE {
 		/// </summary>
 		/// <param name="skip>To make reader skip included files pass true, pass false otherwise.</param>
 		void SetSkipIncludes(bool skip) { m_SkipIncludes = skip; };
+
+		/// <summary>
+		/// Sets the PresetCache this records everything it reads to, or plays back everything it reads from instead of reading any files, depending on which the PresetCache is doing.
+		/// Has to be set before Create() is called, and the PresetCache has to outlive this.
+		/// </summary>
+		/// <param name="presetCache">The PresetCache to use, or 0 to just read the files. Ownership is NOT transferred!</param>
+		void SetPresetCache(PresetCache *presetCache) { m_pPresetCache = presetCache; }
+
+		/// <summary>
+		/// Shows whether the PresetCache this is playing back was given up on. Everything read since is empty, and the DataModule gets read again from its ini files, so whatever is made from it should be thrown away without complaint.
+		/// </summary>
+		/// <returns>Whether the PresetCache this is playing back was given up on.</returns>
+		bool IsPresetCacheAbandoned() const { return m_pPresetCache && m_pPresetCache->HasReplayFailed(); }
 #pragma endregion
 
 #pragma region Reading Operations
@@ -152,9 +167,10 @@ namespace RTE {
 		/// <summary>
 		/// Reads the next property name from the context object Reader's stream after eating all whitespace including newlines up till the first newline char.
 		/// Basically gets anything between the last newline before text to the next "=" after that.
+		/// Property names are interned, so the same name read anywhere, by any Reader, is always the same string.
 		/// </summary>
-		/// <returns>The whitespace-trimmed std::string that will hold the next property's name.</returns>
-		std::string ReadPropName();
+		/// <returns>The whitespace-trimmed interned std::string of the next property's name. It stays valid for as long as the program runs.</returns>
+		const std::string & ReadPropName();
 
 		/// <summary>
 		/// Reads the next property value from the context object Reader's stream after eating all whitespace including newlines up till the first newline char.
@@ -163,6 +179,14 @@ namespace RTE {
 		/// <returns>The whitespace-trimmed std::string that will hold the next property value.</returns>
 		std::string ReadPropValue();
 
+		/// <summary>
+		/// Gets the interned copy of a property name, adding it the first time it's seen.
+		/// Interned names are never removed or moved, so references to them stay valid for as long as the program runs. Thread safe.
+		/// </summary>
+		/// <param name="propName">The property name to intern.</param>
+		/// <returns>The interned copy of the property name.</returns>
+		static const std::string & InternPropName(const std::string &propName);
+
 		/// <summary>
 		/// Takes out whitespace from the beginning and the end of a string.
 		/// </summary>
@@ -182,10 +206,11 @@ namespace RTE {
 		/// Shows whether this is still OK to read from. If file isn't present, etc, this will return false.
 		/// </summary>
 		/// <returns>Whether this Reader's stream is OK or not.</returns>
-		bool IsOK() { return m_pStream && m_pStream->good(); }
+		bool IsOK();
 
 		/// <summary>
 		/// Makes an error message box pop up for the user that tells them something went wrong with the reading, and where.
+		/// Does nothing while playing back a PresetCache that was given up on, since the DataModule gets read again from its ini files anyway.
 		/// </summary>
 		/// <param name="errorDesc">The message describing what's wrong.</param>
 		void ReportError(std::string errorDesc);
@@ -197,18 +222,18 @@ namespace RTE {
 		/// </summary>
 		/// <param name="var">A reference to the variable that will be filled by the extracted data.</param>
 		/// <returns>A Reader reference for further use in an expression.</returns>
-		virtual Reader & operator>>(bool &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(char &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(unsigned char &var) { DiscardEmptySpace(); int temp; *m_pStream >> temp; var = temp; return *this; }
-		virtual Reader & operator>>(short &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(unsigned short &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(int &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(unsigned int &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(long &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(unsigned long &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(float &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(double &var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
-		virtual Reader & operator>>(char * var) { DiscardEmptySpace(); *m_pStream >> var; return *this; }
+		virtual Reader & operator>>(bool &var);
+		virtual Reader & operator>>(char &var);
+		virtual Reader & operator>>(unsigned char &var);
+		virtual Reader & operator>>(short &var);
+		virtual Reader & operator>>(unsigned short &var);
+		virtual Reader & operator>>(int &var);
+		virtual Reader & operator>>(unsigned int &var);
+		virtual Reader & operator>>(long &var);
+		virtual Reader & operator>>(unsigned long &var);
+		virtual Reader & operator>>(float &var);
+		virtual Reader & operator>>(double &var);
+		virtual Reader & operator>>(char * var);
 		virtual Reader & operator>>(std::string &var) { var.assign(ReadLine()); return *this; }
 #pragma endregion
 
@@ -222,16 +247,70 @@ namespace RTE {
 
 	protected:
 
+		/// <summary>
+		/// An input stream over the whole contents of a file, which is read into memory in one go when the stream is made.
+		/// Carriage returns before newlines are dropped on the way in, same as reading the file in text mode would.
+		/// The Reader scans the memory directly for all the text parsing, and only goes through the stream itself for extracting formatted values.
+		/// </summary>
+		class FileStream : public std::istream {
+
+		public:
+
+			/// <summary>
+			/// Constructor method used to instantiate a FileStream object in system memory, reading in the whole file. If the file couldn't be read, the stream is left failed.
+			/// </summary>
+			/// <param name="filePath">Path to the file to read.</param>
+			explicit FileStream(const std::string &filePath);
+
+			/// <summary>
+			/// Gets the position of the next character to be read.
+			/// </summary>
+			/// <returns>A pointer to the next character to be read. Equal to GetEnd() if there is nothing more to read.</returns>
+			const char * GetPos() const { return m_Buffer.GetPos(); }
+
+			/// <summary>
+			/// Gets the end of the file contents.
+			/// </summary>
+			/// <returns>A pointer to one past the last character of the file.</returns>
+			const char * GetEnd() const { return m_Buffer.GetEnd(); }
+
+			/// <summary>
+			/// Moves the position of the next character to be read.
+			/// </summary>
+			/// <param name="newPos">The new position. Has to be between GetPos() and GetEnd().</param>
+			void SetPos(const char *newPos) { m_Buffer.SetPos(newPos); }
+
+		private:
+
+			/// <summary>
+			/// A stream buffer reading straight from a block of memory, with its read position exposed.
+			/// </summary>
+			class MemoryBuffer : public std::streambuf {
+			public:
+				void SetData(char *begin, char *end) { setg(begin, begin, end); }
+				const char * GetPos() const { return gptr(); }
+				const char * GetEnd() const { return egptr(); }
+				void SetPos(const char *newPos) { setg(eback(), eback() + (newPos - eback()), egptr()); }
+			};
+
+			std::vector<char> m_Data; //!< The whole contents of the file.
+			MemoryBuffer m_Buffer; //!< The stream buffer reading from m_Data.
+
+			// Disallow the use of some implicit methods.
+			FileStream(const FileStream &reference);
+			FileStream & operator=(const FileStream &rhs);
+		};
+
 		/// <summary>
 		/// A struct containing information from the currently used stream.
 		/// </summary>
 		struct StreamInfo {
 			// TODO: Figure out what the hell is this and what/how it does.
-			StreamInfo(std::ifstream *pStream, std::string filePath, int currentLine, int prevIndent) :
+			StreamInfo(FileStream *pStream, std::string filePath, int currentLine, int prevIndent) :
 				m_pStream(pStream), m_FilePath(filePath), m_CurrentLine(currentLine), m_PreviousIndent(prevIndent) { ; }
 
 			// NOTE: These members are owned by the reader that owns this struct, so are not deleted when this is destroyed.
-			std::ifstream *m_pStream; //!< Currently used stream, is not on the StreamStack until a new stream is opened.
+			FileStream *m_pStream; //!< Currently used stream, is not on the StreamStack until a new stream is opened.
 			std::string m_FilePath; //!< Currently used stream's filepath.
 			int m_CurrentLine; //!< The line number the stream is on.
 			int m_PreviousIndent; //!< Count of tabs encountered on the last line DiscardEmptySpace() discarded.
@@ -239,7 +318,7 @@ namespace RTE {
 
 		static const std::string m_ClassName; //!< A string with the friendly-formatted type name of this.
 
-		std::ifstream *m_pStream; //!< Currently used stream, is not on the StreamStack until a new stream is opened.
+		FileStream *m_pStream; //!< Currently used stream, is not on the StreamStack until a new stream is opened.
 		std::list<StreamInfo> m_StreamStack; //!< Stack of stream and filepath pairs, each one representing a file opened to read from within another.
 		bool m_EndOfStreams; //!< All streams have been depleted.
 
@@ -265,7 +344,65 @@ namespace RTE {
 		/// </summary>
 		int m_ObjectEndings;
 
+		std::string m_PropNameBuffer; //!< Reused for looking up each property name read in the interned names, so reading them doesn't allocate.
+
+		PresetCache *m_pPresetCache; //!< The PresetCache everything read is recorded to or played back from, if any. Not owned.
+		int m_PresetCacheDepth; //!< How many reads are in progress while recording, so only the outermost ones are recorded and not the ones they're made of.
+
 #pragma region Reading Operations
+		/// <summary>
+		/// Does a read through the PresetCache if there is one, either playing back the value or reading it from the files and recording it. Without a PresetCache it just reads from the files.
+		/// </summary>
+		/// <param name="readType">The kind of read, checked against what was recorded when playing back.</param>
+		/// <param name="readFunction">Reads the value from the files.</param>
+		/// <returns>The value read or played back.</returns>
+		template <typename Type, typename ReadFunction> Type CacheRead(PresetCache::ReadType readType, const ReadFunction &readFunction);
+
+		/// <summary>
+		/// Reads the rest of the line from the files, the actual work of ReadLine(char *, int).
+		/// </summary>
+		/// <param name="locString">The c-string that will be filled out with the line.</param>
+		/// <param name="size">An int specifying the max size of the c-string.</param>
+		void ReadLineFromFile(char *locString, int size);
+
+		/// <summary>
+		/// Reads the rest of the line from the files, the actual work of ReadLine().
+		/// </summary>
+		/// <returns>The std::string that will hold the line's contents.</returns>
+		std::string ReadLineFromFile();
+
+		/// <summary>
+		/// Discards all whitespace, newlines and comments in the files, the actual work of DiscardEmptySpace().
+		/// </summary>
+		/// <returns>Whether there is more data to read from the file streams after this eat.</returns>
+		bool DiscardEmptySpaceFromFile();
+
+		/// <summary>
+		/// Reads from the files up to a specific character or end-of-file, the actual work of ReadTo().
+		/// </summary>
+		/// <param name="terminator">Which character to stop reading at.</param>
+		/// <param name="eatTerminator">Whether to also discard the terminator when it is encountered, or to leave it in the stream.</param>
+		/// <returns>The std::string that will hold what has been read up till, but not including the terminator char.</returns>
+		std::string ReadToFromFile(char terminator, bool discardTerminator);
+
+		/// <summary>
+		/// Reads the next property name from the files, the actual work of ReadPropName().
+		/// </summary>
+		/// <returns>The whitespace-trimmed interned std::string of the next property's name.</returns>
+		const std::string & ReadPropNameFromFile();
+
+		/// <summary>
+		/// Reads the next property value from the files, the actual work of ReadPropValue().
+		/// </summary>
+		/// <returns>The whitespace-trimmed std::string that will hold the next property value.</returns>
+		std::string ReadPropValueFromFile();
+
+		/// <summary>
+		/// Lines up the reader with the next property of the current object in the files, the actual work of NextProperty().
+		/// </summary>
+		/// <returns>Whether there are any more properties to be read by the current object.</returns>
+		bool NextPropertyFromFile();
+
 		/// <summary>
 		/// When ReadPropName encounters the property name "IncludeFile", it will automatically call this function to get started reading on that file.
 		/// This will create a new stream to the include file.
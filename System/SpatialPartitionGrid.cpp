@@ -0,0 +1,319 @@
+#include "SpatialPartitionGrid.h"
+#include "MovableObject.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::Clear() {
+		m_Width = 0;
+		m_Height = 0;
+		m_WrapsX = false;
+		m_WrapsY = false;
+		m_CellSize = 128;
+		m_CellCountX = 0;
+		m_CellCountY = 0;
+		m_QuerySlack = 0;
+		m_Cells.clear();
+		m_ObjectEntries.clear();
+		m_UpdateStamp = 0;
+		m_CellVisitStamps.clear();
+		m_QueryStamp = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SpatialPartitionGrid::Create(int width, int height, bool wrapsX, bool wrapsY, int cellSize) {
+		RTEAssert(width > 0 && height > 0 && cellSize > 0, "Trying to create a SpatialPartitionGrid with no area!");
+		Clear();
+
+		m_Width = width;
+		m_Height = height;
+		m_WrapsX = wrapsX;
+		m_WrapsY = wrapsY;
+		m_CellSize = cellSize;
+		// The last column and row may stick out past the far edges, which only matters for wrapping and is handled when wrapping positions
+		m_CellCountX = (m_Width + m_CellSize - 1) / m_CellSize;
+		m_CellCountY = (m_Height + m_CellSize - 1) / m_CellSize;
+		// Allow objects to have moved up to a full cell since their last update, and make up for the last column and row being narrower when they are wrapped next to the first
+		m_QuerySlack = m_CellSize;
+		if (m_WrapsX) { m_QuerySlack += m_CellCountX * m_CellSize - m_Width; }
+		if (m_WrapsY) { m_QuerySlack += m_CellCountY * m_CellSize - m_Height; }
+		m_Cells.resize(m_CellCountX * m_CellCountY);
+		m_CellVisitStamps.resize(m_Cells.size(), 0);
+
+		return 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::UpdateObject(MovableObject *pObject) {
+		if (!pObject || m_Cells.empty()) {
+			return;
+		}
+		const Vector &pos = pObject->GetPos();
+		int cellIndex = GetCellY(pos.m_Y) * m_CellCountX + GetCellX(pos.m_X);
+
+		std::unordered_map<const MovableObject *, ObjectEntry>::iterator entryItr = m_ObjectEntries.find(pObject);
+		if (entryItr == m_ObjectEntries.end()) {
+			ObjectEntry newEntry;
+			newEntry.m_CellIndex = cellIndex;
+			newEntry.m_UpdateStamp = m_UpdateStamp;
+			m_ObjectEntries.insert(std::make_pair(pObject, newEntry));
+			m_Cells[cellIndex].push_back(pObject);
+			return;
+		}
+
+		entryItr->second.m_UpdateStamp = m_UpdateStamp;
+		if (entryItr->second.m_CellIndex != cellIndex) {
+			RemoveFromCell(entryItr->second.m_CellIndex, pObject);
+			m_Cells[cellIndex].push_back(pObject);
+			entryItr->second.m_CellIndex = cellIndex;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::FinishUpdate() {
+		std::unordered_map<const MovableObject *, ObjectEntry>::iterator entryItr = m_ObjectEntries.begin();
+		while (entryItr != m_ObjectEntries.end()) {
+			if (entryItr->second.m_UpdateStamp != m_UpdateStamp) {
+				RemoveFromCell(entryItr->second.m_CellIndex, entryItr->first);
+				entryItr = m_ObjectEntries.erase(entryItr);
+			} else {
+				++entryItr;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::RemoveObject(const MovableObject *pObject) {
+		std::unordered_map<const MovableObject *, ObjectEntry>::iterator entryItr = m_ObjectEntries.find(pObject);
+		if (entryItr != m_ObjectEntries.end()) {
+			RemoveFromCell(entryItr->second.m_CellIndex, pObject);
+			m_ObjectEntries.erase(entryItr);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::RemoveAllObjects() {
+		for (std::vector<std::vector<MovableObject *>>::iterator cellItr = m_Cells.begin(); cellItr != m_Cells.end(); ++cellItr) {
+			cellItr->clear();
+		}
+		m_ObjectEntries.clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MovableObject * SpatialPartitionGrid::GetClosestObject(const Vector &point, float maxRadius, const std::function<bool(MovableObject *)> &filter, Vector &distanceResult) const {
+		if (m_ObjectEntries.empty()) {
+			return 0;
+		}
+		++m_QueryStamp;
+
+		int centerX = GetCellX(point.m_X);
+		int centerY = GetCellY(point.m_Y);
+		// Past this many rings every cell in the grid has been visited, no matter where the search started
+		int lastRing = std::max(m_CellCountX, m_CellCountY);
+		// Rings that are further out than the radius even with the slack taken off can't have anything acceptable in them
+		lastRing = std::min(lastRing, static_cast<int>(std::ceil((maxRadius + static_cast<float>(m_QuerySlack)) / static_cast<float>(m_CellSize))) + 1);
+
+		float shortestDistance = maxRadius;
+		MovableObject *pClosestObject = 0;
+
+		for (int ring = 0; ring <= lastRing; ++ring) {
+			for (int cellY = centerY - ring; cellY <= centerY + ring; ++cellY) {
+				// Only the top and bottom rows of the ring are full, the rows between just have the leftmost and rightmost cells
+				bool fullRow = cellY == centerY - ring || cellY == centerY + ring;
+				int step = (fullRow || ring == 0) ? 1 : ring * 2;
+				for (int cellX = centerX - ring; cellX <= centerX + ring; cellX += step) {
+					int cellIndex = WrapCellIndex(cellX, cellY);
+					if (cellIndex < 0 || m_CellVisitStamps[cellIndex] == m_QueryStamp) {
+						continue;
+					}
+					m_CellVisitStamps[cellIndex] = m_QueryStamp;
+
+					for (std::vector<MovableObject *>::const_iterator objectItr = m_Cells[cellIndex].begin(); objectItr != m_Cells[cellIndex].end(); ++objectItr) {
+						if (filter && !filter(*objectItr)) {
+							continue;
+						}
+						Vector distanceVec = ShortestDistance((*objectItr)->GetPos(), point);
+						float distance = distanceVec.GetMagnitude();
+						if (distance < shortestDistance) {
+							shortestDistance = distance;
+							pClosestObject = *objectItr;
+							distanceResult = distanceVec;
+						}
+					}
+				}
+			}
+			// Anything in the rings further out is at least this far away, so there's no point looking there
+			if (pClosestObject && shortestDistance <= static_cast<float>(ring * m_CellSize - m_QuerySlack)) {
+				break;
+			}
+		}
+		return pClosestObject;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::GetObjectsInRadius(const Vector &center, float radius, std::vector<MovableObject *> &results) const {
+		if (m_ObjectEntries.empty() || radius < 0) {
+			return;
+		}
+		++m_QueryStamp;
+
+		int reach = static_cast<int>(std::ceil((radius + static_cast<float>(m_QuerySlack)) / static_cast<float>(m_CellSize)));
+		int centerX = GetCellX(center.m_X);
+		int centerY = GetCellY(center.m_Y);
+
+		for (int cellY = centerY - reach; cellY <= centerY + reach; ++cellY) {
+			for (int cellX = centerX - reach; cellX <= centerX + reach; ++cellX) {
+				int cellIndex = WrapCellIndex(cellX, cellY);
+				if (cellIndex < 0 || m_CellVisitStamps[cellIndex] == m_QueryStamp) {
+					continue;
+				}
+				m_CellVisitStamps[cellIndex] = m_QueryStamp;
+
+				for (std::vector<MovableObject *>::const_iterator objectItr = m_Cells[cellIndex].begin(); objectItr != m_Cells[cellIndex].end(); ++objectItr) {
+					if (ShortestDistance((*objectItr)->GetPos(), center).GetMagnitude() <= radius) {
+						results.push_back(*objectItr);
+					}
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::GetObjectsInBox(const Box &box, std::vector<MovableObject *> &results) const {
+		if (m_ObjectEntries.empty()) {
+			return;
+		}
+		++m_QueryStamp;
+
+		Box searchBox(box);
+		searchBox.Unflip();
+		Vector corner = searchBox.GetCorner();
+		float width = searchBox.GetWidth();
+		float height = searchBox.GetHeight();
+
+		int padding = (m_QuerySlack + m_CellSize - 1) / m_CellSize;
+		int firstCellX = GetCellX(corner.m_X) - padding;
+		int firstCellY = GetCellY(corner.m_Y) - padding;
+		int lastCellX = firstCellX + static_cast<int>(std::ceil(width / static_cast<float>(m_CellSize))) + padding * 2;
+		int lastCellY = firstCellY + static_cast<int>(std::ceil(height / static_cast<float>(m_CellSize))) + padding * 2;
+		// A box wider than a wrapping grid covers all of it, so don't bother going around more than once
+		if (lastCellX - firstCellX >= m_CellCountX) { lastCellX = firstCellX + m_CellCountX - 1; }
+		if (lastCellY - firstCellY >= m_CellCountY) { lastCellY = firstCellY + m_CellCountY - 1; }
+		// Non-wrapping grids put everything outside the area into the edge cells, which are always included in the range since the first cell is clamped too
+		if (!m_WrapsX) {
+			firstCellX = std::max(firstCellX, 0);
+			lastCellX = std::min(lastCellX, m_CellCountX - 1);
+		}
+		if (!m_WrapsY) {
+			firstCellY = std::max(firstCellY, 0);
+			lastCellY = std::min(lastCellY, m_CellCountY - 1);
+		}
+
+		for (int cellY = firstCellY; cellY <= lastCellY; ++cellY) {
+			for (int cellX = firstCellX; cellX <= lastCellX; ++cellX) {
+				int cellIndex = WrapCellIndex(cellX, cellY);
+				if (cellIndex < 0 || m_CellVisitStamps[cellIndex] == m_QueryStamp) {
+					continue;
+				}
+				m_CellVisitStamps[cellIndex] = m_QueryStamp;
+
+				for (std::vector<MovableObject *>::const_iterator objectItr = m_Cells[cellIndex].begin(); objectItr != m_Cells[cellIndex].end(); ++objectItr) {
+					// Measure from the box corner so wrapped boxes and positions are compared on the same side of the seam
+					Vector offset = ShortestDistance(corner, (*objectItr)->GetPos());
+					if (m_WrapsX && offset.m_X < 0) { offset.m_X += static_cast<float>(m_Width); }
+					if (m_WrapsY && offset.m_Y < 0) { offset.m_Y += static_cast<float>(m_Height); }
+					if (offset.m_X >= 0 && offset.m_X < width && offset.m_Y >= 0 && offset.m_Y < height) {
+						results.push_back(*objectItr);
+					}
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SpatialPartitionGrid::GetCellX(float posX) const {
+		int cellX = static_cast<int>(std::floor(posX / static_cast<float>(m_CellSize)));
+		if (m_WrapsX) {
+			// Wrap the position rather than the cell, since the last column may not be a full cell wide
+			float wrappedX = std::fmod(posX, static_cast<float>(m_Width));
+			if (wrappedX < 0) { wrappedX += static_cast<float>(m_Width); }
+			cellX = static_cast<int>(wrappedX) / m_CellSize;
+		}
+		return std::max(0, std::min(cellX, m_CellCountX - 1));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SpatialPartitionGrid::GetCellY(float posY) const {
+		int cellY = static_cast<int>(std::floor(posY / static_cast<float>(m_CellSize)));
+		if (m_WrapsY) {
+			float wrappedY = std::fmod(posY, static_cast<float>(m_Height));
+			if (wrappedY < 0) { wrappedY += static_cast<float>(m_Height); }
+			cellY = static_cast<int>(wrappedY) / m_CellSize;
+		}
+		return std::max(0, std::min(cellY, m_CellCountY - 1));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SpatialPartitionGrid::WrapCellIndex(int cellX, int cellY) const {
+		if (m_WrapsX) {
+			cellX %= m_CellCountX;
+			if (cellX < 0) { cellX += m_CellCountX; }
+		} else if (cellX < 0 || cellX >= m_CellCountX) {
+			return -1;
+		}
+		if (m_WrapsY) {
+			cellY %= m_CellCountY;
+			if (cellY < 0) { cellY += m_CellCountY; }
+		} else if (cellY < 0 || cellY >= m_CellCountY) {
+			return -1;
+		}
+		return cellY * m_CellCountX + cellX;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	Vector SpatialPartitionGrid::ShortestDistance(const Vector &pos1, const Vector &pos2) const {
+		Vector distance = pos2 - pos1;
+		float halfWidth = static_cast<float>(m_Width) / 2.0F;
+		float halfHeight = static_cast<float>(m_Height) / 2.0F;
+
+		if (m_WrapsX) {
+			if (distance.m_X > halfWidth) {
+				distance.m_X -= static_cast<float>(m_Width);
+			} else if (distance.m_X < -halfWidth) {
+				distance.m_X += static_cast<float>(m_Width);
+			}
+		}
+		if (m_WrapsY) {
+			if (distance.m_Y > halfHeight) {
+				distance.m_Y -= static_cast<float>(m_Height);
+			} else if (distance.m_Y < -halfHeight) {
+				distance.m_Y += static_cast<float>(m_Height);
+			}
+		}
+		return distance;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialPartitionGrid::RemoveFromCell(int cellIndex, const MovableObject *pObject) {
+		std::vector<MovableObject *> &cell = m_Cells[cellIndex];
+		std::vector<MovableObject *>::iterator objectItr = std::find(cell.begin(), cell.end(), pObject);
+		if (objectItr != cell.end()) {
+			*objectItr = cell.back();
+			cell.pop_back();
+		}
+	}
+}
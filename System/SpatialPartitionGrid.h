@@ -0,0 +1,199 @@
+#ifndef _RTESPATIALPARTITIONGRID_
+#define _RTESPATIALPARTITIONGRID_
+
+#include "Box.h"
+
+namespace RTE {
+
+	class MovableObject;
+
+	/// <summary>
+	/// A uniform grid of cells covering the scene, which MovableObjects are sorted into by position so that proximity queries only have to look at the objects in nearby cells.
+	/// Wraps along the same axes as the scene does. Does not own any of the objects in it, and is not thread safe.
+	/// </summary>
+	class SpatialPartitionGrid {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a SpatialPartitionGrid object in system memory. Create() should be called before using the object.
+		/// </summary>
+		SpatialPartitionGrid() { Clear(); }
+
+		/// <summary>
+		/// Makes the SpatialPartitionGrid object ready for use, emptying it of any objects.
+		/// </summary>
+		/// <param name="width">The width of the area to cover, in scene pixels.</param>
+		/// <param name="height">The height of the area to cover, in scene pixels.</param>
+		/// <param name="wrapsX">Whether the area wraps horizontally.</param>
+		/// <param name="wrapsY">Whether the area wraps vertically.</param>
+		/// <param name="cellSize">The width and height of each cell, in scene pixels.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Create(int width, int height, bool wrapsX, bool wrapsY, int cellSize = 128);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a SpatialPartitionGrid object before deletion from system memory.
+		/// </summary>
+		~SpatialPartitionGrid() { Destroy(); }
+
+		/// <summary>
+		/// Destroys and resets (through Clear()) this SpatialPartitionGrid object.
+		/// </summary>
+		void Destroy() { Clear(); }
+
+		/// <summary>
+		/// Resets the entire SpatialPartitionGrid object to the default settings or values.
+		/// </summary>
+		void Reset() { Clear(); }
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Tells whether this grid was created to cover an area with the specified dimensions and wrapping.
+		/// </summary>
+		/// <param name="width">The width of the area, in scene pixels.</param>
+		/// <param name="height">The height of the area, in scene pixels.</param>
+		/// <param name="wrapsX">Whether the area wraps horizontally.</param>
+		/// <param name="wrapsY">Whether the area wraps vertically.</param>
+		/// <returns>Whether the grid matches the specified area.</returns>
+		bool MatchesArea(int width, int height, bool wrapsX, bool wrapsY) const { return !m_Cells.empty() && m_Width == width && m_Height == height && m_WrapsX == wrapsX && m_WrapsY == wrapsY; }
+
+		/// <summary>
+		/// Gets the number of objects currently sorted into this grid.
+		/// </summary>
+		/// <returns>The number of objects in the grid.</returns>
+		int GetObjectCount() const { return m_ObjectEntries.size(); }
+#pragma endregion
+
+#pragma region Updating
+		/// <summary>
+		/// Starts a new update pass. Every object that should stay in the grid must be passed to UpdateObject before the pass is finished with FinishUpdate.
+		/// </summary>
+		void StartUpdate() { ++m_UpdateStamp; }
+
+		/// <summary>
+		/// Adds an object to the grid, or moves it to the cell of its current position if it was already in it. Only touches the cells if it has actually changed cell since the last update.
+		/// </summary>
+		/// <param name="pObject">The object to update. Not owned.</param>
+		void UpdateObject(MovableObject *pObject);
+
+		/// <summary>
+		/// Finishes the current update pass, removing all objects that weren't updated since StartUpdate was called.
+		/// </summary>
+		void FinishUpdate();
+
+		/// <summary>
+		/// Removes an object from the grid right away. Should be called for anything that is removed or deleted between update passes, so the grid never points at a deleted object.
+		/// </summary>
+		/// <param name="pObject">The object to remove. It's safe to pass objects that aren't in the grid.</param>
+		void RemoveObject(const MovableObject *pObject);
+
+		/// <summary>
+		/// Removes all objects from the grid, keeping its dimensions.
+		/// </summary>
+		void RemoveAllObjects();
+#pragma endregion
+
+#pragma region Queries
+		/// <summary>
+		/// Finds the object closest to a point, searching outwards from the point one ring of cells at a time and stopping as soon as no unvisited cell can contain anything closer.
+		/// Object positions are used as they are right now, and the search allows for objects having moved up to a cell since they were last updated.
+		/// </summary>
+		/// <param name="point">The scene point to search around.</param>
+		/// <param name="maxRadius">Only objects closer than this are considered.</param>
+		/// <param name="filter">Function that returns whether an object should be considered at all.</param>
+		/// <param name="distanceResult">Filled out with the shortest distance vector from the found object to the point, if any was found.</param>
+		/// <returns>The closest object that passed the filter, or 0 if none was found within the radius.</returns>
+		MovableObject * GetClosestObject(const Vector &point, float maxRadius, const std::function<bool(MovableObject *)> &filter, Vector &distanceResult) const;
+
+		/// <summary>
+		/// Gathers all objects within a radius of a point.
+		/// </summary>
+		/// <param name="center">The scene point to search around.</param>
+		/// <param name="radius">The radius to search within.</param>
+		/// <param name="results">A vector which the found objects will be appended to.</param>
+		void GetObjectsInRadius(const Vector &center, float radius, std::vector<MovableObject *> &results) const;
+
+		/// <summary>
+		/// Gathers all objects whose positions are inside a box. The box is wrapped along the axes the grid wraps on.
+		/// </summary>
+		/// <param name="box">The scene box to search within.</param>
+		/// <param name="results">A vector which the found objects will be appended to.</param>
+		void GetObjectsInBox(const Box &box, std::vector<MovableObject *> &results) const;
+#pragma endregion
+
+	protected:
+
+		/// <summary>
+		/// Where in the grid an object is, and when it was last updated.
+		/// </summary>
+		struct ObjectEntry {
+			int m_CellIndex; //!< The index of the cell the object is currently sorted into.
+			unsigned int m_UpdateStamp; //!< The update pass the object was last updated in.
+		};
+
+		int m_Width; //!< The width of the covered area, in scene pixels.
+		int m_Height; //!< The height of the covered area, in scene pixels.
+		bool m_WrapsX; //!< Whether the covered area wraps horizontally.
+		bool m_WrapsY; //!< Whether the covered area wraps vertically.
+		int m_CellSize; //!< The width and height of each cell, in scene pixels.
+		int m_CellCountX; //!< The number of cell columns.
+		int m_CellCountY; //!< The number of cell rows.
+		int m_QuerySlack; //!< How much closer than their cell suggests objects may be, from moving since their last update and from the narrower last cells at wrapping seams.
+
+		std::vector<std::vector<MovableObject *>> m_Cells; //!< The objects sorted into each cell, row by row. Not owned.
+		std::unordered_map<const MovableObject *, ObjectEntry> m_ObjectEntries; //!< Where each object in the grid currently is.
+		unsigned int m_UpdateStamp; //!< The current update pass.
+
+		mutable std::vector<unsigned int> m_CellVisitStamps; //!< The query each cell was last visited by, so wrapped queries don't visit the same cell twice.
+		mutable unsigned int m_QueryStamp; //!< The current query.
+
+		/// <summary>
+		/// Gets the index of the cell column containing an x position, wrapping or clamping it to the grid.
+		/// </summary>
+		/// <param name="posX">The x position in scene pixels.</param>
+		/// <returns>The cell column.</returns>
+		int GetCellX(float posX) const;
+
+		/// <summary>
+		/// Gets the index of the cell row containing a y position, wrapping or clamping it to the grid.
+		/// </summary>
+		/// <param name="posY">The y position in scene pixels.</param>
+		/// <returns>The cell row.</returns>
+		int GetCellY(float posY) const;
+
+		/// <summary>
+		/// Wraps cell coordinates along the wrapping axes, and checks that they are within the grid.
+		/// </summary>
+		/// <param name="cellX">The cell column, which will be wrapped if needed.</param>
+		/// <param name="cellY">The cell row, which will be wrapped if needed.</param>
+		/// <returns>The index of the cell, or -1 if the coordinates are outside a non-wrapping grid.</returns>
+		int WrapCellIndex(int cellX, int cellY) const;
+
+		/// <summary>
+		/// Gets the shortest distance between two points in the covered area, taking wrapping into account the same way SceneMan::ShortestDistance does.
+		/// </summary>
+		/// <param name="pos1">The first position.</param>
+		/// <param name="pos2">The second position.</param>
+		/// <returns>The shortest distance vector from the first position to the second.</returns>
+		Vector ShortestDistance(const Vector &pos1, const Vector &pos2) const;
+
+		/// <summary>
+		/// Removes an object from a cell's list, without keeping the order of the rest of the list.
+		/// </summary>
+		/// <param name="cellIndex">The index of the cell to remove the object from.</param>
+		/// <param name="pObject">The object to remove.</param>
+		void RemoveFromCell(int cellIndex, const MovableObject *pObject);
+
+	private:
+
+		/// <summary>
+		/// Clears all the member variables of this SpatialPartitionGrid, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+	};
+}
+#endif
@@ -8,6 +8,8 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <cctype>
 #include <string>
 #include <cstring>